@@ -100,6 +100,10 @@ struct _cntxt_entry;
 // response mad is supplied to callback only if Status is VSTATUS_OK
 typedef void (*cntxt_callback_t)(struct _cntxt_entry *, Status_t, void *, Mai_t *mad);
 
+// optional per pool hook told the round trip time of each response matched
+// to an outstanding entry, measured from the last (re)transmission
+typedef void (*cntxt_rtt_hook_t)(uint16_t aid, uint64_t usecs);
+
 typedef struct _cntxt_entry {
 	uint64_t	    tstamp;
 	uint64_t        tid;		// Tid for hash table search
@@ -160,6 +164,7 @@ typedef struct _generic_cntxt_ {
     cntxt_entry_t 	*hash[CNTXT_HASH_TABLE_DEPTH];
     cntxt_entry_t 	*pool;      // array of context entries 'poolSize' deep
     Pool_t          *globalPool;    // pool to allocate data from if needed for queued messages
+    cntxt_rtt_hook_t rttHook;           // NULL if round trip times not wanted
 } generic_cntxt_t;
 
 // external function definitions
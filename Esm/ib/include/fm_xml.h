@@ -859,6 +859,12 @@ typedef struct _SMXmlConfig {
 	uint32_t	queryValidation;
 	uint32_t	sma_batch_size;
 	uint32_t	max_parallel_reqs;
+	uint32_t	sma_adaptive_batch;
+	uint32_t	sma_batch_size_max;
+	uint32_t	pipelined_discovery;
+	char		sim_fabric[FILENAME_SIZE];
+	uint32_t	sim_hop_latency;
+	uint32_t	sim_loss_ppm;
  	uint32_t	check_mft_responses;
 	uint32_t	min_supported_vls;
 
@@ -870,6 +876,15 @@ typedef struct _SMXmlConfig {
 	uint32_t	topo_lid_offset;
 	uint32_t	force_rebalance;
 	uint32_t	use_cached_node_data;
+	uint32_t	light_sweep;				// re-probe only trap sources when reusing cached node data
+	uint32_t	light_sweep_full_interval;	// seconds between forced full sweeps in light sweep mode
+	uint32_t	routing_threads;			// worker threads for routing computations, 0 = one per CPU
+	uint32_t	incremental_cost_update;	// repair the previous cost matrix when only ISLs changed
+	uint32_t	compact_cost_matrix;		// keep the retained cost matrix packed and narrowed
+	uint32_t	parallel_lft;				// calculate switch LFTs on the worker pool
+	uint32_t	sa_worker_threads;			// SA query worker threads, 0 = process on the SA reader
+	uint32_t	path_record_cache_size;		// max cached point to point PathRecord queries, 0 = disabled
+	char		warm_start_file[FILENAME_SIZE];	// routing snapshot used to warm start, empty = disabled
 
     SMLinkPolicyXmlConfig_t hfi_link_policy;
     SMLinkPolicyXmlConfig_t isl_link_policy;
@@ -1047,6 +1062,7 @@ typedef struct _PmShortTermHistoryXmlConfig {
 	uint32_t	imagesPerComposite;
 	uint64_t	maxDiskSpace;
 	uint8_t		compressionDivisions;
+	char		compressionCodec[16];
 } PmShortTermHistoryXmlConfig_t;
 
 // PM configuration
@@ -1127,6 +1143,7 @@ typedef struct _FEXmlConfig {
 	uint32_t 	manager_check_rate;
     uint32_t   	login;
 	uint32_t	window;
+	uint32_t	worker_threads;		// passthrough worker threads, 0 = serve on the FE thread
     uint32_t    SslSecurityEnabled;
 	char		SslSecurityDir[FILENAME_SIZE];
 	char		SslSecurityFmCertificate[FILENAME_SIZE];
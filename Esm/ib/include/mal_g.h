@@ -106,4 +106,14 @@ Status_t ib_enable_is_sm(void);
  */
 Status_t ib_disable_is_sm(void);
 
+/*
+ * ib_sim_configure
+ *
+ * Directs all MAD traffic to a simulated fabric instead of the HFI.  The
+ * fabric is a "fattree:leaves,spines,hfis" or "torus:x,y,z,hfis" spec or
+ * the name of an opareport topology file.  Must be called before
+ * ib_init_devport.
+ */
+Status_t ib_sim_configure(const char *fabric, uint32_t hopLatency, uint32_t lossPpm);
+
 #endif // _IB_MAL_G_H_ 
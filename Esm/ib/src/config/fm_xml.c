@@ -1054,6 +1054,7 @@ void pmClearConfig(PMXmlConfig_t *pmp)
 	memset(pmp->log_masks, 0, sizeof(pmp->log_masks));
 	memset(pmp->name, 0, sizeof(pmp->name));
 	memset(pmp->shortTermHistory.StorageLocation, 0, sizeof(pmp->shortTermHistory.StorageLocation));
+	memset(pmp->shortTermHistory.compressionCodec, 0, sizeof(pmp->shortTermHistory.compressionCodec));
 
 	pmp->number_of_pm_groups = 0;
 	memset(pmp->pm_portgroups, 0, sizeof(pmp->pm_portgroups));
@@ -1194,6 +1195,7 @@ void pmInitConfig(PMXmlConfig_t *pmp, uint32_t instance, uint32_t ccc_method)
 		DEFAULT_AND_CKSUM_STR(pmp->shortTermHistory.StorageLocation, "/var/opt/opafm", CKSUM_OVERALL_DISRUPT);
 		DEFAULT_AND_CKSUM_U32(pmp->shortTermHistory.totalHistory, 24, CKSUM_OVERALL_DISRUPT_CONSIST);
 		DEFAULT_AND_CKSUM_U8(pmp->shortTermHistory.compressionDivisions, 1, CKSUM_OVERALL_DISRUPT_CONSIST);
+		DEFAULT_AND_CKSUM_STR(pmp->shortTermHistory.compressionCodec, "zlib", CKSUM_OVERALL_DISRUPT_CONSIST);
 	}
 
 	DEFAULT_AND_CKSUM_U32(pmp->SslSecurityEnabled, 0, CKSUM_OVERALL_DISRUPT_CONSIST);
@@ -1403,6 +1405,7 @@ void feInitConfig(FEXmlConfig_t *fep, uint32_t instance, uint32_t ccc_method)
 	DEFAULT_AND_CKSUM_STR(fep->CoreDumpDir, "/var/crash/opafm", CKSUM_OVERALL_DISRUPT);
 	DEFAULT_AND_CKSUM_STR(fep->syslog_facility, "local6", CKSUM_OVERALL_DISRUPT);
 	DEFAULT_AND_CKSUM_U32(fep->manager_check_rate, 60000000, CKSUM_OVERALL_DISRUPT_CONSIST);
+	DEFAULT_AND_CKSUM_U32(fep->worker_threads, 0, CKSUM_OVERALL_DISRUPT);
 	DEFAULT_AND_CKSUM_U32(fep->SslSecurityEnabled, 0, CKSUM_OVERALL_DISRUPT);
 	if (fep->SslSecurityEnabled) {
 		DEFAULT_AND_CKSUM_STR(fep->SslSecurityDir, FM_SSL_SECURITY_DIR, CKSUM_OVERALL_DISRUPT);
@@ -1459,6 +1462,7 @@ void feShowConfig(FEXmlConfig_t *fep)
 	printf("XML - listen %u\n", (unsigned int)fep->listen);
 	printf("XML - login %u\n", (unsigned int)fep->login);
 	printf("XML - window %u\n", (unsigned int)fep->window);
+	printf("XML - worker_threads %u\n", (unsigned int)fep->worker_threads);
 	printf("XML - debug %u\n", (unsigned int)fep->debug);
 	printf("XML - debug_rmpp %u\n", (unsigned int)fep->debug_rmpp);
 	printf("XML - subnet_size %u\n", (unsigned int)fep->subnet_size);
@@ -1500,6 +1504,8 @@ void smClearConfig(SMXmlConfig_t *smp)
 	memset(smp->log_masks, 0, sizeof(smp->log_masks));
 	memset(smp->name, 0, sizeof(smp->name));
 	memset(smp->routing_algorithm, 0, sizeof(smp->routing_algorithm));
+	memset(smp->sim_fabric, 0, sizeof(smp->sim_fabric));
+	memset(smp->warm_start_file, 0, sizeof(smp->warm_start_file));
 	memset(smp->preDefTopo.topologyFilename, 0, sizeof(smp->preDefTopo.topologyFilename));
 	memset(&smp->ftreeRouting.coreSwitches, 0, sizeof(smp->ftreeRouting.coreSwitches));
 	memset(&smp->ftreeRouting.routeLast, 0, sizeof(smp->ftreeRouting.routeLast));
@@ -1627,6 +1633,20 @@ void smInitConfig(SMXmlConfig_t *smp, SMDPLXmlConfig_t *dplp, SMMcastConfig_t *m
         smp->max_parallel_reqs = 1;
 	CKSUM_DATA(smp->sma_batch_size, CKSUM_OVERALL_DISRUPT_CONSIST);
 	CKSUM_DATA(smp->max_parallel_reqs, CKSUM_OVERALL_DISRUPT_CONSIST);
+	DEFAULT_AND_CKSUM_U32(smp->sma_adaptive_batch, 0, CKSUM_OVERALL_DISRUPT_CONSIST);
+	DEFAULT_U32(smp->sma_batch_size_max, 16);
+	if (smp->sma_batch_size_max < smp->sma_batch_size)
+		smp->sma_batch_size_max = smp->sma_batch_size;
+	// the per SMA window is kept in a uint8_t
+	if (smp->sma_batch_size_max > 255)
+		smp->sma_batch_size_max = 255;
+	CKSUM_DATA(smp->sma_batch_size_max, CKSUM_OVERALL_DISRUPT_CONSIST);
+	DEFAULT_AND_CKSUM_U32(smp->pipelined_discovery, 0, CKSUM_OVERALL_DISRUPT_CONSIST);
+	CKSUM_STR(smp->sim_fabric, CKSUM_OVERALL_DISRUPT);
+	DEFAULT_AND_CKSUM_U32(smp->sim_hop_latency, 0, CKSUM_OVERALL_DISRUPT);
+	DEFAULT_AND_CKSUM_U32(smp->sim_loss_ppm, 0, CKSUM_OVERALL_DISRUPT);
+	if (smp->sim_loss_ppm > 1000000)
+		smp->sim_loss_ppm = 1000000;
 
 
 	DEFAULT_AND_CKSUM_U32(smp->check_mft_responses, 1, CKSUM_OVERALL_DISRUPT_CONSIST);
@@ -1647,6 +1667,15 @@ void smInitConfig(SMXmlConfig_t *smp, SMDPLXmlConfig_t *dplp, SMMcastConfig_t *m
 	DEFAULT_AND_CKSUM_U32(smp->loopback_mode, 0, CKSUM_OVERALL_DISRUPT_CONSIST);
 	DEFAULT_AND_CKSUM_U32(smp->force_rebalance, 0, CKSUM_OVERALL_DISRUPT_CONSIST);
 	DEFAULT_AND_CKSUM_U32(smp->use_cached_node_data, 0, CKSUM_OVERALL_DISRUPT_CONSIST);
+	DEFAULT_AND_CKSUM_U32(smp->light_sweep, 0, CKSUM_OVERALL_DISRUPT_CONSIST);
+	DEFAULT_AND_CKSUM_U32(smp->light_sweep_full_interval, 300, CKSUM_OVERALL_DISRUPT_CONSIST);
+	DEFAULT_AND_CKSUM_U32(smp->routing_threads, 0, CKSUM_OVERALL_DISRUPT);
+	DEFAULT_AND_CKSUM_U32(smp->incremental_cost_update, 1, CKSUM_OVERALL_DISRUPT);
+	DEFAULT_AND_CKSUM_U32(smp->compact_cost_matrix, 1, CKSUM_OVERALL_DISRUPT);
+	DEFAULT_AND_CKSUM_U32(smp->parallel_lft, 0, CKSUM_OVERALL_DISRUPT_CONSIST);
+	DEFAULT_AND_CKSUM_U32(smp->sa_worker_threads, 0, CKSUM_OVERALL_DISRUPT);
+	DEFAULT_AND_CKSUM_U32(smp->path_record_cache_size, 16384, CKSUM_OVERALL_DISRUPT);
+	CKSUM_STR(smp->warm_start_file, CKSUM_OVERALL);
 	DEFAULT_AND_CKSUM_U32(smp->sma_spoofing_check, 1, CKSUM_OVERALL_DISRUPT_CONSIST);
 	DEFAULT_AND_CKSUM_U16(smp->hfi_link_policy.link_max_downgrade, 1, CKSUM_OVERALL_DISRUPT_CONSIST);
 	DEFAULT_AND_CKSUM_U8(smp->hfi_link_policy.width_policy.enabled, 1, CKSUM_OVERALL_DISRUPT_CONSIST);
@@ -1948,6 +1977,12 @@ void smShowConfig(SMXmlConfig_t *smp, SMDPLXmlConfig_t *dplp, SMMcastConfig_t *m
 	printf("XML - queryValidation %u\n", (unsigned int)smp->queryValidation);
 	printf("XML - sma_batch_size %u\n", (unsigned int)smp->sma_batch_size);
 	printf("XML - max_parallel_reqs %u\n", (unsigned int)smp->max_parallel_reqs);
+	printf("XML - sma_adaptive_batch %u\n", (unsigned int)smp->sma_adaptive_batch);
+	printf("XML - sma_batch_size_max %u\n", (unsigned int)smp->sma_batch_size_max);
+	printf("XML - pipelined_discovery %u\n", (unsigned int)smp->pipelined_discovery);
+	printf("XML - sim_fabric %s\n", smp->sim_fabric);
+	printf("XML - sim_hop_latency %u\n", (unsigned int)smp->sim_hop_latency);
+	printf("XML - sim_loss_ppm %u\n", (unsigned int)smp->sim_loss_ppm);
 	printf("XML - check_mft_responses %u\n", (unsigned int)smp->check_mft_responses);
 	printf("XML - sm_debug_perf %u\n", (unsigned int)smp->sm_debug_perf);
 	printf("XML - sa_debug_perf %u\n", (unsigned int)smp->sa_debug_perf);
@@ -1966,6 +2001,15 @@ void smShowConfig(SMXmlConfig_t *smp, SMDPLXmlConfig_t *dplp, SMMcastConfig_t *m
 	printf("XML - loopback_mode %u\n", (unsigned int)smp->loopback_mode);
 	printf("XML - force_rebalance %u\n", (unsigned int)smp->force_rebalance);
 	printf("XML - use_cached_node_data %u\n", (unsigned int)smp->use_cached_node_data);
+	printf("XML - light_sweep %u\n", (unsigned int)smp->light_sweep);
+	printf("XML - light_sweep_full_interval %u\n", (unsigned int)smp->light_sweep_full_interval);
+	printf("XML - routing_threads %u\n", (unsigned int)smp->routing_threads);
+	printf("XML - incremental_cost_update %u\n", (unsigned int)smp->incremental_cost_update);
+	printf("XML - compact_cost_matrix %u\n", (unsigned int)smp->compact_cost_matrix);
+	printf("XML - parallel_lft %u\n", (unsigned int)smp->parallel_lft);
+	printf("XML - sa_worker_threads %u\n", (unsigned int)smp->sa_worker_threads);
+	printf("XML - path_record_cache_size %u\n", (unsigned int)smp->path_record_cache_size);
+	printf("XML - warm_start_file %s\n", smp->warm_start_file);
 	printf("XML - NoReplyIfBusy %u\n", (unsigned int)smp->NoReplyIfBusy);
 	printf("XML - lft_multi_block %u\n", (unsigned int)smp->lft_multi_block);
 	printf("XML - use_aggregates %u\n", (unsigned int)smp->use_aggregates);
@@ -5957,6 +6001,12 @@ static IXML_FIELD SmFields[] = {
 	{ tag:"QueryValidation", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, queryValidation) },
 	{ tag:"SmaBatchSize", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, sma_batch_size) },
 	{ tag:"MaxParallelReqs", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, max_parallel_reqs) },
+	{ tag:"AdaptiveSmaBatch", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, sma_adaptive_batch) },
+	{ tag:"SmaBatchSizeMax", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, sma_batch_size_max) },
+	{ tag:"PipelinedDiscovery", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, pipelined_discovery) },
+	{ tag:"SimFabric", format:'s', IXML_FIELD_INFO(SMXmlConfig_t, sim_fabric) },
+	{ tag:"SimHopLatency", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, sim_hop_latency) },
+	{ tag:"SimLossPpm", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, sim_loss_ppm) },
  	{ tag:"CheckMftResponses", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, check_mft_responses) },
 	{ tag:"MonitorStandby", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, monitor_standby_enable) },
 	{ tag:"Lmc", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, lmc) },
@@ -6009,6 +6059,15 @@ static IXML_FIELD SmFields[] = {
 	{ tag:"LIDSpacing", format:'h', IXML_FIELD_INFO(SMXmlConfig_t, topo_lid_offset) },
 	{ tag:"ForceRebalance", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, force_rebalance) },
 	{ tag:"UseCachedNodeData", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, use_cached_node_data) },
+	{ tag:"LightSweep", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, light_sweep) },
+	{ tag:"LightSweepFullInterval", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, light_sweep_full_interval) },
+	{ tag:"RoutingThreads", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, routing_threads) },
+	{ tag:"IncrementalCostUpdate", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, incremental_cost_update) },
+	{ tag:"CompactCostMatrix", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, compact_cost_matrix) },
+	{ tag:"ParallelLftCalculation", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, parallel_lft) },
+	{ tag:"SaWorkerThreads", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, sa_worker_threads) },
+	{ tag:"PathRecordCacheSize", format:'u', IXML_FIELD_INFO(SMXmlConfig_t, path_record_cache_size) },
+	{ tag:"WarmStartFile", format:'s', IXML_FIELD_INFO(SMXmlConfig_t, warm_start_file) },
 	{ tag:"DynamicPacketLifetime", format:'k', subfields:SmDPLifetimeFields, start_func:SmDPLifetimeXmlParserStart, end_func:SmDPLifetimeXmlParserEnd },
 	{ tag:"Multicast", format:'k', subfields:SmMcastFields, start_func:SmMcastXmlParserStart, end_func:SmMcastXmlParserEnd },
 	{ tag:"RoutingAlgorithm", format:'s', IXML_FIELD_INFO(SMXmlConfig_t, routing_algorithm) },
@@ -6212,6 +6271,7 @@ static IXML_FIELD FeFields[] = {
 	{ tag:"LogFile", format:'s', IXML_FIELD_INFO(FEXmlConfig_t, log_file) },
 	{ tag:"Window", format:'u', IXML_FIELD_INFO(FEXmlConfig_t, window) },
 	{ tag:"ManagerCheckRate", format:'u', IXML_FIELD_INFO(FEXmlConfig_t, manager_check_rate) },
+	{ tag:"WorkerThreads", format:'u', IXML_FIELD_INFO(FEXmlConfig_t, worker_threads) },
 	{ NULL }
 };
 
@@ -6374,6 +6434,7 @@ static IXML_FIELD PmShortTermHistoryFields[] = {
 	{ tag:"ImagesPerComposite", format:'u', IXML_FIELD_INFO(PmShortTermHistoryXmlConfig_t, imagesPerComposite) },
 	{ tag:"MaxDiskSpace", format:'u', IXML_FIELD_INFO(PmShortTermHistoryXmlConfig_t, maxDiskSpace) },
 	{ tag:"CompressionDivisions", format:'u', IXML_FIELD_INFO(PmShortTermHistoryXmlConfig_t, compressionDivisions) },
+	{ tag:"CompressionCodec", format:'s', IXML_FIELD_INFO(PmShortTermHistoryXmlConfig_t, compressionCodec) },
 	{ NULL }
 };
 
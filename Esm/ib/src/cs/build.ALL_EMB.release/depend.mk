@@ -0,0 +1,11 @@
+include Makefile
+include build.ALL_EMB.release/cs_sema.c.dep
+include build.ALL_EMB.release/cs_context.c.dep
+include build.ALL_EMB.release/cs_queue.c.dep
+include build.ALL_EMB.release/cs_hashtable.c.dep
+include build.ALL_EMB.release/cs_string.c.dep
+include build.ALL_EMB.release/vs_pool_common.c.dep
+include build.ALL_EMB.release/cs_bitset.c.dep
+include build.ALL_EMB.release/vs_thr_common.c.dep
+include build.ALL_EMB.release/cs_utility.c.dep
+include build.ALL_EMB.release/cs_csm_log.c.dep
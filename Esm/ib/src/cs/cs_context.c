@@ -258,6 +258,13 @@ static Status_t cntxt_release( cntxt_entry_t *a_cntxt, generic_cntxt_t *cntx, St
     cntxt_unhash( a_cntxt, cntx);
     a_cntxt->releasing = 1;
 
+    if (cntx->rttHook && s == VSTATUS_OK && mad) {
+        uint64_t now;
+
+        vs_time_get( &now );
+        cntx->rttHook( a_cntxt->mad.base.aid, now - a_cntxt->tstamp );
+    }
+
     if (a_cntxt->senderWantsResponse && cntx->resp_queue) {
 		Status_t status;
 
@@ -0,0 +1,5 @@
+include Makefile
+include build.ALL_EMB.release/fe_main.c.dep
+include build.ALL_EMB.release/fe_mad.c.dep
+include build.ALL_EMB.release/fe_trap_thread.c.dep
+include build.ALL_EMB.release/fe_linux.c.dep
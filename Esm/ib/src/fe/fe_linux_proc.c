@@ -439,7 +439,12 @@ uint8_t fe_is_thread(void)
 void
 if3_set_rmpp_minfo (ManagerInfo_t *mi)
 {
-    mi->rmppMngrfd = &fdsa;
+    // passthrough workers open their own FE handles, each with its own RMPP
+    // connection
+    if (mi->mclass == MAD_CV_VENDOR_FE && mi->fdr != fdsa)
+        mi->rmppMngrfd = &mi->fdr;
+    else
+        mi->rmppMngrfd = &fdsa;
     mi->rmppPool = &fe_pool;
     // FE does not receive inbound MAD requests, so RMPP filters not required
     mi->rmppCreateFilters = 0;
@@ -216,24 +216,22 @@ uint32_t fe_send_packet(NetConnection *conn, uint8_t *buf, int32_t len)
 *                      PASSTHROUGH HANDLERS                                *
 ***************************************************************************/
 
-static uint32_t fe_passthrough_send_failure_response(uint8_t *netbuf, FE_ConnList *connList, IBhandle_t fd_sa, uint16 returnStatus)
+static uint32_t fe_passthrough_send_failure_response(uint8_t *netbuf, FePassthru_t *pt, uint16 returnStatus)
 {
-	NetConnection *curConn; 					/* Pointer to the current connection */
 	OOBPacket *ipacket; 						/* The incoming packet */
 	OOBPacket *opacket; 						/* The out going packet */
 	SA_MAD* saMad;								/* Pointer to the incoming mad data to forward */
-	uint32_t rc = FE_SUCCESS;				    /* Whether or not the response to the FEC was successful */
+	uint32_t rc = FE_SUCCESS;				    /* Whether or not the response to the FEC was built */
     SA_MAD* returnMad; 							/* Outgoing mad to send */
 
-	IB_ENTER(__func__, netbuf, connList, 0, 0);
+	IB_ENTER(__func__, netbuf, pt, 0, 0);
 
 	/* Sort out the incoming information */
 	ipacket = (OOBPacket *) netbuf;
 	saMad = (SA_MAD*) &(ipacket->MadData);
-	curConn = connList->conn;
 
     /* Build the out of band packet and construct a response from the original request. */
-    opacket = (OOBPacket *) g_fe_oob_send_buf;
+    opacket = (OOBPacket *) pt->sendBuf;
     memset(opacket, 0, sizeof(OOBPacket));
     returnMad = (SA_MAD*) &(opacket->MadData);
 
@@ -248,30 +246,70 @@ static uint32_t fe_passthrough_send_failure_response(uint8_t *netbuf, FE_ConnLis
     returnMad->RmppHdr = saMad->RmppHdr;
     returnMad->SaHdr = saMad->SaHdr;
 
-    /* Forward the response to the FEC*/
-    if(fe_send_packet(curConn, g_fe_oob_send_buf, sizeof(OOBHeader) + IBA_SUBN_ADM_HDRSIZE)){
-        IB_LOG_WARN_FMT(__func__, "Unable to send response packet");
-        rc = FE_NO_COMPLETE;
-    }
+    /* The caller forwards the response to the FEC */
+    pt->sendLen = sizeof(OOBHeader) + IBA_SUBN_ADM_HDRSIZE;
 
 	IB_EXIT(__func__, rc);
 	return rc;
 }
 
-uint32_t fe_sa_passthrough(uint8_t *netbuf, FE_ConnList *connList, IBhandle_t fd_sa){
-	NetConnection *curConn; 						/* Pointer to the current connection */
+/*
+ * Release a worker's SA connection along with its RMPP connection.
+ */
+void fe_passthrough_close(FePassthru_t *pt)
+{
+    if (pt->fd == INVALID_HANDLE)
+        return;
+    (void)if3_close_mngr_rmpp_cnx(pt->fd);
+    (void)if3_close(pt->fd);
+    pt->fd = INVALID_HANDLE;
+}
+
+/*
+ * Forward a passthrough MAD to the SA/PA and wait for the response.  The FE
+ * thread uses fdsa, which only it opens and closes.  A worker uses its own
+ * connection, reopened once the FE thread has dropped fdsa because the SA
+ * was lost or moved.
+ */
+static Status_t fe_passthrough_send_mad(FePassthru_t *pt, SA_MAD *saMad, uint32_t dataLength, Mai_t *returnMait,
+                                        uint8_t *returnBuffer, uint32_t *returnSize, uint32_t *returnStatus)
+{
+    Status_t rc;
+    IBhandle_t fd = fdsa;
+
+    if (pt->ownCnx) {
+        if (pt->fdGen != fe_sa_generation)
+            fe_passthrough_close(pt);
+        if (pt->fd == INVALID_HANDLE && fdsa != INVALID_HANDLE) {
+            pt->fdGen = fe_sa_generation;
+            if ((rc = if3_open(fe_config.hca, fe_config.port, MAD_CV_VENDOR_FE, &pt->fd)) != VSTATUS_OK) {
+                IB_LOG_INFINI_INFORC("can't open passthrough connection to SA rc:", rc);
+                pt->fd = INVALID_HANDLE;
+            }
+        }
+        fd = pt->fd;
+    }
+
+    if (fd == INVALID_HANDLE)
+        return VSTATUS_TIMEOUT;
+
+    return if3_mngr_send_passthru_mad(fd, saMad, dataLength, returnMait, returnBuffer,
+                                      returnSize, returnStatus, NULL, NULL);
+}
+
+uint32_t fe_sa_passthrough(uint8_t *netbuf, FePassthru_t *pt){
 	OOBPacket *packet; 								/* The incoming packet */
 	OOBHeader *messageHeader; 						/* Header on the incoming and outgoing message */
 	SA_MAD* saMad;								 	/* Pointer to the incoming mad data to forward */
 	int badRequest = FE_SUCCESS;					/* Whether or not the FEC was naughty with their request */
 
-	IB_ENTER(__func__, netbuf, connList, 0, 0);
+	IB_ENTER(__func__, netbuf, pt, 0, 0);
 
 	/* Sort out the incoming information */
 	packet = (OOBPacket *) netbuf;
 	messageHeader = &(packet->Header);
 	saMad = (SA_MAD*) &(packet->MadData);
-	curConn = connList->conn;
+	pt->sendLen = 0;
 
 	/* Validate the request, if we don't support it, mark it as bad and ignore it */
 	switch(saMad->common.AttributeID){
@@ -358,22 +396,21 @@ uint32_t fe_sa_passthrough(uint8_t *netbuf, FE_ConnList *connList, IBhandle_t fd
 
 	/* Process the request */
 	if(badRequest) {
-        (void)fe_passthrough_send_failure_response(netbuf, connList, fd_sa, MAD_STATUS_SA_REQ_INVALID);
+        (void)fe_passthrough_send_failure_response(netbuf, pt, MAD_STATUS_SA_REQ_INVALID);
     } else {
 		SA_MAD* returnMad; 							/* Outgoing mad to send */
 		Mai_t returnMait; 							/* The Mai_t we are returned from the fabric query */
-		uint8_t* returnBuffer = g_fe_recv_buf; 	    /* Buffer to fill with the fabric query results */
+		uint8_t* returnBuffer = pt->recvBuf; 	    /* Buffer to fill with the fabric query results */
 		uint32_t returnSize = STL_BUF_RECV_SIZE;	/* Size of the returned results */
 		uint32_t returnStatus; 						/* Status of the fabric query */
-        Status_t rc = VSTATUS_TIMEOUT;
+        Status_t rc;
 
 		/* Send our mad and receive the response */
-		if(fd_sa == INVALID_HANDLE ||
-           (rc = if3_mngr_send_passthru_mad(fd_sa, saMad, messageHeader->Length, &returnMait, returnBuffer, &returnSize, &returnStatus, NULL, NULL)) != VSTATUS_OK){
+		if((rc = fe_passthrough_send_mad(pt, saMad, messageHeader->Length, &returnMait, returnBuffer, &returnSize, &returnStatus)) != VSTATUS_OK){
             returnStatus = (rc == VSTATUS_TIMEOUT) ? STL_MAD_STATUS_STL_SA_UNAVAILABLE : MAD_STATUS_BUSY;
 			IB_LOG_ERROR_FMT(__func__, "Sending request to manager failed. Mad error code: %x", returnStatus);
             /* Mad was not sent, so use generic Mad status error */
-            (void)fe_passthrough_send_failure_response(netbuf, connList, fd_sa, (uint16)returnStatus);
+            (void)fe_passthrough_send_failure_response(netbuf, pt, (uint16)returnStatus);
             return FE_NO_COMPLETE;
 		}
 		
@@ -387,7 +424,7 @@ uint32_t fe_sa_passthrough(uint8_t *netbuf, FE_ConnList *connList, IBhandle_t fd
 
 		/* Build the out of band packet and copy the response into it */
 		/* There's no need to bswap the data, as that will be done by the FEC on the other side */
-		packet = (OOBPacket *) g_fe_oob_send_buf;
+		packet = (OOBPacket *) pt->sendBuf;
 		memset(packet, 0, sizeof(OOBPacket));
 		returnMad = (SA_MAD*) &(packet->MadData);
 
@@ -406,39 +443,34 @@ uint32_t fe_sa_passthrough(uint8_t *netbuf, FE_ConnList *connList, IBhandle_t fd
 		returnMad->SaHdr = *((SA_HDR*)(returnMait.data + sizeof(RMPP_HEADER)));
 		memcpy(&(returnMad->Data), returnBuffer, returnSize);
 
-		/* Forward the response to the FEC*/
-		if(fe_send_packet(curConn, g_fe_oob_send_buf, sizeof(OOBHeader) + IBA_SUBN_ADM_HDRSIZE + returnSize)){
-			IB_LOG_WARN_FMT(__func__, "Unable to send response packet");
-			badRequest = FE_NO_COMPLETE;
-			return badRequest;
-		}
+		/* The caller forwards the response to the FEC */
+		pt->sendLen = sizeof(OOBHeader) + IBA_SUBN_ADM_HDRSIZE + returnSize;
 	}
 
 	IB_EXIT(__func__, badRequest);
 	return badRequest;
 }
 
-uint32_t fe_pa_passthrough(uint8_t* netbuf, FE_ConnList* connList, IBhandle_t fd_sa){
-	NetConnection *curConn; 						/* Pointer to the current connection */
+uint32_t fe_pa_passthrough(uint8_t* netbuf, FePassthru_t *pt){
 	OOBPacket *packet; 								/* The incoming packet */
 	OOBHeader *messageHeader; 						/* Header on the incoming and outgoing message */
 	SA_MAD* saMad;								 	/* Pointer to the incoming mad data to forward */
 	int badRequest = FE_SUCCESS;					/* Whether or not the FEC was naughty with their request */
 	SA_MAD* returnMad; 								/* Outgoing mad to send */
 	Mai_t returnMait; 								/* The Mai_t we are returned from the fabric query */
-	uint8_t* returnBuffer = g_fe_recv_buf; 		    /* Buffer to fill with the fabric query results */
+	uint8_t* returnBuffer = pt->recvBuf; 		    /* Buffer to fill with the fabric query results */
 	uint32_t returnSize = STL_BUF_RECV_SIZE;		/* Size of the returned results */
 	uint32_t returnStatus; 							/* Status of the fabric query */
 	uint32_t dataLength;
-    Status_t rc = VSTATUS_TIMEOUT;
+    Status_t rc;
 
-	IB_ENTER(__func__, netbuf, connList, 0, 0);
+	IB_ENTER(__func__, netbuf, pt, 0, 0);
 
 	/* Sort out the incoming information */
 	packet = (OOBPacket *) netbuf;
 	messageHeader = &(packet->Header);
 	saMad = (SA_MAD*) &(packet->MadData);
-	curConn = connList->conn;
+	pt->sendLen = 0;
 	dataLength = messageHeader->Length - IBA_SUBN_ADM_HDRSIZE;
 
 	/* If our request doesn't have enough data to hold an SA_MAD with no data, something is wrong with it */
@@ -449,12 +481,11 @@ uint32_t fe_pa_passthrough(uint8_t* netbuf, FE_ConnList* connList, IBhandle_t fd
 	}
 
 	/* Send our mad and receive the response */
-	if(fd_sa == INVALID_HANDLE ||
-       (rc = if3_mngr_send_passthru_mad(fd_sa, saMad, dataLength, &returnMait, returnBuffer, &returnSize, &returnStatus, NULL, NULL)) != VSTATUS_OK){
+	if((rc = fe_passthrough_send_mad(pt, saMad, dataLength, &returnMait, returnBuffer, &returnSize, &returnStatus)) != VSTATUS_OK){
         returnStatus = (rc == VSTATUS_TIMEOUT) ? STL_MAD_STATUS_STL_PA_UNAVAILABLE : MAD_STATUS_BUSY;
         IB_LOG_ERROR_FMT(__func__, "Sending request to manager failed. Mad error code: %x", returnStatus);
         /* Mad was not sent, so use generic Mad status error */
-        (void)fe_passthrough_send_failure_response(netbuf, connList, fd_sa, (uint16)returnStatus);
+        (void)fe_passthrough_send_failure_response(netbuf, pt, (uint16)returnStatus);
         return FE_NO_COMPLETE;
 	}
 
@@ -468,7 +499,7 @@ uint32_t fe_pa_passthrough(uint8_t* netbuf, FE_ConnList* connList, IBhandle_t fd
 
 	/* Build the out of band packet and copy the response into it */
 	/* There's no need to bswap the data, as that will be done by the FEC on the other side */
-	packet = (OOBPacket *) g_fe_oob_send_buf;
+	packet = (OOBPacket *) pt->sendBuf;
 	memset(packet, 0, sizeof(OOBPacket));
 	returnMad = (SA_MAD*) &(packet->MadData);
 
@@ -487,12 +518,8 @@ uint32_t fe_pa_passthrough(uint8_t* netbuf, FE_ConnList* connList, IBhandle_t fd
 	returnMad->SaHdr = *((SA_HDR*)(returnMait.data + sizeof(RMPP_HEADER)));
 	memcpy(&(returnMad->Data), returnBuffer, returnSize);
 
-	/* Forward the response to the FEC*/
-	if(fe_send_packet(curConn, g_fe_oob_send_buf, sizeof(OOBHeader) + IBA_SUBN_ADM_HDRSIZE + returnSize)){
-		IB_LOG_WARN_FMT(__func__, "Unable to send response packet");
-		badRequest = FE_NO_COMPLETE;
-		return badRequest;
-	}
+	/* The caller forwards the response to the FEC */
+	pt->sendLen = sizeof(OOBHeader) + IBA_SUBN_ADM_HDRSIZE + returnSize;
 
 	IB_EXIT(__func__, badRequest);
 	return badRequest;
@@ -53,6 +53,21 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "fe.h"
 #include "sa/if3_sa.h"
 
+/*
+ * Buffers a passthrough request is answered in.  The FE thread and each
+ * passthrough worker have their own set.  A worker also has its own
+ * connection to the SA, so workers never share an RMPP connection with each
+ * other or with the FE thread's fdsa.
+ */
+typedef struct _FePassthru {
+    uint8_t     *sendBuf;           /* response packet, STL_BUF_OOB_SEND_SIZE  */
+    uint8_t     *recvBuf;           /* fabric query data, STL_BUF_RECV_SIZE    */
+    int32_t     sendLen;            /* length of response in sendBuf, 0 = none */
+    uint8_t     ownCnx;             /* use fd rather than fdsa                 */
+    IBhandle_t  fd;                 /* worker's SA connection, opened on use   */
+    uint32_t    fdGen;              /* fe_sa_generation when fd was opened     */
+} FePassthru_t;
+
 /* Variables    */
 extern uint8_t *g_fe_oob_send_buf;
 extern uint8_t *g_fe_recv_buf;
@@ -61,9 +76,11 @@ extern Pool_t fe_pool;
 /* Function Prototypes */
 uint32_t fe_vieo_init(uint8_t *);
 void fe_shutdown(void);
-uint32_t fe_sa_passthrough(uint8_t *, FE_ConnList *, IBhandle_t);
-uint32_t fe_pa_passthrough(uint8_t *, FE_ConnList *, IBhandle_t);
+uint32_t fe_sa_passthrough(uint8_t *, FePassthru_t *);
+uint32_t fe_pa_passthrough(uint8_t *, FePassthru_t *);
+void fe_passthrough_close(FePassthru_t *);
 uint32_t fe_unsolicited(FE_ConnList *, uint32_t *);
+uint32_t fe_send_packet(NetConnection *, uint8_t *, int32_t);
 uint32_t fe_get_config_file_checksum(NetConnection *conn, uint32_t mid);
 uint32_t fe_get_config_file_timestamp(NetConnection *conn, uint32_t mid);
 
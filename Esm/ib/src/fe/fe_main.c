@@ -82,6 +82,7 @@ NetConnection   *dconn          = NULL;    /* Ptr to debug connection       */
 NetConnection   *conn           = NULL;    /* Anchor ptr to conn structs    */
 FE_ConnList     *clist          = NULL;    /* Pointer to connection list    */
 IBhandle_t      fdsa,fd_pm,fd_dm;          /* Manager Handles               */
+uint32_t        fe_sa_generation;          /* Bumped whenever fdsa closes   */
 uint8_t         *g_fe_oob_send_buf;                 /* Ptr to net send buffer        */
 int32_t         pm_lid;                    /* Lid of PM                     */
 int32_t         dm_lid;                    /* Lid of DM                     */
@@ -127,6 +128,56 @@ uint32_t    fe_consistency_checksum = 0;
 // XML debug tracing
 static uint32_t xml_trace = 0;
 
+// passthrough buffers of the FE thread
+static FePassthru_t fe_passthru;
+
+//
+// Passthrough worker pool.  When configured, the FE thread hands SA and PA
+// passthrough requests to a fixed set of worker threads and goes straight
+// back to its sockets.  All requests from one connection go to the same
+// worker, so each client still gets its responses in request order.  The
+// workers return responses tagged with the connection id; the FE thread
+// sends them, or drops them if the connection has since closed.
+//
+#define FE_WORKER_MAX_THREADS	8
+#define FE_WORKER_QUEUE_DEPTH	16
+#define FE_WORKER_STACK_SIZE	(256 * 1024)
+
+typedef struct {
+	int				connId;
+	int				len;
+	uint8_t			*data;			// request, freed by the worker
+} FeWorkerRequest_t;
+
+typedef struct _FeWorkerReply {
+	struct _FeWorkerReply	*next;
+	int						connId;
+	int32_t					len;
+	uint8_t					data[1];
+} FeWorkerReply_t;
+
+typedef struct {
+	Thread_t			handle;
+	Lock_t				lock;		// protects head and count
+	Sema_t				sema;		// one count per queued request
+	FeWorkerRequest_t	queue[FE_WORKER_QUEUE_DEPTH];
+	uint32_t			head;
+	uint32_t			count;
+	FePassthru_t		pt;
+} FeWorker_t;
+
+typedef struct {
+	uint32_t			threads;
+	uint32_t			exit;
+	Sema_t				doneSema;
+	Lock_t				replyLock;	// protects the reply list
+	FeWorkerReply_t		*replyHead;
+	FeWorkerReply_t		*replyTail;
+	FeWorker_t			workers[FE_WORKER_MAX_THREADS];
+} FeWorkerPool_t;
+
+static FeWorkerPool_t fe_worker_pool;
+
 #ifndef __VXWORKS__
 Pool_t   fe_xml_pool;               /* Mem pool for FE XML parsing defined net.c */
 #endif
@@ -242,19 +293,15 @@ void fe_init_globals(void)
     //
 }
 
-uint32_t fe_process_passthrough(uint8_t *netbuf, int buflen, FE_ConnList *clist) {
+uint32_t fe_process_passthrough(uint8_t *netbuf, int buflen, FePassthru_t *pt) {
 	OOBPacket* message; 				/* Pointer to the incoming packet */
 	uint32_t rc; 						/* Return code */
 	
-	IB_ENTER(__func__, netbuf, clist, 0, 0);
+	IB_ENTER(__func__, netbuf, pt, 0, 0);
 	IB_LOG_INFO0("Passthrough packet received");
 
 	rc = FE_SUCCESS;
-
-	if(!clist) {
-		rc = FE_FATAL;
-		return rc;
-	}
+	pt->sendLen = 0;
 
 	/* If the buffer is empty, return */
 	if(netbuf == NULL){
@@ -276,10 +323,10 @@ uint32_t fe_process_passthrough(uint8_t *netbuf, int buflen, FE_ConnList *clist)
 	/* Process message type and route to the apropriate manager */
 	switch(message->MadData.common.MgmtClass) {
 	case MCLASS_SUBN_ADM: 			/* SA */
-		rc = fe_sa_passthrough(netbuf, clist, fdsa);
+		rc = fe_sa_passthrough(netbuf, pt);
 		break;
 	case MCLASS_VFI_PM: 			/* PA */
-		rc = fe_pa_passthrough(netbuf, clist, fdsa);
+		rc = fe_pa_passthrough(netbuf, pt);
 		break;
     default:
 		rc = FE_NO_COMPLETE;
@@ -290,6 +337,266 @@ uint32_t fe_process_passthrough(uint8_t *netbuf, int buflen, FE_ConnList *clist)
 	return(rc);
 }
 
+// argc is the worker index.
+static void fe_worker(uint32_t argc, uint8_t **argv) {
+	FeWorkerPool_t		*pool = &fe_worker_pool;
+	FeWorker_t			*worker = &pool->workers[argc];
+	FeWorkerRequest_t	req;
+	FeWorkerReply_t		*reply;
+	uint32_t			rc;
+
+	for (;;) {
+		if (cs_psema(&worker->sema) != VSTATUS_OK)
+			continue;
+
+		if (pool->exit)
+			break;
+
+		(void)vs_lock(&worker->lock);
+		req = worker->queue[worker->head];
+		worker->head = (worker->head + 1) % FE_WORKER_QUEUE_DEPTH;
+		worker->count--;
+		(void)vs_unlock(&worker->lock);
+
+		if ((rc = fe_process_passthrough(req.data, req.len, &worker->pt)))
+			IB_LOG_ERROR("ProcCmd error:", rc);
+		fe_net_free_buf((char *)req.data);
+		if (worker->pt.sendLen == 0)
+			continue;
+
+		if (vs_pool_alloc(&fe_pool, sizeof(FeWorkerReply_t) + worker->pt.sendLen,
+						  (void *)&reply) != VSTATUS_OK) {
+			IB_LOG_ERROR("can't allocate passthrough response for connection", req.connId);
+			continue;
+		}
+		reply->next = NULL;
+		reply->connId = req.connId;
+		reply->len = worker->pt.sendLen;
+		memcpy(reply->data, worker->pt.sendBuf, reply->len);
+
+		(void)vs_lock(&pool->replyLock);
+		if (pool->replyTail)
+			pool->replyTail->next = reply;
+		else
+			pool->replyHead = reply;
+		pool->replyTail = reply;
+		(void)vs_unlock(&pool->replyLock);
+
+		fe_net_wake();
+	}
+
+	(void)cs_vsema(&pool->doneSema);
+}
+
+static void fe_worker_free(FeWorker_t *worker) {
+	fe_passthrough_close(&worker->pt);
+	if (worker->pt.sendBuf)
+		(void)vs_pool_free(&fe_pool, worker->pt.sendBuf);
+	if (worker->pt.recvBuf)
+		(void)vs_pool_free(&fe_pool, worker->pt.recvBuf);
+	memset(worker, 0, sizeof(*worker));
+}
+
+static Status_t fe_workers_start(uint32_t threads) {
+	FeWorkerPool_t	*pool = &fe_worker_pool;
+	FeWorker_t		*worker;
+	Status_t		status;
+	uint32_t		i;
+
+	IB_ENTER(__func__, threads, 0, 0, 0);
+
+	memset(pool, 0, sizeof(*pool));
+
+#ifdef __VXWORKS__
+	threads = 0;
+#endif
+	if (threads == 0) {
+		IB_EXIT(__func__, VSTATUS_OK);
+		return VSTATUS_OK;
+	}
+	if (threads > FE_WORKER_MAX_THREADS)
+		threads = FE_WORKER_MAX_THREADS;
+
+	if ((status = cs_sema_create(&pool->doneSema, 0)) != VSTATUS_OK) {
+		IB_LOG_ERRORRC("can't create FE worker pool semaphore rc:", status);
+		IB_EXIT(__func__, status);
+		return status;
+	}
+	if ((status = vs_lock_init(&pool->replyLock, VLOCK_FREE, VLOCK_THREAD)) != VSTATUS_OK) {
+		IB_LOG_ERRORRC("can't initialize FE worker pool lock rc:", status);
+		(void)cs_sema_delete(&pool->doneSema);
+		IB_EXIT(__func__, status);
+		return status;
+	}
+
+	for (i = 0; i < threads; i++) {
+		worker = &pool->workers[i];
+		worker->pt.ownCnx = 1;
+		worker->pt.fd = INVALID_HANDLE;
+
+		status = vs_pool_alloc(&fe_pool, STL_BUF_OOB_SEND_SIZE, (void *)&worker->pt.sendBuf);
+		if (status == VSTATUS_OK)
+			status = vs_pool_alloc(&fe_pool, STL_BUF_RECV_SIZE, (void *)&worker->pt.recvBuf);
+		if (status != VSTATUS_OK) {
+			IB_LOG_WARNRC("can't allocate FE worker buffers, continuing with fewer workers rc:", status);
+			fe_worker_free(worker);
+			break;
+		}
+
+		if ((status = vs_lock_init(&worker->lock, VLOCK_FREE, VLOCK_THREAD)) != VSTATUS_OK) {
+			IB_LOG_WARNRC("can't initialize FE worker lock, continuing with fewer workers rc:", status);
+			fe_worker_free(worker);
+			break;
+		}
+
+		if ((status = cs_sema_create(&worker->sema, 0)) != VSTATUS_OK) {
+			IB_LOG_WARNRC("can't create FE worker semaphore, continuing with fewer workers rc:", status);
+			(void)vs_lock_delete(&worker->lock);
+			fe_worker_free(worker);
+			break;
+		}
+
+		status = vs_thread_create(&worker->handle, (unsigned char *)"feworker",
+								  fe_worker, i, NULL, FE_WORKER_STACK_SIZE);
+		if (status != VSTATUS_OK) {
+			IB_LOG_WARNRC("can't create FE worker thread, continuing with fewer workers rc:", status);
+			(void)cs_sema_delete(&worker->sema);
+			(void)vs_lock_delete(&worker->lock);
+			fe_worker_free(worker);
+			break;
+		}
+		pool->threads++;
+	}
+
+	if (pool->threads == 0) {
+		(void)vs_lock_delete(&pool->replyLock);
+		(void)cs_sema_delete(&pool->doneSema);
+	} else {
+		IB_LOG_INFINI_INFO("FE worker threads:", pool->threads);
+	}
+
+	IB_EXIT(__func__, VSTATUS_OK);
+	return VSTATUS_OK;
+}
+
+static void fe_workers_stop(void) {
+	FeWorkerPool_t	*pool = &fe_worker_pool;
+	FeWorker_t		*worker;
+	FeWorkerReply_t	*reply;
+	uint32_t		i;
+
+	if (pool->threads == 0)
+		return;
+
+	pool->exit = 1;
+	for (i = 0; i < pool->threads; i++)
+		(void)cs_vsema(&pool->workers[i].sema);
+	for (i = 0; i < pool->threads; i++)
+		(void)cs_psema(&pool->doneSema);
+
+	for (i = 0; i < pool->threads; i++) {
+		worker = &pool->workers[i];
+		for (; worker->count; worker->count--) {
+			fe_net_free_buf((char *)worker->queue[worker->head].data);
+			worker->head = (worker->head + 1) % FE_WORKER_QUEUE_DEPTH;
+		}
+		(void)cs_sema_delete(&worker->sema);
+		(void)vs_lock_delete(&worker->lock);
+		fe_worker_free(worker);
+	}
+	while ((reply = pool->replyHead) != NULL) {
+		pool->replyHead = reply->next;
+		(void)vs_pool_free(&fe_pool, reply);
+	}
+	(void)vs_lock_delete(&pool->replyLock);
+	(void)cs_sema_delete(&pool->doneSema);
+	pool->threads = 0;
+}
+
+static FeWorker_t *fe_worker_for(NetConnection *conn) {
+	FeWorkerPool_t	*pool = &fe_worker_pool;
+
+	if (pool->threads == 0)
+		return NULL;
+	return &pool->workers[(uint32_t)conn->id % pool->threads];
+}
+
+//
+// Whether conn's worker has no room for another request.  The request is
+// then left queued on the connection until the worker catches up.
+//
+static int fe_worker_busy(NetConnection *conn) {
+	FeWorker_t	*worker = fe_worker_for(conn);
+	int			busy;
+
+	if (!worker)
+		return 0;
+
+	(void)vs_lock(&worker->lock);
+	busy = (worker->count >= FE_WORKER_QUEUE_DEPTH);
+	(void)vs_unlock(&worker->lock);
+	return busy;
+}
+
+//
+// Hand a request to conn's worker, which takes ownership of netbuf.
+// Returns 0 if the FE thread must process the request itself.
+//
+static int fe_worker_dispatch(uint8_t *netbuf, int buflen, NetConnection *conn) {
+	FeWorker_t			*worker = fe_worker_for(conn);
+	FeWorkerRequest_t	*req;
+
+	if (!worker)
+		return 0;
+
+	(void)vs_lock(&worker->lock);
+	if (worker->count >= FE_WORKER_QUEUE_DEPTH) {
+		(void)vs_unlock(&worker->lock);
+		return 0;
+	}
+	req = &worker->queue[(worker->head + worker->count) % FE_WORKER_QUEUE_DEPTH];
+	req->connId = conn->id;
+	req->len = buflen;
+	req->data = netbuf;
+	worker->count++;
+	(void)vs_unlock(&worker->lock);
+
+	(void)cs_vsema(&worker->sema);
+	return 1;
+}
+
+//
+// Send the responses the workers have completed to their connections.
+//
+static void fe_workers_reply(FE_ConnList *clist) {
+	FeWorkerPool_t	*pool = &fe_worker_pool;
+	FeWorkerReply_t	*reply, *next;
+	FE_ConnList		*tlist;
+
+	if (pool->threads == 0)
+		return;
+
+	(void)vs_lock(&pool->replyLock);
+	reply = pool->replyHead;
+	pool->replyHead = pool->replyTail = NULL;
+	(void)vs_unlock(&pool->replyLock);
+
+	for (; reply; reply = next) {
+		next = reply->next;
+		for (tlist = clist; tlist; tlist = tlist->next) {
+			if (tlist->conn->id == reply->connId)
+				break;
+		}
+		if (tlist && tlist->state != BAD_CONN) {
+			if (fe_send_packet(tlist->conn, reply->data, reply->len))
+				IB_LOG_WARN_FMT(__func__, "Unable to send response packet");
+		} else {
+			IB_LOG_INFO("dropping passthrough response for closed connection", reply->connId);
+		}
+		(void)vs_pool_free(&fe_pool, reply);
+	}
+}
+
 int fe_main()
 {
     uint32_t        error; 
@@ -376,6 +683,9 @@ int fe_main()
         Shutdown = 1;           // bail
     }
 
+    if (!Shutdown)
+        (void)fe_workers_start(fe_config.worker_threads); 
+
     // set flag to indicate that the connection to the SA is valid, in order
     // to avoid repeating registering with the SA unnessarily.
     if (fdsa != INVALID_HANDLE)
@@ -440,19 +750,35 @@ int fe_main()
         }
         
         
+        // send responses the passthrough workers have completed
+        fe_workers_reply(clist); 
+        
         //
         // check queue for new msgs
         tlist = clist; 
         while (tlist && !Shutdown) {
+            if (fe_worker_busy(tlist->conn)) {
+                // leave the request on the connection until the worker catches up
+                tlist = tlist->next; 
+                continue;
+            }
             fe_net_get_next_message(tlist->conn, &netbuf, &buflen, NULL); 
-            if (netbuf) 
-				if ((error = fe_process_passthrough((void *)netbuf, buflen, tlist))) {
-                    if (error == FE_UNLOGGED) {
-                        IB_LOG_ERROR0("Connection not logged in");
-                    } else {
-                        IB_LOG_ERROR("ProcCmd error:", error);
+            if (netbuf) {
+                if (fe_worker_dispatch((uint8_t *)netbuf, buflen, tlist->conn)) {
+                    netbuf = NULL;  // the worker frees it
+                } else {
+                    if ((error = fe_process_passthrough((void *)netbuf, buflen, &fe_passthru))) {
+                        if (error == FE_UNLOGGED) {
+                            IB_LOG_ERROR0("Connection not logged in");
+                        } else {
+                            IB_LOG_ERROR("ProcCmd error:", error);
+                        }
+                    }
+                    if (fe_passthru.sendLen && fe_send_packet(tlist->conn, fe_passthru.sendBuf, fe_passthru.sendLen)) {
+                        IB_LOG_WARN_FMT(__func__, "Unable to send response packet");
                     }
                 }
+            }
             fe_net_free_buf(netbuf); 
             tlist = tlist->next;
         }
@@ -502,6 +828,7 @@ int fe_main()
                 fe_if3_unsubscribe_sa(FALSE);  // this will just delete the trap filters
                 if3_close(fdsa);    // release management structure and related file descriptors
                 fdsa = INVALID_HANDLE; 
+                fe_sa_generation++;     // passthrough workers drop their connections too
                 endtime = timenow + fe_config.manager_check_rate; 
                 continue;
             } else if (saHasMoved) {
@@ -517,6 +844,7 @@ int fe_main()
                 fe_if3_unsubscribe_sa(FALSE);  // this will just delete the trap filters
                 if3_close(fdsa);    // release management structure and related file descriptors
                 fdsa = INVALID_HANDLE; 
+                fe_sa_generation++; 
                 endtime = timenow + fe_config.manager_check_rate; 
                 IB_LOG_INFINI_INFO0("SM/SA have moved, will resync if a few seconds"); 
                 continue;
@@ -529,8 +857,9 @@ int fe_main()
                 continue;
             }
             
-            if (Shutdown) 
+            if (Shutdown) {
                 break; 
+            }
 
 			// Attempt to reconnect to each of the managers if we don't have a valid connection
             if (!sa_valid_con) {
@@ -573,6 +902,7 @@ int fe_main()
     
     //
     // perform shutdown of the FE
+    fe_workers_stop(); 
     fe_shutdown(); 
     
 #ifdef IB_STACK_OPENIB
@@ -647,7 +977,7 @@ void fe_compute_pool_size(void)
 #else
 	// this really doesn't matter since only VxWorks pools are limited in size
 			// add an extra 10% to be safe
-	g_fePoolSize = ((buf_recv_size + buf_oob_send_size)*11)/10;
+	g_fePoolSize = ((buf_recv_size + buf_oob_send_size)*(1 + fe_config.worker_threads)*11)/10;
 	// in addition to in_buff, prts and lnks, the pool is used for:
 	//		MFT for 1 switch (FV query - 1 per FV)
 	//		LFT for 1 switch (FV query - 1 per FV))
@@ -689,6 +1019,8 @@ uint32_t fe_init(void)
     } else if ((rc = vs_pool_alloc(&fe_pool, STL_BUF_RECV_SIZE, (void *)&g_fe_recv_buf)) != VSTATUS_OK) {
         IB_FATAL_ERROR("fe_init: failed to allocate g_fe_recv_buf from fe_pool");
     }
+    fe_passthru.sendBuf = g_fe_oob_send_buf;
+    fe_passthru.recvBuf = g_fe_recv_buf;
     
 #ifndef __VXWORKS__
 	sprintf(buf, "FE: Using: HFI %u Port %u PortGuid "FMT_U64,
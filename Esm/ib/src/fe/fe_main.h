@@ -131,6 +131,7 @@ extern uint32_t        fe_lnks_size;
 extern int             fe_rmpp_usrid;
 extern Pool_t fe_pool; /* Pointer to Fab_exec memory pool */
 extern IBhandle_t fdsa; /* Handle used in speaking to SA */ 
+extern uint32_t fe_sa_generation; /* Bumped whenever fdsa is closed */
 
 #define STL_BUF_RECV_SIZE       (fe_in_buff_size + fe_prts_size + fe_lnks_size)
 #define STL_BUF_OOB_SEND_SIZE   (fe_in_buff_size + fe_prts_size + fe_lnks_size)
@@ -0,0 +1,4 @@
+include Makefile
+include build.ALL_EMB.release/libnet.c.dep
+include build.ALL_EMB.release/netblob.c.dep
+include build.ALL_EMB.release/netqueue.c.dep
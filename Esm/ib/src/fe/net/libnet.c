@@ -56,6 +56,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #else
 #include <memory.h>
 #endif
+#ifdef __LINUX__
+#include <sys/epoll.h>
+#include <fcntl.h>
+#endif
 #include "ib_types.h"
 #include "ib_status.h"
 #include "vs_g.h"
@@ -74,6 +78,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define MAX(x,y) ((x)>(y)?(x):(y))
 #endif
 
+/* NetConnection events flags */
+#define NET_EVENT_READ  0x01
+#define NET_EVENT_WRITE 0x02
+
+#define NET_EPOLL_EVENTS 32
+
 extern uint8_t fe_is_thread(void);
 extern const struct in6_addr in6addr_any;
 extern FEXmlConfig_t fe_config;
@@ -85,6 +95,15 @@ static int G_numConnections_;
 static int G_connectCount;
 static NetConnection *G_connections_;
 static void *G_sslContext_ = NULL;
+#ifdef __LINUX__
+/*
+ * The listen socket, the wake pipe and every connection are registered with
+ * one epoll instance.  Connections carry their NetConnection in data.ptr;
+ * the listen socket and the wake pipe are told apart by address.
+ */
+static int G_epollFd_ = -1;
+static int G_wakePipe_[2] = { -1, -1 };
+#endif
 
 /* Function prototypes  */
 static void (*DisconnectCallBack) (NetConnection *) = NULL;
@@ -96,6 +115,13 @@ static void HandleReadWriteError (NetConnection *);
 static void AddToConnectionList (NetConnection *);
 static void RemoveFromConnectionList (NetConnection *);
 static void CloseSock (SOCKET_t);
+static int WaitForEvents (int, int, int *);
+#ifdef __LINUX__
+static int InitEpoll (void);
+static void CloseEpoll (void);
+static int EpollControl (NetConnection *, int, uint32_t);
+static void SetNonBlocking (int);
+#endif
 
 
 int fe_net_init(int port, NetError *err, void (*Callback)(NetConnection *))
@@ -228,6 +254,20 @@ int fe_net_init(int port, NetError *err, void (*Callback)(NetConnection *))
         G_listenSock_ = INVALID_SOCKET;
     }
 
+#ifdef __LINUX__
+    if (InitEpoll() != NET_OK) {
+        SET_ERROR (err, NET_INTERNAL_ERR);
+        if (G_listenSock_ != INVALID_SOCKET) {
+            CloseSock (G_listenSock_);
+            G_listenSock_ = INVALID_SOCKET;
+        }
+        fprintf(stderr,"\nfe_net_init error creating epoll instance %d\n", (int)*err);
+        IB_LOG_ERROR("error creating epoll instance err:", (int)*err);
+        IB_EXIT(__func__,err);
+        return(NET_FAILED);
+    }
+#endif
+
     G_numConnections_ = 0;
     G_connections_ = NULL;
     G_initted_ = 1;
@@ -253,6 +293,9 @@ int fe_net_disconnect(NetConnection *conn, NetError *err)
         return(NET_FAILED);
     }
 
+#ifdef __LINUX__
+    (void)EpollControl (conn, EPOLL_CTL_DEL, 0);
+#endif
     CloseSock (conn->sock);
     conn->sock = INVALID_SOCKET;
 
@@ -392,15 +435,134 @@ void fe_net_get_next_message(NetConnection * conn, char **data, int *len, NetErr
 
 NetConnection* fe_net_process(int msecToWait, int blocking)
 {
-    int             n, nfds;
     NetConnection   *conn;
     NetConnection   *retval = NULL;
+    uint32_t        events;
+    int             listenReady = 0;
+
+    IB_ENTER(__func__,msecToWait,blocking,0,0);
+
+    if (msecToWait < 0) {
+        msecToWait = 0;
+    }
+    if (!WaitForEvents (msecToWait, blocking, &listenReady)) {
+        IB_EXIT(__func__, retval);
+        return(NULL);
+    }
+    if (listenReady) {
+#if defined(__VXWORKS__)
+        if (G_connections_ != NULL)
+            vs_thread_sleep(VTIMER_1S / 100);
+#endif
+        retval = AcceptConnection();
+    }
+
+    /*
+     * The OpenSSL interface does not reliably support the return of
+     * correct results from the standard socket fd_isset() routine, so a
+     * flag must be used to indicate that outstanding inbound/outbound
+     * data is ready to be processed on the socket. 
+     */ 
+    for (conn = G_connections_; conn; conn = conn->next) {
+        events = conn->events;
+        conn->events = 0;
+        if ((events & NET_EVENT_READ) || (conn->blobInProgress && conn->sslSession)) {
+            if (ReadFromSocket (conn) == NET_FAILED) {
+                conn->err = 1;
+                continue;     /* don't bother trying to write */
+            }
+        }
+        if ((events & NET_EVENT_WRITE) || !fe_net_queue_empty (&conn->sendQueue)) {
+            if (WriteToSocket (conn) == NET_FAILED) {
+                conn->err = 1;
+            }
+        }
+    }
+
+    /*
+     * Handle errs here so we don't hassle with removing from 
+     * conn list while iterating
+     */
+    conn = G_connections_;
+    while (conn) {
+        if (conn->err) {
+            HandleReadWriteError (conn);
+            conn = G_connections_;    /* start over */
+        }
+        else {
+            conn = conn->next;
+        }
+    }
+
+    IB_EXIT(__func__, retval);
+    return retval;
+}
+
+/*
+ * Wait up to msecToWait for the listen socket or any connection to become
+ * ready, recording the ready events of each connection in conn->events.
+ * Returns 0 if there is nothing to process.
+ */
+#ifdef __LINUX__
+static int WaitForEvents(int msecToWait, int blocking, int *listenReady) {
+    struct epoll_event  events[NET_EPOLL_EVENTS];
+    NetConnection       *conn;
+    uint32_t            want;
+    int                 i, n;
+    int                 inprogressData = 0;
+    char                drain[64];
+
+    /*
+     * Connections are level triggered and only armed for EPOLLOUT while
+     * they have traffic queued, so an idle writable socket never wakes us.
+     */
+    for (conn = G_connections_; conn; conn = conn->next) {
+        want = EPOLLIN;
+        if (!fe_net_queue_empty (&conn->sendQueue)) {
+            want |= EPOLLOUT;
+        }
+        if (want != conn->armed && EpollControl (conn, EPOLL_CTL_MOD, want) != NET_OK) {
+            conn->err = 1;
+        }
+        if (conn->blobInProgress && conn->sslSession) {
+            inprogressData++;
+        }
+    }
+    if (G_listenSock_ == INVALID_SOCKET && G_connections_ == NULL && !blocking) {
+        return 0;
+    }
+
+    n = epoll_wait (G_epollFd_, events, NET_EPOLL_EVENTS, msecToWait);
+    if (n == SOCKET_ERROR) {
+        return 0;
+    }
+    for (i = 0; i < n; i++) {
+        if (events[i].data.ptr == (void *)&G_listenSock_) {
+            *listenReady = 1;
+        } else if (events[i].data.ptr == (void *)G_wakePipe_) {
+            while (read (G_wakePipe_[0], drain, sizeof(drain)) > 0)
+                ;
+        } else {
+            conn = (NetConnection *)events[i].data.ptr;
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                conn->events |= NET_EVENT_READ;
+            }
+            if (events[i].events & EPOLLOUT) {
+                conn->events |= NET_EVENT_WRITE;
+            }
+        }
+    }
+
+    return (n > 0 || inprogressData);
+}
+#else
+static int WaitForEvents(int msecToWait, int blocking, int *listenReady) {
+    int             n, nfds;
+    NetConnection   *conn;
     FDSET_t          readfds, writefds, errorfds;
     int queuedData = 0, inprogressData=0;
     struct timeval  timeout;
 
-    IB_ENTER(__func__,msecToWait,blocking,0,0);
-
     /*
      * Do a select on the listen socket (to catch new connections),
      * on all in-bound sockets, and on those out-bound sockets for
@@ -432,80 +594,39 @@ NetConnection* fe_net_process(int msecToWait, int blocking)
          * flag must be used to indicate that outstanding data is on the
          * socket ready to be read. 
          */ 
-        if (conn->blobInProgress) {
+        if (conn->blobInProgress && conn->sslSession) {
             inprogressData++;
         }
     }
     if ((nfds == 0) && !blocking) {
-        IB_EXIT(__func__, retval);
-        return(NULL);
+        return 0;
     }
     ++nfds;
 
-    if (msecToWait < 0) {
-        msecToWait = 0;
-    }
     timeout.tv_sec = msecToWait / 1000;
     timeout.tv_usec = (msecToWait % 1000) * 1000;
     n = SELECT (nfds, &readfds, &writefds, &errorfds, &timeout);
     if (n == SOCKET_ERROR) {
-        IB_EXIT(__func__, retval);
-        return(NULL);
+        return 0;
     }
     if (n == 0 && !inprogressData) {
-        IB_EXIT(__func__, retval);
-        return(NULL);
+        return 0;
     }
-    if (G_listenSock_ != INVALID_SOCKET) {
-        if (FD_ISSET (G_listenSock_, &readfds)) {
-#if defined(__VXWORKS__)
-			if (G_connections_ != NULL)
-				vs_thread_sleep(VTIMER_1S / 100);
-#endif
-            retval = AcceptConnection();
-        }
+    if (G_listenSock_ != INVALID_SOCKET && FD_ISSET (G_listenSock_, &readfds)) {
+        *listenReady = 1;
     }
-
-    /*
-     * The OpenSSL interface does not reliably support the return of
-     * correct results from the standard socket fd_isset() routine, so a
-     * flag must be used to indicate that outstanding inbound/outbound
-     * data is ready to be processed on the socket. 
-     */ 
     for (conn = G_connections_; conn; conn = conn->next) {
-        if (FD_ISSET (conn->sock, &readfds) || conn->blobInProgress) {
-            if (ReadFromSocket (conn) == NET_FAILED) {
-                conn->err = 1;
-                continue;     /* don't bother trying to write */
-            }
+        if (FD_ISSET (conn->sock, &readfds)) {
+            conn->events |= NET_EVENT_READ;
         }
-        if (FD_ISSET (conn->sock, &writefds) || !fe_net_queue_empty (&conn->sendQueue)) {
-#ifdef RFR
-#endif
-            if (WriteToSocket (conn) == NET_FAILED) {
-                conn->err = 1;
-            }
+        if (FD_ISSET (conn->sock, &writefds)) {
+            conn->events |= NET_EVENT_WRITE;
         }
     }
 
-    /*
-     * Handle errs here so we don't hassle with removing from 
-     * conn list while iterating
-     */
-    conn = G_connections_;
-    while (conn) {
-        if (conn->err) {
-            HandleReadWriteError (conn);
-            conn = G_connections_;    /* start over */
-        }
-        else {
-            conn = conn->next;
-        }
-    }
-
-    IB_EXIT(__func__, retval);
-    return retval;
+    return 1;
 }
+#endif
 
 static int ReadFromSocket(NetConnection *conn) {
     int     bytesRead;
@@ -545,6 +666,11 @@ static int ReadFromSocket(NetConnection *conn) {
         return(NET_FAILED);
     }
     else if (bytesRead == SOCKET_ERROR) {
+        if (!conn->sslSession && (errno == EAGAIN || errno == WSAEWOULDBLOCK)) {
+            /* non-blocking socket drained; continue next time */
+            IB_EXIT(__func__, rc);
+            return(NET_OK);
+        }
         IB_LOG_VERBOSE("error ", errno);
         IB_LOG_VERBOSE("bytes Read", bytesRead);
         IB_LOG_VERBOSE("connection", conn->id);
@@ -784,6 +910,24 @@ static NetConnection* AcceptConnection() {
     conn->id = G_numConnections_++;
     conn->addr = addr;
 
+#ifdef __LINUX__
+    /*
+     * SSL/TLS sessions may need several socket reads per record, so their
+     * sockets stay blocking and rely on blobInProgress as before.
+     */
+    if (!sslSession) {
+        SetNonBlocking (sock);
+    }
+    if (EpollControl (conn, EPOLL_CTL_ADD, EPOLLIN) != NET_OK) {
+        IB_LOG_ERROR("Unable to add connection to epoll sock:", sock);
+        CloseSock(sock);
+        if (sslSession) (void)if3_ssl_sess_close(sslSession);
+        vs_pool_free(&fe_pool, (void *)conn);
+        IB_EXIT(__func__, 0);
+        return(NULL);
+    }
+#endif
+
     AddToConnectionList (conn);
 
     IB_LOG_VERBOSE("Accepted IPv6 Connection ", conn->id);
@@ -896,6 +1040,10 @@ int fe_net_shutdown(void) {
         CloseSock(conn->sock);
     }
 
+#ifdef __LINUX__
+    CloseEpoll();
+#endif
+
 #ifdef __VXWORKS__
     G_numConnections_ = 0;
     G_connections_ = NULL;
@@ -907,6 +1055,89 @@ int fe_net_shutdown(void) {
     return NET_NO_ERROR;
 }
     
+/*
+ * Wake a thread blocked in fe_net_process().  May be called from any thread.
+ */
+void fe_net_wake(void) {
+#ifdef __LINUX__
+    char c = 0;
+
+    /* a full pipe already has a wakeup pending */
+    if (G_wakePipe_[1] != -1 && write (G_wakePipe_[1], &c, 1) == SOCKET_ERROR
+        && errno != EAGAIN) {
+        IB_LOG_VERBOSE("wake write failed errno:", errno);
+    }
+#endif
+}
+
+#ifdef __LINUX__
+static int InitEpoll(void) {
+    struct epoll_event ev;
+
+    G_epollFd_ = epoll_create1 (EPOLL_CLOEXEC);
+    if (G_epollFd_ == -1) {
+        return NET_FAILED;
+    }
+    if (pipe (G_wakePipe_)) {
+        G_wakePipe_[0] = G_wakePipe_[1] = -1;
+        CloseEpoll();
+        return NET_FAILED;
+    }
+    SetNonBlocking (G_wakePipe_[0]);
+    SetNonBlocking (G_wakePipe_[1]);
+
+    memset (&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = (void *)G_wakePipe_;
+    if (epoll_ctl (G_epollFd_, EPOLL_CTL_ADD, G_wakePipe_[0], &ev)) {
+        CloseEpoll();
+        return NET_FAILED;
+    }
+    if (G_listenSock_ != INVALID_SOCKET) {
+        ev.data.ptr = (void *)&G_listenSock_;
+        if (epoll_ctl (G_epollFd_, EPOLL_CTL_ADD, G_listenSock_, &ev)) {
+            CloseEpoll();
+            return NET_FAILED;
+        }
+    }
+    return NET_OK;
+}
+
+static void CloseEpoll(void) {
+    if (G_wakePipe_[0] != -1) {
+        close (G_wakePipe_[0]);
+        close (G_wakePipe_[1]);
+        G_wakePipe_[0] = G_wakePipe_[1] = -1;
+    }
+    if (G_epollFd_ != -1) {
+        close (G_epollFd_);
+        G_epollFd_ = -1;
+    }
+}
+
+static int EpollControl(NetConnection *conn, int op, uint32_t events) {
+    struct epoll_event ev;
+
+    memset (&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = (void *)conn;
+    if (epoll_ctl (G_epollFd_, op, conn->sock, &ev)) {
+        IB_LOG_VERBOSE("epoll_ctl failed errno:", errno);
+        return NET_FAILED;
+    }
+    conn->armed = events;
+    return NET_OK;
+}
+
+static void SetNonBlocking(int fd) {
+    int flags = fcntl (fd, F_GETFL, 0);
+
+    if (flags == -1 || fcntl (fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        IB_LOG_WARN("unable to make descriptor non-blocking errno:", errno);
+    }
+}
+#endif
+
 static void CloseSock(SOCKET_t sock) {
     IB_ENTER(__func__,sock,0,0,0);
 
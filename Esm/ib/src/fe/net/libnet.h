@@ -153,6 +153,8 @@ struct NetConnection_t {
     uint8_t *fe_in_buff;            /* input buffer (cache) for connection  */
     uint32_t fe_nodes_len;          /* len of node data in cache            */
     void * sslSession;
+    uint32_t events;                /* NET_EVENT_* seen in this pass        */
+    uint32_t armed;                 /* events registered with epoll         */
 };
 typedef struct NetConnection_t NetConnection;
 
@@ -211,5 +213,6 @@ EXT NetConnection * fe_net_process(int msecToWait, int blocking);
 EXT int fe_net_send(NetConnection * conn, char * data, int len, NetError * err);
 EXT void fe_net_get_next_message(NetConnection * conn, char ** data, int * len,
                             NetError * err);
+EXT void fe_net_wake(void);
 void fe_net_inet_ntop(NetConnection *conn, char *str, int slen);
 #endif
@@ -0,0 +1,2 @@
+include Makefile
+include build.ALL_EMB.release/if3_sa.c.dep
@@ -0,0 +1,8 @@
+include Makefile
+include build.ALL_EMB.release/cs_info_file.c.dep
+include build.ALL_EMB.release/cs_mad_openib.c.dep
+include build.ALL_EMB.release/vs_evt.c.dep
+include build.ALL_EMB.release/vs_lck.c.dep
+include build.ALL_EMB.release/vs_pool.c.dep
+include build.ALL_EMB.release/vs_thr.c.dep
+include build.ALL_EMB.release/vs_utility.c.dep
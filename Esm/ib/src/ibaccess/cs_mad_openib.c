@@ -34,6 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <if3.h>
              
 #include "oib_utils.h"
+#include "cs_sim.h"
 #include <ib_mad.h>
 #include <ib_sa.h>
 #include <iba/ib_pa.h>
@@ -221,6 +222,12 @@ ib_init_devport(uint32_t *devp, uint32_t *portp, uint64_t *Guidp)
 		return status;
 	}
 	
+	if (cs_sim_enabled()) {
+		status = cs_sim_open((Guidp != NULL) ? *Guidp : 0ULL, portp, Guidp);
+		if (status == VSTATUS_OK && devp != NULL) *devp = 0;
+		IB_EXIT(__func__, status);
+		return status;
+	}
 
 	if (Guidp != NULL && *Guidp != 0ULL) {
 		status = oib_open_port_by_guid(&g_port_handle, *Guidp);
@@ -273,6 +280,10 @@ ib_refresh_devport(void)
 {
 	IB_ENTER(__func__, 0, 0, 0, 0);
 	
+	if (cs_sim_enabled()) {
+		IB_EXIT(__func__, VSTATUS_OK);
+		return VSTATUS_OK;
+	}
 	if (oib_mad_refresh_port_pkey(g_port_handle) < 0) {
 		IB_LOG_ERROR_FMT(__func__,
 		       "Failed to refresh UMAD pkeys");
@@ -291,7 +302,8 @@ Status_t ib_shutdown(void)
 	IB_ENTER(__func__, 0, 0, 0, 0);
 	
 	ib_disable_is_sm();
-	oib_close_port(g_port_handle);
+	if (!cs_sim_enabled())
+		oib_close_port(g_port_handle);
 	g_port_handle = NULL;
 	
 	IB_EXIT(__func__, 0);
@@ -306,6 +318,9 @@ ib_register_sm(int queue_size)
 {
 	FSTATUS status;
 
+	if (cs_sim_enabled())
+		return VSTATUS_OK;
+
 	status = oib_bind_classes(g_port_handle, sm_class_args);
 	if (status != FSUCCESS) {
 		IB_LOG_ERROR("Failed to register management classes;",
@@ -328,6 +343,11 @@ ib_register_fe(int queue_size, uint8_t thread)
 
 	IB_ENTER(__func__, 0, 0, 0, 0);
 
+	if (cs_sim_enabled()) {
+		IB_EXIT(__func__, VSTATUS_OK);
+		return VSTATUS_OK;
+	}
+
 	status = oib_bind_classes(g_port_handle, (thread) ? fe_class_args : fe_proc_class_args);
 	if (status != FSUCCESS) {
 		IB_LOG_ERROR("Failed to register FE management classes;",
@@ -351,6 +371,11 @@ ib_register_pm(int queue_size)
 	
 	IB_ENTER(__func__, 0, 0, 0, 0);
 
+	if (cs_sim_enabled()) {
+		IB_EXIT(__func__, VSTATUS_OK);
+		return VSTATUS_OK;
+	}
+
 	status = oib_bind_classes(g_port_handle, pm_class_args);
 	if (status != FSUCCESS) {
 		IB_LOG_ERROR("Failed to register PM management classes;",
@@ -400,7 +425,10 @@ ib_recv_sma(IBhandle_t handle, Mai_t *mai, uint64_t timeout)
    memset (&addr, 0, sizeof(addr));
    retry:
    do {
-	  status = oib_recv_mad_alloc(g_port_handle, &buf, &len, timeout, &addr);
+	  if (cs_sim_enabled())
+		 status = cs_sim_recv(&buf, &len, timeout, &addr);
+	  else
+		 status = oib_recv_mad_alloc(g_port_handle, &buf, &len, timeout, &addr);
    } 
    while (status == FNOT_DONE);
     
@@ -553,7 +581,10 @@ ib_send_sma(IBhandle_t handle, Mai_t * mai, uint64_t timeout)
 	addr.qkey = mai->addrInfo.qkey;
 	addr.pkey = mai->addrInfo.pkey;
 	addr.sl = mai->addrInfo.sl;
-	status = oib_send_mad2(g_port_handle, (void*)buf, IB_MAX_MAD_DATA, &addr, adjusted_timeout, 0);
+	if (cs_sim_enabled())
+		status = cs_sim_send(buf, IB_MAX_MAD_DATA, &addr, adjusted_timeout);
+	else
+		status = oib_send_mad2(g_port_handle, (void*)buf, IB_MAX_MAD_DATA, &addr, adjusted_timeout, 0);
 	if (status != FSUCCESS) {
 		if (mai->addrInfo.srcqp != 1) {
 			IB_LOG_INFO("Error sending packet via OPENIB interface; status:", status);
@@ -628,7 +659,10 @@ stl_send_sma(IBhandle_t handle, Mai_t * mai, uint64_t timeout)
 	addr.pkey = mai->addrInfo.pkey;
 	addr.sl = mai->addrInfo.sl;
 	//IB_LOG_INFINI_INFO_FMT(__func__, "Sending MAD of size %d bytes", bufLen);
-	status = oib_send_mad2(g_port_handle, (void*)buf, bufLen, &addr, adjusted_timeout, 0);
+	if (cs_sim_enabled())
+		status = cs_sim_send(buf, bufLen, &addr, adjusted_timeout);
+	else
+		status = oib_send_mad2(g_port_handle, (void*)buf, bufLen, &addr, adjusted_timeout, 0);
 	if (status != FSUCCESS) {
 		if (mai->addrInfo.srcqp != 1) {
 			IB_LOG_INFO("Error sending packet via OPENIB interface; status:", status);
@@ -660,7 +694,11 @@ ib_attach_sma(int16_t dev, int8_t port, uint32_t qpn,
 	if (handlep != NULL)
 		*handlep = IB_MAKEHANDLE(dev, port);
 	
-	if (nodeTypep != NULL)
+	if (nodeTypep != NULL && cs_sim_enabled())
+	{
+		*nodeTypep = STL_NODE_FI;
+	}
+	else if (nodeTypep != NULL)
 	{
 		status = oib_get_hfi_node_type(g_port_handle, &type);
 		if (status == FSUCCESS)
@@ -723,6 +761,12 @@ Status_t ib_enable_is_sm(void)
 	
 	IB_ENTER(__func__, 0, 0, 0, 0);
 	
+	if (cs_sim_enabled()) {
+		cs_sim_set_is_sm(1);
+		IB_EXIT(__func__, VSTATUS_OK);
+		return VSTATUS_OK;
+	}
+
 	status = vs_lock(&ib_issm.lock);
 	if (status != VSTATUS_OK) {
 		vs_unlock(&ib_issm.lock);
@@ -763,6 +807,12 @@ Status_t ib_disable_is_sm(void)
 	Status_t status;
 	IB_ENTER(__func__, 0, 0, 0, 0);
 	
+	if (cs_sim_enabled()) {
+		cs_sim_set_is_sm(0);
+		IB_EXIT(__func__, VSTATUS_OK);
+		return VSTATUS_OK;
+	}
+
 	status = vs_lock(&ib_issm.lock);
 	if (status != VSTATUS_OK) {
 		IB_LOG_WARNRC("failed to acquire issm lock; rc:", status);
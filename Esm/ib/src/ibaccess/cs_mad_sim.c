@@ -0,0 +1,1304 @@
+/* BEGIN_ICS_COPYRIGHT2 ****************************************
+
+Copyright (c) 2015, Intel Corporation
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Intel Corporation nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ * ** END_ICS_COPYRIGHT2   ****************************************/
+
+//=======================================================================
+//
+// FILE NAME
+//    cs_mad_sim.c
+//
+// DESCRIPTION
+//    MAD transport for a simulated fabric.  Outbound MADs are routed
+//    through the fabric built by cs_sim_fabric.c and answered by an
+//    in-process SMA or PMA on the target node; the answer is queued
+//    with a due time of twice the path length times the configured
+//    per-link latency and handed back by cs_sim_recv().  MADs which
+//    would be lost on a link, or which have nobody to answer them, come
+//    back as timeouts exactly as oib_recv_mad_alloc() reports them.
+//
+//    MADs the FM sends to its own port (SMInfo, SA and PA requests and
+//    every response) are looped back as inbound MADs.  Traps are never
+//    generated; the SM has to find fabric changes by sweeping.
+//
+//=======================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <ib_macros.h>
+#include <iba/ib_generalServices.h>
+#include "cs_sim.h"
+#include <mal_g.h>
+
+#define	CS_SIM_FLITS_PER_USEC	1562	// 4x 25G, 8 byte flits
+#define	CS_SIM_FLITS_PER_PKT	32
+#define	CS_SIM_MAX_LID			0x100000
+
+// a MAD waiting to be returned by cs_sim_recv()
+typedef struct cs_sim_event {
+	uint64_t		due;			// usec, vs_time_get
+	uint64_t		seq;			// keeps equal due times in send order
+	FSTATUS			status;			// FSUCCESS or FTIMEOUT
+	uint8_t			*buf;			// handed to the caller, who frees it
+	size_t			len;
+	struct oib_mad_addr	addr;
+} cs_sim_event_t;
+
+static struct {
+	int				enabled;
+	uint32_t		hopLatency;		// usec, one way per link
+	uint32_t		lossPpm;		// per link traversal
+	uint64_t		rng;
+	cs_sim_fabric_t	fabric;
+	pthread_mutex_t	lock;
+	pthread_cond_t	cond;
+	cs_sim_event_t	*heap;			// min heap on (due, seq)
+	uint32_t		heapLen;
+	uint32_t		heapCap;
+	uint64_t		seq;
+} cs_sim = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+static uint64_t
+cs_sim_now(void)
+{
+	uint64_t now;
+
+	(void)vs_time_get(&now);
+	return now;
+}
+
+// xorshift64*, good enough to decide which MADs get dropped
+static uint32_t
+cs_sim_rand(void)
+{
+	cs_sim.rng ^= cs_sim.rng >> 12;
+	cs_sim.rng ^= cs_sim.rng << 25;
+	cs_sim.rng ^= cs_sim.rng >> 27;
+	return (uint32_t)((cs_sim.rng * 2685821657736338717ull) >> 32);
+}
+
+// a round trip over hops links loses the MAD or its response
+static int
+cs_sim_lost(uint32_t hops)
+{
+	uint32_t i;
+
+	if (!cs_sim.lossPpm)
+		return 0;
+	for (i = 0; i < 2 * hops; i++) {
+		if (cs_sim_rand() % 1000000 < cs_sim.lossPpm)
+			return 1;
+	}
+	return 0;
+}
+
+//==============================================================================
+// event queue
+//==============================================================================
+static int
+cs_sim_event_before(cs_sim_event_t *a, cs_sim_event_t *b)
+{
+	return a->due < b->due || (a->due == b->due && a->seq < b->seq);
+}
+
+// queues buf, which is owned by the queue from here on
+static void
+cs_sim_queue(FSTATUS status, uint8_t *buf, size_t len, struct oib_mad_addr *addr,
+			 uint64_t due)
+{
+	cs_sim_event_t ev, tmp;
+	uint32_t i, parent;
+
+	if (cs_sim.heapLen == cs_sim.heapCap) {
+		uint32_t newCap = cs_sim.heapCap ? cs_sim.heapCap * 2 : 256;
+		cs_sim_event_t *newHeap = realloc(cs_sim.heap, newCap * sizeof(*newHeap));
+		if (newHeap == NULL) {
+			IB_LOG_ERROR0("can't grow simulated fabric event queue");
+			free(buf);
+			return;
+		}
+		cs_sim.heap = newHeap;
+		cs_sim.heapCap = newCap;
+	}
+
+	ev.due = due;
+	ev.seq = cs_sim.seq++;
+	ev.status = status;
+	ev.buf = buf;
+	ev.len = len;
+	ev.addr = *addr;
+
+	i = cs_sim.heapLen++;
+	cs_sim.heap[i] = ev;
+	while (i > 0) {
+		parent = (i - 1) / 2;
+		if (!cs_sim_event_before(&cs_sim.heap[i], &cs_sim.heap[parent]))
+			break;
+		tmp = cs_sim.heap[i];
+		cs_sim.heap[i] = cs_sim.heap[parent];
+		cs_sim.heap[parent] = tmp;
+		i = parent;
+	}
+	(void)pthread_cond_broadcast(&cs_sim.cond);
+}
+
+static void
+cs_sim_pop(cs_sim_event_t *evp)
+{
+	cs_sim_event_t tmp;
+	uint32_t i = 0, child;
+
+	*evp = cs_sim.heap[0];
+	cs_sim.heap[0] = cs_sim.heap[--cs_sim.heapLen];
+	for (;;) {
+		child = 2 * i + 1;
+		if (child >= cs_sim.heapLen)
+			break;
+		if (child + 1 < cs_sim.heapLen
+			&& cs_sim_event_before(&cs_sim.heap[child + 1], &cs_sim.heap[child]))
+			child++;
+		if (!cs_sim_event_before(&cs_sim.heap[child], &cs_sim.heap[i]))
+			break;
+		tmp = cs_sim.heap[i];
+		cs_sim.heap[i] = cs_sim.heap[child];
+		cs_sim.heap[child] = tmp;
+		i = child;
+	}
+}
+
+// the request comes back to the caller as a timeout, as oib_utils does
+static void
+cs_sim_queue_timeout(uint8_t *req, size_t len, struct oib_mad_addr *addr, int timeout_ms)
+{
+	uint8_t *buf;
+
+	if (timeout_ms <= 0)
+		return;
+	buf = malloc(len);
+	if (buf == NULL)
+		return;
+	memcpy(buf, req, len);
+	cs_sim_queue(FTIMEOUT, buf, len, addr, cs_sim_now() + (uint64_t)timeout_ms * 1000);
+}
+
+// a MAD sent to the FM's own port arrives as an inbound MAD
+static void
+cs_sim_queue_loopback(uint8_t *req, size_t len, struct oib_mad_addr *addr, uint8_t mclass)
+{
+	struct oib_mad_addr in;
+	uint8_t *buf;
+
+	buf = malloc(len);
+	if (buf == NULL)
+		return;
+	memcpy(buf, req, len);
+	memset(&in, 0, sizeof(in));
+	in.lid = cs_sim.fabric.local->ports[cs_sim.fabric.localPort].portInfo.LID;
+	in.qpn = (mclass == MCLASS_SM_LID_ROUTED || mclass == MCLASS_SM_DIRECTED_ROUTE) ? 0 : 1;
+	in.qkey = addr->qkey;
+	in.pkey = addr->pkey;
+	in.sl = addr->sl;
+	cs_sim_queue(FSUCCESS, buf, len, &in, cs_sim_now());
+}
+
+//==============================================================================
+// LIDs and routing
+//==============================================================================
+static cs_sim_port_t *
+cs_sim_lid_owner(uint32_t lid)
+{
+	if (lid == 0 || lid >= cs_sim.fabric.lidCap)
+		return NULL;
+	return cs_sim.fabric.lids[lid];
+}
+
+static void
+cs_sim_set_lid(cs_sim_port_t *portp, uint32_t oldLid, uint8_t oldLmc,
+			   uint32_t newLid, uint8_t newLmc)
+{
+	cs_sim_fabric_t *fabricp = &cs_sim.fabric;
+	uint32_t lid, top;
+
+	top = oldLid + (1 << oldLmc);
+	for (lid = oldLid; oldLid && lid < top && lid < fabricp->lidCap; lid++) {
+		if (fabricp->lids[lid] == portp)
+			fabricp->lids[lid] = NULL;
+	}
+
+	top = newLid + (1 << newLmc);
+	if (newLid == 0 || top > CS_SIM_MAX_LID)
+		return;
+	if (top > fabricp->lidCap) {
+		uint32_t newCap = fabricp->lidCap ? fabricp->lidCap : 1024;
+		cs_sim_port_t **newLids;
+
+		while (newCap < top)
+			newCap *= 2;
+		newLids = realloc(fabricp->lids, newCap * sizeof(*newLids));
+		if (newLids == NULL) {
+			IB_LOG_ERROR("can't grow simulated LID table to", newCap);
+			return;
+		}
+		memset(newLids + fabricp->lidCap, 0, (newCap - fabricp->lidCap) * sizeof(*newLids));
+		fabricp->lids = newLids;
+		fabricp->lidCap = newCap;
+	}
+	for (lid = newLid; lid < top; lid++)
+		fabricp->lids[lid] = portp;
+}
+
+// a link carries SMPs once trained and everything else once active
+static int
+cs_sim_link_up(cs_sim_port_t *portp, uint8_t minState)
+{
+	cs_sim_port_t *nbrp;
+
+	if (portp->nbrp == NULL || portp->portInfo.PortStates.s.PortState < minState)
+		return 0;
+	nbrp = &portp->nbrp->ports[portp->nbrPort];
+	return nbrp->portInfo.PortStates.s.PortState >= minState;
+}
+
+//==============================================================================
+// cs_sim_route_lid
+//
+// follows the forwarding tables from nodep, which the MAD entered through
+// *ingressp, to the owner of dlid.  Returns the node reached and updates
+// *ingressp and *hopsp, or NULL if the MAD is dropped on the way.
+//==============================================================================
+static cs_sim_node_t *
+cs_sim_route_lid(cs_sim_node_t *nodep, cs_sim_port_t **ingressp, uint32_t dlid,
+				 uint8_t minState, uint32_t *hopsp)
+{
+	cs_sim_port_t *ownerp = cs_sim_lid_owner(dlid);
+	cs_sim_port_t *egressp;
+	uint32_t hops;
+	uint8_t port;
+
+	if (ownerp == NULL)
+		return NULL;
+
+	for (hops = 0; hops <= CS_SIM_MAX_HOPS; hops++) {
+		if (ownerp->nodep == nodep) {
+			*hopsp += hops;
+			return nodep;
+		}
+		if (nodep->nodeInfo.NodeType == STL_NODE_SW) {
+			if (nodep->lft == NULL || dlid > nodep->switchInfo.LinearFDBTop
+				|| dlid >= nodep->switchInfo.LinearFDBCap)
+				return NULL;
+			port = nodep->lft[dlid];
+			if (port == 0 || port > nodep->nodeInfo.NumPorts)
+				return NULL;
+			egressp = &nodep->ports[port];
+		} else if (hops == 0) {
+			// an HFI only ever sends out of the port the MAD is sent on
+			egressp = *ingressp;
+		} else {
+			return NULL;
+		}
+		if (!cs_sim_link_up(egressp, minState))
+			return NULL;
+		*ingressp = &egressp->nbrp->ports[egressp->nbrPort];
+		nodep = egressp->nbrp;
+	}
+	return NULL;
+}
+
+//==============================================================================
+// port state machine
+//==============================================================================
+static void
+cs_sim_update_neighbor_normal(cs_sim_node_t *nodep, cs_sim_port_t *portp)
+{
+	cs_sim_port_t *nbrp;
+	uint8_t state = portp->portInfo.PortStates.s.PortState;
+
+	if (portp->portNum == 0) {
+		portp->portInfo.PortStates.s.NeighborNormal = (state >= IB_PORT_ARMED);
+		return;
+	}
+	if (portp->nbrp == NULL) {
+		portp->portInfo.PortStates.s.NeighborNormal = 0;
+		return;
+	}
+	nbrp = &portp->nbrp->ports[portp->nbrPort];
+	portp->portInfo.PortStates.s.NeighborNormal = nbrp->portInfo.PortStates.s.NeighborNormal =
+		(state >= IB_PORT_ARMED && nbrp->portInfo.PortStates.s.PortState >= IB_PORT_ARMED);
+}
+
+// the link retrains and both ends come back in Init
+static void
+cs_sim_bounce_link(cs_sim_node_t *nodep, cs_sim_port_t *portp)
+{
+	cs_sim_port_t *nbrp;
+
+	portp->portInfo.PortStates.s.PortState = IB_PORT_INIT;
+	portp->portInfo.PortStates.s.NeighborNormal = 0;
+	if (nodep->nodeInfo.NodeType == STL_NODE_SW)
+		nodep->switchInfo.u1.s.PortStateChange = 1;
+	if (portp->nbrp == NULL)
+		return;
+	nbrp = &portp->nbrp->ports[portp->nbrPort];
+	nbrp->portInfo.PortStates.s.PortState = IB_PORT_INIT;
+	nbrp->portInfo.PortStates.s.NeighborNormal = 0;
+	if (portp->nbrp->nodeInfo.NodeType == STL_NODE_SW)
+		portp->nbrp->switchInfo.u1.s.PortStateChange = 1;
+}
+
+// returns 0 or the MAD status for a transition the port can't make
+static uint16_t
+cs_sim_set_port_state(cs_sim_node_t *nodep, cs_sim_port_t *portp, uint8_t newState)
+{
+	uint8_t state = portp->portInfo.PortStates.s.PortState;
+
+	switch (newState) {
+	case IB_PORT_NOP:
+		return 0;
+	case IB_PORT_DOWN:
+		if (state >= IB_PORT_INIT && portp->portNum != 0)
+			cs_sim_bounce_link(nodep, portp);
+		return 0;
+	case IB_PORT_ARMED:
+		if (state != IB_PORT_INIT && state != IB_PORT_ARMED)
+			return MAD_STATUS_INVALID_ATTRIB;
+		break;
+	case IB_PORT_ACTIVE:
+		if (state != IB_PORT_ACTIVE
+			&& (state != IB_PORT_ARMED || !portp->portInfo.PortStates.s.NeighborNormal))
+			return MAD_STATUS_INVALID_ATTRIB;
+		break;
+	default:
+		return MAD_STATUS_INVALID_ATTRIB;
+	}
+	if (state != IB_PORT_ACTIVE && newState == IB_PORT_ACTIVE)
+		portp->ctrs.lastUpdate = cs_sim_now();
+	portp->portInfo.PortStates.s.PortState = newState;
+	cs_sim_update_neighbor_normal(nodep, portp);
+	return 0;
+}
+
+//==============================================================================
+// cs_sim_set_port_info
+//
+// takes what the SM may write from a Set(PortInfo), keeps everything the
+// port itself owns, then applies the requested state change
+//==============================================================================
+static uint16_t
+cs_sim_set_port_info(cs_sim_node_t *nodep, cs_sim_port_t *portp, STL_PORT_INFO *reqp,
+					 int smConfigStarted)
+{
+	STL_PORT_INFO *pip = &portp->portInfo;
+	STL_PORT_INFO old = *pip;
+	size_t ro = offsetof(STL_PORT_INFO, IPAddrIPV6);
+
+	*pip = *reqp;
+	memcpy((uint8_t *)pip + ro, (uint8_t *)&old + ro, sizeof(*pip) - ro);
+	pip->PortStates = old.PortStates;
+	pip->VL.s2.Cap = old.VL.s2.Cap;
+	pip->VL.ArbitrationHighCap = old.VL.ArbitrationHighCap;
+	pip->VL.ArbitrationLowCap = old.VL.ArbitrationLowCap;
+	pip->PortPhyConfig = old.PortPhyConfig;
+	pip->NeighborPortNum = old.NeighborPortNum;
+	pip->LinkSpeed.Supported = old.LinkSpeed.Supported;
+	pip->LinkSpeed.Active = old.LinkSpeed.Active;
+	pip->LinkWidth.Supported = old.LinkWidth.Supported;
+	pip->LinkWidth.Active = old.LinkWidth.Active;
+	pip->LinkWidthDowngrade.Supported = old.LinkWidthDowngrade.Supported;
+	pip->LinkWidthDowngrade.TxActive = old.LinkWidthDowngrade.TxActive;
+	pip->LinkWidthDowngrade.RxActive = old.LinkWidthDowngrade.RxActive;
+	pip->PortLinkMode.s.Supported = old.PortLinkMode.s.Supported;
+	pip->PortLinkMode.s.Active = old.PortLinkMode.s.Active;
+	pip->PortLTPCRCMode.s.Supported = old.PortLTPCRCMode.s.Supported;
+	pip->PortLTPCRCMode.s.Active = old.PortLTPCRCMode.s.Active;
+	pip->PortPacketFormats.Supported = old.PortPacketFormats.Supported;
+	pip->FlitControl.Interleave.s.DistanceSupported = old.FlitControl.Interleave.s.DistanceSupported;
+	pip->FlitControl.Interleave.s.MaxNestLevelRxSupported =
+		old.FlitControl.Interleave.s.MaxNestLevelRxSupported;
+	pip->FlitControl.Preemption.MaxSmallPktLimit = old.FlitControl.Preemption.MaxSmallPktLimit;
+	pip->BufferUnits.s.VL15Init = old.BufferUnits.s.VL15Init;
+	pip->BufferUnits.s.CreditAck = old.BufferUnits.s.CreditAck;
+	pip->BufferUnits.s.BufferAlloc = old.BufferUnits.s.BufferAlloc;
+
+	if (nodep->nodeInfo.NodeType == STL_NODE_SW && portp->portNum != 0) {
+		// only switch port 0 has a LID
+		pip->LID = old.LID;
+		pip->s1.LMC = old.s1.LMC;
+	} else if (pip->LID != old.LID || pip->s1.LMC != old.s1.LMC) {
+		cs_sim_set_lid(portp, old.LID, old.s1.LMC, pip->LID, pip->s1.LMC);
+	}
+	if (smConfigStarted)
+		pip->PortStates.s.IsSMConfigurationStarted = 1;
+
+	return cs_sim_set_port_state(nodep, portp, reqp->PortStates.s.PortState);
+}
+
+//==============================================================================
+// SMA
+//==============================================================================
+
+// the size a Get returns for a table attribute that was never Set
+static uint32_t
+cs_sim_attr_size(uint16_t aid, uint32_t amod, uint32_t maxLen)
+{
+	uint32_t n = MAX(amod >> 24, 1);
+
+	switch (aid) {
+	case STL_MCLASS_ATTRIB_ID_PART_TABLE:
+		return n * sizeof(STL_PARTITION_TABLE);
+	case STL_MCLASS_ATTRIB_ID_SL_SC_MAPPING_TABLE:
+		return sizeof(STL_SLSCMAP);
+	case STL_MCLASS_ATTRIB_ID_SC_SL_MAPPING_TABLE:
+		return sizeof(STL_SCSLMAP);
+	case STL_MCLASS_ATTRIB_ID_SC_SC_MAPPING_TABLE:
+		return n * sizeof(STL_SCSCMAP);
+	case STL_MCLASS_ATTRIB_ID_SC_VLR_MAPPING_TABLE:
+	case STL_MCLASS_ATTRIB_ID_SC_VLT_MAPPING_TABLE:
+	case STL_MCLASS_ATTRIB_ID_SC_VLNT_MAPPING_TABLE:
+		return n * sizeof(STL_SCVLMAP);
+	case STL_MCLASS_ATTRIB_ID_MCAST_FWD_TABLE:
+		return n * sizeof(STL_MULTICAST_FORWARDING_TABLE);
+	case STL_MCLASS_ATTRIB_ID_BUFFER_CONTROL_TABLE:
+		return n * ((sizeof(STL_BUFFER_CONTROL_TABLE) + 7) & ~7);
+	case STL_MCLASS_ATTRIB_ID_CONGESTION_INFO:
+		return sizeof(STL_CONGESTION_INFO);
+	case STL_MCLASS_ATTRIB_ID_LED_INFO:
+		return n * sizeof(STL_LED_INFO);
+	default:
+		return maxLen;
+	}
+}
+
+// attributes the simulator doesn't model: a Get returns the last Set
+static uint16_t
+cs_sim_sma_stored(cs_sim_node_t *nodep, uint8_t method, uint16_t aid, uint32_t amod,
+				  uint8_t *data, uint32_t reqLen, uint32_t maxLen, uint32_t *rspLenp)
+{
+	uint64_t key = ((uint64_t)aid << 32) | amod;
+	cl_map_item_t *mi = cl_qmap_get(&nodep->attrs, key);
+	cs_sim_attr_t *attrp;
+
+	if (method == MMTHD_SET) {
+		if (mi != cl_qmap_end(&nodep->attrs)) {
+			cl_qmap_remove_item(&nodep->attrs, mi);
+			free(PARENT_STRUCT(mi, cs_sim_attr_t, item));
+		}
+		attrp = malloc(sizeof(*attrp) + reqLen);
+		if (attrp == NULL)
+			return MAD_STATUS_BUSY;
+		attrp->len = reqLen;
+		memcpy(attrp->data, data, reqLen);
+		cl_qmap_insert(&nodep->attrs, key, &attrp->item);
+		*rspLenp = reqLen;
+		return 0;
+	}
+
+	if (mi == cl_qmap_end(&nodep->attrs)) {
+		*rspLenp = MIN(cs_sim_attr_size(aid, amod, maxLen), maxLen);
+		memset(data, 0, *rspLenp);
+		return 0;
+	}
+	attrp = PARENT_STRUCT(mi, cs_sim_attr_t, item);
+	*rspLenp = MIN(attrp->len, maxLen);
+	memcpy(data, attrp->data, *rspLenp);
+	return 0;
+}
+
+//==============================================================================
+// cs_sim_sma_attr
+//
+// processes one attribute of a Get or Set in place.  data is in network
+// byte order; *rspLenp is set to the size of the attribute returned.
+//==============================================================================
+static uint16_t
+cs_sim_sma_attr(cs_sim_node_t *nodep, cs_sim_port_t *ingressp, uint8_t method,
+				uint16_t aid, uint32_t amod, uint8_t *data, uint32_t reqLen,
+				uint32_t maxLen, uint32_t *rspLenp)
+{
+	int isSwitch = (nodep->nodeInfo.NodeType == STL_NODE_SW);
+	uint32_t i, n, start, len;
+	uint16_t status = 0, portStatus;
+
+	*rspLenp = 0;
+
+	switch (aid) {
+	case STL_MCLASS_ATTRIB_ID_NODE_INFO:
+		if (method != MMTHD_GET || maxLen < sizeof(STL_NODE_INFO))
+			return MAD_STATUS_UNSUPPORTED_METHOD_ATTRIB;
+		{
+			STL_NODE_INFO *nip = (STL_NODE_INFO *)data;
+			*nip = nodep->nodeInfo;
+			nip->u1.s.LocalPortNum = ingressp->portNum;
+			BSWAP_STL_NODE_INFO(nip);
+		}
+		*rspLenp = sizeof(STL_NODE_INFO);
+		return 0;
+
+	case STL_MCLASS_ATTRIB_ID_NODE_DESCRIPTION:
+		if (method != MMTHD_GET || maxLen < sizeof(STL_NODE_DESCRIPTION))
+			return MAD_STATUS_UNSUPPORTED_METHOD_ATTRIB;
+		memcpy(data, &nodep->nodeDesc, sizeof(STL_NODE_DESCRIPTION));
+		BSWAP_STL_NODE_DESCRIPTION((STL_NODE_DESCRIPTION *)data);
+		*rspLenp = sizeof(STL_NODE_DESCRIPTION);
+		return 0;
+
+	case STL_MCLASS_ATTRIB_ID_PORT_INFO:
+	case STL_MCLASS_ATTRIB_ID_PORT_STATE_INFO:
+		n = MAX(amod >> 24, 1);
+		start = amod & 0xff;
+		if (!isSwitch) {
+			// an HFI answers for the port the SMP came in on
+			start = ingressp->portNum;
+			n = 1;
+		}
+		len = n * ((aid == STL_MCLASS_ATTRIB_ID_PORT_INFO)
+				   ? sizeof(STL_PORT_INFO) : sizeof(STL_PORT_STATE_INFO));
+		if (start + n - 1 > nodep->nodeInfo.NumPorts || len > maxLen)
+			return MAD_STATUS_INVALID_ATTRIB;
+
+		for (i = 0; i < n; i++) {
+			cs_sim_port_t *portp = &nodep->ports[start + i];
+
+			if (aid == STL_MCLASS_ATTRIB_ID_PORT_INFO) {
+				STL_PORT_INFO *pip = (STL_PORT_INFO *)data + i;
+				if (method == MMTHD_SET) {
+					BSWAP_STL_PORT_INFO(pip);
+					portStatus = cs_sim_set_port_info(nodep, portp, pip, (amod & 0x200) != 0);
+					if (portStatus)
+						status = portStatus;
+				}
+				*pip = portp->portInfo;
+				pip->LocalPortNum = ingressp->portNum;
+				BSWAP_STL_PORT_INFO(pip);
+			} else {
+				STL_PORT_STATE_INFO *psip = (STL_PORT_STATE_INFO *)data + i;
+				if (method == MMTHD_SET) {
+					BSWAP_STL_PORT_STATE_INFO(psip, 1);
+					// per port failures show in the states returned
+					(void)cs_sim_set_port_state(nodep, portp, psip->PortStates.s.PortState);
+				}
+				psip->PortStates = portp->portInfo.PortStates;
+				psip->LinkWidthDowngradeTxActive = portp->portInfo.LinkWidthDowngrade.TxActive;
+				psip->LinkWidthDowngradeRxActive = portp->portInfo.LinkWidthDowngrade.RxActive;
+				BSWAP_STL_PORT_STATE_INFO(psip, 1);
+			}
+		}
+		*rspLenp = len;
+		return status;
+
+	case STL_MCLASS_ATTRIB_ID_SWITCH_INFO:
+		if (!isSwitch || maxLen < sizeof(STL_SWITCH_INFO))
+			return MAD_STATUS_UNSUPPORTED_METHOD_ATTRIB;
+		{
+			STL_SWITCH_INFO *sip = (STL_SWITCH_INFO *)data;
+			if (method == MMTHD_SET) {
+				STL_SWITCH_INFO old = nodep->switchInfo;
+
+				BSWAP_STL_SWITCH_INFO(sip);
+				nodep->switchInfo = *sip;
+				nodep->switchInfo.LinearFDBCap = old.LinearFDBCap;
+				nodep->switchInfo.MulticastFDBCap = old.MulticastFDBCap;
+				nodep->switchInfo.CollectiveCap = old.CollectiveCap;
+				nodep->switchInfo.PartitionEnforcementCap = old.PartitionEnforcementCap;
+				nodep->switchInfo.PortGroupCap = old.PortGroupCap;
+				nodep->switchInfo.RoutingMode.Supported = old.RoutingMode.Supported;
+				nodep->switchInfo.u2 = old.u2;
+				nodep->switchInfo.CapabilityMask = old.CapabilityMask;
+				// writing PortStateChange clears it
+				nodep->switchInfo.u1.s.PortStateChange = 0;
+			}
+			*sip = nodep->switchInfo;
+			BSWAP_STL_SWITCH_INFO(sip);
+		}
+		*rspLenp = sizeof(STL_SWITCH_INFO);
+		return 0;
+
+	case STL_MCLASS_ATTRIB_ID_LINEAR_FWD_TABLE:
+		if (!isSwitch)
+			return MAD_STATUS_UNSUPPORTED_METHOD_ATTRIB;
+		n = MAX(amod >> 24, 1);
+		start = (amod & 0x3ffff) * MAX_LFT_ELEMENTS_BLOCK;
+		len = n * MAX_LFT_ELEMENTS_BLOCK;
+		if (start + len > nodep->switchInfo.LinearFDBCap || len > maxLen)
+			return MAD_STATUS_INVALID_ATTRIB;
+		if (method == MMTHD_SET) {
+			if (nodep->lft == NULL) {
+				nodep->lft = malloc(nodep->switchInfo.LinearFDBCap);
+				if (nodep->lft == NULL)
+					return MAD_STATUS_BUSY;
+				memset(nodep->lft, 0xff, nodep->switchInfo.LinearFDBCap);
+			}
+			memcpy(nodep->lft + start, data, len);
+		} else if (nodep->lft) {
+			memcpy(data, nodep->lft + start, len);
+		} else {
+			memset(data, 0xff, len);
+		}
+		*rspLenp = len;
+		return 0;
+
+	case STL_MCLASS_ATTRIB_ID_AGGREGATE:
+		{
+			STL_AGGREGATE *segp = (STL_AGGREGATE *)data;
+			uint8_t *end = data + MIN(reqLen, maxLen);
+			uint32_t segLen, segRsp;
+
+			n = amod & 0xff;
+			for (i = 0; i < n; i++) {
+				if ((uint8_t *)segp->Data > end)
+					return MAD_STATUS_INVALID_ATTRIB;
+				BSWAP_STL_AGGREGATE_HEADER(segp);
+				segLen = segp->Result.s.RequestLength * 8;
+				if (segp->Data + segLen > end || segp->AttributeID == STL_MCLASS_ATTRIB_ID_AGGREGATE
+					|| cs_sim_sma_attr(nodep, ingressp, method, segp->AttributeID,
+									   segp->AttributeModifier, segp->Data, segLen,
+									   segLen, &segRsp)) {
+					// processing stops at the first segment in error
+					segp->Result.s.Error = 1;
+					BSWAP_STL_AGGREGATE_HEADER(segp);
+					break;
+				}
+				segp->Result.s.Error = 0;
+				BSWAP_STL_AGGREGATE_HEADER(segp);
+				segp = (STL_AGGREGATE *)(segp->Data + segLen);
+			}
+		}
+		*rspLenp = MIN(reqLen, maxLen);
+		return 0;
+
+	default:
+		return cs_sim_sma_stored(nodep, method, aid, amod, data, reqLen, maxLen, rspLenp);
+	}
+}
+
+//==============================================================================
+// cs_sim_smp
+//
+// routes an SMP and queues the response of the SMA it reaches
+//==============================================================================
+static void
+cs_sim_smp(uint8_t *req, size_t len, struct oib_mad_addr *addr, MAD_COMMON *hdrp, int timeout_ms)
+{
+	cs_sim_fabric_t *fabricp = &cs_sim.fabric;
+	cs_sim_node_t *nodep = fabricp->local;
+	cs_sim_port_t *ingressp = &fabricp->local->ports[fabricp->localPort];
+	struct oib_mad_addr rspAddr;
+	STL_SMP *smp;
+	uint8_t *rsp, *data;
+	uint32_t hops = 0, hdrLen, maxLen, reqLen, rspLen, i;
+	uint16_t status;
+	int dr = (hdrp->MgmtClass == MCLASS_SM_DIRECTED_ROUTE);
+
+	if (len > STL_MAD_BLOCK_SIZE)
+		goto noanswer;
+	rsp = calloc(1, STL_MAD_BLOCK_SIZE);
+	if (rsp == NULL)
+		goto noanswer;
+	memcpy(rsp, req, len);
+	smp = (STL_SMP *)rsp;
+
+	if (dr) {
+		uint32_t drSlid = ntoh32(smp->SmpExt.DirectedRoute.DrSLID);
+		uint32_t drDlid = ntoh32(smp->SmpExt.DirectedRoute.DrDLID);
+
+		// LR-DR: LID routed to the switch the directed part starts from
+		if (drSlid != STL_LID_PERMISSIVE) {
+			nodep = cs_sim_route_lid(nodep, &ingressp, addr->lid, IB_PORT_INIT, &hops);
+			if (nodep == NULL)
+				goto drop;
+		}
+		for (i = 1; i <= hdrp->u.DR.HopCount && i < 64; i++) {
+			uint8_t port = smp->SmpExt.DirectedRoute.InitPath[i];
+			cs_sim_port_t *egressp;
+
+			if (port == 0 || port > nodep->nodeInfo.NumPorts
+				|| (nodep->nodeInfo.NodeType != STL_NODE_SW && i > 1))
+				goto drop;
+			egressp = &nodep->ports[port];
+			if (!cs_sim_link_up(egressp, IB_PORT_INIT))
+				goto drop;
+			smp->SmpExt.DirectedRoute.RetPath[i] = egressp->nbrPort;
+			ingressp = &egressp->nbrp->ports[egressp->nbrPort];
+			nodep = egressp->nbrp;
+			hops++;
+		}
+		// DR-LR: LID routed from the end of the directed part
+		if (drDlid != STL_LID_PERMISSIVE) {
+			nodep = cs_sim_route_lid(nodep, &ingressp, drDlid, IB_PORT_INIT, &hops);
+			if (nodep == NULL)
+				goto drop;
+		}
+		data = smp->SmpExt.DirectedRoute.SMPData;
+		hdrLen = sizeof(MAD_COMMON) + STL_SMP_DR_HDR_LEN;
+		maxLen = STL_MAX_PAYLOAD_SMP_DR;
+	} else {
+		nodep = cs_sim_route_lid(nodep, &ingressp, addr->lid, IB_PORT_INIT, &hops);
+		if (nodep == NULL)
+			goto drop;
+		data = smp->SmpExt.LIDRouted.SMPData;
+		hdrLen = sizeof(MAD_COMMON) + STL_SMP_LR_HDR_LEN;
+		maxLen = STL_MAX_PAYLOAD_SMP_LR;
+	}
+
+	if (hdrp->AttributeID == STL_MCLASS_ATTRIB_ID_SM_INFO) {
+		// SMInfo is answered by the SM on the port, not the SMA
+		if (nodep == fabricp->local) {
+			free(rsp);
+			cs_sim_queue_loopback(req, len, addr, hdrp->MgmtClass);
+			return;
+		}
+		status = MAD_STATUS_UNSUPPORTED_METHOD_ATTRIB;
+		rspLen = 0;
+	} else if (hdrp->mr.AsReg8 != MMTHD_GET && hdrp->mr.AsReg8 != MMTHD_SET) {
+		status = MAD_STATUS_UNSUPPORTED_METHOD;
+		rspLen = 0;
+	} else {
+		reqLen = (len > hdrLen) ? (uint32_t)(len - hdrLen) : 0;
+		status = cs_sim_sma_attr(nodep, ingressp, hdrp->mr.AsReg8, hdrp->AttributeID,
+								 hdrp->AttributeModifier, data, reqLen, maxLen, &rspLen);
+	}
+	if (cs_sim_lost(hops))
+		goto drop;
+
+	{
+		MAD_COMMON *rhp = (MAD_COMMON *)rsp;
+
+		*rhp = *hdrp;
+		rhp->mr.AsReg8 = MMTHD_GET_RESP;
+		if (dr) {
+			rhp->u.DR.s.D = 1;
+			rhp->u.DR.s.Status = status;
+			rhp->u.DR.HopPointer = rhp->u.DR.HopCount;
+		} else {
+			rhp->u.NS.Status.AsReg16 = status;
+		}
+		BSWAP_MAD_HEADER((MAD *)rhp);
+	}
+
+	memset(&rspAddr, 0, sizeof(rspAddr));
+	rspAddr.lid = dr ? addr->lid : nodep->ports[nodep->nodeInfo.NodeType == STL_NODE_SW
+												? 0 : ingressp->portNum].portInfo.LID;
+	rspAddr.pkey = addr->pkey;
+	rspAddr.sl = addr->sl;
+	cs_sim_queue(FSUCCESS, rsp, hdrLen + ((rspLen + 7) & ~7), &rspAddr,
+				 cs_sim_now() + 2 * (uint64_t)hops * cs_sim.hopLatency);
+	return;
+
+drop:
+	free(rsp);
+noanswer:
+	cs_sim_queue_timeout(req, len, addr, timeout_ms);
+}
+
+//==============================================================================
+// PMA
+//==============================================================================
+
+// advances the counters of portp to now at its modeled load
+static void
+cs_sim_update_ctrs(cs_sim_port_t *portp, uint64_t now)
+{
+	cs_sim_ctrs_t *cp = &portp->ctrs;
+	uint64_t dt, xmit, rcv;
+	uint8_t nbrUtil;
+
+	if (portp->portInfo.PortStates.s.PortState != IB_PORT_ACTIVE || portp->nbrp == NULL
+		|| now <= cp->lastUpdate) {
+		cp->lastUpdate = now;
+		return;
+	}
+	dt = now - cp->lastUpdate;
+	nbrUtil = portp->nbrp->ports[portp->nbrPort].util;
+	xmit = dt * CS_SIM_FLITS_PER_USEC * portp->util / 100;
+	rcv = dt * CS_SIM_FLITS_PER_USEC * nbrUtil / 100;
+
+	cp->xmitData += xmit;
+	cp->rcvData += rcv;
+	cp->xmitPkts += xmit / CS_SIM_FLITS_PER_PKT;
+	cp->rcvPkts += rcv / CS_SIM_FLITS_PER_PKT;
+	// congestion grows with the square of the load
+	cp->xmitWait += xmit * portp->util / 400;
+	cp->linkIntegrityErrors += (rcv / CS_SIM_FLITS_PER_PKT) * cs_sim.lossPpm / 1000000;
+	cp->linkErrorRecovery = cp->linkIntegrityErrors / 16;
+	cp->lastUpdate = now;
+}
+
+// the ports a counter request selects, in order
+static int
+cs_sim_pma_ports(cs_sim_node_t *nodep, cs_sim_port_t *ingressp, const void *maskp,
+				 cs_sim_port_t **portsp)
+{
+	uint64_t mask[4];
+	uint32_t port;
+	int n = 0;
+
+	if (nodep->nodeInfo.NodeType != STL_NODE_SW) {
+		portsp[0] = ingressp;
+		return 1;
+	}
+	// the mask sits unaligned in the packed request
+	memcpy(mask, maskp, sizeof(mask));
+	for (port = 0; port <= nodep->nodeInfo.NumPorts; port++) {
+		if (ntoh64(mask[3 - port / 64]) & (1ull << (port % 64)))
+			portsp[n++] = &nodep->ports[port];
+	}
+	return n;
+}
+
+static uint16_t
+cs_sim_pma_attr(cs_sim_node_t *nodep, cs_sim_port_t *ingressp, uint8_t method,
+				uint16_t aid, uint8_t *data, uint32_t maxLen, uint32_t *rspLenp)
+{
+	cs_sim_port_t *ports[STL_MAX_PORTS + 1];
+	uint64_t now = cs_sim_now();
+	uint32_t vlMask, numVls, len;
+	int i, n;
+
+	*rspLenp = 0;
+
+	switch (aid) {
+	case PM_ATTRIB_ID_CLASS_PORTINFO:
+		if (method != MMTHD_GET)
+			return MAD_STATUS_UNSUPPORTED_METHOD_ATTRIB;
+		{
+			STL_CLASS_PORT_INFO *cpip = (STL_CLASS_PORT_INFO *)data;
+			memset(cpip, 0, sizeof(*cpip));
+			cpip->BaseVersion = STL_BASE_VERSION;
+			cpip->ClassVersion = STL_PM_CLASS_VERSION;
+			cpip->u1.s.RespTimeValue = 18;
+			BSWAP_STL_CLASS_PORT_INFO(cpip);
+		}
+		*rspLenp = sizeof(STL_CLASS_PORT_INFO);
+		return 0;
+
+	case STL_PM_ATTRIB_ID_PORT_STATUS:
+		if (method != MMTHD_GET)
+			return MAD_STATUS_UNSUPPORTED_METHOD_ATTRIB;
+		{
+			STL_PORT_STATUS_RSP *rp = (STL_PORT_STATUS_RSP *)data;
+			cs_sim_port_t *portp = ingressp;
+			cs_sim_ctrs_t *cp;
+
+			if (nodep->nodeInfo.NodeType == STL_NODE_SW) {
+				if (rp->PortNumber > nodep->nodeInfo.NumPorts)
+					return MAD_STATUS_INVALID_ATTRIB;
+				portp = &nodep->ports[rp->PortNumber];
+			}
+			vlMask = ntoh32(rp->VLSelectMask);
+			numVls = __builtin_popcount(vlMask);
+			len = sizeof(*rp) - sizeof(rp->VLs) + numVls * sizeof(rp->VLs[0]);
+			if (len > maxLen)
+				return MAD_STATUS_INVALID_ATTRIB;
+			memset((uint8_t *)rp + 8, 0, len - 8);
+
+			cs_sim_update_ctrs(portp, now);
+			cp = &portp->ctrs;
+			rp->PortNumber = portp->portNum;
+			rp->PortXmitData = hton64(cp->xmitData);
+			rp->PortRcvData = hton64(cp->rcvData);
+			rp->PortXmitPkts = hton64(cp->xmitPkts);
+			rp->PortRcvPkts = hton64(cp->rcvPkts);
+			rp->PortXmitWait = hton64(cp->xmitWait);
+			rp->LocalLinkIntegrityErrors = hton64(cp->linkIntegrityErrors);
+			rp->LinkErrorRecovery = hton32((uint32_t)cp->linkErrorRecovery);
+			rp->lq.s.LinkQualityIndicator = cs_sim_link_up(portp, IB_PORT_INIT)
+				? STL_LINKQUALITY_EXCELLENT : STL_LINKQUALITY_NONE;
+			// all traffic runs on VL0
+			if (vlMask & 1) {
+				rp->VLs[0].PortVLXmitData = rp->PortXmitData;
+				rp->VLs[0].PortVLRcvData = rp->PortRcvData;
+				rp->VLs[0].PortVLXmitPkts = rp->PortXmitPkts;
+				rp->VLs[0].PortVLRcvPkts = rp->PortRcvPkts;
+				rp->VLs[0].PortVLXmitWait = rp->PortXmitWait;
+			}
+			*rspLenp = len;
+		}
+		return 0;
+
+	case STL_PM_ATTRIB_ID_DATA_PORT_COUNTERS:
+		if (method != MMTHD_GET)
+			return MAD_STATUS_UNSUPPORTED_METHOD_ATTRIB;
+		{
+			STL_DATA_PORT_COUNTERS_RSP *rp = (STL_DATA_PORT_COUNTERS_RSP *)data;
+			struct _port_dpctrs *dp = (struct _port_dpctrs *)(data
+				+ offsetof(STL_DATA_PORT_COUNTERS_RSP, Port));
+			uint32_t portLen, lliRes, lerRes;
+
+			vlMask = ntoh32(rp->VLSelectMask);
+			numVls = __builtin_popcount(vlMask);
+			portLen = sizeof(*dp) - sizeof(dp->VLs) + numVls * sizeof(dp->VLs[0]);
+			n = cs_sim_pma_ports(nodep, ingressp, rp->PortSelectMask, ports);
+			len = offsetof(STL_DATA_PORT_COUNTERS_RSP, Port) + n * portLen;
+			if (n == 0 || len > maxLen)
+				return MAD_STATUS_INVALID_ATTRIB;
+			lliRes = ntoh32(rp->res.AsReg32) >> 4 & 0xf;
+			lerRes = ntoh32(rp->res.AsReg32) & 0xf;
+			memset(dp, 0, len - offsetof(STL_DATA_PORT_COUNTERS_RSP, Port));
+
+			for (i = 0; i < n; i++) {
+				cs_sim_ctrs_t *cp = &ports[i]->ctrs;
+
+				cs_sim_update_ctrs(ports[i], now);
+				dp->PortNumber = ports[i]->portNum;
+				dp->lq.AsReg32 = hton32(cs_sim_link_up(ports[i], IB_PORT_INIT)
+										? STL_LINKQUALITY_EXCELLENT : STL_LINKQUALITY_NONE);
+				dp->PortXmitData = hton64(cp->xmitData);
+				dp->PortRcvData = hton64(cp->rcvData);
+				dp->PortXmitPkts = hton64(cp->xmitPkts);
+				dp->PortRcvPkts = hton64(cp->rcvPkts);
+				dp->PortXmitWait = hton64(cp->xmitWait);
+				dp->PortErrorCounterSummary = hton64(
+					((cp->linkIntegrityErrors + (lliRes ? RES_ADDER_LLI : 0)) >> lliRes)
+					+ ((cp->linkErrorRecovery + (lerRes ? RES_ADDER_LER : 0)) >> lerRes));
+				if (vlMask & 1) {
+					dp->VLs[0].PortVLXmitData = dp->PortXmitData;
+					dp->VLs[0].PortVLRcvData = dp->PortRcvData;
+					dp->VLs[0].PortVLXmitPkts = dp->PortXmitPkts;
+					dp->VLs[0].PortVLRcvPkts = dp->PortRcvPkts;
+					dp->VLs[0].PortVLXmitWait = dp->PortXmitWait;
+				}
+				dp = (struct _port_dpctrs *)((uint8_t *)dp + portLen);
+			}
+			*rspLenp = len;
+		}
+		return 0;
+
+	case STL_PM_ATTRIB_ID_ERROR_PORT_COUNTERS:
+		if (method != MMTHD_GET)
+			return MAD_STATUS_UNSUPPORTED_METHOD_ATTRIB;
+		{
+			STL_ERROR_PORT_COUNTERS_RSP *rp = (STL_ERROR_PORT_COUNTERS_RSP *)data;
+			struct _port_epctrs *ep = (struct _port_epctrs *)(data
+				+ offsetof(STL_ERROR_PORT_COUNTERS_RSP, Port));
+			uint32_t portLen;
+
+			vlMask = ntoh32(rp->VLSelectMask);
+			numVls = __builtin_popcount(vlMask);
+			portLen = sizeof(*ep) - sizeof(ep->VLs) + numVls * sizeof(ep->VLs[0]);
+			n = cs_sim_pma_ports(nodep, ingressp, rp->PortSelectMask, ports);
+			len = offsetof(STL_ERROR_PORT_COUNTERS_RSP, Port) + n * portLen;
+			if (n == 0 || len > maxLen)
+				return MAD_STATUS_INVALID_ATTRIB;
+			memset(ep, 0, len - offsetof(STL_ERROR_PORT_COUNTERS_RSP, Port));
+
+			for (i = 0; i < n; i++) {
+				cs_sim_update_ctrs(ports[i], now);
+				ep->PortNumber = ports[i]->portNum;
+				ep->LocalLinkIntegrityErrors = hton64(ports[i]->ctrs.linkIntegrityErrors);
+				ep->LinkErrorRecovery = hton32((uint32_t)ports[i]->ctrs.linkErrorRecovery);
+				ep = (struct _port_epctrs *)((uint8_t *)ep + portLen);
+			}
+			*rspLenp = len;
+		}
+		return 0;
+
+	case STL_PM_ATTRIB_ID_ERROR_INFO:
+		{
+			STL_ERROR_INFO_RSP *rp = (STL_ERROR_INFO_RSP *)data;
+
+			// no error has ever been captured
+			n = cs_sim_pma_ports(nodep, ingressp, rp->PortSelectMask, ports);
+			len = offsetof(STL_ERROR_INFO_RSP, Port) + n * sizeof(rp->Port[0]);
+			if (n == 0 || len > maxLen)
+				return MAD_STATUS_INVALID_ATTRIB;
+			memset(rp->Port, 0, n * sizeof(rp->Port[0]));
+			for (i = 0; i < n; i++)
+				rp->Port[i].PortNumber = ports[i]->portNum;
+			*rspLenp = len;
+		}
+		return 0;
+
+	case STL_PM_ATTRIB_ID_CLEAR_PORT_STATUS:
+		if (method != MMTHD_SET)
+			return MAD_STATUS_UNSUPPORTED_METHOD_ATTRIB;
+		{
+			STL_CLEAR_PORT_STATUS *cp = (STL_CLEAR_PORT_STATUS *)data;
+			CounterSelectMask_t sel;
+
+			sel.AsReg32 = ntoh32(cp->CounterSelectMask.AsReg32);
+			n = cs_sim_pma_ports(nodep, ingressp, cp->PortSelectMask, ports);
+			for (i = 0; i < n; i++) {
+				cs_sim_ctrs_t *ctrs = &ports[i]->ctrs;
+
+				cs_sim_update_ctrs(ports[i], now);
+				if (sel.s.PortXmitData) ctrs->xmitData = 0;
+				if (sel.s.PortRcvData) ctrs->rcvData = 0;
+				if (sel.s.PortXmitPkts) ctrs->xmitPkts = 0;
+				if (sel.s.PortRcvPkts) ctrs->rcvPkts = 0;
+				if (sel.s.PortXmitWait) ctrs->xmitWait = 0;
+				if (sel.s.LocalLinkIntegrityErrors) ctrs->linkIntegrityErrors = 0;
+				if (sel.s.LinkErrorRecovery) ctrs->linkErrorRecovery = 0;
+			}
+			*rspLenp = sizeof(STL_CLEAR_PORT_STATUS);
+		}
+		return 0;
+
+	default:
+		return MAD_STATUS_UNSUPPORTED_METHOD_ATTRIB;
+	}
+}
+
+//==============================================================================
+// cs_sim_pma
+//
+// routes a PMA request and queues the response
+//==============================================================================
+static void
+cs_sim_pma(uint8_t *req, size_t len, struct oib_mad_addr *addr, MAD_COMMON *hdrp, int timeout_ms)
+{
+	cs_sim_fabric_t *fabricp = &cs_sim.fabric;
+	cs_sim_port_t *ingressp = &fabricp->local->ports[fabricp->localPort];
+	cs_sim_node_t *nodep;
+	struct oib_mad_addr rspAddr;
+	MAD_COMMON *rhp;
+	uint8_t *rsp;
+	uint32_t hops = 0, rspLen;
+	uint16_t status;
+
+	if (len > STL_MAD_BLOCK_SIZE)
+		goto noanswer;
+	nodep = cs_sim_route_lid(fabricp->local, &ingressp, addr->lid, IB_PORT_ACTIVE, &hops);
+	if (nodep == NULL || cs_sim_lost(hops))
+		goto noanswer;
+	rsp = calloc(1, STL_MAD_BLOCK_SIZE);
+	if (rsp == NULL)
+		goto noanswer;
+	memcpy(rsp, req, len);
+
+	if (hdrp->mr.AsReg8 != MMTHD_GET && hdrp->mr.AsReg8 != MMTHD_SET)
+		status = MAD_STATUS_UNSUPPORTED_METHOD;
+	else
+		status = cs_sim_pma_attr(nodep, ingressp, hdrp->mr.AsReg8, hdrp->AttributeID,
+								 rsp + sizeof(MAD_COMMON), STL_GS_DATASIZE, &rspLen);
+	if (status)
+		rspLen = (len > sizeof(MAD_COMMON)) ? (uint32_t)(len - sizeof(MAD_COMMON)) : 0;
+
+	rhp = (MAD_COMMON *)rsp;
+	*rhp = *hdrp;
+	rhp->mr.AsReg8 = MMTHD_GET_RESP;
+	rhp->u.NS.Status.AsReg16 = status;
+	BSWAP_MAD_HEADER((MAD *)rhp);
+
+	memset(&rspAddr, 0, sizeof(rspAddr));
+	rspAddr.lid = addr->lid;
+	rspAddr.qpn = 1;
+	rspAddr.qkey = QP1_WELL_KNOWN_Q_KEY;
+	rspAddr.pkey = addr->pkey;
+	rspAddr.sl = addr->sl;
+	cs_sim_queue(FSUCCESS, rsp, sizeof(MAD_COMMON) + rspLen, &rspAddr,
+				 cs_sim_now() + 2 * (uint64_t)hops * cs_sim.hopLatency);
+	return;
+
+noanswer:
+	cs_sim_queue_timeout(req, len, addr, timeout_ms);
+}
+
+//==============================================================================
+// ib_sim_configure
+//==============================================================================
+Status_t
+ib_sim_configure(const char *fabric, uint32_t hopLatency, uint32_t lossPpm)
+{
+	Status_t status;
+
+	IB_ENTER(__func__, hopLatency, lossPpm, 0, 0);
+
+	if (cs_sim.enabled) {
+		IB_EXIT(__func__, VSTATUS_BUSY);
+		return VSTATUS_BUSY;
+	}
+	status = cs_sim_build(&cs_sim.fabric, fabric);
+	if (status != VSTATUS_OK) {
+		IB_EXIT(__func__, status);
+		return status;
+	}
+	cs_sim.hopLatency = hopLatency;
+	cs_sim.lossPpm = MIN(lossPpm, 1000000);
+	cs_sim.rng = cs_sim_now() | 1;
+	cs_sim.enabled = 1;
+
+	IB_LOG_WARN_FMT(__func__, "MADs go to simulated fabric %s, not to the HFI "
+					"(%u usec per hop, %u ppm loss per link)",
+					fabric, cs_sim.hopLatency, cs_sim.lossPpm);
+	IB_EXIT(__func__, VSTATUS_OK);
+	return VSTATUS_OK;
+}
+
+//==============================================================================
+// cs_sim_enabled
+//==============================================================================
+int
+cs_sim_enabled(void)
+{
+	return cs_sim.enabled;
+}
+
+//==============================================================================
+// cs_sim_open
+//
+// binds the FM to the HFI port with GUID portGuid, or to the first HFI
+//==============================================================================
+Status_t
+cs_sim_open(uint64_t portGuid, uint32_t *portp, uint64_t *guidp)
+{
+	cs_sim_fabric_t *fabricp = &cs_sim.fabric;
+	uint32_t i;
+
+	for (i = 0; i < fabricp->numNodes; i++) {
+		cs_sim_node_t *nodep = fabricp->nodes[i];
+		if (nodep->nodeInfo.NodeType == STL_NODE_FI && nodep->nodeInfo.NumPorts
+			&& (portGuid == 0 || nodep->nodeInfo.PortGUID == portGuid))
+			break;
+	}
+	if (i == fabricp->numNodes) {
+		IB_LOG_ERROR_FMT(__func__, "no simulated HFI port with GUID 0x%.16"CS64"x", portGuid);
+		return VSTATUS_BAD;
+	}
+
+	(void)pthread_mutex_lock(&cs_sim.lock);
+	fabricp->local = fabricp->nodes[i];
+	fabricp->localPort = 1;
+	(void)pthread_mutex_unlock(&cs_sim.lock);
+
+	if (portp != NULL) *portp = fabricp->localPort;
+	if (guidp != NULL) *guidp = fabricp->local->nodeInfo.PortGUID;
+	return VSTATUS_OK;
+}
+
+//==============================================================================
+// cs_sim_set_is_sm
+//==============================================================================
+void
+cs_sim_set_is_sm(int isSm)
+{
+	(void)pthread_mutex_lock(&cs_sim.lock);
+	if (cs_sim.fabric.local)
+		cs_sim.fabric.local->ports[cs_sim.fabric.localPort].portInfo.CapabilityMask.s.IsSM = isSm ? 1 : 0;
+	(void)pthread_mutex_unlock(&cs_sim.lock);
+}
+
+//==============================================================================
+// cs_sim_send
+//
+// the simulated oib_send_mad2(); buf is the MAD in wire format
+//==============================================================================
+FSTATUS
+cs_sim_send(uint8_t *buf, size_t len, struct oib_mad_addr *addr, int timeout_ms)
+{
+	cs_sim_port_t *localp;
+	MAD mad;					// only the common header is used
+	MAD_COMMON *hdr = &mad.common;
+	uint32_t lid;
+
+	if (len < sizeof(MAD_COMMON))
+		return FINVALID_PARAMETER;
+	memcpy(hdr, buf, sizeof(*hdr));
+	BSWAP_MAD_HEADER(&mad);
+
+	(void)pthread_mutex_lock(&cs_sim.lock);
+	if (cs_sim.fabric.local == NULL) {
+		(void)pthread_mutex_unlock(&cs_sim.lock);
+		return FERROR;
+	}
+	localp = &cs_sim.fabric.local->ports[cs_sim.fabric.localPort];
+	lid = localp->portInfo.LID;
+
+	if (hdr->mr.s.R || hdr->mr.s.Method == MMTHD_TRAP || hdr->mr.s.Method == MMTHD_SEND
+		|| hdr->mr.s.Method == MMTHD_REPORT || hdr->mr.s.Method == MMTHD_TRAP_REPRESS) {
+		// the FM only ever answers itself; anything else has no listener
+		if (hdr->MgmtClass == MCLASS_SM_DIRECTED_ROUTE || addr->lid == 0
+			|| addr->lid == STL_LID_PERMISSIVE || addr->lid == LID_PERMISSIVE
+			|| cs_sim_lid_owner(addr->lid) == localp)
+			cs_sim_queue_loopback(buf, len, addr, hdr->MgmtClass);
+	} else if (hdr->BaseVersion != STL_BASE_VERSION) {
+		cs_sim_queue_timeout(buf, len, addr, timeout_ms);
+	} else if (hdr->MgmtClass == MCLASS_SM_LID_ROUTED
+			   || hdr->MgmtClass == MCLASS_SM_DIRECTED_ROUTE) {
+		cs_sim_smp(buf, len, addr, hdr, timeout_ms);
+	} else if (hdr->MgmtClass == MCLASS_PERF) {
+		cs_sim_pma(buf, len, addr, hdr, timeout_ms);
+	} else if (lid && cs_sim_lid_owner(addr->lid) == localp) {
+		// SA, PA and vendor requests to our own port
+		cs_sim_queue_loopback(buf, len, addr, hdr->MgmtClass);
+	} else {
+		cs_sim_queue_timeout(buf, len, addr, timeout_ms);
+	}
+	(void)pthread_mutex_unlock(&cs_sim.lock);
+	return FSUCCESS;
+}
+
+//==============================================================================
+// cs_sim_recv
+//
+// the simulated oib_recv_mad_alloc(); returns the next due MAD, FNOT_DONE
+// once timeout_ms passes without one, and waits forever for timeout_ms < 0
+//==============================================================================
+FSTATUS
+cs_sim_recv(uint8_t **bufp, size_t *lenp, int timeout_ms, struct oib_mad_addr *addr)
+{
+	cs_sim_event_t ev;
+	uint64_t now, deadline, until;
+	struct timespec ts;
+
+	(void)pthread_mutex_lock(&cs_sim.lock);
+	now = cs_sim_now();
+	deadline = (timeout_ms < 0) ? (uint64_t)-1 : now + (uint64_t)timeout_ms * 1000;
+
+	for (;;) {
+		if (cs_sim.heapLen && cs_sim.heap[0].due <= now) {
+			cs_sim_pop(&ev);
+			(void)pthread_mutex_unlock(&cs_sim.lock);
+			*bufp = ev.buf;
+			*lenp = ev.len;
+			*addr = ev.addr;
+			return ev.status;
+		}
+		if (now >= deadline)
+			break;
+
+		until = cs_sim.heapLen ? MIN(cs_sim.heap[0].due, deadline) : deadline;
+		if (until == (uint64_t)-1) {
+			(void)pthread_cond_wait(&cs_sim.cond, &cs_sim.lock);
+		} else {
+			// vs_time_get is wall clock time, as pthread_cond_timedwait wants
+			ts.tv_sec = until / 1000000;
+			ts.tv_nsec = (until % 1000000) * 1000;
+			(void)pthread_cond_timedwait(&cs_sim.cond, &cs_sim.lock, &ts);
+		}
+		now = cs_sim_now();
+	}
+	(void)pthread_mutex_unlock(&cs_sim.lock);
+	return FNOT_DONE;
+}
@@ -0,0 +1,137 @@
+/* BEGIN_ICS_COPYRIGHT2 ****************************************
+
+Copyright (c) 2015, Intel Corporation
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Intel Corporation nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ * ** END_ICS_COPYRIGHT2   ****************************************/
+
+//=======================================================================
+//
+// FILE NAME
+//    cs_sim.h
+//
+// DESCRIPTION
+//    Simulated fabric backend for the MAL layer.  When a simulated
+//    fabric is configured, cs_mad_openib.c hands every outbound MAD to
+//    cs_sim_send() instead of the HFI, and ib_recv_sma() takes its
+//    inbound MADs from cs_sim_recv().  The fabric is a set of nodes and
+//    links held in memory; the SMA and PMA of each node are answered
+//    in-process, DR SMPs follow the initial path and LID routed MADs
+//    follow the forwarding tables the SM has programmed.
+//
+//=======================================================================
+
+#ifndef	_CS_SIM_H
+#define	_CS_SIM_H
+
+#include <cs_g.h>
+#include <iba/ib_mad.h>
+#include <iba/stl_sm.h>
+#include <iba/stl_pm.h>
+#include <iba/public/iquickmap.h>
+#include "oib_utils.h"
+
+// generated GUIDs: OUI in the top 24 bits, node type and index below
+#define	CS_SIM_GUID_BASE		0x0011750000000000ull
+#define	CS_SIM_GUID(type, index) \
+	(CS_SIM_GUID_BASE | ((uint64_t)(type) << 32) | (uint64_t)(index))
+
+#define	CS_SIM_LFT_CAP			0xC000	// LinearFDBCap of generated switches
+#define	CS_SIM_MFT_CAP			0x1000	// MulticastFDBCap of generated switches
+#define	CS_SIM_MAX_HOPS			64		// LID routed walks longer than this loop
+
+// PMA counters kept per port, advanced lazily when they are read
+typedef struct cs_sim_ctrs {
+	uint64_t	xmitData;
+	uint64_t	rcvData;
+	uint64_t	xmitPkts;
+	uint64_t	rcvPkts;
+	uint64_t	xmitWait;
+	uint64_t	linkIntegrityErrors;
+	uint64_t	linkErrorRecovery;
+	uint64_t	lastUpdate;			// usec, vs_time_get
+} cs_sim_ctrs_t;
+
+struct cs_sim_node;
+
+typedef struct cs_sim_port {
+	struct cs_sim_node *nodep;
+	struct cs_sim_node *nbrp;		// NULL when not cabled
+	uint8_t			nbrPort;
+	uint8_t			portNum;
+	uint8_t			util;			// offered load in percent for the PMA model
+	STL_PORT_INFO	portInfo;		// host byte order
+	cs_sim_ctrs_t	ctrs;
+} cs_sim_port_t;
+
+typedef struct cs_sim_node {
+	uint32_t		index;
+	STL_NODE_INFO	nodeInfo;		// host byte order, PortGUID of port 0/1
+	STL_NODE_DESCRIPTION nodeDesc;
+	STL_SWITCH_INFO	switchInfo;		// switches only, host byte order
+	uint8_t			*lft;			// switches only, allocated on first Set
+	cs_sim_port_t	*ports;			// NumPorts + 1 entries, [0] unused on HFIs
+	cl_qmap_t		attrs;			// other attributes: last Set payload
+} cs_sim_node_t;
+
+// a stored attribute not modeled by the SMA: the last payload Set for it
+typedef struct cs_sim_attr {
+	cl_map_item_t	item;			// key is aid << 32 | amod
+	uint32_t		len;
+	uint8_t			data[1];
+} cs_sim_attr_t;
+
+typedef struct cs_sim_fabric {
+	cs_sim_node_t	**nodes;
+	uint32_t		numNodes;
+	uint32_t		maxNodes;
+	cs_sim_node_t	*local;			// node of the port the FM is bound to
+	uint8_t			localPort;
+	cs_sim_port_t	**lids;			// end port owning each assigned LID
+	uint32_t		lidCap;
+} cs_sim_fabric_t;
+
+//
+// fabric construction (cs_sim_fabric.c)
+//
+cs_sim_node_t *cs_sim_add_node(cs_sim_fabric_t *fabricp, uint8_t nodeType,
+		uint8_t numPorts, uint64_t nodeGuid, const char *desc);
+Status_t cs_sim_connect(cs_sim_node_t *ap, uint8_t aport, cs_sim_node_t *bp,
+		uint8_t bport);
+Status_t cs_sim_build(cs_sim_fabric_t *fabricp, const char *spec);
+void cs_sim_free(cs_sim_fabric_t *fabricp);
+
+//
+// MAL interface (cs_mad_sim.c)
+//
+int cs_sim_enabled(void);
+Status_t cs_sim_open(uint64_t portGuid, uint32_t *portp, uint64_t *guidp);
+FSTATUS cs_sim_send(uint8_t *buf, size_t len, struct oib_mad_addr *addr,
+		int timeout_ms);
+FSTATUS cs_sim_recv(uint8_t **bufp, size_t *lenp, int timeout_ms,
+		struct oib_mad_addr *addr);
+void cs_sim_set_is_sm(int isSm);
+
+#endif	// _CS_SIM_H
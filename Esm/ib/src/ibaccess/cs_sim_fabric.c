@@ -0,0 +1,577 @@
+/* BEGIN_ICS_COPYRIGHT2 ****************************************
+
+Copyright (c) 2015, Intel Corporation
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Intel Corporation nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ * ** END_ICS_COPYRIGHT2   ****************************************/
+
+//=======================================================================
+//
+// FILE NAME
+//    cs_sim_fabric.c
+//
+// DESCRIPTION
+//    Construction of the simulated fabric used by cs_mad_sim.c, either
+//    generated (fat tree or 3D torus) or loaded from a topology snapshot
+//    written by opareport.  Nodes come up with every cabled port in the
+//    Init state and no LIDs assigned, as after a fabric power on.
+//
+//=======================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <ib_macros.h>
+#include "cs_sim.h"
+#include "topology.h"
+
+#define	CS_SIM_TYPE_HFI		1
+#define	CS_SIM_TYPE_SWITCH	2
+
+//==============================================================================
+// cs_sim_init_port
+//
+// power on defaults of a port, modeled on a Gen1 port running at 4x 25G
+//==============================================================================
+static void
+cs_sim_init_port(cs_sim_node_t *nodep, cs_sim_port_t *portp, uint8_t portNum)
+{
+	STL_PORT_INFO *pip = &portp->portInfo;
+
+	memset(portp, 0, sizeof(*portp));
+	portp->nodep = nodep;
+	portp->portNum = portNum;
+	// offered load spread over 0-90% so PM bucketing has something to see
+	portp->util = (uint8_t)((nodep->nodeInfo.NodeGUID * 31 + portNum * 17) % 91);
+
+	pip->VL.s2.Cap = 8;
+	pip->VL.ArbitrationHighCap = 16;
+	pip->VL.ArbitrationLowCap = 16;
+	pip->PortStates.s.PortState = IB_PORT_DOWN;
+	pip->PortStates.s.PortPhysicalState = IB_PORT_PHYS_POLLING;
+	pip->PortPhyConfig.s.PortType = portNum ? STL_PORT_TYPE_STANDARD : STL_PORT_TYPE_UNKNOWN;
+	pip->LinkSpeed.Supported = STL_LINK_SPEED_25G;
+	pip->LinkSpeed.Enabled = STL_LINK_SPEED_25G;
+	pip->LinkWidth.Supported = STL_LINK_WIDTH_1X | STL_LINK_WIDTH_2X
+		| STL_LINK_WIDTH_3X | STL_LINK_WIDTH_4X;
+	pip->LinkWidth.Enabled = pip->LinkWidth.Supported;
+	pip->LinkWidthDowngrade.Supported = pip->LinkWidth.Supported;
+	pip->LinkWidthDowngrade.Enabled = pip->LinkWidth.Supported;
+	pip->PortLinkMode.s.Supported = STL_PORT_LINK_MODE_STL;
+	pip->PortLinkMode.s.Enabled = STL_PORT_LINK_MODE_STL;
+	pip->PortLinkMode.s.Active = STL_PORT_LINK_MODE_STL;
+	pip->PortLTPCRCMode.s.Supported = STL_PORT_LTP_CRC_MODE_14
+		| STL_PORT_LTP_CRC_MODE_16 | STL_PORT_LTP_CRC_MODE_48;
+	pip->PortLTPCRCMode.s.Enabled = pip->PortLTPCRCMode.s.Supported;
+	pip->PortLTPCRCMode.s.Active = STL_PORT_LTP_CRC_MODE_16;
+	pip->PortPacketFormats.Supported = STL_PORT_PACKET_FORMAT_8B
+		| STL_PORT_PACKET_FORMAT_9B | STL_PORT_PACKET_FORMAT_16B;
+	pip->PortPacketFormats.Enabled = pip->PortPacketFormats.Supported;
+	pip->FlitControl.Interleave.s.DistanceSupported = STL_PORT_FLIT_DISTANCE_MODE_1;
+	pip->FlitControl.Interleave.s.DistanceEnabled = STL_PORT_FLIT_DISTANCE_MODE_1;
+	pip->FlitControl.Interleave.s.MaxNestLevelRxSupported = 8;
+	pip->FlitControl.Interleave.s.MaxNestLevelTxEnabled = 8;
+	pip->FlitControl.Preemption.MaxSmallPktLimit = 0x20;
+	pip->BufferUnits.s.BufferAlloc = 3;
+	pip->BufferUnits.s.CreditAck = 1;
+	pip->BufferUnits.s.VL15Init = 0x110;
+	pip->OverallBufferSpace = (nodep->nodeInfo.NodeType == STL_NODE_SW) ? 0x2160 : 0x1000;
+	pip->ReplayDepth.BufferDepth = 128;
+	pip->ReplayDepth.WireDepth = 32;
+	pip->MTU.Cap = STL_MTU_10240;
+	pip->Resp.TimeValue = 18;
+	pip->Subnet.Timeout = 18;
+	pip->SA_QP.s.QueuePair = 1;
+	pip->PortNeighborMode.MgmtAllowed = 1;
+	pip->CapabilityMask.s.IsCapabilityMaskNoticeSupported = 1;
+	pip->CapabilityMask3.s.IsVLMarkerSupported = 1;
+	pip->LocalPortNum = portNum;
+
+	if (nodep->nodeInfo.NodeType == STL_NODE_SW && portNum == 0) {
+		// enhanced switch port 0 is always up
+		pip->PortStates.s.PortState = IB_PORT_INIT;
+		pip->PortStates.s.PortPhysicalState = IB_PORT_PHYS_LINKUP;
+		pip->LinkSpeed.Active = STL_LINK_SPEED_25G;
+		pip->LinkWidth.Active = STL_LINK_WIDTH_4X;
+		pip->LinkWidthDowngrade.TxActive = STL_LINK_WIDTH_4X;
+		pip->LinkWidthDowngrade.RxActive = STL_LINK_WIDTH_4X;
+	}
+}
+
+//==============================================================================
+// cs_sim_add_node
+//==============================================================================
+cs_sim_node_t *
+cs_sim_add_node(cs_sim_fabric_t *fabricp, uint8_t nodeType, uint8_t numPorts,
+				uint64_t nodeGuid, const char *desc)
+{
+	cs_sim_node_t *nodep;
+	uint32_t i;
+
+	if (fabricp->numNodes == fabricp->maxNodes) {
+		uint32_t newMax = fabricp->maxNodes ? fabricp->maxNodes * 2 : 1024;
+		cs_sim_node_t **newNodes = realloc(fabricp->nodes, newMax * sizeof(*newNodes));
+		if (newNodes == NULL)
+			return NULL;
+		fabricp->nodes = newNodes;
+		fabricp->maxNodes = newMax;
+	}
+
+	nodep = calloc(1, sizeof(*nodep));
+	if (nodep == NULL)
+		return NULL;
+	nodep->ports = calloc(numPorts + 1, sizeof(cs_sim_port_t));
+	if (nodep->ports == NULL) {
+		free(nodep);
+		return NULL;
+	}
+
+	nodep->index = fabricp->numNodes;
+	nodep->nodeInfo.BaseVersion = STL_BASE_VERSION;
+	nodep->nodeInfo.ClassVersion = STL_SM_CLASS_VERSION;
+	nodep->nodeInfo.NodeType = nodeType;
+	nodep->nodeInfo.NumPorts = numPorts;
+	nodep->nodeInfo.SystemImageGUID = nodeGuid;
+	nodep->nodeInfo.NodeGUID = nodeGuid;
+	nodep->nodeInfo.PortGUID = nodeGuid;
+	nodep->nodeInfo.u1.s.VendorID = 0x001175;
+	if (nodeType == STL_NODE_SW) {
+		nodep->nodeInfo.PartitionCap = 8;
+		nodep->nodeInfo.DeviceID = 0x2718;
+
+		nodep->switchInfo.LinearFDBCap = CS_SIM_LFT_CAP;
+		nodep->switchInfo.MulticastFDBCap = CS_SIM_MFT_CAP;
+		nodep->switchInfo.PartitionEnforcementCap = 8;
+		nodep->switchInfo.RoutingMode.Supported = STL_ROUTE_LINEAR;
+		nodep->switchInfo.RoutingMode.Enabled = STL_ROUTE_LINEAR;
+		nodep->switchInfo.u2.s.EnhancedPort0 = 1;
+		nodep->switchInfo.MultiCollectMask.MulticastMask = 4;
+	} else {
+		nodep->nodeInfo.PartitionCap = 16;
+		nodep->nodeInfo.DeviceID = 0x24f0;
+	}
+	snprintf((char *)nodep->nodeDesc.NodeString, sizeof(nodep->nodeDesc.NodeString),
+			 "%s", desc);
+	cl_qmap_init(&nodep->attrs, NULL);
+
+	for (i = 0; i <= numPorts; i++)
+		cs_sim_init_port(nodep, &nodep->ports[i], (uint8_t)i);
+
+	fabricp->nodes[fabricp->numNodes++] = nodep;
+	return nodep;
+}
+
+//==============================================================================
+// cs_sim_connect
+//==============================================================================
+Status_t
+cs_sim_connect(cs_sim_node_t *ap, uint8_t aport, cs_sim_node_t *bp, uint8_t bport)
+{
+	cs_sim_port_t *app, *bpp;
+
+	if (aport == 0 || aport > ap->nodeInfo.NumPorts
+		|| bport == 0 || bport > bp->nodeInfo.NumPorts) {
+		return VSTATUS_ILLPARM;
+	}
+	app = &ap->ports[aport];
+	bpp = &bp->ports[bport];
+	if (app->nbrp != NULL || bpp->nbrp != NULL)
+		return VSTATUS_BUSY;
+
+	app->nbrp = bp;
+	app->nbrPort = bport;
+	bpp->nbrp = ap;
+	bpp->nbrPort = aport;
+
+	app->portInfo.NeighborPortNum = bport;
+	app->portInfo.NeighborNodeGUID = bp->nodeInfo.NodeGUID;
+	app->portInfo.PortNeighborMode.NeighborNodeType =
+		(bp->nodeInfo.NodeType == STL_NODE_SW) ? STL_NEIGH_NODE_TYPE_SW : STL_NEIGH_NODE_TYPE_HFI;
+	bpp->portInfo.NeighborPortNum = aport;
+	bpp->portInfo.NeighborNodeGUID = ap->nodeInfo.NodeGUID;
+	bpp->portInfo.PortNeighborMode.NeighborNodeType =
+		(ap->nodeInfo.NodeType == STL_NODE_SW) ? STL_NEIGH_NODE_TYPE_SW : STL_NEIGH_NODE_TYPE_HFI;
+
+	// link training completes immediately
+	app->portInfo.PortStates.s.PortState = IB_PORT_INIT;
+	app->portInfo.PortStates.s.PortPhysicalState = IB_PORT_PHYS_LINKUP;
+	app->portInfo.LinkSpeed.Active = STL_LINK_SPEED_25G;
+	app->portInfo.LinkWidth.Active = STL_LINK_WIDTH_4X;
+	app->portInfo.LinkWidthDowngrade.TxActive = STL_LINK_WIDTH_4X;
+	app->portInfo.LinkWidthDowngrade.RxActive = STL_LINK_WIDTH_4X;
+	bpp->portInfo.PortStates = app->portInfo.PortStates;
+	bpp->portInfo.LinkSpeed.Active = STL_LINK_SPEED_25G;
+	bpp->portInfo.LinkWidth.Active = STL_LINK_WIDTH_4X;
+	bpp->portInfo.LinkWidthDowngrade.TxActive = STL_LINK_WIDTH_4X;
+	bpp->portInfo.LinkWidthDowngrade.RxActive = STL_LINK_WIDTH_4X;
+
+	return VSTATUS_OK;
+}
+
+//==============================================================================
+// cs_sim_build_fattree
+//
+// two tier fat tree: every leaf has <hfis> HFIs on its first ports and one
+// uplink to every spine on the ports after them
+//==============================================================================
+static Status_t
+cs_sim_build_fattree(cs_sim_fabric_t *fabricp, uint32_t leaves, uint32_t spines, uint32_t hfis)
+{
+	cs_sim_node_t **leafp, *nodep, *spinep;
+	char desc[STL_NODE_DESCRIPTION_ARRAY_SIZE];
+	uint32_t l, s, h;
+	Status_t status = VSTATUS_OK;
+
+	if (leaves == 0 || hfis + spines > STL_MAX_PORTS - 1 || leaves > STL_MAX_PORTS - 1
+		|| (spines == 0 && leaves > 1)) {
+		IB_LOG_ERROR_FMT(__func__, "unsupported fat tree %u leaves, %u spines, %u HFIs per leaf",
+						 leaves, spines, hfis);
+		return VSTATUS_ILLPARM;
+	}
+
+	leafp = calloc(leaves, sizeof(*leafp));
+	if (leafp == NULL)
+		return VSTATUS_NOMEM;
+
+	// HFIs are added first so the first one is the FM's port by default
+	for (l = 0; l < leaves; l++) {
+		snprintf(desc, sizeof(desc), "simleaf%u", l);
+		leafp[l] = cs_sim_add_node(fabricp, STL_NODE_SW, (uint8_t)(hfis + spines),
+								   CS_SIM_GUID(CS_SIM_TYPE_SWITCH, l), desc);
+		if (leafp[l] == NULL) {
+			status = VSTATUS_NOMEM;
+			goto done;
+		}
+	}
+	for (l = 0; l < leaves && status == VSTATUS_OK; l++) {
+		for (h = 0; h < hfis; h++) {
+			snprintf(desc, sizeof(desc), "simhost%u hfi1_0", l * hfis + h);
+			nodep = cs_sim_add_node(fabricp, STL_NODE_FI, 1,
+									CS_SIM_GUID(CS_SIM_TYPE_HFI, l * hfis + h), desc);
+			if (nodep == NULL) {
+				status = VSTATUS_NOMEM;
+				break;
+			}
+			(void)cs_sim_connect(leafp[l], (uint8_t)(h + 1), nodep, 1);
+		}
+	}
+	for (s = 0; s < spines && status == VSTATUS_OK; s++) {
+		snprintf(desc, sizeof(desc), "simspine%u", s);
+		spinep = cs_sim_add_node(fabricp, STL_NODE_SW, (uint8_t)leaves,
+								 CS_SIM_GUID(CS_SIM_TYPE_SWITCH, leaves + s), desc);
+		if (spinep == NULL) {
+			status = VSTATUS_NOMEM;
+			break;
+		}
+		for (l = 0; l < leaves; l++)
+			(void)cs_sim_connect(leafp[l], (uint8_t)(hfis + s + 1), spinep, (uint8_t)(l + 1));
+	}
+
+done:
+	free(leafp);
+	return status;
+}
+
+//==============================================================================
+// cs_sim_build_torus
+//
+// 3D torus of switches; ports 1-6 are +x,-x,+y,-y,+z,-z and the HFIs hang
+// off ports 7 and up.  A dimension of size 2 gets a single link per pair.
+//==============================================================================
+static Status_t
+cs_sim_build_torus(cs_sim_fabric_t *fabricp, uint32_t dim[3], uint32_t hfis)
+{
+	cs_sim_node_t **swp, *nodep;
+	char desc[STL_NODE_DESCRIPTION_ARRAY_SIZE];
+	uint32_t numSw, i, h, d, coord[3], stride[3], next;
+	Status_t status = VSTATUS_OK;
+
+	if (dim[0] == 0 || dim[1] == 0 || dim[2] == 0 || hfis > STL_MAX_PORTS - 7) {
+		IB_LOG_ERROR_FMT(__func__, "unsupported torus %ux%ux%u, %u HFIs per switch",
+						 dim[0], dim[1], dim[2], hfis);
+		return VSTATUS_ILLPARM;
+	}
+	numSw = dim[0] * dim[1] * dim[2];
+	stride[0] = 1;
+	stride[1] = dim[0];
+	stride[2] = dim[0] * dim[1];
+
+	swp = calloc(numSw, sizeof(*swp));
+	if (swp == NULL)
+		return VSTATUS_NOMEM;
+
+	for (i = 0; i < numSw; i++) {
+		snprintf(desc, sizeof(desc), "simsw_%u_%u_%u",
+				 i % dim[0], (i / dim[0]) % dim[1], i / (dim[0] * dim[1]));
+		swp[i] = cs_sim_add_node(fabricp, STL_NODE_SW, (uint8_t)(6 + hfis),
+								 CS_SIM_GUID(CS_SIM_TYPE_SWITCH, i), desc);
+		if (swp[i] == NULL) {
+			status = VSTATUS_NOMEM;
+			goto done;
+		}
+	}
+	for (i = 0; i < numSw && status == VSTATUS_OK; i++) {
+		for (h = 0; h < hfis; h++) {
+			snprintf(desc, sizeof(desc), "simhost%u hfi1_0", i * hfis + h);
+			nodep = cs_sim_add_node(fabricp, STL_NODE_FI, 1,
+									CS_SIM_GUID(CS_SIM_TYPE_HFI, i * hfis + h), desc);
+			if (nodep == NULL) {
+				status = VSTATUS_NOMEM;
+				break;
+			}
+			(void)cs_sim_connect(swp[i], (uint8_t)(7 + h), nodep, 1);
+		}
+	}
+	for (i = 0; i < numSw && status == VSTATUS_OK; i++) {
+		coord[0] = i % dim[0];
+		coord[1] = (i / dim[0]) % dim[1];
+		coord[2] = i / (dim[0] * dim[1]);
+		for (d = 0; d < 3; d++) {
+			if (dim[d] == 1 || (dim[d] == 2 && coord[d] == 1))
+				continue;
+			next = i - coord[d] * stride[d] + ((coord[d] + 1) % dim[d]) * stride[d];
+			(void)cs_sim_connect(swp[i], (uint8_t)(2 * d + 1), swp[next], (uint8_t)(2 * d + 2));
+		}
+	}
+
+done:
+	free(swp);
+	return status;
+}
+
+//==============================================================================
+// cs_sim_load_snapshot
+//
+// loads the nodes and links of an opareport snapshot.  The snapshot's
+// NodeInfo, NodeDesc, SwitchInfo capabilities and port capabilities are
+// kept; states, LIDs and forwarding tables start from power on values.
+//==============================================================================
+static Status_t
+cs_sim_load_snapshot(cs_sim_fabric_t *fabricp, const char *filename)
+{
+	FabricData_t fabric;
+	cl_map_item_t *mi, *pi;
+	Status_t status = VSTATUS_OK;
+
+	if (Xml2ParseSnapshot(filename, 1, &fabric, FF_NONE, FALSE) != FSUCCESS) {
+		IB_LOG_ERROR_FMT(__func__, "failed to parse fabric snapshot %s", filename);
+		DestroyFabricData(&fabric);
+		return VSTATUS_BAD;
+	}
+
+	// HFIs first so the first one in GUID order is the FM's port by default
+	for (mi = cl_qmap_head(&fabric.AllNodes); mi != cl_qmap_end(&fabric.AllNodes);
+		 mi = cl_qmap_next(mi)) {
+		NodeData *np = PARENT_STRUCT(mi, NodeData, AllNodesEntry);
+		np->context = NULL;
+		if (np->NodeInfo.NodeType != STL_NODE_FI)
+			continue;
+		np->context = cs_sim_add_node(fabricp, np->NodeInfo.NodeType,
+									  np->NodeInfo.NumPorts, np->NodeInfo.NodeGUID,
+									  (char *)np->NodeDesc.NodeString);
+		if (np->context == NULL) {
+			status = VSTATUS_NOMEM;
+			goto done;
+		}
+	}
+	for (mi = cl_qmap_head(&fabric.AllNodes); mi != cl_qmap_end(&fabric.AllNodes);
+		 mi = cl_qmap_next(mi)) {
+		NodeData *np = PARENT_STRUCT(mi, NodeData, AllNodesEntry);
+		cs_sim_node_t *nodep;
+
+		if (np->NodeInfo.NodeType == STL_NODE_FI) {
+			nodep = (cs_sim_node_t *)np->context;
+		} else if (np->NodeInfo.NodeType == STL_NODE_SW) {
+			nodep = cs_sim_add_node(fabricp, np->NodeInfo.NodeType,
+									np->NodeInfo.NumPorts, np->NodeInfo.NodeGUID,
+									(char *)np->NodeDesc.NodeString);
+			if (nodep == NULL) {
+				status = VSTATUS_NOMEM;
+				goto done;
+			}
+			np->context = nodep;
+			if (np->pSwitchInfo) {
+				STL_SWITCH_INFO *sip = &np->pSwitchInfo->SwitchInfoData;
+				nodep->switchInfo.LinearFDBCap = MIN(sip->LinearFDBCap, CS_SIM_LFT_CAP);
+				nodep->switchInfo.MulticastFDBCap = sip->MulticastFDBCap;
+				nodep->switchInfo.PartitionEnforcementCap = sip->PartitionEnforcementCap;
+				nodep->switchInfo.PortGroupCap = sip->PortGroupCap;
+				nodep->switchInfo.CapabilityMask = sip->CapabilityMask;
+			}
+		} else {
+			continue;
+		}
+
+		nodep->nodeInfo.SystemImageGUID = np->NodeInfo.SystemImageGUID;
+		nodep->nodeInfo.PartitionCap = np->NodeInfo.PartitionCap;
+		nodep->nodeInfo.DeviceID = np->NodeInfo.DeviceID;
+		nodep->nodeInfo.Revision = np->NodeInfo.Revision;
+		nodep->nodeInfo.u1.s.VendorID = np->NodeInfo.u1.s.VendorID;
+
+		for (pi = cl_qmap_head(&np->Ports); pi != cl_qmap_end(&np->Ports);
+			 pi = cl_qmap_next(pi)) {
+			PortData *pp = PARENT_STRUCT(pi, PortData, NodePortsEntry);
+			STL_PORT_INFO *pip;
+
+			if (pp->PortNum > nodep->nodeInfo.NumPorts)
+				continue;
+			if (pp->PortGUID && (pp->PortNum == 0 || np->NodeInfo.NodeType == STL_NODE_FI))
+				nodep->nodeInfo.PortGUID = pp->PortGUID;
+
+			// keep what the hardware reported it can do, reset what the SM sets
+			pip = &nodep->ports[pp->PortNum].portInfo;
+			*pip = pp->PortInfo;
+			pip->LID = 0;
+			pip->s1.LMC = 0;
+			pip->MasterSMLID = 0;
+			pip->M_Key = 0;
+			pip->CapabilityMask.s.IsSM = 0;
+			pip->PortStates.s.PortState = IB_PORT_DOWN;
+			pip->PortStates.s.PortPhysicalState = IB_PORT_PHYS_POLLING;
+			pip->PortStates.s.NeighborNormal = 0;
+			pip->PortStates.s.IsSMConfigurationStarted = 0;
+			pip->NeighborPortNum = 0;
+			pip->NeighborNodeGUID = 0;
+			pip->LocalPortNum = pp->PortNum;
+			if (pp->PortNum == 0) {
+				pip->PortStates.s.PortState = IB_PORT_INIT;
+				pip->PortStates.s.PortPhysicalState = IB_PORT_PHYS_LINKUP;
+			}
+		}
+	}
+
+	// links, each once from the lower GUID side
+	for (mi = cl_qmap_head(&fabric.AllNodes); mi != cl_qmap_end(&fabric.AllNodes);
+		 mi = cl_qmap_next(mi)) {
+		NodeData *np = PARENT_STRUCT(mi, NodeData, AllNodesEntry);
+
+		if (np->context == NULL)
+			continue;
+		for (pi = cl_qmap_head(&np->Ports); pi != cl_qmap_end(&np->Ports);
+			 pi = cl_qmap_next(pi)) {
+			PortData *pp = PARENT_STRUCT(pi, PortData, NodePortsEntry);
+			PortData *nbr = pp->neighbor;
+
+			if (pp->PortNum == 0 || nbr == NULL || nbr->nodep->context == NULL)
+				continue;
+			if (nbr->nodep->NodeInfo.NodeGUID < np->NodeInfo.NodeGUID
+				|| (nbr->nodep == np && nbr->PortNum < pp->PortNum))
+				continue;
+			(void)cs_sim_connect((cs_sim_node_t *)np->context, pp->PortNum,
+								 (cs_sim_node_t *)nbr->nodep->context, nbr->PortNum);
+		}
+	}
+
+done:
+	DestroyFabricData(&fabric);
+	return status;
+}
+
+//==============================================================================
+// cs_sim_parse_dims
+//==============================================================================
+static int
+cs_sim_parse_dims(const char *str, uint32_t *vals, int count)
+{
+	int i;
+	char *end;
+
+	for (i = 0; i < count; i++) {
+		if (!isdigit((unsigned char)*str))
+			return 0;
+		vals[i] = (uint32_t)strtoul(str, &end, 0);
+		str = end;
+		if (i < count - 1) {
+			if (*str != ',' && *str != 'x')
+				return 0;
+			str++;
+		}
+	}
+	return *str == '\0';
+}
+
+//==============================================================================
+// cs_sim_build
+//
+// spec is "fattree:<leaves>,<spines>,<hfis per leaf>",
+// "torus:<x>,<y>,<z>,<hfis per switch>" or the name of a snapshot file
+//==============================================================================
+Status_t
+cs_sim_build(cs_sim_fabric_t *fabricp, const char *spec)
+{
+	uint32_t vals[4];
+	Status_t status;
+
+	memset(fabricp, 0, sizeof(*fabricp));
+
+	if (strncasecmp(spec, "fattree:", 8) == 0) {
+		if (!cs_sim_parse_dims(spec + 8, vals, 3)) {
+			IB_LOG_ERROR_FMT(__func__, "invalid simulated fabric %s", spec);
+			return VSTATUS_ILLPARM;
+		}
+		status = cs_sim_build_fattree(fabricp, vals[0], vals[1], vals[2]);
+	} else if (strncasecmp(spec, "torus:", 6) == 0) {
+		if (!cs_sim_parse_dims(spec + 6, vals, 4)) {
+			IB_LOG_ERROR_FMT(__func__, "invalid simulated fabric %s", spec);
+			return VSTATUS_ILLPARM;
+		}
+		status = cs_sim_build_torus(fabricp, vals, vals[3]);
+	} else {
+		status = cs_sim_load_snapshot(fabricp, spec);
+	}
+
+	if (status != VSTATUS_OK) {
+		cs_sim_free(fabricp);
+		return status;
+	}
+	IB_LOG_INFINI_INFO_FMT(__func__, "simulated fabric %s: %u nodes", spec, fabricp->numNodes);
+	return VSTATUS_OK;
+}
+
+//==============================================================================
+// cs_sim_free
+//==============================================================================
+void
+cs_sim_free(cs_sim_fabric_t *fabricp)
+{
+	uint32_t i;
+	cl_map_item_t *mi;
+
+	for (i = 0; i < fabricp->numNodes; i++) {
+		cs_sim_node_t *nodep = fabricp->nodes[i];
+		while ((mi = cl_qmap_head(&nodep->attrs)) != cl_qmap_end(&nodep->attrs)) {
+			cl_qmap_remove_item(&nodep->attrs, mi);
+			free(PARENT_STRUCT(mi, cs_sim_attr_t, item));
+		}
+		free(nodep->lft);
+		free(nodep->ports);
+		free(nodep);
+	}
+	free(fabricp->nodes);
+	free(fabricp->lids);
+	memset(fabricp, 0, sizeof(*fabricp));
+}
@@ -0,0 +1,10 @@
+include Makefile
+include build.ALL_EMB.release/reli.c.dep
+include build.ALL_EMB.release/felib.c.dep
+include build.ALL_EMB.release/service.c.dep
+include build.ALL_EMB.release/vfi.c.dep
+include build.ALL_EMB.release/rmpp.c.dep
+include build.ALL_EMB.release/if3_ssl.c.dep
+include build.ALL_EMB.release/hsm_com_server.c.dep
+include build.ALL_EMB.release/hsm_com_srvr_api.c.dep
+include build.ALL_EMB.release/hsm_com_srvr_common.c.dep
@@ -63,7 +63,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define IB_LOG_ERROR(_x,_y) printf (" %s : %u \n",_x,(int)_y);
 #endif
 
-#define MAX_MANAGER       (12)
+#define MAX_MANAGER       (20)      // room for a handle per FE passthrough worker
 #define FE_MANAGER_SL     (0)
 #define FE_MANAGER_PKEY   (mai_get_default_pkey())
 #define FE_MANAGER_QKEY   (GSI_WELLKNOWN_QKEY)
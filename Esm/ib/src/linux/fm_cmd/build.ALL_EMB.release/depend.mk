@@ -0,0 +1,6 @@
+include Makefile
+include build.ALL_EMB.release/fm_cmd.c.dep
+include build.ALL_EMB.release/hsm_com_client_api.c.dep
+include build.ALL_EMB.release/hsm_com_client_common.c.dep
+include build.ALL_EMB.release/hsm_config_client.c.dep
+include build.ALL_EMB.release/hsm_com_client.c.dep
@@ -66,6 +66,7 @@ int sm_restore_priority(p_fm_config_conx_hdlt hdl, fm_mgr_type_t mgr, int argc,
 int sm_broadcast_xml_config(p_fm_config_conx_hdlt hdl, fm_mgr_type_t mgr, int argc, char *argv[]);
 int sm_get_counters(p_fm_config_conx_hdlt hdl, fm_mgr_type_t mgr, int argc, char *argv[]);
 int sm_reset_counters(p_fm_config_conx_hdlt hdl, fm_mgr_type_t mgr, int argc, char *argv[]);
+int sm_get_sweep_profile(p_fm_config_conx_hdlt hdl, fm_mgr_type_t mgr, int argc, char *argv[]);
 int pm_get_counters(p_fm_config_conx_hdlt hdl, fm_mgr_type_t mgr, int argc, char *argv[]);
 int pm_reset_counters(p_fm_config_conx_hdlt hdl, fm_mgr_type_t mgr, int argc, char *argv[]);
 int sm_state_dump(p_fm_config_conx_hdlt hdl, fm_mgr_type_t mgr, int argc, char *argv[]);
@@ -104,6 +105,7 @@ static command_t commandList[] = {
 	{"smRestorePriority", sm_restore_priority, FM_MGR_SM, "Restore the normal priority of the SM (if it is\n                           currently elevated)"},
 	{"smShowCounters", sm_get_counters, FM_MGR_SM, "Get statistics and performance counters from the SM"},
 	{"smResetCounters",sm_reset_counters, FM_MGR_SM, "Reset SM statistics and performace counters"},
+	{"smShowSweepProfile", sm_get_sweep_profile, FM_MGR_SM, "Get per phase sweep timings and MAD round trip\n                           histograms from the SM"},
 	{"smStateDump",sm_state_dump, FM_MGR_SM, "Dump Internal SM state into directory specified"},
 	{"smLogLevel", mgr_log_level, FM_MGR_SM, "Set the SM logging level (0=NONE+, 1=WARN+, 2=NOTICE+,\n                           3=INFO+, 4=VERBOSE+, 5=DEBUG2+, 6=DEBUG4+, 7=TRACE+)"},
 	{"smLogMode", mgr_log_mode, FM_MGR_SM, "Set the SM log mode flags (0/1 1=downgrade\n                           non-actionable, 0/2 2=logfile only)"},
@@ -239,6 +241,26 @@ int sm_get_counters(p_fm_config_conx_hdlt hdl, fm_mgr_type_t mgr, int argc, char
 	return 0;
 }
 
+int sm_get_sweep_profile(p_fm_config_conx_hdlt hdl, fm_mgr_type_t mgr, int argc, char *argv[]) {
+	fm_mgr_config_errno_t	res;
+	fm_msg_ret_code_t		ret_code;
+	uint8_t data[BUF_SZ];
+	time_t timeNow;
+
+	if((res = fm_mgr_simple_query(hdl, FM_ACT_GET, FM_DT_SM_GET_SWEEP_PROFILE, mgr, BUF_SZ, data, &ret_code)) != FM_CONF_OK)
+	{
+		fprintf(stderr, "sm_get_sweep_profile: Failed to retrieve data: \n"
+		       "\tError:(%d) %s \n\tRet code:(%d) %s\n",
+		       res, fm_mgr_get_error_str(res),ret_code,
+		       fm_mgr_get_resp_error_str(ret_code));
+	} else {
+		time(&timeNow);
+		data[BUF_SZ-1]=0;
+		printf("SM Sweep Profile as of %s%s", ctime(&timeNow), (char*) data);
+    }
+	return 0;
+}
+
 int pm_get_counters(p_fm_config_conx_hdlt hdl, fm_mgr_type_t mgr, int argc, char *argv[]) {
 	fm_mgr_config_errno_t	res;
 	fm_msg_ret_code_t		ret_code;
@@ -200,6 +200,7 @@ typedef enum{
 	FM_DT_SM_SKIP_ATTRIBUTE_WRITE,
 	FM_DT_PAUSE_SWEEPS,
 	FM_DT_RESUME_SWEEPS,
+	FM_DT_SM_GET_SWEEP_PROFILE,
 }fm_datatype_t;
 
 typedef struct fm_error_map_s{
@@ -37,6 +37,7 @@ cmd=(
 	"smForceSweep"
 	"smRestorePriority"
 	"smShowCounters"
+	"smShowSweepProfile"
 	"smResetCounters"
 	"smStateDump"
 	"smLogLevel 4"
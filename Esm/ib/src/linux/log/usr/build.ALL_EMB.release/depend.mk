@@ -0,0 +1,2 @@
+include Makefile
+include build.ALL_EMB.release/vslog.c.dep
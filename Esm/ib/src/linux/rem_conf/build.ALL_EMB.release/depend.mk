@@ -0,0 +1 @@
+include Makefile
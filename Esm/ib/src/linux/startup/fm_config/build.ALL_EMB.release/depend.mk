@@ -0,0 +1,3 @@
+include Makefile
+include build.ALL_EMB.release/config_convert.c.dep
+include build.ALL_EMB.release/config_check.c.dep
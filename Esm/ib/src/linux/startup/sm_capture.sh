@@ -91,6 +91,7 @@ dump_sm_instance()
 	# $2 =dir
 	echo "Getting SM $1 counters..."
 	$OPA_FM_BASE/bin/fm_cmd -i$1 smShowCounters > $2/smShowCounters
+	$OPA_FM_BASE/bin/fm_cmd -i$1 smShowSweepProfile > $2/smShowSweepProfile
 
 	echo "Getting PM $1 counters..."
 	$OPA_FM_BASE/bin/fm_cmd -i$1 pmShowCounters > $2/pmShowCounters
@@ -0,0 +1,10 @@
+include Makefile
+include build.ALL_EMB.release/mai.c.dep
+include build.ALL_EMB.release/mai_fcmp.c.dep
+include build.ALL_EMB.release/mai_config.c.dep
+include build.ALL_EMB.release/mai_filter.c.dep
+include build.ALL_EMB.release/mai_util.c.dep
+include build.ALL_EMB.release/mai_futil.c.dep
+include build.ALL_EMB.release/mai_dc.c.dep
+include build.ALL_EMB.release/mai_filter_common.c.dep
+include build.ALL_EMB.release/mai_tid.c.dep
@@ -574,7 +574,7 @@ mai_recv(IBhandle_t fd, Mai_t * buf, uint64_t timeout)
 	  md = mai_dequeue_mbuff(act);
 
 	  if (md) {
-	  	memcpy((void *) buf, (void *) &md->mad, sizeof(md->mad));
+	  	memcpy((void *) buf, (void *) MAI_MBUFF_MAD(md), sizeof(*buf));
 	  	mai_free_mbuff(md);
 	  } 
 
@@ -85,6 +85,8 @@ uint32_t        gMAI_MAX_DATA = MAI_MAX_DATA_DEFAULT;
 
 uint32_t        gMAI_MADS_LOWWM = MAI_MADS_LOWWM_DEFAULT;
 
+volatile unsigned int gMAI_FILTER_GEN;
+
 #ifdef MAI_STATS
 mai_stats_t     gMAI_STATS;
 #endif
@@ -443,6 +445,7 @@ mai_init()
      * Initialize filter subsysem 
      */
     maif_init();
+    mai_fidx_init();
 
     rc = ib_init_sma(gMAI_MAX_DATA);
     if (rc != VSTATUS_OK)
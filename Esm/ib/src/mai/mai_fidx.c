@@ -0,0 +1,246 @@
+/* BEGIN_ICS_COPYRIGHT5 ****************************************
+
+Copyright (c) 2015, Intel Corporation
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Intel Corporation nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+** END_ICS_COPYRIGHT5   ****************************************/
+
+/****************************************************************************
+ *                                                                          *
+ * FILE NAME                                               VERSION          *
+ *      mai_fidx.c                                         MAPI 0.05        *
+ *                                                                          *
+ * DESCRIPTION                                                              *
+ *      This file contains the compiled filter dispatch index used by       *
+ *      mai_mad_process to find the filters a received MAD can match        *
+ *      without running maif_match against every filter on every channel.  *
+ *                                                                          *
+ * DATA STRUCTURES                                                          *
+ *      mai_fidx                        see mai_l.h                         *
+ *                                                                          *
+ ****************************************************************************/
+
+#include "mai_l.h"		/* Local mai function definitions */
+
+static MaiFidx_t gMAI_FIDX;
+
+/*
+ * FUNCTION
+ *   mai_fidx_reset
+ *
+ * DESCRIPTION
+ *   Drop all cached keys.  Called holding MAI_UPCHANNELS_LOCK.
+ */
+static void
+mai_fidx_reset(unsigned int gen)
+{
+    memset(gMAI_FIDX.entry, 0, sizeof(gMAI_FIDX.entry));
+    gMAI_FIDX.nentries = 0;
+    gMAI_FIDX.ncands = 0;
+    gMAI_FIDX.gen = gen;
+}
+
+/*
+ * FUNCTION
+ *   mai_fidx_init
+ *
+ * DESCRIPTION
+ *   Initialize the dispatch index to empty.
+ */
+void
+mai_fidx_init(void)
+{
+    gMAI_FILTER_GEN = 0;
+    mai_fidx_reset(0);
+}
+
+/*
+ * FUNCTION
+ *   mai_fidx_compatible
+ *
+ * DESCRIPTION
+ *   Returns true if the filter could accept a MAD with the given class,
+ *   method and attribute.  This only looks at the three fields of the
+ *   index key, maif_match makes the final decision.
+ */
+static __inline__ int
+mai_fidx_compatible(Filter_t * filter, Mad_t * base)
+{
+    if (!(filter->active & MAI_ACT_FMASK))
+	return 1;
+
+    return ((filter->value.mclass ^ base->mclass) & filter->mask.mclass) == 0
+	&& ((filter->value.method ^ base->method) & filter->mask.method) == 0
+	&& ((filter->value.aid ^ base->aid) & filter->mask.aid) == 0;
+}
+
+/*
+ * FUNCTION
+ *   mai_fidx_build
+ *
+ * DESCRIPTION
+ *   Walk all up channels and their filters in dispatch order and append
+ *   those compatible with the key to the candidate pool.
+ *
+ * RETURNS
+ *   0   It worked
+ *  !0   Out of candidate slots or a corrupt list, caller must scan
+ */
+static int
+mai_fidx_build(MaiFidxEntry_t * entry, Mad_t * base)
+{
+    struct mai_fd  *chan;
+    struct mai_filter *filt;
+    int             limit = 0;
+    int             limit2;
+
+    entry->first = gMAI_FIDX.ncands;
+    entry->count = 0;
+
+    for (chan = gMAI_UP_CHANNELS; chan != NULL; chan = chan->next)
+      {
+	  if (limit++ > MAI_MAX_CHANNELS)
+	      return 1;
+
+	  limit2 = 0;
+
+	  MAI_HANDLE_LOCK(chan);
+
+	  for (filt = chan->sfilters; filt; filt = filt->next)
+	    {
+		if (limit2++ > MAI_MAX_FILTERS)
+		  {
+		      MAI_HANDLE_UNLOCK(chan);
+		      return 1;
+		  }
+
+		if (!mai_fidx_compatible(&filt->filter, base))
+		    continue;
+
+		if (gMAI_FIDX.ncands >= MAI_FIDX_CANDS)
+		  {
+		      MAI_HANDLE_UNLOCK(chan);
+		      return 1;
+		  }
+
+		gMAI_FIDX.cand[gMAI_FIDX.ncands].chan = chan;
+		gMAI_FIDX.cand[gMAI_FIDX.ncands].filt = filt;
+		gMAI_FIDX.cand[gMAI_FIDX.ncands].gen = chan->filt_gen;
+		gMAI_FIDX.ncands++;
+		entry->count++;
+	    }
+
+	  MAI_HANDLE_UNLOCK(chan);
+      }
+
+    return 0;
+}
+
+/*
+ * FUNCTION
+ *   mai_fidx_lookup
+ *
+ * DESCRIPTION
+ *   Find, or compile on first use, the index entry for the class, method
+ *   and attribute of a MAD.  Must be called holding MAI_UPCHANNELS_LOCK
+ *   and the entry is only valid while it is held.
+ *
+ * INPUTS
+ *   mad    The received MAD
+ *
+ * RETURNS
+ *   NULL - The index could not hold the entry, scan all channels
+ *  !NULL - Pointer to the entry
+ */
+MaiFidxEntry_t *
+mai_fidx_lookup(Mai_t * mad)
+{
+    MaiFidxEntry_t *entry;
+    uint32_t        key;
+    unsigned int    gen;
+    int             slot,
+                    i;
+
+    MAI_ASSERT_TRUE((gmai_uplock.locked));
+
+    gen = gMAI_FILTER_GEN;
+    if (gen != gMAI_FIDX.gen)
+	mai_fidx_reset(gen);
+
+    key = MAI_FIDX_KEY(&mad->base);
+    slot = (int)((key * 2654435761U) >> 24) & (MAI_FIDX_SLOTS - 1);
+
+    for (i = 0; i < MAI_FIDX_SLOTS; i++)
+      {
+	  entry = &gMAI_FIDX.entry[(slot + i) & (MAI_FIDX_SLOTS - 1)];
+	  if (!entry->valid)
+	      break;
+	  if (entry->key == key)
+	      return entry;
+      }
+
+    /*
+     * Keep the table at most 3/4 full, so probes stay short.  When full
+     * or out of candidates, start over with just this key.
+     */
+    if (gMAI_FIDX.nentries >= (MAI_FIDX_SLOTS * 3) / 4)
+      {
+	  mai_fidx_reset(gen);
+	  entry = &gMAI_FIDX.entry[slot];
+      }
+
+    if (mai_fidx_build(entry, &mad->base))
+      {
+	  i = gMAI_FIDX.nentries;
+	  mai_fidx_reset(gen);
+	  if (i == 0)
+	      return NULL;
+	  entry = &gMAI_FIDX.entry[slot];
+	  if (mai_fidx_build(entry, &mad->base))
+	    {
+		mai_fidx_reset(gen);
+		return NULL;
+	    }
+      }
+
+    entry->key = key;
+    entry->valid = 1;
+    gMAI_FIDX.nentries++;
+
+    return entry;
+}
+
+/*
+ * FUNCTION
+ *   mai_fidx_cands
+ *
+ * DESCRIPTION
+ *   Returns the first of entry->count candidates for an index entry.
+ */
+MaiFidxCand_t  *
+mai_fidx_cands(MaiFidxEntry_t * entry)
+{
+    return &gMAI_FIDX.cand[entry->first];
+}
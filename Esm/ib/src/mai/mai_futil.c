@@ -111,7 +111,7 @@ mai_filter_purge(struct mai_fd *act, Filter_t * ft)
 		return;
 	    }
 
-	  rc = maif_match(&md->mad, ft);
+	  rc = maif_match(MAI_MBUFF_MAD(md), ft);
 
 	  if (!rc)
 	    {
@@ -158,7 +158,7 @@ mai_filter_purge(struct mai_fd *act, Filter_t * ft)
 		/*
 		 * See if this MAD matches this filter 
 		 */
-		rc = maif_match(&md->mad, &q->filter);
+		rc = maif_match(MAI_MBUFF_MAD(md), &q->filter);
 
 		if (rc)
 		  {
@@ -184,7 +184,7 @@ mai_filter_purge(struct mai_fd *act, Filter_t * ft)
 	   * Move to next MAD 
 	   */
 	  md = md->next;
-	  madp = &del->mad;
+	  madp = MAI_MBUFF_MAD(del);
 
 	  MSTATS_FD_MADDECR(act);
 	  MSTATS_FD_RX(act, madp->type);
@@ -491,6 +491,9 @@ mai_filter_dequeue(struct mai_fd *chanp, struct mai_filter *filt)
     filt->prev = NULL;
     filt->owner = NULL;
 
+    chanp->filt_gen++;
+    gMAI_FILTER_GEN++;
+
     MSTATS_FD_FILTREM(chanp);
 
     IB_EXIT(__func__, filt);
@@ -544,6 +547,9 @@ mai_filter_enqueue(struct mai_fd *chanp, struct mai_filter *filt)
 
     filt->owner = chanp;
 
+    chanp->filt_gen++;
+    gMAI_FILTER_GEN++;
+
     MSTATS_FD_FILTADD(chanp);
 
     IB_EXIT(__func__, 0);
@@ -168,9 +168,20 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 struct mai_data {
     struct mai_data *next;	/* Next MAD */
     int             state;	/* Current state - FREE,BUSY */
+    struct mai_data *shared;	/* Buffer holding the MAD, may be self */
+    int             ref;	/* References to mad, when shared == self */
     Mai_t           mad;	/* Actual data when BUSY or READY */
 };
 
+/*
+ * MAI_MBUFF_MAD
+ *   A MAD delivered to several channels is copied once.  Every channel
+ * gets its own mai_data for queueing, but they all point at the buffer
+ * of the first one, which is held until the last reference is freed.
+ * Consumers must only read the MAD through this macro.
+ */
+#define MAI_MBUFF_MAD(md) (&(md)->shared->mad)
+
 /*
  * mai_filter
  *   This internal data structure describes one filter that has been
@@ -340,11 +351,52 @@ typedef struct mai_fd {
     Eventset_t      hdl_emask;   /* Event mask to wait on/post         */
 
     unsigned int    incarn;	/* the open incarnation number */
+    unsigned int    filt_gen;	/* bumped when sfilters changes */
 #ifdef MAI_STATS
     mai_fd_stats_t  stats;	/* statistics on fd */
 #endif
 } mai_fd_t;
 
+/*
+ * mai_fidx
+ *   Compiled dispatch index used by mai_mad_process.  For each
+ * (mclass, method, aid) seen, it caches the ordered list of filters on
+ * all up channels whose value/mask could accept a MAD with that key, so
+ * only those need a full maif_match.  Any change to a filter list or to
+ * the up channel list bumps gMAI_FILTER_GEN and the whole index is
+ * dropped on the next lookup.  Each candidate also records the filt_gen
+ * of its channel so that a list changed under the handle lock alone is
+ * detected and that channel is scanned the old way.
+ *
+ * Protected by MAI_UPCHANNELS_LOCK.
+ */
+#define MAI_FIDX_SLOTS	(256)			/* power of 2 */
+#define MAI_FIDX_CANDS	(MAI_MAX_FILTERS * 4)
+
+typedef struct mai_fidx_cand {
+    struct mai_fd     *chan;	/* Channel owning filt */
+    struct mai_filter *filt;	/* Filter that may match */
+    unsigned int       gen;	/* chan->filt_gen when cached */
+} MaiFidxCand_t;
+
+typedef struct mai_fidx_entry {
+    int             valid;	/* Slot is in use */
+    uint32_t        key;	/* mclass<<24 | method<<16 | aid */
+    int             first;	/* Index of first candidate */
+    int             count;	/* Number of candidates */
+} MaiFidxEntry_t;
+
+typedef struct mai_fidx {
+    unsigned int    gen;	/* gMAI_FILTER_GEN when built */
+    int             nentries;	/* Slots in use */
+    int             ncands;	/* Candidates in use */
+    MaiFidxEntry_t  entry[MAI_FIDX_SLOTS];
+    MaiFidxCand_t   cand[MAI_FIDX_CANDS];
+} MaiFidx_t;
+
+#define MAI_FIDX_KEY(b) (((uint32_t)(b)->mclass << 24) | \
+                         ((uint32_t)(b)->method << 16) | (b)->aid)
+
 #ifdef MAI_STATS
 #define MSTATS_FD_TX MSTATS_DC_TX
 #define MSTATS_FD_RX MSTATS_DC_RX
@@ -436,6 +488,10 @@ int             maif_reduce(Filter_t * filt1, Filter_t * filt2);
  *   Used to chain together all the currently available elements in
  * gMAI_MAD_BUFFS[] (through mai_data.next).
  *
+ * gMAI_FILTER_GEN
+ *   Bumped whenever a filter or an up channel is added or removed.  Used
+ * to invalidate the compiled dispatch index (see mai_fidx).
+ *
  * gMAI_INITIALIZED
  *   Checks for recursive initialization calls and allows functions to
  * verify that initialization has taken place.
@@ -478,6 +534,8 @@ extern uint32_t gMAI_MAX_DATA;
 
 extern uint32_t gMAI_MADS_LOWWM;
 
+extern volatile unsigned int gMAI_FILTER_GEN;
+
 #define MAI_INVALID (-1)
 
 /*
@@ -576,8 +634,14 @@ void            mai_free_dc(struct mai_dc *dc);
 int             mai_validate_filter(Filter_t * filter);
 
 struct mai_data *mai_alloc_mbuff(Mai_t * rawmad);
+struct mai_data *mai_share_mbuff(struct mai_data *owner);
+void            mai_hold_mbuff(struct mai_data *owner);
 void            mai_free_mbuff(struct mai_data *fmad);
 
+void            mai_fidx_init(void);
+MaiFidxEntry_t *mai_fidx_lookup(Mai_t * mad);
+MaiFidxCand_t  *mai_fidx_cands(MaiFidxEntry_t * entry);
+
 int             mai_enqueue_mbuff(struct mai_data *mad,
 				  struct mai_fd *chan);
 struct mai_data *mai_dequeue_mbuff(struct mai_fd *chan);
@@ -180,6 +180,8 @@ mai_alloc_mbuff(Mai_t * rawmad)
      */
     newmad->next = NULL;
     newmad->state = MAI_BUSY;
+    newmad->shared = newmad;
+    newmad->ref = 1;
     memcpy(&newmad->mad, rawmad, sizeof(newmad->mad));
 
     MSTATS_DATA_USE();
@@ -190,26 +192,101 @@ mai_alloc_mbuff(Mai_t * rawmad)
 
 /*
  * FUNCTION
- *   mai_free_mad_buff
+ *   mai_share_mbuff
  *
- *  DESCRIPTION 
- *   This function requeues  a MAD buffer to the free list
+ * DESCRIPTION
+ *   This function allocates a free mai_data element for queueing which
+ *   refers to the MAD already held by owner instead of copying it.
  *
  * INPUTS
- *   fmad    the MAD buffer being freed.
+ *     owner    buffer returned by mai_alloc_mbuff
  *
  * RETURNS
+ *   NULL - No buffers available
+ *  !NULL - Pointer to the new element
+ */
+struct mai_data *
+mai_share_mbuff(struct mai_data *owner)
+{
+    struct mai_data *newmad;
+
+    IB_ENTER(__func__, owner, 0, 0, 0);
+
+    MAI_MBUFFS_LOCK();
+
+    newmad = gMAI_DATA_FREE;
+
+    if (!newmad)
+      {
+	  MAI_MBUFFS_UNLOCK();
+
+	  /* Caller will log error */
+	  IB_EXIT(__func__, 0);
+
+	  MSTATS_NORESOURCE_INCR();
+	  return (NULL);
+      }
+
+    gMAI_DATA_FREE = newmad->next;
+    gMAI_MAD_CNT--;
+
+    MAI_ASSERT_TRUE((gMAI_MAD_CNT >= 0));
+
+    if (gMAI_MAD_CNT <= gMAI_MADS_LOWWM)
+      {
+	  if (smDebugPerf) IB_LOG_INFINI_INFO("Running low on free mad buffers cnt:", gMAI_MAD_CNT);
+      }
+
+    MAI_ASSERT_TRUE((owner->shared == owner && owner->ref > 0));
+    owner->ref++;
+
+    MAI_MBUFFS_UNLOCK();
+
+    newmad->next = NULL;
+    newmad->state = MAI_BUSY;
+    newmad->shared = owner;
+    newmad->ref = 0;
+
+    MSTATS_DATA_USE();
+
+    IB_EXIT(__func__, newmad);
+    return (newmad);
+}
+
+/*
+ * FUNCTION
+ *   mai_hold_mbuff
+ *
+ * DESCRIPTION
+ *   Take an additional reference on a buffer returned by mai_alloc_mbuff.
+ *   Each reference is dropped with mai_free_mbuff.
  *
+ * INPUTS
+ *     owner    buffer returned by mai_alloc_mbuff
  */
 void
-mai_free_mbuff(struct mai_data *fmad)
+mai_hold_mbuff(struct mai_data *owner)
 {
+    IB_ENTER(__func__, owner, 0, 0, 0);
 
-    IB_ENTER(__func__, fmad, 0, 0, 0);
+    MAI_MBUFFS_LOCK();
+    MAI_ASSERT_TRUE((owner->shared == owner && owner->ref > 0));
+    owner->ref++;
+    MAI_MBUFFS_UNLOCK();
 
-    fmad->state = MAI_FREE;
+    IB_EXIT(__func__, 0);
+}
 
-    MAI_MBUFFS_LOCK();
+/*
+ * requeue one mai_data element to the free list.  Called holding
+ * the mbuff lock.
+ */
+static void
+mai_release_mbuff(struct mai_data *fmad)
+{
+    fmad->state = MAI_FREE;
+    fmad->shared = NULL;
+    fmad->ref = 0;
 
     MSTATS_DATA_FREE();
 
@@ -220,6 +297,49 @@ mai_free_mbuff(struct mai_data *fmad)
 
     fmad->next = gMAI_DATA_FREE;
     gMAI_DATA_FREE = fmad;
+}
+
+/*
+ * FUNCTION
+ *   mai_free_mad_buff
+ *
+ *  DESCRIPTION 
+ *   This function requeues  a MAD buffer to the free list
+ *
+ * INPUTS
+ *   fmad    the MAD buffer being freed.
+ *
+ * RETURNS
+ *
+ */
+void
+mai_free_mbuff(struct mai_data *fmad)
+{
+    struct mai_data *owner;
+
+    IB_ENTER(__func__, fmad, 0, 0, 0);
+
+    MAI_MBUFFS_LOCK();
+
+    owner = fmad->shared;
+    if (!owner)
+      {
+	  /* never allocated, mai_init is seeding the free list */
+	  mai_release_mbuff(fmad);
+      }
+    else
+      {
+	  /*
+	   * The element holding the MAD stays allocated until the last
+	   * element sharing it has been freed
+	   */
+	  MAI_ASSERT_TRUE((owner->ref > 0));
+	  owner->ref--;
+	  if (fmad != owner)
+	      mai_release_mbuff(fmad);
+	  if (owner->ref == 0)
+	      mai_release_mbuff(owner);
+      }
 
     MAI_MBUFFS_UNLOCK();
 
@@ -286,7 +406,7 @@ mai_enqueue_mbuff(struct mai_data *mad, struct mai_fd *chan)
 
 		/* log SA mad count if greater than 80% of queue depth */
 		if (smDebugPerf) {
-			if (mad->mad.base.mclass == MAD_CV_SUBN_ADM && mad->mad.base.cversion == SA_MAD_CVERSION && chan->mad_cnt > (gMAI_MAX_QUEUED*4/5)) {
+			if (MAI_MBUFF_MAD(mad)->base.mclass == MAD_CV_SUBN_ADM && MAI_MBUFF_MAD(mad)->base.cversion == SA_MAD_CVERSION && chan->mad_cnt > (gMAI_MAX_QUEUED*4/5)) {
                 if (++num_times_since_logged >= 20) {
                     num_times_since_logged = 0;
                     IB_LOG_INFINI_INFO("Number of entries on SA queue now", chan->mad_cnt);
@@ -563,6 +683,8 @@ mai_enqueue_upchannel(struct mai_fd *new_fd)
      */
     MSTATS_UPCHAN_USE(new_fd->qp);
 
+    gMAI_FILTER_GEN++;
+
     MAI_UPCHANNELS_UNLOCK();
 
     IB_EXIT(__func__, 0);
@@ -623,6 +745,8 @@ mai_dequeue_upchannel(struct mai_fd *free_fd)
      */
     MSTATS_UPCHAN_FREE(free_fd->qp);
 
+    gMAI_FILTER_GEN++;
+
     MAI_UPCHANNELS_UNLOCK();
 
     IB_EXIT(__func__, 0);
@@ -632,11 +756,127 @@ mai_dequeue_upchannel(struct mai_fd *free_fd)
 
 
 
+/*
+ * Results of mai_mad_deliver
+ */
+#define MAI_DELIVER_NOMATCH  (0)	/* try the next filter on the channel */
+#define MAI_DELIVER_DONE     (1)	/* channel got it, go to next channel */
+#define MAI_DELIVER_NOBUF    (2)	/* out of buffers, give up on the MAD */
+
+/*
+ * mai_mad_deliver
+ *   Check one filter against a MAD and if it matches queue the MAD on the
+ * filter owner's channel.  The first channel to match gets the buffer
+ * allocated in *owner, later ones get an element sharing it.
+ *
+ *   Called holding MAI_UPCHANNELS_LOCK and the lock of chan.
+ */
+static int
+mai_mad_deliver(Mai_t * mad, struct mai_fd *chan, struct mai_filter *filt,
+		struct mai_data **owner, int *filterMatch)
+{
+    struct mai_data *data;	/* Points to the MAD */
+    int             rc;
+    uint64_t        timeNow=0;
+
+    /*
+     * See if this MAD matches this filter 
+     */
+    rc = maif_match(mad, &filt->filter);
+
+    if (!rc)
+	return MAI_DELIVER_NOMATCH;	/* No match, try the next one */
+
+    MSTATS_FMATCH_INCR(filt);
+
+    /*
+     * There is a match.  Copy the MAD once, and share that copy with any
+     * other channel that matches.
+     */
+    *filterMatch = 1;
+    if (*owner == NULL)
+      {
+	  data = *owner = mai_alloc_mbuff(mad);
+	  /* hold a reference of our own until all channels are done */
+	  if (data)
+	      mai_hold_mbuff(data);
+      }
+    else
+      {
+	  data = mai_share_mbuff(*owner);
+      }
+
+    if (!data)
+      {
+	  /*
+	   * If we ran out of buffers, drop it 
+	   */
+	  vs_time_get(&timeNow);
+	  if ((timeNow - time_last_underflow_logged) > MAX_USECS_BETWEEN_OVERUNDERFLOW_MESSAGES)
+	    {
+		time_last_underflow_logged = timeNow;
+		IB_LOG_INFINI_INFO_FMT(__func__,
+		       "Out of mad buffers, %s[%s] for filter %s not handled from LID [0x%x], TID=0x%.16"CS64"X, total since start=%d",
+		       cs_getMethodText((int)mad->base.method), cs_getAidName((int)mad->base.mclass, (int)mad->base.aid), filt->filter.fname, 
+		       mad->addrInfo.slid, mad->base.tid, gMAI_STATS.no_resource);
+	    }
+	  return MAI_DELIVER_NOBUF;
+      }
+
+    /*
+     * Chain it to the end of this channels input queue 
+     */
+    rc = mai_enqueue_mbuff(data, filt->owner);
+
+    if (rc)
+      {
+	  /*
+	   * NO - put the MAD back on free list 
+	   */
+	  mai_free_mbuff(data);
+
+	  vs_time_get(&timeNow);
+	  if ((timeNow - time_last_overflow_logged) > MAX_USECS_BETWEEN_OVERUNDERFLOW_MESSAGES)
+	    {
+		time_last_overflow_logged = timeNow;
+		IB_LOG_INFINI_INFO_FMT(__func__,
+		       "Cannot enqueue %s[%s] for filter %s, from LID [0x%x], TID=0x%.16"CS64"X, num mads dropped since start=%d",
+		       cs_getMethodText((int)mad->base.method), cs_getAidName((int)mad->base.mclass, (int)mad->base.aid), filt->filter.fname, 
+		       mad->addrInfo.slid, mad->base.tid, filt->owner->overflow);
+	    }
+	  return MAI_DELIVER_NOMATCH;
+      }
+
+    //IB_LOG_INFO("mai_mad_process added mad to up channel handle", chan->up_fd);
+    /*
+     * If the filter was a one shot filter then remove
+     * it 
+     */
+    if (filt->once)
+      {
+	  MAI_HANDLE_UNLOCK(chan);
+
+	  rc = mai_filter_hdelete(filt->owner->up_fd, filt->hndl);
+	  if (rc != VSTATUS_OK)
+	    {
+		IB_LOG_ERROR("Deleting one shot filter rc:", rc);
+	    }
+
+	  MAI_HANDLE_LOCK(chan);
+      }
+
+    return MAI_DELIVER_DONE;	// each channel gets a single notice of match
+}
+
 /*
  * mai_mad_process
  *   This function is called with a MAD and the QP it was received on.
- * We scan all outstanding regular filters (gMAI_UP_CHANNELS[qp]) duplicating
- * the MAD on the input queues of any channel with a matching filter.
+ * We look up the filters that could match in the compiled dispatch index
+ * (see mai_fidx.c), and queue the MAD on the input queue of any channel
+ * with a matching filter.  The MAD is copied once and shared by all
+ * channels.  If the index can not be used, or a channel's filters changed
+ * since the index was built, we scan all outstanding regular filters
+ * (gMAI_UP_CHANNELS[qp]) of the channel(s) as before.
  *
  * The function returns the total number of filter matches.
  *
@@ -649,15 +889,19 @@ mai_mad_process(Mai_t * mad, int *filterMatch)
 {
     struct mai_fd  *chan;	/* Loops over all channels */
     struct mai_filter *filt;	/* Loops over all filters on a channel */
-    struct mai_data *data;	/* Points to the MAD */
+    struct mai_data *owner;	/* Buffer holding the copy of the MAD */
+    MaiFidxEntry_t *fidx;	/* Index entry for this MAD */
+    MaiFidxCand_t  *cand;	/* Candidate filters from the index */
+    int             ncand;
     int             handled;	/* Total number of duplicates created */
     int             limit;	/* Used to avoid linked list bugs */
     int             limit2;	/* Ditto */
-    int             rc;
-    uint64_t        timeNow=0;
+    int             rc = MAI_DELIVER_NOMATCH;
+    int             i;
 
     IB_ENTER(__func__, mad, 0, 0, 0);
     handled = 0;		/* Start from scratch */
+    owner = NULL;
 
     /*
      * Scan the filter lists for all open channels looking for matches 
@@ -665,135 +909,131 @@ mai_mad_process(Mai_t * mad, int *filterMatch)
 
     MAI_UPCHANNELS_LOCK();
 
-    limit = 0;
+    fidx = (gMAI_INITIALIZED != 0) ? mai_fidx_lookup(mad) : NULL;
 
-    for (chan = gMAI_UP_CHANNELS;
-	 (chan != NULL) && (gMAI_INITIALIZED != 0); chan = chan->next)
+    if (fidx)
       {
-	  if (limit++ > MAI_MAX_CHANNELS)
-	    {
-		MAI_UPCHANNELS_UNLOCK();
-		IB_LOG_ERROR("Channel list corrupt limit:",
-			     limit);
-		mai_shut_down();
-		return 0;
-	    }
-
-	  limit2 = 0;
-
-	  MAI_HANDLE_LOCK(chan);
+	  /*
+	   * Candidates are grouped by channel, in channel list order 
+	   */
+	  cand = mai_fidx_cands(fidx);
+	  ncand = fidx->count;
 
-	  for (filt = chan->sfilters; filt; filt = filt->next)
+	  for (i = 0; i < ncand && gMAI_INITIALIZED != 0; )
 	    {
-		if (limit2++ > MAI_MAX_FILTERS)
-		  {
+		chan = cand[i].chan;
 
-		      MAI_HANDLE_UNLOCK(chan);
-		      MAI_UPCHANNELS_UNLOCK();
+		MAI_HANDLE_LOCK(chan);
 
-		      IB_LOG_ERROR("Filter list corrupt limit:",
-				   limit2);
-		      mai_shut_down();
-		      return 0;
+		if (chan->filt_gen != cand[i].gen)
+		  {
+			/*
+			 * The filters changed under us, scan them all 
+			 */
+			limit2 = 0;
+			for (filt = chan->sfilters; filt; filt = filt->next)
+			  {
+			    if (limit2++ > MAI_MAX_FILTERS)
+			      {
+				  MAI_HANDLE_UNLOCK(chan);
+				  MAI_UPCHANNELS_UNLOCK();
+				  if (owner) mai_free_mbuff(owner);
+
+				  IB_LOG_ERROR("Filter list corrupt limit:",
+					       limit2);
+				  mai_shut_down();
+				  return 0;
+			      }
+			    rc = mai_mad_deliver(mad, chan, filt, &owner, filterMatch);
+			    if (rc != MAI_DELIVER_NOMATCH)
+				break;
+			  }
+		  }
+		else
+		  {
+			for (; i < ncand && cand[i].chan == chan; i++)
+			  {
+			    rc = mai_mad_deliver(mad, chan, cand[i].filt, &owner, filterMatch);
+			    if (rc != MAI_DELIVER_NOMATCH)
+				break;
+			  }
 		  }
 
-		/*
-		 * See if this MAD matches this filter 
-		 */
-		rc = maif_match(mad, &filt->filter);
-
-		if (!rc)
-		    continue;	/* No match, try the next one */
+		MAI_HANDLE_UNLOCK(chan);
 
-		MSTATS_FMATCH_INCR(filt);
+		if (rc == MAI_DELIVER_NOBUF)
+		    break;
+		if (rc == MAI_DELIVER_DONE)
+		    handled++;
 
-		/*
-		 * There is a match.  Create a new MAD and add to this guy 
-		 */
-        *filterMatch = 1;
-		data = mai_alloc_mbuff(mad);
+		/* skip the rest of this channel's candidates */
+		while (i < ncand && cand[i].chan == chan)
+		    i++;
+		rc = MAI_DELIVER_NOMATCH;
+	    }
+      }
+    else
+      {
+	  limit = 0;
 
-		if (!data)
+	  for (chan = gMAI_UP_CHANNELS;
+	       (chan != NULL) && (gMAI_INITIALIZED != 0); chan = chan->next)
+	    {
+		if (limit++ > MAI_MAX_CHANNELS)
 		  {
-		      /*
-		       * If we ran out of buffers, drop it 
-		       */
-		      MAI_HANDLE_UNLOCK(chan);
 		      MAI_UPCHANNELS_UNLOCK();
-
-              vs_time_get(&timeNow);
-              if ((timeNow - time_last_underflow_logged) > MAX_USECS_BETWEEN_OVERUNDERFLOW_MESSAGES)
-                {
-                    time_last_underflow_logged = timeNow;
-                    IB_LOG_INFINI_INFO_FMT(__func__,
-                           "Out of mad buffers, %s[%s] for filter %s not handled from LID [0x%x], TID=0x%.16"CS64"X, total since start=%d",
-                           cs_getMethodText((int)mad->base.method), cs_getAidName((int)mad->base.mclass, (int)mad->base.aid), filt->filter.fname, 
-                           mad->addrInfo.slid, mad->base.tid, gMAI_STATS.no_resource);
-                }
-
-		      IB_EXIT(__func__, handled);
-		      return (handled);
+		      if (owner) mai_free_mbuff(owner);
+		      IB_LOG_ERROR("Channel list corrupt limit:",
+				   limit);
+		      mai_shut_down();
+		      return 0;
 		  }
 
-		/*
-		 * Chain it to the end of this channels input queue 
-		 */
-		rc = mai_enqueue_mbuff(data, filt->owner);
+		limit2 = 0;
 
-		if (rc)
-		  {
-		      /*
-		       * NO - put the MAD back on free list 
-		       */
-		      mai_free_mbuff(data);
+		MAI_HANDLE_LOCK(chan);
 
-              vs_time_get(&timeNow);
-              if ((timeNow - time_last_overflow_logged) > MAX_USECS_BETWEEN_OVERUNDERFLOW_MESSAGES)
-			    {
-                    time_last_overflow_logged = timeNow;
-                    IB_LOG_INFINI_INFO_FMT(__func__,
-                           "Cannot enqueue %s[%s] for filter %s, from LID [0x%x], TID=0x%.16"CS64"X, num mads dropped since start=%d",
-                           cs_getMethodText((int)mad->base.method), cs_getAidName((int)mad->base.mclass, (int)mad->base.aid), filt->filter.fname, 
-                           mad->addrInfo.slid, mad->base.tid, filt->owner->overflow);
-			    }
-		  }
-		else
+		for (filt = chan->sfilters; filt; filt = filt->next)
 		  {
-		      //IB_LOG_INFO("mai_mad_process added mad to up channel handle", chan->up_fd);
-		      /*
-		       * If the filter was a one shot filter then remove
-		       * it 
-		       */
-		      if (filt->once)
+		      if (limit2++ > MAI_MAX_FILTERS)
 			{
-			    MAI_HANDLE_UNLOCK(chan);
 
-			    rc = mai_filter_hdelete(filt->owner->up_fd,
-						    filt->hndl);
-			    if (rc != VSTATUS_OK)
-			      {
-				  IB_LOG_ERROR
-				      ("Deleting one shot filter rc:",
-				       rc);
-			      }
+			    MAI_HANDLE_UNLOCK(chan);
+			    MAI_UPCHANNELS_UNLOCK();
+			    if (owner) mai_free_mbuff(owner);
 
-			    MAI_HANDLE_LOCK(chan);
+			    IB_LOG_ERROR("Filter list corrupt limit:",
+					 limit2);
+			    mai_shut_down();
+			    return 0;
 			}
 
-		      handled++;
-		      break;	// each channel gets a single notice of match
+		      rc = mai_mad_deliver(mad, chan, filt, &owner, filterMatch);
+		      if (rc != MAI_DELIVER_NOMATCH)
+			  break;
 		  }
-	    }
 
-	  /*
-	   * Release the lock to the handle 
-	   */
-	  MAI_HANDLE_UNLOCK(chan);
+		/*
+		 * Release the lock to the handle 
+		 */
+		MAI_HANDLE_UNLOCK(chan);
 
+		if (rc == MAI_DELIVER_NOBUF)
+		    break;
+		if (rc == MAI_DELIVER_DONE)
+		    handled++;
+		rc = MAI_DELIVER_NOMATCH;
+	    }
       }
 
     MAI_UPCHANNELS_UNLOCK();
 
+    /*
+     * Drop our reference, the channels hold their own 
+     */
+    if (owner)
+	mai_free_mbuff(owner);
+
     IB_EXIT(__func__, handled);
     return (handled);
 }
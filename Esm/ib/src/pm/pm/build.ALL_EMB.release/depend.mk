@@ -0,0 +1,16 @@
+include Makefile
+include build.ALL_EMB.release/paAccess.c.dep
+include build.ALL_EMB.release/pm_calc.c.dep
+include build.ALL_EMB.release/pm_groups.c.dep
+include build.ALL_EMB.release/mad_info.c.dep
+include build.ALL_EMB.release/pm_sweep.c.dep
+include build.ALL_EMB.release/pm_mad.c.dep
+include build.ALL_EMB.release/pm_debug.c.dep
+include build.ALL_EMB.release/paServer.c.dep
+include build.ALL_EMB.release/pm_dispatch.c.dep
+include build.ALL_EMB.release/pm_async_rcv.c.dep
+include build.ALL_EMB.release/pm_counters.c.dep
+include build.ALL_EMB.release/pm_vfs.c.dep
+include build.ALL_EMB.release/pm.c.dep
+include build.ALL_EMB.release/pa_protocol.c.dep
+include build.ALL_EMB.release/pm_linux.c.dep
@@ -470,6 +470,24 @@ static FSTATUS LocateGroup(Pm_t *pm, const char *groupName, PmGroup_t **pmGroupP
 	return FNOT_FOUND;
 }
 
+// index of pmGroupP in the image's port columns, PM_MAX_GROUPS for all ports
+// or -1 if the columns can't be used.  Short term history images are
+// reconstituted per query and walk the LidMap
+static int ColumnsGroupIndex(Pm_t *pm, PmImage_t *pmimagep, PmGroup_t *pmGroupP, boolean sth)
+{
+	int i;
+
+	if (sth || ! pmimagep->Columns.valid)
+		return -1;
+	if (pmGroupP == pm->AllPorts)
+		return PM_MAX_GROUPS;
+	for (i = 0; i < pm->NumGroups; i++) {
+		if (pm->Groups[i] == pmGroupP)
+			return i;
+	}
+	return -1;
+}
+
 /*************************************************************************************
 *
 * paGetGroupList - return list of group names
@@ -519,6 +537,43 @@ done:
 	return(fStatus);
 }
 
+// Columnar equivalent of the LidMap walk in paGetGroupInfo.  Ports are
+// selected from the flags and group columns, only ports in the group are
+// visited in the port images
+static void scanGroupInfo(Pm_t *pm, PmPortColumns_t *columns, int groupIndex,
+						uint32 imageIndex, PmGroupImage_t *pmGroupImage, boolean *isFailedPort)
+{
+	const uint16 groupMask = (groupIndex < PM_MAX_GROUPS) ? (1<<groupIndex) : 0;
+	const uint8 *flags = columns->flags;
+	const uint16 *mask = columns->groupMask;
+	const uint16 *intMask = columns->intLinkMask;
+	uint32 id, nbrId;
+
+	for (id = 0; id < columns->numPorts; id++) {
+		PmPortImage_t *portImage;
+
+		if (! columns->port[id])
+			continue;
+		if (! (flags[id] & PM_PORT_COL_FLAG_QUERY_OK)) {
+			// mark a flag to indicate there is at least one failed port.
+			*isFailedPort = TRUE;
+			continue;
+		}
+		if (groupMask && ! (mask[id] & groupMask))
+			continue;
+		portImage = &columns->port[id]->Image[imageIndex];
+		if (! groupMask || (intMask[id] & groupMask)) {
+			pmGroupImage->NumIntPorts++;
+			UpdateInGroupStats(pm, pmGroupImage, portImage);
+		} else {
+			nbrId = columns->neighbor[id];
+			pmGroupImage->NumExtPorts++;
+			UpdateExtGroupStats(pm, pmGroupImage, portImage,
+				(nbrId != PM_PORT_COL_NO_NEIGHBOR) ? &columns->port[nbrId]->Image[imageIndex] : NULL);
+		}
+	}
+}
+
 /*************************************************************************************
 *
 * paGetGroupInfo - return group information
@@ -552,6 +607,7 @@ FSTATUS paGetGroupInfo(Pm_t *pm, char *groupName, PmGroupInfo_t *pmGroupInfo, ui
 	boolean				isGroupAll = FALSE;
 	PmHistoryRecord_t	*record = NULL;
 	boolean 			frozen = 0;
+	int					groupIndex;
 
 	// check input parameters
 	if (!pm || !groupName || !pmGroupInfo || !isFailedPort)
@@ -634,18 +690,61 @@ FSTATUS paGetGroupInfo(Pm_t *pm, char *groupName, PmGroupInfo_t *pmGroupInfo, ui
 	ClearGroupStats(&pmGroupImage);
 
 	*isFailedPort = FALSE;
-	for (lid = 1; lid <= pmImageP->maxLid; lid++ ) {
-		PmNode_t *pmNodeP = pmImageP->LidMap[lid];
-		if (!pmNodeP) continue;
-		if (pmNodeP->nodeType == STL_NODE_SW) {
-			int p;
-			for (p=0; p <= pmNodeP->numPorts; p++) { 	// Includes port 0
-				pmPortP = pmNodeP->up.swPorts[p];
-				// if this is a sth image, the port may be 'empty' but not null 
-				// 'Empty' ports should be excluded from the count, and can be indentified by their having a port num and guid of 0
-				if (!pmPortP || (sth && !pmPortP->guid && !pmPortP->portNum)) continue;
-
-				pmPortImageP = &pmPortP->Image[imageIndex];
+	groupIndex = ColumnsGroupIndex(pm, pmImageP, pmGroupP, sth);
+	if (groupIndex >= 0) {
+		scanGroupInfo(pm, &pmImageP->Columns, groupIndex, imageIndex, &pmGroupImage, isFailedPort);
+	} else {
+		for (lid = 1; lid <= pmImageP->maxLid; lid++ ) {
+			PmNode_t *pmNodeP = pmImageP->LidMap[lid];
+			if (!pmNodeP) continue;
+			if (pmNodeP->nodeType == STL_NODE_SW) {
+				int p;
+				for (p=0; p <= pmNodeP->numPorts; p++) { 	// Includes port 0
+					pmPortP = pmNodeP->up.swPorts[p];
+					// if this is a sth image, the port may be 'empty' but not null 
+					// 'Empty' ports should be excluded from the count, and can be indentified by their having a port num and guid of 0
+					if (!pmPortP || (sth && !pmPortP->guid && !pmPortP->portNum)) continue;
+
+					pmPortImageP = &pmPortP->Image[imageIndex];
+					if (pmPortImageP->u.s.queryStatus != PM_QUERY_STATUS_OK) {
+						// mark a flag to indicate there is at least one failed port.
+						*isFailedPort = TRUE;
+						continue;
+					}
+					if (isGroupAll) {
+						pmGroupImage.NumIntPorts++;
+						UpdateInGroupStats(pm, &pmGroupImage, pmPortImageP); // includes all ports
+					} else {
+#if PM_COMPRESS_GROUPS
+						for (g=0; g < pmPortImageP->u.s.InGroups; g++) {
+#else
+						for (g=0; g<PM_MAX_GROUPS_PER_PORT; g++) {
+#endif
+							PmGroup_t *pmPortGroupP = pmPortImageP->Groups[g];
+#if PM_COMPRESS_GROUPS
+							DEBUG_ASSERT(pmPortGroupP);
+#else
+							if (! pmPortGroupP)
+								continue;	// could be gaps, keep going
+#endif
+							if (pmGroupP != pmPortGroupP) 
+								continue;   // only update group
+
+							if (pmPortImageP->IntLinkFlags & (1<<g)) {
+								pmGroupImage.NumIntPorts++;
+								UpdateInGroupStats(pm, &pmGroupImage, pmPortImageP);
+							} else {
+								pmGroupImage.NumExtPorts++;
+								pmPortImageNeighborP = &pmPortP->Image[imageIndex].neighbor->Image[imageIndex];
+								UpdateExtGroupStats(pm, &pmGroupImage, pmPortImageP, pmPortImageNeighborP);
+							}
+						}
+					}
+				}
+			} else {
+				pmPortP = pmNodeP->up.caPortp;
+				if (!pmPortP) continue;
+				pmPortImageP = &pmPortP->Image[imageIndex]; 
 				if (pmPortImageP->u.s.queryStatus != PM_QUERY_STATUS_OK) {
 					// mark a flag to indicate there is at least one failed port.
 					*isFailedPort = TRUE;
@@ -681,44 +780,6 @@ FSTATUS paGetGroupInfo(Pm_t *pm, char *groupName, PmGroupInfo_t *pmGroupInfo, ui
 					}
 				}
 			}
-		} else {
-			pmPortP = pmNodeP->up.caPortp;
-			if (!pmPortP) continue;
-			pmPortImageP = &pmPortP->Image[imageIndex]; 
-			if (pmPortImageP->u.s.queryStatus != PM_QUERY_STATUS_OK) {
-				// mark a flag to indicate there is at least one failed port.
-				*isFailedPort = TRUE;
-				continue;
-			}
-			if (isGroupAll) {
-				pmGroupImage.NumIntPorts++;
-				UpdateInGroupStats(pm, &pmGroupImage, pmPortImageP); // includes all ports
-			} else {
-#if PM_COMPRESS_GROUPS
-				for (g=0; g < pmPortImageP->u.s.InGroups; g++) {
-#else
-				for (g=0; g<PM_MAX_GROUPS_PER_PORT; g++) {
-#endif
-					PmGroup_t *pmPortGroupP = pmPortImageP->Groups[g];
-#if PM_COMPRESS_GROUPS
-					DEBUG_ASSERT(pmPortGroupP);
-#else
-					if (! pmPortGroupP)
-						continue;	// could be gaps, keep going
-#endif
-					if (pmGroupP != pmPortGroupP) 
-						continue;   // only update group
-
-					if (pmPortImageP->IntLinkFlags & (1<<g)) {
-						pmGroupImage.NumIntPorts++;
-						UpdateInGroupStats(pm, &pmGroupImage, pmPortImageP);
-					} else {
-						pmGroupImage.NumExtPorts++;
-						pmPortImageNeighborP = &pmPortP->Image[imageIndex].neighbor->Image[imageIndex];
-						UpdateExtGroupStats(pm, &pmGroupImage, pmPortImageP, pmPortImageNeighborP);
-					}
-				}
-			}
 		}
 	}
 	FinalizeGroupStats(&pmGroupImage);
@@ -1713,11 +1774,7 @@ typedef uint32 (*CompareFunc_t)(uint64 value1, uint64 value2);
 // % of wire potential being used
 uint32 computeUtilizationValue(Pm_t *pm, PmPortImage_t *portImage)
 {
-	uint32 rate = PmCalculateRate(portImage->u.s.activeSpeed, portImage->u.s.rxActiveWidth);
-	uint32 pct10 = ((uint64)portImage->SendMBps * 1000) / s_StaticRateToMBps[rate];
-	// This can be a 1-2% off if the interval and/or sweep time wanders
-	// slightly between sweeps.  So limit to 100% to avoid user confusion.
-	return pct10<1000?pct10:1000;
+	return PmCalculateUtilPct10(portImage);
 }
 
 // packet rate - return actual value
@@ -1799,39 +1856,16 @@ int neighborInList(STL_LID_32 lid, uint8 portNum, PmPort_t *pmNeighborportp, PmP
 	return(0);
 }
 
-FSTATUS processFocusPort(Pm_t *pm, PmPort_t *pmportp, PmPortImage_t *portImage, PmPort_t *pmNeighborportp,
-						 PmPortImage_t *neighborPortImage, STL_LID_32 lid, uint8 portNum, ComputeFunc_t computeFunc,
+// insert a port into the sorted focus list if it qualifies
+static void insertFocusPort(PmPort_t *pmportp, PmPort_t *nbrPt, STL_LID_32 lid, uint8 portNum,
+						 uint64 computedValue, uint64 nbrComputedValue,
 						 CompareFunc_t compareFunc, CompareFunc_t candidateFunc, sortInfo_t *sortInfo)
 {
-	uint64				computedValue = 0;
-	uint64				nbrComputedValue = 0;
 	uint64				sortValue;
-	PmPort_t			*nbrPt;
-	PmPortImage_t		*nbrPI;
 	sortedValueEntry_t	*newListEntry = NULL;
 	sortedValueEntry_t	*thisListEntry = NULL;
 	sortedValueEntry_t	*prevListEntry = NULL;
 
-	if (portNum != 0) {
-        int rc;
-
-        if ((rc = neighborInList(lid, portNum, pmNeighborportp, neighborPortImage, sortInfo)) == -1)
-    		return(FNOT_DONE);
-        else if (rc)
-    		return(FSUCCESS);
-    }
-		
-	if (portNum == 0) {
-		nbrPt = pmportp;
-		nbrPI = portImage;
-	} else {
-		nbrPt = pmNeighborportp;
-		nbrPI = neighborPortImage;
-	}
-    if (portImage)
-        computedValue = computeFunc(pm, portImage);
-    if (nbrPI)
-    	nbrComputedValue = computeFunc(pm, nbrPI);
 	sortValue = MAX(computedValue, nbrComputedValue);
 
 	if (sortInfo->sortedValueListHead == NULL) {
@@ -1930,10 +1964,143 @@ FSTATUS processFocusPort(Pm_t *pm, PmPort_t *pmportp, PmPortImage_t *portImage,
 			}
 		}
 	}
+}
+
+FSTATUS processFocusPort(Pm_t *pm, PmPort_t *pmportp, PmPortImage_t *portImage, PmPort_t *pmNeighborportp,
+						 PmPortImage_t *neighborPortImage, STL_LID_32 lid, uint8 portNum, ComputeFunc_t computeFunc,
+						 CompareFunc_t compareFunc, CompareFunc_t candidateFunc, sortInfo_t *sortInfo)
+{
+	uint64				computedValue = 0;
+	uint64				nbrComputedValue = 0;
+	PmPort_t			*nbrPt;
+	PmPortImage_t		*nbrPI;
+
+	if (portNum != 0) {
+        int rc;
+
+        if ((rc = neighborInList(lid, portNum, pmNeighborportp, neighborPortImage, sortInfo)) == -1)
+    		return(FNOT_DONE);
+        else if (rc)
+    		return(FSUCCESS);
+    }
+		
+	if (portNum == 0) {
+		nbrPt = pmportp;
+		nbrPI = portImage;
+	} else {
+		nbrPt = pmNeighborportp;
+		nbrPI = neighborPortImage;
+	}
+    if (portImage)
+        computedValue = computeFunc(pm, portImage);
+    if (nbrPI)
+    	nbrComputedValue = computeFunc(pm, nbrPI);
+	insertFocusPort(pmportp, nbrPt, lid, portNum, computedValue, nbrComputedValue,
+					compareFunc, candidateFunc, sortInfo);
 
 	return(FSUCCESS);
 }
 
+// build the sorted list from focus entries, best first
+static void listFocusEntries(PmPortColumns_t *columns, const uint32 *value,
+						 const PmFocusEntry_t *entry, uint32 count, sortInfo_t *sortInfo)
+{
+	sortedValueEntry_t *listp, *prevp = NULL;
+	uint32 i, id, nbrId;
+
+	for (i = 0; i < count; i++) {
+		id = entry[i].id;
+		nbrId = (columns->portNum[id] == 0) ? id : columns->neighbor[id];
+		listp = &sortInfo->sortedValueListPool[i];
+		listp->value = value[id];
+		listp->neighborValue = value[nbrId];
+		listp->sortValue = entry[i].sortValue;
+		listp->portp = columns->port[id];
+		listp->neighborPortp = columns->port[nbrId];
+		listp->lid = columns->lid[id];
+		listp->portNum = columns->portNum[id];
+		listp->prev = prevp;
+		listp->next = NULL;
+		if (prevp)
+			prevp->next = listp;
+		prevp = listp;
+	}
+	sortInfo->sortedValueListHead = count ? sortInfo->sortedValueListPool : NULL;
+	sortInfo->sortedValueListTail = prevp;
+	sortInfo->numValueEntries = count;
+}
+
+// Columnar equivalent of calling processFocusPort for every port of the image
+// which is in the group.  groupMask of 0 selects all ports.  The best range
+// links are kept in a bounded heap, ranked and deduplicated as for the focus
+// index so both give the same list.
+static FSTATUS scanFocusPorts(PmPortColumns_t *columns, uint16 groupMask, uint32 focus,
+						 uint32 range, sortInfo_t *sortInfo)
+{
+	const uint8 wantFlags = PM_PORT_COL_FLAG_VALID | PM_PORT_COL_FLAG_QUERY_OK;
+	const uint32 *value = columns->value[focus == PM_FOCUS_UTIL_LOW ? PM_PORT_COL_UTIL : focus];
+	const boolean low = (focus == PM_FOCUS_UTIL_LOW);
+	const uint8 *flags = columns->flags;
+	const uint16 *mask = columns->groupMask;
+	PmFocusEntry_t *heap, entry;
+	uint32 count = 0, id, nbrId;
+	Status_t status;
+
+	range = MIN(range, columns->numPorts);
+	if (! range)
+		return FSUCCESS;
+	status = vs_pool_alloc(&pm_pool, range * sizeof(PmFocusEntry_t), (void*)&heap);
+	if (status != VSTATUS_OK) {
+		IB_LOG_ERRORRC("Failed to allocate focus heap for pmFocusPorts rc:", status);
+		return FINSUFFICIENT_MEMORY;
+	}
+
+	for (id = 0; id < columns->numPorts; id++) {
+		if ((flags[id] & wantFlags) != wantFlags)
+			continue;
+		if (groupMask && !(mask[id] & groupMask))
+			continue;
+		if (columns->portNum[id] == 0) {
+			nbrId = id;
+		} else {
+			nbrId = columns->neighbor[id];
+			if (nbrId == PM_PORT_COL_NO_NEIGHBOR)
+				continue;
+			// the link is already offered by its first end in the group
+			if (nbrId < id && (flags[nbrId] & wantFlags) == wantFlags
+				&& (! groupMask || (mask[nbrId] & groupMask)))
+				continue;
+		}
+		entry.id = id;
+		entry.sortValue = MAX(value[id], value[nbrId]);
+		PmFocusInsert(low, heap, &count, range, &entry);
+	}
+	PmFocusSort(low, heap, count);
+	listFocusEntries(columns, value, heap, count, sortInfo);
+
+	vs_pool_free(&pm_pool, heap);
+	return FSUCCESS;
+}
+
+// Answer a focus query from the image's focus index.  Returns FALSE if the
+// index may not hold range entries, in which case the caller must scan
+static boolean sliceFocusIndex(PmPortColumns_t *columns, int groupIndex, uint32 focus,
+						 uint32 range, sortInfo_t *sortInfo)
+{
+	const uint32 *value = columns->value[focus == PM_FOCUS_UTIL_LOW ? PM_PORT_COL_UTIL : focus];
+	uint32 count;
+
+	if (! columns->focus)
+		return FALSE;
+	count = columns->focus->count[groupIndex][focus];
+	if (count == PM_FOCUS_INDEX_DEPTH && range > PM_FOCUS_INDEX_DEPTH)
+		return FALSE;
+
+	listFocusEntries(columns, value, columns->focus->entry[groupIndex][focus],
+					MIN(count, range), sortInfo);
+	return TRUE;
+}
+
 FSTATUS addSortedPorts(PmFocusPorts_t *pmFocusPorts, sortInfo_t *sortInfo, uint32 imageIndex)
 {
 	Status_t			status;
@@ -2012,6 +2179,9 @@ FSTATUS paGetFocusPorts(Pm_t *pm, char *groupName, PmFocusPorts_t *pmFocusPorts,
 	ComputeFunc_t		computeFunc = NULL;
 	CompareFunc_t		compareFunc = NULL;
 	CompareFunc_t		candidateFunc = NULL;
+	PmPortColumn_t		column = PM_PORT_COL_UTIL;
+	uint32				focus;
+	int					groupIndex;
 	boolean				sth = 0;
 	PmHistoryRecord_t	*record = NULL;
 	boolean				frozen = 0;
@@ -2033,46 +2203,55 @@ FSTATUS paGetFocusPorts(Pm_t *pm, char *groupName, PmFocusPorts_t *pmFocusPorts,
 	}
 	switch (select) {
 	case STL_PA_SELECT_UTIL_HIGH:
+		column = PM_PORT_COL_UTIL;
 		computeFunc = &computeUtilizationValue;
 		compareFunc = &compareLE;
 		candidateFunc = &compareGE;
 		break;
 	case STL_PA_SELECT_UTIL_PKTS_HIGH:
+		column = PM_PORT_COL_PKTS;
 		computeFunc = &computePktRate;
 		compareFunc = &compareLE;
 		candidateFunc = &compareGE;
 		break;
 	case STL_PA_SELECT_UTIL_LOW:
+		column = PM_PORT_COL_UTIL;
 		computeFunc = &computeUtilizationValue;
 		compareFunc = &compareGE;
 		candidateFunc = &compareLE;
 		break;
 	case STL_PA_SELECT_ERR_INTEG:
+		column = PM_PORT_COL_INTEGRITY;
 		computeFunc = &computeIntegrityValue;
 		compareFunc = &compareLE;
 		candidateFunc = &compareGE;
 		break;
 	case STL_PA_SELECT_ERR_CONG:
+		column = PM_PORT_COL_CONGESTION;
 		computeFunc = &computeCongestionValue;
 		compareFunc = &compareLE;
 		candidateFunc = &compareGE;
 		break;
 	case STL_PA_SELECT_ERR_SMA_CONG:
+		column = PM_PORT_COL_SMA_CONGESTION;
 		computeFunc = &computeSmaCongestionValue;
 		compareFunc = &compareLE;
 		candidateFunc = &compareGE;
 		break;
 	case STL_PA_SELECT_ERR_BUBBLE:
+		column = PM_PORT_COL_BUBBLE;
 		computeFunc = &computeBubbleValue;
 		compareFunc = &compareLE;
 		candidateFunc = &compareGE;
 		break;
 	case STL_PA_SELECT_ERR_SEC:
+		column = PM_PORT_COL_SECURITY;
 		computeFunc = &computeSecurityValue;
 		compareFunc = &compareLE;
 		candidateFunc = &compareGE;
 		break;
 	case STL_PA_SELECT_ERR_ROUT:
+		column = PM_PORT_COL_ROUTING;
 		computeFunc = &computeRoutingValue;
 		compareFunc = &compareLE;
 		candidateFunc = &compareGE;
@@ -2082,6 +2261,7 @@ FSTATUS paGetFocusPorts(Pm_t *pm, char *groupName, PmFocusPorts_t *pmFocusPorts,
 		return FINVALID_PARAMETER | STL_MAD_STATUS_STL_PA_INVALID_PARAMETER;
 		break;
 	}
+	focus = (select == STL_PA_SELECT_UTIL_LOW) ? PM_FOCUS_UTIL_LOW : column;
 
 	// initialize group config port list counts
 	pmFocusPorts->NumPorts = 0;
@@ -2161,38 +2341,47 @@ FSTATUS paGetFocusPorts(Pm_t *pm, char *groupName, PmFocusPorts_t *pmFocusPorts,
 	}
 	(void)vs_rwunlock(&pm->stateLock);
 
-	for (lid=1; lid<= pmimagep->maxLid; ++lid) {
-		uint8 portnum;
-		PmNode_t *pmnodep = pmimagep->LidMap[lid];
-		if (! pmnodep)
-			continue;
-		if (pmnodep->nodeType == STL_NODE_SW) {
-			for (portnum=0; portnum<=pmnodep->numPorts; ++portnum) {
-				PmPort_t *pmportp = pmnodep->up.swPorts[portnum];
-				PmPort_t *pmNeighborportp;
-				PmPortImage_t *portImage;
-				PmPortImage_t *neighborPortImage;
-				if (! pmportp)
-					continue;
-				portImage = &pmportp->Image[imageIndex];
-				pmNeighborportp = portImage->neighbor;
-				neighborPortImage = &pmNeighborportp->Image[imageIndex];
+	// slice the focus index or scan the columnar copy of the image when
+	// available
+	groupIndex = ColumnsGroupIndex(pm, pmimagep, pmGroupP, sth);
+	if (groupIndex >= 0) {
+		if (! sliceFocusIndex(&pmimagep->Columns, groupIndex, focus, range, &sortInfo))
+			status = scanFocusPorts(&pmimagep->Columns, (groupIndex < PM_MAX_GROUPS) ? (1<<groupIndex) : 0,
+						   focus, range, &sortInfo);
+	} else {
+		for (lid=1; lid<= pmimagep->maxLid; ++lid) {
+			uint8 portnum;
+			PmNode_t *pmnodep = pmimagep->LidMap[lid];
+			if (! pmnodep)
+				continue;
+			if (pmnodep->nodeType == STL_NODE_SW) {
+				for (portnum=0; portnum<=pmnodep->numPorts; ++portnum) {
+					PmPort_t *pmportp = pmnodep->up.swPorts[portnum];
+					PmPort_t *pmNeighborportp;
+					PmPortImage_t *portImage;
+					PmPortImage_t *neighborPortImage;
+					if (! pmportp)
+						continue;
+					portImage = &pmportp->Image[imageIndex];
+					pmNeighborportp = portImage->neighbor;
+					neighborPortImage = &pmNeighborportp->Image[imageIndex];
+					if (PmIsPortInGroup(pm, pmportp, portImage, pmGroupP, sth) &&
+						portImage->u.s.queryStatus == PM_QUERY_STATUS_OK)
+					{
+						processFocusPort(pm, pmportp, portImage, pmNeighborportp, neighborPortImage, lid, portnum, computeFunc, compareFunc, candidateFunc, &sortInfo);
+					}
+				}
+			} else {
+				PmPort_t *pmportp = pmnodep->up.caPortp;
+				PmPortImage_t *portImage = &pmportp->Image[imageIndex];
+				PmPort_t *pmNeighborportp = portImage->neighbor;
+				PmPortImage_t *neighborPortImage = &pmNeighborportp->Image[imageIndex];
 				if (PmIsPortInGroup(pm, pmportp, portImage, pmGroupP, sth) &&
 					portImage->u.s.queryStatus == PM_QUERY_STATUS_OK)
 				{
-					processFocusPort(pm, pmportp, portImage, pmNeighborportp, neighborPortImage, lid, portnum, computeFunc, compareFunc, candidateFunc, &sortInfo);
+					processFocusPort(pm, pmportp, portImage, pmNeighborportp, neighborPortImage, lid, pmportp->portNum, computeFunc, compareFunc, candidateFunc, &sortInfo);
 				}
 			}
-		} else {
-			PmPort_t *pmportp = pmnodep->up.caPortp;
-			PmPortImage_t *portImage = &pmportp->Image[imageIndex];
-			PmPort_t *pmNeighborportp = portImage->neighbor;
-			PmPortImage_t *neighborPortImage = &pmNeighborportp->Image[imageIndex];
-			if (PmIsPortInGroup(pm, pmportp, portImage, pmGroupP, sth) &&
-				portImage->u.s.queryStatus == PM_QUERY_STATUS_OK)
-			{
-				processFocusPort(pm, pmportp, portImage, pmNeighborportp, neighborPortImage, lid, pmportp->portNum, computeFunc, compareFunc, candidateFunc, &sortInfo);
-			}
 		}
 	}
 
@@ -3725,6 +3914,9 @@ void freeNodeList(Pm_t *pm, PmImage_t *pmimagep) {
 	uint32_t	i;
 	PmNode_t	*pmnodep;
 
+	// columns reference the ports being freed
+	pmimagep->Columns.valid = FALSE;
+
 	if (pmimagep->LidMap) {
 		for (i = 0; i <= pmimagep->maxLid; i++) {
 			pmnodep = pmimagep->LidMap[i];
@@ -4026,16 +4218,20 @@ FSTATUS CopyToPmImage(Pm_t *pm, PmImage_t *pmimagep, PmImage_t *sthimagep) {
 	Status_t	rc;
 	uint32_t	i, j;
     Lock_t		orgImageLock;	// Lock image data (except state and imageId).
+	PmPortColumns_t	orgColumns;
 
 	if (!pmimagep || !sthimagep) {
 		ret = FINVALID_PARAMETER;
 		goto exit;
 	}
 
-	// retain PmImage lock 
+	// retain PmImage lock and column storage
     orgImageLock = pmimagep->imageLock;
+	orgColumns = pmimagep->Columns;
 
 	*pmimagep = *sthimagep;
+	pmimagep->Columns = orgColumns;
+	pmimagep->Columns.valid = FALSE;
 	pmimagep->LidMap = NULL;
 	rc = vs_pool_alloc(&pm_pool, sizeof(PmNode_t *) * (pmimagep->maxLid + 1), (void *)&pmimagep->LidMap);
 	if (rc != VSTATUS_OK || !pmimagep->LidMap) {
@@ -4181,6 +4377,7 @@ FSTATUS putPMSweepImageDataR(uint8_t *p_img_in, uint32_t len_img_in) {
 		// decompress the rest
 		ret = decompressAndReassemble(p_img_in + sizeof(PmFileHeader_t),
 									  len_img_in - sizeof(PmFileHeader_t),
+									  PmHistoryCodec(&cimg_in->header),
 									  cimg_in->header.numDivisions, 
 									  cimg_in->header.divisionSizes, 
 									  bf_decompress + sizeof(PmFileHeader_t), 
@@ -167,6 +167,16 @@ uint32_t PmCalculateRate(uint32_t speed, uint32_t width) {
 	}
 }
 
+// % of wire potential being used, in tenths of a percent
+uint32 PmCalculateUtilPct10(PmPortImage_t *portImage)
+{
+	uint32 rate = PmCalculateRate(portImage->u.s.activeSpeed, portImage->u.s.rxActiveWidth);
+	uint32 pct10 = ((uint64)portImage->SendMBps * 1000) / s_StaticRateToMBps[rate];
+	// This can be a 1-2% off if the interval and/or sweep time wanders
+	// slightly between sweeps.  So limit to 100% to avoid user confusion.
+	return pct10<1000?pct10:1000;
+}
+
 // update stats for a port whose neighbor is also in the group
 void UpdateInGroupStats(Pm_t *pm, PmGroupImage_t *groupImage,
 				PmPortImage_t *portImage)
@@ -916,6 +926,338 @@ void PmClearPortImage(PmPortImage_t *portImage)
 	memset(portImage->VFErrors, 0, sizeof(ErrorSummary_t) * MAX_VFABRICS);
 }
 
+#if PM_MAX_GROUPS > 16
+#error "PmPortColumns_t.groupMask must be widened for PM_MAX_GROUPS"
+#endif
+
+void PmFreePortColumns(PmPortColumns_t *columns)
+{
+	// all columns are carved out of a single allocation starting at port
+	if (columns->port)
+		vs_pool_free(&pm_pool, columns->port);
+	if (columns->focus)
+		vs_pool_free(&pm_pool, columns->focus);
+	memset(columns, 0, sizeof(*columns));
+}
+
+// make sure columns has room for the given number of lids and port ids.
+// Existing contents are not preserved.
+static Status_t PmAllocPortColumns(PmPortColumns_t *columns, uint32 lids, uint32 ports)
+{
+	Status_t status;
+	uint8 *p;
+	size_t size;
+	int i;
+
+	if (columns->port && lids <= columns->lidsSize && ports <= columns->portsSize)
+		return VSTATUS_OK;
+
+	PmFreePortColumns(columns);
+	// add some spare to avoid resizing for minor fabric changes
+	lids = MIN(lids + PM_LID_MAP_SPARE, LID_UCAST_END+1);
+	ports += ports/8;
+
+	// widest types first so every column stays naturally aligned
+	size = ports * sizeof(PmPort_t *)
+		+ lids * sizeof(uint32)
+		+ ports * sizeof(STL_LID_32)
+		+ ports * sizeof(uint32) * (1 + PM_PORT_COL_MAX)
+		+ ports * sizeof(uint16) * 2
+		+ ports * sizeof(uint8) * (2 + PM_PORT_COL_MAX - 1);
+	status = vs_pool_alloc(&pm_pool, size, (void *)&p);
+	if (status != VSTATUS_OK) {
+		IB_LOG_ERRORRC("Failed to allocate PM port columns rc:", status);
+		return status;
+	}
+	MemoryClear(p, size);
+
+	columns->port = (PmPort_t **)p;			p += ports * sizeof(PmPort_t *);
+	columns->firstPort = (uint32 *)p;		p += lids * sizeof(uint32);
+	columns->lid = (STL_LID_32 *)p;			p += ports * sizeof(STL_LID_32);
+	columns->neighbor = (uint32 *)p;		p += ports * sizeof(uint32);
+	for (i = 0; i < PM_PORT_COL_MAX; i++) {
+		columns->value[i] = (uint32 *)p;	p += ports * sizeof(uint32);
+	}
+	columns->groupMask = (uint16 *)p;		p += ports * sizeof(uint16);
+	columns->intLinkMask = (uint16 *)p;		p += ports * sizeof(uint16);
+	columns->portNum = p;					p += ports;
+	columns->flags = p;						p += ports;
+	for (i = 0; i < PM_PORT_COL_MAX; i++) {
+		if (i == PM_PORT_COL_PKTS)
+			continue;
+		columns->bucket[i] = p;				p += ports;
+	}
+	columns->lidsSize = lids;
+	columns->portsSize = ports;
+	return VSTATUS_OK;
+}
+
+static void PmSetPortColumns(Pm_t *pm, PmPortColumns_t *columns, uint32 id,
+				PmPort_t *pmportp, STL_LID_32 lid, uint8 portNum, uint32 imageIndex)
+{
+	PmPortImage_t *portImage = &pmportp->Image[imageIndex];
+	uint16 groupMask = 0;
+	uint16 intLinkMask = 0;
+	uint8 flags = 0;
+	int i, j;
+
+#if PM_COMPRESS_GROUPS
+	for (j=0; j<portImage->u.s.InGroups; j++) {
+#else
+	for (j=0; j<PM_MAX_GROUPS_PER_PORT; j++) {
+#endif
+		for (i=0; i<pm->NumGroups; i++) {
+			if (portImage->Groups[j] && portImage->Groups[j] == pm->Groups[i]) {
+				groupMask |= (1<<i);
+				if (portImage->IntLinkFlags & (1<<j))
+					intLinkMask |= (1<<i);
+				break;
+			}
+		}
+	}
+	if (! pmportp->u.s.PmaAvoid && portImage->u.s.active)
+		flags |= PM_PORT_COL_FLAG_VALID;
+	if (portImage->u.s.queryStatus == PM_QUERY_STATUS_OK)
+		flags |= PM_PORT_COL_FLAG_QUERY_OK;
+	// same selection as the loops in PmFinalizeAllPortStats
+	if (! pmportp->u.s.PmaAvoid
+		&& (portImage->u.s.active || pmportp->pmnodep->nodeType != STL_NODE_SW))
+		flags |= PM_PORT_COL_FLAG_FINALIZED;
+
+	columns->port[id] = pmportp;
+	columns->lid[id] = lid;
+	columns->portNum[id] = portNum;
+	columns->flags[id] = flags;
+	columns->groupMask[id] = groupMask;
+	columns->intLinkMask[id] = intLinkMask;
+	columns->neighbor[id] = PM_PORT_COL_NO_NEIGHBOR;
+
+	columns->value[PM_PORT_COL_UTIL][id] = PmCalculateUtilPct10(portImage);
+	columns->value[PM_PORT_COL_PKTS][id] = portImage->SendKPps;
+	columns->value[PM_PORT_COL_INTEGRITY][id] = portImage->Errors.Integrity;
+	columns->value[PM_PORT_COL_CONGESTION][id] = portImage->Errors.Congestion;
+	columns->value[PM_PORT_COL_SMA_CONGESTION][id] = portImage->Errors.SmaCongestion;
+	columns->value[PM_PORT_COL_BUBBLE][id] = portImage->Errors.Bubble;
+	columns->value[PM_PORT_COL_SECURITY][id] = portImage->Errors.Security;
+	columns->value[PM_PORT_COL_ROUTING][id] = portImage->Errors.Routing;
+
+	columns->bucket[PM_PORT_COL_UTIL][id] = portImage->UtilBucket;
+	columns->bucket[PM_PORT_COL_INTEGRITY][id] = portImage->IntegrityBucket;
+	columns->bucket[PM_PORT_COL_CONGESTION][id] = portImage->CongestionBucket;
+	columns->bucket[PM_PORT_COL_SMA_CONGESTION][id] = portImage->SmaCongestionBucket;
+	columns->bucket[PM_PORT_COL_BUBBLE][id] = portImage->BubbleBucket;
+	columns->bucket[PM_PORT_COL_SECURITY][id] = portImage->SecurityBucket;
+	columns->bucket[PM_PORT_COL_ROUTING][id] = portImage->RoutingBucket;
+}
+
+// TRUE if entry a ranks after entry b in the focus list.  Equal values rank
+// by port id, the order the classic scan lists them in
+static __inline boolean PmFocusWorse(boolean low, const PmFocusEntry_t *a, const PmFocusEntry_t *b)
+{
+	if (a->sortValue != b->sortValue)
+		return low ? (a->sortValue > b->sortValue) : (a->sortValue < b->sortValue);
+	return a->id > b->id;
+}
+
+// heap of the best entries with the worst at the root
+static void PmFocusSiftDown(boolean low, PmFocusEntry_t *heap, uint32 count, uint32 i)
+{
+	PmFocusEntry_t entry = heap[i];
+	uint32 child;
+
+	while ((child = 2*i + 1) < count) {
+		if (child + 1 < count && PmFocusWorse(low, &heap[child+1], &heap[child]))
+			child++;
+		if (! PmFocusWorse(low, &heap[child], &entry))
+			break;
+		heap[i] = heap[child];
+		i = child;
+	}
+	heap[i] = entry;
+}
+
+// offer entry to a heap holding at most size entries
+void PmFocusInsert(boolean low, PmFocusEntry_t *heap, uint32 *count, uint32 size,
+				const PmFocusEntry_t *entry)
+{
+	uint32 i, parent;
+
+	if (*count < size) {
+		i = (*count)++;
+		while (i) {
+			parent = (i - 1)/2;
+			if (! PmFocusWorse(low, entry, &heap[parent]))
+				break;
+			heap[i] = heap[parent];
+			i = parent;
+		}
+		heap[i] = *entry;
+	} else if (PmFocusWorse(low, &heap[0], entry)) {
+		heap[0] = *entry;
+		PmFocusSiftDown(low, heap, *count, 0);
+	}
+}
+
+// heapsort, moving the worst remaining entry to the end each pass, leaves
+// the heap sorted best first
+void PmFocusSort(boolean low, PmFocusEntry_t *heap, uint32 count)
+{
+	PmFocusEntry_t entry;
+
+	for (; count > 1; count--) {
+		entry = heap[0];
+		heap[0] = heap[count-1];
+		heap[count-1] = entry;
+		PmFocusSiftDown(low, heap, count-1, 0);
+	}
+}
+
+// Build the focus index from the columns, see PmFocusIndex_t.  Each
+// eligible link is offered to a bounded heap per select and group, then the
+// heaps are sorted best first.  On allocation failure focus stays NULL and PA
+// queries scan the columns.
+static void PmBuildFocusIndex(PmPortColumns_t *columns)
+{
+	const uint8 wantFlags = PM_PORT_COL_FLAG_VALID | PM_PORT_COL_FLAG_QUERY_OK;
+	const uint32 allPorts = 1 << PM_MAX_GROUPS;
+	PmFocusIndex_t *focus = columns->focus;
+	PmFocusEntry_t entry;
+	uint32 id, nbrId, groups, g, f;
+
+	if (! focus) {
+		if (vs_pool_alloc(&pm_pool, sizeof(*focus), (void *)&focus) != VSTATUS_OK) {
+			IB_LOG_WARN0("Failed to allocate PM focus index, focus queries will scan ports");
+			return;
+		}
+		columns->focus = focus;
+	}
+	memset(focus->count, 0, sizeof(focus->count));
+
+	for (id = 0; id < columns->numPorts; id++) {
+		if ((columns->flags[id] & wantFlags) != wantFlags)
+			continue;
+		groups = columns->groupMask[id] | allPorts;
+		if (columns->portNum[id] == 0) {
+			nbrId = id;
+		} else {
+			nbrId = columns->neighbor[id];
+			if (nbrId == PM_PORT_COL_NO_NEIGHBOR)
+				continue;
+			// the link is already listed for groups holding its first end
+			if (nbrId < id && (columns->flags[nbrId] & wantFlags) == wantFlags)
+				groups &= ~(columns->groupMask[nbrId] | allPorts);
+		}
+		entry.id = id;
+		for (f = 0; f < PM_FOCUS_MAX; f++) {
+			const uint32 *value = columns->value[f == PM_FOCUS_UTIL_LOW ? PM_PORT_COL_UTIL : f];
+
+			entry.sortValue = MAX(value[id], value[nbrId]);
+			for (g = 0; g < PM_FOCUS_GROUPS; g++) {
+				if (groups & (1 << g))
+					PmFocusInsert(f == PM_FOCUS_UTIL_LOW, focus->entry[g][f],
+								&focus->count[g][f], PM_FOCUS_INDEX_DEPTH, &entry);
+			}
+		}
+	}
+
+	for (g = 0; g < PM_FOCUS_GROUPS; g++) {
+		for (f = 0; f < PM_FOCUS_MAX; f++)
+			PmFocusSort(f == PM_FOCUS_UTIL_LOW, focus->entry[g][f], focus->count[g][f]);
+	}
+}
+
+// Build the columnar copy of the port statistics for an image.
+// Must be called after all ports have been finalized and buckets computed.
+// On failure the columns are left invalid and PA queries fall back to
+// walking the LidMap.
+// caller must have imageLock held write for this image
+void PmBuildPortColumns(Pm_t *pm, PmImage_t *pmimagep, uint32 imageIndex)
+{
+	PmPortColumns_t *columns = &pmimagep->Columns;
+	STL_LID_32 lid;
+	uint32 numPorts = 0;
+	uint32 id;
+
+	columns->valid = FALSE;
+	columns->numPorts = 0;
+	if (! pmimagep->LidMap)
+		return;
+
+	for (lid = 1; lid <= pmimagep->maxLid; ++lid) {
+		PmNode_t *pmnodep = pmimagep->LidMap[lid];
+		if (! pmnodep)
+			continue;
+		if (pmnodep->nodeType == STL_NODE_SW)
+			numPorts += pmnodep->numPorts + 1;
+		else
+			numPorts++;
+	}
+	if (PmAllocPortColumns(columns, pmimagep->maxLid + 1, numPorts) != VSTATUS_OK)
+		return;
+
+	// assign ids in lid/portNum order.  Switch ports which are not present
+	// keep their id so a neighbor's id can be computed from lid and portNum
+	id = 0;
+	columns->firstPort[0] = PM_PORT_COL_NO_NEIGHBOR;
+	for (lid = 1; lid <= pmimagep->maxLid; ++lid) {
+		PmNode_t *pmnodep = pmimagep->LidMap[lid];
+		PmPort_t *pmportp;
+		if (! pmnodep) {
+			columns->firstPort[lid] = PM_PORT_COL_NO_NEIGHBOR;
+			continue;
+		}
+		columns->firstPort[lid] = id;
+		if (pmnodep->nodeType == STL_NODE_SW) {
+			uint8 i;
+			for (i=0; i<= pmnodep->numPorts; ++i, ++id) {
+				pmportp = pmnodep->up.swPorts[i];
+				if (pmportp) {
+					PmSetPortColumns(pm, columns, id, pmportp, lid, i, imageIndex);
+				} else {
+					columns->port[id] = NULL;
+					columns->flags[id] = 0;
+				}
+			}
+		} else {
+			pmportp = pmnodep->up.caPortp;
+			if (pmportp) {
+				PmSetPortColumns(pm, columns, id, pmportp, lid, pmportp->portNum, imageIndex);
+			} else {
+				columns->port[id] = NULL;
+				columns->flags[id] = 0;
+			}
+			id++;
+		}
+	}
+	columns->numPorts = id;
+
+	for (id = 0; id < columns->numPorts; id++) {
+		PmPort_t *neighbor;
+		STL_LID_32 nbrLid;
+		uint32 nbrId;
+
+		if (! columns->port[id])
+			continue;
+		neighbor = columns->port[id]->Image[imageIndex].neighbor;
+		if (! neighbor)
+			continue;
+		nbrLid = neighbor->pmnodep->Image[imageIndex].lid;
+		nbrId = (nbrLid <= pmimagep->maxLid) ? columns->firstPort[nbrLid]
+											: PM_PORT_COL_NO_NEIGHBOR;
+		if (nbrId != PM_PORT_COL_NO_NEIGHBOR
+			&& neighbor->pmnodep->nodeType == STL_NODE_SW)
+			nbrId += neighbor->portNum;
+		if (nbrId >= columns->numPorts || columns->port[nbrId] != neighbor) {
+			IB_LOG_DEBUG1_FMT(__func__, "Neighbor of LID 0x%x port %u not in image, port columns not used",
+				columns->lid[id], columns->portNum[id]);
+			return;
+		}
+		columns->neighbor[id] = nbrId;
+	}
+	PmBuildFocusIndex(columns);
+	columns->valid = TRUE;
+}
+
 // Returns TRUE if need to Clear some counters for Port, FALSE if not
 // TRUE means *counterSelect indicates counters to clear
 // FALSE means no counters need to be cleared and *counterSelect is 0
@@ -0,0 +1,432 @@
+/* BEGIN_ICS_COPYRIGHT7 ****************************************
+
+Copyright (c) 2015, Intel Corporation
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Intel Corporation nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+** END_ICS_COPYRIGHT7   ****************************************/
+
+/* [ICS VERSION STRING: unknown] */
+
+
+// PM Short-Term History compression.
+// Each history image is split into divisions which are compressed
+// independently, so they can be processed in parallel by a small pool of
+// persistent worker threads.  The codec used is recorded in the file header
+// so files written with any codec built into this FM can be read back.
+
+#ifndef __VXWORKS__
+
+#include "pm_topology.h"
+#include <pthread.h>
+#include "zlib.h"
+#ifdef PM_HISTORY_LZ4
+#include <lz4.h>
+#endif
+#ifdef PM_HISTORY_ZSTD
+#include <zstd.h>
+#endif
+
+#define PM_ZLIB_LEVEL	3
+#define PM_ZSTD_LEVEL	9
+
+typedef FSTATUS (*PmCompressFunc_t)(unsigned char *input_data, size_t input_size,
+						unsigned char **output_data, size_t *output_size);
+typedef FSTATUS (*PmDecompressFunc_t)(unsigned char *input_data, size_t input_size,
+						unsigned char *output_data, size_t output_size);
+
+typedef struct PmCodec_s {
+	const char			*name;
+	PmCompressFunc_t	compress;		// NULL if not built in
+	PmDecompressFunc_t	decompress;
+} PmCodec_t;
+
+// resize the output buffer of a compressor to match what was actually used
+static FSTATUS PmCodecTrimOutput(unsigned char **output_data, size_t *output_size, size_t used)
+{
+	unsigned char *p = (unsigned char*)realloc(*output_data, used ? used : 1);
+
+	if (p)
+		*output_data = p;
+	*output_size = used;
+	return FSUCCESS;
+}
+
+static FSTATUS zlibCompress(unsigned char *input_data, size_t input_size, unsigned char **output_data, size_t *output_size)
+{
+	int ret;
+	z_stream strm;
+	size_t bound;
+
+	// initialize the z stream
+	strm.zalloc = Z_NULL;
+	strm.zfree = Z_NULL;
+	strm.opaque = Z_NULL;
+	ret = deflateInit(&strm, PM_ZLIB_LEVEL);
+	if (ret != Z_OK) {
+		return FERROR;
+	}
+
+	// deflate bound gives an upper bound on how much space the compressed data will take up
+	bound = (size_t)deflateBound(&strm, (uLong)input_size);
+	*output_data = (unsigned char*)calloc(1, bound);
+	if (!(*output_data)) {
+		*output_size = 0;
+		(void)deflateEnd(&strm);
+		return FINSUFFICIENT_MEMORY;
+	}
+
+	strm.avail_in = input_size;
+	strm.next_in = input_data;
+	strm.avail_out = bound;
+	strm.next_out = *output_data;
+
+	ret = deflate(&strm, Z_FINISH);
+	if (ret != Z_STREAM_END) {
+		IB_LOG_ERROR0("Error while deflating PM History Image");
+		free(*output_data);
+		*output_data = NULL;
+		*output_size = 0;
+		(void)deflateEnd(&strm);
+		return FERROR;
+	}
+
+	(void)PmCodecTrimOutput(output_data, output_size, (size_t)strm.total_out);
+	(void)deflateEnd(&strm);
+	return FSUCCESS;
+}
+
+static FSTATUS zlibDecompress(unsigned char *input_data, size_t input_size, unsigned char *output_data, size_t output_size)
+{
+	int ret;
+	z_stream strm;
+
+	strm.zalloc = Z_NULL;
+	strm.zfree = Z_NULL;
+	strm.opaque = Z_NULL;
+	strm.avail_in = 0;
+	strm.next_in = Z_NULL;
+	ret = inflateInit(&strm);
+	if (ret != Z_OK) {
+		IB_LOG_ERROR0("Error decompressing PM history image: Unable to initialize inflation");
+		return FERROR;
+	}
+
+	strm.avail_in = input_size;
+	strm.next_in = input_data;
+	strm.avail_out = output_size;
+	strm.next_out = output_data;
+
+	ret = inflate(&strm, Z_FINISH);
+	if (ret != Z_STREAM_END) {
+		IB_LOG_ERROR0("Error decompressing PM history image");
+		(void)inflateEnd(&strm);
+		return FERROR;
+	}
+	(void)inflateEnd(&strm);
+	return FSUCCESS;
+}
+
+#ifdef PM_HISTORY_LZ4
+static FSTATUS lz4Compress(unsigned char *input_data, size_t input_size, unsigned char **output_data, size_t *output_size)
+{
+	int bound, ret;
+
+	if (input_size > LZ4_MAX_INPUT_SIZE) {
+		IB_LOG_ERROR0("PM History Image division too large for lz4");
+		return FERROR;
+	}
+	bound = LZ4_compressBound((int)input_size);
+	*output_data = (unsigned char*)calloc(1, bound);
+	if (!(*output_data)) {
+		*output_size = 0;
+		return FINSUFFICIENT_MEMORY;
+	}
+	ret = LZ4_compress_default((const char *)input_data, (char *)*output_data, (int)input_size, bound);
+	if (ret <= 0) {
+		IB_LOG_ERROR0("Error while compressing PM History Image with lz4");
+		free(*output_data);
+		*output_data = NULL;
+		*output_size = 0;
+		return FERROR;
+	}
+	return PmCodecTrimOutput(output_data, output_size, (size_t)ret);
+}
+
+static FSTATUS lz4Decompress(unsigned char *input_data, size_t input_size, unsigned char *output_data, size_t output_size)
+{
+	int ret = LZ4_decompress_safe((const char *)input_data, (char *)output_data, (int)input_size, (int)output_size);
+
+	if (ret < 0 || (size_t)ret != output_size) {
+		IB_LOG_ERROR0("Error decompressing PM history image with lz4");
+		return FERROR;
+	}
+	return FSUCCESS;
+}
+#endif
+
+#ifdef PM_HISTORY_ZSTD
+static FSTATUS zstdCompress(unsigned char *input_data, size_t input_size, unsigned char **output_data, size_t *output_size)
+{
+	size_t bound = ZSTD_compressBound(input_size);
+	size_t ret;
+
+	*output_data = (unsigned char*)calloc(1, bound);
+	if (!(*output_data)) {
+		*output_size = 0;
+		return FINSUFFICIENT_MEMORY;
+	}
+	ret = ZSTD_compress(*output_data, bound, input_data, input_size, PM_ZSTD_LEVEL);
+	if (ZSTD_isError(ret)) {
+		IB_LOG_ERROR_FMT(__func__, "Error while compressing PM History Image with zstd: %s",
+			ZSTD_getErrorName(ret));
+		free(*output_data);
+		*output_data = NULL;
+		*output_size = 0;
+		return FERROR;
+	}
+	return PmCodecTrimOutput(output_data, output_size, ret);
+}
+
+static FSTATUS zstdDecompress(unsigned char *input_data, size_t input_size, unsigned char *output_data, size_t output_size)
+{
+	size_t ret = ZSTD_decompress(output_data, output_size, input_data, input_size);
+
+	if (ZSTD_isError(ret) || ret != output_size) {
+		IB_LOG_ERROR0("Error decompressing PM history image with zstd");
+		return FERROR;
+	}
+	return FSUCCESS;
+}
+#endif
+
+static PmCodec_t pm_codecs[PM_HISTORY_CODEC_MAX] = {
+	[PM_HISTORY_CODEC_ZLIB] = { "zlib", zlibCompress, zlibDecompress },
+#ifdef PM_HISTORY_LZ4
+	[PM_HISTORY_CODEC_LZ4] = { "lz4", lz4Compress, lz4Decompress },
+#else
+	[PM_HISTORY_CODEC_LZ4] = { "lz4", NULL, NULL },
+#endif
+#ifdef PM_HISTORY_ZSTD
+	[PM_HISTORY_CODEC_ZSTD] = { "zstd", zstdCompress, zstdDecompress },
+#else
+	[PM_HISTORY_CODEC_ZSTD] = { "zstd", NULL, NULL },
+#endif
+};
+
+const char *PmCodecName(uint8 codec)
+{
+	return (codec < PM_HISTORY_CODEC_MAX) ? pm_codecs[codec].name : "unknown";
+}
+
+// returns PM_HISTORY_CODEC_* or -1 if name is not a known codec
+int PmCodecFromName(const char *name)
+{
+	int i;
+
+	for (i = 0; i < PM_HISTORY_CODEC_MAX; i++) {
+		if (strcasecmp(name, pm_codecs[i].name) == 0)
+			return i;
+	}
+	return -1;
+}
+
+boolean PmCodecAvailable(uint8 codec)
+{
+	return (codec < PM_HISTORY_CODEC_MAX && pm_codecs[codec].compress != NULL);
+}
+
+static void PmCodecRunJob(PmCodecJob_t *job)
+{
+	if (! PmCodecAvailable(job->codec)) {
+		IB_LOG_ERROR_FMT(__func__, "PM history codec %u (%s) not available in this build",
+			job->codec, PmCodecName(job->codec));
+		job->status = FINVALID_PARAMETER;
+		if (! job->decompress) {
+			job->output_data = NULL;
+			job->output_size = 0;
+		}
+	} else if (job->decompress) {
+		job->status = pm_codecs[job->codec].decompress(job->input_data, job->input_size,
+												job->output_data, job->output_size);
+	} else {
+		job->status = pm_codecs[job->codec].compress(job->input_data, job->input_size,
+												&job->output_data, &job->output_size);
+	}
+}
+
+// a set of jobs submitted by one PmCodecRun call
+typedef struct PmCodecBatch_s {
+	PmCodecJob_t			*jobs;
+	uint32					numJobs;
+	uint32					nextJob;	// next job to hand out
+	uint32					remaining;	// jobs not yet completed
+	struct PmCodecBatch_s	*next;
+} PmCodecBatch_t;
+
+// Callers of PmCodecRun (engine thread storing a composite, PA threads
+// loading one) may overlap, so batches are queued and workers take jobs
+// from the oldest batch with work left.  The submitting thread also works
+// on its own batch, so a pool for N divisions needs N-1 workers.
+static struct {
+	pthread_mutex_t	lock;
+	pthread_cond_t	workCond;	// signaled when a batch is queued or on exit
+	pthread_cond_t	doneCond;	// signaled when a batch completes
+	pthread_t		threads[PM_MAX_COMPRESSION_DIVISIONS];
+	uint32			numThreads;
+	boolean			exit;
+	PmCodecBatch_t	*batches;
+} pm_codec_pool = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.workCond = PTHREAD_COND_INITIALIZER,
+	.doneCond = PTHREAD_COND_INITIALIZER,
+};
+
+// caller must hold pm_codec_pool.lock
+static PmCodecJob_t *PmCodecTakeJob(PmCodecBatch_t *batch)
+{
+	if (batch->nextJob < batch->numJobs)
+		return &batch->jobs[batch->nextJob++];
+	return NULL;
+}
+
+static void *PmCodecWorker(void *arg)
+{
+	PmCodecBatch_t *batch;
+	PmCodecJob_t *job;
+
+	(void)pthread_mutex_lock(&pm_codec_pool.lock);
+	for (;;) {
+		job = NULL;
+		for (batch = pm_codec_pool.batches; batch && ! job; ) {
+			if (! (job = PmCodecTakeJob(batch)))
+				batch = batch->next;
+		}
+		if (! job) {
+			if (pm_codec_pool.exit)
+				break;
+			(void)pthread_cond_wait(&pm_codec_pool.workCond, &pm_codec_pool.lock);
+			continue;
+		}
+		(void)pthread_mutex_unlock(&pm_codec_pool.lock);
+		PmCodecRunJob(job);
+		(void)pthread_mutex_lock(&pm_codec_pool.lock);
+		if (--batch->remaining == 0)
+			(void)pthread_cond_broadcast(&pm_codec_pool.doneCond);
+	}
+	(void)pthread_mutex_unlock(&pm_codec_pool.lock);
+	return NULL;
+}
+
+// start the worker pool.  threads is the number of additional threads
+// beyond the caller of PmCodecRun, 0 runs all jobs in the caller
+Status_t PmCodecPoolInit(uint32 threads)
+{
+	uint32 i;
+	int ret;
+
+	if (pm_codec_pool.numThreads)
+		PmCodecPoolDestroy();
+
+	threads = MIN(threads, PM_MAX_COMPRESSION_DIVISIONS);
+	pm_codec_pool.exit = FALSE;
+	for (i = 0; i < threads; i++) {
+		ret = pthread_create(&pm_codec_pool.threads[i], NULL, PmCodecWorker, NULL);
+		if (ret) {
+			IB_LOG_WARNRC("Failed to create PM history compression thread, continuing with fewer threads rc:", ret);
+			break;
+		}
+		pm_codec_pool.numThreads++;
+	}
+	return VSTATUS_OK;
+}
+
+void PmCodecPoolDestroy(void)
+{
+	uint32 i;
+
+	if (! pm_codec_pool.numThreads)
+		return;
+
+	(void)pthread_mutex_lock(&pm_codec_pool.lock);
+	pm_codec_pool.exit = TRUE;
+	(void)pthread_cond_broadcast(&pm_codec_pool.workCond);
+	(void)pthread_mutex_unlock(&pm_codec_pool.lock);
+
+	for (i = 0; i < pm_codec_pool.numThreads; i++) {
+		if (pthread_join(pm_codec_pool.threads[i], NULL))
+			IB_LOG_ERROR0("Failed to join PM history compression thread");
+	}
+	pm_codec_pool.numThreads = 0;
+}
+
+// run a set of compress or decompress jobs to completion, in parallel when
+// the pool has workers.  Returns FSUCCESS or the status of the first job
+// which failed
+FSTATUS PmCodecRun(PmCodecJob_t *jobs, uint32 numJobs)
+{
+	PmCodecBatch_t batch;
+	PmCodecBatch_t **pp;
+	PmCodecJob_t *job;
+	uint32 i;
+
+	if (! pm_codec_pool.numThreads || numJobs <= 1) {
+		for (i = 0; i < numJobs; i++)
+			PmCodecRunJob(&jobs[i]);
+	} else {
+		batch.jobs = jobs;
+		batch.numJobs = numJobs;
+		batch.nextJob = 0;
+		batch.remaining = numJobs;
+		batch.next = NULL;
+
+		(void)pthread_mutex_lock(&pm_codec_pool.lock);
+		for (pp = &pm_codec_pool.batches; *pp; pp = &(*pp)->next)
+			;
+		*pp = &batch;
+		(void)pthread_cond_broadcast(&pm_codec_pool.workCond);
+
+		while ((job = PmCodecTakeJob(&batch)) != NULL) {
+			(void)pthread_mutex_unlock(&pm_codec_pool.lock);
+			PmCodecRunJob(job);
+			(void)pthread_mutex_lock(&pm_codec_pool.lock);
+			batch.remaining--;
+		}
+		while (batch.remaining)
+			(void)pthread_cond_wait(&pm_codec_pool.doneCond, &pm_codec_pool.lock);
+
+		for (pp = &pm_codec_pool.batches; *pp != &batch; pp = &(*pp)->next)
+			;
+		*pp = batch.next;
+		(void)pthread_mutex_unlock(&pm_codec_pool.lock);
+	}
+
+	for (i = 0; i < numJobs; i++) {
+		if (jobs[i].status != FSUCCESS)
+			return jobs[i].status;
+	}
+	return FSUCCESS;
+}
+
+#endif	// __VXWORKS__
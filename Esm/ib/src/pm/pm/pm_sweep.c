@@ -53,7 +53,6 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "fm_xml.h"
 #include <limits.h>
 #include <string.h>
-#include "zlib.h"
 #include <dirent.h>
 #include <sys/stat.h>
 #include <time.h>
@@ -92,6 +91,11 @@ Thread_t g_pmAsyncRcvThread;
 boolean g_pmAsyncRcvThreadRunning = FALSE;
 Sema_t g_pmAsyncRcvSema;	// indicates AsyncRcvThread is ready
 
+#ifndef __VXWORKS__
+// codec used to compress new Short-Term History files, see PmInitHistory
+static uint8 pm_history_codec = PM_HISTORY_CODEC_ZLIB;
+#endif
+
 // default Thresholds
 ErrorSummary_t g_pmThresholds = {
     Integrity:  100,
@@ -1668,75 +1672,6 @@ static uint64 buildShortTermHistoryImageId(Pm_t *pm, uint32 imageIndex) {
 }
 
 #ifndef __VXWORKS__
-/************************************************************************************* 
-*   decompressComposite - decompress a composite History file
-*  
-*   Inputs:
-*   	input_data - buffer of compressed data
-*   	input_size - the size of the input buffer
-*   	output_data - output data buffer
-*   	output_size - the size of the output data buffer
-*  
-*   Returns:
-*   	Status - FSUCCESS if okay
-*  
-*   Note:
-*   	The output_data buffer will be filled with the uncompressed data
-*   	Unlike compressData, output_size must be provided and will not
-*   	be updated & output_data must have already been allocated
-*  
-*************************************************************************************/
-FSTATUS decompressData(unsigned char *input_data, size_t input_size, unsigned char *output_data, size_t output_size) {
-	int ret;
-	z_stream strm;
-
-	// initialize
-	strm.zalloc = Z_NULL;
-	strm.zfree = Z_NULL;
-	strm.opaque = Z_NULL;
-	strm.avail_in = 0;
-	strm.next_in = Z_NULL;
-	ret = inflateInit(&strm);
-	if (ret != Z_OK) {
-		IB_LOG_ERROR0("Error decompressing PM history image: Unable to initialize inflation");
-		return FERROR;
-	}
-
-	// get ready to decompress
-	strm.avail_in = input_size;
-	strm.next_in = input_data;
-	strm.avail_out = output_size;
-	strm.next_out = output_data;
-
-	// decompress the data
-	ret = inflate(&strm, Z_FINISH);
-	if (ret != Z_STREAM_END) {
-		IB_LOG_ERROR0("Error decompressing PM history image");
-		(void)inflateEnd(&strm);
-		return FERROR;
-	}
-	inflateEnd(&strm);
-	return FSUCCESS;
-}
-
-struct decompress_args {
-	unsigned char *input_data;
-	size_t input_size;
-	unsigned char *output_data;
-	size_t output_size;
-};
-
-void *threadDecompress(void *args) {
-	FSTATUS ret; 
-	ret = decompressData(
-	  ((struct decompress_args*)args)->input_data,
-	  ((struct decompress_args*)args)->input_size,
-	  ((struct decompress_args*)args)->output_data,
-	  ((struct decompress_args*)args)->output_size
-	  );
-	pthread_exit(&ret);
-}
-
 /************************************************************************************* 
 *   decompressAndReassemble - decompress each piece of a History file and put it back
 *   	together
@@ -1744,6 +1679,7 @@ void *threadDecompress(void *args) {
 *   Inputs:
 *   	input_data - buffer of compressed data - must NOT contain the uncompressed header section
 *   	input_size - total size of the input data
+*   	codec - PM_HISTORY_CODEC_* the data was compressed with
 *   	divs - number of divisions of the compressed input data
 *   	input_sizes - an array of length 'divs' that lists the size of each division
 *   	output_data - output data buffer
@@ -1754,12 +1690,11 @@ void *threadDecompress(void *args) {
 *  
 *   Note:
 *   	The output_data buffer will be filled with the uncompressed data
-*   	Unlike compressData, output_size must be provided and will not
-*   	be updated & output_data must have already been allocated
-*  
+*   	output_size must be provided & output_data must have already been allocated
+*   	The divisions are decompressed in parallel by the history codec pool
 *  
 *************************************************************************************/
-FSTATUS decompressAndReassemble(unsigned char *input_data, size_t input_size, uint8 divs, uint64 *input_sizes, unsigned char *output_data, size_t output_size) {
+FSTATUS decompressAndReassemble(unsigned char *input_data, size_t input_size, uint8 codec, uint8 divs, uint64 *input_sizes, unsigned char *output_data, size_t output_size) {
 	// first check divs, make sure it isn't over the max
 	if (divs > PM_MAX_COMPRESSION_DIVISIONS) {
 		IB_LOG_ERROR_FMT(NULL, "Unable to decompress, invalid number of divisions: %d", divs);
@@ -1770,8 +1705,12 @@ FSTATUS decompressAndReassemble(unsigned char *input_data, size_t input_size, ui
 		IB_LOG_ERROR0("Unable to decompress, invalid data output size");
 		return FERROR;
 	}
+	if (codec >= PM_HISTORY_CODEC_MAX || ! PmCodecAvailable(codec)) {
+		IB_LOG_ERROR_FMT(__func__, "Unable to decompress, history codec %u (%s) not available",
+			codec, PmCodecName(codec));
+		return FERROR;
+	}
 
-	unsigned char *input_pieces[divs];
 	// if numDivisions is 0, treat it as 1
 	if (divs == 0) divs = 1;
 	// the length of each division is the output size / number of divisions, rounded up
@@ -1779,11 +1718,17 @@ FSTATUS decompressAndReassemble(unsigned char *input_data, size_t input_size, ui
 	unsigned char *loc = input_data;
 	// need to total up all of the input sizes to make sure they do not exceed the expected input size
 	size_t total_in = 0;
+	PmCodecJob_t jobs[divs];
 
 	int i;
 	for (i = 0; i < divs; i++) {
-		// input
-		input_pieces[i] = loc;
+		jobs[i].codec = codec;
+		jobs[i].decompress = TRUE;
+		jobs[i].input_data = loc;
+		jobs[i].input_size = (size_t)input_sizes[i];
+		jobs[i].output_data = output_data + (i * len);
+		jobs[i].output_size = MIN(len, output_size - (i * len));
+		jobs[i].status = FSUCCESS;
 		loc += input_sizes[i];
 		total_in += (size_t)input_sizes[i];
 	}
@@ -1791,112 +1736,7 @@ FSTATUS decompressAndReassemble(unsigned char *input_data, size_t input_size, ui
 		IB_LOG_ERROR0("Unable to decompress, invalid division sizes");
 		return FERROR;
 	}
-	// in parallel: call decompress on each piece
-	pthread_attr_t attr;
-	pthread_t threads[divs];
-	struct decompress_args args[divs];
-	int ret;
-
-	pthread_attr_init(&attr);
-	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-	for (i = 0; i < divs; i++) {
-		args[i].input_data = input_pieces[i];
-		args[i].input_size = (size_t)input_sizes[i];
-		args[i].output_data = output_data + (i * len);
-		args[i].output_size = MIN(len, output_size - (i * len));
-
-		ret = pthread_create(&threads[i], &attr, threadDecompress, &args[i]);
-		if (ret) IB_LOG_ERROR0("Failed to create decompression thread");
-	}
-	pthread_attr_destroy(&attr);
-
-	// wait for all threads to complete
-	for (i = 0; i < divs; i++) {
-		ret = pthread_join(threads[i], NULL);
-		if (ret) IB_LOG_ERROR0("Failed to join compression thread");
-	}
-	return FSUCCESS;
-}
-
-/************************************************************************************* 
-    compressData - Compress data and write it to a buffer
- 
-    Inputs:
-    	input_data - the data to be compressed
-    	input_size - the number of bytes of data
-    	output_data - pointer to the output data
-    	output_size - pointer to the output size
- 
-    Returns:
-    	Status - FSUCCESS if okay
- 
-    The function will compress what is in input_data, place that in output_data, and
-    update output_size to reflect the size of the output.
- 
-*************************************************************************************/ 
-static FSTATUS compressData(unsigned char *input_data, size_t input_size, unsigned char **output_data, size_t *output_size)  {
-	int ret;
-	z_stream strm;
-	size_t bound;
-
-	// initialize the z stream
-	strm.zalloc = Z_NULL;
-	strm.zfree = Z_NULL;
-	strm.opaque = Z_NULL;
-	ret = deflateInit(&strm, 3);
-	if (ret != Z_OK) {
-		return FERROR;
-	}
-
-	// allocate output
-	// deflate bound gives an upper bound on how much space the compressed data will take up
-	bound = (size_t)deflateBound(&strm, (uLong)input_size);
-	*output_data = (unsigned char*)calloc(1, bound);
-	if (!(*output_data)) {
-		*output_size = 0;
-		(void)deflateEnd(&strm);
-		return FERROR;
-	}
-
-	// get ready to compress
-	strm.avail_in = input_size;
-	strm.next_in = input_data;
-	strm.avail_out = bound;
-	strm.next_out = *output_data;
-
-	// compress the data
-	ret = deflate(&strm, Z_FINISH);
-	if (ret != Z_STREAM_END) {
-		IB_LOG_ERROR0("Error while deflating PM History Image");
-		free(*output_data);
-		return FERROR;
-	}
-
-	// resize the output buffer to match what was actually used
-	*output_size = (uint64)strm.total_out;
-	*output_data = (unsigned char*)realloc(*output_data, *output_size);
-
-	(void)deflateEnd(&strm);
-	return FSUCCESS;
-}
-
-// data needed for the compress thread
-struct compress_args {
-	unsigned char *input_data;
-	size_t input_size;
-	unsigned char **output_data;
-	size_t *output_size;
-};
-
-void *threadCompress(void *args) {
-	FSTATUS ret; 
-	ret = compressData(
-	   ((struct compress_args*)args)->input_data,
-	   ((struct compress_args*)args)->input_size,
-	   ((struct compress_args*)args)->output_data,
-	   ((struct compress_args*)args)->output_size
-	   );
-	pthread_exit(&ret);
+	return PmCodecRun(jobs, divs);
 }
 
 /************************************************************************************* 
@@ -1905,6 +1745,7 @@ void *threadCompress(void *args) {
     Inputs:
     	input_data - the data to be compressed, does not include header
     	input_size - size of input data
+    	codec - PM_HISTORY_CODEC_* to compress with
     	compressed_divisions - pointer to the array of pointers to compressed divisions
     	compressed_lengths - pointer to the array of sizes for the compressed divisions
  
@@ -1912,50 +1753,43 @@ void *threadCompress(void *args) {
     	Status - FSUCCESS if okay
  
     The function will divide the input data into the number of chunks defined in the
-    xml config file. The divisions will be compressed in parallel. The array
-    compressed_divisions will point to each compressed piece, and the array
-    compressed_lengths will tell how long each compressed piece is.
+    xml config file. The divisions will be compressed in parallel by the history
+    codec pool. The array compressed_divisions will point to each compressed piece,
+    and the array compressed_lengths will tell how long each compressed piece is.
  
 *************************************************************************************/ 
-FSTATUS divideAndCompress(unsigned char *input_data, size_t input_size, unsigned char **compressed_divisions, size_t *compressed_lengths) {
-	if (pm_config.shortTermHistory.compressionDivisions == 0) {
+static FSTATUS divideAndCompress(unsigned char *input_data, size_t input_size, uint8 codec, unsigned char **compressed_divisions, size_t *compressed_lengths) {
+	uint8 divs = pm_config.shortTermHistory.compressionDivisions;
+	FSTATUS status;
+
+	if (divs == 0) {
 		// really this shouldn't be possible, but better to be safe
 		IB_LOG_ERROR0("Invalid compression divisions, must not be 0");
 		return FERROR;
 	}
 	// determine the length of each division
 	// the last section may be a little bit shorter than the others if the data doesn't divide equally
-	size_t len = (input_size % pm_config.shortTermHistory.compressionDivisions ? 
-				  (input_size / pm_config.shortTermHistory.compressionDivisions) + 1:
-				  (input_size / pm_config.shortTermHistory.compressionDivisions));
+	size_t len = (input_size % divs ? (input_size / divs) + 1: (input_size / divs));
+	PmCodecJob_t jobs[divs];
 	int i;
 
-	// in parallel: call compressData on each division
-	pthread_attr_t attr;
-	pthread_t threads[pm_config.shortTermHistory.compressionDivisions];
-	struct compress_args args[pm_config.shortTermHistory.compressionDivisions];
-	int ret;
-
-	pthread_attr_init(&attr);
-	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-	for (i = 0; i < pm_config.shortTermHistory.compressionDivisions; i++) {
-		args[i].input_data = input_data + (i * len);
-		args[i].input_size = MIN(len, input_size - (i * len));
-		args[i].output_data = &compressed_divisions[i];
-		args[i].output_size = &compressed_lengths[i];
-
-		ret = pthread_create(&threads[i], &attr, threadCompress, &args[i]);
-		if (ret) IB_LOG_ERROR0("Failed to create compression thread");
+	for (i = 0; i < divs; i++) {
+		jobs[i].codec = codec;
+		jobs[i].decompress = FALSE;
+		jobs[i].input_data = input_data + (i * len);
+		jobs[i].input_size = MIN(len, input_size - (i * len));
+		jobs[i].output_data = NULL;
+		jobs[i].output_size = 0;
+		jobs[i].status = FSUCCESS;
 	}
-	pthread_attr_destroy(&attr);
 
-	// wait for all of the threads to complete
-	for (i = 0; i < pm_config.shortTermHistory.compressionDivisions; i++) {
-		ret = pthread_join(threads[i], NULL);
-		if (ret) IB_LOG_ERROR0("Failed to join compression thread");
-	}
+	status = PmCodecRun(jobs, divs);
 
-	return FSUCCESS;
+	for (i = 0; i < divs; i++) {
+		compressed_divisions[i] = jobs[i].output_data;
+		compressed_lengths[i] = jobs[i].output_size;
+	}
+	return status;
 }
 
 #endif
@@ -3317,6 +3151,7 @@ FSTATUS PmLoadComposite(Pm_t *pm, PmHistoryRecord_t *record, PmCompositeImage_t
 		// decompress the data into the image data buffer
 		ret = decompressAndReassemble(raw_data + sizeof(PmFileHeader_t),
 									  raw_len - sizeof(PmFileHeader_t), 
+									  PmHistoryCodec((PmFileHeader_t*)raw_data),
 									  ((PmFileHeader_t*)raw_data)->numDivisions,
 									  ((PmFileHeader_t*)raw_data)->divisionSizes,
 									  img_data + sizeof(PmFileHeader_t), 
@@ -3338,8 +3173,9 @@ FSTATUS PmLoadComposite(Pm_t *pm, PmHistoryRecord_t *record, PmCompositeImage_t
 		free(raw_data);
 	}
 
-	// check the version
-	if (((PmFileHeader_t*)img_data)->historyVersion != PM_HISTORY_VERSION) {
+	// check the version, the previous one differs only in the codec
+	if (((PmFileHeader_t*)img_data)->historyVersion != PM_HISTORY_VERSION
+		&& ((PmFileHeader_t*)img_data)->historyVersion != PM_HISTORY_VERSION_NO_CODEC) {
 #ifdef __VXWORKS__
 		IB_LOG_ERROR0("Loaded PM history image that does not match current version");
 #else
@@ -3557,7 +3393,11 @@ FSTATUS storeComposite(Pm_t *pm, PmCompositeImage_t *cimg) {
 		}
 
 		// don't compress the header
-		ret = divideAndCompress(data + sizeof(PmFileHeader_t), len - sizeof(PmFileHeader_t), compressed_divisions, compressed_sizes);
+		ret = divideAndCompress(data + sizeof(PmFileHeader_t), len - sizeof(PmFileHeader_t), pm_history_codec, compressed_divisions, compressed_sizes);
+		if (ret != FSUCCESS) {
+			IB_LOG_ERRORRC("Failed to compress PM history image rc:", ret);
+			goto error;
+		}
 
 		writeLen = sizeof(PmFileHeader_t);
 		for (i=0; i < pm_config.shortTermHistory.compressionDivisions; i++) {
@@ -3570,6 +3410,7 @@ FSTATUS storeComposite(Pm_t *pm, PmCompositeImage_t *cimg) {
 
 		// update header with division info
 		((PmFileHeader_t*)data)->numDivisions = pm_config.shortTermHistory.compressionDivisions;
+		((PmFileHeader_t*)data)->codec = pm_history_codec;
 
 		// open file
 		if (!(fp = fopen(cimg->header.common.filename, "wb"))) {
@@ -4024,6 +3865,7 @@ static Status_t PmLoadHistory(Pm_t *pm, boolean master) {
 Status_t PmInitHistory(Pm_t *pm) {
 	Status_t status = VSTATUS_OK;
 	int i;
+	int codec;
 	size_t storage_len;
 	struct stat dirInfo;
 	char *basename;
@@ -4091,6 +3933,23 @@ Status_t PmInitHistory(Pm_t *pm) {
 		return VSTATUS_ILLPARM;
 	}
 
+	// select the codec for new files, files already on disk record their own
+	codec = PmCodecFromName(pm_config.shortTermHistory.compressionCodec);
+	if (codec < 0) {
+		IB_LOG_ERROR_FMT(__func__, "Invalid PM Short-Term History 'compressionCodec' configuration: %s",
+			pm_config.shortTermHistory.compressionCodec);
+		return VSTATUS_ILLPARM;
+	}
+	if (! PmCodecAvailable(codec)) {
+		IB_LOG_WARN_FMT(__func__, "PM Short-Term History codec %s not available in this build, using %s",
+			PmCodecName(codec), PmCodecName(PM_HISTORY_CODEC_ZLIB));
+		codec = PM_HISTORY_CODEC_ZLIB;
+	}
+	pm_history_codec = (uint8)codec;
+
+	// the caller of a compress or decompress works on one division itself
+	(void)PmCodecPoolInit(pm_config.shortTermHistory.compressionDivisions - 1);
+
 	// initialize the instanceId to 0
 	pm->ShortTermHistory.currentInstanceId = 0;	  
 
@@ -4205,10 +4064,11 @@ FSTATUS storeCompositeToBuffer(PmCompositeImage_t *cimg, uint8_t *buffer, uint32
 			ret = FINSUFFICIENT_MEMORY;
 			goto done;
 		}
-		ret = divideAndCompress(data + sizeof(PmFileHeader_t), len - sizeof(PmFileHeader_t), compressed_divisions, compressed_sizes);
+		ret = divideAndCompress(data + sizeof(PmFileHeader_t), len - sizeof(PmFileHeader_t), pm_history_codec, compressed_divisions, compressed_sizes);
 
 		// update header with division info
 		((PmFileHeader_t*)data)->numDivisions = pm_config.shortTermHistory.compressionDivisions;
+		((PmFileHeader_t*)data)->codec = pm_history_codec;
 		for (i = 0; i < pm_config.shortTermHistory.compressionDivisions; i++) 
 			((PmFileHeader_t*)data)->divisionSizes[i] = compressed_sizes[i];
 
@@ -4648,6 +4508,7 @@ void PmDestroy(Pm_t *pm)
 			vs_pool_free(&pm_pool, pmimagep->LidMap);
 			pmimagep->LidMap = NULL;
 		}
+		PmFreePortColumns(&pmimagep->Columns);
 		vs_rwunlock(&pmimagep->imageLock);
 		(void)vs_lock_delete(&pmimagep->imageLock);
 	}
@@ -4688,6 +4549,7 @@ void PmDestroy(Pm_t *pm)
 		pm->AllPorts = NULL;
 	}
 #ifndef __VXWORKS__
+	PmCodecPoolDestroy();
 	if (pm->ShortTermHistory.currentComposite) {
 		PmFreeComposite(pm->ShortTermHistory.currentComposite);
 		pm->ShortTermHistory.currentComposite = NULL;
@@ -4710,6 +4572,33 @@ void PmDestroy(Pm_t *pm)
 #endif
 }
 
+// Log the statistics of a finalized port which exceeded their threshold, up
+// to ThresholdExceededMsgLimit ports per statistic
+static void PmLogExceededThresholds(Pm_t *pm, PmPort_t *pmportp)
+{
+	PmPortImage_t *portImage = &pmportp->Image[pm->SweepIndex];
+	PmPortImage_t *portImageNeighbor = (portImage->neighbor ? &portImage->neighbor->Image[pm->SweepIndex] : NULL);
+
+#define LOG_EXCEEDED_THRESHOLD(stat) \
+	do { \
+		if (portImage->stat##Bucket >= (PM_ERR_BUCKETS-1) \
+			&& pm->AllPorts->Image[pm->SweepIndex].IntErr.Ports[PM_ERR_BUCKETS-1].stat \
+					< pm_config.thresholdsExceededMsgLimit.stat) { \
+			PmPrintExceededPort(pmportp, pm->SweepIndex, \
+				#stat, pm->Thresholds.stat, portImage->Errors.stat); \
+			PmPrintExceededPortDetails##stat(portImage, portImageNeighbor); \
+		} \
+	} while (0)
+
+	LOG_EXCEEDED_THRESHOLD(Integrity);
+	LOG_EXCEEDED_THRESHOLD(Congestion);
+	LOG_EXCEEDED_THRESHOLD(SmaCongestion);
+	LOG_EXCEEDED_THRESHOLD(Bubble);
+	LOG_EXCEEDED_THRESHOLD(Security);
+	LOG_EXCEEDED_THRESHOLD(Routing);
+#undef LOG_EXCEEDED_THRESHOLD
+}
+
 // After all individual ports have been tabulated, we tabulate totals for
 // all groups.  We must do this after port tabulation because some counters
 // need to look at both sides of a link to pick the max or combine error
@@ -4723,7 +4612,7 @@ static void PmFinalizeAllPortStats(Pm_t *pm)
 	uint16 lid;
 	PmPort_t *pmportp;
 	PmImage_t *pmimagep = &pm->Image[pm->SweepIndex];
-	PmPortImage_t *portImage, *portImageNeighbor = NULL;
+	PmPortColumns_t *columns = &pmimagep->Columns;
 	// get totalsLock so we can update RunningTotals and avoid any races
 	// with paClearPortCounters
 	(void)vs_wrlock(&pm->totalsLock);
@@ -4746,17 +4635,6 @@ static void PmFinalizeAllPortStats(Pm_t *pm)
 		}
 	}
 	(void)vs_rwunlock(&pm->totalsLock);
-	// Log Ports which exceeded threshold up to ThresholdExceededMsgLimit
-#define LOG_EXCEEDED_THRESHOLD(stat) \
-	do { \
-		if (portImage->stat##Bucket >= (PM_ERR_BUCKETS-1) \
-			&& pm->AllPorts->Image[pm->SweepIndex].IntErr.Ports[PM_ERR_BUCKETS-1].stat \
-					< pm_config.thresholdsExceededMsgLimit.stat) { \
-			PmPrintExceededPort(pmportp, pm->SweepIndex, \
-				#stat, pm->Thresholds.stat, portImage->Errors.stat); \
-			PmPrintExceededPortDetails##stat(portImage, portImageNeighbor); \
-		} \
-	} while (0)
 
 	for (lid = 1; lid <= pmimagep->maxLid; ++lid) {
 		PmNode_t *pmnodep = pmimagep->LidMap[lid];
@@ -4767,34 +4645,56 @@ static void PmFinalizeAllPortStats(Pm_t *pm)
 			for (i=0; i<= pmnodep->numPorts; ++i) {
 				pmportp = pmnodep->up.swPorts[i];
 				if (pmportp && ! pmportp->u.s.PmaAvoid
-					&& pmportp->Image[pm->SweepIndex].u.s.active) {
-					portImage = &pmportp->Image[pm->SweepIndex];
-					portImageNeighbor = (portImage->neighbor ? &portImage->neighbor->Image[pm->SweepIndex] : NULL);
-					ComputeBuckets(pm, portImage);
-					LOG_EXCEEDED_THRESHOLD(Integrity);
-					LOG_EXCEEDED_THRESHOLD(Congestion);
-					LOG_EXCEEDED_THRESHOLD(SmaCongestion);
-					LOG_EXCEEDED_THRESHOLD(Bubble);
-					LOG_EXCEEDED_THRESHOLD(Security);
-					LOG_EXCEEDED_THRESHOLD(Routing);
-                }
-            }
+					&& pmportp->Image[pm->SweepIndex].u.s.active)
+					ComputeBuckets(pm, &pmportp->Image[pm->SweepIndex]);
+			}
 		} else {
 			pmportp = pmnodep->up.caPortp;
-			if (pmportp && ! pmportp->u.s.PmaAvoid) {
-                portImage = &pmportp->Image[pm->SweepIndex];
-                portImageNeighbor = (portImage->neighbor ? &portImage->neighbor->Image[pm->SweepIndex] : NULL);
-                ComputeBuckets(pm, portImage);
-				LOG_EXCEEDED_THRESHOLD(Integrity);
-                LOG_EXCEEDED_THRESHOLD(Congestion);
-                LOG_EXCEEDED_THRESHOLD(SmaCongestion);
-                LOG_EXCEEDED_THRESHOLD(Bubble);
-                LOG_EXCEEDED_THRESHOLD(Security);
-                LOG_EXCEEDED_THRESHOLD(Routing);
-            }
+			if (pmportp && ! pmportp->u.s.PmaAvoid)
+				ComputeBuckets(pm, &pmportp->Image[pm->SweepIndex]);
+		}
+	}
+
+	// buckets are final, build the columns PA queries scan
+	PmBuildPortColumns(pm, pmimagep, pm->SweepIndex);
+
+	// Log Ports which exceeded threshold up to ThresholdExceededMsgLimit.
+	// Few ports exceed, so scan the bucket columns and only visit the images
+	// of ports in the top bucket
+	if (columns->valid) {
+		uint32 id;
+		int c;
+
+		for (id = 0; id < columns->numPorts; id++) {
+			if (! (columns->flags[id] & PM_PORT_COL_FLAG_FINALIZED))
+				continue;
+			for (c = PM_PORT_COL_INTEGRITY; c <= PM_PORT_COL_ROUTING; c++) {
+				if (columns->bucket[c][id] >= (PM_ERR_BUCKETS-1))
+					break;
+			}
+			if (c <= PM_PORT_COL_ROUTING)
+				PmLogExceededThresholds(pm, columns->port[id]);
+		}
+	} else {
+		for (lid = 1; lid <= pmimagep->maxLid; ++lid) {
+			PmNode_t *pmnodep = pmimagep->LidMap[lid];
+			if (! pmnodep)
+				continue;
+			if (pmnodep->nodeType == STL_NODE_SW) {
+				uint8 i;
+				for (i=0; i<= pmnodep->numPorts; ++i) {
+					pmportp = pmnodep->up.swPorts[i];
+					if (pmportp && ! pmportp->u.s.PmaAvoid
+						&& pmportp->Image[pm->SweepIndex].u.s.active)
+						PmLogExceededThresholds(pm, pmportp);
+				}
+			} else {
+				pmportp = pmnodep->up.caPortp;
+				if (pmportp && ! pmportp->u.s.PmaAvoid)
+					PmLogExceededThresholds(pm, pmportp);
+			}
 		}
 	}
-#undef LOG_EXCEEDED_THRESHOLD
 }
 
 #if 0
@@ -5037,6 +4937,8 @@ static FSTATUS PmSweep(Pm_t *pm)
 
 	(void)vs_wrlock(&pmimagep->imageLock);
 	(void)vs_rwunlock(&pm->stateLock);
+	// topology may change below, columns are rebuilt once sweep is finalized
+	pmimagep->Columns.valid = FALSE;
 	vs_stdtime_get(&pmimagep->sweepStart);
 	vs_time_get(&sweepStart);
 
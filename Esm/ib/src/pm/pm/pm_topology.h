@@ -695,6 +695,72 @@ typedef struct PmDispatcherNode_s {
 	PmDispatcherPacket_t *DispPackets;	// allocated array of PmaBatchSize
 } PmDispatcherNode_t;
 
+// Columnar (structure of arrays) copy of the per port statistics which PA
+// queries scan across the whole fabric.  Built by the engine once all ports
+// in an image have been finalized.  Ports are indexed by a port id assigned
+// in LidMap order: the ports of the node at a given lid occupy
+// firstPort[lid] .. firstPort[lid]+numPorts, so iterating ids in order visits
+// ports in the same order as the classic lid/portNum loops.
+typedef enum {
+	PM_PORT_COL_UTIL = 0,		// utilization in tenths of a percent
+	PM_PORT_COL_PKTS,			// SendKPps
+	PM_PORT_COL_INTEGRITY,		// Errors.Integrity
+	PM_PORT_COL_CONGESTION,		// Errors.Congestion
+	PM_PORT_COL_SMA_CONGESTION,	// Errors.SmaCongestion
+	PM_PORT_COL_BUBBLE,			// Errors.Bubble
+	PM_PORT_COL_SECURITY,		// Errors.Security
+	PM_PORT_COL_ROUTING,		// Errors.Routing
+	PM_PORT_COL_MAX
+} PmPortColumn_t;
+
+#define PM_PORT_COL_NO_NEIGHBOR		0xffffffff
+
+// PmPortColumns_t.flags
+#define PM_PORT_COL_FLAG_VALID		0x01	// PMA available and port active
+#define PM_PORT_COL_FLAG_QUERY_OK	0x02	// queryStatus == PM_QUERY_STATUS_OK
+#define PM_PORT_COL_FLAG_FINALIZED	0x04	// stats finalized and buckets computed
+
+// Focus index, the best PM_FOCUS_INDEX_DEPTH links of an image for each
+// focus select and group, built along with the columns so PA focus queries
+// slice a sorted list rather than scan every port.  Index f below
+// PM_PORT_COL_MAX holds the highest values of column f, PM_FOCUS_UTIL_LOW the
+// lowest utilization.  Group index PM_MAX_GROUPS is all ports.  As for the
+// classic scan, a link is sorted on the larger value of its two ends and is
+// listed once, by its first port id in the group.
+#define PM_FOCUS_INDEX_DEPTH	64
+#define PM_FOCUS_UTIL_LOW		PM_PORT_COL_MAX
+#define PM_FOCUS_MAX			(PM_PORT_COL_MAX + 1)
+#define PM_FOCUS_GROUPS			(PM_MAX_GROUPS + 1)
+
+typedef struct PmFocusEntry_s {
+	uint32		sortValue;
+	uint32		id;			// port id in PmPortColumns_t
+} PmFocusEntry_t;
+
+typedef struct PmFocusIndex_s {
+	uint32		count[PM_FOCUS_GROUPS][PM_FOCUS_MAX];
+	PmFocusEntry_t entry[PM_FOCUS_GROUPS][PM_FOCUS_MAX][PM_FOCUS_INDEX_DEPTH];
+} PmFocusIndex_t;
+
+typedef struct PmPortColumns_s {
+	boolean		valid;		// columns reflect the current image contents
+	uint32		numPorts;	// port ids in use
+	uint32		portsSize;	// port ids allocated
+	uint32		lidsSize;	// firstPort entries allocated
+	uint32		*firstPort;	// indexed by lid, first port id of the node
+	PmPort_t	**port;		// NULL for unused ids
+	STL_LID_32	*lid;
+	uint8		*portNum;
+	uint8		*flags;		// PM_PORT_COL_FLAG_*
+	uint16		*groupMask;	// bit i set if port is in Pm.Groups[i]
+	uint16		*intLinkMask;	// bit i set if neighbor also in Pm.Groups[i]
+	uint32		*neighbor;	// port id of neighbor or PM_PORT_COL_NO_NEIGHBOR
+	uint32		*value[PM_PORT_COL_MAX];	// see PmPortColumn_t
+	uint8		*bucket[PM_PORT_COL_MAX];	// UtilBucket and error buckets,
+											// NULL for PM_PORT_COL_PKTS
+	PmFocusIndex_t	*focus;	// NULL if could not be allocated
+} PmPortColumns_t;
+
 typedef struct PmImage_s {
 	// These fields are protected by Pm.stateLock
 	uint8		state;		// Image State
@@ -747,6 +813,7 @@ typedef struct PmImage_s {
 	uint32		UnexpectedClearPorts;	// Ports which whose counters decreased
 	uint32		DowngradedPorts; // Ports whose Link Width has been downgraded
 
+	PmPortColumns_t	Columns;	// protected by imageLock, see PmBuildPortColumns
 } PmImage_t;
 
 // --------------- Short-Term PA History --------------------
@@ -755,9 +822,17 @@ typedef struct PmImage_s {
 #define PM_HISTORY_MAX_IMAGES_PER_COMPOSITE 60
 #define PM_HISTORY_MAX_SMS_PER_COMPOSITE 2
 #define PM_HISTORY_MAX_LOCATION_LEN 111
-#define PM_HISTORY_VERSION 4
+#define PM_HISTORY_VERSION 5
+#define PM_HISTORY_VERSION_NO_CODEC 4	// same layout, codec byte reserved
 #define PM_MAX_COMPRESSION_DIVISIONS 32
 
+// compression codecs for history files.  Files before version 5 did not
+// record the codec and are zlib, see PmHistoryCodec
+#define PM_HISTORY_CODEC_ZLIB	0
+#define PM_HISTORY_CODEC_LZ4	1	// fast, built with PM_HISTORY_LZ4
+#define PM_HISTORY_CODEC_ZSTD	2	// dense, built with PM_HISTORY_ZSTD
+#define PM_HISTORY_CODEC_MAX	3
+
 typedef struct PmCompositePort_s {
 	uint64	guid;
 	// This is problematic to maintain, but a short-term work-around:
@@ -905,10 +980,19 @@ typedef struct PmFileHeader_s {
 	uint64	flatSize;
 	uint16	historyVersion;
 	uint8	numDivisions;
-	uint8	reserved[5];
+	uint8	codec;			// PM_HISTORY_CODEC_*, used when common.isCompressed
+	uint8	reserved[4];
 	uint64	divisionSizes[PM_MAX_COMPRESSION_DIVISIONS];
 } PmFileHeader_t;
 
+// codec a compressed history image was written with
+static __inline uint8 PmHistoryCodec(const PmFileHeader_t *header)
+{
+	if (header->historyVersion <= PM_HISTORY_VERSION_NO_CODEC)
+		return PM_HISTORY_CODEC_ZLIB;
+	return header->codec;
+}
+
 typedef struct PmCompositeImage_s {
 	PmFileHeader_t	header;
 	uint64	sweepStart;
@@ -1382,7 +1466,27 @@ BSWAP_PM_COMPOSITE_IMAGE_FLAT(PmCompositeImage_t *Dest, boolean hton)
 
 void clearLoadedImage(PmShortTermHistory_t *sth);
 size_t computeCompositeSize(void);
-FSTATUS decompressAndReassemble(unsigned char *input_data, size_t input_size, uint8 divs, size_t *input_sizes, unsigned char *output_data, size_t output_size);
+FSTATUS decompressAndReassemble(unsigned char *input_data, size_t input_size, uint8 codec, uint8 divs, uint64 *input_sizes, unsigned char *output_data, size_t output_size);
+
+// pm_codec.c - history compression codecs and the worker pool which
+// compresses or decompresses the divisions of a history image in parallel
+typedef struct PmCodecJob_s {
+	uint8			codec;			// PM_HISTORY_CODEC_*
+	boolean			decompress;
+	unsigned char	*input_data;
+	size_t			input_size;
+	unsigned char	*output_data;	// compress: allocated by job, caller frees
+									// decompress: supplied by caller
+	size_t			output_size;	// compress: output, decompress: input
+	FSTATUS			status;
+} PmCodecJob_t;
+
+const char *PmCodecName(uint8 codec);
+int PmCodecFromName(const char *name);
+boolean PmCodecAvailable(uint8 codec);
+Status_t PmCodecPoolInit(uint32 threads);
+void PmCodecPoolDestroy(void);
+FSTATUS PmCodecRun(PmCodecJob_t *jobs, uint32 numJobs);
 FSTATUS rebuildComposite(PmCompositeImage_t *cimg, unsigned char *data);
 void writeImageToBuffer(Pm_t *pm, uint32 histindex, uint8_t isCompressed, uint8_t *buffer, uint32_t *bIndex);
 void PmFreeComposite(PmCompositeImage_t *cimg);
@@ -1605,6 +1709,12 @@ void PmClearPortImage(PmPortImage_t *portImage);
 void FinalizeVFStats(PmVFImage_t *vfImage);
 
 uint32_t PmCalculateRate(uint32_t speed, uint32_t width);
+uint32 PmCalculateUtilPct10(PmPortImage_t *portImage);
+void PmBuildPortColumns(Pm_t *pm, PmImage_t *pmimagep, uint32 imageIndex);
+void PmFocusInsert(boolean low, PmFocusEntry_t *heap, uint32 *count, uint32 size,
+				const PmFocusEntry_t *entry);
+void PmFocusSort(boolean low, PmFocusEntry_t *heap, uint32 count);
+void PmFreePortColumns(PmPortColumns_t *columns);
 void UpdateInGroupStats(Pm_t *pm, PmGroupImage_t *groupImage, PmPortImage_t *portImage);
 void UpdateExtGroupStats(Pm_t *pm, PmGroupImage_t *groupImage, PmPortImage_t *portImage, PmPortImage_t *portImage2);
 void UpdateVFStats(Pm_t *pm, PmVFImage_t *vfImage, PmPortImage_t *portImage);
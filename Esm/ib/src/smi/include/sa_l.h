@@ -127,12 +127,34 @@ typedef struct _FieldMask {
 } FieldMask_t;
 
 //
-//      Scratch pad for template queries.
+//	Per-thread SA request state.
 //
-extern	uint8_t         template_mask[4096];
-extern	uint32_t        template_offset;
-extern	uint32_t        template_length;
-extern	FieldMask_t     *template_fieldp;
+//	The response build buffer and the template query scratch pad are used
+//	by every request handler.  Each thread that processes SA requests (the
+//	reader and any SA worker threads) owns one of these; threads that are
+//	not SA workers share the reader's.
+//
+typedef struct _SaThreadState {
+	uint8_t		*data;			// response build buffer, sa_data_length bytes
+	IBhandle_t	fd;				// mai handle for the first packet of responses
+	uint8_t		templateMask[4096];
+	uint16_t	templateType;
+	uint32_t	templateOffset;
+	uint32_t	templateLength;
+	FieldMask_t	*templateFieldp;
+} SaThreadState_t;
+
+extern	SaThreadState_t	*sa_thread_state(void);
+
+//
+//      Scratch pad for template queries.  They must be used sequentially
+//      within a thread.
+//
+#define	template_mask		(sa_thread_state()->templateMask)
+#define	template_type		(sa_thread_state()->templateType)
+#define	template_offset		(sa_thread_state()->templateOffset)
+#define	template_length		(sa_thread_state()->templateLength)
+#define	template_fieldp		(sa_thread_state()->templateFieldp)
 
 //
 // SA Caching
@@ -195,7 +217,7 @@ typedef struct sa_cntxt {
 	uint64_t	tid ;		// Tid for hash table search
 	Lid_t		lid ;		// Lid for hash table search
     uint16_t    method;     // initial method requested by initiator
-    IBhandle_t	sendFd;     // mai handle to use for sending packets (fd_sa for 1st seg and fd_sa_w threafter)
+    IBhandle_t	sendFd;     // mai handle to use for sending packets (reader/worker handle for 1st seg and fd_sa_w threafter)
 	uint8_t		hashed ;	// Entry is inserted into the hash table
 	uint32_t	ref ;		// Reference count for the structure
     uint32_t    reqDataLen; // length of the getMulti request MAD
@@ -340,7 +362,8 @@ extern SubscriberTable_t   saSubscribers;
 extern ServiceRecTable_t   saServiceRecords;
 extern  uint32_t    saDebugRmpp;    // controls output of SA INFO RMPP+ messages
 extern uint32_t     saRmppCheckSum; // rmppp response checksum control
-extern	uint8_t		*sa_data;
+#define	sa_data			(sa_thread_state()->data)
+#define	sa_reply_fd		(sa_thread_state()->fd)
 extern SACache_t	saCache;
 extern SACacheBuildFunc_t	saCacheBuildFunctions[];	
 
@@ -442,8 +465,14 @@ extern  void		sa_cache_clean(void);
 extern  Status_t	sa_cache_release(SACacheEntry_t *);
 extern	Status_t    sa_cache_cntxt_free(sa_cntxt_t *);
 
+extern  Status_t	sa_PathRecord_CacheInit(uint32_t);
+extern  void		sa_PathRecord_CacheInvalidate(void);
+extern  void		sa_PathRecord_CacheDelete(void);
+
 extern  char *      sa_getMethodText(int method);
-extern  char *      sa_getAidName(uint16_t aid);
+// buf receives the name of an unknown aid, it needs SA_AID_NAME_LEN bytes
+#define SA_AID_NAME_LEN     8
+extern  char *      sa_getAidName(uint16_t aid, char *buf, size_t len);
 
 extern	void		dumpGid(IB_GID gid);
 extern	void		dumpGuid(Guid_t guid);
@@ -256,6 +256,10 @@ typedef enum _smCounters {
 	smCounterSaDroppedRequests,
 	smCounterSaContextNotAvailable,
 
+	// PathRecord cache
+	smCounterSaPathRecordCacheHits,
+	smCounterSaPathRecordCacheMisses,
+
 	// GetMulti Request stuff
 	smCounterSaGetMultiNonRmpp,
 	smCounterSaRxGetMultiInboundRmppAbort,
@@ -327,6 +331,11 @@ typedef enum _sm_peak_counters {
 	smMaxSaContextsInUse,
 	smMaxSaContextsFree,
 	smMaxSweepTime,			// in milliseconds
+	smMaxSweepAllocs,		// topology arena allocations in one sweep
+	smMaxSweepFrees,		// topology arena frees in one sweep
+	smMaxSweepArenaKb,		// topology arena high water mark, in KB
+	smMaxRssKb,				// process peak resident set size, in KB
+	smMaxSaPathRecordCacheEntries,
 
 	smPeakCountersMax // Last value
 } sm_peak_counters_t;
@@ -469,4 +478,41 @@ extern void sm_print_counters_to_stream(FILE * out);
 extern char * sm_print_counters_to_buf(void);
 #endif
 
+//
+// Sweep phase profile.
+//
+// topology_main() brackets each entry of its topology_functions[] table
+// with sm_profile_phase_begin() and sm_profile_phase_end().  The cost of a
+// phase is the change in the SMA transmit and retransmit counters and in
+// the topology arena allocation count across the call, plus its wall time.
+// The last SM_PROFILE_WINDOW sweeps are kept per phase and summarized, with
+// a log2 histogram of wall time, when the profile is printed.
+//
+// MAD round trip times are reported by sm_send_request and by the cs_context
+// which SM dispatched requests complete through (see rttHook) and are
+// binned per attribute id.  Both are cleared by sm_reset_counters().
+//
+#define SM_PROFILE_MAX_PHASES	16
+#define SM_PROFILE_WINDOW		32		// sweeps kept per phase
+#define SM_PROFILE_BUCKETS		20		// log2 buckets, see sm_profile_bucket()
+#define SM_PROFILE_MAX_ATTRS	48		// distinct attribute ids tracked
+
+struct _SmArena;
+
+typedef struct _sm_profile_mark {
+	uint64_t	start;			// usecs
+	uint32_t	mads;
+	uint32_t	retries;
+	struct _SmArena *arena;
+	uint64_t	allocs;
+} sm_profile_mark_t;
+
+extern void sm_profile_phase_begin(sm_profile_mark_t *mark);
+extern void sm_profile_phase_end(int phase, const char *name, const sm_profile_mark_t *mark);
+extern void sm_profile_mad_rtt(uint16_t aid, uint64_t usecs);
+
+#ifndef __VXWORKS__
+extern char * sm_print_profile_to_buf(void);
+#endif
+
 #endif	// _SM_COUNTERS_H_
@@ -73,6 +73,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ilist.h"
 #include "iquickmap.h"
+#include "ihashmap.h"
 #include <iba/stl_sm.h>
 #include <iba/stl_helper.h>
 
@@ -292,8 +293,6 @@ typedef	struct _PortData {
 									//bit[0]: link below max supported
 									//bit[1]: port below minimum allowed
 
-	cl_map_obj_t	mapObj;		// quickmap item to sort on GUIDs
-
 	struct _Node *nodePtr; 	// Ptr to the node record this port belongs.
 	//void       *pmData;		// Pointer to Pm per port Data
 
@@ -353,6 +352,24 @@ typedef	struct _Port {
 #else
 #define MAX_MCAST_MGIDS  20000
 #endif
+
+//
+//	Linear forwarding tables are held as MAX_LFT_ELEMENTS_BLOCK entry blocks
+//	that are shared copy-on-write between a switch in the old topology and the
+//	same switch in the new one, so a sweep only duplicates the blocks it
+//	changes.  Blocks never written point at a shared block of 0xff entries.
+//	Use the sm_lft_* accessors rather than the blocks; see sm_lft.c.
+//
+typedef struct _LftBlock {
+	ATOMIC_UINT	refCount;	// tables referencing this block
+	PORT		entry[MAX_LFT_ELEMENTS_BLOCK];
+} LftBlock_t;
+
+typedef struct _Lft {
+	uint32_t	numBlocks;
+	LftBlock_t	*block[1];	// numBlocks entries
+} Lft_t;
+
 typedef	struct _Node {
 	uint32_t	index;		// index in linked list
 	uint32_t	oldIndex;	// index in linked list in old topology
@@ -362,13 +379,15 @@ typedef	struct _Node {
 	STL_NODE_DESCRIPTION	nodeDesc;	// NodeInfo (for SA)
 	STL_SWITCH_INFO	switchInfo;	// SwitchInfo (for SA)	// TBD make a pointer and only allocate for switches
 	STL_PORT_STATE_INFO *portStateInfo;
+	uint32_t	discoveredLid;		// switch port 0 LID as read by discovery, before LID assignment
+	uint32_t	discoveredFDBTop;	// SwitchInfo.LinearFDBTop as read by discovery
 	STL_CONGESTION_INFO congestionInfo;
 	uint8_t		path[64];	// directed path to this node
-	PORT		*lft;
+	Lft_t		*lft;		// see sm_lft_port() and sm_lft_set_port()
 	STL_PORTMASK **mft;		// 2D array of port masks for MFT.
 	STL_PORTMASK *pgt;		// 1D array of port masks for Port Group Table. 
 	uint8_t		pgtLen;		// Current length of PGT. 
-	PORT		*pgft;		///< Port Group Forwarding Table
+	PORT		*pgft;		///< Port Group Forwarding Table, shared copy-on-write; see sm_Node_get_pgft_wr()
 	uint32_t 	pgftSize; 	///< amount of memory allocated for pgft; should track actual memory allocation, not highest entry in use
 	Port_t		*port;		// ports on this node
 	bitset_t	activePorts;
@@ -379,6 +398,13 @@ typedef	struct _Node {
 	uint64_t	nonRespTime;	// Timestamp of first failure to respond.
 	uint8_t     asyncReqsSupported; // number of async requests node can handle
 	uint8_t     asyncReqsOutstanding; // number of async requests on the wire
+	uint8_t     asyncReqsWindow;	// adaptive limit on async requests, see sm_dispatch.c
+	uint8_t     asyncReqsCredit;	// responses since asyncReqsWindow last grew
+	uint8_t     asyncReqsRecover;	// requests sent before last shrink still on the wire
+	uint32_t    madRttAvg;			// smoothed async response time in usec, scaled by 8
+	uint32_t    madRttMin;			// fastest async response time seen in usec
+	uint32_t    madResponses;		// async responses received
+	uint32_t    madTimeouts;		// async requests which timed out
 	uint8_t		portsInInit; 
 	uint8_t		activeVLs; 
 	uint8_t		tier; 			// tier switch resides on in fat tree
@@ -386,6 +412,7 @@ typedef	struct _Node {
 	uint8_t		uplinkTrunkCnt; // number of uplink ports in trunk group
 	uint16_t	numLidsRouted;	// used to build balanced LFTs.
 	uint16_t	numBaseLidsRouted;	// used to build balanced LFTs when LMC enabled.
+	struct _LftWorkspace *lftWorkspace;	// set while a worker works on this switch's LFT
 	char*		nodeDescString;	// Only used when nodeDesc is 64 chars (not null terminated).
 	cl_map_obj_t	mapObj;		// Quickmap item to sort on guids
 	cl_map_obj_t	nodeIdMapObj;	// Quickmap item to sort on guids
@@ -427,6 +454,9 @@ typedef	struct _Node {
 	//uint8_t		pmFlags;		// PM flag - TBD how many bits needed
 	uint8_t		slscChange:1;		//indicates if sl2sc of the node needs to be programmed
 	uint8_t		aggregateEnable:1;
+	uint8_t		lightTrusted:1;		// light sweep took this switch from the old topology
+	uint8_t		warmStart:1;		// switch still holds the LFT, PGT and PGFT restored from the warm start snapshot
+	uint8_t		mftWarm:1;			// MFT matches the warm start snapshot, see sm_snapshot_match_mfts()
 } Node_t;
 
 typedef struct _QuarantinedNode {
@@ -658,6 +688,20 @@ typedef struct _PreDefTopoLogCounts {
 	uint32_t 	undefinedLinkQuarantined;
 } PreDefTopoLogCounts;
 
+//
+//	Per sweep allocator for the objects owned by a topology; see sm_arena.c.
+//
+typedef struct _SmArena SmArena_t;
+
+typedef struct {
+	uint64_t	allocs;			// blocks allocated
+	uint64_t	frees;			// blocks freed before the arena was released
+	uint64_t	reused;			// allocations satisfied from the free lists
+	uint64_t	inUseBytes;		// bytes currently allocated
+	uint64_t	peakBytes;		// high water mark of inUseBytes
+	uint64_t	reservedBytes;	// bytes obtained from sm_pool
+} SmArenaStats_t;
+
 //
 //	Per Topology structure.
 //
@@ -675,7 +719,8 @@ typedef	struct _Topology {
 	uint32_t	state;		// SM state
 	uint32_t	maxLid;		// maximum Lid assigned
 
-	uint16_t	*cost;		// array for path resolution
+	uint16_t	*cost;		// array for path resolution, see sm_cost_get()
+	uint8_t		costMode;	// SM_COST_* layout of cost
 
 	Node_t		*node_head;	// linked list of nodes
 	Node_t		*node_tail;	// ditto
@@ -704,7 +749,8 @@ typedef	struct _Topology {
 	uint8_t		pad[65536];	// general scratch pad area
 	Node_t		**nodeArray;	// Array of all nodes
 	cl_qmap_t	*nodeMap;	// Sorted GUID tree of all nodes
-	cl_qmap_t	*portMap;	// Sorted GUID tree of all ports
+	cl_hmap_t	nodeGuidMap;	// GUID index of all nodes, for lookups
+	cl_hmap_t	portGuidMap;	// GUID index of all ports
 	cl_qmap_t	*nodeIdMap; // Sorted Node tree based on the locally assigned node id.
 	cl_qmap_t	*quarantinedNodeMap;	// Sorted GUID tree of all nodes
 	uint8_t		maxMcastMtu; // Maximum MTU supported by fabric for multicast traffic
@@ -734,6 +780,10 @@ typedef	struct _Topology {
 	/// Store link down reasons for ports that disappeared;
 	/// see LdrCacheEntry_t
 	cl_qmap_t *ldrCache;
+
+	/// Nodes, port data, node descriptions and LFTs/MFTs of this topology.
+	/// Created when the sweep starts, released by topology_free_topology().
+	SmArena_t *arena;
 } Topology_t;
 
 typedef struct {
@@ -805,6 +855,8 @@ typedef	struct _McGroup {
 	uint8_t			tClass;
 	uint8_t			scope;
 	McMember_t		*mcMembers;
+	CS_HashTablep	mcMemberMap;		// PortGID to member
+	CS_HashTablep	mcMemberIndexMap;	// member index to member
 	uint32_t		index_pool; /* Next index to use for new Mc Member records */
 	bitset_t		vfMembers;
 	McGroupFlags	flags;      // Flags associated with this group
@@ -899,10 +951,20 @@ typedef struct sm_dispatch_send_params {
     uint8_t bversion; 
 } sm_dispatch_send_params_t;
 
+struct sm_dispatch_req;
+
+// optional per request hook, called with the response (or a NULL mad on
+// timeout) from the dispatcher callback with sm_async_send_rcv_cntxt.lock held
+typedef void (*sm_dispatch_resp_cb_t)(struct sm_dispatch_req *req, Status_t status, Mai_t *mad);
+
 typedef struct sm_dispatch_req {
 	sm_dispatch_send_params_t sendParams;
 	Node_t *nodep;
 	uint32_t sweepPasscount;
+	uint64_t sendTime;		// when handed to the wire, for response time
+	sm_dispatch_resp_cb_t respCb;
+	void *respData;
+	uint32_t respTag;
 	struct sm_dispatch *disp;
 	struct sm_dispatch_req *next, *prev;
 	LIST_ITEM item;
@@ -942,6 +1004,70 @@ typedef struct SwitchportToNextGuid
 	Node_t	 *nextSwp;
 } SwitchportToNextGuid_t;
 
+//
+// Per-thread state for sm_shortestpath_calculate_all_lfts_parallel().  While
+// a worker collects a switch's candidate ports, switchp->lftWorkspace points
+// at the worker's workspace and the routing modules take their port scratch
+// space from it instead of the shared topop->pad.
+//
+
+typedef struct _LftWorkspace {
+	SwitchportToNextGuid_t	orderedPorts[256];
+	uint32_t	*first;			// candidate ports of the current switch,
+	uint8_t		*ports;			// see LftCandidates_t in sm_shortestpath.c
+} LftWorkspace_t;
+
+static __inline__ SwitchportToNextGuid_t * sm_lft_ordered_ports(Topology_t *topop, Node_t *switchp) {
+	return (switchp->lftWorkspace ? switchp->lftWorkspace->orderedPorts
+			: (SwitchportToNextGuid_t *)topop->pad);
+}
+
+//
+// A destination for sm_shortestpath_calculate_all_lfts_parallel(), listed in
+// the order the serial LFT calculation visits destinations.
+//
+
+typedef struct {
+	Node_t	*nodep;
+	Port_t	*portp;
+} LftDest_t;
+
+//
+// sm_lft.c prototypes
+//
+
+Status_t     sm_lft_alloc(Node_t *switchp);
+Status_t     sm_lft_share(Node_t *switchp, const Node_t *oldSwitchp);
+void         sm_lft_release(Node_t *switchp);
+const PORT * sm_lft_block(const Node_t *switchp, uint32_t block);
+PORT *       sm_lft_block_wr(Node_t *switchp, uint32_t block);
+void         sm_lft_copy_blocks(const Node_t *switchp, uint32_t block, uint16_t numBlocks,
+                                STL_LINEAR_FORWARDING_TABLE *lftp);
+PORT *       sm_pgft_alloc(size_t size);
+PORT *       sm_pgft_share(PORT *pgft);
+uint32_t     sm_pgft_release(PORT *pgft);
+uint32_t     sm_pgft_refs(const PORT *pgft);
+
+// egress port for lid, 0xff when the lid is beyond the table
+static __inline__ PORT sm_lft_port(const Node_t *switchp, uint32_t lid) {
+	uint32_t block = lid / MAX_LFT_ELEMENTS_BLOCK;
+
+	if (!switchp->lft || block >= switchp->lft->numBlocks)
+		return 0xff;
+	return switchp->lft->block[block]->entry[lid % MAX_LFT_ELEMENTS_BLOCK];
+}
+
+// rewriting an entry with the value it already has leaves its block shared
+static __inline__ void sm_lft_set_port(Node_t *switchp, uint32_t lid, PORT port) {
+	PORT *entry;
+
+	if (sm_lft_port(switchp, lid) == port)
+		return;
+	entry = sm_lft_block_wr(switchp, lid / MAX_LFT_ELEMENTS_BLOCK);
+	if (entry)
+		entry[lid % MAX_LFT_ELEMENTS_BLOCK] = port;
+}
+
 //
 // Use for slsc/vlarb setup
 //
@@ -1021,6 +1147,52 @@ static __inline__ void setResweepReason(SweepReason_t reason) {
 #define	Min(X,Y)		((X) < (Y)) ? (X) : (Y)
 #define	Max(X,Y)		((X) > (Y)) ? (X) : (Y)
 
+//
+// Cost matrix layouts.  Routing always builds SM_COST_FULL, a max_sws x
+// max_sws matrix indexed with Index() holding both triangles.  Once the
+// sweep completes sm_routing_pack_floyds() may replace it with the strict
+// upper triangle, row by row, as uint16_t or, when every finite cost is
+// below 0xff, as uint8_t with 0xff standing for Cost_Infinity.  The
+// matrix is symmetric with a zero diagonal so nothing is lost.
+//
+// Code outside the Floyd-Warshall internals reads and writes costs
+// through sm_cost_get() and sm_cost_set(); only a full matrix can be set.
+//
+#define	SM_COST_FULL		0
+#define	SM_COST_PACKED16	1
+#define	SM_COST_PACKED8		2
+
+#define	SM_COST_PACKED8_INFINITY	0xff
+
+static __inline__ size_t sm_cost_packed_index(const Topology_t *topop, int i, int j) {
+	size_t n = topop->max_sws, r = i;
+	// i < j: rows 0..i-1 hold n-1, n-2, ... entries
+	return r * (2 * n - r - 1) / 2 + (j - i - 1);
+}
+
+static __inline__ uint16_t sm_cost_get(const Topology_t *topop, int i, int j) {
+	uint8_t c8;
+
+	if (topop->costMode == SM_COST_FULL)
+		return topop->cost[(size_t)i * topop->max_sws + j];
+	if (i == j)
+		return 0;
+	if (i > j) {
+		int t = i; i = j; j = t;
+	}
+	if (topop->costMode == SM_COST_PACKED16)
+		return topop->cost[sm_cost_packed_index(topop, i, j)];
+	c8 = ((const uint8_t *)topop->cost)[sm_cost_packed_index(topop, i, j)];
+	return (c8 == SM_COST_PACKED8_INFINITY) ? Cost_Infinity : c8;
+}
+
+// sets both directions
+static __inline__ void sm_cost_set(Topology_t *topop, int i, int j, uint16_t cost) {
+	ASSERT(topop->costMode == SM_COST_FULL);
+	topop->cost[(size_t)i * topop->max_sws + j] = cost;
+	topop->cost[(size_t)j * topop->max_sws + i] = cost;
+}
+
 #define	PathToPort(NP,PP)	((NP)->nodeInfo.NodeType == NI_TYPE_SWITCH) ? 	\
 				(NP)->path : (PP)->path
 
@@ -1093,14 +1265,13 @@ void Switch_Enqueue_Type(Topology_t *, Node_t *, int, int);
 	char		nodeDescStr[ND_LEN+1];									\
 																		\
 	local_size = sizeof(Node_t) + (COUNT) * sizeof(Port_t) + 16;	\
-	local_status = vs_pool_alloc(&sm_pool, local_size, (void *)&NODEP);	\
+	local_status = sm_arena_alloc((TOPOP)->arena, local_size, (void *)&NODEP);	\
 	if (local_status == VSTATUS_OK) {									\
-		memset((void *)NODEP, 0, local_size);							\
 		NODEP->nodeInfo = NODEINFO;										\
 		NODEP->nodeDesc = NODEDESC; \
 		memcpy(nodeDescStr, NODEDESC.NodeString, ND_LEN);					\
 		if (strlen(nodeDescStr) == ND_LEN) {							\
-			local_status = vs_pool_alloc(&sm_pool, ND_LEN+1, (void *)&NODEP->nodeDescString);	\
+			local_status = sm_arena_alloc((TOPOP)->arena, ND_LEN+1, (void *)&NODEP->nodeDescString);	\
 			if (local_status != VSTATUS_OK) {							\
                 IB_FATAL_ERROR("Can't allocate space for node's mft"); 	\
 			}															\
@@ -1111,11 +1282,10 @@ void Switch_Enqueue_Type(Topology_t *, Node_t *, int, int);
     			Node_Enqueue_Type(TOPOP, NODEP, ca_head, ca_tail);			\
     		} else if (TYPE == NI_TYPE_SWITCH) {							\
     		  if (sm_mcast_mlid_table_cap) {							\
-                local_status = vs_pool_alloc(&sm_pool, sizeof(STL_PORTMASK*) * sm_mcast_mlid_table_cap, (void*)&NODEP->mft); \
+                local_status = sm_arena_alloc((TOPOP)->arena, sizeof(STL_PORTMASK*) * sm_mcast_mlid_table_cap, (void*)&NODEP->mft); \
                 if (local_status == VSTATUS_OK) { 						\
-                    local_status = vs_pool_alloc(&sm_pool, sizeof(STL_PORTMASK) * sm_mcast_mlid_table_cap * STL_MFTABLE_POSITION_COUNT, (void*)&NODEP->mft[0]); \
+                    local_status = sm_arena_alloc((TOPOP)->arena, sizeof(STL_PORTMASK) * sm_mcast_mlid_table_cap * STL_MFTABLE_POSITION_COUNT, (void*)&NODEP->mft[0]); \
                     if (local_status == VSTATUS_OK) { 					\
-                        memset((void *)NODEP->mft[0], 0, (sizeof(STL_PORTMASK) * sm_mcast_mlid_table_cap * STL_MFTABLE_POSITION_COUNT));	\
                         for (local_i = 1; local_i < sm_mcast_mlid_table_cap; ++local_i) { 	\
                             NODEP->mft[local_i] = NODEP->mft[local_i - 1] + STL_MFTABLE_POSITION_COUNT; 	\
                         } 												\
@@ -1173,24 +1343,11 @@ void Switch_Enqueue_Type(Topology_t *, Node_t *, int, int);
 	} 																	\
 }
 
-#define	Node_Delete(NODEP) {							\
-	Status_t	local_status;						\
-										\
-	if (NODEP->mft) { \
-		local_status = vs_pool_free(&sm_pool, NODEP->mft[0]); \
-		if (local_status != VSTATUS_OK) { \
-			IB_FATAL_ERROR("Failed to free node's mft"); \
-		} \
-		local_status = vs_pool_free(&sm_pool, NODEP->mft); \
-		if (local_status != VSTATUS_OK) { \
-			IB_FATAL_ERROR("Failed to free node's mft pointers"); \
-		} \
-	} \
+// Release what a node holds from sm_pool.  The node, its ports, mft and
+// nodeDescString come from the topology's arena and go with the arena.
+#define	Node_Release(NODEP) {							\
     if (NODEP->lft) { \
-        local_status = vs_pool_free(&sm_pool, NODEP->lft); \
-        if (local_status != VSTATUS_OK) { \
-            IB_FATAL_ERROR("Failed to free node's lft"); \
-        } \
+        sm_lft_release(NODEP); \
     } \
 	if (NODEP->pgt)	{	\
 		vs_pool_free(&sm_pool, NODEP->pgt);		\
@@ -1198,9 +1355,6 @@ void Switch_Enqueue_Type(Topology_t *, Node_t *, int, int);
 	if (NODEP->pgft)	{	\
 		sm_Node_release_pgft(NODEP);		\
 	}\
-	if (NODEP->nodeDescString)	{	\
-		vs_pool_free(&sm_pool, NODEP->nodeDescString);	\
-	}\
 	if (NODEP->portStateInfo) {  \
 		vs_pool_free(&sm_pool, NODEP->portStateInfo); \
 	}\
@@ -1208,23 +1362,11 @@ void Switch_Enqueue_Type(Topology_t *, Node_t *, int, int);
 	bitset_free(&NODEP->initPorts);						\
 	bitset_free(&NODEP->vfMember);						\
 	bitset_free(&NODEP->fullPKeyMember);				\
-    sm_node_free_port(NODEP);   \
-	sm_node_release_changes((NODEP));   \
-	local_status = vs_pool_free(&sm_pool, (void *)NODEP);			\
-	if (local_status != VSTATUS_OK) {					\
-		IB_FATAL_ERROR("can't free space");				\
-	}									\
+    sm_node_release_ports(NODEP);   \
 }
 
+// quarantinedNode is in the topology's arena and goes with the arena
 #define	Node_Quarantined_Delete(NODEP) {							        \
-    if (NODEP->quarantinedNode)	{	                                        \
-    	if (NODEP->quarantinedNode->nodeDescString)	{	                    \
-    		vs_pool_free(&sm_pool, NODEP->quarantinedNode->nodeDescString);	\
-    	}                                                                   \
-    	if (vs_pool_free(&sm_pool, (void *)NODEP->quarantinedNode)) {       \
-    		IB_FATAL_ERROR("can't free space");                             \
-    	}                                                                   \
-	}                                                                       \
     if (vs_pool_free(&sm_pool, (void *)NODEP)) {                            \
         IB_FATAL_ERROR("can't free space");                                 \
     }                                                                       \
@@ -1386,7 +1528,11 @@ static __inline__ Lid_t sm_port_top_lid(Port_t * portp) {
 	}									\
 }
 
-#define	McGroup_Create(GROUPP) { 						\
+//
+//	The MGID and PortGID are the hash keys of the group and member indexes,
+//	so they are set on creation and must not be changed afterwards.
+//
+#define	McGroup_Create(GROUPP,MGID) { 						\
 	size_t		local_size;						\
 	Status_t	local_status;						\
 										\
@@ -1400,7 +1546,9 @@ static __inline__ Lid_t sm_port_top_lid(Port_t * portp) {
 	if (!bitset_init(&sm_pool, &GROUPP->vfMembers, MAX_VFABRICS)) { \
 		IB_FATAL_ERROR("McGroup_Create: can't allocate space");				\
 	}									\
+	memcpy(&GROUPP->mGid, &(MGID), sizeof(IB_GID));				\
 	McGroup_Enqueue(GROUPP);						\
+	sm_multicast_index_group(GROUPP);					\
 	++sm_numMcGroups; \
 }
 
@@ -1410,6 +1558,7 @@ static __inline__ Lid_t sm_port_top_lid(Port_t * portp) {
 	--sm_numMcGroups;					\
 										\
 	sm_multicast_decommision_group(GROUPP); \
+	sm_multicast_unindex_group(GROUPP);				\
 	McGroup_Dequeue(GROUPP);						\
 	bitset_free(&GROUPP->vfMembers); \
 	local_status = vs_pool_free(&sm_pool, (void *)GROUPP);			\
@@ -1443,7 +1592,7 @@ static __inline__ Lid_t sm_port_top_lid(Port_t * portp) {
 	}									\
 }
 
-#define	McMember_Create(GROUPP,MEMBERP) { 					\
+#define	McMember_Create(GROUPP,MEMBERP,PORTGID) { 					\
 	size_t		local_size;						\
 	Status_t	local_status;						\
 										\
@@ -1454,13 +1603,16 @@ static __inline__ Lid_t sm_port_top_lid(Port_t * portp) {
 	}									\
 										\
 	memset((void *)MEMBERP, 0, local_size);					\
+	memcpy(&MEMBERP->record.RID.PortGID, &(PORTGID), sizeof(IB_GID));	\
 	MEMBERP->index = ++GROUPP->index_pool;				 \
 	McMember_Enqueue(GROUPP, MEMBERP);					\
+	sm_multicast_index_member(GROUPP, MEMBERP);				\
 }
 
 #define	McMember_Delete(GROUPP,MEMBERP) {					\
 	Status_t	local_status;						\
 										\
+	sm_multicast_unindex_member(GROUPP, MEMBERP);				\
 	McMember_Dequeue(GROUPP, MEMBERP);					\
 	local_status = vs_pool_free(&sm_pool, (void *)MEMBERP);			\
 	if (local_status != VSTATUS_OK) {					\
@@ -2005,6 +2157,7 @@ extern uint64_t sm_mcSpanningTreeRootGuid;
 //	Prototypes.
 //
 const char *sm_getStateText (uint32_t state);
+char *sm_getAttributeIdText(uint32_t aid);
 Status_t	sa_Get_PKeys(Lid_t, uint16_t *, uint32_t *);
 Status_t	sa_Compare_PKeys(STL_PKEY_ELEMENT *, STL_PKEY_ELEMENT *);
 Status_t	sa_Compare_Node_PKeys(Node_t *, Node_t *);
@@ -2159,6 +2312,8 @@ Status_t    sm_bounce_all_switch_ports(Topology_t *topop, Node_t *nodep, Port_t
 Status_t	sm_get_CapabilityMask(IBhandle_t, uint8_t, uint32_t *);
 Status_t	sm_set_CapabilityMask(IBhandle_t, uint8_t, uint32_t);
 Status_t	sm_process_notice(Notice_t *);
+void		*sm_hmap_alloc(size_t, void *);
+void		sm_hmap_free(void *, void *);
 Node_t		*sm_find_guid(Topology_t *, uint64_t);
 Node_t      *sm_find_quarantined_guid(Topology_t *topop, uint64_t guid);
 Node_t		*sm_find_next_guid(Topology_t *, uint64_t);
@@ -2210,7 +2365,9 @@ Status_t    sm_enable_port_led(Node_t *nodep, Port_t *portp, boolean enabled);
 Status_t sm_routing_alloc_floyds(Topology_t *topop);
 void     sm_routing_init_floyds(Topology_t *tp);
 void     sm_routing_calc_floyds(int switches, unsigned short *cost);
+Status_t sm_routing_update_floyds(Topology_t *src_topop, Topology_t *dst_topop);
 Status_t sm_routing_copy_floyds(Topology_t *src_topop, Topology_t *dst_topop);
+void     sm_routing_pack_floyds(Topology_t *topop);
 Status_t sm_routing_copy_lfts(Topology_t *oldtp, Topology_t *newtp);
 Status_t sm_routing_prep_new_switch(Topology_t *topop, Node_t *nodep, int, uint8_t *path);
 Status_t sm_routing_route_switch_LR(Topology_t *topop, SwitchList_t *swlist, int rebalance);
@@ -2219,12 +2376,42 @@ Status_t sm_routing_route_old_switch(Topology_t *src_topop, Topology_t *dst_topo
 int      sm_balance_base_lids(SwitchportToNextGuid_t *ordered_ports, int olen);
 Status_t sm_routing_init(Topology_t * topop);
 
+//
+// sm_parallel.c prototypes
+//
+
+#define SM_PARALLEL_MAX_THREADS	16
+
+// Work function run by the SM worker pool, once per item in [0, items).
+// worker is the index of the running thread, in [0, sm_parallel_threads()),
+// for callers that keep per-thread scratch space.
+typedef void (*sm_parallel_work_t)(void *context, uint32_t item, uint32_t worker);
+
+Status_t sm_parallel_init(uint32_t threads);
+void     sm_parallel_destroy(void);
+uint32_t sm_parallel_threads(void);
+Status_t sm_parallel_run(uint32_t items, sm_parallel_work_t work, void *context);
+
+//
+// sm_arena.c prototypes
+//
+
+Status_t   sm_arena_create(SmArena_t **arenap);
+void       sm_arena_destroy(SmArena_t *arena);
+Status_t   sm_arena_alloc(SmArena_t *arena, size_t length, void **loc);
+Status_t   sm_arena_free(void *p);
+SmArena_t *sm_arena_owner(void *p);
+void       sm_arena_get_stats(SmArena_t *arena, SmArenaStats_t *stats);
+uint32_t   sm_arena_peak_rss_kb(void);
+
 //
 // sm_shortestpath.c prototypes
 //
 
 Status_t sm_shortestpath_init(Topology_t *);
 Status_t sm_shortestpath_make_routing_module(RoutingModule_t *rm);
+Status_t sm_shortestpath_calculate_all_lfts_parallel(Topology_t *topop,
+			LftDest_t *dests, uint32_t numDests, int edgeFirst);
 
 //
 // sm_dgmh.c prototypes
@@ -2244,6 +2431,25 @@ Status_t sm_dispatch_wait(sm_dispatch_t *disp);
 Status_t sm_dispatch_clear(sm_dispatch_t *disp);
 Status_t sm_dispatch_update(sm_dispatch_t *disp);
 void sm_dispatch_bump_passcount(sm_dispatch_t *disp);
+void sm_dispatch_init_node(Node_t *nodep, Node_t *oldnodep);
+
+//
+// sm_discovery.c prototypes
+//
+
+Status_t	sm_discovery_prefetch_level(Topology_t *topop, Node_t *firstp);
+Status_t	sm_discovery_get_nodeinfo(Node_t *cnp, Port_t *cpp, uint8_t *path, STL_NODE_INFO *nip);
+Status_t	sm_discovery_get_nodedesc(Node_t *cnp, Port_t *cpp, uint8_t *path, STL_NODE_DESCRIPTION *ndp);
+void		sm_discovery_prefetch_done(void);
+extern int	sm_light_sweep;
+void		sm_light_sweep_init(void);
+void		sm_light_sweep_note_trap(Lid_t lid);
+void		sm_light_sweep_force_full(void);
+void		sm_light_sweep_begin(int trapOnly);
+void		sm_light_sweep_end(int valid);
+int			sm_light_sweep_trusted(Node_t *nodep, Node_t *oldnodep);
+void		sm_light_sweep_inconsistent(Node_t *nodep, Port_t *portp);
+int			sm_light_sweep_is_failed(void);
 
 //
 // sm_partMgr.c prototypes
@@ -2421,6 +2627,12 @@ McGroup_t	*sm_find_next_multicast_gid(IB_GID);
 McMember_t	*sm_find_multicast_member(McGroup_t *, IB_GID);
 McMember_t	*sm_find_multicast_member_by_index(McGroup_t *mcGroup, uint32_t index);
 McMember_t	*sm_find_next_multicast_member_by_index(McGroup_t *mcGroup, uint32_t index);
+void		sm_multicast_index_group(McGroup_t *mcGroup);
+void		sm_multicast_unindex_group(McGroup_t *mcGroup);
+void		sm_multicast_clear_group_index(void);
+void		sm_multicast_index_member(McGroup_t *mcGroup, McMember_t *mcMember);
+void		sm_multicast_unindex_member(McGroup_t *mcGroup, McMember_t *mcMember);
+void		sm_multicast_set_member_index(McGroup_t *mcGroup, McMember_t *mcMember, uint32_t index);
 
 void		topology_main(uint32_t, uint8_t **);
 Status_t	topology_userexit(void);
@@ -2544,6 +2756,10 @@ uint32_t	idbGetDisableCommonMcastMtuAndRate(void);
 Port_t *    sm_get_port(const Node_t *nodep, uint32_t portIndex);
 #else
 Status_t	sm_dump_state(const char * dumpDir);
+Status_t	sm_snapshot_save(Topology_t *topop);
+Status_t	sm_snapshot_restore(Topology_t *topop);
+void		sm_snapshot_match_mfts(Topology_t *topop);
+void		sm_snapshot_invalidate(void);
 #endif
 
 
@@ -2621,7 +2837,7 @@ void        smPauseResumeSweeps(boolean);
 void		smProcessReconfigureRequest(void);
 PortData_t *sm_alloc_port(Topology_t *topop, Node_t *nodep, uint32_t portIndex, int *bytes);
 void        sm_free_port(Port_t * portp);
-void        sm_node_free_port(Node_t *nodep);
+void        sm_node_release_ports(Node_t *nodep);
 Status_t    sm_build_node_array(Topology_t *topop);
 Status_t    sm_clearIsSM(void);
 void        sm_clean_vfdg_memory(void);
@@ -0,0 +1,34 @@
+include Makefile
+include build.ALL_EMB.release/sa_main.c.dep
+include build.ALL_EMB.release/sa_utility.c.dep
+include build.ALL_EMB.release/sa_db.c.dep
+include build.ALL_EMB.release/sa_userexits.c.dep
+include build.ALL_EMB.release/sa_ClassPortInfo.c.dep
+include build.ALL_EMB.release/sa_InformInfo.c.dep
+include build.ALL_EMB.release/sa_InformRecord.c.dep
+include build.ALL_EMB.release/sa_LFTableRecord.c.dep
+include build.ALL_EMB.release/sa_LinkRecord.c.dep
+include build.ALL_EMB.release/sa_McMemberRecord.c.dep
+include build.ALL_EMB.release/sa_MFTableRecord.c.dep
+include build.ALL_EMB.release/sa_MultiPathRecord.c.dep
+include build.ALL_EMB.release/sa_NodeRecord.c.dep
+include build.ALL_EMB.release/sa_PartitionRecord.c.dep
+include build.ALL_EMB.release/sa_PathRecord.c.dep
+include build.ALL_EMB.release/sa_PortInfoRecord.c.dep
+include build.ALL_EMB.release/sa_SLSCTableRecord.c.dep
+include build.ALL_EMB.release/sa_SMInfoRecord.c.dep
+include build.ALL_EMB.release/sa_ServiceRecord.c.dep
+include build.ALL_EMB.release/sa_SwitchInfoRecord.c.dep
+include build.ALL_EMB.release/sa_VLArbitrationRecord.c.dep
+include build.ALL_EMB.release/sa_Trap.c.dep
+include build.ALL_EMB.release/sa_TraceRecord.c.dep
+include build.ALL_EMB.release/sa_VFabricRecord.c.dep
+include build.ALL_EMB.release/sa_FabricInfoRecord.c.dep
+include build.ALL_EMB.release/sa_QuarantinedNodeRecord.c.dep
+include build.ALL_EMB.release/sa_BufferControlTableRecord.c.dep
+include build.ALL_EMB.release/sa_CongestionRecords.c.dep
+include build.ALL_EMB.release/sa_CableInfoRecord.c.dep
+include build.ALL_EMB.release/sa_PortGroupRecord.c.dep
+include build.ALL_EMB.release/sa_SCSLTableRecord.c.dep
+include build.ALL_EMB.release/sa_SCVLTableRecord.c.dep
+include build.ALL_EMB.release/sa_SCSCTableRecord.c.dep
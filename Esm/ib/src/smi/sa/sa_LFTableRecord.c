@@ -152,7 +152,7 @@ sa_LFTableRecord_Set(uint8_t *lftp, Node_t *nodep, Port_t *portp, uint16_t index
 	length = MIN(nodep->switchInfo.LinearFDBTop-MAX_LFT_ELEMENTS_BLOCK*index+1,
 		MAX_LFT_ELEMENTS_BLOCK);
 
-	memcpy((void *)lftRecord.LinearFdbData, (void *)&nodep->lft[MAX_LFT_ELEMENTS_BLOCK*index], length);
+	memcpy((void *)lftRecord.LinearFdbData, (void *)sm_lft_block(nodep, index), length);
 
 	if (length<MAX_LFT_ELEMENTS_BLOCK) {
 		memset((void*)&lftRecord.LinearFdbData[length], 0xff,
@@ -826,9 +826,8 @@ sa_McMemberRecord_Set(Mai_t *maip, uint32_t *records) {
 
 		mcmp->MLID = mLid;
 
-		McGroup_Create(mcGroup);
+		McGroup_Create(mcGroup, mcmp->RID.MGID);
 		createdGroup = 1;
-		memcpy(&(mcGroup->mGid), &mcmp->RID.MGID, 16);
 		mcGroup->mLid = mcmp->MLID;
 		mcGroup->qKey = mcmp->Q_Key;
 		mcGroup->pKey = mcmp->P_Key;
@@ -842,7 +841,7 @@ sa_McMemberRecord_Set(Mai_t *maip, uint32_t *records) {
 		bitset_copy(&mcGroup->vfMembers, &mcGroupVf);
 		mcGroup->members_full++;
 
-		McMember_Create(mcGroup, mcMember);
+		McMember_Create(mcGroup, mcMember, mcmp->RID.PortGID);
 		mcMember->record = *mcmp;
 		mcMember->portGuid = guid;
 		mcMember->slid = maip->addrInfo.slid;
@@ -951,9 +950,8 @@ sa_McMemberRecord_Set(Mai_t *maip, uint32_t *records) {
 
 			mcmp->MLID = mLid;
 
-			McGroup_Create(mcGroup);
+			McGroup_Create(mcGroup, mcmp->RID.MGID);
 			createdGroup = 1;
-			memcpy(&(mcGroup->mGid), &mcmp->RID.MGID, 16);
 			mcGroup->mLid = mcmp->MLID;
 			mcGroup->qKey = mcmp->Q_Key;
 			mcGroup->pKey = mcmp->P_Key;
@@ -967,7 +965,7 @@ sa_McMemberRecord_Set(Mai_t *maip, uint32_t *records) {
 			bitset_copy(&mcGroup->vfMembers, &mcGroupVf);
 			mcGroup->members_full++;
 
-			McMember_Create(mcGroup, mcMember);
+			McMember_Create(mcGroup, mcMember, mcmp->RID.PortGID);
 			mcMember->record = *mcmp;
 			mcMember->portGuid = guid;
 			mcMember->slid = maip->addrInfo.slid;
@@ -1145,7 +1143,7 @@ sa_McMemberRecord_Set(Mai_t *maip, uint32_t *records) {
 			mcmp->HopLimit = mcGroup->hopLimit;
 
 			if (!(mcMember = sm_find_multicast_member(mcGroup, mcmp->RID.PortGID))) {
-				McMember_Create(mcGroup, mcMember);
+				McMember_Create(mcGroup, mcMember, mcmp->RID.PortGID);
 				if (mcmp->JoinFullMember) {
 					mcGroup->members_full++;
 				}
@@ -2064,6 +2062,7 @@ Status_t createBroadcastGroup(uint16_t pkey, uint8_t mtu, uint8_t rate, uint8_t
 	STL_MCMEMBER_RECORD		*mcmp;
 	uint32_t  			mLid;
 	IB_GID	  			mGid;
+	IB_GID				portGid;
 	//uint16_t            netPKey;
 
     if (!pkey) {
@@ -2098,11 +2097,11 @@ Status_t createBroadcastGroup(uint16_t pkey, uint8_t mtu, uint8_t rate, uint8_t
 		goto done;
 	}
 
-	McGroup_Create(mcGroup);
+	McGroup_Create(mcGroup, mGid);
 
-	McMember_Create(mcGroup, mcMember);
+	memset(&portGid, 0, sizeof(portGid));
+	McMember_Create(mcGroup, mcMember, portGid);
 
-	memcpy(&(mcGroup->mGid), &mGid, sizeof(mGid));
 	mcGroup->mLid         = mLid;
 	mcGroup->qKey         = qkey;
 	mcGroup->pKey         = pkey;
@@ -2214,6 +2213,7 @@ Status_t clearBroadcastGroups(int recreateGroup) {
         }
         /* clear group globals */
         sm_McGroups = 0;
+        sm_multicast_clear_group_index();
         sm_numMcGroups = 0;
         vs_unlock(&sm_McGroups_lock);
     }
@@ -2370,6 +2370,7 @@ Status_t createMCastGroup(uint64_t* mgid, uint16_t pkey, uint8_t mtu, uint8_t ra
 	STL_MCMEMBER_RECORD	*mcmp;
 	Lid_t  			    mLid;
 	IB_GID				mGid;
+	IB_GID				portGid;
 	int vf = 0;
 	VirtualFabrics_t *VirtualFabrics = old_topology.vfs_ptr;
 
@@ -2413,9 +2414,10 @@ Status_t createMCastGroup(uint64_t* mgid, uint16_t pkey, uint8_t mtu, uint8_t ra
 		goto done;
 	}
 
-	McGroup_Create(mcGroup);
+	McGroup_Create(mcGroup, mGid);
 
-	McMember_Create(mcGroup, mcMember);
+	memset(&portGid, 0, sizeof(portGid));
+	McMember_Create(mcGroup, mcMember, portGid);
 
 	if (VirtualFabrics) {
 		for (vf=0; vf < VirtualFabrics->number_of_vfs; vf++) {
@@ -2426,8 +2428,6 @@ Status_t createMCastGroup(uint64_t* mgid, uint16_t pkey, uint8_t mtu, uint8_t ra
 		}
 	}
 
-	memcpy(&(mcGroup->mGid), &mGid, sizeof(mGid));
-
 	mcGroup->mLid         = mLid;
 	mcGroup->qKey         = qkey;
 	mcGroup->pKey         = pkey;
@@ -69,8 +69,6 @@ extern		Pool_t		sm_pool;
 Status_t	sa_PathRecord_Set(uint32_t*, uint32_t, Port_t*, uint32_t, Port_t*, uint32_t, PKey_t, uint64_t, uint8_t, uint8_t);
 extern 		IB_GID nullGid;
 
-static uint8_t serviceIdCheck;
-
 Status_t
 sa_MultiPathRecord(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
 	uint32_t		bytes=0;
@@ -88,6 +86,7 @@ sa_MultiPathRecord(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
 	Port_t*			reqPortp;
 	Node_t*			reqNodep;
 	uint64_t		serviceId=0;
+	uint8_t			serviceIdCheck;
 	uint8_t			sl=0xff;
 	IB_GID			*sGidList = NULL;
 	IB_GID			*dGidList = NULL;
@@ -67,17 +67,223 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 Status_t	sa_PathRecord_Set(uint32_t*, uint32_t, Port_t*, uint32_t, Port_t*, uint32_t, PKey_t, uint64_t, uint8_t, uint8_t);
 void        sa_GroupPathRecord_Set(Port_t *src_portp, McGroup_t *group);
-Status_t	sa_PathRecord_Wildcard(Port_t *, uint32_t, uint32_t *, PKey_t, uint8_t, Node_t*, uint64_t, uint8_t);
+Status_t	sa_PathRecord_Wildcard(Port_t *, uint32_t, uint32_t *, PKey_t, uint8_t, Node_t*, uint64_t, uint8_t, uint8_t);
 Status_t	sa_PathRecord_Interop(IB_PATH_RECORD *, uint64_t);
 IB_GID		nullGid={.Raw={0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}};
 
 /************ support for dynamic update of switch config parms *************/
 extern uint8_t sa_dynamicPlt[];
 
-static uint16_t srcLids[128];
-static uint16_t dstLids[128];
+//
+//	PathRecord cache.
+//
+//	Point to point queries are answered from a cache of the wire format
+//	records built by sa_PathRecord_Set().  The result only depends on the
+//	query parameters and old_topology, so the cache is filled lazily and
+//	emptied whenever old_topology is replaced.  When the cache is full it is
+//	emptied and starts over.
+//
+typedef struct _SaPathCacheEntry {
+	struct _SaPathCacheEntry *next;
+	uint64_t	srcGuid;
+	uint64_t	dstGuid;
+	uint64_t	serviceId;
+	uint32_t	slid;				// requested lids, PERMISSIVE_LID if wildcarded
+	uint32_t	dlid;
+	PKey_t		pkey;
+	uint8_t		sl;
+	uint8_t		serviceIdCheck;
+	uint8_t		numPath;
+	uint32_t	records;
+	IB_PATH_RECORD	data[1];	// records entries, network byte order
+} SaPathCacheEntry_t;
+
+typedef struct {
+	Lock_t				lock;
+	uint32_t			maxEntries;		// 0 if the cache is disabled
+	uint32_t			entries;
+	uint32_t			mask;			// bucket count - 1
+	SaPathCacheEntry_t	**buckets;
+} SaPathCache_t;
+
+static SaPathCache_t saPathCache;
+
+static __inline__ uint32_t
+sa_PathRecord_CacheHash(const SaPathCacheEntry_t *key)
+{
+	uint64_t h;
+
+	h = key->srcGuid ^ (key->dstGuid * 0x9E3779B97F4A7C15ull);
+	h ^= ((uint64_t)key->slid << 32) | key->dlid;
+	h ^= key->serviceId;
+	h ^= ((uint64_t)key->pkey << 24) | ((uint64_t)key->sl << 16) | key->numPath;
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDull;
+	h ^= h >> 33;
+	return (uint32_t)h & saPathCache.mask;
+}
+
+static __inline__ int
+sa_PathRecord_CacheMatch(const SaPathCacheEntry_t *a, const SaPathCacheEntry_t *b)
+{
+	return a->srcGuid == b->srcGuid && a->dstGuid == b->dstGuid
+		&& a->slid == b->slid && a->dlid == b->dlid
+		&& a->pkey == b->pkey && a->sl == b->sl && a->numPath == b->numPath
+		&& a->serviceIdCheck == b->serviceIdCheck && a->serviceId == b->serviceId;
+}
+
+// Caller must hold saPathCache.lock.
+static void
+sa_PathRecord_CacheFlush(void)
+{
+	SaPathCacheEntry_t *entry, *next;
+	uint32_t i;
+
+	if (saPathCache.buckets == NULL)
+		return;
+
+	for (i = 0; i <= saPathCache.mask; i++) {
+		for (entry = saPathCache.buckets[i]; entry != NULL; entry = next) {
+			next = entry->next;
+			(void)vs_pool_free(&sm_pool, entry);
+		}
+		saPathCache.buckets[i] = NULL;
+	}
+	saPathCache.entries = 0;
+}
+
+Status_t
+sa_PathRecord_CacheInit(uint32_t maxEntries)
+{
+	Status_t	status;
+	uint32_t	buckets;
+
+	IB_ENTER(__func__, maxEntries, 0, 0, 0);
+
+	memset(&saPathCache, 0, sizeof(saPathCache));
+
+	status = vs_lock_init(&saPathCache.lock, VLOCK_FREE, VLOCK_THREAD);
+	if (status != VSTATUS_OK) {
+		IB_LOG_ERRORRC("can't initialize PathRecord cache lock rc:", status);
+		IB_EXIT(__func__, status);
+		return status;
+	}
+
+	if (maxEntries == 0) {
+		IB_EXIT(__func__, VSTATUS_OK);
+		return VSTATUS_OK;
+	}
+
+	// about two entries per bucket when full
+	for (buckets = 64; buckets < maxEntries / 2; buckets <<= 1)
+		;
+
+	status = vs_pool_alloc(&sm_pool, buckets * sizeof(SaPathCacheEntry_t *), (void *)&saPathCache.buckets);
+	if (status != VSTATUS_OK) {
+		IB_LOG_WARNRC("can't allocate PathRecord cache, caching disabled rc:", status);
+		IB_EXIT(__func__, VSTATUS_OK);
+		return VSTATUS_OK;
+	}
+	memset(saPathCache.buckets, 0, buckets * sizeof(SaPathCacheEntry_t *));
+	saPathCache.mask = buckets - 1;
+	saPathCache.maxEntries = maxEntries;
+
+	IB_EXIT(__func__, VSTATUS_OK);
+	return VSTATUS_OK;
+}
+
+void
+sa_PathRecord_CacheInvalidate(void)
+{
+	if (saPathCache.maxEntries == 0)
+		return;
+
+	(void)vs_lock(&saPathCache.lock);
+	sa_PathRecord_CacheFlush();
+	(void)vs_unlock(&saPathCache.lock);
+}
+
+void
+sa_PathRecord_CacheDelete(void)
+{
+	if (saPathCache.buckets != NULL) {
+		(void)vs_lock(&saPathCache.lock);
+		sa_PathRecord_CacheFlush();
+		(void)vs_pool_free(&sm_pool, saPathCache.buckets);
+		saPathCache.buckets = NULL;
+		saPathCache.maxEntries = 0;
+		(void)vs_unlock(&saPathCache.lock);
+	}
+	(void)vs_lock_delete(&saPathCache.lock);
+}
+
+//
+//	sa_PathRecord_Set() for a single source and destination, answered from
+//	the cache when possible.  *records must be zero on entry.
+//
+static Status_t
+sa_PathRecord_SetCached(uint32_t* records, uint32_t numPath, Port_t *src_portp, uint32_t slid,
+				Port_t *dst_portp, uint32_t dlid, PKey_t pkey,
+				uint64_t serviceId, uint8_t serviceIdChk, uint8_t sl) {
+	SaPathCacheEntry_t	key, *entry;
+	uint32_t			hash;
+	Status_t			status;
 
-static uint8_t serviceIdCheck;
+	if (saPathCache.maxEntries == 0) {
+		return sa_PathRecord_Set(records, numPath, src_portp, slid, dst_portp, dlid,
+								 pkey, serviceId, serviceIdChk, sl);
+	}
+
+	key.srcGuid = src_portp->portData->guid;
+	key.dstGuid = dst_portp->portData->guid;
+	key.serviceId = serviceId;
+	key.slid = slid;
+	key.dlid = dlid;
+	key.pkey = pkey;
+	key.sl = sl;
+	key.serviceIdCheck = serviceIdChk;
+	key.numPath = (uint8_t)numPath;
+	hash = sa_PathRecord_CacheHash(&key);
+
+	(void)vs_lock(&saPathCache.lock);
+	for (entry = saPathCache.buckets[hash]; entry != NULL; entry = entry->next) {
+		if (sa_PathRecord_CacheMatch(entry, &key)) {
+			memcpy(sa_data, entry->data, entry->records * sizeof(IB_PATH_RECORD));
+			*records = entry->records;
+			(void)vs_unlock(&saPathCache.lock);
+			INCREMENT_COUNTER(smCounterSaPathRecordCacheHits);
+			return VSTATUS_OK;
+		}
+	}
+	(void)vs_unlock(&saPathCache.lock);
+
+	INCREMENT_COUNTER(smCounterSaPathRecordCacheMisses);
+
+	status = sa_PathRecord_Set(records, numPath, src_portp, slid, dst_portp, dlid,
+							   pkey, serviceId, serviceIdChk, sl);
+	// failures are not cached so they are logged again on the next query
+	if (status != VSTATUS_OK || *records == 0)
+		return status;
+
+	if (vs_pool_alloc(&sm_pool, sizeof(SaPathCacheEntry_t) + (*records - 1) * sizeof(IB_PATH_RECORD),
+					  (void *)&entry) != VSTATUS_OK)
+		return status;
+
+	*entry = key;
+	entry->records = *records;
+	memcpy(entry->data, sa_data, *records * sizeof(IB_PATH_RECORD));
+
+	(void)vs_lock(&saPathCache.lock);
+	if (saPathCache.entries >= saPathCache.maxEntries)
+		sa_PathRecord_CacheFlush();
+	entry->next = saPathCache.buckets[hash];
+	saPathCache.buckets[hash] = entry;
+	saPathCache.entries++;
+	SET_PEAK_COUNTER(smMaxSaPathRecordCacheEntries, saPathCache.entries);
+	(void)vs_unlock(&saPathCache.lock);
+
+	return status;
+}
 
 Status_t
 sa_PathRecord(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
@@ -96,6 +302,7 @@ sa_PathRecord(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
 	Port_t*		reqPortp;
 	Node_t*		reqNodep;
 	uint64_t	serviceId=0;
+	uint8_t		serviceIdCheck;
 	uint8_t		sl=0xff;
 
 	// init to permissive lid to represent wildcarded lid
@@ -326,7 +533,7 @@ sa_PathRecord(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
 //	Check for Bus-walk operation.
 //
 	if ((samad.SaHdr.ComponentMask & PR_COMPONENTMASK_NO_DST) == 0) {
-		if (sa_PathRecord_Wildcard(src_portp, slid, &records, pkey, prp->NumbPath, reqNodep, serviceId, sl) != VSTATUS_OK) {
+		if (sa_PathRecord_Wildcard(src_portp, slid, &records, pkey, prp->NumbPath, reqNodep, serviceId, serviceIdCheck, sl) != VSTATUS_OK) {
             maip->base.status = MAD_STATUS_SA_NO_RESOURCES;
 		}
 		goto reply_PathRecord;
@@ -442,7 +649,7 @@ sa_PathRecord(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
 			goto reply_PathRecord;
         }
 
-		(void)sa_PathRecord_Set(&records, prp->NumbPath, src_portp, slid, dst_portp, dlid,
+		(void)sa_PathRecord_SetCached(&records, prp->NumbPath, src_portp, slid, dst_portp, dlid,
 							pkey, serviceId, serviceIdCheck, sl);
 
 		if (saDebugRmpp && (records == 0)) {
@@ -502,7 +709,7 @@ reply_PathRecord:
 
 Status_t
 sa_PathRecord_Wildcard(Port_t *src_portp, uint32_t slid, uint32_t *records, PKey_t pkey, uint8_t numPath,
-						Node_t *reqNodep, uint64_t serviceId, uint8_t sl) {
+						Node_t *reqNodep, uint64_t serviceId, uint8_t serviceIdCheck, uint8_t sl) {
 	Node_t		*dst_nodep;
 	Port_t		*dst_portp;
 	uint32_t	pathCount;
@@ -677,6 +884,8 @@ sa_PathRecord_Set(uint32_t* records, uint32_t numPath, Port_t *src_portp, uint32
 	uint16_t		updnSlid, updnDlid;
 #endif
 	uint8_t			srcLidLen, dstLidLen;
+	uint16_t		srcLids[128];
+	uint16_t		dstLids[128];
 	bitset_t		vfs;
 	Status_t		status=VSTATUS_OK;
 
@@ -803,7 +1012,7 @@ sa_PathRecord_Set(uint32_t* records, uint32_t numPath, Port_t *src_portp, uint32
 				status = VSTATUS_BAD;
 				goto done_PathRecordSet;
 			}
-			portno = next_nodep->lft[last_portp->portData->lid];
+			portno = sm_lft_port(next_nodep, last_portp->portData->lid);
 			if (portno == 255) {
 				/* PR#101984 - no path from this node for given Lid */
 				IB_LOG_WARN_FMT("sa_PathRecord_Set",
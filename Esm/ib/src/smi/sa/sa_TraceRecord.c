@@ -582,7 +582,7 @@ sa_TraceRecord_Set(uint8_t ** cpp, STL_SA_MAD * samad, Port_t * src_portp, uint3
 				return (VSTATUS_BAD);
 			}
 			next_portp = sm_get_port(next_nodep, 0);
-			entry_portno = next_nodep->lft[slid];
+			entry_portno = sm_lft_port(next_nodep, slid);
 		}
 
 
@@ -604,7 +604,7 @@ sa_TraceRecord_Set(uint8_t ** cpp, STL_SA_MAD * samad, Port_t * src_portp, uint3
 			}
 
 			/* Get the port number of exit port from node forwarding table. */
-			exit_portno = next_nodep->lft[dlid];
+			exit_portno = sm_lft_port(next_nodep, dlid);
 
 			if (exit_portno == 255) {
 				/* PR#101984 - no path from this node for given Lid */
@@ -121,6 +121,7 @@ void sm_discovery_needed(const char* reason, int lid)
 		}
 	}
 	smFabricDiscoveryNeeded = 1;
+	sm_light_sweep_note_trap(lid);
 
 	// Only Trap's call this function.
 	setResweepReason(SM_SWEEP_REASON_TRAP_EVENT);
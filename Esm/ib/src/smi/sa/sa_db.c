@@ -64,7 +64,6 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "sm_l.h"
 #include "sa_l.h"
 
-extern uint8_t		*sa_data;
 extern uint32_t		sa_data_length;
 
 
@@ -101,8 +100,10 @@ sa_template_test(uint8_t *src, uint8_t ** dstp, uint32_t length, uint32_t bytes,
 Status_t
 sa_template_test_noinc(uint8_t *src, uint8_t * dst, uint32_t length) {
 	int i;
+	uint8_t *mask = template_mask;
+
 	for (i = 0; i < (int)length; i++) {
-		if (((src[i] ^ dst[i]) & template_mask[i]) != 0) {
+		if (((src[i] ^ dst[i]) & mask[i]) != 0) {
 			return(VSTATUS_BAD);
 		}
 	}
@@ -157,7 +158,7 @@ sa_create_template_mask(uint16_t type, uint64_t componentMask) {
 
 //
 //	The template global variables have been set by a previous call.  So
-//	we can use them here.  (This assumes that SA remains single threaded.)
+//	we can use them here.  (They are per-thread, see sa_thread_state().)
 //
 	if (template_fieldp == NULL) {
 		IB_EXIT("sa_create_template_mask", VSTATUS_OK);
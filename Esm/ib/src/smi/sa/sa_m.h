@@ -44,15 +44,6 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //									
 //===========================================================================//
 
-//
-//	Scratch pad for template queries.  They must be used sequentially.
-//
-uint8_t		template_mask[4096];
-uint16_t	template_type;
-uint32_t	template_offset;
-uint32_t	template_length;
-FieldMask_t	*template_fieldp;
-
 FieldMask_t 	StlNodeRecordFieldMask[] = {
 	{     0,    32 },	// RID.LID
 	{    32,    32 },	// Reserved
@@ -62,6 +62,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "sm_l.h"
 #include "sm_counters.h"
 #include "sa_l.h"
+#ifndef __VXWORKS__
+#include <pthread.h>
+#endif
 
 //===========================================================================//
 extern	uint32_t	sm_port;
@@ -72,7 +75,6 @@ extern 	uint8_t		nullData[];
 extern  uint64_t	topology_wakeup_time;
 uint32_t            sa_mft_reprog=0;
 
-uint8_t				*sa_data;
 uint32_t			sa_data_length;
 uint32_t			sa_max_path_records;
 uint32_t            saDebugRmpp=0;  // control SA RMPP INFO debug messages; default off in ESM
@@ -102,6 +104,46 @@ static  int	sa_cntxt_nalloc = 0 ;
 static 	int	sa_cntxt_nfree = 0 ;
 static  int sa_main_reader_exit = 0;
 static  int sa_main_writer_exit = 0;
+static  ATOMIC_UINT sa_context_busy_count;
+
+//
+//	Per-thread request state.  The reader's state is also used by any thread
+//	which is not an SA worker (writer, topology, ...), as sa_data was before.
+//
+static  SaThreadState_t	sa_reader_state;
+#ifndef __VXWORKS__
+static  pthread_key_t	sa_thread_key;
+static  int				sa_thread_key_valid = 0;
+#endif
+
+//
+//	SA worker pool.  When configured, the reader hands query requests to a
+//	fixed set of worker threads.  All requests from a given LID go to the
+//	same worker in arrival order, so duplicate detection, GetMulti segment
+//	reassembly and the first RMPP window behave exactly as they do on the
+//	reader.  Requests which modify SA state stay on the reader.
+//
+#define SA_WORKER_MAX_THREADS	16
+#define SA_WORKER_QUEUE_DEPTH	64
+
+typedef struct {
+	Thread_t		handle;
+	Lock_t			lock;			// protects head and count
+	Sema_t			sema;			// one count per queued request
+	Mai_t			*queue;			// SA_WORKER_QUEUE_DEPTH requests
+	uint32_t		head;
+	uint32_t		count;
+	SaThreadState_t	state;
+} SaWorker_t;
+
+typedef struct {
+	uint32_t		threads;
+	uint32_t		exit;
+	Sema_t			doneSema;
+	SaWorker_t		workers[SA_WORKER_MAX_THREADS];
+} SaWorkerPool_t;
+
+static  SaWorkerPool_t	sa_worker_pool;
 
 #define	INCR_SA_CNTXT_NFREE() {  \
     if (sa_cntxt_nfree < sa_max_cntxt) {        \
@@ -166,6 +208,7 @@ int sa_filter_reports(Mai_t * data)
 
 static int sa_filter_validate_mad(Mai_t *maip, STL_SA_MAD_HEADER *samad)
 {
+    char        aidName[SA_AID_NAME_LEN];
     int rc = 0;
         
     if (samad->smKey)
@@ -200,11 +243,11 @@ static int sa_filter_validate_mad(Mai_t *maip, STL_SA_MAD_HEADER *samad)
         if (samad->smKey) 
             IB_LOG_WARN_FMT("sa_filter_validate_mad", 
                             "Dropping packet, invalid SM_Key "FMT_U64" %s[%s] from LID [0x%x] with TID ["FMT_U64"] ", 
-                            samad->smKey, sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid), maip->addrInfo.slid, maip->base.tid); 
+                            samad->smKey, sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid, aidName, sizeof(aidName)), maip->addrInfo.slid, maip->base.tid); 
         else 
             IB_LOG_WARN_FMT("sa_filter_validate_mad", 
                             "Dropping packet, invalid P_Key 0x%x %s[%s] from LID [0x%x] with TID ["FMT_U64"] ", 
-                            maip->addrInfo.pkey, sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid), maip->addrInfo.slid, maip->base.tid);
+                            maip->addrInfo.pkey, sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid, aidName, sizeof(aidName)), maip->addrInfo.slid, maip->base.tid);
     }
 
     if (rc) {
@@ -219,6 +262,7 @@ static int sa_filter_validate_mad(Mai_t *maip, STL_SA_MAD_HEADER *samad)
 
 int sa_reader_filter(Mai_t *maip)
 {
+	char		aidName[SA_AID_NAME_LEN];
 	STL_SA_MAD_HEADER samad;
 
     // check whether a previous filter has indicated to drop the packet 
@@ -244,13 +288,14 @@ int sa_reader_filter(Mai_t *maip)
     if (saDebugRmpp) {
         IB_LOG_INFINI_INFO_FMT( "sa_reader_filter",
                "Processing request for %s[%s] from LID[0x%x], TID="FMT_U64, 
-               sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid), maip->addrInfo.slid, maip->base.tid);
+               sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid, aidName, sizeof(aidName)), maip->addrInfo.slid, maip->base.tid);
     }
 	return 0;
 }
 
 int sa_writer_filter(Mai_t *maip)
 {
+	char		aidName[SA_AID_NAME_LEN];
 	STL_SA_MAD_HEADER samad;
 
     BSWAPCOPY_STL_SA_MAD_HEADER((STL_SA_MAD_HEADER*)maip->data, &samad);
@@ -267,7 +312,7 @@ int sa_writer_filter(Mai_t *maip)
             if (saDebugRmpp) {
                 IB_LOG_INFINI_INFO_FMT( "sa_writer_filter",
                        "Processing inflight Rmpp packet for %s[%s] from LID[0x%x], TID="FMT_U64, 
-                       sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid), maip->addrInfo.slid, maip->base.tid);
+                       sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid, aidName, sizeof(aidName)), maip->addrInfo.slid, maip->base.tid);
             }
             return 0;  // process inflight rmpp responses
         }
@@ -320,11 +365,20 @@ sa_main(void) {
     //
     //	Allocate the SA storage pool.
     //
-	status = vs_pool_alloc(&sm_pool, sa_data_length, (void*)&sa_data);
+	status = vs_pool_alloc(&sm_pool, sa_data_length, (void*)&sa_reader_state.data);
 	if (status != VSTATUS_OK) {
 		IB_FATAL_ERROR("sa_main: can't allocate sa data");
 		return 4;
 	}
+#ifndef __VXWORKS__
+	if (!sa_thread_key_valid) {
+		if (pthread_key_create(&sa_thread_key, NULL) != 0) {
+			IB_FATAL_ERROR("sa_main: can't create SA thread state key");
+			return 4;
+		}
+		sa_thread_key_valid = 1;
+	}
+#endif
 
     //
     //	Fill in my ClassPortInfo_t and add it to the database.
@@ -364,25 +418,302 @@ sa_main(void) {
 		return 6;
 	}
 
+	status = sa_PathRecord_CacheInit(sm_config.path_record_cache_size);
+	if (status != VSTATUS_OK) {
+		IB_FATAL_ERROR("sa_main: can't initialize SA PathRecord cache");
+		return 6;
+	}
+
 	return 0;
 }
 
 
+SaThreadState_t *
+sa_thread_state(void)
+{
+#ifndef __VXWORKS__
+	SaThreadState_t *state;
+
+	if (sa_thread_key_valid && (state = pthread_getspecific(sa_thread_key)) != NULL)
+		return state;
+#endif
+	return &sa_reader_state;
+}
+
+//
+//	Get a context for a new request and process it.  Called by the reader, or
+//	by the worker which owns the requester's LID.
+//
+static void
+sa_main_process_request(Mai_t *maip) {
+	char		aidName[SA_AID_NAME_LEN];
+	sa_cntxt_t	*sa_cntxt=NULL;
+    SAContextGet_t  cntxGetStatus=0;
+
+    /* 
+     * get a context to process request; sa_cntxt can be:
+     *   1. NULL if resources are scarce
+     *   2. NULL if request is dup of existing request
+     *   3. in progress getMulti request context
+     *   4. New context for a brand new request 
+     */
+    cntxGetStatus = sa_cntxt_get( maip, (void *)&sa_cntxt );
+    if (cntxGetStatus == ContextAllocated) {
+		/* process the new request */
+		sa_process_mad( maip, sa_cntxt );
+		/* 
+		 * This may not necessarily release context based on if someone else has reserved it
+		 */
+		if(sa_cntxt) sa_cntxt_release( sa_cntxt );
+	} else if (cntxGetStatus == ContextExist) {
+		INCREMENT_COUNTER(smCounterSaDuplicateRequests);
+		/* this is a duplicate request */
+		if (saDebugPerf || saDebugRmpp) {
+			IB_LOG_INFINI_INFO_FMT( "sa_main_reader",
+			       "SA_READER received duplicate %s[%s] from LID [0x%x] with TID ["FMT_U64"] ", 
+			       sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid, aidName, sizeof(aidName)),maip->addrInfo.slid, maip->base.tid);
+		}
+    } else if (cntxGetStatus == ContextNotAvailable) {
+		INCREMENT_COUNTER(smCounterSaContextNotAvailable);
+        /* we are swamped, return BUSY to caller */
+        if (saDebugPerf || saDebugRmpp) { /* log msg before send changes method and lids */
+            IB_LOG_INFINI_INFO_FMT( "sa_main_reader",
+                   "NO CONTEXT AVAILABLE, returning MAD_STATUS_BUSY to %s[%s] request from LID [0x%x], TID ["FMT_U64"]!",
+                   sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid, aidName, sizeof(aidName)), maip->addrInfo.slid, maip->base.tid);
+        }
+        maip->base.status = MAD_STATUS_BUSY;
+        sa_send_reply( maip, sa_cntxt );
+        if ((AtomicIncrement(&sa_context_busy_count) % sa_max_cntxt) == 0) {
+            IB_LOG_INFINI_INFO_FMT( "sa_main_reader",
+                   "Had to drop %d SA requests since start due to no available contexts",
+                   (int)AtomicRead(&sa_context_busy_count));
+        }
+    } else if (cntxGetStatus == ContextExistGetMulti) {
+        /* continue processing the getMulti request */
+        sa_process_getmulti( maip, sa_cntxt );
+        if(sa_cntxt) sa_cntxt_release( sa_cntxt );
+    } else {
+        IB_LOG_WARN("sa_main_reader: Invalid sa_cntxt_get return code:", cntxGetStatus);
+    }
+}
+
+// argc is the worker index.
+static void
+sa_worker(uint32_t argc, uint8_t ** argv) {
+	SaWorkerPool_t	*pool = &sa_worker_pool;
+	SaWorker_t		*worker = &pool->workers[argc];
+	Mai_t			in_mad;
+
+#ifndef __VXWORKS__
+	(void)pthread_setspecific(sa_thread_key, &worker->state);
+#endif
+
+	for (;;) {
+		if (cs_psema(&worker->sema) != VSTATUS_OK)
+			continue;
+
+		if (pool->exit)
+			break;
+
+		(void)vs_lock(&worker->lock);
+		memcpy(&in_mad, &worker->queue[worker->head], sizeof(Mai_t));
+		worker->head = (worker->head + 1) % SA_WORKER_QUEUE_DEPTH;
+		worker->count--;
+		(void)vs_unlock(&worker->lock);
+
+		/* we may have lost mastership while the request was queued */
+		if (sm_state != SM_STATE_MASTER)
+			continue;
+
+		sa_main_process_request(&in_mad);
+	}
+
+	(void)cs_vsema(&pool->doneSema);
+}
+
+static void
+sa_worker_free(SaWorker_t *worker) {
+	if (worker->state.fd)
+		(void)mai_close(worker->state.fd);
+	if (worker->state.data)
+		(void)vs_pool_free(&sm_pool, worker->state.data);
+	if (worker->queue)
+		(void)vs_pool_free(&sm_pool, worker->queue);
+	memset(worker, 0, sizeof(*worker));
+}
+
+static Status_t
+sa_workers_start(uint32_t threads) {
+	SaWorkerPool_t	*pool = &sa_worker_pool;
+	SaWorker_t		*worker;
+	Status_t		status;
+	uint32_t		i;
+
+	IB_ENTER(__func__, threads, 0, 0, 0);
+
+	memset(pool, 0, sizeof(*pool));
+
+#ifdef __VXWORKS__
+	threads = 0;
+#endif
+	if (threads == 0) {
+		IB_EXIT(__func__, VSTATUS_OK);
+		return VSTATUS_OK;
+	}
+	if (threads > SA_WORKER_MAX_THREADS)
+		threads = SA_WORKER_MAX_THREADS;
+
+	if ((status = cs_sema_create(&pool->doneSema, 0)) != VSTATUS_OK) {
+		IB_LOG_ERRORRC("can't create SA worker pool semaphore rc:", status);
+		IB_EXIT(__func__, status);
+		return status;
+	}
+
+	for (i = 0; i < threads; i++) {
+		worker = &pool->workers[i];
+
+		status = vs_pool_alloc(&sm_pool, sizeof(Mai_t) * SA_WORKER_QUEUE_DEPTH, (void *)&worker->queue);
+		if (status == VSTATUS_OK)
+			status = vs_pool_alloc(&sm_pool, sa_data_length, (void *)&worker->state.data);
+		if (status == VSTATUS_OK)
+			status = mai_open(1, sm_config.hca, sm_config.port, &worker->state.fd);
+		if (status != VSTATUS_OK) {
+			IB_LOG_WARNRC("can't allocate SA worker resources, continuing with fewer workers rc:", status);
+			sa_worker_free(worker);
+			break;
+		}
+
+		if ((status = vs_lock_init(&worker->lock, VLOCK_FREE, VLOCK_THREAD)) != VSTATUS_OK) {
+			IB_LOG_WARNRC("can't initialize SA worker lock, continuing with fewer workers rc:", status);
+			sa_worker_free(worker);
+			break;
+		}
+
+		if ((status = cs_sema_create(&worker->sema, 0)) != VSTATUS_OK) {
+			IB_LOG_WARNRC("can't create SA worker semaphore, continuing with fewer workers rc:", status);
+			(void)vs_lock_delete(&worker->lock);
+			sa_worker_free(worker);
+			break;
+		}
+
+		status = vs_thread_create(&worker->handle, (unsigned char *)"saworker",
+								  sa_worker, i, NULL, SM_STACK_SIZE);
+		if (status != VSTATUS_OK) {
+			IB_LOG_WARNRC("can't create SA worker thread, continuing with fewer workers rc:", status);
+			(void)cs_sema_delete(&worker->sema);
+			(void)vs_lock_delete(&worker->lock);
+			sa_worker_free(worker);
+			break;
+		}
+		pool->threads++;
+	}
+
+	if (pool->threads == 0)
+		(void)cs_sema_delete(&pool->doneSema);
+	else
+		IB_LOG_INFINI_INFO("SA worker threads:", pool->threads);
+
+	IB_EXIT(__func__, VSTATUS_OK);
+	return VSTATUS_OK;
+}
+
+static void
+sa_workers_stop(void) {
+	SaWorkerPool_t	*pool = &sa_worker_pool;
+	uint32_t		i;
+
+	if (pool->threads == 0)
+		return;
+
+	pool->exit = 1;
+	for (i = 0; i < pool->threads; i++)
+		(void)cs_vsema(&pool->workers[i].sema);
+	for (i = 0; i < pool->threads; i++)
+		(void)cs_psema(&pool->doneSema);
+
+	for (i = 0; i < pool->threads; i++) {
+		(void)cs_sema_delete(&pool->workers[i].sema);
+		(void)vs_lock_delete(&pool->workers[i].lock);
+		sa_worker_free(&pool->workers[i]);
+	}
+	(void)cs_sema_delete(&pool->doneSema);
+	pool->threads = 0;
+}
+
+//
+//	Hand a request to a worker.  Returns 0 if the reader must process the
+//	request itself.
+//
+static int
+sa_worker_dispatch(Mai_t *maip) {
+	char		aidName[SA_AID_NAME_LEN];
+	SaWorkerPool_t	*pool = &sa_worker_pool;
+	SaWorker_t		*worker;
+
+	if (pool->threads == 0)
+		return 0;
+
+	switch (maip->base.method) {
+	case SA_CM_GET:
+	case SA_CM_GETTABLE:
+	case SA_CM_GETTRACETABLE:
+	case SA_CM_GETMULTI:
+		break;
+	default:
+		return 0;
+	}
+
+	// these return pointers into tables which are only locked while searched,
+	// so they stay with the other updates on the reader
+	switch (maip->base.aid) {
+	case SA_MCMEMBER_RECORD:
+	case SA_SERVICE_RECORD:
+	case SA_INFORMINFO:
+	case SA_INFORM_RECORD:
+	case SA_JOB_MANAGEMENT:
+		return 0;
+	default:
+		break;
+	}
+
+	worker = &pool->workers[maip->addrInfo.slid % pool->threads];
+
+	(void)vs_lock(&worker->lock);
+	if (worker->count >= SA_WORKER_QUEUE_DEPTH) {
+		(void)vs_unlock(&worker->lock);
+		INCREMENT_COUNTER(smCounterSaDroppedRequests);
+		if (smDebugPerf || saDebugPerf) {
+			IB_LOG_INFINI_INFO_FMT(__func__,
+			       "Dropping %s[%s] request from LID[0x%x], TID="FMT_U64"; SA worker queue full",
+			       sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid, aidName, sizeof(aidName)),
+			       maip->addrInfo.slid, maip->base.tid);
+		}
+		/* sender will retry */
+		return 1;
+	}
+	memcpy(&worker->queue[(worker->head + worker->count) % SA_WORKER_QUEUE_DEPTH], maip, sizeof(Mai_t));
+	worker->count++;
+	(void)vs_unlock(&worker->lock);
+
+	(void)cs_vsema(&worker->sema);
+	return 1;
+}
+
 void
 sa_main_reader(uint32_t argc, uint8_t ** argv) {
+	char		aidName[SA_AID_NAME_LEN];
 	Status_t	status;
 	Mai_t		in_mad;
 	Filter_t	filter;
-	sa_cntxt_t	*sa_cntxt=NULL;
 	uint64_t	now, delta, max_delta;
 	int			tries=0, retry=0;
     uint64_t    reqTimeToLive=0;
-    SAContextGet_t  cntxGetStatus=0;
-    int         numContextBusy=0;
 
 	IB_ENTER("sa_main_reader", 0, 0, 0, 0);
 
 	sa_main_reader_exit = 0;
+	sa_reader_state.fd = fd_sa;
+	AtomicWrite(&sa_context_busy_count, 0);
     
     /*
      *	Create the SubnAdm(*) MAD filter for the SA thread.
@@ -400,6 +731,8 @@ sa_main_reader(uint32_t argc, uint8_t ** argv) {
 		(void)vs_thread_exit(&sm_threads[SM_THREAD_SA_READER].handle);
 	}
 
+	(void)sa_workers_start(sm_config.sa_worker_threads);
+
     timeMftLastUpdated = 0;
     /* 
      * calculate request time to live on queue
@@ -460,58 +793,16 @@ sa_main_reader(uint32_t argc, uint8_t ** argv) {
                     if (smDebugPerf || saDebugPerf) {
                         IB_LOG_INFINI_INFO_FMT( "sa_main_reader",
                                "Dropping stale %s[%s] request from LID[0x%x], TID="FMT_U64"; On queue for %d.%d seconds.", 
-                               sa_getMethodText((int)in_mad.base.method), sa_getAidName((int)in_mad.base.aid), in_mad.addrInfo.slid, 
+                               sa_getMethodText((int)in_mad.base.method), sa_getAidName((int)in_mad.base.aid, aidName, sizeof(aidName)), in_mad.addrInfo.slid, 
                                in_mad.base.tid, (int)(delta/1000000), (int)((delta - delta/1000000*1000000))/1000);
                     }
                     /* drop the request without returning a response; sender will retry */
                     continue;
                 }
             }
-            /* 
-             * get a context to process request; sa_cntxt can be:
-             *   1. NULL if resources are scarce
-             *   2. NULL if request is dup of existing request
-             *   3. in progress getMulti request context
-             *   4. New context for a brand new request 
-             */
-            cntxGetStatus = sa_cntxt_get( &in_mad, (void *)&sa_cntxt );
-            if (cntxGetStatus == ContextAllocated) {
-				/* process the new request */
-				sa_process_mad( &in_mad, sa_cntxt );
-				/* 
-				 * This may not necessarily release context based on if someone else has reserved it
-				 */
-				if(sa_cntxt) sa_cntxt_release( sa_cntxt );
-			} else if (cntxGetStatus == ContextExist) {
-				INCREMENT_COUNTER(smCounterSaDuplicateRequests);
-				/* this is a duplicate request */
-				if (saDebugPerf || saDebugRmpp) {
-					IB_LOG_INFINI_INFO_FMT( "sa_main_reader",
-					       "SA_READER received duplicate %s[%s] from LID [0x%x] with TID ["FMT_U64"] ", 
-					       sa_getMethodText((int)in_mad.base.method), sa_getAidName((int)in_mad.base.aid),in_mad.addrInfo.slid, in_mad.base.tid);
-				}
-            } else if (cntxGetStatus == ContextNotAvailable) {
-				INCREMENT_COUNTER(smCounterSaContextNotAvailable);
-                /* we are swamped, return BUSY to caller */
-                if (saDebugPerf || saDebugRmpp) { /* log msg before send changes method and lids */
-                    IB_LOG_INFINI_INFO_FMT( "sa_main_reader",
-                           "NO CONTEXT AVAILABLE, returning MAD_STATUS_BUSY to %s[%s] request from LID [0x%x], TID ["FMT_U64"]!",
-                           sa_getMethodText((int)in_mad.base.method), sa_getAidName((int)in_mad.base.aid), in_mad.addrInfo.slid, in_mad.base.tid);
-                }
-                in_mad.base.status = MAD_STATUS_BUSY;
-                sa_send_reply( &in_mad, sa_cntxt );
-                if ((++numContextBusy % sa_max_cntxt) == 0) {
-                    IB_LOG_INFINI_INFO_FMT( "sa_main_reader",
-                           "Had to drop %d SA requests since start due to no available contexts",
-                           numContextBusy);
-                }
-            } else if (cntxGetStatus == ContextExistGetMulti) {
-                /* continue processing the getMulti request */
-                sa_process_getmulti( &in_mad, sa_cntxt );
-                if(sa_cntxt) sa_cntxt_release( sa_cntxt );
-            } else {
-                IB_LOG_WARN("sa_main_reader: Invalid sa_cntxt_get return code:", cntxGetStatus);
-            }
+            /* queries go to the worker pool, everything else is processed here */
+            if (!sa_worker_dispatch(&in_mad))
+                sa_main_process_request(&in_mad);
         }
 
         /* 
@@ -535,6 +826,7 @@ sa_main_reader(uint32_t argc, uint8_t ** argv) {
             sa_mft_reprog = 0;
         }
 	}
+    sa_workers_stop();
     /* cleanup before exit, but allow some time for the other threads to flush out first */
     (void)vs_thread_sleep(VTIMER_1S);     
     (void)sa_SubscriberDelete();
@@ -546,6 +838,7 @@ sa_main_reader(uint32_t argc, uint8_t ** argv) {
 
 void
 sa_main_writer(uint32_t argc, uint8_t ** argv) {
+	char		aidName[SA_AID_NAME_LEN];
 	Status_t	status;
 	Mai_t		in_mad;
 	Filter_t	filter;
@@ -608,7 +901,7 @@ sa_main_writer(uint32_t argc, uint8_t ** argv) {
                 if (saDebugRmpp) {
                     IB_LOG_INFINI_INFO_FMT( "sa_main_writer", 
                            "dropping %s[%s] RMPP packet from LID[0x%x], TID ["FMT_U64"] already completed/aborted",
-                           sa_getMethodText((int)in_mad.base.method), sa_getAidName(in_mad.base.aid), 
+                           sa_getMethodText((int)in_mad.base.method), sa_getAidName(in_mad.base.aid, aidName, sizeof(aidName)), 
                            in_mad.addrInfo.slid, in_mad.base.tid);
                 }
             }
@@ -641,6 +934,7 @@ sa_main_writer(uint32_t argc, uint8_t ** argv) {
     /* clean up cache before exit */
     sa_cache_clean();
     (void)vs_lock_delete(&saCache.lock);
+    sa_PathRecord_CacheDelete();
 	//IB_LOG_INFINI_INFO0("sa_main_writer thread: Exiting OK");
 } // SA_MAIN_WRITER
 
@@ -1058,6 +1352,7 @@ void sa_cntxt_clear(void) {
 void setPacketLifetime(uint8_t plt) {
     if (plt > 0 && plt < 20) {
         sm_config.sa_packet_lifetime_n2 = plt;
+        sa_PathRecord_CacheInvalidate();
         printf("packetLifetime set to %d; host will get on next path record request \n", (int)sm_config.sa_packet_lifetime_n2);
     } else {
         printf("sa_packetLifetime should be 1-19;  current value is %d \n", (int)sm_config.sa_packet_lifetime_n2);
@@ -1084,6 +1379,7 @@ void setDynamicPlt(uint8_t h1, uint8_t h2, uint8_t h3, uint8_t h4, uint8_t h5) {
         printf("Dynamic PLT ON using values: 5 hops=%d, 6 hops=%d, 7 hops=%d, 7+hops=%d \n", 
                h5, sa_dynamicPlt[6], sa_dynamicPlt[7], sa_dynamicPlt[9]);
     }
+    sa_PathRecord_CacheInvalidate();
 }
 
 void setRespTime(uint8_t respTime) {
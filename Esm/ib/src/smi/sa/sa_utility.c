@@ -153,6 +153,7 @@ char *sa_getMethodText(int method) {
 
 Status_t
 sa_validate_mad(Mai_t *maip) {
+    char        aidName[SA_AID_NAME_LEN];
     Status_t	rc = VSTATUS_OK;
 
 	IB_ENTER("sa_validate_mad", maip, 0, 0, 0);
@@ -161,7 +162,7 @@ sa_validate_mad(Mai_t *maip) {
 		maip->base.cversion != STL_SA_CLASS_VERSION) {
         IB_LOG_WARN_FMT( "sa_validate_mad",
                "Invalid SA Class Version %d received in %s[%s] request from LID [0x%x], TID ["FMT_U64"], ignoring request!",
-               maip->base.cversion, sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid), maip->addrInfo.slid, maip->base.tid);
+               maip->base.cversion, sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid, aidName, sizeof(aidName)), maip->addrInfo.slid, maip->base.tid);
 		rc = VSTATUS_BAD;
     } else {
         /*  Drop unsupported MADs */
@@ -172,7 +173,7 @@ sa_validate_mad(Mai_t *maip) {
             if (smDebugPerf || saDebugPerf) {
                 IB_LOG_INFINI_INFO_FMT( "sa_validate_mad",
                        "Unsupported or invalid %s[%s] request from LID [0x%x], TID["FMT_U64"]", 
-                       sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid), maip->addrInfo.slid, maip->base.tid);
+                       sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid, aidName, sizeof(aidName)), maip->addrInfo.slid, maip->base.tid);
             }
     		IB_EXIT("sa_validate_mad", VSTATUS_OK);
     		rc = VSTATUS_BAD;
@@ -192,6 +193,7 @@ sa_validate_mad(Mai_t *maip) {
 //
 Status_t
 sa_process_inflight_rmpp_request(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
+	char		aidName[SA_AID_NAME_LEN];
 
 	IB_ENTER("sa_process_inflight_rmpp_request", maip, sa_cntxt, 0, 0);
     //
@@ -203,7 +205,7 @@ sa_process_inflight_rmpp_request(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
 	} else {
         IB_LOG_INFINI_INFO_FMT( "sa_process_inflight_rmpp_request",
                "SA_WRITER received %s[%s] RMPP packet from LID [0x%x] TID ["FMT_U64"] after transaction completion", 
-               sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid), maip->addrInfo.slid, maip->base.tid);
+               sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid, aidName, sizeof(aidName)), maip->addrInfo.slid, maip->base.tid);
     }
     IB_EXIT("sa_process_inflight_rmpp_request", VSTATUS_OK);
     return(VSTATUS_OK);
@@ -243,6 +245,7 @@ Status_t
 sa_process_mad(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
 
     uint64_t startTime=0, endTime=0;
+    char     aidName[SA_AID_NAME_LEN];
 
 	IB_ENTER("sa_process_mad", maip, sa_cntxt, 0, 0);
 
@@ -257,8 +260,8 @@ sa_process_mad(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
 		return(VSTATUS_OK);
 	}
 
-    /* use sa reader mai handle for sending out 1st packet of responses */
-    sa_cntxt->sendFd = fd_sa;
+    /* use this thread's mai handle for sending out 1st packet of responses */
+    sa_cntxt->sendFd = sa_reply_fd;
 
     /*
      * Since we have validated this MAD, we can now process it in an attribute specific way.
@@ -268,7 +271,7 @@ sa_process_mad(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
 #if 0
 // make "#if 1" to assist in local SA debugging
         fprintf(stdout, "sa_process_mad: %s[%s] request from LID [0x%x], TID["FMT_U64"]\n", 
-               sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid), maip->addrInfo.slid, maip->base.tid);
+               sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid, aidName, sizeof(aidName)), maip->addrInfo.slid, maip->base.tid);
         fflush(stdout);
 #endif
 	switch (maip->base.aid) {
@@ -377,7 +380,7 @@ sa_process_mad(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
     default:
         IB_LOG_INFINI_INFO_FMT( "sa_process_mad",
                "Unsupported or invalid %s[%s] request from LID [0x%x], TID["FMT_U64"]", 
-               sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid), maip->addrInfo.slid, maip->base.tid);
+               sa_getMethodText((int)maip->base.method), sa_getAidName((int)maip->base.aid, aidName, sizeof(aidName)), maip->addrInfo.slid, maip->base.tid);
 		maip->base.status = MAD_STATUS_SA_REQ_INVALID;
 		sa_cntxt_data( sa_cntxt, sa_data, 0 );
 		(void)sa_send_reply(maip, sa_cntxt);
@@ -399,7 +402,7 @@ sa_process_mad(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
         IB_LOG_INFINI_INFO_FMT( "sa_process_mad", 
                "%ld microseconds to process %s[%s] request from LID 0x%.4X, TID="FMT_U64,
                (long)(endTime - startTime), sa_getMethodText((int)sa_cntxt->method), 
-               sa_getAidName(maip->base.aid), maip->addrInfo.dlid, maip->base.tid);
+               sa_getAidName(maip->base.aid, aidName, sizeof(aidName)), maip->addrInfo.dlid, maip->base.tid);
     }
 	IB_EXIT("sa_process_mad", VSTATUS_OK);
 	return(VSTATUS_OK);
@@ -409,6 +412,7 @@ sa_process_mad(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
 
 Status_t
 sa_send_reply(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
+	char		aidName[SA_AID_NAME_LEN];
 	uint8_t		method;
 	uint16_t	lid;
 
@@ -477,7 +481,7 @@ sa_send_reply(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
                 if (maip) {
                     IB_LOG_WARN_FMT("sa_send_reply", 
                        "sa_cntxt->len[%d] too large, returning no resources error to caller to %s[%s] request from LID [0x%x], TID ["FMT_U64"]!",
-                       sa_cntxt->len, sa_getMethodText((int)method), sa_getAidName((int)maip->base.aid), sa_cntxt->lid, sa_cntxt->tid);
+                       sa_cntxt->len, sa_getMethodText((int)method), sa_getAidName((int)maip->base.aid, aidName, sizeof(aidName)), sa_cntxt->lid, sa_cntxt->tid);
                     maip->base.status = MAD_STATUS_SA_NO_RESOURCES;
                 } else {
                     IB_LOG_WARN_FMT("sa_send_reply", 
@@ -522,8 +526,8 @@ Status_t sa_getMulti_resend_ack(sa_cntxt_t *sa_cntxt) {
 	STL_SA_MAD	samad;
     uint16_t    lid;
     Status_t    status=VSTATUS_OK;
-    /* set the mai handle to use for sending - use reader handle fd_sa if no context */
-    IBhandle_t  fd = (sa_cntxt->sendFd) ? sa_cntxt->sendFd : fd_sa;
+    /* set the mai handle to use for sending - use this thread's handle if no context */
+    IBhandle_t  fd = (sa_cntxt->sendFd) ? sa_cntxt->sendFd : sa_reply_fd;
 
     // get input mad from context
     memcpy((void *)&mad, (void *)&sa_cntxt->mad, sizeof(Mai_t));
@@ -590,8 +594,8 @@ Status_t sa_getMulti_resend_ack(sa_cntxt_t *sa_cntxt) {
 static Status_t send_ack(Mai_t *maip, STL_SA_MAD *samad, sa_cntxt_t* sa_cntxt, uint16_t wsize) {
     Status_t    rc=VSTATUS_OK;
     uint16_t    lid;
-    /* set the mai handle to use for sending - use reader handle fd_sa if no context */
-    IBhandle_t  fd = (sa_cntxt->sendFd) ? sa_cntxt->sendFd : fd_sa;
+    /* set the mai handle to use for sending - use this thread's handle if no context */
+    IBhandle_t  fd = (sa_cntxt->sendFd) ? sa_cntxt->sendFd : sa_reply_fd;
 
     samad->header.rmppType = RMPP_TYPE_ACK;
     /* set NewWindowLast (next ACK) */
@@ -642,8 +646,8 @@ sa_receive_getmulti(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
     uint16_t    lid;
     uint32_t    len;
     Status_t    rc=VSTATUS_OK;
-    /* set the mai handle to use for sending - use reader handle fd_sa if no context */
-    IBhandle_t  fd = (sa_cntxt->sendFd) ? sa_cntxt->sendFd : fd_sa;
+    /* set the mai handle to use for sending - use this thread's handle if no context */
+    IBhandle_t  fd = (sa_cntxt->sendFd) ? sa_cntxt->sendFd : sa_reply_fd;
 
 	IB_ENTER("sa_receive_getmulti", maip, sa_cntxt, 0, 0);
 
@@ -773,7 +777,7 @@ sa_receive_getmulti(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
             sa_cntxt->retries = 0;          // current retry count
             sa_cntxt->segTotal = 0;
             sa_cntxt->reqInProg = 1;
-            sa_cntxt->sendFd = fd_sa;       // use reader mai handle for receiving request
+            sa_cntxt->sendFd = sa_reply_fd; // use reader/worker mai handle for receiving request
             /* calculate packet and total transaction timeouts */
             sa_cntxt->RespTimeout = 4ull * ( (2*(1<<sm_config.sa_packet_lifetime_n2)) + (1<<saClassPortInfo.u1.s.RespTimeValue) );
             sa_cntxt->tTime = 0;            // for now just use max retries
@@ -988,11 +992,12 @@ sa_receive_getmulti(Mai_t *maip, sa_cntxt_t* sa_cntxt) {
 
 Status_t
 sa_send_single(Mai_t *maip, sa_cntxt_t* sa_cntxt ) {
+	char		aidName[SA_AID_NAME_LEN];
 	Status_t	status;
     uint32_t    datalen = sizeof(SAMadh_t);
 	STL_SA_MAD	samad;
-    /* set the mai handle to use for sending - use reader handle fd_sa if no context */
-    IBhandle_t  fd = (sa_cntxt && sa_cntxt->sendFd) ? sa_cntxt->sendFd : fd_sa;
+    /* set the mai handle to use for sending - use this thread's handle if no context */
+    IBhandle_t  fd = (sa_cntxt && sa_cntxt->sendFd) ? sa_cntxt->sendFd : sa_reply_fd;
 
 	IB_ENTER("sa_send_single", maip, sa_cntxt, 0, 0);
 
@@ -1035,7 +1040,7 @@ sa_send_single(Mai_t *maip, sa_cntxt_t* sa_cntxt ) {
 	if (status != VSTATUS_OK) {
         IB_LOG_ERROR_FMT( "sa_send_single", 
                "can't send reply to %s request to LID[0x%x] for TID["FMT_U64"]",
-               sa_getAidName(maip->base.aid), (int)maip->addrInfo.dlid, maip->base.tid);
+               sa_getAidName(maip->base.aid, aidName, sizeof(aidName)), (int)maip->addrInfo.dlid, maip->base.tid);
 		IB_EXIT("sa_send_single", VSTATUS_OK);
 		return(VSTATUS_OK);
 	}
@@ -1049,6 +1054,7 @@ sa_send_single(Mai_t *maip, sa_cntxt_t* sa_cntxt ) {
  */
 Status_t
 sa_send_multi(Mai_t *maip, sa_cntxt_t *sa_cntxt ) {
+    char        aidName[SA_AID_NAME_LEN];
     int         i;
     int         wl=0;
     uint8_t     chkSum=0;
@@ -1059,7 +1065,7 @@ sa_send_multi(Mai_t *maip, sa_cntxt_t *sa_cntxt ) {
     uint16_t    sendAbort=0;
     uint16_t    releaseContext=1;  /* release context here unless we are in resend mode */
     uint64_t    tnow, delta, ttemp;
-    IBhandle_t  fd = (sa_cntxt->sendFd) ? sa_cntxt->sendFd : fd_sa;
+    IBhandle_t  fd = (sa_cntxt->sendFd) ? sa_cntxt->sendFd : sa_reply_fd;
 	size_t      sa_data_size = IB_SA_DATA_LEN;
 
 	IB_ENTER("sa_send_multi", maip, sa_cntxt, sa_cntxt->len , 0);
@@ -1149,7 +1155,7 @@ sa_send_multi(Mai_t *maip, sa_cntxt_t *sa_cntxt ) {
             // invalid RMPP type
             IB_LOG_WARN_FMT( "sa_send_multi", 
                    "ABORTING - RMPP protocol error; RmppType is NULL in %s[%s] from Lid[%d] for TID="FMT_U64,
-                   sa_getMethodText((int)sa_cntxt->method), sa_getAidName(maip->base.aid), (int)sa_cntxt->lid, sa_cntxt->tid);
+                   sa_getMethodText((int)sa_cntxt->method), sa_getAidName(maip->base.aid, aidName, sizeof(aidName)), (int)sa_cntxt->lid, sa_cntxt->tid);
 			INCREMENT_COUNTER(smCounterRmppStatusAbortBadType);
             sendAbort = 1;
             samad.header.rmppStatus = RMPP_STATUS_ABORT_BADTYPE;
@@ -1160,12 +1166,12 @@ sa_send_multi(Mai_t *maip, sa_cntxt_t *sa_cntxt ) {
             samad.header.rmppStatus = RMPP_STATUS_ABORT_UNSUPPORTED_VERSION;
             IB_LOG_WARN_FMT( "sa_send_multi", 
                    "ABORTING - Unsupported Version %d in %s[%s] request from LID[0x%x], TID["FMT_U64"]",
-                   saresp.header.rmppVersion, sa_getMethodText((int)sa_cntxt->method), sa_getAidName(maip->base.aid), (int)sa_cntxt->lid, sa_cntxt->tid);
+                   saresp.header.rmppVersion, sa_getMethodText((int)sa_cntxt->method), sa_getAidName(maip->base.aid, aidName, sizeof(aidName)), (int)sa_cntxt->lid, sa_cntxt->tid);
        } else if (!(saresp.header.u.tf.rmppFlags & RMPP_FLAGS_ACTIVE)) {
            /* invalid RMPP type */
            IB_LOG_WARN_FMT( "sa_send_multi", 
                   "RMPP protocol error, RMPPFlags.Active bit is NULL in %s[%s] from LID[0x%x] for TID["FMT_U64"]",
-                  sa_getMethodText((int)sa_cntxt->method), sa_getAidName(maip->base.aid), (int)sa_cntxt->lid, sa_cntxt->tid);
+                  sa_getMethodText((int)sa_cntxt->method), sa_getAidName(maip->base.aid, aidName, sizeof(aidName)), (int)sa_cntxt->lid, sa_cntxt->tid);
 			INCREMENT_COUNTER(smCounterRmppStatusAbortBadType);
            samad.header.rmppStatus = RMPP_STATUS_ABORT_BADTYPE;
            sendAbort = 1;
@@ -1213,7 +1219,7 @@ sa_send_multi(Mai_t *maip, sa_cntxt_t *sa_cntxt ) {
                     if (saDebugRmpp) {
                         IB_LOG_INFINI_INFO_FMT( "sa_send_multi",
                                " Received seg %d ACK, %s[%s] transaction from LID[0x%x], TID["FMT_U64"] has completed",
-                               saresp.header.segNum, sa_getMethodText((int)sa_cntxt->method), sa_getAidName(sa_cntxt->mad.base.aid),
+                               saresp.header.segNum, sa_getMethodText((int)sa_cntxt->method), sa_getAidName(sa_cntxt->mad.base.aid, aidName, sizeof(aidName)),
                                sa_cntxt->lid, sa_cntxt->tid);
                     }
                 } else {
@@ -1227,7 +1233,7 @@ sa_send_multi(Mai_t *maip, sa_cntxt_t *sa_cntxt ) {
                             IB_LOG_INFINI_INFO_FMT( "sa_send_multi",
                                    "LID[0x%x] set RespTimeValue (%d usec) in ACK of seg %d for %s[%s], TID["FMT_U64"]",
                                    sa_cntxt->lid, (int)sa_cntxt->RespTimeout, saresp.header.segNum, 
-                                   sa_getMethodText((int)sa_cntxt->method), sa_getAidName((int)sa_cntxt->mad.base.aid),
+                                   sa_getMethodText((int)sa_cntxt->method), sa_getAidName((int)sa_cntxt->mad.base.aid, aidName, sizeof(aidName)),
                                    sa_cntxt->tid);
                         }
                     }
@@ -1238,7 +1244,7 @@ sa_send_multi(Mai_t *maip, sa_cntxt_t *sa_cntxt ) {
             if (saDebugPerf || saDebugRmpp) {
                 IB_LOG_INFINI_INFO_FMT( "sa_send_multi",
                        "STOP/ABORT received for %s[%s] from LID[0x%x], status code = %x, for TID["FMT_U64"]",
-                       sa_getMethodText((int)sa_cntxt->method), sa_getAidName((int)maip->base.aid),
+                       sa_getMethodText((int)sa_cntxt->method), sa_getAidName((int)maip->base.aid, aidName, sizeof(aidName)),
                         sa_cntxt->lid, saresp.header.rmppStatus);
             }
             sa_cntxt_release( sa_cntxt );
@@ -1248,7 +1254,7 @@ sa_send_multi(Mai_t *maip, sa_cntxt_t *sa_cntxt ) {
             /* invalid RmppType received */
             IB_LOG_WARN_FMT( "sa_send_multi",
                    "ABORT - Invalid rmppType %d received for %s[%s] from LID[0x%x] for TID["FMT_U64"]",
-                   saresp.header.rmppType, sa_getMethodText((int)sa_cntxt->method), sa_getAidName((int)maip->base.aid),
+                   saresp.header.rmppType, sa_getMethodText((int)sa_cntxt->method), sa_getAidName((int)maip->base.aid, aidName, sizeof(aidName)),
                    sa_cntxt->lid, sa_cntxt->tid);
             // abort with badtype status
 			INCREMENT_COUNTER(smCounterRmppStatusAbortBadType);
@@ -1266,7 +1272,7 @@ sa_send_multi(Mai_t *maip, sa_cntxt_t *sa_cntxt ) {
 					"sa_send_multi",
 				   	"ABORT - MAX RETRIES EXHAUSTED; no ACK for seg %d of %s[%s] request from LID[0x%X], TID = "FMT_U64, 
 				    (int)sa_cntxt->WL, sa_getMethodText((int)sa_cntxt->method),
-				   	sa_getAidName(sa_cntxt->mad.base.aid), sa_cntxt->lid,
+				   	sa_getAidName(sa_cntxt->mad.base.aid, aidName, sizeof(aidName)), sa_cntxt->lid,
 					sa_cntxt->tid);
 			}
 			/* ABORT transaction with too many retries status */
@@ -1281,7 +1287,7 @@ sa_send_multi(Mai_t *maip, sa_cntxt_t *sa_cntxt ) {
 			if (saDebugRmpp) {
 				IB_LOG_INFINI_INFO_FMT( "sa_send_multi",
 				       "Timed out waiting for ACK of seg %d of %s[%s] from LID[0x%x], TID["FMT_U64"], retry #%d",
-				       (int)sa_cntxt->WL, sa_getMethodText((int)sa_cntxt->method), sa_getAidName((int)sa_cntxt->mad.base.aid),
+				       (int)sa_cntxt->WL, sa_getMethodText((int)sa_cntxt->method), sa_getAidName((int)sa_cntxt->mad.base.aid, aidName, sizeof(aidName)),
 				       sa_cntxt->lid, sa_cntxt->tid, sa_cntxt->retries);
 			}
 		}
@@ -1294,7 +1300,7 @@ sa_send_multi(Mai_t *maip, sa_cntxt_t *sa_cntxt ) {
             delta = tnow-sa_cntxt->mad.intime;
             IB_LOG_INFINI_INFO_FMT( "sa_send_multi", 
                    "%s[%s] RMPP [CHKSUM=%d] TRANSACTION from LID[0x%x], TID["FMT_U64"] has completed in %d.%.3d seconds (%"CS64"d usecs)",
-                   sa_getMethodText((int)sa_cntxt->method), sa_getAidName(sa_cntxt->mad.base.aid), 
+                   sa_getMethodText((int)sa_cntxt->method), sa_getAidName(sa_cntxt->mad.base.aid, aidName, sizeof(aidName)), 
                    sa_cntxt->chkSum, sa_cntxt->lid, sa_cntxt->tid,
                    (int)(delta/1000000), (int)((delta - delta/1000000*1000000))/1000, delta);
         }
@@ -1307,7 +1313,7 @@ sa_send_multi(Mai_t *maip, sa_cntxt_t *sa_cntxt ) {
             if (chkSum != sa_cntxt->chkSum) {
                 IB_LOG_ERROR_FMT( "sa_send_multi", 
                        "CHECKSUM FAILED [%d vs %d] for completeted %s[%s] RMPP TRANSACTION from LID[0x%x], TID["FMT_U64"]",
-                       chkSum, sa_cntxt->chkSum, sa_getMethodText((int)sa_cntxt->method), sa_getAidName(sa_cntxt->mad.base.aid), 
+                       chkSum, sa_cntxt->chkSum, sa_getMethodText((int)sa_cntxt->method), sa_getAidName(sa_cntxt->mad.base.aid, aidName, sizeof(aidName)), 
                        sa_cntxt->lid, sa_cntxt->tid);
             }
         }
@@ -1405,7 +1411,7 @@ sa_send_multi(Mai_t *maip, sa_cntxt_t *sa_cntxt ) {
 		if (status != VSTATUS_OK) {
             IB_LOG_ERROR_FMT( "sa_send_multi", 
                    "mai_send error [%d] while processing %s[%s] request from LID[0x%x], TID["FMT_U64"]",
-                   status, sa_getMethodText((int)sa_cntxt->method), sa_getAidName(maip->base.aid), 
+                   status, sa_getMethodText((int)sa_cntxt->method), sa_getAidName(maip->base.aid, aidName, sizeof(aidName)), 
                    sa_cntxt->lid, sa_cntxt->tid);
             if (releaseContext) sa_cntxt_release( sa_cntxt );
 			IB_EXIT( "sa_send_multi", VSTATUS_OK );
@@ -1428,7 +1434,7 @@ sa_send_multi(Mai_t *maip, sa_cntxt_t *sa_cntxt ) {
 		if ((status = mai_send(fd, maip)) != VSTATUS_OK)
             IB_LOG_ERROR_FMT( "sa_send_multi", 
                    "error[%d] from mai_send while sending ABORT of [%s] request to LID[0x%x], TID["FMT_U64"]",
-                   status, sa_getMethodText((int)sa_cntxt->method), sa_getAidName(maip->base.aid), 
+                   status, sa_getMethodText((int)sa_cntxt->method), sa_getAidName(maip->base.aid, aidName, sizeof(aidName)), 
                    sa_cntxt->lid, maip->base.tid);
         /*
          * We are done with this RMPP xfer.  Release the context here if 
@@ -1632,7 +1638,11 @@ sa_cache_cntxt_free(sa_cntxt_t *cntxt)
 	
 	IB_ENTER("sa_cache_cntxt_free", cntxt, 0, 0, 0);
 	
+	// contexts may be retired by any of the SA threads; the reference
+	// count is protected by the cache lock
+	(void)vs_lock(&saCache.lock);
 	rc = sa_cache_release(cntxt->cache);
+	(void)vs_unlock(&saCache.lock);
 	
 	IB_EXIT("sa_cache_cntxt_free", rc);
 	return rc;
@@ -1796,7 +1806,7 @@ sa_Authenticate_Path(Lid_t srcLid, Lid_t dstLid) {
         }
     }
 
-    if (tp->cost[Index(i,j)] == Cost_Infinity) {
+    if (sm_cost_get(tp, i, j) == Cost_Infinity) {
         if (saDebugRmpp) IB_LOG_INFINI_INFO("sa_Authenticate_Path: no path from requester to LID ", dstAuth.lid);
     }
 
@@ -2152,8 +2162,7 @@ sa_data_offset(uint16_t class, uint16_t type) {
 	}
 }
 
-char *sa_getAidName(uint16_t aid) {
-	static char num[] = "0x0000";
+char *sa_getAidName(uint16_t aid, char *buf, size_t len) {
     static char *aidName[0x40]={	/* 0x00 to 0x3F */
 		"0x00","CLASSPORTINFO","NOTICE","INFORMINFO","0x4","0x5","0x6","0x7",
 		"0x08","0x09","0x0A","0x0B","0x0C","0x0D","0x0E","0x0F",
@@ -2177,8 +2186,8 @@ char *sa_getAidName(uint16_t aid) {
 	else if (aid == SA_INFORM_RECORD)	/* 0xF3 */
 		return "INFORMINFORECORD";
 	else {
-		sprintf(num, "0x%.2X", aid);
-		return(num);
+		snprintf(buf, len, "0x%.2X", aid);
+		return(buf);
 	}
 }
 
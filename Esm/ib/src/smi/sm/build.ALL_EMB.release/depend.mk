@@ -0,0 +1,30 @@
+include Makefile
+include build.ALL_EMB.release/sm_main.c.dep
+include build.ALL_EMB.release/sm_fsm.c.dep
+include build.ALL_EMB.release/sm_topology.c.dep
+include build.ALL_EMB.release/sm_async.c.dep
+include build.ALL_EMB.release/sm_utility.c.dep
+include build.ALL_EMB.release/sm_topology_rcv.c.dep
+include build.ALL_EMB.release/sm_mkey.c.dep
+include build.ALL_EMB.release/sm_multicast.c.dep
+include build.ALL_EMB.release/sm_control.c.dep
+include build.ALL_EMB.release/sm_userexits.c.dep
+include build.ALL_EMB.release/sm_attribute.c.dep
+include build.ALL_EMB.release/sm_idb.c.dep
+include build.ALL_EMB.release/sm_dbsync.c.dep
+include build.ALL_EMB.release/sm_dbsync_util.c.dep
+include build.ALL_EMB.release/sm_routing.c.dep
+include build.ALL_EMB.release/sm_dispatch.c.dep
+include build.ALL_EMB.release/sm_shortestpath.c.dep
+include build.ALL_EMB.release/sm_dgrouting.c.dep
+include build.ALL_EMB.release/sm_counters.c.dep
+include build.ALL_EMB.release/sm_partMgr.c.dep
+include build.ALL_EMB.release/sm_qos.c.dep
+include build.ALL_EMB.release/sm_ar.c.dep
+include build.ALL_EMB.release/sm_jm.c.dep
+include build.ALL_EMB.release/sm_jm_wire.c.dep
+include build.ALL_EMB.release/sm_buffer_control_tables.c.dep
+include build.ALL_EMB.release/stl_cca.c.dep
+include build.ALL_EMB.release/sm_linux.c.dep
+include build.ALL_EMB.release/sm_diag_ctrl.c.dep
+include build.ALL_EMB.release/sm_statedump.c.dep
@@ -90,6 +90,11 @@ sm_AdaptiveRoutingSwitchUpdate(Topology_t* topop, Node_t* switchp)
 	
 	if (!sm_adaptiveRouting.enable || !switchp->arSupport) return VSTATUS_OK;
 
+	if (switchp->warmStart && !switchp->initPorts.nset_m && !switchp->arChange) {
+		// Restored from the warm start snapshot; already programmed.
+		return status;
+	}
+
 	if (!switchp->initPorts.nset_m &&
 		!switchp->arChange &&
 		bitset_equal(&old_switchesInUse, &new_switchesInUse) &&
@@ -191,7 +196,7 @@ sm_AdaptiveRoutingSwitchUpdate(Topology_t* topop, Node_t* switchp)
 			// AMOD = numBlocks 0000 00[[[[[[current set]]]]]
 			amod = (numBlocks<<24) | currentSet;
 			status = SM_Set_PortGroupFwdTable(fd_topology, amod, path, sm_lid, 
-				dlid, (STL_PORT_GROUP_FORWARDING_TABLE*)&sm_Node_get_pgft_wr(switchp)[currentLid],
+				dlid, (STL_PORT_GROUP_FORWARDING_TABLE*)&sm_Node_get_pgft(switchp)[currentLid],
 				numBlocks, sm_config.mkey);
 
 			if (status != VSTATUS_OK) {
@@ -0,0 +1,382 @@
+/* BEGIN_ICS_COPYRIGHT7 ****************************************
+
+Copyright (c) 2015, Intel Corporation
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Intel Corporation nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+** END_ICS_COPYRIGHT7   ****************************************/
+
+/* [ICS VERSION STRING: unknown] */
+
+//
+// Per-sweep topology arena.
+//
+// Each Topology_t owns an arena from which its nodes, port data and node
+// descriptions are allocated.  Forwarding tables are not: they are shared
+// between sweeps (see sm_lft.c) and so come from sm_pool.  Small blocks are carved
+// out of large chunks with a bump pointer; blocks freed while the topology is
+// still live go on per size class free lists and are reused by later
+// allocations.  Blocks too large to share a chunk are allocated on their own
+// but are still owned by the arena.  When the topology is retired the whole
+// arena is released in one pass over its chunks instead of one pool free per
+// object.
+//
+// Every block is preceded by a small header naming the owning arena, so
+// sm_arena_free() needs only the pointer, and memory allocated for one
+// topology can be released through whichever topology it ends up in.
+//
+
+#include "ib_types.h"
+#include "sm_l.h"
+#ifndef __VXWORKS__
+#include <sys/resource.h>
+#endif
+
+#define SM_ARENA_ALIGN			16
+#define SM_ARENA_CHUNK_SIZE		(1024 * 1024)
+#define SM_ARENA_MAX_SMALL		(SM_ARENA_CHUNK_SIZE / 4)
+
+// Free list k holds blocks of [2^(k+4), 2^(k+5)) bytes.
+#define SM_ARENA_MIN_SHIFT		4
+#define SM_ARENA_CLASSES		16
+
+#define SM_ARENA_ROUNDUP(x)		(((x) + SM_ARENA_ALIGN - 1) & ~((size_t)SM_ARENA_ALIGN - 1))
+
+#define SM_ARENA_BLOCK_LARGE	0x1
+
+typedef struct _SmArenaBlock {
+	struct _SmArena	*arena;
+	uint32_t		size;		// usable bytes following the header
+	uint32_t		flags;
+} SmArenaBlock_t;
+
+typedef struct _SmArenaLarge {
+	struct _SmArenaLarge	*next;
+	struct _SmArenaLarge	*prev;
+} SmArenaLarge_t;
+
+typedef struct _SmArenaChunk {
+	struct _SmArenaChunk	*next;
+} SmArenaChunk_t;
+
+#define SM_ARENA_HDR_SIZE		SM_ARENA_ROUNDUP(sizeof(SmArenaBlock_t))
+#define SM_ARENA_LARGE_SIZE		SM_ARENA_ROUNDUP(sizeof(SmArenaLarge_t))
+#define SM_ARENA_CHUNK_HDR_SIZE	SM_ARENA_ROUNDUP(sizeof(SmArenaChunk_t))
+
+typedef struct _SmArenaFree {
+	struct _SmArenaFree	*next;
+} SmArenaFree_t;
+
+struct _SmArena {
+	Lock_t			lock;
+	SmArenaChunk_t	*chunks;
+	SmArenaLarge_t	*large;
+	uint8_t			*bump;			// next free byte of the current chunk
+	uint8_t			*bumpEnd;
+	SmArenaFree_t	*freeList[SM_ARENA_CLASSES];
+	SmArenaStats_t	stats;
+};
+
+#define SM_ARENA_BLOCK(p)		((SmArenaBlock_t *)((uint8_t *)(p) - SM_ARENA_HDR_SIZE))
+#define SM_ARENA_PAYLOAD(b)		((void *)((uint8_t *)(b) + SM_ARENA_HDR_SIZE))
+
+// floor(log2(size)) relative to the smallest class
+static __inline__ uint32_t
+sm_arena_class_floor(size_t size)
+{
+	uint32_t cls = 0;
+
+	size >>= SM_ARENA_MIN_SHIFT + 1;
+	while (size && cls < SM_ARENA_CLASSES - 1) {
+		size >>= 1;
+		cls++;
+	}
+	return cls;
+}
+
+// smallest class whose blocks are all at least size bytes
+static __inline__ uint32_t
+sm_arena_class_ceil(size_t size)
+{
+	uint32_t cls = sm_arena_class_floor(size);
+
+	if (((size_t)1 << (cls + SM_ARENA_MIN_SHIFT)) < size)
+		cls++;
+	return cls;
+}
+
+static void
+sm_arena_push_free(SmArena_t *arena, SmArenaBlock_t *block)
+{
+	SmArenaFree_t *f = (SmArenaFree_t *)SM_ARENA_PAYLOAD(block);
+	uint32_t cls = sm_arena_class_floor(block->size);
+
+	f->next = arena->freeList[cls];
+	arena->freeList[cls] = f;
+}
+
+// Start a new chunk, returning the unused tail of the current one to the
+// free lists so it is not lost.
+static Status_t
+sm_arena_new_chunk(SmArena_t *arena)
+{
+	SmArenaChunk_t *chunk;
+	size_t left = arena->bumpEnd - arena->bump;
+	Status_t status;
+
+	if (left >= SM_ARENA_HDR_SIZE + SM_ARENA_ALIGN) {
+		SmArenaBlock_t *block = (SmArenaBlock_t *)arena->bump;
+
+		block->arena = arena;
+		block->size = (uint32_t)(left - SM_ARENA_HDR_SIZE);
+		block->flags = 0;
+		sm_arena_push_free(arena, block);
+	}
+
+	status = vs_pool_alloc(&sm_pool, SM_ARENA_CHUNK_SIZE, (void *)&chunk);
+	if (status != VSTATUS_OK)
+		return status;
+
+	chunk->next = arena->chunks;
+	arena->chunks = chunk;
+	arena->bump = (uint8_t *)chunk + SM_ARENA_CHUNK_HDR_SIZE;
+	arena->bumpEnd = (uint8_t *)chunk + SM_ARENA_CHUNK_SIZE;
+	arena->stats.reservedBytes += SM_ARENA_CHUNK_SIZE;
+	return VSTATUS_OK;
+}
+
+static SmArenaBlock_t *
+sm_arena_alloc_large(SmArena_t *arena, size_t size)
+{
+	SmArenaLarge_t *large;
+	SmArenaBlock_t *block;
+
+	if (vs_pool_alloc(&sm_pool, SM_ARENA_LARGE_SIZE + SM_ARENA_HDR_SIZE + size,
+					  (void *)&large) != VSTATUS_OK)
+		return NULL;
+
+	large->prev = NULL;
+	large->next = arena->large;
+	if (arena->large)
+		arena->large->prev = large;
+	arena->large = large;
+
+	block = (SmArenaBlock_t *)((uint8_t *)large + SM_ARENA_LARGE_SIZE);
+	block->arena = arena;
+	block->size = (uint32_t)size;
+	block->flags = SM_ARENA_BLOCK_LARGE;
+	arena->stats.reservedBytes += size;
+	return block;
+}
+
+static SmArenaBlock_t *
+sm_arena_alloc_small(SmArena_t *arena, size_t size)
+{
+	SmArenaBlock_t *block;
+	uint32_t cls = sm_arena_class_ceil(size);
+
+	if (cls < SM_ARENA_CLASSES && arena->freeList[cls]) {
+		SmArenaFree_t *f = arena->freeList[cls];
+
+		arena->freeList[cls] = f->next;
+		arena->stats.reused++;
+		return SM_ARENA_BLOCK(f);
+	}
+
+	if ((size_t)(arena->bumpEnd - arena->bump) < SM_ARENA_HDR_SIZE + size) {
+		if (sm_arena_new_chunk(arena) != VSTATUS_OK)
+			return NULL;
+	}
+
+	block = (SmArenaBlock_t *)arena->bump;
+	arena->bump += SM_ARENA_HDR_SIZE + size;
+	block->arena = arena;
+	block->size = (uint32_t)size;
+	block->flags = 0;
+	return block;
+}
+
+Status_t
+sm_arena_create(SmArena_t **arenap)
+{
+	SmArena_t *arena;
+	Status_t status;
+
+	IB_ENTER(__func__, arenap, 0, 0, 0);
+
+	*arenap = NULL;
+
+	status = vs_pool_alloc(&sm_pool, sizeof(SmArena_t), (void *)&arena);
+	if (status != VSTATUS_OK) {
+		IB_LOG_ERRORRC("can't allocate topology arena rc:", status);
+		IB_EXIT(__func__, status);
+		return status;
+	}
+	memset(arena, 0, sizeof(SmArena_t));
+
+	status = vs_lock_init(&arena->lock, VLOCK_FREE, VLOCK_THREAD);
+	if (status != VSTATUS_OK) {
+		IB_LOG_ERRORRC("can't initialize topology arena lock rc:", status);
+		(void)vs_pool_free(&sm_pool, arena);
+		IB_EXIT(__func__, status);
+		return status;
+	}
+
+	*arenap = arena;
+
+	IB_EXIT(__func__, VSTATUS_OK);
+	return VSTATUS_OK;
+}
+
+void
+sm_arena_destroy(SmArena_t *arena)
+{
+	SmArenaChunk_t *chunk;
+	SmArenaLarge_t *large;
+
+	if (arena == NULL)
+		return;
+
+	while ((chunk = arena->chunks) != NULL) {
+		arena->chunks = chunk->next;
+		(void)vs_pool_free(&sm_pool, chunk);
+	}
+
+	while ((large = arena->large) != NULL) {
+		arena->large = large->next;
+		(void)vs_pool_free(&sm_pool, large);
+	}
+
+	(void)vs_lock_delete(&arena->lock);
+	(void)vs_pool_free(&sm_pool, arena);
+}
+
+Status_t
+sm_arena_alloc(SmArena_t *arena, size_t length, void **loc)
+{
+	SmArenaBlock_t *block;
+	size_t size;
+
+	if (arena == NULL || loc == NULL || length == 0)
+		return VSTATUS_ILLPARM;
+
+	size = SM_ARENA_ROUNDUP(length);
+
+	if (vs_lock(&arena->lock) != VSTATUS_OK)
+		return VSTATUS_NXIO;
+
+	if (size > SM_ARENA_MAX_SMALL)
+		block = sm_arena_alloc_large(arena, size);
+	else
+		block = sm_arena_alloc_small(arena, size);
+
+	if (block == NULL) {
+		(void)vs_unlock(&arena->lock);
+		*loc = NULL;
+		return VSTATUS_NOMEM;
+	}
+
+	arena->stats.allocs++;
+	arena->stats.inUseBytes += block->size;
+	if (arena->stats.inUseBytes > arena->stats.peakBytes)
+		arena->stats.peakBytes = arena->stats.inUseBytes;
+
+	(void)vs_unlock(&arena->lock);
+
+	// same contract as vs_pool_alloc(): the memory is returned zeroed
+	memset(SM_ARENA_PAYLOAD(block), 0, block->size);
+	*loc = SM_ARENA_PAYLOAD(block);
+	return VSTATUS_OK;
+}
+
+Status_t
+sm_arena_free(void *p)
+{
+	SmArenaBlock_t *block;
+	SmArena_t *arena;
+
+	if (p == NULL)
+		return VSTATUS_ILLPARM;
+
+	block = SM_ARENA_BLOCK(p);
+	arena = block->arena;
+
+	if (vs_lock(&arena->lock) != VSTATUS_OK)
+		return VSTATUS_NXIO;
+
+	arena->stats.frees++;
+	arena->stats.inUseBytes -= block->size;
+
+	if (block->flags & SM_ARENA_BLOCK_LARGE) {
+		SmArenaLarge_t *large = (SmArenaLarge_t *)((uint8_t *)block - SM_ARENA_LARGE_SIZE);
+
+		if (large->prev)
+			large->prev->next = large->next;
+		else
+			arena->large = large->next;
+		if (large->next)
+			large->next->prev = large->prev;
+		arena->stats.reservedBytes -= block->size;
+		(void)vs_unlock(&arena->lock);
+		(void)vs_pool_free(&sm_pool, large);
+		return VSTATUS_OK;
+	}
+
+	sm_arena_push_free(arena, block);
+
+	(void)vs_unlock(&arena->lock);
+	return VSTATUS_OK;
+}
+
+SmArena_t *
+sm_arena_owner(void *p)
+{
+	return (p == NULL) ? NULL : SM_ARENA_BLOCK(p)->arena;
+}
+
+void
+sm_arena_get_stats(SmArena_t *arena, SmArenaStats_t *stats)
+{
+	if (arena == NULL) {
+		memset(stats, 0, sizeof(*stats));
+		return;
+	}
+
+	(void)vs_lock(&arena->lock);
+	*stats = arena->stats;
+	(void)vs_unlock(&arena->lock);
+}
+
+// Peak resident set size of the SM process in KB, or 0 if not available.
+uint32_t
+sm_arena_peak_rss_kb(void)
+{
+#ifndef __VXWORKS__
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		return (uint32_t)usage.ru_maxrss;
+#endif
+	return 0;
+}
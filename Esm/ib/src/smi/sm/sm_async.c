@@ -468,6 +468,7 @@ async_main(uint32_t argc, uint8_t ** argv) {
 			
 			// May be set to INTERVAL_CHANGE in sm_SetSweepRate
 			setResweepReason(SM_SWEEP_REASON_FORCED);
+			sm_light_sweep_force_full();
 
             /* force wakeup of topology thread now if waiting on semaphore */
             if (sm_config.timer != 0 && topology_wakeup_time > 0ull) 
@@ -502,6 +503,7 @@ async_main(uint32_t argc, uint8_t ** argv) {
 			} else {
 				if (portInfo.PortStates.s.PortState <= IB_PORT_INIT) {
 					smFabricDiscoveryNeeded = 1;
+					sm_light_sweep_force_full();
 				}
 			}
 			lastTimePortChecked = now;	
@@ -258,6 +258,10 @@ sm_counter_t smCounters[smCountersMax] = {
 	[smCounterSaDroppedRequests]        = { "SA DROPPED REQUESTS", 0, 0, 0 },
 	[smCounterSaContextNotAvailable]    = { "SA NO AVAILABLE CONTEXTS", 0, 0, 0 },
 
+	// PathRecord cache
+	[smCounterSaPathRecordCacheHits]    = { "SA PathRecord Cache Hits", 0, 0, 0 },
+	[smCounterSaPathRecordCacheMisses]  = { "SA PathRecord Cache Misses", 0, 0, 0 },
+
 	// GetMulti Request stuff
 	[smCounterSaGetMultiNonRmpp]        = { "SA RX GETMULTI() Non-RMPP", 0, 0, 0 },
 	[smCounterSaRxGetMultiInboundRmppAbort] = { "SA RX GETMULTI RMPP Abort", 0, 0, 0 },
@@ -328,8 +332,51 @@ sm_counter_t smPeakCounters[smPeakCountersMax] = {
 	[smMaxSaContextsInUse]              = { "SA Maximum Contexts In Use", 0, 0, 0},
 	[smMaxSaContextsFree]              = { "SA Maximum Contexts Free", 0, 0, 0},
 	[smMaxSweepTime]                   = { "Maximum SM Sweep Time in ms", 0, 0, 0},
+	[smMaxSweepAllocs]                 = { "Maximum Topology Allocations per Sweep", 0, 0, 0},
+	[smMaxSweepFrees]                  = { "Maximum Topology Frees per Sweep", 0, 0, 0},
+	[smMaxSweepArenaKb]                = { "Maximum Topology Memory in KB", 0, 0, 0},
+	[smMaxRssKb]                       = { "Peak SM Resident Set Size in KB", 0, 0, 0},
+	[smMaxSaPathRecordCacheEntries]    = { "SA Maximum PathRecord Cache Entries", 0, 0, 0},
+};
+
+//
+// Sweep phase profile; see sm_counters.h.
+//
+typedef enum {
+	smProfileTime,			// usecs
+	smProfileMads,
+	smProfileRetries,
+	smProfileAllocs,
+
+	smProfileMetrics
+} sm_profile_metric_t;
+
+static const char * smProfileMetricNames[smProfileMetrics] = {
+	[smProfileTime]    = "Time (ms)",
+	[smProfileMads]    = "MADs",
+	[smProfileRetries] = "Retries",
+	[smProfileAllocs]  = "Allocs",
 };
 
+typedef struct _sm_profile_phase {
+	const char * name;
+	uint32_t sweeps;		// samples recorded since the last reset
+	uint32_t sample[SM_PROFILE_WINDOW][smProfileMetrics];
+} sm_profile_phase_t;
+
+typedef struct _sm_profile_attr {
+	ATOMIC_UINT aid;		// attribute id + 1, 0 while the slot is unused
+	ATOMIC_UINT maxUsecs;
+	ATOMIC_UINT hist[SM_PROFILE_BUCKETS];
+} sm_profile_attr_t;
+
+// phase samples are only written by the topology thread, the lock keeps
+// a concurrent fm_cmd query from seeing a half written sample
+static sm_profile_phase_t smProfilePhases[SM_PROFILE_MAX_PHASES];
+static sm_profile_attr_t smProfileAttrs[SM_PROFILE_MAX_ATTRS];
+static Lock_t smProfileLock;
+static int smProfileLockInit = 0;
+
 //
 // Initialize SM counters
 //
@@ -341,6 +388,11 @@ void sm_init_counters(void) {
 		AtomicWrite(&smCounters[i].total, 0);
 	}
 
+	if (!smProfileLockInit &&
+		vs_lock_init(&smProfileLock, VLOCK_FREE, VLOCK_THREAD) == VSTATUS_OK) {
+		smProfileLockInit = 1;
+	}
+
 	if (VSTATUS_OK != vs_stdtime_get(&smCountersClearedTime)) {
 		smCountersClearedTime = 0;
 	}
@@ -386,6 +438,13 @@ void sm_reset_counters(void) {
 		AtomicWrite(&smPeakCounters[i].total, 0);
 	}
 
+	if (smProfileLockInit) {
+		(void)vs_lock(&smProfileLock);
+		memset(smProfilePhases, 0, sizeof(smProfilePhases));
+		(void)vs_unlock(&smProfileLock);
+	}
+	memset(smProfileAttrs, 0, sizeof(smProfileAttrs));
+
 	if (VSTATUS_OK != vs_stdtime_get(&smCountersClearedTime)) {
 		smCountersClearedTime = 0;
 	}
@@ -545,6 +604,201 @@ char * sm_print_counters_to_buf(void) {
 }
 #endif
 
+//
+// Bucket 0 counts zero, bucket i counts [2^(i-1), 2^i) and the last bucket
+// counts everything above that.
+//
+static int sm_profile_bucket(uint64_t value) {
+	int bucket = 0;
+
+	while (value && bucket < SM_PROFILE_BUCKETS - 1) {
+		value >>= 1;
+		++bucket;
+	}
+	return bucket;
+}
+
+void sm_profile_phase_begin(sm_profile_mark_t * mark) {
+	SmArenaStats_t stats;
+
+	(void)vs_time_get(&mark->start);
+	mark->mads = AtomicRead(&smCounters[smCounterSmPacketTransmits].sinceLastSweep);
+	mark->retries = AtomicRead(&smCounters[smCounterPacketRetransmits].sinceLastSweep);
+	mark->arena = sm_topop ? sm_topop->arena : NULL;
+	sm_arena_get_stats(mark->arena, &stats);
+	mark->allocs = stats.allocs;
+}
+
+void sm_profile_phase_end(int phase, const char * name, const sm_profile_mark_t * mark) {
+	sm_profile_phase_t * p;
+	SmArenaStats_t stats;
+	SmArena_t * arena;
+	uint32_t * sample;
+	uint64_t now;
+
+	if (phase < 0 || phase >= SM_PROFILE_MAX_PHASES || !smProfileLockInit)
+		return;
+
+	(void)vs_time_get(&now);
+	arena = sm_topop ? sm_topop->arena : NULL;
+	sm_arena_get_stats(arena, &stats);
+
+	(void)vs_lock(&smProfileLock);
+	p = &smProfilePhases[phase];
+	p->name = name;
+	sample = p->sample[p->sweeps % SM_PROFILE_WINDOW];
+	sample[smProfileTime] = (uint32_t)(now - mark->start);
+	sample[smProfileMads] =
+		AtomicRead(&smCounters[smCounterSmPacketTransmits].sinceLastSweep) - mark->mads;
+	sample[smProfileRetries] =
+		AtomicRead(&smCounters[smCounterPacketRetransmits].sinceLastSweep) - mark->retries;
+	// discovery may start a new topology, in which case count all of it
+	sample[smProfileAllocs] = (uint32_t)((arena == mark->arena)
+		? stats.allocs - mark->allocs : stats.allocs);
+	++p->sweeps;
+	(void)vs_unlock(&smProfileLock);
+}
+
+//
+// Called for every response matched to an outstanding SM request, possibly
+// from several threads at once, so the table is claimed and updated with
+// atomics only.  Attributes beyond SM_PROFILE_MAX_ATTRS are not recorded.
+//
+void sm_profile_mad_rtt(uint16_t aid, uint64_t usecs) {
+	sm_profile_attr_t * attr = NULL;
+	uint32_t key = (uint32_t)aid + 1;
+	uint32_t slot, tmp, value;
+	int i;
+
+	for (i = 0, slot = aid % SM_PROFILE_MAX_ATTRS; i < SM_PROFILE_MAX_ATTRS;
+		 ++i, slot = (slot + 1) % SM_PROFILE_MAX_ATTRS) {
+		tmp = AtomicRead(&smProfileAttrs[slot].aid);
+		if (tmp == 0) {
+			if (AtomicCompareStore(&smProfileAttrs[slot].aid, 0, key))
+				tmp = key;
+			else
+				tmp = AtomicRead(&smProfileAttrs[slot].aid);
+		}
+		if (tmp == key) {
+			attr = &smProfileAttrs[slot];
+			break;
+		}
+	}
+	if (!attr)
+		return;
+
+	AtomicIncrementVoid(&attr->hist[sm_profile_bucket(usecs)]);
+
+	value = (usecs > 0xffffffff) ? 0xffffffff : (uint32_t)usecs;
+	do {
+		tmp = AtomicRead(&attr->maxUsecs);
+	} while (value > tmp && !AtomicCompareStore(&attr->maxUsecs, tmp, value));
+}
+
+#ifndef __VXWORKS__
+
+static char * sm_profile_print_hist(char * buf, int * len, const uint32_t * hist) {
+	int i;
+
+	for (i = 0; i < SM_PROFILE_BUCKETS; ++i) {
+		if (!hist[i])
+			continue;
+		if (i == SM_PROFILE_BUCKETS - 1)
+			buf = snprintfcat(buf, len, " >=%u:%u", 1u << (i - 1), hist[i]);
+		else
+			buf = snprintfcat(buf, len, " <%u:%u", 1u << i, hist[i]);
+	}
+	return snprintfcat(buf, len, "\n");
+}
+
+//
+// prints the sweep phase profile to a dynamically allocated buffer - user
+// is responsible for freeing it using vs_pool_free()
+//
+char * sm_print_profile_to_buf(void) {
+	sm_profile_phase_t * p;
+	sm_profile_attr_t * attr;
+	char * buf = NULL;
+	int len = 1024;
+	int i, m, n, count;
+	uint32_t value, min, max, hist[SM_PROFILE_BUCKETS];
+	uint64_t sum;
+
+	if (vs_pool_alloc(&sm_pool, len, (void*)&buf) != VSTATUS_OK) {
+		IB_FATAL_ERROR("sm_print_profile_to_buf: CAN'T ALLOCATE SPACE.");
+		return NULL;
+	}
+
+	snprintf(buf, len, "Sweep phases, last %d sweeps per phase:\n", SM_PROFILE_WINDOW);
+	buf = snprintfcat(buf, &len, "%-14s %-10s %10s %10s %10s %10s\n",
+		"PHASE", "METRIC", "LAST", "MIN", "AVG", "MAX");
+	buf = snprintfcat(buf, &len, "-------------- ---------- "
+	                             "---------- ---------- ---------- ----------\n");
+
+	if (smProfileLockInit)
+		(void)vs_lock(&smProfileLock);
+	for (i = 0; i < SM_PROFILE_MAX_PHASES && buf; ++i) {
+		p = &smProfilePhases[i];
+		if (!p->sweeps)
+			continue;
+		count = MIN(p->sweeps, SM_PROFILE_WINDOW);
+
+		for (m = 0; m < smProfileMetrics; ++m) {
+			min = 0xffffffff;
+			max = 0;
+			sum = 0;
+			for (n = 0; n < count; ++n) {
+				value = p->sample[n][m];
+				if (m == smProfileTime)
+					value /= 1000;
+				min = MIN(min, value);
+				max = MAX(max, value);
+				sum += value;
+			}
+			value = p->sample[(p->sweeps - 1) % SM_PROFILE_WINDOW][m];
+			if (m == smProfileTime)
+				value /= 1000;
+			buf = snprintfcat(buf, &len, "%-14s %-10s %10u %10u %10u %10u\n",
+				m == 0 ? p->name : "", smProfileMetricNames[m],
+				value, min, (uint32_t)(sum / count), max);
+		}
+
+		memset(hist, 0, sizeof(hist));
+		for (n = 0; n < count; ++n)
+			++hist[sm_profile_bucket(p->sample[n][smProfileTime] / 1000)];
+		buf = snprintfcat(buf, &len, "%-14s %-10s", "", "ms hist");
+		buf = sm_profile_print_hist(buf, &len, hist);
+	}
+	if (smProfileLockInit)
+		(void)vs_unlock(&smProfileLock);
+
+	if (!buf)
+		return NULL;
+
+	buf = snprintfcat(buf, &len, "\nMAD round trip times in usecs:\n");
+	buf = snprintfcat(buf, &len, "%-24s %10s %10s  %s\n",
+		"ATTRIBUTE", "COUNT", "MAX", "HISTOGRAM");
+	buf = snprintfcat(buf, &len, "------------------------ "
+	                             "---------- ----------  ---------\n");
+	for (i = 0; i < SM_PROFILE_MAX_ATTRS && buf; ++i) {
+		attr = &smProfileAttrs[i];
+		value = AtomicRead(&attr->aid);
+		if (!value)
+			continue;
+		sum = 0;
+		for (n = 0; n < SM_PROFILE_BUCKETS; ++n) {
+			hist[n] = AtomicRead(&attr->hist[n]);
+			sum += hist[n];
+		}
+		buf = snprintfcat(buf, &len, "%-24s %10"CS64u" %10u ",
+			sm_getAttributeIdText(value - 1), sum, AtomicRead(&attr->maxUsecs));
+		buf = sm_profile_print_hist(buf, &len, hist);
+	}
+
+	return buf;
+}
+#endif
+
 #ifdef __VXWORKS__
 void sm_print_counters_to_stream(FILE * out) {
 	int i = 0;
@@ -1307,8 +1307,7 @@ static Status_t processGroupSync(Mai_t *maip, uint8_t *msgbuf, uint32_t reclen)
             /* create the group */
             (void)vs_lock(&sm_McGroups_lock);
             if ((status = sm_multicast_sync_lid(*((IB_GID*)mcgs.mGid), mcgs.pKey, mcgs.mtu, mcgs.rate, mcgs.mLid)) == VSTATUS_OK) {
-                McGroup_Create(mcGroup);
-                memcpy(&(mcGroup->mGid), &(mcgs.mGid), sizeof(IB_GID));
+                McGroup_Create(mcGroup, mcgs.mGid);
                 mcGroup->members_full = mcgs.members_full;
                 mcGroup->qKey = mcgs.qKey;
                 mcGroup->pKey = mcgs.pKey;
@@ -1327,14 +1326,14 @@ static Status_t processGroupSync(Mai_t *maip, uint8_t *msgbuf, uint32_t reclen)
 				    BSWAPCOPY_STL_MCMEMBER_SYNCDB((STL_MCMEMBER_SYNCDB*)&msgbuf[bufidx], &mcms);
                     bufidx += sizeof(STL_MCMEMBER_SYNCDB);
                     ++memcnt;
-                    McMember_Create(mcGroup, mcMember);
+                    McMember_Create(mcGroup, mcMember, mcms.member.RID.PortGID);
                     mcMember->slid = mcms.slid;
                     mcMember->proxy = mcms.proxy;
                     mcMember->state = mcms.state;
                     mcMember->nodeGuid = mcms.nodeGuid;
                     mcMember->portGuid = mcms.portGuid;
                     mcMember->record = mcms.member;
-                    mcMember->index = mcms.index;
+                    sm_multicast_set_member_index(mcGroup, mcMember, mcms.index);
                 }
 				// Remove this usage once ib_sa.h:McGroupSync_t:mGid changes type
                 IB_LOG_INFO_FMT(__func__,
@@ -1388,8 +1387,7 @@ static Status_t processGroupSync(Mai_t *maip, uint8_t *msgbuf, uint32_t reclen)
             }
             /* create the group with members */
             if ((status = sm_multicast_sync_lid(*((IB_GID*)mcgs.mGid), mcgs.pKey, mcgs.mtu, mcgs.rate, mcgs.mLid)) == VSTATUS_OK) {
-                McGroup_Create(mcGroup);
-                memcpy(&(mcGroup->mGid), &(mcgs.mGid), sizeof(IB_GID));
+                McGroup_Create(mcGroup, mcgs.mGid);
                 mcGroup->members_full = mcgs.members_full;
                 mcGroup->qKey = mcgs.qKey;
                 mcGroup->pKey = mcgs.pKey;
@@ -1407,14 +1405,14 @@ static Status_t processGroupSync(Mai_t *maip, uint8_t *msgbuf, uint32_t reclen)
                 while (bufidx < reclen && memcnt < mcgs.membercount) {
         		    BSWAPCOPY_STL_MCMEMBER_SYNCDB((STL_MCMEMBER_SYNCDB*)&msgbuf[bufidx], &mcms);
                     bufidx += sizeof(STL_MCMEMBER_SYNCDB);
-                    McMember_Create(mcGroup, mcMember);
+                    McMember_Create(mcGroup, mcMember, mcms.member.RID.PortGID);
                     mcMember->slid = mcms.slid;
                     mcMember->proxy = mcms.proxy;
                     mcMember->state = mcms.state;
                     mcMember->nodeGuid = mcms.nodeGuid;
                     mcMember->portGuid = mcms.portGuid;
                     mcMember->record = mcms.member;
-                    mcMember->index = mcms.index;
+                    sm_multicast_set_member_index(mcGroup, mcMember, mcms.index);
                 }
                 (void)vs_rdlock(&old_topology_lock);
                 VirtualFabrics_t *VirtualFabrics = old_topology.vfs_ptr;
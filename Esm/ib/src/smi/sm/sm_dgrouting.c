@@ -380,7 +380,7 @@ dgmh_calculate_lft(Topology_t * topop, Node_t * switchp)
 			}
 
 			for_all_port_lids(portp, portLid) {
-				switchp->lft[portLid] = xftPorts[portLid - pdp->lid];
+				sm_lft_set_port(switchp, portLid, xftPorts[portLid - pdp->lid]);
 				IB_LOG_DEBUG4_FMT(__func__, "Setting LID %u to egress port %u", 
 					portLid, xftPorts[portLid - pdp->lid]);
 			}
@@ -479,7 +479,7 @@ dgmh_calculate_all_lfts(Topology_t * topop)
 				}
 
 				for_all_port_lids(portp, portLid) {
-					switchp->lft[portLid] = xftPorts[portLid - pdp->lid];
+					sm_lft_set_port(switchp, portLid, xftPorts[portLid - pdp->lid]);
 					IB_LOG_DEBUG4_FMT(__func__, "Setting LID %u to egress port %u", 
 						portLid, xftPorts[portLid - pdp->lid]);
 				}
@@ -489,6 +489,77 @@ dgmh_calculate_all_lfts(Topology_t * topop)
 	return status;
 }
 
+/*
+ * Parallel version of dgmh_calculate_all_lfts(), the destinations are
+ * handed to the shortestpath parallel calculation in device group order.
+ */
+static Status_t
+dgmh_calculate_all_lfts_parallel(Topology_t * topop)
+{
+	DGTopology 	*dgp = topop->routingModule->data;
+	cl_map_item_t *qp;
+	LftDest_t	*dests;
+	uint32_t	numDests = 0;
+	Status_t status = VSTATUS_OK;
+	int i, end;
+
+	end = (dgp->allGroup<dgp->dgCount)?dgp->dgCount:dgp->allGroup+1;
+
+	for (i=0; i<end; i++)
+		numDests += cl_qmap_count(&(dgp->deviceGroup[i]));
+	if (numDests == 0)
+		return sm_shortestpath_calculate_all_lfts_parallel(topop, NULL, 0, 0);
+
+	if (vs_pool_alloc(&sm_pool, numDests * sizeof(LftDest_t), (void *)&dests) != VSTATUS_OK) {
+		IB_LOG_ERROR_FMT(__func__, "Failed to allocate LFT destination list.");
+		return VSTATUS_NOMEM;
+	}
+	numDests = 0;
+
+	for (i=0; (i<end) && (status == VSTATUS_OK); i++) {
+		for (qp = cl_qmap_head(&(dgp->deviceGroup[i])); 
+			(status == VSTATUS_OK) && (qp != cl_qmap_end(&(dgp->deviceGroup[i])));
+			qp = cl_qmap_next(qp)) {
+			PortData_t 	*pdp;
+			Node_t 		*nodep;
+			Port_t 		*portp;
+			DGItem 		*dgip;
+
+			dgip = (DGItem*)PARENT_STRUCT(qp, DGItem, mapItem);
+			portp = dgip->port;
+			if (!portp) {
+				IB_LOG_ERROR_FMT(__func__, "Unable to map DG entry to device port structure.");
+				status = VSTATUS_BAD;
+				break;
+			}
+			pdp = portp->portData;
+			if (!pdp) {
+				IB_LOG_ERROR_FMT(__func__, "Unable to map DG entry to device port data.");
+				status = VSTATUS_BAD;
+				break;
+			}
+
+			nodep = pdp->nodePtr;
+
+			// skip dead ports.
+			if ((nodep == NULL) ||  (!sm_valid_port(portp)) ||
+				(portp->state == IB_PORT_DOWN)) {
+				continue;
+			}
+
+			dests[numDests].nodep = nodep;
+			dests[numDests].portp = portp;
+			numDests++;
+		}
+	}
+
+	if (status == VSTATUS_OK)
+		status = sm_shortestpath_calculate_all_lfts_parallel(topop, dests, numDests, 0);
+
+	vs_pool_free(&sm_pool, dests);
+	return status;
+}
+
 static Status_t
 _init_switch_lfts_dg(Topology_t * topop, int * routing_needed, int * rebalance)
 {
@@ -501,7 +572,10 @@ _init_switch_lfts_dg(Topology_t * topop, int * routing_needed, int * rebalance)
 	if (*routing_needed) {
 		// A topology change was indicated.  Re-calculate lfts with big hammer (rebalance).
 		// If not, copy and delta updates handled by main topology method.
-		s = dgmh_calculate_all_lfts(topop);
+		if (sm_config.parallel_lft)
+			s = dgmh_calculate_all_lfts_parallel(topop);
+		else
+			s = dgmh_calculate_all_lfts(topop);
 		*rebalance = 1;
 	}
 
@@ -597,6 +597,17 @@ fm_msg_ret_code_t sm_diag_ctrl(fm_config_datagram_t *msg) {
 		}
 		break;
 
+	case FM_DT_SM_GET_SWEEP_PROFILE:
+		tmpData = sm_print_profile_to_buf();
+		if (tmpData != NULL) {
+			length = strlen(tmpData) + 1;
+
+			memcpy(&msg->data[0], tmpData, MIN(msg->header.data_len, length));
+			msg->data[msg->header.data_len - 1] = '\0';
+			vs_pool_free(&sm_pool, tmpData);
+		}
+		break;
+
 	case FM_DT_SM_RESET_COUNTERS:
 		sm_reset_counters();
 		break;
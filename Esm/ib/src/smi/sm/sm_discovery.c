@@ -0,0 +1,568 @@
+/* BEGIN_ICS_COPYRIGHT7 ****************************************
+
+Copyright (c) 2015, Intel Corporation
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Intel Corporation nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+** END_ICS_COPYRIGHT7   ****************************************/
+
+/* [ICS VERSION STRING: unknown] */
+
+//
+// Pipelined discovery (sm_config.pipelined_discovery).
+//
+// topology_discovery() walks the node list, which is in breadth first order,
+// and calls sm_setup_node() for every unexplored port.  Each of those starts
+// with a directed route Get(NodeInfo) and, for a node not yet seen in this
+// sweep, a Get(NodeDescription), each a full round trip.  When the walk
+// reaches the first node of a new hop level, sm_discovery_prefetch_level()
+// sends those requests for every candidate port of the whole level through
+// the async dispatcher, so up to MaxParallelReqs of them are on the wire at
+// once.  Responses are decoded into the prefetch table by the dispatcher
+// callback as they arrive.  sm_setup_node() then takes its NodeInfo and
+// NodeDescription from the table and only falls back to a synchronous get
+// when a prefetch is missing or failed.  The nodes themselves are still set
+// up one at a time in the original order, so node and port numbering, and
+// hence routing, are exactly as without prefetch.
+//
+
+#include "ib_types.h"
+#include "sm_counters.h"
+#include "sm_l.h"
+
+#define SM_DISC_PF_NONE		0
+#define SM_DISC_PF_PENDING	1
+#define SM_DISC_PF_VALID	2
+#define SM_DISC_PF_FAILED	3
+
+typedef struct {
+	cl_map_item_t	mapItem;		// keyed on parent node index and port
+	uint8_t			niState;
+	uint8_t			ndState;
+	uint8_t			path[64];
+	STL_NODE_INFO	nodeInfo;
+	STL_NODE_DESCRIPTION nodeDesc;
+} SmDiscPrefetch_t;
+
+// the table and tag are protected by sm_async_send_rcv_cntxt.lock, the map is
+// only used by the topology thread
+static SmDiscPrefetch_t *sm_disc_pf = NULL;
+static uint32_t sm_disc_pf_size = 0;
+static uint32_t sm_disc_pf_count = 0;
+static uint32_t sm_disc_pf_tag = 0;
+static cl_qmap_t sm_disc_pf_map;
+static int sm_disc_pf_mapInit = 0;
+
+static __inline__ uint64_t
+sm_discovery_key(Node_t *cnp, Port_t *cpp)
+{
+	return ((uint64_t)cnp->index << 8) | cpp->index;
+}
+
+// active ports of a switch trusted by a light sweep are set up from the old
+// topology without asking the neighbor anything
+static __inline__ int
+sm_discovery_candidate(Node_t *nodep, Port_t *portp)
+{
+	return portp != NULL && portp->state > IB_PORT_DOWN
+		&& (portp->nodeno == -1 || portp->portno == -1)
+		&& !(nodep->lightTrusted && portp->state == IB_PORT_ACTIVE);
+}
+
+// called with sm_async_send_rcv_cntxt.lock held
+static void
+sm_discovery_resp(sm_dispatch_req_t *req, Status_t status, Mai_t *mad)
+{
+	uint32_t i = (uint32_t)(uintptr_t)req->respData;
+	SmDiscPrefetch_t *pfp;
+	DRStlSmp_t *drp;
+	uint32_t datalen = 0;
+	int ok;
+
+	// a leftover from an earlier level or sweep
+	if (req->respTag != sm_disc_pf_tag || i >= sm_disc_pf_count)
+		return;
+
+	pfp = &sm_disc_pf[i];
+	ok = (status == VSTATUS_OK && mad != NULL && mad->type != MAI_TYPE_ERROR
+		&& mad->base.mclass == MCLASS_SM_DIRECTED_ROUTE
+		&& !(mad->base.status & MAD_STATUS_MASK));
+	if (ok) {
+		drp = (DRStlSmp_t *)mad->data;
+		datalen = mad->datasize - STL_SMP_DR_HDR_LEN - sizeof(MAD_COMMON);
+	}
+
+	if (req->sendParams.aid == STL_MCLASS_ATTRIB_ID_NODE_INFO) {
+		if (ok && datalen >= sizeof(STL_NODE_INFO)) {
+			memcpy(&pfp->nodeInfo, drp->SMPData, sizeof(STL_NODE_INFO));
+			BSWAP_STL_NODE_INFO(&pfp->nodeInfo);
+			// same checks as SM_Get_NodeInfo, including the PR 113605 workaround
+			if (pfp->nodeInfo.NodeType == NI_TYPE_CA
+				&& (((pfp->nodeInfo.NodeGUID & 0xffffffff00000000ULL) == 0)
+					|| ((pfp->nodeInfo.PortGUID & 0xffffffff00000000ULL) == 0)))
+				ok = 0;
+		} else {
+			ok = 0;
+		}
+		pfp->niState = ok ? SM_DISC_PF_VALID : SM_DISC_PF_FAILED;
+	} else {
+		if (ok && datalen >= sizeof(STL_NODE_DESCRIPTION)) {
+			memcpy(&pfp->nodeDesc, drp->SMPData, sizeof(STL_NODE_DESCRIPTION));
+			BSWAP_STL_NODE_DESCRIPTION(&pfp->nodeDesc);
+		} else {
+			ok = 0;
+		}
+		pfp->ndState = ok ? SM_DISC_PF_VALID : SM_DISC_PF_FAILED;
+	}
+}
+
+static Status_t
+sm_discovery_send(Node_t *cnp, uint32_t i, uint32_t aid)
+{
+	Status_t status;
+	sm_dispatch_req_t *req;
+	sm_dispatch_send_params_t sendParams;
+
+	memset(&sendParams, 0, sizeof(sendParams));
+	sendParams.fd = fd_topology;
+	sendParams.method = MAD_CM_GET;
+	sendParams.aid = aid;
+	sendParams.amod = 0;
+	sendParams.path = sm_disc_pf[i].path;
+	sendParams.slid = RESERVED_LID;
+	sendParams.dlid = RESERVED_LID;
+	sendParams.mkey = 0;
+	sendParams.bversion = STL_BASE_VERSION;
+	sendParams.bufferLength = (aid == STL_MCLASS_ATTRIB_ID_NODE_INFO)
+		? sizeof(STL_NODE_INFO) : sizeof(STL_NODE_DESCRIPTION);
+
+	// requests are flow controlled against the SMA of the parent switch,
+	// which forwards all of them
+	status = sm_dispatch_new_req(&sm_asyncDispatch, &sendParams, cnp, &req);
+	if (status != VSTATUS_OK)
+		return status;
+
+	req->respCb = sm_discovery_resp;
+	req->respData = (void *)(uintptr_t)i;
+	req->respTag = sm_disc_pf_tag;
+
+	if (aid == STL_MCLASS_ATTRIB_ID_NODE_INFO) {
+		sm_disc_pf[i].niState = SM_DISC_PF_PENDING;
+		INCREMENT_COUNTER(smCounterGetNodeInfo);
+	} else {
+		sm_disc_pf[i].ndState = SM_DISC_PF_PENDING;
+		INCREMENT_COUNTER(smCounterGetNodeDescription);
+	}
+
+	return sm_dispatch_enqueue(req);
+}
+
+// the nodes of a level are those following firstp with the same path length
+#define for_level_nodes(FIRSTP,NP) \
+	for (NP = (FIRSTP); NP != NULL && NP->path[0] == (FIRSTP)->path[0]; NP = NP->next)
+
+Status_t
+sm_discovery_prefetch_level(Topology_t *topop, Node_t *firstp)
+{
+	Status_t status;
+	Node_t *nodep;
+	Port_t *portp;
+	uint32_t needed = 0, i;
+	int start_port, end_port, p;
+	int wantDesc = (topology_passcount == 0);
+	SmDiscPrefetch_t *newp = NULL;
+
+	IB_ENTER(__func__, topop, firstp, 0, 0);
+
+	if (!sm_asyncDispatch.initialized || firstp == NULL) {
+		IB_EXIT(__func__, VSTATUS_OK);
+		return VSTATUS_OK;
+	}
+
+	// only switches (and the SM's own node) are explored from
+	for_level_nodes(firstp, nodep) {
+		if (nodep->nodeInfo.NodeType != NI_TYPE_SWITCH || nodep->path[0] + 1 >= 62)
+			continue;
+		for (p = 1; p <= nodep->nodeInfo.NumPorts; p++) {
+			if (sm_discovery_candidate(nodep, sm_get_port(nodep, p)))
+				needed++;
+		}
+	}
+
+	if (needed > sm_disc_pf_size) {
+		status = vs_pool_alloc(&sm_pool, needed * sizeof(SmDiscPrefetch_t), (void *)&newp);
+		if (status != VSTATUS_OK) {
+			IB_LOG_WARNRC("can't allocate discovery prefetch table, rc:", status);
+			IB_EXIT(__func__, status);
+			return status;
+		}
+	}
+
+	if (!sm_disc_pf_mapInit) {
+		cl_qmap_init(&sm_disc_pf_map, NULL);
+		sm_disc_pf_mapInit = 1;
+	}
+	cl_qmap_remove_all(&sm_disc_pf_map);
+
+	// invalidate anything still in flight from the previous level
+	cs_cntxt_lock(&sm_async_send_rcv_cntxt);
+	sm_disc_pf_tag++;
+	sm_disc_pf_count = 0;
+	if (newp) {
+		if (sm_disc_pf)
+			vs_pool_free(&sm_pool, sm_disc_pf);
+		sm_disc_pf = newp;
+		sm_disc_pf_size = needed;
+	}
+	cs_cntxt_unlock(&sm_async_send_rcv_cntxt);
+
+	if (needed == 0) {
+		IB_EXIT(__func__, VSTATUS_OK);
+		return VSTATUS_OK;
+	}
+
+	for_level_nodes(firstp, nodep) {
+		if (nodep->nodeInfo.NodeType != NI_TYPE_SWITCH || nodep->path[0] + 1 >= 62)
+			continue;
+
+		start_port = 1;
+		end_port = nodep->nodeInfo.NumPorts;
+
+		for (p = start_port; p <= end_port && sm_disc_pf_count < needed; p++) {
+			portp = sm_get_port(nodep, p);
+			if (!sm_discovery_candidate(nodep, portp))
+				continue;
+
+			// entries are only written by the callbacks once requests are
+			// enqueued, which takes the context lock
+			i = sm_disc_pf_count++;
+			memset(&sm_disc_pf[i], 0, sizeof(SmDiscPrefetch_t));
+			memcpy(sm_disc_pf[i].path, nodep->path, 64);
+			sm_disc_pf[i].path[0]++;
+			sm_disc_pf[i].path[sm_disc_pf[i].path[0]] = portp->index;
+			cl_qmap_insert(&sm_disc_pf_map, sm_discovery_key(nodep, portp),
+				&sm_disc_pf[i].mapItem);
+
+			if (sm_discovery_send(nodep, i, STL_MCLASS_ATTRIB_ID_NODE_INFO) != VSTATUS_OK)
+				sm_disc_pf[i].niState = SM_DISC_PF_FAILED;
+			if (wantDesc && sm_discovery_send(nodep, i, STL_MCLASS_ATTRIB_ID_NODE_DESCRIPTION) != VSTATUS_OK)
+				sm_disc_pf[i].ndState = SM_DISC_PF_FAILED;
+		}
+	}
+
+	if (smDebugPerf) {
+		IB_LOG_INFINI_INFO_FMT(__func__, "prefetching %u ports at hop %u",
+			sm_disc_pf_count, firstp->path[0] + 1);
+	}
+
+	// Anything not back by the time the dispatcher gives up is fetched
+	// synchronously by sm_setup_node.
+	status = sm_dispatch_wait(&sm_asyncDispatch);
+	if (status != VSTATUS_OK) {
+		IB_LOG_INFO("discovery prefetch incomplete, rc:", status);
+		sm_dispatch_clear(&sm_asyncDispatch);
+	}
+
+	IB_EXIT(__func__, VSTATUS_OK);
+	return VSTATUS_OK;
+}
+
+static SmDiscPrefetch_t *
+sm_discovery_find(Node_t *cnp, Port_t *cpp, uint8_t *path)
+{
+	cl_map_item_t *mi;
+	SmDiscPrefetch_t *pfp;
+
+	if (!sm_disc_pf_mapInit || cnp == NULL || cpp == NULL || path == NULL)
+		return NULL;
+
+	mi = cl_qmap_get(&sm_disc_pf_map, sm_discovery_key(cnp, cpp));
+	if (mi == cl_qmap_end(&sm_disc_pf_map))
+		return NULL;
+
+	pfp = PARENT_STRUCT(mi, SmDiscPrefetch_t, mapItem);
+	if (memcmp(pfp->path, path, path[0] + 1) != 0)
+		return NULL;
+	return pfp;
+}
+
+// NodeInfo for the node on the far side of cpp, if it was prefetched
+Status_t
+sm_discovery_get_nodeinfo(Node_t *cnp, Port_t *cpp, uint8_t *path, STL_NODE_INFO *nip)
+{
+	SmDiscPrefetch_t *pfp;
+	Status_t status = VSTATUS_NOT_FOUND;
+
+	if ((pfp = sm_discovery_find(cnp, cpp, path)) == NULL)
+		return status;
+
+	cs_cntxt_lock(&sm_async_send_rcv_cntxt);
+	if (pfp->niState == SM_DISC_PF_VALID) {
+		memcpy(nip, &pfp->nodeInfo, sizeof(STL_NODE_INFO));
+		// consumed, a later visit must ask the node again
+		pfp->niState = SM_DISC_PF_NONE;
+		status = VSTATUS_OK;
+	}
+	cs_cntxt_unlock(&sm_async_send_rcv_cntxt);
+
+	return status;
+}
+
+// NodeDescription for the node on the far side of cpp, if it was prefetched
+Status_t
+sm_discovery_get_nodedesc(Node_t *cnp, Port_t *cpp, uint8_t *path, STL_NODE_DESCRIPTION *ndp)
+{
+	SmDiscPrefetch_t *pfp;
+	Status_t status = VSTATUS_NOT_FOUND;
+
+	if ((pfp = sm_discovery_find(cnp, cpp, path)) == NULL)
+		return status;
+
+	cs_cntxt_lock(&sm_async_send_rcv_cntxt);
+	if (pfp->ndState == SM_DISC_PF_VALID) {
+		memcpy(ndp, &pfp->nodeDesc, sizeof(STL_NODE_DESCRIPTION));
+		pfp->ndState = SM_DISC_PF_NONE;
+		status = VSTATUS_OK;
+	}
+	cs_cntxt_unlock(&sm_async_send_rcv_cntxt);
+
+	return status;
+}
+
+// called when discovery ends, so nothing is used by a later sweep
+void
+sm_discovery_prefetch_done(void)
+{
+	if (!sm_disc_pf_mapInit)
+		return;
+
+	cl_qmap_remove_all(&sm_disc_pf_map);
+
+	cs_cntxt_lock(&sm_async_send_rcv_cntxt);
+	sm_disc_pf_tag++;
+	sm_disc_pf_count = 0;
+	cs_cntxt_unlock(&sm_async_send_rcv_cntxt);
+}
+
+//
+// Light sweep (sm_config.light_sweep).
+//
+// When the only thing which asked for a sweep was a set of Port State
+// Change traps, the switches which sent them are the only ones which can
+// have changed.  sm_setup_node() still reads SwitchInfo and PortStateInfo
+// from every switch; one which reports no pending port change and exactly
+// the port states the last sweep saw is trusted, and the NodeInfo,
+// NodeDescription and PortInfo of whatever hangs off its active ports are
+// taken from the old topology.  The trap sources, and anything reached through
+// them, are probed as usual, so the new topology is the old one with just
+// the changed switches re-discovered, and the usual comparison against the
+// old topology hands only the difference on to routing.
+//
+// Anything other than a trap, a trap without an issuer LID, a trap from a
+// LID the old topology does not know, a failure to set up a port of a
+// trusted switch, or a failed sweep makes the next sweep a full one, as
+// does LightSweepFullInterval passing without one.
+//
+
+#define SM_LIGHT_MAX_TRAPS	64
+
+// the trap list and fullPending are protected by sm_light_lock, the rest is
+// only used by the topology thread
+static Lock_t sm_light_lock;
+static int sm_light_lockInit = 0;
+static Lid_t sm_light_traps[SM_LIGHT_MAX_TRAPS];
+static uint32_t sm_light_numTraps = 0;
+static int sm_light_fullPending = 1;
+static uint64_t sm_light_lastFull = 0;
+static int sm_light_failed = 0;
+static bitset_t sm_light_changed;		// old topology node indexes
+int sm_light_sweep = 0;
+
+void
+sm_light_sweep_init(void)
+{
+	if (!sm_light_lockInit) {
+		if (vs_lock_init(&sm_light_lock, VLOCK_FREE, VLOCK_THREAD) != VSTATUS_OK) {
+			IB_LOG_ERROR0("can't initialize light sweep lock");
+			return;
+		}
+		if (!bitset_init(&sm_pool, &sm_light_changed, SM_NODE_NUM)) {
+			(void)vs_lock_delete(&sm_light_lock);
+			return;
+		}
+		sm_light_lockInit = 1;
+	}
+}
+
+// record the issuer of a trap which needs a sweep; 0 if the trap has none
+void
+sm_light_sweep_note_trap(Lid_t lid)
+{
+	uint32_t i;
+
+	if (!sm_light_lockInit) {
+		sm_light_fullPending = 1;
+		return;
+	}
+
+	(void)vs_lock(&sm_light_lock);
+	if (lid == 0 || sm_light_numTraps >= SM_LIGHT_MAX_TRAPS) {
+		sm_light_fullPending = 1;
+	} else {
+		for (i = 0; i < sm_light_numTraps; i++) {
+			if (sm_light_traps[i] == lid)
+				break;
+		}
+		if (i == sm_light_numTraps)
+			sm_light_traps[sm_light_numTraps++] = lid;
+	}
+	(void)vs_unlock(&sm_light_lock);
+}
+
+void
+sm_light_sweep_force_full(void)
+{
+	if (!sm_light_lockInit) {
+		sm_light_fullPending = 1;
+		return;
+	}
+
+	(void)vs_lock(&sm_light_lock);
+	sm_light_fullPending = 1;
+	(void)vs_unlock(&sm_light_lock);
+}
+
+//
+// Decide whether the sweep about to start can be a light one.  trapOnly says
+// traps were the only reason for it.
+//
+void
+sm_light_sweep_begin(int trapOnly)
+{
+	Lid_t traps[SM_LIGHT_MAX_TRAPS];
+	uint32_t numTraps, i;
+	int fullPending;
+	uint64_t now;
+	Node_t *nodep, *peerp;
+	Port_t *portp;
+
+	sm_light_sweep = 0;
+	sm_light_failed = 0;
+
+	if (!sm_light_lockInit)
+		return;
+
+	(void)vs_lock(&sm_light_lock);
+	numTraps = sm_light_numTraps;
+	memcpy(traps, sm_light_traps, numTraps * sizeof(Lid_t));
+	sm_light_numTraps = 0;
+	fullPending = sm_light_fullPending;
+	sm_light_fullPending = 0;
+	(void)vs_unlock(&sm_light_lock);
+
+	(void)vs_time_get(&now);
+	if (!sm_config.light_sweep || !sm_config.use_cached_node_data || !trapOnly
+		|| fullPending || numTraps == 0 || sm_state != SM_STATE_MASTER
+		|| topology_passcount == 0 || sm_light_lastFull == 0
+		|| now - sm_light_lastFull >= (uint64_t)sm_config.light_sweep_full_interval * VTIMER_1S)
+		return;
+
+	while (sm_light_changed.nbits_m < old_topology.num_nodes) {
+		if (!bitset_resize(&sm_light_changed, sm_light_changed.nbits_m + SM_NODE_NUM))
+			return;
+	}
+	bitset_clear_all(&sm_light_changed);
+
+	for (i = 0; i < numTraps; i++) {
+		if ((portp = sm_find_port_lid(&old_topology, traps[i])) == NULL
+			|| (nodep = sm_find_port_node(&old_topology, portp)) == NULL) {
+			IB_LOG_INFINI_INFO_FMT(__func__,
+				"trap from LID 0x%x not in the last sweep, doing a full sweep", traps[i]);
+			return;
+		}
+		bitset_set(&sm_light_changed, nodep->index);
+
+		// the switch an HFI hangs off sees the same link change
+		if (nodep->nodeInfo.NodeType != NI_TYPE_SWITCH && portp->nodeno >= 0) {
+			if ((peerp = sm_find_node(&old_topology, portp->nodeno)) == NULL)
+				return;
+			bitset_set(&sm_light_changed, peerp->index);
+		}
+	}
+
+	sm_light_sweep = 1;
+	IB_LOG_INFINI_INFO_FMT(__func__, "light sweep, re-probing %u changed node(s)",
+		(unsigned)sm_light_changed.nset_m);
+}
+
+// valid is whether the sweep produced a new topology
+void
+sm_light_sweep_end(int valid)
+{
+	if (!valid) {
+		sm_light_sweep_force_full();
+	} else if (!sm_light_sweep) {
+		(void)vs_time_get(&sm_light_lastFull);
+	}
+	sm_light_sweep = 0;
+}
+
+//
+// Can the links of switch nodep be taken as oldnodep had them?  nodep's
+// SwitchInfo and PortStateInfo were just read from the switch; it must
+// report no port change and exactly the port states the last sweep saw.
+//
+int
+sm_light_sweep_trusted(Node_t *nodep, Node_t *oldnodep)
+{
+	return sm_light_sweep && !sm_light_failed && oldnodep != NULL
+		&& nodep->nodeInfo.NodeType == NI_TYPE_SWITCH
+		&& oldnodep->nodeInfo.NodeType == NI_TYPE_SWITCH
+		&& oldnodep->nodeInfo.NumPorts == nodep->nodeInfo.NumPorts
+		&& nodep->portStateInfo != NULL && oldnodep->portStateInfo != NULL
+		&& !nodep->switchInfo.u1.s.PortStateChange
+		&& !bitset_test(&sm_light_changed, oldnodep->index)
+		&& !memcmp(nodep->portStateInfo, oldnodep->portStateInfo,
+			sizeof(STL_PORT_STATE_INFO) * (nodep->nodeInfo.NumPorts + 1));
+}
+
+// a port of the trusted switch nodep did not match what the last sweep saw
+void
+sm_light_sweep_inconsistent(Node_t *nodep, Port_t *portp)
+{
+	if (!sm_light_sweep || sm_light_failed)
+		return;
+
+	IB_LOG_WARN_FMT(__func__,
+		"port %d of node %s, nodeGuid "FMT_U64" differs from the last sweep, "
+		"a full sweep is needed", portp->index, sm_nodeDescString(nodep),
+		nodep->nodeInfo.NodeGUID);
+	sm_light_failed = 1;
+}
+
+int
+sm_light_sweep_is_failed(void)
+{
+	return sm_light_sweep && sm_light_failed;
+}
@@ -41,6 +41,109 @@ static Status_t sm_dispatch_passthrough(sm_dispatch_req_t *req);
 
 //---------------------------------------------------------------------------//
 
+// Adaptive SMA batch (sm_config.sma_adaptive_batch).
+//
+// Instead of a fixed sm_config.sma_batch_size requests outstanding to each
+// SMA, each node has a window which is managed AIMD style from the response
+// callbacks: it grows by one for every window's worth of prompt responses
+// and is halved when a request times out or the response time climbs well
+// above the fastest seen from that SMA.  After a shrink, requests already on
+// the wire under the old window are allowed to drain before the window can
+// shrink again, so a single burst of late responses only counts once.
+
+// response time must exceed both the node's fastest response by this factor
+// and the floor below to be treated as a sign of SMA congestion
+#define SM_DISPATCH_RTT_BACKOFF_FACTOR	4
+#define SM_DISPATCH_RTT_BACKOFF_FLOOR	1000	// usec
+
+static __inline__ uint8_t sm_dispatch_node_limit(Node_t *nodep)
+{
+	if (sm_config.sma_adaptive_batch && nodep->asyncReqsWindow)
+		return nodep->asyncReqsWindow;
+	return nodep->asyncReqsSupported;
+}
+
+// called when a node is added to the new topology.  Response time
+// statistics and the learned window carry over from the previous sweep.
+void sm_dispatch_init_node(Node_t *nodep, Node_t *oldnodep)
+{
+	nodep->asyncReqsSupported = sm_config.sma_batch_size;
+	nodep->asyncReqsCredit = 0;
+	nodep->asyncReqsRecover = 0;
+	if (oldnodep && oldnodep->asyncReqsWindow) {
+		nodep->asyncReqsWindow = MIN(oldnodep->asyncReqsWindow, sm_config.sma_batch_size_max);
+		nodep->madRttAvg = oldnodep->madRttAvg;
+		nodep->madRttMin = oldnodep->madRttMin;
+		nodep->madResponses = oldnodep->madResponses;
+		nodep->madTimeouts = oldnodep->madTimeouts;
+	} else {
+		nodep->asyncReqsWindow = sm_config.sma_batch_size;
+		nodep->madRttAvg = 0;
+		nodep->madRttMin = 0;
+		nodep->madResponses = 0;
+		nodep->madTimeouts = 0;
+	}
+}
+
+static void sm_dispatch_window_shrink(Node_t *nodep, const char *reason)
+{
+	if (nodep->asyncReqsRecover)
+		return;
+
+	nodep->asyncReqsWindow = MAX(1, nodep->asyncReqsWindow / 2);
+	nodep->asyncReqsCredit = 0;
+	// the request completing now is still counted as outstanding
+	nodep->asyncReqsRecover = nodep->asyncReqsOutstanding ? nodep->asyncReqsOutstanding - 1 : 0;
+
+	IB_LOG_VERBOSE_FMT(__func__,
+		"%s from NodeGUID "FMT_U64" [%s], window now %u (avg rtt %u usec, min %u usec, %u timeouts)",
+		reason, nodep->nodeInfo.NodeGUID, sm_nodeDescString(nodep), nodep->asyncReqsWindow,
+		nodep->madRttAvg >> 3, nodep->madRttMin, nodep->madTimeouts);
+}
+
+// called with sm_async_send_rcv_cntxt.lock held
+static void sm_dispatch_window_update(Node_t *nodep, sm_dispatch_req_t *req, Status_t cntxtStatus)
+{
+	uint64_t now;
+	uint32_t rtt;
+
+	if (cntxtStatus == VSTATUS_TIMEOUT) {
+		nodep->madTimeouts++;
+		sm_dispatch_window_shrink(nodep, "Timeout");
+		if (nodep->asyncReqsRecover) nodep->asyncReqsRecover--;
+		return;
+	}
+	if (cntxtStatus != VSTATUS_OK)
+		return;
+
+	vs_time_get(&now);
+	rtt = (now > req->sendTime) ? (uint32_t)MIN(now - req->sendTime, (uint64_t)UINT32_MAX) : 0;
+	nodep->madResponses++;
+	if (!nodep->madRttMin || rtt < nodep->madRttMin)
+		nodep->madRttMin = rtt;
+	// exponentially weighted average with a gain of 1/8
+	if (!nodep->madRttAvg)
+		nodep->madRttAvg = rtt << 3;
+	else
+		nodep->madRttAvg += rtt - (nodep->madRttAvg >> 3);
+
+	if (nodep->asyncReqsRecover) {
+		nodep->asyncReqsRecover--;
+		return;
+	}
+
+	if (rtt > SM_DISPATCH_RTT_BACKOFF_FLOOR
+		&& rtt > nodep->madRttMin * SM_DISPATCH_RTT_BACKOFF_FACTOR) {
+		sm_dispatch_window_shrink(nodep, "Slow response");
+	} else if (++nodep->asyncReqsCredit >= nodep->asyncReqsWindow) {
+		nodep->asyncReqsCredit = 0;
+		if (nodep->asyncReqsWindow < sm_config.sma_batch_size_max)
+			nodep->asyncReqsWindow++;
+	}
+}
+
+//---------------------------------------------------------------------------//
+
 static void sm_dispatch_free_req(sm_dispatch_req_t *req)
 {
 	vs_pool_free(&sm_pool, (void *)req);
@@ -116,6 +219,12 @@ static void sm_dispatch_cntxt_callback(cntxt_entry_t *cntxt, Status_t cntxtStatu
 
 //	IB_LOG_INFINI_INFO0("received ack");
 
+	if (req->respCb)
+		req->respCb(req, cntxtStatus, mad);
+
+	if (nodep && sm_config.sma_adaptive_batch)
+		sm_dispatch_window_update(nodep, req, cntxtStatus);
+
 	if (req->disp->reqsOutstanding) --req->disp->reqsOutstanding;
 	if (nodep && nodep->asyncReqsOutstanding) --nodep->asyncReqsOutstanding;
 
@@ -138,6 +247,9 @@ static Status_t sm_dispatch_send(sm_dispatch_req_t *req)
 		sm_newTopology.dlid = req->sendParams.dlid;
 	}
 
+	if (sm_config.sma_adaptive_batch)
+		vs_time_get(&req->sendTime);
+
     if (req->sendParams.bversion == STL_BASE_VERSION) {
         return sm_send_stl_request_impl(
            req->sendParams.fd, req->sendParams.method, req->sendParams.aid, 
@@ -247,6 +359,9 @@ Status_t sm_dispatch_new_req(
 	memcpy(&req->sendParams, sendParams, sizeof(req->sendParams));
 	req->nodep = nodep;
 	req->disp = disp;
+	req->respCb = NULL;
+	req->respData = NULL;
+	req->respTag = 0;
 	req->sweepPasscount = disp->sweepPasscount;
 	QListSetObj(&req->item, req);
 
@@ -388,7 +503,7 @@ Status_t sm_dispatch_update(sm_dispatch_t *disp)
 		req = (sm_dispatch_req_t *)QListObj(item);
 		item = QListNext(&disp->queue, item);
 		if ((disp->sweepPasscount != req->sweepPasscount) ||
-			(req->nodep->asyncReqsOutstanding < req->nodep->asyncReqsSupported)) {
+			(req->nodep->asyncReqsOutstanding < sm_dispatch_node_limit(req->nodep))) {
 //			IB_LOG_INFINI_INFO0("servicing incoming queue");
 			QListRemoveItem(&disp->queue, &req->item);
 			++disp->reqsOutstanding;
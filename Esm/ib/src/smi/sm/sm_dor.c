@@ -1005,9 +1005,8 @@ _calc_updn_closure(Topology_t *topop)
 				cost += sm_GetCost(portp->portData);
 			}
 
-			if (topop->cost[Index(parent->nodep->swIdx, curr->nodep->swIdx)] == Cost_Infinity) {
-					topop->cost[Index(parent->nodep->swIdx, curr->nodep->swIdx)] = cost;
-					topop->cost[Index(curr->nodep->swIdx, parent->nodep->swIdx)] = cost;
+			if (sm_cost_get(topop, parent->nodep->swIdx, curr->nodep->swIdx) == Cost_Infinity) {
+					sm_cost_set(topop, parent->nodep->swIdx, curr->nodep->swIdx, cost);
 			}
 
 			prev = parent;
@@ -1026,7 +1025,7 @@ _calc_updn_closure(Topology_t *topop)
 			continue;
 		for (j = i+1; j < tree->numNodes; ++j) {
 			n2 = tree->nodes + j;
-			if (topop->cost[Index(n1->nodep->swIdx, n2->nodep->swIdx)] != Cost_Infinity)
+			if (sm_cost_get(topop, n1->nodep->swIdx, n2->nodep->swIdx) != Cost_Infinity)
 				continue;
 			/* cost between n1, n2 will be the sum of costs to the common parent from each of
 			 * the nodes as that will be the path connecting these two nodes.
@@ -1067,8 +1066,7 @@ _calc_updn_closure(Topology_t *topop)
 	
 			if (p2 == p1) {
 				cost = cost1 + cost2;
-				topop->cost[Index(n1->nodep->swIdx, n2->nodep->swIdx)] = cost;
-				topop->cost[Index(n2->nodep->swIdx, n1->nodep->swIdx)] = cost;
+				sm_cost_set(topop, n1->nodep->swIdx, n2->nodep->swIdx, cost);
 			}
 		}
 	}
@@ -1404,8 +1402,7 @@ _calc_dor_closure(Topology_t *topop)
 				 /* Set floyd cost to Infinity for this pair as there is no DOR closure */
 				 /* The cost will be set later on based on the Up/Dn spanning tree calculation */
 				 /* Note - floyd costs are not used in DOR or Up/Dn but are used by the job management code. */
-				topop->cost[Index(ni->swIdx, nj->swIdx)] = Cost_Infinity;
-				topop->cost[Index(nj->swIdx, ni->swIdx)] = Cost_Infinity;
+				sm_cost_set(topop, ni->swIdx, nj->swIdx, Cost_Infinity);
 
 				if (smDorRouting.debug)
 					IB_LOG_INFINI_INFO_FMT(__func__,
@@ -414,7 +414,7 @@ sm_jm_get_cost
 			if (ts2 == 0xffff)
 				cost[pos++] = 0xffff;
 			else
-				cost[pos++] = topop->cost[Index(ts1, ts2)];
+				cost[pos++] = sm_cost_get(topop, ts1, ts2);
 		}
 	}
 
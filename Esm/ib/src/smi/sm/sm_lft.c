@@ -0,0 +1,269 @@
+/* BEGIN_ICS_COPYRIGHT7 ****************************************
+
+Copyright (c) 2015, Intel Corporation
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Intel Corporation nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+** END_ICS_COPYRIGHT7   ****************************************/
+
+/* [ICS VERSION STRING: unknown] */
+
+//
+// Copy-on-write forwarding tables.
+//
+// A switch's LFT is an array of pointers to MAX_LFT_ELEMENTS_BLOCK entry
+// blocks.  When a sweep finds a switch unchanged, the new topology takes a
+// reference on each of the old topology's blocks instead of copying the
+// table; the first write to a block through sm_lft_block_wr() duplicates
+// it if any other table still references it.  A block that has never been
+// written is the shared sm_lft_empty block of 0xff entries, so a freshly
+// allocated table costs only its pointer array.
+//
+// The PGFT is much smaller and is shared whole: sm_pgft_alloc() puts a
+// reference count in front of the table and sm_Node_get_pgft_wr()
+// duplicates it on the first write while it is shared.
+//
+// Tables and blocks live in sm_pool rather than a topology arena because
+// they outlive the topology which built them.  Reference counts are atomic
+// since an old topology may be released while workers are still writing
+// the new topology's tables; a block is only ever written by the one
+// table that holds the sole reference to it.
+//
+
+#include "ib_types.h"
+#include "sm_l.h"
+
+static LftBlock_t sm_lft_empty;
+static int sm_lft_empty_init;
+
+typedef struct _PgftHdr {
+	ATOMIC_UINT	refCount;
+	uint32_t	pad[3];			// keeps the table 16 byte aligned
+} PgftHdr_t;
+
+#define SM_PGFT_HDR(pgft)		((PgftHdr_t *)((uint8_t *)(pgft) - sizeof(PgftHdr_t)))
+
+static LftBlock_t *
+sm_lft_empty_block(void)
+{
+	// the table is always built by the SM thread before any worker sees it
+	if (!sm_lft_empty_init) {
+		memset(sm_lft_empty.entry, 0xff, sizeof(sm_lft_empty.entry));
+		sm_lft_empty_init = 1;
+	}
+	return &sm_lft_empty;
+}
+
+static void
+sm_lft_block_put(LftBlock_t *block)
+{
+	if (block == &sm_lft_empty)
+		return;
+	if (AtomicDecrement(&block->refCount) == 0)
+		(void)vs_pool_free(&sm_pool, block);
+}
+
+static Status_t
+sm_lft_table_alloc(Node_t *switchp, uint32_t numBlocks)
+{
+	Status_t status;
+	Lft_t *lft;
+
+	status = vs_pool_alloc(&sm_pool, sizeof(Lft_t) + (numBlocks - 1) * sizeof(LftBlock_t *),
+						   (void *)&lft);
+	if (status != VSTATUS_OK) {
+		IB_LOG_ERROR_FMT(__func__,
+			"Unable to allocate %u block LFT for node \"%s\", nodeGuid "FMT_U64,
+			numBlocks, sm_nodeDescString(switchp), switchp->nodeInfo.NodeGUID);
+		return status;
+	}
+	lft->numBlocks = numBlocks;
+	switchp->lft = lft;
+	return VSTATUS_OK;
+}
+
+//
+// Give switchp an LFT covering LinearFDBTop with every entry unrouted.
+//
+Status_t
+sm_lft_alloc(Node_t *switchp)
+{
+	LftBlock_t *empty = sm_lft_empty_block();
+	Status_t status;
+	uint32_t i, numBlocks;
+
+	sm_lft_release(switchp);
+
+	numBlocks = ROUNDUP(switchp->switchInfo.LinearFDBTop + 1, MAX_LFT_ELEMENTS_BLOCK)
+		/ MAX_LFT_ELEMENTS_BLOCK;
+	status = sm_lft_table_alloc(switchp, numBlocks);
+	if (status != VSTATUS_OK)
+		return status;
+	for (i = 0; i < numBlocks; i++)
+		switchp->lft->block[i] = empty;
+	return VSTATUS_OK;
+}
+
+//
+// Give switchp an LFT sized for its own LinearFDBTop which shares every
+// block it has in common with oldSwitchp's.  Blocks beyond the old table
+// are unrouted.
+//
+Status_t
+sm_lft_share(Node_t *switchp, const Node_t *oldSwitchp)
+{
+	LftBlock_t *empty = sm_lft_empty_block();
+	LftBlock_t *block;
+	Status_t status;
+	uint32_t i, numBlocks, oldBlocks;
+
+	if (oldSwitchp->lft == NULL)
+		return sm_lft_alloc(switchp);
+
+	sm_lft_release(switchp);
+
+	numBlocks = ROUNDUP(switchp->switchInfo.LinearFDBTop + 1, MAX_LFT_ELEMENTS_BLOCK)
+		/ MAX_LFT_ELEMENTS_BLOCK;
+	oldBlocks = oldSwitchp->lft->numBlocks;
+	status = sm_lft_table_alloc(switchp, numBlocks);
+	if (status != VSTATUS_OK)
+		return status;
+	for (i = 0; i < numBlocks; i++) {
+		if (i < oldBlocks) {
+			block = oldSwitchp->lft->block[i];
+			if (block != empty)
+				AtomicIncrementVoid(&block->refCount);
+			switchp->lft->block[i] = block;
+		} else {
+			switchp->lft->block[i] = empty;
+		}
+	}
+	return VSTATUS_OK;
+}
+
+void
+sm_lft_release(Node_t *switchp)
+{
+	uint32_t i;
+
+	if (switchp->lft == NULL)
+		return;
+	for (i = 0; i < switchp->lft->numBlocks; i++)
+		sm_lft_block_put(switchp->lft->block[i]);
+	(void)vs_pool_free(&sm_pool, switchp->lft);
+	switchp->lft = NULL;
+}
+
+//
+// Entries of one block for reading; blocks past the end of the table read
+// as unrouted.
+//
+const PORT *
+sm_lft_block(const Node_t *switchp, uint32_t block)
+{
+	if (switchp->lft == NULL || block >= switchp->lft->numBlocks)
+		return sm_lft_empty_block()->entry;
+	return switchp->lft->block[block]->entry;
+}
+
+//
+// Entries of one block for writing, duplicating the block first if any
+// other table references it.  Returns NULL if block is beyond the table.
+//
+PORT *
+sm_lft_block_wr(Node_t *switchp, uint32_t block)
+{
+	LftBlock_t *old, *new;
+
+	if (switchp->lft == NULL || block >= switchp->lft->numBlocks)
+		return NULL;
+
+	old = switchp->lft->block[block];
+	if (old != &sm_lft_empty && AtomicRead(&old->refCount) == 1)
+		return old->entry;
+
+	if (vs_pool_alloc(&sm_pool, sizeof(LftBlock_t), (void *)&new) != VSTATUS_OK) {
+		IB_FATAL_ERROR("sm_lft_block_wr: CAN'T ALLOCATE SPACE FOR NODE'S LFT;  OUT OF MEMORY IN SM MEMORY POOL!  TOO MANY NODES!!");
+		return NULL;
+	}
+	AtomicWrite(&new->refCount, 1);
+	memcpy(new->entry, old->entry, sizeof(new->entry));
+	switchp->lft->block[block] = new;
+	sm_lft_block_put(old);
+	return new->entry;
+}
+
+//
+// Gather numBlocks consecutive blocks starting at block into the wire
+// layout expected by SM_Set_LFT() and friends.
+//
+void
+sm_lft_copy_blocks(const Node_t *switchp, uint32_t block, uint16_t numBlocks,
+				   STL_LINEAR_FORWARDING_TABLE *lftp)
+{
+	uint16_t i;
+
+	for (i = 0; i < numBlocks; i++)
+		memcpy(lftp[i].LftBlock, sm_lft_block(switchp, block + i), MAX_LFT_ELEMENTS_BLOCK);
+}
+
+//
+// A PGFT of size entries, all unused.
+//
+PORT *
+sm_pgft_alloc(size_t size)
+{
+	PgftHdr_t *hdr;
+
+	if (vs_pool_alloc(&sm_pool, sizeof(PgftHdr_t) + size, (void *)&hdr) != VSTATUS_OK)
+		return NULL;
+	AtomicWrite(&hdr->refCount, 1);
+	memset(hdr + 1, 0xff, size);
+	return (PORT *)(hdr + 1);
+}
+
+PORT *
+sm_pgft_share(PORT *pgft)
+{
+	AtomicIncrementVoid(&SM_PGFT_HDR(pgft)->refCount);
+	return pgft;
+}
+
+// @return references remaining
+uint32_t
+sm_pgft_release(PORT *pgft)
+{
+	PgftHdr_t *hdr = SM_PGFT_HDR(pgft);
+	uint32_t refs = AtomicDecrement(&hdr->refCount);
+
+	if (refs == 0)
+		(void)vs_pool_free(&sm_pool, hdr);
+	return refs;
+}
+
+uint32_t
+sm_pgft_refs(const PORT *pgft)
+{
+	return AtomicRead(&SM_PGFT_HDR(pgft)->refCount);
+}
@@ -425,6 +425,7 @@ sm_conf_callback(hsm_com_datagram_t *data)
 		case FM_DT_SM_RESTORE_PRIORITY:
 		case FM_DT_SM_GET_COUNTERS:
 		case FM_DT_SM_RESET_COUNTERS:
+		case FM_DT_SM_GET_SWEEP_PROFILE:
 		case FM_DT_SM_DUMP_STATE:
 		case FM_DT_LOG_LEVEL:
 		case FM_DT_LOG_MODE:
@@ -571,7 +572,8 @@ void if3_set_rmpp_minfo (ManagerInfo_t *mi)
 
     switch (mi->mclass) {
     case MAD_CV_VENDOR_FE:
-        mi->rmppMngrfd = &fdsa;
+        // FE passthrough workers have their own handles and RMPP connections
+        mi->rmppMngrfd = (mi->fdr == fdsa) ? &fdsa : &mi->fdr;
         mi->rmppPool = &fe_pool;
         // FE does not receive inbound MAD requests, so RMPP filters not required
         mi->rmppCreateFilters = 0;
@@ -2113,6 +2113,11 @@ sm_main(void) {
 	mai_set_num_end_ports( MIN(2*sm_config.subnet_size, MAI_MAX_QUEUED_DEFAULT));
 	mai_init();
 
+	if (sm_config.sim_fabric[0]) {
+		if (ib_sim_configure(sm_config.sim_fabric, sm_config.sim_hop_latency,
+							 sm_config.sim_loss_ppm) != VSTATUS_OK)
+			IB_FATAL_ERROR("sm_main: Failed to load simulated fabric; terminating");
+	}
 	status = ib_init_devport(&sm_config.hca, &sm_config.port, &sm_config.port_guid);
 	if (status != VSTATUS_OK)
 		IB_FATAL_ERROR("sm_main: Failed to bind to device; terminating");
@@ -2231,6 +2236,13 @@ sm_main(void) {
 		IB_FATAL_ERROR("Failed to initialize Job Management data structures");
 		return VSTATUS_BAD;
 	}
+
+	// start the worker pool used for routing computations
+	status = sm_parallel_init(sm_config.routing_threads);
+	if (status != VSTATUS_OK) {
+		IB_FATAL_ERROR("Failed to initialize SM worker pool");
+		return VSTATUS_BAD;
+	}
    
     // Initialize the SSL/TLS network security interface
     if (sm_config.SslSecurityEnabled) 
@@ -2824,6 +2836,7 @@ sm_shutdown(void){
 	async_main_kill();
     topology_rcv_kill();
     sm_dbsync_kill();
+	sm_parallel_destroy();
 	sm_jm_destroy_job_table();
 	sm_clean_vfdg_memory();
 	sm_free_vf_mem();
@@ -2896,6 +2909,7 @@ sm_cleanGlobals(uint8_t stop){
 		memset(&sm_smInfo,0,sizeof(sm_smInfo));
 		sm_masterStartTime = 0;
 		sm_McGroups = 0;
+		sm_multicast_clear_group_index();
     	sm_numMcGroups = 0;
     	sm_McGroups_Need_Prog = 0;
 
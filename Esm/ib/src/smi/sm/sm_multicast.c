@@ -1085,6 +1085,10 @@ Status_t sm_set_all_mft(int force, Topology_t *prev_tp)
         /* skip switches whose mft's did not change */
         if (topology_passcount > 1 && !switchp->mftChange && !switchp->mftPortMaskChange && !force) {
             continue;
+        }
+        /* first sweep after a warm start and the switch already has this MFT */
+        if (switchp->mftWarm && !force) {
+            continue;
         } 
         //else if (switchp->mftChange) {
         //	IB_LOG_INFINI_INFO_FMT(__func__,
@@ -1890,20 +1894,126 @@ sm_multicast_assign_lid(IB_GID mGid, PKey_t pKey, uint8_t mtu, uint8_t rate,
 
 // -------------------------------------------------------------------------- //
 
+//
+//	Hash indexes over the multicast group list (by MGID) and each group's
+//	member list (by PortGID and by member index).  The keys point into the
+//	McGroup_t/McMember_t, so the entries are added by McGroup_Create() and
+//	McMember_Create() once the key is set, and removed by the delete macros
+//	before the structure is freed.  Callers hold sm_McGroups_lock, as for
+//	the lists themselves.
+//
+static CS_HashTablep sm_McGroupMap = NULL;
+
+static uint64_t
+sm_multicast_gid_hash(void *key) {
+	IB_GID		*gid = (IB_GID *)key;
+	uint64_t	h = gid->AsReg64s.H ^ gid->AsReg64s.L;
+
+	// the table only uses the low 32 bits, so fold the whole GID into them
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	return h;
+}
+
+static int32_t
+sm_multicast_gid_equal(void *key1, void *key2) {
+	return (memcmp(key1, key2, sizeof(IB_GID)) == 0);
+}
+
+static uint64_t
+sm_multicast_index_hash(void *key) {
+	return *(uint32_t *)key;
+}
+
+static int32_t
+sm_multicast_index_equal(void *key1, void *key2) {
+	return (*(uint32_t *)key1 == *(uint32_t *)key2);
+}
+
+void
+sm_multicast_index_group(McGroup_t *mcGroup) {
+
+	if (sm_McGroupMap == NULL) {
+		sm_McGroupMap = cs_create_hashtable("sm_McGroups", 64, sm_multicast_gid_hash,
+			sm_multicast_gid_equal, CS_HASH_KEY_NOT_ALLOCATED);
+		if (sm_McGroupMap == NULL) {
+			IB_FATAL_ERROR("can't allocate multicast group index");
+		}
+	}
+
+	mcGroup->mcMemberMap = cs_create_hashtable("sm_McMembers", 16, sm_multicast_gid_hash,
+		sm_multicast_gid_equal, CS_HASH_KEY_NOT_ALLOCATED);
+	mcGroup->mcMemberIndexMap = cs_create_hashtable("sm_McMemberIndexes", 16, sm_multicast_index_hash,
+		sm_multicast_index_equal, CS_HASH_KEY_NOT_ALLOCATED);
+	if (  mcGroup->mcMemberMap == NULL || mcGroup->mcMemberIndexMap == NULL
+	   || !cs_hashtable_insert(sm_McGroupMap, &mcGroup->mGid, mcGroup)) {
+		IB_FATAL_ERROR("can't allocate multicast group index");
+	}
+}
+
+void
+sm_multicast_unindex_group(McGroup_t *mcGroup) {
+
+	if (sm_McGroupMap != NULL)
+		(void)cs_hashtable_remove(sm_McGroupMap, &mcGroup->mGid);
+
+	if (mcGroup->mcMemberMap != NULL) {
+		cs_hashtable_destroy(mcGroup->mcMemberMap, FALSE);
+		mcGroup->mcMemberMap = NULL;
+	}
+	if (mcGroup->mcMemberIndexMap != NULL) {
+		cs_hashtable_destroy(mcGroup->mcMemberIndexMap, FALSE);
+		mcGroup->mcMemberIndexMap = NULL;
+	}
+}
+
+// Used when the group list is reset without deleting the groups.
+void
+sm_multicast_clear_group_index(void) {
+
+	if (sm_McGroupMap != NULL) {
+		cs_hashtable_destroy(sm_McGroupMap, FALSE);
+		sm_McGroupMap = NULL;
+	}
+}
+
+void
+sm_multicast_index_member(McGroup_t *mcGroup, McMember_t *mcMember) {
+
+	if (  !cs_hashtable_insert(mcGroup->mcMemberMap, &mcMember->record.RID.PortGID, mcMember)
+	   || !cs_hashtable_insert(mcGroup->mcMemberIndexMap, &mcMember->index, mcMember)) {
+		IB_FATAL_ERROR("can't allocate multicast member index");
+	}
+}
+
+void
+sm_multicast_unindex_member(McGroup_t *mcGroup, McMember_t *mcMember) {
+
+	(void)cs_hashtable_remove(mcGroup->mcMemberMap, &mcMember->record.RID.PortGID);
+	(void)cs_hashtable_remove(mcGroup->mcMemberIndexMap, &mcMember->index);
+}
+
+// Replaces the index assigned by McMember_Create(), e.g. with the one
+// received from the master SM by dbsync.
+void
+sm_multicast_set_member_index(McGroup_t *mcGroup, McMember_t *mcMember, uint32_t index) {
+
+	(void)cs_hashtable_remove(mcGroup->mcMemberIndexMap, &mcMember->index);
+	mcMember->index = index;
+	if (!cs_hashtable_insert(mcGroup->mcMemberIndexMap, &mcMember->index, mcMember)) {
+		IB_FATAL_ERROR("can't allocate multicast member index");
+	}
+}
+
 McGroup_t *
 sm_find_multicast_gid(IB_GID gid) {
 	McGroup_t	*mcGroup=NULL;
 
 	IB_ENTER(__func__, &gid, 0, 0, 0);
 
-//
-//	Loop over all MC groups looking for this MC gid.
-//
-	for_all_multicast_groups(mcGroup) {
-		if (memcmp(&(mcGroup->mGid), &gid, 16) == 0) {
-			break;
-		}
-	}
+	if (sm_McGroupMap != NULL)
+		mcGroup = (McGroup_t *)cs_hashtable_search(sm_McGroupMap, &gid);
 
 	IB_EXIT(__func__, mcGroup);
 	return(mcGroup);
@@ -2049,18 +2159,11 @@ sm_multicast_gid_valid(uint8_t scope, IB_GID gid) {
 
 McMember_t *
 sm_find_multicast_member(McGroup_t *mcGroup, IB_GID gid) {
-	McMember_t		*mcMember=NULL;
+	McMember_t		*mcMember;
 
 	IB_ENTER(__func__, mcGroup, &gid, 0, 0);
 
-//
-//	Loop over all of the members looking for this gid.
-//
-	for_all_multicast_members(mcGroup, mcMember) {
-		if (memcmp((void *)(&gid), (void *)mcMember->record.RID.PortGID.Raw, 16) == 0) {
-			break;
-		}
-	}
+	mcMember = (McMember_t *)cs_hashtable_search(mcGroup->mcMemberMap, &gid);
 
 	IB_EXIT(__func__, mcMember);
 	return(mcMember);
@@ -2069,18 +2172,11 @@ sm_find_multicast_member(McGroup_t *mcGroup, IB_GID gid) {
 
 McMember_t *
 sm_find_multicast_member_by_index(McGroup_t *mcGroup, uint32_t index) {
-	McMember_t		*mcMember=NULL;
+	McMember_t		*mcMember;
 
 	IB_ENTER(__func__, mcGroup, index, 0, 0);
 
-//
-//	Loop over all of the members looking for this index
-//
-	for_all_multicast_members(mcGroup, mcMember) {
-		if (mcMember->index == index) {
-			break;
-		}
-	}
+	mcMember = (McMember_t *)cs_hashtable_search(mcGroup->mcMemberIndexMap, &index);
 
 	IB_EXIT(__func__, mcMember);
 	return(mcMember);
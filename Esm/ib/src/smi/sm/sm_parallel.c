@@ -0,0 +1,213 @@
+/* BEGIN_ICS_COPYRIGHT7 ****************************************
+
+Copyright (c) 2015, Intel Corporation
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Intel Corporation nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+** END_ICS_COPYRIGHT7   ****************************************/
+
+/* [ICS VERSION STRING: unknown] */
+
+//
+// SM worker pool.
+//
+// A small set of persistent worker threads used by the topology thread to
+// spread independent pieces of a sweep computation (cost matrix tiles,
+// per-switch forwarding tables, ...) across CPUs.  The caller of
+// sm_parallel_run() always participates in the work, so a pool of N threads
+// has N-1 worker threads.  Only one sm_parallel_run() may be active at a
+// time; it is intended to be called from the topology thread only.
+//
+
+#include "ib_types.h"
+#include "sm_l.h"
+#ifndef __VXWORKS__
+#include <unistd.h>
+#endif
+
+typedef struct {
+	uint32_t			threads;		// total threads, including the caller
+	uint32_t			exit;
+	Thread_t			handles[SM_PARALLEL_MAX_THREADS];
+	Sema_t				startSema;
+	Sema_t				doneSema;
+
+	// the job currently being executed
+	sm_parallel_work_t	work;
+	void				*context;
+	uint32_t			items;
+	ATOMIC_UINT			nextItem;
+} SmParallelPool_t;
+
+static SmParallelPool_t sm_parallel_pool = { .threads = 1 };
+
+static __inline__ void
+sm_parallel_do_items(SmParallelPool_t *pool, uint32_t worker)
+{
+	uint32_t item;
+
+	while ((item = AtomicIncrement(&pool->nextItem) - 1) < pool->items) {
+		pool->work(pool->context, item, worker);
+	}
+}
+
+// argc is the worker index, 1..threads-1; index 0 is the calling thread.
+static void
+sm_parallel_worker(uint32_t argc, uint8_t **argv)
+{
+	SmParallelPool_t *pool = &sm_parallel_pool;
+
+	for (;;) {
+		if (cs_psema(&pool->startSema) != VSTATUS_OK)
+			continue;
+
+		if (pool->exit)
+			break;
+
+		sm_parallel_do_items(pool, argc);
+
+		(void)cs_vsema(&pool->doneSema);
+	}
+
+	(void)cs_vsema(&pool->doneSema);
+}
+
+uint32_t
+sm_parallel_threads(void)
+{
+	return sm_parallel_pool.threads;
+}
+
+Status_t
+sm_parallel_init(uint32_t threads)
+{
+	SmParallelPool_t *pool = &sm_parallel_pool;
+	Status_t status;
+	uint32_t i;
+
+	IB_ENTER(__func__, threads, 0, 0, 0);
+
+	if (threads == 0) {
+#ifndef __VXWORKS__
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (cpus > 0) ? (uint32_t)cpus : 1;
+#else
+		threads = 1;
+#endif
+	}
+	if (threads > SM_PARALLEL_MAX_THREADS)
+		threads = SM_PARALLEL_MAX_THREADS;
+
+	memset(pool, 0, sizeof(*pool));
+	pool->threads = 1;
+
+	if (threads == 1) {
+		IB_EXIT(__func__, VSTATUS_OK);
+		return VSTATUS_OK;
+	}
+
+	if ((status = cs_sema_create(&pool->startSema, 0)) != VSTATUS_OK) {
+		IB_LOG_ERRORRC("can't create worker pool start semaphore rc:", status);
+		IB_EXIT(__func__, status);
+		return status;
+	}
+
+	if ((status = cs_sema_create(&pool->doneSema, 0)) != VSTATUS_OK) {
+		IB_LOG_ERRORRC("can't create worker pool done semaphore rc:", status);
+		(void)cs_sema_delete(&pool->startSema);
+		IB_EXIT(__func__, status);
+		return status;
+	}
+
+	for (i = 1; i < threads; i++) {
+		status = vs_thread_create(&pool->handles[i], (unsigned char *)"sm_worker",
+								  sm_parallel_worker, i, NULL, SM_STACK_SIZE);
+		if (status != VSTATUS_OK) {
+			IB_LOG_WARNRC("can't create SM worker thread, continuing with fewer threads rc:", status);
+			break;
+		}
+		pool->threads++;
+	}
+
+	IB_LOG_INFINI_INFO("SM worker pool threads:", pool->threads);
+
+	IB_EXIT(__func__, VSTATUS_OK);
+	return VSTATUS_OK;
+}
+
+void
+sm_parallel_destroy(void)
+{
+	SmParallelPool_t *pool = &sm_parallel_pool;
+	uint32_t i;
+
+	if (pool->threads <= 1)
+		return;
+
+	pool->exit = 1;
+	for (i = 1; i < pool->threads; i++)
+		(void)cs_vsema(&pool->startSema);
+	for (i = 1; i < pool->threads; i++)
+		(void)cs_psema(&pool->doneSema);
+
+	(void)cs_sema_delete(&pool->startSema);
+	(void)cs_sema_delete(&pool->doneSema);
+	pool->threads = 1;
+}
+
+Status_t
+sm_parallel_run(uint32_t items, sm_parallel_work_t work, void *context)
+{
+	SmParallelPool_t *pool = &sm_parallel_pool;
+	uint32_t i, workers;
+
+	if (work == NULL)
+		return VSTATUS_ILLPARM;
+
+	if (pool->threads <= 1 || items <= 1) {
+		for (i = 0; i < items; i++)
+			work(context, i, 0);
+		return VSTATUS_OK;
+	}
+
+	pool->work = work;
+	pool->context = context;
+	pool->items = items;
+	AtomicWrite(&pool->nextItem, 0);
+
+	// no point waking more workers than there are items left for them
+	workers = MIN(pool->threads, items) - 1;
+	for (i = 0; i < workers; i++)
+		(void)cs_vsema(&pool->startSema);
+
+	sm_parallel_do_items(pool, 0);
+
+	for (i = 0; i < workers; i++)
+		(void)cs_psema(&pool->doneSema);
+
+	pool->work = NULL;
+	pool->context = NULL;
+
+	return VSTATUS_OK;
+}
@@ -34,6 +34,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "sa_l.h"
 #include "sm_dbsync.h"
 #include "fm_xml.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 // Macro hacks for compiler warnings on non 64-bit systems;
 // replace with uintptr_t if available on all platforms.
@@ -207,10 +210,92 @@ sm_routing_alloc_floyds(Topology_t *topop)
 
 		topop->bytes = bytesCost;
 	}
+	topop->costMode = SM_COST_FULL;
 
 	return VSTATUS_OK;
 }
 
+// Fill the full matrix cost, of src_topop->max_sws squared entries, from
+// src_topop's cost matrix in whatever layout it is stored.
+static void
+sm_routing_expand_floyds(const Topology_t *src_topop, unsigned short *cost)
+{
+	int i, j, switches = src_topop->max_sws;
+
+	if (src_topop->costMode == SM_COST_FULL) {
+		memcpy(cost, src_topop->cost, (size_t)switches * switches * sizeof(uint16_t));
+		return;
+	}
+
+	for (i = 0; i < switches; i++) {
+		cost[(size_t)i * switches + i] = 0;
+		for (j = i + 1; j < switches; j++) {
+			cost[(size_t)i * switches + j] = cost[(size_t)j * switches + i]
+				= sm_cost_get(src_topop, i, j);
+		}
+	}
+}
+
+//
+// Replace a completed full cost matrix with its packed upper triangle,
+// narrowed to one byte per cost if every finite cost allows.  Nothing
+// may sm_cost_set() the matrix afterwards; sm_routing_copy_floyds() and
+// sm_routing_update_floyds() expand it again for the next sweep.
+//
+void
+sm_routing_pack_floyds(Topology_t *topop)
+{
+	int i, j, switches = topop->max_sws;
+	size_t entries, bytesCost, k;
+	uint16_t c, maxCost = 0;
+	void *packed;
+
+	if (  !sm_config.compact_cost_matrix
+	   || topop->cost == NULL
+	   || topop->costMode != SM_COST_FULL
+	   || switches < 2)
+		return;
+
+	for (i = 0; i < switches; i++) {
+		for (j = i + 1; j < switches; j++) {
+			c = topop->cost[(size_t)i * switches + j];
+			if (c < Cost_Infinity && c > maxCost)
+				maxCost = c;
+		}
+	}
+
+	entries = (size_t)switches * (switches - 1) / 2;
+	bytesCost = entries * (maxCost < SM_COST_PACKED8_INFINITY ? sizeof(uint8_t) : sizeof(uint16_t));
+	if (vs_pool_alloc(&sm_pool, bytesCost, &packed) != VSTATUS_OK) {
+		// the full matrix is still good, just bigger
+		IB_LOG_WARN("can't malloc packed cost array; bytes:", (uint32_t)bytesCost);
+		return;
+	}
+
+	k = 0;
+	if (maxCost < SM_COST_PACKED8_INFINITY) {
+		uint8_t *cost8 = (uint8_t *)packed;
+		for (i = 0; i < switches; i++) {
+			for (j = i + 1; j < switches; j++, k++) {
+				c = topop->cost[(size_t)i * switches + j];
+				cost8[k] = (c >= Cost_Infinity) ? SM_COST_PACKED8_INFINITY : (uint8_t)c;
+			}
+		}
+		topop->costMode = SM_COST_PACKED8;
+	} else {
+		uint16_t *cost16 = (uint16_t *)packed;
+		for (i = 0; i < switches; i++) {
+			for (j = i + 1; j < switches; j++, k++)
+				cost16[k] = topop->cost[(size_t)i * switches + j];
+		}
+		topop->costMode = SM_COST_PACKED16;
+	}
+
+	(void)vs_pool_free(&sm_pool, (void *)topop->cost);
+	topop->cost = (uint16_t *)packed;
+	topop->bytes = bytesCost;
+}
+
 void
 sm_routing_init_floyds(Topology_t *topop)
 {
@@ -256,57 +341,591 @@ sm_routing_init_floyds(Topology_t *topop)
 	}
 }
 
+//
+// Blocked (tiled) Floyd-Warshall.
+//
+// The cost matrix is split into SM_FLOYDS_TILE x SM_FLOYDS_TILE tiles.  For
+// each diagonal tile kb, the classic three phases are run:
+//   1. the diagonal tile (kb,kb) is closed over its own intermediate nodes,
+//   2. the tiles in row kb and column kb are relaxed through the diagonal tile,
+//   3. every other tile (ib,jb) is relaxed through (ib,kb) and (kb,jb).
+// Tiles within phase 2 and within phase 3 are independent of each other and
+// are handed to the SM worker pool.  The result is identical to the simple
+// triple loop; both triangles of the (symmetric) matrix are produced.
+//
+#define SM_FLOYDS_TILE	64
+
+typedef struct {
+	unsigned short	*cost;
+	int				switches;
+	int				tiles;		// tiles per row/column
+	int				kb;			// current diagonal tile
+} FloydsPhase_t;
+
+// dst[j] = min(dst[j], dik + src[j]) for j in [0, len)
+static __inline__ void
+sm_routing_floyds_minplus(unsigned short *dst, const unsigned short *src,
+	unsigned short dik, int len)
+{
+	int j = 0;
+
+#if defined(__SSE2__)
+	// SSE2 has no unsigned 16-bit min; use min(a,b) = a - subs_epu16(a,b).
+	// Costs are at most Cost_Infinity, so the addition cannot wrap.
+	__m128i vik = _mm_set1_epi16((short)dik);
+
+	for (; j + 8 <= len; j += 8) {
+		__m128i a = _mm_loadu_si128((const __m128i *)&dst[j]);
+		__m128i b = _mm_add_epi16(_mm_loadu_si128((const __m128i *)&src[j]), vik);
+		_mm_storeu_si128((__m128i *)&dst[j], _mm_sub_epi16(a, _mm_subs_epu16(a, b)));
+	}
+#endif
+
+	for (; j < len; j++) {
+		unsigned short value = dik + src[j];
+		if (value < dst[j])
+			dst[j] = value;
+	}
+}
+
+// Relax tile (ib,jb) through the intermediate nodes of tile kb.
+static void
+sm_routing_floyds_tile(unsigned short *cost, int switches, int ib, int jb, int kb)
+{
+	int i, k;
+	int i0 = ib * SM_FLOYDS_TILE, i1 = MIN(i0 + SM_FLOYDS_TILE, switches);
+	int j0 = jb * SM_FLOYDS_TILE, j1 = MIN(j0 + SM_FLOYDS_TILE, switches);
+	int k0 = kb * SM_FLOYDS_TILE, k1 = MIN(k0 + SM_FLOYDS_TILE, switches);
+	unsigned short dik;
+
+	for (k = k0; k < k1; k++) {
+		const unsigned short *rowk = &cost[k * switches + j0];
+
+		for (i = i0; i < i1; i++) {
+			if ((dik = cost[i * switches + k]) == Cost_Infinity)
+				continue;
+			sm_routing_floyds_minplus(&cost[i * switches + j0], rowk, dik, j1 - j0);
+		}
+	}
+}
+
+// Phase 2 work item: items [0, tiles-1) are row kb, the rest are column kb.
+static void
+sm_routing_floyds_phase2(void *context, uint32_t item, uint32_t worker)
+{
+	FloydsPhase_t *phase = (FloydsPhase_t *)context;
+	int other = (int)item % (phase->tiles - 1);
+
+	if (other >= phase->kb)
+		other++;
+
+	if ((int)item < phase->tiles - 1)
+		sm_routing_floyds_tile(phase->cost, phase->switches, phase->kb, other, phase->kb);
+	else
+		sm_routing_floyds_tile(phase->cost, phase->switches, other, phase->kb, phase->kb);
+}
+
+// Phase 3 work item: one row of tiles (excluding row and column kb).
+static void
+sm_routing_floyds_phase3(void *context, uint32_t item, uint32_t worker)
+{
+	FloydsPhase_t *phase = (FloydsPhase_t *)context;
+	int ib = (int)item, jb;
+
+	if (ib >= phase->kb)
+		ib++;
+
+	for (jb = 0; jb < phase->tiles; jb++) {
+		if (jb == phase->kb)
+			continue;
+		sm_routing_floyds_tile(phase->cost, phase->switches, ib, jb, phase->kb);
+	}
+}
+
+static void
+sm_routing_calc_floyds_blocked(int switches, unsigned short * cost)
+{
+	FloydsPhase_t phase;
+
+	phase.cost = cost;
+	phase.switches = switches;
+	phase.tiles = (switches + SM_FLOYDS_TILE - 1) / SM_FLOYDS_TILE;
+
+	for (phase.kb = 0; phase.kb < phase.tiles; phase.kb++) {
+		sm_routing_floyds_tile(cost, switches, phase.kb, phase.kb, phase.kb);
+
+		if (phase.tiles == 1)
+			break;
+
+		(void)sm_parallel_run(2 * (phase.tiles - 1), sm_routing_floyds_phase2, &phase);
+		(void)sm_parallel_run(phase.tiles - 1, sm_routing_floyds_phase3, &phase);
+
+		if (smDebugPerf && (phase.kb & 0xF) == 0xF) {
+			IB_LOG_INFINI_INFO_FMT(__func__, "completed tile %d of %d", phase.kb, phase.tiles);
+		}
+	}
+}
+
+static void sm_routing_analyze_floyds(int switches, unsigned short * cost);
+
 void
 sm_routing_calc_floyds(int switches, unsigned short * cost)
 {
-	int i, j, k;
-	int ij, ik, kj, oldik;
-	int kNumNodes, iNumNodes, oldiNumNodes;
-	unsigned short value;
-	unsigned int total_cost = 0;
-	unsigned int leastTotalCost = 0;
-	unsigned int max_cost = 0;
-	unsigned int leastWorstCaseCost = 0;
-	uint64_t leastWorstCostSwitchGuid = 0;
-	uint64_t leastTotalCostSwitchGuid = 0;
-	unsigned int currRootTotalCost = 0;
-	unsigned int currRootWorstCaseCost = 0;
-	int curr_selection_sm_neighbor = 0;
-	uint8_t	old_root_exists = 0;
-	Node_t *nodep;
-	Node_t *sw = sm_topop->switch_head;
+	sm_routing_calc_floyds_blocked(switches, cost);
 
-	for (k = 0, kNumNodes = 0; k < switches; k++, kNumNodes += switches) {
-		for (i = 0, iNumNodes = 0; i < switches; i++, iNumNodes += switches) {
+	sm_routing_analyze_floyds(switches, cost);
+}
 
-			ik = iNumNodes + k;
+//
+// Incremental cost matrix update.
+//
+// When only inter-switch links changed between sweeps (same set of switches,
+// same switch indices) the previous sweep's cost matrix is repaired instead
+// of being recomputed:
+//   - links that went away or got more expensive invalidate the rows of any
+//     switch whose shortest paths may have used them; those rows are rebuilt
+//     with Dijkstra over the new switch graph,
+//   - links that appeared or got cheaper are then inserted one at a time by
+//     relaxing every row through them.
+// The result is exactly the matrix the full Floyd-Warshall would produce.
+//
+#define SM_FLOYDS_INCR_MAX_EDGES	64
+
+typedef struct {
+	uint16_t	sw;			// neighbor switch index
+	uint16_t	cost;
+} FloydsEdge_t;
+
+// Switch graph in compressed row form, with the same per-link cost
+// selection as sm_routing_init_floyds().
+typedef struct {
+	int				switches;
+	uint32_t		*offsets;	// first edge of each switch, switches + 1 entries
+	uint32_t		*counts;	// edges in use for each switch
+	FloydsEdge_t	*edges;
+} FloydsGraph_t;
+
+typedef struct {
+	uint16_t	u;
+	uint16_t	v;
+	uint16_t	oldCost;
+	uint16_t	newCost;
+} FloydsChange_t;
+
+typedef struct {
+	unsigned short	*cost;
+	FloydsGraph_t	*graph;
+	uint16_t		*rows;		// switch indices of the rows to rebuild
+	uint32_t		edgeCount;
+	Status_t		status;
+} FloydsRepair_t;
+
+typedef struct {
+	unsigned short	*cost;
+	int				switches;
+	const unsigned short *rowU;
+	const unsigned short *rowV;
+	uint16_t		edgeCost;
+} FloydsInsert_t;
+
+typedef struct {
+	uint16_t	dist;
+	uint16_t	sw;
+} FloydsHeapEntry_t;
+
+static void
+sm_routing_floyds_graph_free(FloydsGraph_t *graph)
+{
+	if (graph->offsets)
+		(void)vs_pool_free(&sm_pool, graph->offsets);
+	if (graph->counts)
+		(void)vs_pool_free(&sm_pool, graph->counts);
+	if (graph->edges)
+		(void)vs_pool_free(&sm_pool, graph->edges);
+	memset(graph, 0, sizeof(*graph));
+}
+
+static void
+sm_routing_floyds_graph_set(FloydsGraph_t *graph, int i, int k, uint16_t cost)
+{
+	FloydsEdge_t *edges = &graph->edges[graph->offsets[i]];
+	uint32_t e;
 
-			if (cost[ik] == Cost_Infinity) {
+	for (e = 0; e < graph->counts[i]; e++) {
+		if (edges[e].sw == k) {
+			edges[e].cost = cost;
+			return;
+		}
+	}
+	edges[e].sw = k;
+	edges[e].cost = cost;
+	graph->counts[i]++;
+}
+
+static uint16_t
+sm_routing_floyds_graph_cost(FloydsGraph_t *graph, int i, int k)
+{
+	FloydsEdge_t *edges = &graph->edges[graph->offsets[i]];
+	uint32_t e;
+
+	for (e = 0; e < graph->counts[i]; e++) {
+		if (edges[e].sw == k)
+			return edges[e].cost;
+	}
+	return Cost_Infinity;
+}
+
+static Status_t
+sm_routing_floyds_graph_build(Topology_t *topop, FloydsGraph_t *graph)
+{
+	Status_t status;
+	Node_t *nodep, *neighborNodep;
+	Port_t *portp;
+	int i, k, pass;
+	uint32_t total;
+
+	memset(graph, 0, sizeof(*graph));
+	graph->switches = topop->max_sws;
+
+	status = vs_pool_alloc(&sm_pool, (graph->switches + 1) * sizeof(uint32_t), (void *)&graph->offsets);
+	if (status == VSTATUS_OK)
+		status = vs_pool_alloc(&sm_pool, (graph->switches + 1) * sizeof(uint32_t), (void *)&graph->counts);
+	if (status != VSTATUS_OK) {
+		sm_routing_floyds_graph_free(graph);
+		return status;
+	}
+	memset(graph->counts, 0, (graph->switches + 1) * sizeof(uint32_t));
+
+	// pass 0 sizes each switch's edge list, pass 1 fills it in
+	for (pass = 0; pass < 2; pass++) {
+		for_all_switch_nodes(topop, nodep) {
+			i = nodep->swIdx;
+			for_all_physical_ports(nodep, portp) {
+				if (!sm_valid_port(portp) || portp->state <= IB_PORT_DOWN)
+					continue;
+				neighborNodep = sm_find_node(topop, portp->nodeno);
+				if (neighborNodep == NULL || neighborNodep->nodeInfo.NodeType != NI_TYPE_SWITCH)
+					continue;
+				k = neighborNodep->swIdx;
+				if (k == i || i >= graph->switches || k >= graph->switches)
+					continue;
+
+				if (pass == 0) {
+					graph->counts[i]++;
+					graph->counts[k]++;
+				} else {
+					sm_routing_floyds_graph_set(graph, i, k, sm_GetCost(portp->portData));
+					sm_routing_floyds_graph_set(graph, k, i, sm_GetCost(portp->portData));
+				}
+			}
+		}
+
+		if (pass == 0) {
+			for (i = 0, total = 0; i < graph->switches; i++) {
+				graph->offsets[i] = total;
+				total += graph->counts[i];
+				graph->counts[i] = 0;
+			}
+			graph->offsets[i] = total;
+
+			status = vs_pool_alloc(&sm_pool, MAX(total, 1) * sizeof(FloydsEdge_t), (void *)&graph->edges);
+			if (status != VSTATUS_OK) {
+				sm_routing_floyds_graph_free(graph);
+				return status;
+			}
+		}
+	}
+
+	return VSTATUS_OK;
+}
+
+// Rebuild one row of the cost matrix with Dijkstra over the switch graph.
+static void
+sm_routing_floyds_repair_row(void *context, uint32_t item, uint32_t worker)
+{
+	FloydsRepair_t *repair = (FloydsRepair_t *)context;
+	FloydsGraph_t *graph = repair->graph;
+	int switches = graph->switches;
+	int src = repair->rows[item];
+	unsigned short *row = &repair->cost[src * switches];
+	FloydsHeapEntry_t *heap = NULL, entry, tmp;
+	uint8_t *done = NULL;
+	uint32_t heapLen = 0, e, pos, child;
+	uint16_t dist;
+
+	if (  vs_pool_alloc(&sm_pool, (repair->edgeCount + 1) * sizeof(FloydsHeapEntry_t), (void *)&heap) != VSTATUS_OK
+	   || vs_pool_alloc(&sm_pool, switches, (void *)&done) != VSTATUS_OK) {
+		repair->status = VSTATUS_NOMEM;
+		goto exit;
+	}
+	memset(done, 0, switches);
+
+	for (e = 0; e < switches; e++)
+		row[e] = Cost_Infinity;
+	row[src] = 0;
+	heap[heapLen].dist = 0;
+	heap[heapLen++].sw = src;
+
+	while (heapLen) {
+		// pop min
+		entry = heap[0];
+		heap[0] = heap[--heapLen];
+		for (pos = 0; (child = 2 * pos + 1) < heapLen; pos = child) {
+			if (child + 1 < heapLen && heap[child + 1].dist < heap[child].dist)
+				child++;
+			if (heap[pos].dist <= heap[child].dist)
+				break;
+			tmp = heap[pos]; heap[pos] = heap[child]; heap[child] = tmp;
+		}
+
+		if (done[entry.sw])
+			continue;
+		done[entry.sw] = 1;
+
+		for (e = graph->offsets[entry.sw]; e < graph->offsets[entry.sw] + graph->counts[entry.sw]; e++) {
+			FloydsEdge_t *edge = &graph->edges[e];
+
+			if (done[edge->sw] || edge->cost >= Cost_Infinity)
+				continue;
+			if ((dist = entry.dist + edge->cost) >= row[edge->sw])
+				continue;
+			row[edge->sw] = dist;
+
+			// push; each edge is relaxed at most once so the heap cannot overflow
+			for (pos = heapLen++; pos > 0 && heap[(pos - 1) / 2].dist > dist; pos = (pos - 1) / 2)
+				heap[pos] = heap[(pos - 1) / 2];
+			heap[pos].dist = dist;
+			heap[pos].sw = edge->sw;
+		}
+	}
+
+exit:
+	if (heap)
+		(void)vs_pool_free(&sm_pool, heap);
+	if (done)
+		(void)vs_pool_free(&sm_pool, done);
+}
+
+// Relax one row of the cost matrix through a newly inserted link (u,v).
+static void
+sm_routing_floyds_insert_row(void *context, uint32_t item, uint32_t worker)
+{
+	FloydsInsert_t *insert = (FloydsInsert_t *)context;
+	unsigned short *row = &insert->cost[item * insert->switches];
+	unsigned int viaU = insert->rowU[item] + insert->edgeCost;
+	unsigned int viaV = insert->rowV[item] + insert->edgeCost;
+
+	// rowU/rowV hold the distances from u/v before this insertion, so
+	// rowU[item] is the old cost from this switch to u
+	if (viaU < Cost_Infinity)
+		sm_routing_floyds_minplus(row, insert->rowV, (unsigned short)viaU, insert->switches);
+	if (viaV < Cost_Infinity)
+		sm_routing_floyds_minplus(row, insert->rowU, (unsigned short)viaV, insert->switches);
+}
+
+Status_t
+sm_routing_update_floyds(Topology_t *src_topop, Topology_t *dst_topop)
+{
+	Status_t status;
+	FloydsGraph_t oldGraph, newGraph;
+	FloydsChange_t changes[SM_FLOYDS_INCR_MAX_EDGES];
+	FloydsRepair_t repair;
+	FloydsInsert_t insert;
+	unsigned short *cost, *rowU = NULL, *rowV = NULL;
+	uint8_t *affected = NULL;
+	int switches = dst_topop->max_sws;
+	int numChanges = 0, numRows = 0;
+	int i, k, c, s;
+	uint32_t e;
+	uint16_t oldCost, newCost;
+
+	IB_ENTER(__func__, 0, 0, 0, 0);
+
+	if (  src_topop->cost == NULL
+	   || src_topop->max_sws != switches
+	   || switches <= 0) {
+		IB_EXIT(__func__, VSTATUS_NOSUPPORT);
+		return VSTATUS_NOSUPPORT;
+	}
+
+	memset(&repair, 0, sizeof(repair));
+
+	if ((status = sm_routing_floyds_graph_build(src_topop, &oldGraph)) != VSTATUS_OK) {
+		IB_EXIT(__func__, status);
+		return status;
+	}
+	if ((status = sm_routing_floyds_graph_build(dst_topop, &newGraph)) != VSTATUS_OK) {
+		sm_routing_floyds_graph_free(&oldGraph);
+		IB_EXIT(__func__, status);
+		return status;
+	}
+
+	// Find the links whose cost changed; each one is visited from both ends,
+	// only keep it from the lower switch index.
+	for (i = 0; i < switches && numChanges <= SM_FLOYDS_INCR_MAX_EDGES; i++) {
+		for (e = newGraph.offsets[i]; e < newGraph.offsets[i] + newGraph.counts[i]; e++) {
+			k = newGraph.edges[e].sw;
+			if (k < i)
+				continue;
+			newCost = newGraph.edges[e].cost;
+			oldCost = sm_routing_floyds_graph_cost(&oldGraph, i, k);
+			if (newCost == oldCost)
+				continue;
+			if (numChanges == SM_FLOYDS_INCR_MAX_EDGES) {
+				numChanges++;
+				break;
+			}
+			changes[numChanges++] = (FloydsChange_t){ .u = i, .v = k, .oldCost = oldCost, .newCost = newCost };
+		}
+		for (e = oldGraph.offsets[i]; e < oldGraph.offsets[i] + oldGraph.counts[i]; e++) {
+			k = oldGraph.edges[e].sw;
+			if (k < i || sm_routing_floyds_graph_cost(&newGraph, i, k) != Cost_Infinity)
 				continue;
+			if (numChanges >= SM_FLOYDS_INCR_MAX_EDGES) {
+				numChanges = SM_FLOYDS_INCR_MAX_EDGES + 1;
+				break;
 			}
+			changes[numChanges++] = (FloydsChange_t){ .u = i, .v = k,
+				.oldCost = oldGraph.edges[e].cost, .newCost = Cost_Infinity };
+		}
+	}
 
-			for (j = i + 1, ij = iNumNodes + i + 1, kj = kNumNodes + i + 1;
-			     j < switches; ++j, ++ij, ++kj) {
+	if (numChanges > SM_FLOYDS_INCR_MAX_EDGES) {
+		if (smDebugPerf)
+			IB_LOG_INFINI_INFO0("too many link changes for incremental cost update");
+		status = VSTATUS_NOSUPPORT;
+		goto exit;
+	}
 
-				if ((value = cost[ik] + cost[kj]) < cost[ij]) {
-					cost[ij] = value;
-					// Take advantage of the fact that cost array is symmetric
-					cost[Index(j, i)] = value;
-				}
+	if ((status = sm_routing_alloc_floyds(dst_topop)) != VSTATUS_OK)
+		goto exit;
+	cost = dst_topop->cost;
+	sm_routing_expand_floyds(src_topop, cost);
+
+	// Removed or more expensive links: any switch that could reach one end
+	// of the link through it on a shortest path gets its row rebuilt.
+	if (  vs_pool_alloc(&sm_pool, switches, (void *)&affected) != VSTATUS_OK
+	   || vs_pool_alloc(&sm_pool, switches * sizeof(uint16_t), (void *)&repair.rows) != VSTATUS_OK) {
+		status = VSTATUS_NOMEM;
+		goto exit;
+	}
+	memset(affected, 0, switches);
+
+	for (c = 0; c < numChanges; c++) {
+		FloydsChange_t *chg = &changes[c];
+
+		if (chg->newCost <= chg->oldCost)
+			continue;
+		for (s = 0; s < switches; s++) {
+			unsigned short *row = &cost[s * switches];
+			if (  row[chg->u] + chg->oldCost == row[chg->v]
+			   || row[chg->v] + chg->oldCost == row[chg->u]) {
+				affected[s] = 1;
 			}
 		}
+	}
+
+	for (s = 0; s < switches; s++) {
+		if (affected[s])
+			repair.rows[numRows++] = s;
+	}
+
+	if (numRows > switches / 2) {
+		if (smDebugPerf)
+			IB_LOG_INFINI_INFO0("too many affected switches for incremental cost update");
+		status = VSTATUS_NOSUPPORT;
+		goto exit;
+	}
 
-		if (smDebugPerf && (k & 0xFF) == 0xFF) {
-			IB_LOG_INFINI_INFO_FMT(__func__, "completed run %d of %d", k, switches);
+	if (numRows) {
+		repair.cost = cost;
+		repair.graph = &newGraph;
+		repair.edgeCount = newGraph.offsets[switches];
+		repair.status = VSTATUS_OK;
+		(void)sm_parallel_run(numRows, sm_routing_floyds_repair_row, &repair);
+		if ((status = repair.status) != VSTATUS_OK)
+			goto exit;
+
+		// rows are rebuilt independently; mirror them into their columns
+		for (c = 0; c < numRows; c++) {
+			s = repair.rows[c];
+			for (k = 0; k < switches; k++)
+				cost[k * switches + s] = cost[s * switches + k];
 		}
 	}
 
+	// New or cheaper links: insert them one at a time.
+	if (  vs_pool_alloc(&sm_pool, switches * sizeof(uint16_t), (void *)&rowU) != VSTATUS_OK
+	   || vs_pool_alloc(&sm_pool, switches * sizeof(uint16_t), (void *)&rowV) != VSTATUS_OK) {
+		status = VSTATUS_NOMEM;
+		goto exit;
+	}
+
+	for (c = 0; c < numChanges; c++) {
+		FloydsChange_t *chg = &changes[c];
+
+		if (chg->newCost >= chg->oldCost)
+			continue;
+
+		memcpy(rowU, &cost[chg->u * switches], switches * sizeof(uint16_t));
+		memcpy(rowV, &cost[chg->v * switches], switches * sizeof(uint16_t));
+		insert.cost = cost;
+		insert.switches = switches;
+		insert.rowU = rowU;
+		insert.rowV = rowV;
+		insert.edgeCost = chg->newCost;
+		(void)sm_parallel_run(switches, sm_routing_floyds_insert_row, &insert);
+	}
+
+	if (smDebugPerf) {
+		IB_LOG_INFINI_INFO_FMT(__func__, "incremental cost update: %d link changes, %d rows rebuilt",
+			numChanges, numRows);
+	}
+
+	sm_routing_analyze_floyds(switches, cost);
+
+exit:
+	if (affected)
+		(void)vs_pool_free(&sm_pool, affected);
+	if (repair.rows)
+		(void)vs_pool_free(&sm_pool, repair.rows);
+	if (rowU)
+		(void)vs_pool_free(&sm_pool, rowU);
+	if (rowV)
+		(void)vs_pool_free(&sm_pool, rowV);
+	sm_routing_floyds_graph_free(&oldGraph);
+	sm_routing_floyds_graph_free(&newGraph);
+
+	IB_EXIT(__func__, status);
+	return status;
+}
+
+// Post-pass over a fully computed cost matrix: MC spanning tree root
+// selection and path change detection against the old topology.
+static void
+sm_routing_analyze_floyds(int switches, unsigned short * cost)
+{
+	int i, k;
+	int ik;
+	int iNumNodes;
+	unsigned int total_cost = 0;
+	unsigned int leastTotalCost = 0;
+	unsigned int max_cost = 0;
+	unsigned int leastWorstCaseCost = 0;
+	uint64_t leastWorstCostSwitchGuid = 0;
+	uint64_t leastTotalCostSwitchGuid = 0;
+	unsigned int currRootTotalCost = 0;
+	unsigned int currRootWorstCaseCost = 0;
+	int curr_selection_sm_neighbor = 0;
+	uint8_t	old_root_exists = 0;
+	Node_t *nodep;
+	Node_t *sw = sm_topop->switch_head;
+
 	/* All floyd costs are fully computed now and can be analyzed */
 	for (k = 0; k < switches; k++) {
 		total_cost = 0;
 		max_cost = 0;
-		for (i = 0, iNumNodes = 0, oldiNumNodes = 0; i < switches;
-			 i++, iNumNodes += switches, oldiNumNodes += old_topology.max_sws) {
+		for (i = 0, iNumNodes = 0; i < switches; i++, iNumNodes += switches) {
 
 			ik = iNumNodes + k;
 
@@ -342,9 +961,7 @@ sm_routing_calc_floyds(int switches, unsigned short * cost)
 			if ((k >= old_topology.max_sws) || (i >= old_topology.max_sws))
 				continue;
 
-			oldik = oldiNumNodes + k;
-
-			if (old_topology.cost[oldik] != cost[ik]) {
+			if (sm_cost_get(&old_topology, i, k) != cost[ik]) {
 				topology_cost_path_changes = 1;
 			}			
 		}
@@ -563,6 +1180,7 @@ sm_routing_copy_floyds(Topology_t *src_topop, Topology_t *dst_topop)
 	Status_t status;
 	size_t   bytesCost;
 
+	// the copy is always full so routing hooks may still adjust it
 	bytesCost = src_topop->max_sws * src_topop->max_sws * sizeof(uint16_t);
 
 	status = vs_pool_alloc(&sm_pool, bytesCost, (void *)&dst_topop->cost);
@@ -573,8 +1191,9 @@ sm_routing_copy_floyds(Topology_t *src_topop, Topology_t *dst_topop)
 	}
 
 	dst_topop->bytes = bytesCost;
+	dst_topop->costMode = SM_COST_FULL;
 
-	memcpy((void *)dst_topop->cost, (void *)src_topop->cost, bytesCost);
+	sm_routing_expand_floyds(src_topop, dst_topop->cost);
 
 	return VSTATUS_OK;
 }
@@ -584,7 +1203,6 @@ sm_routing_copy_lfts(Topology_t *src_topop, Topology_t *dst_topop)
 {
 	Status_t status;
 	Node_t   *nodep, *oldNodep;
-	int      lftLength;
 
 	for_all_switch_nodes(dst_topop, nodep) {
 
@@ -618,16 +1236,13 @@ sm_routing_copy_lfts(Topology_t *src_topop, Topology_t *dst_topop)
 		if (nodep->lft) {
 			IB_LOG_INFINI_INFO_FMT(__func__, "new lft - switch %s nodep %p nodep->index %ld nodep->lft %p", 
 														  sm_nodeDescString(nodep),   nodep,   nodep->index,    nodep->lft);
-			vs_pool_free(&sm_pool, nodep->lft);
-			nodep->lft = NULL;
 		}
-		lftLength = sizeof(PORT) * ROUNDUP(nodep->switchInfo.LinearFDBTop+1,MAX_LFT_ELEMENTS_BLOCK);
-		if ((status = vs_pool_alloc(&sm_pool, lftLength, (void *)&nodep->lft)) != VSTATUS_OK) {
+		// Share the old LFT's blocks; sm_setup_lft_deltas() only duplicates the ones it changes.
+		if ((status = sm_lft_share(nodep, oldNodep)) != VSTATUS_OK) {
 			IB_FATAL_ERROR("sm_routing_copy_lfts: CAN'T ALLOCATE SPACE FOR NODE'S LFT;  OUT OF MEMORY IN SM MEMORY POOL!  TOO MANY NODES!!");
 			return status;
 		}
 
-		memcpy((void *)nodep->lft, (void *)oldNodep->lft, lftLength);
 		if (nodep->arSupport) {
 			if (nodep->pgt && oldNodep->pgt) {
 				memcpy((void *)nodep->pgt, (void *)oldNodep->pgt, sizeof(STL_PORTMASK)*(nodep->switchInfo.PortGroupCap));
@@ -719,7 +1334,6 @@ sm_routing_route_old_switch(Topology_t *src_topop, Topology_t *dst_topop, Node_t
 {
 	Status_t status;
 	Node_t   *oldNodep;
-	int      lftLength;
 
 	if (nodep->switchInfo.LinearFDBCap == 0) {
 		IB_LOG_ERROR_FMT(__func__, "switch doesn't support lft %s",
@@ -785,26 +1399,14 @@ sm_routing_route_old_switch(Topology_t *src_topop, Topology_t *dst_topop, Node_t
 	if (nodep->lft) {
 		IB_LOG_INFINI_INFO_FMT(__func__, "new lft - switch %s nodep %p nodep->index %ld nodep->lft %p", 
 																sm_nodeDescString(nodep),   nodep,   nodep->index,    nodep->lft);
-		vs_pool_free(&sm_pool, nodep->lft);
-		nodep->lft = NULL;
 	}
-	// Just additions, adjust LFT blocks with removed or new lids.
-	lftLength = sizeof(PORT) * ROUNDUP(nodep->switchInfo.LinearFDBTop+1,MAX_LFT_ELEMENTS_BLOCK);
-	if ((status = vs_pool_alloc(&sm_pool, lftLength, (void *)&nodep->lft)) != VSTATUS_OK) {
+	// Just additions, adjust LFT blocks with removed or new lids.  The old
+	// blocks are shared until sm_setup_lft_deltas() changes them.
+	if ((status = sm_lft_share(nodep, oldNodep)) != VSTATUS_OK) {
 		IB_FATAL_ERROR("sm_routing_route_old_switch: CAN'T ALLOCATE SPACE FOR NODE'S LFT;  OUT OF MEMORY IN SM MEMORY POOL!  TOO MANY NODES!!");
 		return VSTATUS_NOMEM;	/*calling function can use this value to abort programming old switches*/
 	}
 
-	if (nodep->switchInfo.LinearFDBTop > oldNodep->switchInfo.LinearFDBTop) {
-		memcpy((void *)nodep->lft, (void *)oldNodep->lft, 
-			sizeof(PORT) * (oldNodep->switchInfo.LinearFDBTop + 1));
-		memset((void *)&(nodep->lft[oldNodep->switchInfo.LinearFDBTop + 1]), 
-			0xff, lftLength - oldNodep->switchInfo.LinearFDBTop);
-	} else {
-		memcpy((void *)nodep->lft, (void *)oldNodep->lft, 
-			sizeof(PORT) * (nodep->switchInfo.LinearFDBTop + 1));
-	}
-
 	if (nodep->pgt && oldNodep->pgt) {
 		memcpy((void *)nodep->pgt, (void *)oldNodep->pgt, 
 			sizeof(STL_PORTMASK)*(nodep->switchInfo.PortGroupCap));
@@ -847,7 +1449,7 @@ Status_t sm_routing_route_switch_LR(Topology_t *topop, SwitchList_t *swlist, int
 
 	/* Check and program any old switches in the switch list*/
 	for_switch_list_switches(swlist, sw) {
-		if (!bitset_test(&old_switchesInUse, sw->switchp->swIdx))
+		if (!bitset_test(&old_switchesInUse, sw->switchp->swIdx) || sw->switchp->warmStart)
 			continue;
 		//IB_LOG_INFINI_INFO_FMT(__func__, "routing old switch "FMT_U64, nodep->nodeInfo.NodeGUID);
 		status = sm_routing_route_old_switch(&old_topology, topop, sw->switchp);
@@ -1006,22 +1608,22 @@ Status_t sm_calculate_balanced_lfts_systematic(Topology_t *topop)
 									// In this case, the target LID(s) are directly
 									// connected to the local switchp port.
 									if (!numPorts) {
-										switchp->lft[currentLid] = toSwitchPortp->index;
+										sm_lft_set_port(switchp, currentLid, toSwitchPortp->index);
 										continue;
 									}
 	
 									if (isUp) {
-										switchp->lft[currentLid] = portGroup[(i+upDestCount + switchp->tierIndex*switchp->uplinkTrunkCnt) % numPorts];
+										sm_lft_set_port(switchp, currentLid, portGroup[(i+upDestCount + switchp->tierIndex*switchp->uplinkTrunkCnt) % numPorts]);
 									} else {
-	  									switchp->lft[currentLid] = portGroup[(i+downDestCount + switchp->tierIndex) % numPorts];
+	  									sm_lft_set_port(switchp, currentLid, portGroup[(i+downDestCount + switchp->tierIndex) % numPorts]);
 									}
 	
 									if (sm_config.ftreeRouting.debug) 
 										IB_LOG_INFINI_INFO_FMT(__func__, "Switch %s to %s lid 0x%x outport %d (of %d) tierIndex %d uplinkTrunk %d", 
 											sm_nodeDescString(switchp), sm_nodeDescString(nodep), currentLid,
-											switchp->lft[currentLid], numPorts, switchp->tierIndex, switchp->uplinkTrunkCnt);
+											sm_lft_port(switchp, currentLid), numPorts, switchp->tierIndex, switchp->uplinkTrunkCnt);
 		
-									incr_lids_routed(topop, switchp, switchp->lft[currentLid]);
+									incr_lids_routed(topop, switchp, sm_lft_port(switchp, currentLid));
 	
 									// Disperse lmc lids to different upstream switches
 									if (isUp && (switchp->uplinkTrunkCnt > 1) && switchp->trunkGrouped) {
@@ -1062,7 +1664,7 @@ Status_t sm_calculate_balanced_lfts_systematic(Topology_t *topop)
 					if (!sm_valid_port(portp) || portp->state <= IB_PORT_DOWN) continue;
 					topop->routingModule->funcs.setup_xft(topop, switchp, nodep, portp, portGroup);
 					for_all_port_lids(portp, currentLid) {
-						switchp->lft[currentLid] = portGroup[currentLid - portp->portData->lid];
+						sm_lft_set_port(switchp, currentLid, portGroup[currentLid - portp->portData->lid]);
 					}
 				}
 				if (topop->routingModule->funcs.setup_pgs) {
@@ -1088,7 +1690,6 @@ Status_t sm_calculate_balanced_lfts_systematic(Topology_t *topop)
 
 Status_t sm_copy_balanced_lfts(Topology_t *topop)
 {
-	int			lftLength;
 	Node_t		*switchp, *oldnodep;
 	Port_t		*portp, *oldportp;
 	Status_t	status=VSTATUS_OK;
@@ -1100,13 +1701,14 @@ Status_t sm_copy_balanced_lfts(Topology_t *topop)
 	}
 
 	for_all_switch_nodes(topop, switchp) {
-		lftLength = sizeof(PORT) * ROUNDUP(switchp->switchInfo.LinearFDBTop+1, MAX_LFT_ELEMENTS_BLOCK);
-		if ((status = vs_pool_alloc(&sm_pool, lftLength, (void *)&switchp->lft)) != VSTATUS_OK) {
+		// Share the old LFT's blocks; later changes duplicate only the blocks they touch.
+		oldnodep = switchp->old;
+		status = oldnodep ? sm_lft_share(switchp, oldnodep) : sm_lft_alloc(switchp);
+		if (status != VSTATUS_OK) {
 			IB_FATAL_ERROR("sm_copy_balanced_lfts: CAN'T ALLOCATE SPACE FOR NODE'S LFT;  OUT OF MEMORY IN SM MEMORY POOL!  TOO MANY NODES!!");
 			return VSTATUS_NOMEM;	/*calling function can use this value to abort programming old switches*/
 		}
 
-		oldnodep = switchp->old;
 		if (!oldnodep) {
 			// shouldn't get here
 			continue;
@@ -1117,22 +1719,6 @@ Status_t sm_copy_balanced_lfts(Topology_t *topop)
 		// Don't copy the portgroups if the switch-switch linkage may have changed.
 		boolean copyPgs = (!switchp->initPorts.nset_m && bitset_equal(&switchp->activePorts, &oldnodep->activePorts));
 
-		if (switchp->switchInfo.LinearFDBTop > oldnodep->switchInfo.LinearFDBTop) {
-			memcpy((void *)switchp->lft, (void *)oldnodep->lft, 
-				sizeof(uint8_t) * (oldnodep->switchInfo.LinearFDBTop + 1));
-			if (oldnodep->switchInfo.LinearFDBTop < lftLength) {
-				memset((void *)&(switchp->lft[oldnodep->switchInfo.LinearFDBTop + 1]), 
-					0xff, lftLength - oldnodep->switchInfo.LinearFDBTop - 1);
-			}
-		} else {
-			memcpy((void *)switchp->lft, (void *)oldnodep->lft, 
-				sizeof(uint8_t) * (switchp->switchInfo.LinearFDBTop + 1));
-			if (switchp->switchInfo.LinearFDBTop < lftLength) {
-				memset((void *)&(switchp->lft[switchp->switchInfo.LinearFDBTop + 1]), 
-					0xff, lftLength - switchp->switchInfo.LinearFDBTop - 1);
-			}
-		}
-
 		if (copyPgs) {
 			if (switchp->pgt && oldnodep->pgt) {
 				memcpy((void *)switchp->pgt, (void *)oldnodep->pgt, 
@@ -1235,7 +1821,7 @@ Status_t sm_calculate_balanced_lft_deltas(Topology_t *topop)
 
 			// Remove the HFI from all LFTs.
 			for_all_switch_nodes(topop, switchp) {
-				switchp->lft[lid] = 0xff;
+				sm_lft_set_port(switchp, lid, 0xff);
 				if (curBlock != lid/LFTABLE_LIST_COUNT) {
 					// Set lft block num
 					curBlock = lid/LFTABLE_LIST_COUNT;
@@ -1273,7 +1859,7 @@ Status_t sm_calculate_balanced_lft_deltas(Topology_t *topop)
 		for_all_switch_nodes(topop, switchp) {
 			topop->routingModule->funcs.setup_xft(topop, switchp, nodep, portp, xftPorts);
 			for_all_port_lids(portp, curLid) {
-				switchp->lft[curLid] = xftPorts[curLid - portp->portData->lid];
+				sm_lft_set_port(switchp, curLid, xftPorts[curLid - portp->portData->lid]);
 			}
 		}
 	}
@@ -1362,7 +1948,7 @@ sm_calculate_all_lfts(Topology_t * topop)
 					}
 				}
 				for_all_port_lids(portp, portLid) {
-					switchp->lft[portLid] = xftPorts[portLid - lid];
+					sm_lft_set_port(switchp, portLid, xftPorts[portLid - lid]);
 				}
 			}
 	    }
@@ -237,7 +237,7 @@ _select_ports(Topology_t *topop, Node_t *switchp, int endIndex, SwitchportToNext
 
 	i = switchp->swIdx;
 	j = endIndex;
-	best_cost = topop->cost[Index(i, j)];
+	best_cost = sm_cost_get(topop, i, j);
 	_spine_first_reset(&sfstate);
 
 	for_all_physical_ports(switchp, portp) {
@@ -254,7 +254,7 @@ _select_ports(Topology_t *topop, Node_t *switchp, int endIndex, SwitchportToNext
 		k = next_nodep->swIdx;
 		if (i == k) continue; // avoid loopback links
 
-		if (topop->cost[Index(i, k)] + topop->cost[Index(k, j)] == best_cost) {
+		if (sm_cost_get(topop, i, k) + sm_cost_get(topop, k, j) == best_cost) {
 			sfres = _spine_first_test(&sfstate, switchp, portp, next_nodep);
 			switch (sfres) {
 			case SPINE_FIRST_FIRST:
@@ -315,6 +315,58 @@ _select_ports(Topology_t *topop, Node_t *switchp, int endIndex, SwitchportToNext
 	return end_port;
 }
 
+// Candidate ports of one switch collected by
+// sm_shortestpath_calculate_all_lfts_parallel(): ports[first[j]] up to
+// ports[first[j+1]] are the port indices _select_ports() returns toward
+// switch j when selectBest is not set.
+typedef struct {
+	uint32_t	*first;		// max_sws + 1 entries
+	uint8_t		*ports;
+} LftCandidates_t;
+
+// _select_ports(), or the same selection made from previously collected
+// candidate ports when cand is given.
+static int
+_get_ports(Topology_t *topop, Node_t *switchp, int endIndex, SwitchportToNextGuid_t *ordered_ports,
+	boolean selectBest, const LftCandidates_t *cand)
+{
+	uint32_t k;
+	uint16_t best_lidsRouted = 0xffff;
+	uint32_t best_switchLidsRouted = 0xffffffff;
+	int      end_port = 0;
+	Node_t   *next_nodep;
+	Port_t   *portp;
+
+	if (!cand)
+		return _select_ports(topop, switchp, endIndex, ordered_ports, selectBest);
+
+	for (k = cand->first[endIndex]; k < cand->first[endIndex + 1]; k++) {
+		portp = sm_get_port(switchp, cand->ports[k]);
+		next_nodep = sm_find_node(topop, portp->nodeno);
+
+		if (selectBest) {
+			// candidates all have the best speed, so _select_ports() keeps
+			// the first one with the fewest LIDs routed
+			if (portp->portData->lidsRouted < best_lidsRouted ||
+				(portp->portData->lidsRouted == best_lidsRouted &&
+				next_nodep->numLidsRouted < best_switchLidsRouted)) {
+				best_lidsRouted = portp->portData->lidsRouted;
+				best_switchLidsRouted = next_nodep->numLidsRouted;
+				end_port = 0;
+			} else {
+				continue;
+			}
+		}
+
+		ordered_ports[end_port].portp = portp;
+		ordered_ports[end_port].guid = next_nodep->nodeInfo.NodeGUID;
+		ordered_ports[end_port].nextSwp = next_nodep;
+		++end_port;
+	}
+
+	return end_port;
+}
+
 static void
 _balance_ports(Node_t *switchp, SwitchportToNextGuid_t *ordered_ports, int olen)
 {
@@ -345,7 +397,7 @@ static int
 _get_port_group(Topology_t *topop, Node_t *switchp, Node_t *nodep, uint8_t *portnos) {
 	int i, j;
 	int end_port = 0;
-	SwitchportToNextGuid_t *ordered_ports = (SwitchportToNextGuid_t *)topop->pad;
+	SwitchportToNextGuid_t *ordered_ports = sm_lft_ordered_ports(topop, switchp);
 
 	IB_ENTER(__func__, switchp, nodep, 0, 0);
 	
@@ -386,13 +438,16 @@ _get_port_group(Topology_t *topop, Node_t *switchp, Node_t *nodep, uint8_t *port
 //	out what the path is through the fabric in order to setup the routing
 //	tables.
 //  See sm_l.h for parameter documentation
+//  cand is NULL, or the candidate ports collected for switchp by
+//  sm_shortestpath_calculate_all_lfts_parallel().
 static Status_t
-_setup_xft(Topology_t *topop, Node_t *switchp, Node_t *nodep, Port_t *orig_portp, uint8_t *portnos) {
+_setup_xft_ports(Topology_t *topop, Node_t *switchp, Node_t *nodep, Port_t *orig_portp,
+	uint8_t *portnos, const LftCandidates_t *cand) {
 	int i, j;
 	uint8_t numLids;
 	int lidsRoutedInc;
 	int offset=0;
-	SwitchportToNextGuid_t *ordered_ports = (SwitchportToNextGuid_t *)topop->pad;
+	SwitchportToNextGuid_t *ordered_ports = sm_lft_ordered_ports(topop, switchp);
 	int end_port = 0;
 
 	IB_ENTER(__func__, switchp, nodep, orig_portp, 0);
@@ -443,7 +498,7 @@ _setup_xft(Topology_t *topop, Node_t *switchp, Node_t *nodep, Port_t *orig_portp
 		memset(ordered_ports, 0, sizeof(SwitchportToNextGuid_t));
 
 		// select best port, _select_ports will return 1 or 0 (no path)
-		if ((end_port = _select_ports(topop, switchp, j, ordered_ports, 1)) == 0) {
+		if ((end_port = _get_ports(topop, switchp, j, ordered_ports, 1, cand)) == 0) {
 			IB_LOG_ERROR_FMT(__func__,
 				"Failed to find an outbound port on NodeGUID "FMT_U64" to NodeGUID "FMT_U64" Port %d",
 				switchp->nodeInfo.NodeGUID, nodep->nodeInfo.NodeGUID, orig_portp->index);
@@ -462,7 +517,7 @@ _setup_xft(Topology_t *topop, Node_t *switchp, Node_t *nodep, Port_t *orig_portp
 	} else { // lmc > 0
 		memset(ordered_ports, 0, sizeof(SwitchportToNextGuid_t) * switchp->nodeInfo.NumPorts);
 
-		end_port = _select_ports(topop, switchp, j, ordered_ports, 0);
+		end_port = _get_ports(topop, switchp, j, ordered_ports, 0, cand);
 		if (!end_port) {
 			IB_LOG_ERROR_FMT(__func__,
 				"Failed to find outbound ports on NodeGUID "FMT_U64" to NodeGUID "FMT_U64" Port %d",
@@ -502,16 +557,23 @@ _setup_xft(Topology_t *topop, Node_t *switchp, Node_t *nodep, Port_t *orig_portp
 	return VSTATUS_OK;
 }
 
+static Status_t
+_setup_xft(Topology_t *topop, Node_t *switchp, Node_t *nodep, Port_t *orig_portp, uint8_t *portnos) {
+	return _setup_xft_ports(topop, switchp, nodep, orig_portp, portnos, NULL);
+}
+
 static Status_t
 _setup_pgs(struct _Topology *topop, struct _Node * srcSw, const struct _Node * dstSw)
 {
-	SwitchportToNextGuid_t * ordered_ports = (SwitchportToNextGuid_t*) topop->pad;
+	SwitchportToNextGuid_t * ordered_ports;
 
 	if (!srcSw || !dstSw) {
 		IB_LOG_ERROR_FMT(__func__, "Invalid source or destination pointer.");
 		return VSTATUS_BAD;
 	}
 
+	ordered_ports = sm_lft_ordered_ports(topop, srcSw);
+
 	if (srcSw->nodeInfo.NodeType != NI_TYPE_SWITCH) {
 		IB_LOG_ERROR_FMT(__func__, "%s (0x%"PRIx64") is not a switch.",
 			srcSw->nodeDesc.NodeString,
@@ -1355,6 +1417,247 @@ _init_switch_lfts_ft(Topology_t * topop, int * routing_needed, int * rebalance)
 	return s;
 }
 
+// -------------------------------------------------------------------------- //
+//
+//	Parallel version of the balanced LFT calculation.  Most of the time in
+//	_setup_xft() goes to _select_ports() walking the ports of the switch, and
+//	without selectBest its result depends only on the cost matrix and the
+//	links, not on the lidsRouted/numLidsRouted balancing counters.  The same
+//	holds for the port groups built by setup_pgs.  So the worker pool
+//	collects every switch's candidate ports and builds its port groups, then
+//	the balancing choices are replayed serially over the candidates in the
+//	order the serial calculation makes them.  The counters and the resulting
+//	LFTs are therefore identical to the serial calculation.
+//
+
+typedef struct {
+	Topology_t		*topop;
+	Node_t			**switches;		// work item to switch
+	Node_t			**swByIdx;		// swIdx to switch
+	LftCandidates_t	**candidates;	// by swIdx
+	LftDest_t		*dests;
+	uint32_t		numDests;
+	Status_t		*status;		// per work item
+	LftWorkspace_t	*workspace;		// per pool thread
+} LftParallel_t;
+
+static void
+_lft_candidates_worker(void *context, uint32_t item, uint32_t worker)
+{
+	LftParallel_t *lp = (LftParallel_t *)context;
+	Topology_t *topop = lp->topop;
+	LftWorkspace_t *ws = &lp->workspace[worker];
+	Node_t *switchp = lp->switches[item];
+	LftCandidates_t *cand;
+	Status_t status = VSTATUS_OK;
+	uint32_t j, d, n = 0;
+	int k, end_port;
+
+	switchp->lftWorkspace = ws;
+
+	for (j = 0; j < topop->max_sws; j++) {
+		ws->first[j] = n;
+		if (lp->swByIdx[j] == NULL || j == switchp->swIdx)
+			continue;
+		end_port = _select_ports(topop, switchp, j, ws->orderedPorts, 0);
+		for (k = 0; k < end_port; k++)
+			ws->ports[n++] = ws->orderedPorts[k].portp->index;
+	}
+	ws->first[j] = n;
+
+	// port groups only depend on the candidates, build them in the order
+	// the serial calculation does for this switch
+	if (topop->routingModule->funcs.setup_pgs) {
+		for (d = 0; d < lp->numDests && status == VSTATUS_OK; d++) {
+			if (lp->dests[d].nodep->nodeInfo.NodeType == NI_TYPE_SWITCH)
+				status = topop->routingModule->funcs.setup_pgs(topop, switchp, lp->dests[d].nodep);
+		}
+	}
+
+	switchp->lftWorkspace = NULL;
+
+	if (status == VSTATUS_OK) {
+		if (vs_pool_alloc(&sm_pool, sizeof(LftCandidates_t)
+				+ (topop->max_sws + 1) * sizeof(uint32_t) + n, (void *)&cand) != VSTATUS_OK) {
+			status = VSTATUS_NOMEM;
+		} else {
+			cand->first = (uint32_t *)(cand + 1);
+			cand->ports = (uint8_t *)(cand->first + topop->max_sws + 1);
+			memcpy(cand->first, ws->first, (topop->max_sws + 1) * sizeof(uint32_t));
+			memcpy(cand->ports, ws->ports, n);
+			lp->candidates[switchp->swIdx] = cand;
+		}
+	}
+	lp->status[item] = status;
+}
+
+/*
+ * Parallel alternative to sm_calculate_all_lfts() and the dgshortestpath
+ * equivalent.  dests lists the destination ports in the order the serial
+ * calculation visits them; with edgeFirst set every destination is routed
+ * on the edge switches before any other switch, as sm_calculate_all_lfts()
+ * does.
+ */
+Status_t
+sm_shortestpath_calculate_all_lfts_parallel(Topology_t *topop, LftDest_t *dests,
+	uint32_t numDests, int edgeFirst)
+{
+	LftParallel_t lp;
+	Node_t *switchp, *nodep;
+	Port_t *portp;
+	Status_t status = VSTATUS_OK;
+	uint32_t threads = sm_parallel_threads();
+	uint32_t switches = 0, maxPorts = 0, t, i, d;
+	size_t size;
+	uint8_t *scratch;
+	int pass;
+	uint16_t portLid;
+	uint8_t xftPorts[256];
+	uint64_t sTime, eTime;
+
+	if (smDebugPerf)
+		vs_time_get(&sTime);
+
+	for_all_switch_nodes(topop, switchp) {
+		status = sm_Node_init_lft(switchp, NULL);
+		if (status != VSTATUS_OK) {
+			IB_LOG_ERROR_FMT(__func__, "Failed to allocate space for LFT.");
+			return status;
+		}
+		switches++;
+		maxPorts = MAX(maxPorts, switchp->nodeInfo.NumPorts);
+	}
+	if (switches == 0)
+		return VSTATUS_OK;
+
+	memset(&lp, 0, sizeof(lp));
+	lp.topop = topop;
+	lp.dests = dests;
+	lp.numDests = numDests;
+
+	// the per thread candidate scratch is carved out of one allocation
+	// after the workspaces
+	size = threads * (sizeof(LftWorkspace_t)
+		 + (topop->max_sws + 1) * sizeof(uint32_t) + topop->max_sws * maxPorts);
+	if (  vs_pool_alloc(&sm_pool, switches * sizeof(Node_t *), (void *)&lp.switches) != VSTATUS_OK
+	   || vs_pool_alloc(&sm_pool, switches * sizeof(Status_t), (void *)&lp.status) != VSTATUS_OK
+	   || vs_pool_alloc(&sm_pool, topop->max_sws * sizeof(Node_t *), (void *)&lp.swByIdx) != VSTATUS_OK
+	   || vs_pool_alloc(&sm_pool, topop->max_sws * sizeof(LftCandidates_t *), (void *)&lp.candidates) != VSTATUS_OK
+	   || vs_pool_alloc(&sm_pool, size, (void *)&lp.workspace) != VSTATUS_OK) {
+		IB_LOG_ERROR_FMT(__func__, "Failed to allocate LFT workspace for %u switches", switches);
+		status = VSTATUS_NOMEM;
+		goto exit;
+	}
+	memset(lp.swByIdx, 0, topop->max_sws * sizeof(Node_t *));
+	memset(lp.candidates, 0, topop->max_sws * sizeof(LftCandidates_t *));
+
+	scratch = (uint8_t *)&lp.workspace[threads];
+	for (t = 0; t < threads; t++) {
+		lp.workspace[t].first = (uint32_t *)scratch;
+		scratch += (topop->max_sws + 1) * sizeof(uint32_t);
+		lp.workspace[t].ports = scratch;
+		scratch += topop->max_sws * maxPorts;
+	}
+
+	i = 0;
+	for_all_switch_nodes(topop, switchp) {
+		lp.switches[i++] = switchp;
+		lp.swByIdx[switchp->swIdx] = switchp;
+	}
+
+	(void)sm_parallel_run(switches, _lft_candidates_worker, &lp);
+
+	// report the first failure in switch list order
+	for (i = 0; i < switches; i++) {
+		if (lp.status[i] != VSTATUS_OK) {
+			status = lp.status[i];
+			IB_LOG_ERROR_FMT(__func__, "Failed to collect routes for %s (0x%"PRIx64")",
+				sm_nodeDescString(lp.switches[i]), lp.switches[i]->nodeInfo.NodeGUID);
+			goto exit;
+		}
+	}
+
+	// replay the balancing in serial order
+	for (pass = 0; pass < (edgeFirst ? 2 : 1); pass++) {
+		for (d = 0; d < numDests; d++) {
+			nodep = dests[d].nodep;
+			portp = dests[d].portp;
+			for_all_switch_nodes(topop, switchp) {
+				if (edgeFirst && (pass==0) && !switchp->edgeSwitch) continue;
+				if (edgeFirst && (pass==1) && switchp->edgeSwitch) continue;
+				status = _setup_xft_ports(topop, switchp, nodep, portp, xftPorts,
+					lp.candidates[switchp->swIdx]);
+				if (status != VSTATUS_OK) {
+					IB_LOG_ERROR_FMT(__func__, "Failed to setup xft for %s (0x%"PRIx64")",
+						nodep->nodeDesc.NodeString,
+						nodep->nodeInfo.NodeGUID);
+					goto exit;
+				}
+				for_all_port_lids(portp, portLid) {
+					sm_lft_set_port(switchp, portLid, xftPorts[portLid - portp->portData->lid]);
+				}
+			}
+		}
+	}
+
+	if (smDebugPerf) {
+		vs_time_get(&eTime);
+		IB_LOG_INFINI_INFO_FMT(__func__, "%u switches on %u threads; elapsed time(usec)=%d",
+			switches, threads, (int)(eTime-sTime));
+	}
+
+exit:
+	if (lp.candidates) {
+		for (i = 0; i < topop->max_sws; i++) {
+			if (lp.candidates[i])
+				vs_pool_free(&sm_pool, lp.candidates[i]);
+		}
+		vs_pool_free(&sm_pool, lp.candidates);
+	}
+	if (lp.workspace)
+		vs_pool_free(&sm_pool, lp.workspace);
+	if (lp.swByIdx)
+		vs_pool_free(&sm_pool, lp.swByIdx);
+	if (lp.status)
+		vs_pool_free(&sm_pool, lp.status);
+	if (lp.switches)
+		vs_pool_free(&sm_pool, lp.switches);
+	return status;
+}
+
+// Parallel sm_calculate_all_lfts(): destinations in LID order.
+static Status_t
+_calculate_all_lfts_parallel(Topology_t * topop)
+{
+	LftDest_t *dests;
+	Node_t *nodep;
+	Port_t *portp;
+	Status_t status;
+	uint32_t lid, numDests = 0;
+
+	if (vs_pool_alloc(&sm_pool, (topop->maxLid + 1) * sizeof(LftDest_t), (void *)&dests) != VSTATUS_OK) {
+		IB_LOG_ERROR_FMT(__func__, "Failed to allocate LFT destination list.");
+		return VSTATUS_NOMEM;
+	}
+
+	for (lid = 0; lid <= topop->maxLid; ++lid) {
+		// only the base LID of each port, as sm_calculate_all_lfts() programs
+		// the entire LMC range in one go
+		nodep = lidmap[lid].newNodep;
+		portp = lidmap[lid].newPortp;
+		if (nodep == NULL || !sm_valid_port(portp)
+			|| portp->state <= IB_PORT_DOWN || lid != portp->portData->lid)
+			continue;
+		dests[numDests].nodep = nodep;
+		dests[numDests].portp = portp;
+		numDests++;
+	}
+
+	status = sm_shortestpath_calculate_all_lfts_parallel(topop, dests, numDests, 1);
+	vs_pool_free(&sm_pool, dests);
+	return status;
+}
+
 static Status_t
 _init_switch_lfts_sp(Topology_t * topop, int * routing_needed, int * rebalance)
 {
@@ -1367,7 +1670,10 @@ _init_switch_lfts_sp(Topology_t * topop, int * routing_needed, int * rebalance)
 	if (*routing_needed) {
 		// A topology change was indicated.  Re-calculate lfts with big hammer (rebalance).
 		// If not, copy and delta updates handled by main topology method.
-		s = sm_calculate_all_lfts(topop);
+		if (sm_config.parallel_lft)
+			s = _calculate_all_lfts_parallel(topop);
+		else
+			s = sm_calculate_all_lfts(topop);
 		*rebalance = 1;
 	}
 
@@ -0,0 +1,839 @@
+/* BEGIN_ICS_COPYRIGHT7 ****************************************
+
+Copyright (c) 2015, Intel Corporation
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Intel Corporation nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+** END_ICS_COPYRIGHT7   ****************************************/
+
+/* [ICS VERSION STRING: unknown] */
+
+//
+// Warm start snapshot.
+//
+// At the end of a sweep which changed routing or multicast state the master
+// writes the routed fabric to sm_config.warm_start_file: every node and
+// active link keyed by GUID, the assigned LIDs, each switch's LFT, PGT, PGFT
+// and MFT, the multicast groups and the cost matrix.  Unlike sm_dump_state()
+// nothing in the file is a pointer, so it can be read back by another
+// process.
+//
+// On the first sweep after the SM starts, sm_snapshot_restore() compares the
+// snapshot with what discovery found.  If every node, link and LID is the
+// same it seeds the cost matrix and forwarding tables from the file and
+// restores the multicast groups, so the sweep does not run Floyd's.  Only a
+// switch whose own SwitchInfo and PortInfo, as read by discovery, show it
+// kept its tables is marked as already programmed; a switch which was
+// rebooted or power cycled is programmed from the restored tables like a
+// new one.  sm_snapshot_match_mfts() does the same for each switch's MFT
+// once multicast routing has been calculated.  Any difference in the fabric
+// and the sweep proceeds exactly as a cold start.
+//
+// The file is host byte order; the version must change with any layout.
+//
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include "ib_types.h"
+#include "sm_l.h"
+
+#define SM_SNAPSHOT_MAGIC		0x534d5753		// "SMWS"
+#define SM_SNAPSHOT_VERSION		1
+
+typedef struct _SmSnapHdr {
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	length;			// bytes following the header
+	uint32_t	checksum;		// CRC-32 of the bytes following the header
+} SmSnapHdr_t;
+
+typedef struct _SmSnapFabric {
+	uint64_t	smPortGuid;
+	uint32_t	smChecksum;		// sm_config.overall_checksum
+	uint32_t	vfChecksum;		// VirtualFabrics_t.overall_checksum
+	char		routingAlgorithm[STRING_SIZE];
+	uint32_t	maxLid;
+	uint32_t	numNodes;
+	uint32_t	numSws;
+	uint32_t	numGroups;
+	uint32_t	mftEntries;		// MFT rows stored for each switch
+	uint32_t	reserved;
+} SmSnapFabric_t;
+
+// followed by numLinks SmSnapPort_t and, for switches, an SmSnapSwitch_t
+typedef struct _SmSnapNode {
+	uint64_t	nodeGuid;
+	uint8_t		nodeType;
+	uint8_t		numPorts;
+	uint16_t	numLinks;
+	uint32_t	reserved;
+} SmSnapNode_t;
+
+typedef struct _SmSnapPort {
+	uint64_t	portGuid;
+	uint64_t	nbrNodeGuid;	// 0 for switch port 0
+	uint32_t	lid;
+	uint8_t		portNum;
+	uint8_t		nbrPortNum;
+	uint8_t		lmc;
+	uint8_t		reserved;
+} SmSnapPort_t;
+
+// followed by the LFT blocks, PGT, PGFT and mftEntries MFT rows
+typedef struct _SmSnapSwitch {
+	uint32_t	lftBlocks;		// MAX_LFT_ELEMENTS_BLOCK entries each
+	uint32_t	pgftSize;		// PGFT entries, 0 if none
+	uint16_t	pgtLen;			// PGT entries
+	uint16_t	portGroupTop;
+	uint32_t	reserved;
+} SmSnapSwitch_t;
+
+// one per group, followed by membercount SmSnapMember_t
+typedef McGroupSync_t SmSnapGroup_t;
+
+typedef struct _SmSnapMember {
+	uint64_t			nodeGuid;
+	uint64_t			portGuid;
+	STL_MCMEMBER_RECORD	record;
+	uint32_t			index;
+	Lid_t				slid;
+	uint8_t				proxy;
+	uint8_t				state;
+} SmSnapMember_t;
+
+// the cost matrix closes the file: numSws * (numSws - 1) / 2 uint16_t, the
+// upper triangle in the order the switches appear
+
+typedef struct _SmSnapCursor {
+	const uint8_t	*p;
+	const uint8_t	*end;
+} SmSnapCursor_t;
+
+static uint8_t		*snapBuf;			// loaded snapshot body
+static uint32_t		snapLen;
+static int			snapTried;			// only the first master sweep may warm start
+static int			snapStale = 1;		// the file no longer describes old_topology
+static uint32_t		crcTable[256];
+
+static uint32_t
+snap_crc(uint32_t crc, const void *data, size_t len)
+{
+	const uint8_t *p = (const uint8_t *)data;
+	uint32_t c;
+	int i, j;
+
+	if (!crcTable[1]) {
+		for (i = 0; i < 256; i++) {
+			for (c = i, j = 0; j < 8; j++)
+				c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+			crcTable[i] = c;
+		}
+	}
+
+	crc = ~crc;
+	while (len--)
+		crc = crcTable[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}
+
+static const void *
+snap_get(SmSnapCursor_t *cur, size_t len)
+{
+	const void *p = cur->p;
+
+	if ((size_t)(cur->end - cur->p) < len)
+		return NULL;
+	cur->p += len;
+	return p;
+}
+
+static int
+snap_read(SmSnapCursor_t *cur, void *dst, size_t len)
+{
+	const void *p = snap_get(cur, len);
+
+	if (!p)
+		return 0;
+	memcpy(dst, p, len);
+	return 1;
+}
+
+static int
+snap_write(FILE *f, uint32_t *crc, const void *data, size_t len)
+{
+	if (len && fwrite(data, len, 1, f) != 1)
+		return 0;
+	*crc = snap_crc(*crc, data, len);
+	return 1;
+}
+
+static int
+snap_link_port(const Node_t *nodep, const Port_t *portp)
+{
+	if (!sm_valid_port((Port_t *)portp) || portp->state <= IB_PORT_DOWN)
+		return 0;
+	// switch port 0 has no link but carries the switch LID
+	return portp->index != 0 || nodep->nodeInfo.NodeType == NI_TYPE_SWITCH;
+}
+
+//
+// A switch which lost power or rebooted since the snapshot was taken comes
+// back with no LID, its default LinearFDBTop and its links in INIT.  Trust
+// its tables only if what discovery read from it says otherwise.
+//
+static int
+snap_switch_loaded(Node_t *nodep, const SmSnapFabric_t *fab, uint32_t lid)
+{
+	Port_t *portp;
+
+	if (  nodep->discoveredLid != lid
+	   || nodep->discoveredFDBTop != MIN(fab->maxLid, nodep->switchInfo.LinearFDBCap))
+		return 0;
+	for_all_physical_ports(nodep, portp) {
+		if (snap_link_port(nodep, portp) && portp->state != IB_PORT_ACTIVE)
+			return 0;
+	}
+	return 1;
+}
+
+static uint32_t
+snap_mft_entries(void)
+{
+	Lid_t maxMcLid = sm_multicast_get_max_lid();
+
+	if (maxMcLid < MULTICAST_LID_MIN)
+		return 0;
+	return MIN((uint32_t)(maxMcLid - MULTICAST_LID_MIN + 1), sm_mcast_mlid_table_cap);
+}
+
+void
+sm_snapshot_invalidate(void)
+{
+	snapStale = 1;
+}
+
+static void
+sm_snapshot_release(void)
+{
+	if (snapBuf) {
+		(void)vs_pool_free(&sm_pool, snapBuf);
+		snapBuf = NULL;
+		snapLen = 0;
+	}
+}
+
+//
+// Write topop to sm_config.warm_start_file if anything it routes has
+// changed since the last write.  The file is replaced atomically.
+//
+Status_t
+sm_snapshot_save(Topology_t *topop)
+{
+	char tmpName[FILENAME_SIZE + 8];
+	SmSnapHdr_t hdr;
+	SmSnapFabric_t fab;
+	SmSnapNode_t snode;
+	SmSnapPort_t sport;
+	SmSnapSwitch_t ssw;
+	SmSnapGroup_t sgrp;
+	SmSnapMember_t smem;
+	McGroup_t *mcgp;
+	McMember_t *mcmp;
+	Node_t *nodep, *nbrp, **sws = NULL;
+	Port_t *portp;
+	uint32_t crc = 0, i, j, numSws = 0;
+	uint16_t cost;
+	long length;
+	int ok = 1;
+	FILE *f;
+
+	// what was restored has served its purpose
+	sm_snapshot_release();
+
+	if (!sm_config.warm_start_file[0] || !snapStale || topop->num_nodes == 0)
+		return VSTATUS_OK;
+
+	if (topop->num_sws && vs_pool_alloc(&sm_pool, topop->num_sws * sizeof(Node_t *),
+										(void *)&sws) != VSTATUS_OK) {
+		IB_LOG_WARN("can't allocate warm start snapshot switch list; switches:", topop->num_sws);
+		return VSTATUS_NOMEM;
+	}
+
+	snprintf(tmpName, sizeof(tmpName), "%s.tmp", sm_config.warm_start_file);
+	if ((f = fopen(tmpName, "w")) == NULL) {
+		IB_LOG_WARN_FMT(__func__, "Can't create warm start snapshot %s: %s",
+			tmpName, strerror(errno));
+		if (sws)
+			(void)vs_pool_free(&sm_pool, sws);
+		return VSTATUS_BAD;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	ok = (fwrite(&hdr, sizeof(hdr), 1, f) == 1);
+
+	memset(&fab, 0, sizeof(fab));
+	fab.smPortGuid = sm_smInfo.PortGUID;
+	fab.smChecksum = sm_config.overall_checksum;
+	fab.vfChecksum = topop->vfs_ptr ? topop->vfs_ptr->overall_checksum : 0;
+	snprintf(fab.routingAlgorithm, sizeof(fab.routingAlgorithm), "%s", sm_config.routing_algorithm);
+	fab.maxLid = topop->maxLid;
+	fab.numNodes = topop->num_nodes;
+	fab.numSws = topop->num_sws;
+
+	(void)vs_lock(&sm_McGroups_lock);
+	fab.mftEntries = snap_mft_entries();
+	for_all_multicast_groups(mcgp)
+		++fab.numGroups;
+	ok = ok && snap_write(f, &crc, &fab, sizeof(fab));
+
+	for_all_nodes(topop, nodep) {
+		if (!ok)
+			break;
+		memset(&snode, 0, sizeof(snode));
+		snode.nodeGuid = nodep->nodeInfo.NodeGUID;
+		snode.nodeType = nodep->nodeInfo.NodeType;
+		snode.numPorts = nodep->nodeInfo.NumPorts;
+		for_all_ports(nodep, portp) {
+			if (snap_link_port(nodep, portp))
+				++snode.numLinks;
+		}
+		ok = snap_write(f, &crc, &snode, sizeof(snode));
+
+		for_all_ports(nodep, portp) {
+			if (!ok || !snap_link_port(nodep, portp))
+				continue;
+			memset(&sport, 0, sizeof(sport));
+			sport.portGuid = portp->portData->guid;
+			sport.lid = portp->portData->lid;
+			sport.lmc = portp->portData->lmc;
+			sport.portNum = portp->index;
+			if (portp->index != 0 && (nbrp = sm_find_node(topop, portp->nodeno)) != NULL) {
+				sport.nbrNodeGuid = nbrp->nodeInfo.NodeGUID;
+				sport.nbrPortNum = portp->portno;
+			}
+			ok = snap_write(f, &crc, &sport, sizeof(sport));
+		}
+
+		if (!ok || nodep->nodeInfo.NodeType != NI_TYPE_SWITCH)
+			continue;
+
+		if (numSws < topop->num_sws)
+			sws[numSws++] = nodep;
+
+		memset(&ssw, 0, sizeof(ssw));
+		ssw.lftBlocks = nodep->lft ? nodep->lft->numBlocks : 0;
+		ssw.pgftSize = nodep->pgft ? (uint32_t)sm_Node_get_pgft_size(nodep) : 0;
+		ssw.pgtLen = nodep->pgt ? nodep->pgtLen : 0;
+		ssw.portGroupTop = nodep->switchInfo.PortGroupTop;
+		ok = snap_write(f, &crc, &ssw, sizeof(ssw));
+
+		for (i = 0; ok && i < ssw.lftBlocks; i++)
+			ok = snap_write(f, &crc, sm_lft_block(nodep, i), MAX_LFT_ELEMENTS_BLOCK);
+		if (ok && ssw.pgtLen)
+			ok = snap_write(f, &crc, nodep->pgt, ssw.pgtLen * sizeof(STL_PORTMASK));
+		if (ok && ssw.pgftSize)
+			ok = snap_write(f, &crc, sm_Node_get_pgft(nodep), ssw.pgftSize * sizeof(PORT));
+		for (i = 0; ok && i < fab.mftEntries; i++) {
+			STL_PORTMASK row[STL_MFTABLE_POSITION_COUNT];
+
+			if (nodep->mft)
+				memcpy(row, nodep->mft[i], sizeof(row));
+			else
+				memset(row, 0, sizeof(row));
+			ok = snap_write(f, &crc, row, sizeof(row));
+		}
+	}
+
+	for_all_multicast_groups(mcgp) {
+		if (!ok)
+			break;
+		memset(&sgrp, 0, sizeof(sgrp));
+		memcpy(&sgrp.mGid, &mcgp->mGid, sizeof(IB_GID));
+		sgrp.members_full = mcgp->members_full;
+		sgrp.qKey = mcgp->qKey;
+		sgrp.pKey = mcgp->pKey;
+		sgrp.mLid = mcgp->mLid;
+		sgrp.mtu = mcgp->mtu;
+		sgrp.rate = mcgp->rate;
+		sgrp.life = mcgp->life;
+		sgrp.sl = mcgp->sl;
+		sgrp.flowLabel = mcgp->flowLabel;
+		sgrp.hopLimit = mcgp->hopLimit;
+		sgrp.tClass = mcgp->tClass;
+		sgrp.scope = mcgp->scope;
+		sgrp.index_pool = mcgp->index_pool;
+		for_all_multicast_members(mcgp, mcmp)
+			++sgrp.membercount;
+		ok = snap_write(f, &crc, &sgrp, sizeof(sgrp));
+
+		for_all_multicast_members(mcgp, mcmp) {
+			if (!ok)
+				break;
+			memset(&smem, 0, sizeof(smem));
+			smem.nodeGuid = mcmp->nodeGuid;
+			smem.portGuid = mcmp->portGuid;
+			smem.record = mcmp->record;
+			smem.index = mcmp->index;
+			smem.slid = mcmp->slid;
+			smem.proxy = mcmp->proxy;
+			smem.state = mcmp->state;
+			ok = snap_write(f, &crc, &smem, sizeof(smem));
+		}
+	}
+	(void)vs_unlock(&sm_McGroups_lock);
+
+	for (i = 0; ok && i < numSws; i++) {
+		for (j = i + 1; ok && j < numSws; j++) {
+			cost = sm_cost_get(topop, sws[i]->swIdx, sws[j]->swIdx);
+			ok = snap_write(f, &crc, &cost, sizeof(cost));
+		}
+	}
+
+	if (ok && (length = ftell(f)) > 0) {
+		hdr.magic = SM_SNAPSHOT_MAGIC;
+		hdr.version = SM_SNAPSHOT_VERSION;
+		hdr.length = (uint32_t)(length - sizeof(hdr));
+		hdr.checksum = crc;
+		ok = (fseek(f, 0, SEEK_SET) == 0 && fwrite(&hdr, sizeof(hdr), 1, f) == 1);
+	} else {
+		ok = 0;
+	}
+	ok = (fclose(f) == 0) && ok;
+	if (sws)
+		(void)vs_pool_free(&sm_pool, sws);
+
+	if (!ok || rename(tmpName, sm_config.warm_start_file) != 0) {
+		IB_LOG_WARN_FMT(__func__, "Failed to write warm start snapshot %s: %s",
+			sm_config.warm_start_file, strerror(errno));
+		(void)unlink(tmpName);
+		return VSTATUS_BAD;
+	}
+
+	snapStale = 0;
+	IB_LOG_INFO_FMT(__func__, "Wrote warm start snapshot %s: %u nodes, %u switches, %u bytes",
+		sm_config.warm_start_file, fab.numNodes, fab.numSws, (unsigned)(hdr.length + sizeof(hdr)));
+	return VSTATUS_OK;
+}
+
+static Status_t
+sm_snapshot_load(void)
+{
+	SmSnapHdr_t hdr;
+	Status_t status;
+	FILE *f;
+
+	if ((f = fopen(sm_config.warm_start_file, "r")) == NULL) {
+		if (errno != ENOENT)
+			IB_LOG_WARN_FMT(__func__, "Can't open warm start snapshot %s: %s",
+				sm_config.warm_start_file, strerror(errno));
+		return VSTATUS_NOT_FOUND;
+	}
+
+	if (  fread(&hdr, sizeof(hdr), 1, f) != 1
+	   || hdr.magic != SM_SNAPSHOT_MAGIC
+	   || hdr.version != SM_SNAPSHOT_VERSION
+	   || hdr.length < sizeof(SmSnapFabric_t)) {
+		IB_LOG_WARN_FMT(__func__, "Ignoring warm start snapshot %s: bad header or version",
+			sm_config.warm_start_file);
+		fclose(f);
+		return VSTATUS_BAD;
+	}
+
+	status = vs_pool_alloc(&sm_pool, hdr.length, (void *)&snapBuf);
+	if (status != VSTATUS_OK) {
+		IB_LOG_WARN("can't allocate warm start snapshot; bytes:", hdr.length);
+		fclose(f);
+		return status;
+	}
+	snapLen = hdr.length;
+
+	if (  fread(snapBuf, snapLen, 1, f) != 1
+	   || snap_crc(0, snapBuf, snapLen) != hdr.checksum) {
+		IB_LOG_WARN_FMT(__func__, "Ignoring warm start snapshot %s: truncated or checksum mismatch",
+			sm_config.warm_start_file);
+		fclose(f);
+		sm_snapshot_release();
+		return VSTATUS_BAD;
+	}
+	fclose(f);
+	return VSTATUS_OK;
+}
+
+//
+// Check the loaded snapshot against topop, filling sws[] with topop's
+// switches in snapshot order.  Returns a short reason on mismatch.
+//
+static const char *
+sm_snapshot_verify(Topology_t *topop, const SmSnapFabric_t *fab, SmSnapCursor_t *cur,
+				   Node_t **sws)
+{
+	SmSnapNode_t snode;
+	SmSnapPort_t sport;
+	SmSnapSwitch_t ssw;
+	Node_t *nodep, *nbrp;
+	Port_t *portp;
+	uint32_t i, n, numLinks, numSws = 0;
+	size_t tables;
+
+	if (fab->smPortGuid != sm_smInfo.PortGUID)
+		return "SM port changed";
+	if (  fab->smChecksum != sm_config.overall_checksum
+	   || fab->vfChecksum != (topop->vfs_ptr ? topop->vfs_ptr->overall_checksum : 0))
+		return "configuration changed";
+	if (strncmp(fab->routingAlgorithm, sm_config.routing_algorithm, sizeof(fab->routingAlgorithm)))
+		return "routing algorithm changed";
+	if (  fab->maxLid != topop->maxLid
+	   || fab->numNodes != topop->num_nodes
+	   || fab->numSws != topop->num_sws)
+		return "fabric size changed";
+
+	for (n = 0; n < fab->numNodes; n++) {
+		if (!snap_read(cur, &snode, sizeof(snode)))
+			return "truncated";
+		nodep = sm_find_guid(topop, snode.nodeGuid);
+		if (  !nodep
+		   || nodep->nodeInfo.NodeType != snode.nodeType
+		   || nodep->nodeInfo.NumPorts != snode.numPorts)
+			return "node changed";
+
+		numLinks = 0;
+		for_all_ports(nodep, portp) {
+			if (snap_link_port(nodep, portp))
+				++numLinks;
+		}
+		if (numLinks != snode.numLinks)
+			return "links changed";
+
+		for (i = 0; i < snode.numLinks; i++) {
+			if (!snap_read(cur, &sport, sizeof(sport)))
+				return "truncated";
+			portp = sm_get_port(nodep, sport.portNum);
+			if (  !portp || !snap_link_port(nodep, portp)
+			   || portp->portData->guid != sport.portGuid
+			   || portp->portData->lid != sport.lid
+			   || portp->portData->lmc != sport.lmc)
+				return "port or LID changed";
+			if (sport.portNum == 0)
+				continue;
+			nbrp = sm_find_node(topop, portp->nodeno);
+			if (  !nbrp
+			   || nbrp->nodeInfo.NodeGUID != sport.nbrNodeGuid
+			   || portp->portno != sport.nbrPortNum)
+				return "links changed";
+		}
+
+		if (snode.nodeType != NI_TYPE_SWITCH)
+			continue;
+
+		if (!snap_read(cur, &ssw, sizeof(ssw)))
+			return "truncated";
+		if ((ssw.lftBlocks * MAX_LFT_ELEMENTS_BLOCK) <= topop->maxLid)
+			return "LFT too short";
+		if (ssw.pgtLen && (!nodep->pgt || ssw.pgtLen > nodep->switchInfo.PortGroupCap))
+			return "adaptive routing changed";
+		if (ssw.pgftSize && !nodep->switchInfo.CapabilityMask.s.IsAdaptiveRoutingSupported)
+			return "adaptive routing changed";
+		if (numSws >= fab->numSws)
+			return "switch count changed";
+		sws[numSws++] = nodep;
+
+		tables = (size_t)ssw.lftBlocks * MAX_LFT_ELEMENTS_BLOCK
+			+ ssw.pgtLen * sizeof(STL_PORTMASK)
+			+ ssw.pgftSize * sizeof(PORT)
+			+ (size_t)fab->mftEntries * STL_MFTABLE_POSITION_COUNT * sizeof(STL_PORTMASK);
+		if (!snap_get(cur, tables))
+			return "truncated";
+	}
+
+	return (numSws == fab->numSws) ? NULL : "switch count changed";
+}
+
+static void
+sm_snapshot_restore_groups(Topology_t *topop, uint32_t numGroups, SmSnapCursor_t *cur)
+{
+	SmSnapGroup_t sgrp;
+	SmSnapMember_t smem;
+	McGroup_t *mcGroup;
+	McMember_t *mcMember;
+	VirtualFabrics_t *VirtualFabrics = topop->vfs_ptr;
+	uint64_t vfmGid[2];
+	uint32_t i;
+	int vf;
+
+	(void)vs_lock(&sm_McGroups_lock);
+	while (numGroups-- && snap_read(cur, &sgrp, sizeof(sgrp))) {
+		// a group the SA already recreated is replaced by the saved one
+		if ((mcGroup = sm_find_multicast_gid(*((IB_GID *)sgrp.mGid)))) {
+			while (mcGroup->mcMembers) {
+				mcMember = mcGroup->mcMembers;
+				McMember_Delete(mcGroup, mcMember);
+			}
+			McGroup_Delete(mcGroup);
+		}
+
+		if (sm_multicast_sync_lid(*((IB_GID *)sgrp.mGid), sgrp.pKey, sgrp.mtu, sgrp.rate, sgrp.mLid) != VSTATUS_OK) {
+			IB_LOG_WARN_FMT(__func__, "Can't restore group " FMT_GID " from warm start snapshot",
+				((IB_GID *)sgrp.mGid)->Type.Global.SubnetPrefix, ((IB_GID *)sgrp.mGid)->Type.Global.InterfaceID);
+			if (!snap_get(cur, (size_t)sgrp.membercount * sizeof(smem)))
+				break;
+			continue;
+		}
+
+		McGroup_Create(mcGroup, sgrp.mGid);
+		mcGroup->members_full = sgrp.members_full;
+		mcGroup->qKey = sgrp.qKey;
+		mcGroup->pKey = sgrp.pKey;
+		mcGroup->mLid = sgrp.mLid;
+		mcGroup->mtu = sgrp.mtu;
+		mcGroup->rate = sgrp.rate;
+		mcGroup->life = sgrp.life;
+		mcGroup->sl = sgrp.sl;
+		mcGroup->flowLabel = sgrp.flowLabel;
+		mcGroup->tClass = sgrp.tClass;
+		mcGroup->hopLimit = sgrp.hopLimit;
+		mcGroup->scope = sgrp.scope;
+		mcGroup->index_pool = sgrp.index_pool;
+
+		for (i = 0; i < sgrp.membercount && snap_read(cur, &smem, sizeof(smem)); i++) {
+			McMember_Create(mcGroup, mcMember, smem.record.RID.PortGID);
+			mcMember->slid = smem.slid;
+			mcMember->proxy = smem.proxy;
+			mcMember->state = smem.state;
+			mcMember->nodeGuid = smem.nodeGuid;
+			mcMember->portGuid = smem.portGuid;
+			mcMember->record = smem.record;
+			sm_multicast_set_member_index(mcGroup, mcMember, smem.index);
+		}
+
+		if (VirtualFabrics) {
+			vfmGid[0] = mcGroup->mGid.AsReg64s.H;
+			vfmGid[1] = mcGroup->mGid.AsReg64s.L;
+			for (vf = 0; vf < VirtualFabrics->number_of_vfs; vf++) {
+				if ((PKEY_VALUE(VirtualFabrics->v_fabric[vf].pkey) == PKEY_VALUE(mcGroup->pKey)) &&
+					(smVFValidateMcDefaultGroup(vf, vfmGid) == VSTATUS_OK)) {
+					bitset_set(&mcGroup->vfMembers, vf);
+				}
+			}
+		}
+	}
+	(void)vs_unlock(&sm_McGroups_lock);
+}
+
+//
+// Called on the first master sweep in place of route calculation.  Returns
+// VSTATUS_OK if topop matched the saved fabric and now holds its cost
+// matrix, forwarding tables and multicast groups.  Switches which still
+// hold their tables are marked warmStart and set in old_switchesInUse so no
+// LFT is sent to them; the rest are left to be programmed as new switches.
+// Anything else and topop is untouched.
+//
+Status_t
+sm_snapshot_restore(Topology_t *topop)
+{
+	SmSnapCursor_t cur;
+	SmSnapFabric_t fab;
+	SmSnapNode_t snode;
+	SmSnapPort_t sport;
+	SmSnapSwitch_t ssw;
+	Node_t *nodep, **sws = NULL;
+	const char *reason;
+	const uint8_t *p;
+	uint32_t i, j, n, s, blocks, swLid, numWarm = 0;
+	uint16_t cost;
+	PORT *entries;
+	Status_t status;
+
+	if (snapTried || !sm_config.warm_start_file[0])
+		return VSTATUS_NOT_FOUND;
+	snapTried = 1;
+
+	// other algorithms derive routes from state which is not saved
+	if (  strcmp(sm_config.routing_algorithm, "shortestpath")
+	   && strcmp(sm_config.routing_algorithm, "dgshortestpath"))
+		return VSTATUS_NOSUPPORT;
+
+	if ((status = sm_snapshot_load()) != VSTATUS_OK)
+		return status;
+
+	cur.p = snapBuf;
+	cur.end = snapBuf + snapLen;
+	(void)snap_read(&cur, &fab, sizeof(fab));
+
+	if (  fab.numSws
+	   && vs_pool_alloc(&sm_pool, fab.numSws * sizeof(Node_t *), (void *)&sws) != VSTATUS_OK) {
+		sm_snapshot_release();
+		return VSTATUS_NOMEM;
+	}
+
+	if ((reason = sm_snapshot_verify(topop, &fab, &cur, sws)) != NULL) {
+		IB_LOG_INFINI_INFO_FMT(__func__, "Not using warm start snapshot %s: %s",
+			sm_config.warm_start_file, reason);
+		status = VSTATUS_BAD;
+		goto done;
+	}
+	if ((size_t)(cur.end - cur.p) < (size_t)fab.numSws * (fab.numSws ? fab.numSws - 1 : 0) / 2 * sizeof(uint16_t)) {
+		IB_LOG_INFINI_INFO_FMT(__func__, "Not using warm start snapshot %s: truncated",
+			sm_config.warm_start_file);
+		status = VSTATUS_BAD;
+		goto done;
+	}
+
+	// the fabric matches; install the saved state
+	if (fab.numSws) {
+		if ((status = sm_routing_alloc_floyds(topop)) != VSTATUS_OK)
+			goto done;
+		sm_routing_init_floyds(topop);
+	}
+
+	cur.p = snapBuf + sizeof(fab);
+	for (n = 0, s = 0; n < fab.numNodes; n++) {
+		(void)snap_read(&cur, &snode, sizeof(snode));
+		for (i = 0, swLid = 0; i < snode.numLinks; i++) {
+			(void)snap_read(&cur, &sport, sizeof(sport));
+			if (sport.portNum == 0)
+				swLid = sport.lid;
+		}
+		if (snode.nodeType != NI_TYPE_SWITCH)
+			continue;
+
+		nodep = sws[s++];
+		(void)snap_read(&cur, &ssw, sizeof(ssw));
+
+		if ((status = sm_lft_alloc(nodep)) != VSTATUS_OK)
+			goto done;
+		blocks = MIN(ssw.lftBlocks, nodep->lft->numBlocks);
+		for (i = 0; i < ssw.lftBlocks; i++) {
+			p = snap_get(&cur, MAX_LFT_ELEMENTS_BLOCK);
+			if (i < blocks && (entries = sm_lft_block_wr(nodep, i)) != NULL)
+				memcpy(entries, p, MAX_LFT_ELEMENTS_BLOCK);
+		}
+
+		p = snap_get(&cur, ssw.pgtLen * sizeof(STL_PORTMASK));
+		if (ssw.pgtLen) {
+			memcpy(nodep->pgt, p, ssw.pgtLen * sizeof(STL_PORTMASK));
+			nodep->pgtLen = ssw.pgtLen;
+			nodep->switchInfo.PortGroupTop = ssw.portGroupTop;
+		}
+
+		p = snap_get(&cur, ssw.pgftSize * sizeof(PORT));
+		if (ssw.pgftSize && (entries = sm_Node_get_pgft_wr(nodep)) != NULL)
+			memcpy(entries, p, MIN(ssw.pgftSize, sm_Node_get_pgft_size(nodep)) * sizeof(PORT));
+
+		// MFTs are compared once multicast routing is done
+		(void)snap_get(&cur, (size_t)fab.mftEntries * STL_MFTABLE_POSITION_COUNT * sizeof(STL_PORTMASK));
+
+		nodep->warmStart = snap_switch_loaded(nodep, &fab, swLid);
+	}
+
+	sm_snapshot_restore_groups(topop, fab.numGroups, &cur);
+
+	for (i = 0; i < fab.numSws; i++) {
+		for (j = i + 1; j < fab.numSws; j++) {
+			if (!snap_read(&cur, &cost, sizeof(cost)))
+				cost = Cost_Infinity;
+			sm_cost_set(topop, sws[i]->swIdx, sws[j]->swIdx, cost);
+		}
+	}
+
+	// only switches which kept their tables count as already programmed
+	bitset_clear_all(&old_switchesInUse);
+	for (i = 0; i < fab.numSws; i++) {
+		if (sws[i]->warmStart) {
+			bitset_set(&old_switchesInUse, sws[i]->swIdx);
+			++numWarm;
+		}
+	}
+
+	IB_LOG_INFINI_INFO_FMT(__func__, "Warm start: using routes from snapshot %s for %u switches, "
+		"%u of which still hold their tables", sm_config.warm_start_file, fab.numSws, numWarm);
+	status = VSTATUS_OK;
+
+done:
+	if (sws)
+		(void)vs_pool_free(&sm_pool, sws);
+	if (status != VSTATUS_OK)
+		sm_snapshot_release();
+	return status;
+}
+
+//
+// After the first sweep's MFTs are calculated, flag the switches whose MFT
+// is what the restored snapshot says they already hold.
+//
+void
+sm_snapshot_match_mfts(Topology_t *topop)
+{
+	SmSnapCursor_t cur;
+	SmSnapFabric_t fab;
+	SmSnapNode_t snode;
+	SmSnapSwitch_t ssw;
+	Node_t *nodep;
+	const uint8_t *mft;
+	uint32_t i, n, entries, matched = 0;
+	size_t rowLen = STL_MFTABLE_POSITION_COUNT * sizeof(STL_PORTMASK);
+
+	if (!snapBuf)
+		return;
+
+	cur.p = snapBuf;
+	cur.end = snapBuf + snapLen;
+	(void)snap_read(&cur, &fab, sizeof(fab));
+
+	(void)vs_lock(&sm_McGroups_lock);
+	entries = snap_mft_entries();
+	(void)vs_unlock(&sm_McGroups_lock);
+	if (entries != fab.mftEntries)
+		return;
+
+	for (n = 0; n < fab.numNodes; n++) {
+		(void)snap_read(&cur, &snode, sizeof(snode));
+		(void)snap_get(&cur, snode.numLinks * sizeof(SmSnapPort_t));
+		if (snode.nodeType != NI_TYPE_SWITCH)
+			continue;
+		(void)snap_read(&cur, &ssw, sizeof(ssw));
+		(void)snap_get(&cur, (size_t)ssw.lftBlocks * MAX_LFT_ELEMENTS_BLOCK
+			+ ssw.pgtLen * sizeof(STL_PORTMASK) + ssw.pgftSize * sizeof(PORT));
+		mft = snap_get(&cur, (size_t)entries * rowLen);
+
+		nodep = sm_find_guid(topop, snode.nodeGuid);
+		if (!nodep || !nodep->warmStart || !mft || (entries && !nodep->mft))
+			continue;
+		for (i = 0; i < entries; i++) {
+			if (memcmp(nodep->mft[i], mft + i * rowLen, rowLen))
+				break;
+		}
+		if (i == entries) {
+			nodep->mftWarm = 1;
+			++matched;
+		}
+	}
+
+	IB_LOG_INFINI_INFO_FMT(__func__, "Warm start: %u of %u switch MFTs unchanged",
+		matched, fab.numSws);
+}
@@ -200,6 +200,7 @@ Status_t dumpTopologyNodes(const char * dumpDir, FILE * mapFile)
 	Node_t * node = NULL;
 	Port_t * port = NULL;
 	size_t len;
+	uint32_t block, numBlocks;
 
 	snprintf(pathBuffer, PATH_BUF_SZ, "%s/%s", dumpDir, NODE_FNAME);
 	if ((nodeFile = fopen(pathBuffer, "a")) == NULL)
@@ -223,10 +224,14 @@ Status_t dumpTopologyNodes(const char * dumpDir, FILE * mapFile)
 		if (node->nodeInfo.NodeType == NI_TYPE_SWITCH)
 		{
 			printf("Dumping node.lft\n");
-			len = sizeof(uint8_t) * ROUNDUP(node->switchInfo.LinearFDBTop+1, MAX_LFT_ELEMENTS_BLOCK);
-			if (VSTATUS_OK != (rc = dumpStructure(node->lft, len, nodeFile,
-			                                      NODE_FNAME, mapFile)))
-				goto bail;
+			numBlocks = ROUNDUP(node->switchInfo.LinearFDBTop+1, MAX_LFT_ELEMENTS_BLOCK) /
+				MAX_LFT_ELEMENTS_BLOCK;
+			for (block = 0; block < numBlocks; block++) {
+				if (VSTATUS_OK != (rc = dumpStructure((void *)sm_lft_block(node, block),
+				                                      MAX_LFT_ELEMENTS_BLOCK, nodeFile,
+				                                      NODE_FNAME, mapFile)))
+					goto bail;
+			}
 
 			printf("Dumping node.mft[]\n");
 			len = sizeof(STL_PORTMASK *) * sm_mcast_mlid_table_cap;
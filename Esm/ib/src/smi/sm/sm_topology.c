@@ -139,7 +139,7 @@ int isSweeping = 0;
 int	activateInProgress = 0;
 int	forceRebalanceNextSweep = 0;
 int oldSmActiveCount = 0;
-void dump_cost_array(uint16_t *);
+void dump_cost_array(Topology_t *);
 void showSmParms(void);
 
 Status_t topology_initialize(void);
@@ -174,20 +174,26 @@ Status_t topology_update_cableinfo(void);
 
 typedef	Status_t  (*TFunc_t)(void);
 
-TFunc_t	topology_functions[] = {
-	topology_discovery,			// Initial exploration of the fabric
-	topology_transition,		// Determine if this SM should be MASTER or STANDBY.
-	topology_userexit,			// NOOP!
-	topology_resolve,			// Sync the old topology with the new one.
-	topology_assignments,		// Assign LIDS, build LFTs, PGTs and PGFTs.
-	topology_adaptiverouting,	// Transmit PGTs and PGFTs to switches.
-	topology_activate,			// Bring all links to active.
-    sm_dbsync_upsmlist,			// Update our list of SMs in the fabric
-    topology_multicast,			// Build MFTs
-	topology_verification, 		// Verify fabric activation if cascade activation enabled
-	topology_cache_build,		// Builds caches that are used by the SA. 
-    topology_loopTest,			// Embedded only. Injects packets into fabric.
-	NULL
+// name is used to label the phase in the sweep profile (sm_counters.h)
+typedef struct {
+	TFunc_t		func;
+	const char	*name;
+} TPhase_t;
+
+TPhase_t	topology_functions[] = {
+	{ topology_discovery, "discovery" },				// Initial exploration of the fabric
+	{ topology_transition, "transition" },				// Determine if this SM should be MASTER or STANDBY.
+	{ topology_userexit, "userexit" },					// NOOP!
+	{ topology_resolve, "resolve" },					// Sync the old topology with the new one.
+	{ topology_assignments, "assignments" },			// Assign LIDS, build LFTs, PGTs and PGFTs.
+	{ topology_adaptiverouting, "adaptiverouting" },	// Transmit PGTs and PGFTs to switches.
+	{ topology_activate, "activate" },					// Bring all links to active.
+	{ sm_dbsync_upsmlist, "upsmlist" },					// Update our list of SMs in the fabric
+	{ topology_multicast, "multicast" },				// Build MFTs
+	{ topology_verification, "verification" },			// Verify fabric activation if cascade activation enabled
+	{ topology_cache_build, "cache_build" },			// Builds caches that are used by the SA.
+	{ topology_loopTest, "loopTest" },					// Embedded only. Injects packets into fabric.
+	{ NULL, NULL }
 };
 
 static const char *sweep_reasons[] = {
@@ -687,6 +693,7 @@ sm_request_resweep(int forceLfts, int forceMfts, SweepReason_t reason)
 	topology_resweep = 1;
 
 	setResweepReason(reason);
+	sm_light_sweep_force_full();
 
 	// if we're already queued up for the next sweep, this will wake us.
 	// if we're already in a sweep, this will get overwritten to the correct
@@ -702,6 +709,8 @@ void
 sm_trigger_sweep(SweepReason_t reason)
 {
 	setResweepReason(reason);
+	if (reason != SM_SWEEP_REASON_TRAP_EVENT)
+		sm_light_sweep_force_full();
 
 	AtomicWrite(&topology_triggered, 1);
 	(void)vs_time_get(&topology_sema_setTime);
@@ -804,6 +813,7 @@ topology_main(uint32_t argc, uint8_t ** argv)
 // Initialize our counters
 //
 	sm_init_counters();
+	sm_light_sweep_init();
 
 //
 //	We need to set our LID to the one specified by the parameters.
@@ -914,13 +924,19 @@ topology_main(uint32_t argc, uint8_t ** argv)
 					IB_LOG_INFINI_INFO0(tempStr);
 				}
 #endif
+				sm_light_sweep_begin(sm_resweep_reason == SM_SWEEP_REASON_TRAP_EVENT
+					&& updatedVirtualFabrics == NULL);
 				sm_resweep_reason = SM_SWEEP_REASON_UNDETERMINED;
 				isSweeping = 1;
 
 				(void)vs_lock(&new_topology_lock);
 
-				for (i = 0; topology_functions[i] != NULL; i++) {
-					status = (topology_functions[i])();
+				for (i = 0; topology_functions[i].func != NULL; i++) {
+					sm_profile_mark_t mark;
+
+					sm_profile_phase_begin(&mark);
+					status = (topology_functions[i].func)();
+					sm_profile_phase_end(i, topology_functions[i].name, &mark);
 					if (status != VSTATUS_OK) {
 						/*
 						 * PR# 101511
@@ -945,6 +961,8 @@ topology_main(uint32_t argc, uint8_t ** argv)
 					}
 				}
 
+				sm_light_sweep_end(newTopologyValid);
+
 				/* clear topology error counters and sweep abandonment counters */
 				if (topo_abandon_count > sm_config.topo_abandon_threshold || topo_errors == 0) topo_abandon_count = 0;
 				topo_errors = 0;
@@ -961,6 +979,8 @@ topology_main(uint32_t argc, uint8_t ** argv)
 					oldTotalPorts = old_topology.num_ports;
 
 					sm_compactSwitchSpace(&sm_newTopology, &new_switchesInUse);
+					// routing is done with the full matrix; keep it small until next sweep
+					sm_routing_pack_floyds(&sm_newTopology);
 
 					sm_clearSwitchPortChange(&sm_newTopology);
 
@@ -1001,6 +1021,10 @@ topology_main(uint32_t argc, uint8_t ** argv)
 							}
 						}
 					}
+#ifndef __VXWORKS__
+					if (sm_state == SM_STATE_MASTER)
+						(void)sm_snapshot_save(&old_topology);
+#endif
 					/* release the copied old topology */
 					(void)topology_release_saved_topology();
 
@@ -1052,6 +1076,23 @@ topology_main(uint32_t argc, uint8_t ** argv)
 #endif
 				SET_PEAK_COUNTER(smMaxSweepTime, (uint32)(temp64/1000));
 
+				{
+					SmArenaStats_t arenaStats;
+					uint32_t rssKb = sm_arena_peak_rss_kb();
+
+					sm_arena_get_stats(sm_topop->arena, &arenaStats);
+					SET_PEAK_COUNTER(smMaxSweepAllocs, (uint32)arenaStats.allocs);
+					SET_PEAK_COUNTER(smMaxSweepFrees, (uint32)arenaStats.frees);
+					SET_PEAK_COUNTER(smMaxSweepArenaKb, (uint32)(arenaStats.peakBytes/1024));
+					SET_PEAK_COUNTER(smMaxRssKb, rssKb);
+					if (smDebugPerf) {
+						IB_LOG_INFINI_INFO_FMT(__func__,
+							"Topology memory: %"CS64u" allocs, %"CS64u" frees (%"CS64u" reused), %"CS64u" KB peak, %"CS64u" KB reserved, %u KB peak RSS",
+							arenaStats.allocs, arenaStats.frees, arenaStats.reused, arenaStats.peakBytes/1024,
+							arenaStats.reservedBytes/1024, rssKb);
+					}
+				}
+
 #ifndef __VXWORKS__
 				if (smDumpCounters) {
 					char *buff = sm_print_counters_to_buf();
@@ -1461,6 +1502,7 @@ topology_discovery(void)
     STL_SMINFO_RECORD sminforec={{0}, 0};
     uint64_t    sTime, eTime;
 	void *routingContext;
+	uint8_t		prefetchLevel = 0;
 
 	IB_ENTER(__func__, 0, 0, 0, 0);
 
@@ -1503,25 +1545,31 @@ topology_discovery(void)
 		return(status);
 	}
 	
-	status = vs_pool_alloc(&sm_pool, sizeof(cl_qmap_t), (void *)&sm_newTopology.portMap);
+	status = vs_pool_alloc(&sm_pool, sizeof(cl_qmap_t), (void *)&sm_newTopology.quarantinedNodeMap);
 	if (status != VSTATUS_OK) {
-		IB_LOG_ERROR0("can't malloc port map");
+		IB_LOG_ERROR0("can't malloc node map");
 		IB_EXIT(__func__, status);
 		return(status);
 	}
-	
-	status = vs_pool_alloc(&sm_pool, sizeof(cl_qmap_t), (void *)&sm_newTopology.quarantinedNodeMap);
+
+	status = sm_arena_create(&sm_newTopology.arena);
 	if (status != VSTATUS_OK) {
-		IB_LOG_ERROR0("can't malloc node map");
+		IB_LOG_ERROR0("can't create topology arena");
 		IB_EXIT(__func__, status);
 		return(status);
 	}
 
 	cl_qmap_init(sm_newTopology.nodeIdMap, NULL);
 	cl_qmap_init(sm_newTopology.nodeMap, NULL);
-	cl_qmap_init(sm_newTopology.portMap, NULL);
 	cl_qmap_init(sm_newTopology.quarantinedNodeMap, NULL);
 
+	// size the GUID indexes for the last fabric so discovery rarely grows them
+	cl_hmap_init(&sm_newTopology.nodeGuidMap, sm_hmap_alloc, sm_hmap_free, NULL);
+	cl_hmap_init(&sm_newTopology.portGuidMap, sm_hmap_alloc, sm_hmap_free, NULL);
+	(void)cl_hmap_reserve(&sm_newTopology.nodeGuidMap, old_topology.num_nodes);
+	(void)cl_hmap_reserve(&sm_newTopology.portGuidMap,
+		old_topology.num_endports + old_topology.num_sws);
+
 	sm_newTopology.smaChanges = NULL;
 	sm_newTopology.nodeArray = NULL;
 	memset(&sm_newTopology.preDefLogCounts, 0, sizeof(PreDefTopoLogCounts));
@@ -1659,11 +1707,20 @@ unlock_bail:
         vs_time_get(&sTime);
         IB_LOG_INFINI_INFO0("START directed route exploration of fabric");
     }
+	// drop anything prefetched by an aborted earlier sweep
+	sm_discovery_prefetch_done();
 	for_all_nodes(sm_topop, nodep) {
 		if ((nodep != sm_topop->node_head) && (nodep->nodeInfo.NodeType != NI_TYPE_SWITCH)) {
 			continue;
 		}
 
+		// the node list is in breadth first order, so all nodes of the next
+		// hop level are known by the time we reach the first of them
+		if (sm_config.pipelined_discovery && nodep->path[0] != prefetchLevel) {
+			prefetchLevel = nodep->path[0];
+			(void)sm_discovery_prefetch_level(sm_topop, nodep);
+		}
+
 		if (nodep->nodeInfo.NodeType == NI_TYPE_SWITCH) {
 			status = sm_topop->routingModule->funcs.discover_node(sm_topop, nodep, routingContext);
 			if (status != VSTATUS_OK) {
@@ -1742,6 +1799,8 @@ unlock_bail:
 				portp->state = IB_PORT_DOWN;
 				DECR_PORT_COUNT(sm_topop, nodep);
 				topology_changed = 1;	/* indicates a fabric change has been detected */
+				if (nodep->lightTrusted)
+					sm_light_sweep_inconsistent(nodep, portp);
 
 #ifndef __VXWORKS__
 				// Self-quarantining not implementing for ESM due to ESM
@@ -1801,6 +1860,15 @@ unlock_bail:
 		}
 	}
 
+	sm_discovery_prefetch_done();
+
+	// what the light sweep took from the old topology can't be relied on
+	if (sm_light_sweep_is_failed()) {
+		sm_topop->routingModule->funcs.post_process_discovery(sm_topop, VSTATUS_BAD, routingContext);
+		IB_EXIT(__func__, VSTATUS_BAD);
+		return VSTATUS_BAD;
+	}
+
 	status = sm_topop->routingModule->funcs.post_process_discovery(sm_topop, VSTATUS_OK, routingContext);
 	if (status != VSTATUS_OK) {
 		IB_LOG_ERRORRC("Failed to process 'post-discovery' routing hook; rc:", status);
@@ -2263,6 +2331,11 @@ Status_t topology_setup_switches_LR_DR()
 	if (sm_config.force_rebalance || rebalance || sm_config.forceAttributeRewrite)
 		routing_needed = 1;
 
+#ifndef __VXWORKS__
+	if (routing_needed || new_endnodesInUse.nset_m)
+		sm_snapshot_invalidate();
+#endif
+
 	/* First initialize and assign LID to the SM port so that SM can send/recv LR SMPs*/
 	portp = sm_get_port(sm_topop->node_head, sm_config.port);
 	if (!sm_valid_port(portp)) {
@@ -2944,6 +3017,26 @@ Status_t topology_setup_routing_floyds(void)
 	
 	newSwitchesInFabric = !bitset_equal(&old_switchesInUse, &new_switchesInUse);
 
+#ifndef __VXWORKS__
+	/* first sweep after a restart: reuse the saved routes if the fabric still matches them */
+	if (topology_passcount == 0 && !rebalance && sm_snapshot_restore(sm_topop) == VSTATUS_OK) {
+		int warmRebalance = 1;	/* as for a brand new topology */
+
+		status = sm_topop->routingModule->funcs.post_process_routing(sm_topop, &old_topology, &warmRebalance);
+		if (status != VSTATUS_OK) {
+			IB_LOG_ERRORRC("Failed to process 'post-routing' routing hook; rc:", status);
+			return status;
+		}
+		if (smDebugPerf) {
+			vs_time_get(&eTime);
+			IB_LOG_INFINI_INFO("END topology_setup_routing_floyds/warm start from snapshot;"
+								" elapsed time(usec)=", (int)(eTime-sTime));
+		}
+		IB_EXIT(__func__, VSTATUS_KNOWN);
+		return VSTATUS_KNOWN;
+	}
+#endif
+
     /* recalculate the path and cost arrays only if topology has changed or first time through */
     if (  topology_changed
        || topology_passcount == 0
@@ -2952,38 +3045,52 @@ Status_t topology_setup_routing_floyds(void)
 
 		rebalance = 1;
 
-		if (smDebugPerf) IB_LOG_INFINI_INFO0("Calculating topology paths");
+		/* if only ISLs changed, try to repair the old cost matrix first */
+		if (  sm_config.incremental_cost_update
+		   && topology_passcount > 0
+		   && !newSwitchesInFabric
+		   && old_topology.num_sws == sm_newTopology.num_sws
+		   && sm_routing_update_floyds(&old_topology, sm_topop) == VSTATUS_OK) {
 
-		status = sm_routing_alloc_floyds(sm_topop);
-		if (status != VSTATUS_OK) {
-			IB_LOG_ERRORRC("failed to allocate cost data; rc:", status);
-			IB_EXIT(__func__, status);
-			return status;
-		}
-    
-    	if (smDebugPerf) {
-    		vs_time_get(&eTime);
-    		IB_LOG_INFINI_INFO("END topology_setup_routing_floyds/setup init path array;"
-								" elapsed time(usecs)=", (int)(eTime-sTime));
-    		vs_time_get(&sTime);
-    	}
- 
-		sm_routing_init_floyds(sm_topop);
+			if (smDebugPerf) {
+				vs_time_get(&eTime);
+				IB_LOG_INFINI_INFO("END topology_setup_routing_floyds/incremental update of cost array;"
+									" elapsed time(usec)=", (int)(eTime-sTime));
+			}
+		} else {
+			if (smDebugPerf) IB_LOG_INFINI_INFO0("Calculating topology paths");
 
-    	if (smDebugPerf) {
-    		vs_time_get(&eTime);
-        		IB_LOG_INFINI_INFO("END topology_setup_routing_floyds/setup initial cost/path arrays;"
+			status = sm_routing_alloc_floyds(sm_topop);
+			if (status != VSTATUS_OK) {
+				IB_LOG_ERRORRC("failed to allocate cost data; rc:", status);
+				IB_EXIT(__func__, status);
+				return status;
+			}
+    
+	    	if (smDebugPerf) {
+	    		vs_time_get(&eTime);
+	    		IB_LOG_INFINI_INFO("END topology_setup_routing_floyds/setup init path array;"
 									" elapsed time(usecs)=", (int)(eTime-sTime));
-    		vs_time_get(&sTime);
-    	}
+	    		vs_time_get(&sTime);
+	    	}
+ 
+			sm_routing_init_floyds(sm_topop);
+
+	    	if (smDebugPerf) {
+	    		vs_time_get(&eTime);
+	        		IB_LOG_INFINI_INFO("END topology_setup_routing_floyds/setup initial cost/path arrays;"
+										" elapsed time(usecs)=", (int)(eTime-sTime));
+	    		vs_time_get(&sTime);
+	    	}
         
-		sm_routing_calc_floyds(sm_topop->max_sws, sm_topop->cost);
+			sm_routing_calc_floyds(sm_topop->max_sws, sm_topop->cost);
 
-    	if (smDebugPerf) {
-    		vs_time_get(&eTime);
-        		IB_LOG_INFINI_INFO("END topology_setup_routing_floyds/calculation of cost and path arrays;"
-									" elapsed time(usec)=", (int)(eTime-sTime));
-        }
+	    	if (smDebugPerf) {
+	    		vs_time_get(&eTime);
+	        		IB_LOG_INFINI_INFO("END topology_setup_routing_floyds/calculation of cost and path arrays;"
+										" elapsed time(usec)=", (int)(eTime-sTime));
+	        }
+		}
 
 		status = sm_topop->routingModule->funcs.post_process_routing(sm_topop, &old_topology, &rebalance);
 		if (status != VSTATUS_OK) {
@@ -3027,6 +3134,7 @@ Status_t topology_setup_routing_floyds(void)
 		// (it has it's port down)
         sm_topop->bytes = 0;
         sm_topop->cost = NULL;
+        sm_topop->costMode = SM_COST_FULL;
         if (!sm_newTopology.num_ports) {
             IB_LOG_WARN0("Host SM's port is down, re-starting sweep");
 			sm_request_resweep(0, 0, SM_SWEEP_REASON_LOCAL_PORT_FAIL);
@@ -3805,6 +3913,11 @@ topology_multicast(void)
 
     if (smSendOutMFTs) {
 		status = sm_calculate_mfts();
+#ifndef __VXWORKS__
+		if (topology_passcount == 0)
+			sm_snapshot_match_mfts(sm_topop);
+		sm_snapshot_invalidate();
+#endif
     } else {
         /* just copy over the switch mfts to new topology */
         (void) sm_multicast_switch_mft_copy();
@@ -4433,11 +4546,8 @@ topology_free_topology(Topology_t * topop)
 		topop->nodeMap = NULL;
 	}
 
-	if(topop->portMap){
-		cl_qmap_remove_all(topop->portMap);
-		(void)vs_pool_free(&sm_pool, (void *)topop->portMap);
-		topop->portMap = NULL;
-	}
+	cl_hmap_destroy(&topop->nodeGuidMap);
+	cl_hmap_destroy(&topop->portGuidMap);
 
 	if(topop->nodeArray != NULL) {
 		(void)vs_pool_free(&sm_pool, (void *)topop->nodeArray);
@@ -4457,13 +4567,14 @@ topology_free_topology(Topology_t * topop)
 
 	while ((nodep = topop->node_head) != NULL) {
 		topop->node_head = nodep->next;
-		Node_Delete(nodep);
+		Node_Release(nodep);
 	}
 
 	if (topop->cost != NULL) {
 		(void)vs_pool_free(&sm_pool, (void *)topop->cost);
 		topop->cost = NULL;
 	}
+	topop->costMode = SM_COST_FULL;
 
 	if (topop->smaChanges != NULL) {
 		vs_pool_free(&sm_pool, topop->smaChanges);
@@ -4493,6 +4604,11 @@ topology_free_topology(Topology_t * topop)
 		topop->ldrCache = NULL;
 	}
 
+	// nodes, ports and everything else from the arena go back to sm_pool
+	// in one go
+	sm_arena_destroy(topop->arena);
+	topop->arena = NULL;
+
 	return VSTATUS_OK;
 }
 
@@ -4694,6 +4810,9 @@ topology_cache_copy(void)
 	}
 	
 	IB_LOG_INFO("in-use elements moved into SA cache history:", count);
+
+	// cached PathRecords describe the topology being replaced
+	sa_PathRecord_CacheInvalidate();
 	
 	rc = VSTATUS_OK;
 	IB_EXIT(__func__, rc);
@@ -4969,7 +5088,7 @@ topology_dump(void)
 
     if (sm_state == SM_STATE_MASTER) {
 		dump_topology(NULL, /* do not buffer */ 0);
-		dump_cost_array((uint16_t *)sm_newTopology.cost);
+		dump_cost_array(&sm_newTopology);
 		(void)fflush(stdout);
 		showSmParms();
 		(void)fflush(stdout);
@@ -5030,26 +5149,24 @@ sm_topology_dump(int buffer)
 
 
 void
-dump_cost_array(uint16_t *cost)
+dump_cost_array(Topology_t *topop)
 {
-	int	ij;
 	int	i, j;
-    int num_nodes = sm_topop->max_sws;  
+    int num_nodes = topop->max_sws;  
 
 	IB_ENTER(__func__, 0, 0, 0, 0);
 
-	if (cost) {
+	if (topop->cost) {
 		printf("\nCOST:\n");
     	printf("     i  j");
     	for (j = 0; j < num_nodes; j++) {
         	printf("%6d", j);
     	}
     	printf("\n");
-		for (i = 0; i < sm_topop->num_nodes; i++) {
+		for (i = 0; i < num_nodes; i++) {
         	printf("%6d   ", i);
-			for (j = 0; j < sm_topop->num_nodes; j++) {
-				ij = Index(i, j);
-				printf("%6d", (int)cost[ij]);
+			for (j = 0; j < num_nodes; j++) {
+				printf("%6d", (int)sm_cost_get(topop, i, j));
 			}
 			printf("\n");
 		}
@@ -112,6 +112,7 @@ topology_rcv(uint32_t argc, uint8_t ** argv) {
 #endif
 
     sm_async_send_rcv_cntxt.resp_queue = sm_async_rcv_resp_queue;   // queue to post responses
+    sm_async_send_rcv_cntxt.rttHook = sm_profile_mad_rtt;
 	sm_async_send_rcv_cntxt.totalTimeout = (sm_config.rcv_wait_msec * sm_config.max_retries * 1000);     // (*1000) to convert from milliseconds to microseconds
 
 	/* PR 110945 - Stepped and randomized retries */
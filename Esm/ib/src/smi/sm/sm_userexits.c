@@ -226,13 +226,13 @@ loopTest_userexit_updateLft(Topology_t *topop, Node_t *cnp) {
             if (cnp->index == loopPath->nodeIdx[j]) {
                 nodeLftUpdatedForLoop = 1;
                 // update lft for this lid for this switch
-                cnp->lft[loopPath->lid] = loopPath->path[j];
+                sm_lft_set_port(cnp, loopPath->lid, loopPath->path[j]);
             }
 			if (esmLoopTestFast) {
 				//update lft for the reverse path lid
 				outPortp = sm_find_port(topop, loopPath->nodeIdx[j], loopPath->path[j]);
 				if (outPortp && (cnp->index == outPortp->nodeno)) {
-					cnp->lft[loopPath->lid + 1] = outPortp->portno;
+					sm_lft_set_port(cnp, loopPath->lid + 1, outPortp->portno);
 				}
 			}
         }
@@ -255,15 +255,15 @@ loopTest_userexit_updateLft(Topology_t *topop, Node_t *cnp) {
 				ii = 1;  /* first node is switch, star there */
 			}
             for (i=ii; i<=loopNode->path[0]; i++) {
-                if (nodep->index == cnp->index && nodep->lft[loopPath->lid] == 0xff) {
+                if (nodep->index == cnp->index && sm_lft_port(nodep, loopPath->lid) == 0xff) {
 					if (smDebugPerf) {
 						IB_LOG_INFO_FMT(__func__, 
 							   "updating node[%d], lft[0x%x] to port %d.....", 
 							   nodep->index, loopPath->lid, loopNode->path[i]);
 					}
-                    nodep->lft[loopPath->lid] = loopNode->path[i];
+                    sm_lft_set_port(nodep, loopPath->lid, loopNode->path[i]);
 					if (esmLoopTestFast) {
-						nodep->lft[loopPath->lid+1] = loopNode->path[i]; //reverse path
+						sm_lft_set_port(nodep, loopPath->lid+1, loopNode->path[i]); //reverse path
 					}
                 } 
                 if (i < loopNode->path[0]) {
@@ -1293,8 +1293,8 @@ char* printSwitchLft(int nodeIdx, int useNew, int haveLock, int buffer) {
                     buf = snprintfcat(buf, &len, "   LID    PORT\n");
                     buf = snprintfcat(buf, &len, " ------   ----\n");
                     for (i = 1; i <= topop->maxLid; i++) {
-                        if (nodep->lft[i] != 0xff) 
-                            buf = snprintfcat(buf, &len, " 0x%04x   %04d\n", i, nodep->lft[i]);
+                        if (sm_lft_port(nodep, i) != 0xff) 
+                            buf = snprintfcat(buf, &len, " 0x%04x   %04d\n", i, sm_lft_port(nodep, i));
                     }
                     buf = snprintfcat(buf, &len, " --------------\n");
                     buf = snprintfcat(buf, &len, "\n");
@@ -1308,8 +1308,8 @@ char* printSwitchLft(int nodeIdx, int useNew, int haveLock, int buffer) {
                 buf = snprintfcat(buf, &len, "   LID    PORT\n");
                 buf = snprintfcat(buf, &len, " ------   ----\n");
                 for (i = 1; i <= topop->maxLid; i++) {
-                    if (nodep->lft[i] != 0xff) 
-                        buf = snprintfcat(buf, &len, " 0x%04x   %04d\n", i, nodep->lft[i]);
+                    if (sm_lft_port(nodep, i) != 0xff) 
+                        buf = snprintfcat(buf, &len, " 0x%04x   %04d\n", i, sm_lft_port(nodep, i));
                 }
             } else {
                 buf = snprintfcat(buf, &len, "Node index %d is not a valid switch!\n", nodeIdx);
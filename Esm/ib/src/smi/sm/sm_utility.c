@@ -287,6 +287,7 @@ sm_send_request_impl(IBhandle_t fd, uint32_t method, uint32_t aid,
 	Mai_t out_mad;
 	cntxt_entry_t *madcntxt = NULL;
 	uint64_t timesent = 0, timercvd = 0, total_timeout = 0, timeout = 0, cumulative_timeout = 0;
+	uint64_t attemptsent = 0;
 	char msgbuf[256] = { 0 };
 	boolean sendSuccess = TRUE; 
 
@@ -433,6 +434,7 @@ sm_send_request_impl(IBhandle_t fd, uint32_t method, uint32_t aid,
 					timeout = sm_config.min_rcv_wait_msec * 1000;
 			}
 			cumulative_timeout += timeout;
+			(void) vs_time_get(&attemptsent);
 			status = mai_send_timeout(fd, &out_mad, timeout);
 			if (status != VSTATUS_OK) {
 				smLogHelper(VS_LOG_WARN, __func__, "error sending", aid, tid, "status",
@@ -449,6 +451,8 @@ sm_send_request_impl(IBhandle_t fd, uint32_t method, uint32_t aid,
 #endif
 			if (status == VSTATUS_OK) {
 				if (in_mad.type != MAI_TYPE_ERROR) {
+					(void) vs_time_get(&timercvd);
+					sm_profile_mad_rtt(aid, timercvd - attemptsent);
 					INCREMENT_COUNTER(smCounterRxGetResp);
 					INCREMENT_MAD_STATUS_COUNTERS(&in_mad);
 					break;
@@ -699,6 +703,7 @@ sm_send_stl_request_impl(IBhandle_t fd, uint32_t method, uint32_t aid,
 	Mai_t out_mad;
 	cntxt_entry_t *madcntxt = NULL;
 	uint64_t timesent = 0, timercvd = 0, total_timeout = 0, timeout = 0, cumulative_timeout = 0;
+	uint64_t attemptsent = 0;
 	char msgbuf[256] = { 0 };
 	char nodeString[NODE_STRING_MAX_LEN];
 	Node_t *node = NULL;
@@ -867,6 +872,7 @@ sm_send_stl_request_impl(IBhandle_t fd, uint32_t method, uint32_t aid,
 			}
 
 			cumulative_timeout += timeout;
+			(void) vs_time_get(&attemptsent);
 			status = mai_send_stl_timeout(fd, &out_mad, &datalen, timeout);
 			if (status != VSTATUS_OK) {
 				smGetNodeString(path, dlid, node, port, nodeString, NODE_STRING_MAX_LEN);	
@@ -894,6 +900,8 @@ sm_send_stl_request_impl(IBhandle_t fd, uint32_t method, uint32_t aid,
 
 			if (status == VSTATUS_OK) {
 				if (in_mad.type != MAI_TYPE_ERROR) {
+					(void) vs_time_get(&timercvd);
+					sm_profile_mad_rtt(aid, timercvd - attemptsent);
 					INCREMENT_COUNTER(smCounterRxGetResp);
 					INCREMENT_MAD_STATUS_COUNTERS(&in_mad);
 					break;
@@ -1819,12 +1827,14 @@ check_for_new_endnode(STL_NODE_INFO * nodeInfo, Node_t * nodep, Node_t * oldnode
 uint32_t
 sm_Node_release_pgft(Node_t * node)
 {
+	uint32_t refs = 0;
+
 	if (node->pgft) {
-		vs_pool_free(&sm_pool, node->pgft);
+		refs = sm_pgft_release(node->pgft);
 		node->pgft = NULL;
 		node->pgftSize = 0;
 	}
-	return 0;
+	return refs;
 }
 
 size_t
@@ -1858,25 +1868,20 @@ sm_Node_get_pgft_wr(Node_t * node)
 
 	size_t pgftLen = sm_Node_compute_pgft_size(node);
 	if (!node->pgft) {
-		Status_t s = vs_pool_alloc(&sm_pool, pgftLen, (void *) &node->pgft);
-		if (s == VSTATUS_OK) {
-			memset((void *) node->pgft, 0xFF, pgftLen);
+		node->pgft = sm_pgft_alloc(pgftLen);
+		if (node->pgft)
 			node->pgftSize = (uint32_t) pgftLen;
-		}
 	}
-	else if (node->pgftSize < pgftLen) {
-		PORT * newPgft = NULL;
-		Status_t s = vs_pool_alloc(&sm_pool, pgftLen, (void *)&newPgft);
-		if (s != VSTATUS_OK) {
-			if (!newPgft)
-				vs_pool_free(&sm_pool, newPgft);
+	else if (node->pgftSize < pgftLen || sm_pgft_refs(node->pgft) > 1) {
+		// grow, or break the sharing with the topology it was copied from
+		size_t newLen = MAX(pgftLen, node->pgftSize);
+		PORT * newPgft = sm_pgft_alloc(newLen);
+		if (!newPgft)
 			return NULL;
-		}
 		memcpy(newPgft, node->pgft, node->pgftSize);
-		memset(newPgft + node->pgftSize, 0xFF, pgftLen - node->pgftSize);
-		vs_pool_free(&sm_pool, node->pgft);
+		(void)sm_pgft_release(node->pgft);
 		node->pgft = newPgft;
-		node->pgftSize = pgftLen;
+		node->pgftSize = (uint32_t) newLen;
 	}
 
 	return node->pgft;
@@ -1888,22 +1893,10 @@ sm_Node_copy_pgft(Node_t * dest, const Node_t * src)
 	if (!src->pgft)
 		return dest->pgft;
 
-	if (dest->pgft && sm_Node_get_pgft_size(dest) < sm_Node_get_pgft_size(src)) {
-		sm_Node_release_pgft(dest);
-	}
-
-	if (!dest->pgft) {
-		Status_t s = vs_pool_alloc(&sm_pool, sm_Node_get_pgft_size(src), (void *) &dest->pgft);
-
-		if (s != VSTATUS_OK)
-			return NULL;
-		dest->pgftSize = sm_Node_get_pgft_size(src);
-	}
-
-	if (dest->pgft) {
-		memcpy((void *) dest->pgft, src->pgft, sm_Node_get_pgft_size(dest));
-		dest->pgftSize = src->pgftSize;
-	}
+	// shared until one side writes it; see sm_Node_get_pgft_wr()
+	sm_Node_release_pgft(dest);
+	dest->pgft = sm_pgft_share(src->pgft);
+	dest->pgftSize = src->pgftSize;
 
 	return dest->pgft;
 }
@@ -1919,7 +1912,7 @@ sm_Node_invalidate_pgs(Node_t * node)
 		node->switchInfo.PortGroupTop = node->pgtLen = 0;
 	}
 
-	if (node->pgft) {
+	if (node->pgft && sm_Node_get_pgft_wr(node)) {
 		memset(node->pgft, 0xFF, node->pgftSize * sizeof(node->pgft[0]));
 	}
 }
@@ -2301,6 +2294,7 @@ sm_setup_node(Topology_t * topop, FabricData_t * pdtop, Node_t * cnp, Port_t * c
 	Node_t *linkednodep = NULL;
 	Port_t *portp, *oldportp, *swPortp = NULL;
 	int use_cache = 0;
+	int lightLink = 0;
 	Node_t *cache_nodep = NULL;
 	Port_t *cache_portp = NULL;
 	Status_t status;
@@ -2328,12 +2322,28 @@ sm_setup_node(Topology_t * topop, FabricData_t * pdtop, Node_t * cnp, Port_t * c
 	if (topology_passcount && cpp && (cpp->state == IB_PORT_ACTIVE)) {
 		use_cache = sm_find_cached_neighbor(cnp, cpp, &cache_nodep, &cache_portp);
 	} 
+
+	//
+	// A link off a switch trusted by a light sweep is taken as it was.
+	//
+	lightLink = use_cache && cnp->lightTrusted && sm_valid_port(cache_portp);
 	
 	// 
 	// Get the current NodeInfo struct.
 	// 
 	memset(&nodeInfo, 0, sizeof(nodeInfo));
-	if ((status = SM_Get_NodeInfo(fd_topology, 0, path, &nodeInfo)) != VSTATUS_OK) {
+	if (lightLink) {
+		nodeInfo = cache_nodep->nodeInfo;
+		nodeInfo.u1.s.LocalPortNum = cache_portp->index;
+		if (nodeInfo.NodeType == NI_TYPE_CA)
+			nodeInfo.PortGUID = cache_portp->portData->guid;
+		status = VSTATUS_OK;
+	} else if (sm_discovery_get_nodeinfo(cnp, cpp, path, &nodeInfo) == VSTATUS_OK) {
+		status = VSTATUS_OK;
+	} else {
+		status = SM_Get_NodeInfo(fd_topology, 0, path, &nodeInfo);
+	}
+	if (status != VSTATUS_OK) {
 		if (!cpp && !cnp) {
 			IB_LOG_ERRORRC("Get NodeInfo failed for local node. rc:",
 						   status);
@@ -2419,7 +2429,15 @@ sm_setup_node(Topology_t * topop, FabricData_t * pdtop, Node_t * cnp, Port_t * c
 		// 
 		// Get the NodeDescription.
 		// 
-		if ((status = SM_Get_NodeDesc(fd_topology, 0, path, &nodeDesc)) != VSTATUS_OK) {
+		if (lightLink) {
+			nodeDesc = cache_nodep->nodeDesc;
+			status = VSTATUS_OK;
+		} else if (sm_discovery_get_nodedesc(cnp, cpp, path, &nodeDesc) == VSTATUS_OK) {
+			status = VSTATUS_OK;
+		} else {
+			status = SM_Get_NodeDesc(fd_topology, 0, path, &nodeDesc);
+		}
+		if (status != VSTATUS_OK) {
 			if (!cpp && !cnp) {
 				IB_LOG_ERRORRC
 					("sm_setup_node: Get NodeDesc failed for local node, rc:",
@@ -2437,7 +2455,12 @@ sm_setup_node(Topology_t * topop, FabricData_t * pdtop, Node_t * cnp, Port_t * c
 
 		// Get the connected-port PortInfo, and save for later.
 		amod = portNumber;
-		status = SM_Get_PortInfo(fd_topology, (1 << 24) | amod | STL_SM_CONF_START_ATTR_MOD, path, &conPortInfo);
+		if (lightLink) {
+			conPortInfo = cache_portp->portData->portInfo;
+			status = VSTATUS_OK;
+		} else {
+			status = SM_Get_PortInfo(fd_topology, (1 << 24) | amod | STL_SM_CONF_START_ATTR_MOD, path, &conPortInfo);
+		}
 		if (status != VSTATUS_OK) {
 
 			if(!cpp || !cnp) {
@@ -2561,7 +2584,7 @@ sm_setup_node(Topology_t * topop, FabricData_t * pdtop, Node_t * cnp, Port_t * c
 			check_for_new_endnode(&nodeInfo, nodep, oldnodep);
 		}
 
-		nodep->asyncReqsSupported = sm_config.sma_batch_size;
+		sm_dispatch_init_node(nodep, oldnodep);
 
 
 		// JPG Add NODE to sorted topo tree here
@@ -2582,6 +2605,12 @@ sm_setup_node(Topology_t * topop, FabricData_t * pdtop, Node_t * cnp, Port_t * c
 							 nodep->nodeInfo.NodeGUID);
 		} else {
 			cl_qmap_set_obj(&nodep->mapObj, nodep);
+			if (cl_hmap_insert(&sm_newTopology.nodeGuidMap, nodep->nodeInfo.NodeGUID, nodep)
+				!= FSUCCESS) {
+				IB_LOG_ERROR_FMT(__func__,
+								 "Error adding Node GUID: " FMT_U64 " to index",
+								 nodep->nodeInfo.NodeGUID);
+			}
 		}
 
 	} else {
@@ -2835,6 +2864,7 @@ sm_setup_node(Topology_t * topop, FabricData_t * pdtop, Node_t * cnp, Port_t * c
             }
             // all switch specific information has been retreived
             nodep->switchInfo = switchInfo;
+            nodep->discoveredFDBTop = switchInfo.LinearFDBTop;
             foundSwitchInfo = 1;
 		}
 
@@ -2882,6 +2912,13 @@ sm_setup_node(Topology_t * topop, FabricData_t * pdtop, Node_t * cnp, Port_t * c
 			nodep->portStateInfo = portStateInfo;
 		}
 
+		if (foundSwitchInfo && sm_light_sweep_trusted(nodep, oldnodep)) {
+			// the switch reads back as the last sweep left it, so its links hold
+			nodep->lightTrusted = 1;
+			use_cache = 1;
+			cache_nodep = oldnodep;
+		}
+
 	} else {
 		start_port = portNumber;
 		end_port = portNumber;
@@ -2915,14 +2952,16 @@ sm_setup_node(Topology_t * topop, FabricData_t * pdtop, Node_t * cnp, Port_t * c
 			(portp->portData->guid
 			 && (nodep != sm_topop->node_head
 				 || !(sm_find_port_guid(&sm_newTopology, portp->portData->guid))))) {
-			if (cl_qmap_insert
-				(sm_newTopology.portMap, portp->portData->guid,
-				 &portp->portData->mapObj.item) != &portp->portData->mapObj.item) {
+			FSTATUS fstatus = cl_hmap_insert(&sm_newTopology.portGuidMap,
+											 portp->portData->guid, portp);
+			if (fstatus == FDUPLICATE) {
 				IB_LOG_ERROR_FMT(__func__,
 								 "Error adding Port GUID: " FMT_U64
-								 " to tree. Already in tree!", portp->portData->guid);
-			} else {
-				cl_qmap_set_obj(&portp->portData->mapObj, portp);
+								 " to index. Already in index!", portp->portData->guid);
+			} else if (fstatus != FSUCCESS) {
+				IB_LOG_ERROR_FMT(__func__,
+								 "Error adding Port GUID: " FMT_U64
+								 " to index, status %d", portp->portData->guid, fstatus);
 			}
 		} else {
 			if (portp->portData->guid) {
@@ -2932,7 +2971,7 @@ sm_setup_node(Topology_t * topop, FabricData_t * pdtop, Node_t * cnp, Port_t * c
 
 		needPortInfo = 1;
 		if (use_cache) {
-			if(nodep->nodeInfo.NodeType == NI_TYPE_SWITCH && cache_nodep) {
+			if(nodep->nodeInfo.NodeType == NI_TYPE_SWITCH && cache_nodep && nodep->portStateInfo) {
 				cache_portp = sm_get_port(cache_nodep, i);
 
 				if (sm_valid_port(cache_portp)) {
@@ -3014,6 +3053,8 @@ sm_setup_node(Topology_t * topop, FabricData_t * pdtop, Node_t * cnp, Port_t * c
 		portp->portData->capmask = portInfo.CapabilityMask.AsReg32;
 		portp->portData->lid = portInfo.LID;
 		portp->portData->lmc = portInfo.s1.LMC;
+		if (portp->index == 0 && nodep->nodeInfo.NodeType == NI_TYPE_SWITCH)
+			nodep->discoveredLid = portInfo.LID;
 		portp->portData->mtuSupported = portInfo.MTU.Cap;
 		portp->state = portInfo.PortStates.s.PortState;
 		if (portInfo.PortStates.s.PortState > IB_PORT_DOWN) {
@@ -3258,13 +3299,33 @@ sm_setup_node(Topology_t * topop, FabricData_t * pdtop, Node_t * cnp, Port_t * c
 	return (VSTATUS_OK);
 }
 
+/*
+ * Allocator for the topology GUID indexes.
+ */
+void *
+sm_hmap_alloc(size_t size, void *context)
+{
+	void *p;
+
+	if (vs_pool_alloc(&sm_pool, size, &p) != VSTATUS_OK)
+		return NULL;
+	memset(p, 0, size);
+	return p;
+}
+
+void
+sm_hmap_free(void *p, void *context)
+{
+	(void)vs_pool_free(&sm_pool, p);
+}
+
 /*
  * the input guid must be a node guid since this is looking in the node map
 */
 Node_t *
 sm_find_guid(Topology_t * topop, uint64_t guid)
 {
-	cl_map_item_t *pItem;
+	Node_t *nodep;
 
 	IB_ENTER(__func__, topop, &guid, 0, 0);
 
@@ -3272,14 +3333,10 @@ sm_find_guid(Topology_t * topop, uint64_t guid)
 	sm_node_guid_cnt++;
 #endif
 
-	if (topop->nodeMap
-		&& ((pItem = cl_qmap_get(topop->nodeMap, guid)) != cl_qmap_end(topop->nodeMap))) {
-		IB_EXIT(__func__, pItem);
-		return (Node_t *) cl_qmap_obj((const cl_map_obj_t * const) pItem);
-	}
+	nodep = (Node_t *) cl_hmap_get(&topop->nodeGuidMap, guid);
 
-	IB_EXIT(__func__, NULL);
-	return (NULL);
+	IB_EXIT(__func__, nodep);
+	return (nodep);
 }
 
 Node_t *
@@ -3543,7 +3600,7 @@ sm_find_active_port_guid(Topology_t * topop, uint64_t guid)
 Port_t *
 sm_find_port_guid(Topology_t * topop, uint64_t guid)
 {
-	cl_map_item_t *pItem;
+	Port_t *portp;
 
 	IB_ENTER(__func__, topop, &guid, 0, 0);
 
@@ -3551,14 +3608,10 @@ sm_find_port_guid(Topology_t * topop, uint64_t guid)
 	sm_port_guid_cnt++;
 #endif
 
-	if (topop->portMap
-		&& ((pItem = cl_qmap_get(topop->portMap, guid)) != cl_qmap_end(topop->portMap))) {
-		IB_EXIT(__func__, pItem);
-		return (Port_t *) cl_qmap_obj((const cl_map_obj_t * const) pItem);
-	}
+	portp = (Port_t *) cl_hmap_get(&topop->portGuidMap, guid);
 
-	IB_EXIT(__func__, NULL);
-	return (NULL);
+	IB_EXIT(__func__, portp);
+	return (portp);
 }
 
 Port_t *
@@ -4823,7 +4876,8 @@ sm_setup_switches_lrdr_wave_discovery_order(Topology_t * topop, int rebalance,
 			return status;
 		}
 
-		if (routing_needed) {
+		/* a warm start leaves switches which lost their tables out of old_switchesInUse */
+		if (routing_needed || !bitset_equal(&old_switchesInUse, &new_switchesInUse)) {
 			/* Setup full LFTs */
 			if ((status =
 				 sm_routing_route_switch_LR(sm_topop, swlist_head, rebalance)) != VSTATUS_OK) {
@@ -6349,6 +6403,7 @@ sm_send_lft(Topology_t * topop, Node_t * cnp)
 	Port_t *swportp;
 	uint32_t amod;
 	const uint16_t lids_per_mad = sm_config.lft_multi_block * MAX_LFT_ELEMENTS_BLOCK;
+	STL_LINEAR_FORWARDING_TABLE lftBlocks[STL_NUM_LFT_BLOCKS_PER_DRSMP];
 
 	swportp = sm_get_port(cnp, 0);
 	if (!sm_valid_port(swportp)) {
@@ -6366,10 +6421,10 @@ sm_send_lft(Topology_t * topop, Node_t * cnp)
 
 		amod = (numBlocks << 24) | currentSet;
 
+		sm_lft_copy_blocks(cnp, currentSet, numBlocks, lftBlocks);
 		status = SM_Set_LFT_Dispatch_LR(fd_topology, amod, sm_lid,
 										swportp->portData->lid,
-										(STL_LINEAR_FORWARDING_TABLE *) & cnp->
-										lft[currentLid], numBlocks, sm_config.mkey, cnp,
+										lftBlocks, numBlocks, sm_config.mkey, cnp,
 										&sm_asyncDispatch);
 
 		if (status != VSTATUS_OK) {
@@ -6393,6 +6448,7 @@ sm_setup_lft_block(Topology_t * topop, Node_t * switchp, uint32_t lid_entry, int
 	uint16_t numBlocks = 1;
 	int block, start_lid;
 	uint32_t amod;
+	STL_LINEAR_FORWARDING_TABLE lftBlock;
 	/* program the full LFT but write only the LFT blocks that correspond to the LID entry */
 
 	/* program the LFT block that contains the LID entry */
@@ -6414,9 +6470,9 @@ sm_setup_lft_block(Topology_t * topop, Node_t * switchp, uint32_t lid_entry, int
 //          switchp->nodeInfo.NodeGUID, path[0], path[1]);
 
 	amod = (numBlocks << 24) | block;
+	sm_lft_copy_blocks(switchp, block, numBlocks, &lftBlock);
 	status =
-		SM_Set_LFT(fd_topology, amod, path,
-				   (STL_LINEAR_FORWARDING_TABLE *) & switchp->lft[start_lid], sm_config.mkey,
+		SM_Set_LFT(fd_topology, amod, path, &lftBlock, sm_config.mkey,
 				   use_lr_dr_mix);
 
 	if (status != VSTATUS_OK) {
@@ -6438,28 +6494,12 @@ Status_t sm_Node_init_lft(Node_t * switchp, size_t * outSize)
 		return VSTATUS_OK;
 	}
 
-	if (switchp->lft) {
-		vs_pool_free(&sm_pool, switchp->lft);
-		switchp->lft = 0;
-		if (outSize)
-			*outSize = 0;
-	}
-
 	size_t sizeLft = sizeof(PORT) * ROUNDUP(switchp->switchInfo.LinearFDBTop+1, MAX_LFT_ELEMENTS_BLOCK);
 
-	Status_t s = vs_pool_alloc(&sm_pool, sizeLft, (void**)&switchp->lft);
-	if (s == VSTATUS_OK && switchp->lft) {
-		memset((void *)switchp->lft, 0xff, sizeLft);
-		if (outSize)
-			*outSize = sizeLft;
-		return s;
-	}
-
+	// every block starts out as the shared unrouted block
+	Status_t s = sm_lft_alloc(switchp);
 	if (outSize)
-		*outSize = 0;
-	IB_LOG_ERROR_FMT(__func__,
-		"Unable to allocate %z LFT memory for node \"%s\", nodeGuid "FMT_U64,
-		sizeLft, switchp->nodeDesc, switchp->nodeInfo.NodeGUID);
+		*outSize = (s == VSTATUS_OK) ? sizeLft : 0;
 
 	return s;
 }
@@ -6515,7 +6555,7 @@ sm_calculate_lft(Topology_t * topop, Node_t * switchp)
 			}
 		}
 		for_all_port_lids(portp, portLid) {
-			switchp->lft[portLid] = xftPorts[portLid - lid];
+			sm_lft_set_port(switchp, portLid, xftPorts[portLid - lid]);
 		}
 	}
 
@@ -6574,6 +6614,7 @@ sm_write_full_lfts_by_block_LR(Topology_t * topop, SwitchList_t * swlist, int re
 	int sent_lft_sets = 0;
 	uint16_t numBlocks = 1;
 	uint32_t amod;
+	STL_LINEAR_FORWARDING_TABLE lftBlocks[STL_NUM_LFT_BLOCKS_PER_DRSMP];
 
 	// LFTs are already calculated
 	// Write the LFT blocks for this switch list
@@ -6620,10 +6661,10 @@ sm_write_full_lfts_by_block_LR(Topology_t * topop, SwitchList_t * swlist, int re
 
 			amod = (numBlocks << 24) | block;
 
+			sm_lft_copy_blocks(switchp, block, numBlocks, lftBlocks);
 			status =
 				SM_Set_LFT_Dispatch_LR(fd_topology, amod, sm_lid, swportp->portData->lid,
-									   (STL_LINEAR_FORWARDING_TABLE *) & switchp->
-									   lft[block * MAX_LFT_ELEMENTS_BLOCK], numBlocks,
+									   lftBlocks, numBlocks,
 									   sm_config.mkey, switchp, &sm_asyncDispatch);
 			sent_lft_sets = 1;
 			if (status != VSTATUS_OK) {
@@ -6688,7 +6729,7 @@ sm_setup_lft(Topology_t * topop, Node_t * cnp)
 				status = topop->routingModule->funcs.setup_xft(topop, cnp, nodep, portp, xftPorts);
 
 				for_all_port_lids(portp, currentLid) {
-					cnp->lft[currentLid] = xftPorts[currentLid - portp->portData->lid];
+					sm_lft_set_port(cnp, currentLid, xftPorts[currentLid - portp->portData->lid]);
 				}
 			}
 		}
@@ -6722,6 +6763,7 @@ sm_send_partial_lft(Topology_t * topop, Node_t * cnp, bitset_t * lftBlocks)
 	Status_t status = VSTATUS_OK;
 	Port_t *swportp;
 	uint32_t amod;
+	STL_LINEAR_FORWARDING_TABLE lftBuf[STL_NUM_LFT_BLOCKS_PER_DRSMP];
 
 	IB_ENTER(__func__, topop, cnp, 0, 0);
 
@@ -6753,10 +6795,10 @@ sm_send_partial_lft(Topology_t * topop, Node_t * cnp, bitset_t * lftBlocks)
 
 			amod = (numBlocks << 24) | firstBlkInSend;
 
+			sm_lft_copy_blocks(cnp, firstBlkInSend, numBlocks, lftBuf);
 			status = SM_Set_LFT_Dispatch_LR(fd_topology, amod, sm_lid,
 										swportp->portData->lid,
-										(STL_LINEAR_FORWARDING_TABLE *) & cnp->
-										lft[currentLid], numBlocks, sm_config.mkey, cnp,
+										lftBuf, numBlocks, sm_config.mkey, cnp,
 										&sm_asyncDispatch);
 
 			if (status != VSTATUS_OK) {
@@ -6813,20 +6855,20 @@ sm_setup_lft_deltas(Topology_t * oldtp, Topology_t * newtp, Node_t * cnp)
 
 	curBlock = 0xffff;
 	for (currentLid = 0; currentLid <= newtp->maxLid; currentLid++) {
-		if (cnp->lft[currentLid] == 0xff)
+		if (sm_lft_port(cnp, currentLid) == 0xff)
 			continue;
 
 		if (!lidmap[currentLid].newNodep) {
 			if (lidmap[currentLid].oldNodep &&
 				(lidmap[currentLid].oldNodep->nodeInfo.NodeType != NI_TYPE_SWITCH)) {
-				portInUse = sm_get_port(cnp, cnp->lft[currentLid]);
+				portInUse = sm_get_port(cnp, sm_lft_port(cnp, currentLid));
 				if (sm_valid_port(portInUse)
 					&& portInUse->portData->lidsRouted > 0) {
 					portInUse->portData->lidsRouted--;
 				}
 			}
 
-			cnp->lft[currentLid] = 0xff;
+			sm_lft_set_port(cnp, currentLid, 0xff);
 
 			if (optSend && (curBlock != currentLid / LFTABLE_LIST_COUNT)) {
 				// Set lft block num
@@ -6849,7 +6891,7 @@ sm_setup_lft_deltas(Topology_t * oldtp, Topology_t * newtp, Node_t * cnp)
 				newtp->routingModule->funcs.setup_xft(newtp, cnp, nodep, portp, xftPorts);
 				curBlock = 0xffff;
 				for_all_port_lids(portp, currentLid) {
-					cnp->lft[currentLid] = xftPorts[currentLid - portp->portData->lid];
+					sm_lft_set_port(cnp, currentLid, xftPorts[currentLid - portp->portData->lid]);
 					if (optSend && (curBlock != currentLid / LFTABLE_LIST_COUNT)) {
 						// Set lft block num
 						curBlock = currentLid / LFTABLE_LIST_COUNT;
@@ -7483,30 +7525,28 @@ sm_get_port(const Node_t * nodep, uint32_t portIndex)
 #endif
 
 static Status_t
-sm_util_alloc_port(Port_t * portp, int numPorts, int *bytes)
+sm_util_alloc_port(SmArena_t * arena, Port_t * portp, int numPorts, int *bytes)
 {
 	Status_t status;
 
 	if (smDebugDynamicPortAlloc)
 		IB_ENTER(__func__, 0, 0, 0, 0);
 
-	// Allocate port record associated with the port.
-	status = vs_pool_alloc(&sm_pool, sizeof(PortData_t), (void *) &portp->portData);
+	// Allocate port record associated with the port from the arena of the
+	// topology that owns the node.  The arena returns it zeroed.
+	status = sm_arena_alloc(arena, sizeof(PortData_t), (void *) &portp->portData);
 	if (status != VSTATUS_OK) {
 		IB_LOG_ERROR0("can't malloc port");
-		(void) vs_pool_free(&sm_pool, (void *) portp->portData);
 		portp->portData = NULL;
 		if (smDebugDynamicPortAlloc)
 			IB_EXIT(__func__, status);
 		return (status);
 	}
-	// Initialize port record.
-	memset(portp->portData, 0, sizeof(PortData_t));
 
 	if (!bitset_init(&sm_pool, &portp->portData->vfMember, MAX_VFABRICS)) {
 		status = VSTATUS_BAD;
 		IB_LOG_ERROR0("can't malloc port data");
-		(void) vs_pool_free(&sm_pool, (void *) portp->portData);
+		(void) sm_arena_free((void *) portp->portData);
 		portp->portData = NULL;
 		if (smDebugDynamicPortAlloc)
 			IB_EXIT(__func__, status);
@@ -7517,7 +7557,7 @@ sm_util_alloc_port(Port_t * portp, int numPorts, int *bytes)
 		status = VSTATUS_BAD;
 		IB_LOG_ERROR0("can't malloc port data");
 		bitset_free(&portp->portData->vfMember);
-		(void) vs_pool_free(&sm_pool, (void *) portp->portData);
+		(void) sm_arena_free((void *) portp->portData);
 		portp->portData = NULL;
 		if (smDebugDynamicPortAlloc)
 			IB_EXIT(__func__, status);
@@ -7544,7 +7584,7 @@ sm_alloc_port(Topology_t * topop, Node_t * nodep, uint32_t portIndex, int *bytes
 								   portIndex, nodep->index);
 		}
 		// Allocate port record associated with the port.
-		if (sm_util_alloc_port(&nodep->port[portIndex], nodep->nodeInfo.NumPorts, bytes) !=
+		if (sm_util_alloc_port(sm_arena_owner(nodep), &nodep->port[portIndex], nodep->nodeInfo.NumPorts, bytes) !=
 			VSTATUS_OK) {
 			return NULL;
 		}
@@ -7575,13 +7615,15 @@ sm_free_port(Port_t * portp)
 			portp->portData->hfiCongCon = NULL;
 		}
 		// Free port record associated with the port.
-		(void) vs_pool_free(&sm_pool, (void *) portp->portData);
+		(void) sm_arena_free((void *) portp->portData);
 		portp->portData = NULL;
 	}
 }
 
+// release what the ports of a node hold from sm_pool.  The PortData_t
+// records come from the topology's arena and go with the arena.
 void
-sm_node_free_port(Node_t * nodep)
+sm_node_release_ports(Node_t * nodep)
 {
 	int portIndex = 0;
 
@@ -7589,7 +7631,7 @@ sm_node_free_port(Node_t * nodep)
 		for (portIndex = 0; portIndex <= nodep->nodeInfo.NumPorts; portIndex++) {
 			if (nodep->port[portIndex].portData != NULL) {
 				if (smDebugDynamicPortAlloc) {
-					IB_LOG_INFINI_INFO_FMT(__func__, "Freeing  port %d for node %d",
+					IB_LOG_INFINI_INFO_FMT(__func__, "Releasing port %d for node %d",
 										   portIndex, nodep->index);
 				}
 
@@ -7603,9 +7645,6 @@ sm_node_free_port(Node_t * nodep)
 				}
 
 				sm_port_releaseNewArb(&nodep->port[portIndex]);
-				// Free port record associated with the port.
-				(void) vs_pool_free(&sm_pool, (void *) nodep->port[portIndex].portData);
-				nodep->port[portIndex].portData = NULL;
 			}
 		}
 	}
@@ -8039,7 +8078,7 @@ void
 sm_compactSwitchSpace(Topology_t * topop, bitset_t * switchbits)
 {
 	Node_t *nodep;
-	int fidx, lidx, i, j, ij, ji, oldij;
+	int fidx, lidx, i, j;
 	uint16_t *cost = NULL;
 	size_t bytesCost;
 	size_t numNodesSqr;
@@ -8082,16 +8121,12 @@ sm_compactSwitchSpace(Topology_t * topop, bitset_t * switchbits)
 					bitset_clear(switchbits, lidx);
 
 					for (j = 0; j < lidx; j++) {
-						ij = Index(fidx, j);
-						ji = Index(j, fidx);
-
 						if (j == fidx) {
-							topop->cost[ij] = topop->cost[ji] = 0;
+							sm_cost_set(topop, fidx, j, 0);
 							continue;
 						}
 
-						oldij = Index(lidx, j);
-						topop->cost[ij] = topop->cost[ji] = topop->cost[oldij];
+						sm_cost_set(topop, fidx, j, sm_cost_get(topop, lidx, j));
 					}
 					break;
 				}
@@ -8161,10 +8196,10 @@ sm_log_topology(Topology_t * topop)
 			}
 		}
 		for (lid = 0; lid <= topop->maxLid; lid++) {
-			if (nodep->lft[lid] == 0xff)
+			if (sm_lft_port(nodep, lid) == 0xff)
 				continue;
 			IB_LOG_INFINI_INFO_FMT(__func__, "lid  0x%x  port %d", lid,
-								   nodep->lft[lid]);
+								   sm_lft_port(nodep, lid));
 		}
 		for_all_ports(nodep, portp) {
 			if (sm_valid_port(portp) && (portp->state > IB_PORT_DOWN)) {
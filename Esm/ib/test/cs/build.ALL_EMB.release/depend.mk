@@ -0,0 +1,8 @@
+include Makefile
+include build.ALL_EMB.release/cs_sema_test.c.dep
+include build.ALL_EMB.release/cs_string_test.c.dep
+include build.ALL_EMB.release/vs_eventthr_test.c.dep
+include build.ALL_EMB.release/vs_lock_test.c.dep
+include build.ALL_EMB.release/vs_pool_test.c.dep
+include build.ALL_EMB.release/vs_thread_test.c.dep
+include build.ALL_EMB.release/vs_timeget_test.c.dep
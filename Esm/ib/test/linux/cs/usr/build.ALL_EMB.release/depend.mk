@@ -0,0 +1,8 @@
+include Makefile
+include build.ALL_EMB.release/evt_test.c.dep
+include build.ALL_EMB.release/lock_test.c.dep
+include build.ALL_EMB.release/pool_test.c.dep
+include build.ALL_EMB.release/sema_test.c.dep
+include build.ALL_EMB.release/string_test.c.dep
+include build.ALL_EMB.release/thread_test.c.dep
+include build.ALL_EMB.release/timeget_test.c.dep
@@ -0,0 +1,5 @@
+include Makefile
+include build.ALL_EMB.release/qp1send.c.dep
+include build.ALL_EMB.release/qp1recv.c.dep
+include build.ALL_EMB.release/qp1source.c.dep
+include build.ALL_EMB.release/qp1sink.c.dep
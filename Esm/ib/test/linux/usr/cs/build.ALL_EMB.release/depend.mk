@@ -0,0 +1,3 @@
+include Makefile
+include build.ALL_EMB.release/send.c.dep
+include build.ALL_EMB.release/recv.c.dep
@@ -69,6 +69,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "iba/public/ipci.h"
 #endif
 #include "iba/public/iquickmap.h"
+#include "iba/public/ihashmap.h"
 #if defined(VXWORKS)
 #include "iba/public/ireaper.h"
 #endif
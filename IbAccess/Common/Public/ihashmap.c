@@ -0,0 +1,335 @@
+/* BEGIN_ICS_COPYRIGHT6 ****************************************
+
+Copyright (c) 2015, Intel Corporation
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+    * Neither the name of Intel Corporation nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+** END_ICS_COPYRIGHT6   ****************************************/
+
+
+#include "ihashmap.h"
+#include "imemory.h"
+
+// Make a memory tag of 'ihmp' for ihashmap.
+#define HMAP_MEM_TAG		MAKE_MEM_TAG( i, h, m, p )
+
+// smallest table allocated
+#define HMAP_MIN_CAPACITY	16
+
+// slots compared per step of a lookup
+#define HMAP_GROUP			4
+
+
+///////////////////////////////////////////////////////////////////////////////
+// __cl_hmap_hash
+//
+// Description:
+//	Mix all 64 bits of the key into the slot index.  GUIDs of one vendor
+//	share their upper 24 bits and often differ only in a few low ones.
+//
+///////////////////////////////////////////////////////////////////////////////
+static __inline size_t
+__cl_hmap_hash(
+	IN	uint64	key,
+	IN	size_t	capacity )
+{
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+	return (size_t)key & (capacity - 1);
+}
+
+
+static void*
+__cl_hmap_alloc(
+	IN	const cl_hmap_t* const	p_map,
+	IN	size_t					size )
+{
+	void *p_mem;
+
+	if (p_map->pfn_alloc)
+	{
+		p_mem = (*p_map->pfn_alloc)(size, p_map->context);
+		if (p_mem)
+			MemoryClear(p_mem, size);
+		return p_mem;
+	}
+	return MemoryAllocate2AndClear(size, IBA_MEM_FLAG_PREMPTABLE, HMAP_MEM_TAG);
+}
+
+
+static void
+__cl_hmap_free(
+	IN	const cl_hmap_t* const	p_map,
+	IN	void					*p_mem )
+{
+	if (p_map->pfn_free)
+		(*p_map->pfn_free)(p_mem, p_map->context);
+	else
+		MemoryDeallocate(p_mem);
+}
+
+
+// store an entry known not to be in the map into a table with room for it
+static void
+__cl_hmap_place(
+	IN	cl_hmap_t* const	p_map,
+	IN	uint64				key,
+	IN	void				*p_object )
+{
+	size_t mask = p_map->capacity - 1;
+	size_t i = __cl_hmap_hash(key, p_map->capacity);
+
+	while (p_map->p_keys[i])
+		i = (i + 1) & mask;
+	p_map->p_keys[i] = key;
+	p_map->p_objs[i] = p_object;
+}
+
+
+static FSTATUS
+__cl_hmap_resize(
+	IN	cl_hmap_t* const	p_map,
+	IN	size_t				capacity )
+{
+	uint64	*p_oldKeys = p_map->p_keys;
+	void	**p_oldObjs = p_map->p_objs;
+	size_t	oldCapacity = p_map->capacity;
+	uint8	*p_mem;
+	size_t	i;
+
+	// keys and objects share one allocation, keys first so they stay
+	// 8 byte aligned
+	p_mem = (uint8*)__cl_hmap_alloc(p_map, capacity * (sizeof(uint64) + sizeof(void*)));
+	if (! p_mem)
+		return FINSUFFICIENT_MEMORY;
+
+	p_map->p_keys = (uint64*)p_mem;
+	p_map->p_objs = (void**)(p_mem + capacity * sizeof(uint64));
+	p_map->capacity = capacity;
+
+	for (i = 0; i < oldCapacity; i++)
+	{
+		if (p_oldKeys[i])
+			__cl_hmap_place(p_map, p_oldKeys[i], p_oldObjs[i]);
+	}
+	if (p_oldKeys)
+		__cl_hmap_free(p_map, p_oldKeys);
+	return FSUCCESS;
+}
+
+
+// slot holding key, or capacity if none
+static size_t
+__cl_hmap_find(
+	IN	const cl_hmap_t* const	p_map,
+	IN	const uint64			key )
+{
+	const uint64	*p_keys = p_map->p_keys;
+	size_t			mask = p_map->capacity - 1;
+	size_t			i, j;
+	unsigned		hit, empty;
+
+	if (p_map->count == 0 || key == 0)
+		return p_map->capacity;
+
+	i = __cl_hmap_hash(key, p_map->capacity);
+	for (;;)
+	{
+		if (i + HMAP_GROUP <= p_map->capacity)
+		{
+			// Compare a whole group without branching so the compiler can
+			// do it with vector instructions.  Linear probing never leaves
+			// an empty slot between a key's home slot and the key, so the
+			// first hit is the key and an empty slot before it ends the
+			// search.
+			hit = empty = 0;
+			for (j = 0; j < HMAP_GROUP; j++)
+			{
+				hit |= (unsigned)(p_keys[i + j] == key) << j;
+				empty |= (unsigned)(p_keys[i + j] == 0) << j;
+			}
+			if (hit)
+			{
+				for (j = 0; ! (hit & (1u << j)); j++)
+					;
+				return i + j;
+			}
+			if (empty)
+				return p_map->capacity;
+			i = (i + HMAP_GROUP) & mask;
+		} else {
+			// the group would run off the end of the table
+			if (p_keys[i] == key)
+				return i;
+			if (p_keys[i] == 0)
+				return p_map->capacity;
+			i = (i + 1) & mask;
+		}
+	}
+}
+
+
+void
+cl_hmap_init(
+	IN	cl_hmap_t* const		p_map,
+	IN	cl_pfn_hmap_alloc_t		pfn_alloc OPTIONAL,
+	IN	cl_pfn_hmap_free_t		pfn_free OPTIONAL,
+	IN	void* const				context OPTIONAL )
+{
+	ASSERT( p_map );
+	ASSERT( (pfn_alloc == NULL) == (pfn_free == NULL) );
+
+	MemoryClear(p_map, sizeof(*p_map));
+	p_map->pfn_alloc = pfn_alloc;
+	p_map->pfn_free = pfn_free;
+	p_map->context = context;
+}
+
+
+void
+cl_hmap_destroy(
+	IN	cl_hmap_t* const		p_map )
+{
+	ASSERT( p_map );
+
+	if (p_map->p_keys)
+		__cl_hmap_free(p_map, p_map->p_keys);
+	p_map->p_keys = NULL;
+	p_map->p_objs = NULL;
+	p_map->capacity = 0;
+	p_map->count = 0;
+}
+
+
+FSTATUS
+cl_hmap_reserve(
+	IN	cl_hmap_t* const		p_map,
+	IN	const size_t			count )
+{
+	size_t capacity;
+
+	ASSERT( p_map );
+
+	// at most half full keeps the probe sequences short
+	capacity = p_map->capacity ? p_map->capacity : HMAP_MIN_CAPACITY;
+	while (capacity < count * 2)
+		capacity *= 2;
+	if (capacity == p_map->capacity)
+		return FSUCCESS;
+	return __cl_hmap_resize(p_map, capacity);
+}
+
+
+FSTATUS
+cl_hmap_insert(
+	IN	cl_hmap_t* const		p_map,
+	IN	const uint64			key,
+	IN	const void* const		p_object )
+{
+	FSTATUS status;
+
+	ASSERT( p_map );
+
+	if (key == 0)
+		return FINVALID_PARAMETER;
+	if (__cl_hmap_find(p_map, key) != p_map->capacity)
+		return FDUPLICATE;
+
+	status = cl_hmap_reserve(p_map, p_map->count + 1);
+	if (status != FSUCCESS)
+		return status;
+
+	__cl_hmap_place(p_map, key, (void*)p_object);
+	p_map->count++;
+	return FSUCCESS;
+}
+
+
+void*
+cl_hmap_get(
+	IN	const cl_hmap_t* const	p_map,
+	IN	const uint64			key )
+{
+	size_t i;
+
+	ASSERT( p_map );
+
+	i = __cl_hmap_find(p_map, key);
+	if (i == p_map->capacity)
+		return NULL;
+	return p_map->p_objs[i];
+}
+
+
+void*
+cl_hmap_remove(
+	IN	cl_hmap_t* const		p_map,
+	IN	const uint64			key )
+{
+	size_t	mask = p_map->capacity - 1;
+	size_t	i, j, home;
+	void	*p_object;
+
+	ASSERT( p_map );
+
+	i = __cl_hmap_find(p_map, key);
+	if (i == p_map->capacity)
+		return NULL;
+	p_object = p_map->p_objs[i];
+
+	// Shift back every later entry of the run which would no longer be
+	// reachable from its home slot through the hole at i.
+	for (j = (i + 1) & mask; p_map->p_keys[j]; j = (j + 1) & mask)
+	{
+		home = __cl_hmap_hash(p_map->p_keys[j], p_map->capacity);
+		if (((j - home) & mask) >= ((j - i) & mask))
+		{
+			p_map->p_keys[i] = p_map->p_keys[j];
+			p_map->p_objs[i] = p_map->p_objs[j];
+			i = j;
+		}
+	}
+	p_map->p_keys[i] = 0;
+	p_map->p_objs[i] = NULL;
+	p_map->count--;
+	return p_object;
+}
+
+
+void
+cl_hmap_remove_all(
+	IN	cl_hmap_t* const		p_map )
+{
+	ASSERT( p_map );
+
+	if (p_map->p_keys)
+	{
+		MemoryClear(p_map->p_keys, p_map->capacity * sizeof(uint64));
+		MemoryClear(p_map->p_objs, p_map->capacity * sizeof(void*));
+	}
+	p_map->count = 0;
+}
@@ -0,0 +1,454 @@
+/* BEGIN_ICS_COPYRIGHT6 ****************************************
+
+Copyright (c) 2015, Intel Corporation
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+    * Neither the name of Intel Corporation nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+** END_ICS_COPYRIGHT6   ****************************************/
+
+/*
+ * Abstract:
+ *	Declaration of hash map, an open addressing hash table keyed by a
+ *	64-bit value such as a GUID.
+ *
+ * Environment:
+ *	All
+ */
+
+
+#ifndef _IBA_PUBLIC_IHASHMAP_H_
+#define _IBA_PUBLIC_IHASHMAP_H_
+
+
+#include "iba/public/datatypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****h* Component Library/Hash Map
+* NAME
+*	Hash Map
+*
+* DESCRIPTION
+*	Hash map stores a pointer to a user object under a unique, non-zero
+*	64-bit key and provides constant time lookup of the object given the
+*	key.  It is intended for indexes keyed by GUID where a quick map's
+*	sorted order is not needed.
+*
+*	The keys are kept in one flat array and collisions are resolved by
+*	linear probing, so a lookup reads consecutive keys from one or two
+*	cache lines and compares them a group at a time.  Removal shifts later
+*	entries back rather than leaving tombstones, so lookups stay short no
+*	matter how many items have been removed.
+*
+*	Unlike quick map, hash map allocates its table, and insertion can fail
+*	for lack of memory.  The table is allocated through the functions given
+*	to cl_hmap_init, or the component library's memory functions if none.
+*
+*	A hash map which is all zeros is a valid empty map using the default
+*	allocator.
+*
+*	Hash map is not thread safe, and users must provide serialization when
+*	adding and removing items from the map.
+*
+* SEE ALSO
+*	Structures:
+*		cl_hmap_t
+*
+*	Callbacks:
+*		cl_pfn_hmap_alloc_t, cl_pfn_hmap_free_t
+*
+*	Initialization/Destruction:
+*		cl_hmap_init, cl_hmap_destroy
+*
+*	Manipulation:
+*		cl_hmap_insert, cl_hmap_get, cl_hmap_remove, cl_hmap_remove_all,
+*		cl_hmap_reserve
+*
+*	Attributes:
+*		cl_hmap_count
+*********/
+
+
+/****d* Component Library: Hash Map/cl_pfn_hmap_alloc_t
+* NAME
+*	cl_pfn_hmap_alloc_t
+*
+* DESCRIPTION
+*	The cl_pfn_hmap_alloc_t function type defines the prototype for functions
+*	used by a hash map to allocate its table.
+*
+* SYNOPSIS
+*/
+typedef void*
+(*cl_pfn_hmap_alloc_t)(
+	IN	size_t					size,
+	IN	void					*context );
+/*
+* PARAMETERS
+*	size
+*		[in] Number of bytes to allocate.
+*
+*	context
+*		[in] Value passed to cl_hmap_init.
+*
+* RETURN VALUE
+*	Pointer to the memory, or NULL if it could not be allocated.
+*
+* SEE ALSO
+*	Hash Map, cl_hmap_init, cl_pfn_hmap_free_t
+*********/
+
+
+/****d* Component Library: Hash Map/cl_pfn_hmap_free_t
+* NAME
+*	cl_pfn_hmap_free_t
+*
+* DESCRIPTION
+*	The cl_pfn_hmap_free_t function type defines the prototype for functions
+*	used by a hash map to free memory obtained from its cl_pfn_hmap_alloc_t.
+*
+* SYNOPSIS
+*/
+typedef void
+(*cl_pfn_hmap_free_t)(
+	IN	void					*p_mem,
+	IN	void					*context );
+/*
+* PARAMETERS
+*	p_mem
+*		[in] Memory to free.
+*
+*	context
+*		[in] Value passed to cl_hmap_init.
+*
+* SEE ALSO
+*	Hash Map, cl_hmap_init, cl_pfn_hmap_alloc_t
+*********/
+
+
+/****s* Component Library: Hash Map/cl_hmap_t
+* NAME
+*	cl_hmap_t
+*
+* DESCRIPTION
+*	Hash map structure.
+*
+*	The cl_hmap_t structure should be treated as opaque and should
+*	be manipulated only through the provided functions.
+*
+* SYNOPSIS
+*/
+typedef struct _cl_hmap
+{
+	uint64					*p_keys;
+	void					**p_objs;
+	size_t					capacity;
+	size_t					count;
+	cl_pfn_hmap_alloc_t		pfn_alloc;
+	cl_pfn_hmap_free_t		pfn_free;
+	void					*context;
+
+} cl_hmap_t;
+/*
+* FIELDS
+*	p_keys
+*		Table of keys, capacity entries long.  0 marks an empty slot.
+*
+*	p_objs
+*		Objects of the slots in p_keys.
+*
+*	capacity
+*		Number of slots, 0 or a power of 2.
+*
+*	count
+*		Number of items in the map.
+*
+*	pfn_alloc, pfn_free, context
+*		Allocator for the table, NULL for the default.
+*
+* SEE ALSO
+*	Hash Map
+*********/
+
+
+/****f* Component Library: Hash Map/cl_hmap_count
+* NAME
+*	cl_hmap_count
+*
+* DESCRIPTION
+*	The cl_hmap_count function returns the number of items stored
+*	in a hash map.
+*
+* SYNOPSIS
+*/
+static __inline size_t
+cl_hmap_count(
+	IN	const cl_hmap_t* const	p_map )
+{
+	return( p_map->count );
+}
+/*
+* PARAMETERS
+*	p_map
+*		[in] Pointer to a cl_hmap_t structure whose item count to return.
+*
+* RETURN VALUE
+*	Returns the number of items stored in the map.
+*
+* SEE ALSO
+*	Hash Map
+*********/
+
+
+/****f* Component Library: Hash Map/cl_hmap_init
+* NAME
+*	cl_hmap_init
+*
+* DESCRIPTION
+*	The cl_hmap_init function initializes a hash map for use.
+*
+* SYNOPSIS
+*/
+void
+cl_hmap_init(
+	IN	cl_hmap_t* const		p_map,
+	IN	cl_pfn_hmap_alloc_t		pfn_alloc OPTIONAL,
+	IN	cl_pfn_hmap_free_t		pfn_free OPTIONAL,
+	IN	void* const				context OPTIONAL );
+/*
+* PARAMETERS
+*	p_map
+*		[in] Pointer to a cl_hmap_t structure to initialize.
+*
+*	pfn_alloc, pfn_free
+*		[in] Functions used to allocate and free the table.  Either both
+*		or neither must be given.
+*
+*	context
+*		[in] Value passed to pfn_alloc and pfn_free.
+*
+* NOTES
+*	No memory is allocated until the first insertion or cl_hmap_reserve.
+*
+* SEE ALSO
+*	Hash Map, cl_hmap_destroy
+*********/
+
+
+/****f* Component Library: Hash Map/cl_hmap_destroy
+* NAME
+*	cl_hmap_destroy
+*
+* DESCRIPTION
+*	The cl_hmap_destroy function frees the table of a hash map and leaves
+*	it empty.  The objects stored in the map are not touched.
+*
+* SYNOPSIS
+*/
+void
+cl_hmap_destroy(
+	IN	cl_hmap_t* const		p_map );
+/*
+* PARAMETERS
+*	p_map
+*		[in] Pointer to a cl_hmap_t structure to destroy.
+*
+* NOTES
+*	The map may be used again after it is destroyed; the allocator given to
+*	cl_hmap_init is kept.
+*
+* SEE ALSO
+*	Hash Map, cl_hmap_init, cl_hmap_remove_all
+*********/
+
+
+/****f* Component Library: Hash Map/cl_hmap_reserve
+* NAME
+*	cl_hmap_reserve
+*
+* DESCRIPTION
+*	The cl_hmap_reserve function grows the table of a hash map so that it
+*	can hold count items without being reallocated.
+*
+* SYNOPSIS
+*/
+FSTATUS
+cl_hmap_reserve(
+	IN	cl_hmap_t* const		p_map,
+	IN	const size_t			count );
+/*
+* PARAMETERS
+*	p_map
+*		[in] Pointer to a cl_hmap_t structure.
+*
+*	count
+*		[in] Number of items to make room for.
+*
+* RETURN VALUES
+*	FSUCCESS if the table is large enough.
+*
+*	FINSUFFICIENT_MEMORY if the table could not be grown.
+*
+* SEE ALSO
+*	Hash Map, cl_hmap_insert
+*********/
+
+
+/****f* Component Library: Hash Map/cl_hmap_insert
+* NAME
+*	cl_hmap_insert
+*
+* DESCRIPTION
+*	The cl_hmap_insert function stores an object in a hash map.
+*
+* SYNOPSIS
+*/
+FSTATUS
+cl_hmap_insert(
+	IN	cl_hmap_t* const		p_map,
+	IN	const uint64			key,
+	IN	const void* const		p_object );
+/*
+* PARAMETERS
+*	p_map
+*		[in] Pointer to a cl_hmap_t structure into which to add the object.
+*
+*	key
+*		[in] Value to assign to the object.  Must not be 0.
+*
+*	p_object
+*		[in] Object to store.
+*
+* RETURN VALUES
+*	FSUCCESS if the object was stored.
+*
+*	FDUPLICATE if an object with the same key is already stored.  The map
+*	is unchanged.
+*
+*	FINVALID_PARAMETER if key is 0.
+*
+*	FINSUFFICIENT_MEMORY if the table had to grow and could not.
+*
+* SEE ALSO
+*	Hash Map, cl_hmap_get, cl_hmap_remove
+*********/
+
+
+/****f* Component Library: Hash Map/cl_hmap_get
+* NAME
+*	cl_hmap_get
+*
+* DESCRIPTION
+*	The cl_hmap_get function returns the object stored in a hash map
+*	with the specified key.
+*
+* SYNOPSIS
+*/
+void*
+cl_hmap_get(
+	IN	const cl_hmap_t* const	p_map,
+	IN	const uint64			key );
+/*
+* PARAMETERS
+*	p_map
+*		[in] Pointer to a cl_hmap_t structure from which to retrieve the
+*		object with the specified key.
+*
+*	key
+*		[in] Key value used to search for the desired object.
+*
+* RETURN VALUES
+*	Pointer to the object with the desired key value.
+*
+*	NULL if there is no object with the key in the map.
+*
+* SEE ALSO
+*	Hash Map, cl_hmap_insert
+*********/
+
+
+/****f* Component Library: Hash Map/cl_hmap_remove
+* NAME
+*	cl_hmap_remove
+*
+* DESCRIPTION
+*	The cl_hmap_remove function removes the object with the specified key
+*	from a hash map.
+*
+* SYNOPSIS
+*/
+void*
+cl_hmap_remove(
+	IN	cl_hmap_t* const		p_map,
+	IN	const uint64			key );
+/*
+* PARAMETERS
+*	p_map
+*		[in] Pointer to a cl_hmap_t structure from which to remove the
+*		object with the specified key.
+*
+*	key
+*		[in] Key value used to search for the object to remove.
+*
+* RETURN VALUES
+*	Pointer to the object which was removed.
+*
+*	NULL if there is no object with the key in the map.
+*
+* SEE ALSO
+*	Hash Map, cl_hmap_remove_all, cl_hmap_insert
+*********/
+
+
+/****f* Component Library: Hash Map/cl_hmap_remove_all
+* NAME
+*	cl_hmap_remove_all
+*
+* DESCRIPTION
+*	The cl_hmap_remove_all function removes all objects from a hash map,
+*	keeping its table for reuse.
+*
+* SYNOPSIS
+*/
+void
+cl_hmap_remove_all(
+	IN	cl_hmap_t* const		p_map );
+/*
+* PARAMETERS
+*	p_map
+*		[in] Pointer to a cl_hmap_t structure to empty.
+*
+* SEE ALSO
+*	Hash Map, cl_hmap_remove, cl_hmap_destroy
+*********/
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif	/* _IBA_PUBLIC_IHASHMAP_H_ */
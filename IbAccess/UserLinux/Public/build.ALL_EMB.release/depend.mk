@@ -0,0 +1,19 @@
+include Makefile
+include build.ALL_EMB.release/iarray.c.dep
+include build.ALL_EMB.release/ibitvector.c.dep
+include build.ALL_EMB.release/icmdthread.c.dep
+include build.ALL_EMB.release/idebugdump.c.dep
+include build.ALL_EMB.release/idebug_linux.c.dep
+include build.ALL_EMB.release/ievent.c.dep
+include build.ALL_EMB.release/ieventthread.c.dep
+include build.ALL_EMB.release/ilist.c.dep
+include build.ALL_EMB.release/imath.c.dep
+include build.ALL_EMB.release/imemory.c.dep
+include build.ALL_EMB.release/imemory_osd.c.dep
+include build.ALL_EMB.release/iobjmgr.c.dep
+include build.ALL_EMB.release/iquickmap.c.dep
+include build.ALL_EMB.release/isemaphore.c.dep
+include build.ALL_EMB.release/ispinlock.c.dep
+include build.ALL_EMB.release/ithread.c.dep
+include build.ALL_EMB.release/itimer.c.dep
+include build.ALL_EMB.release/statustext.c.dep
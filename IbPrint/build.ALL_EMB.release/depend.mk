@@ -0,0 +1,13 @@
+include Makefile
+include build.ALL_EMB.release/ibprint.c.dep
+include build.ALL_EMB.release/stl_mad.c.dep
+include build.ALL_EMB.release/stl_sma.c.dep
+include build.ALL_EMB.release/stl_sa.c.dep
+include build.ALL_EMB.release/stl_pm.c.dep
+include build.ALL_EMB.release/stl_pa.c.dep
+include build.ALL_EMB.release/types.c.dep
+include build.ALL_EMB.release/sma.c.dep
+include build.ALL_EMB.release/pm.c.dep
+include build.ALL_EMB.release/sa.c.dep
+include build.ALL_EMB.release/sd.c.dep
+include build.ALL_EMB.release/mad.c.dep
@@ -0,0 +1,120 @@
+/* BEGIN_ICS_COPYRIGHT7 ****************************************
+
+Copyright (c) 2015, Intel Corporation
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+    * Neither the name of Intel Corporation nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+** END_ICS_COPYRIGHT7   ****************************************/
+
+/* [ICS VERSION STRING: unknown] */
+
+/* convert fabric snapshots between the XML and binary formats */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <topology.h>
+
+void Usage(void)
+{
+	fprintf(stderr, "Usage: opasnapconvert [-b|-x] [-o output_file] [input_file]\n");
+	fprintf(stderr, "       -b - output a binary snapshot\n");
+	fprintf(stderr, "       -x - output an XML snapshot\n");
+	fprintf(stderr, "            default is the opposite format of input_file\n");
+	fprintf(stderr, "       -o output_file - file to write, default is stdout\n");
+	fprintf(stderr, "       input_file - XML or binary snapshot, default is XML from stdin\n");
+	exit(2);
+}
+
+int main(int argc, char **argv)
+{
+	FabricData_t fabric;
+	SnapshotOutputInfo_t info;
+	char *filename = "-";	// default to stdin
+	char *output = NULL;
+	FILE *file = stdout;
+	int output_format = 0;	// 'b' or 'x', 0 for opposite of input
+	int exit_code = 0;
+	int c;
+
+	Top_setcmdname("opasnapconvert");
+	while (-1 != (c = getopt(argc, argv, "bxo:"))) {
+		switch (c) {
+			case 'b':
+			case 'x':
+				if (output_format && output_format != c) {
+					fprintf(stderr, "opasnapconvert: Can't use -b and -x together\n");
+					Usage();
+				}
+				output_format = c;
+				break;
+			case 'o':
+				output = optarg;
+				break;
+			default:
+				Usage();
+				break;
+		}
+	}
+	if (argc > optind)
+		filename = argv[optind++];
+	if (argc > optind)
+		Usage();
+	if (! output_format)
+		output_format = (strcmp(filename, "-") != 0 && BinIsSnapshot(filename)) ? 'x' : 'b';
+
+	if (FSUCCESS != Xml2ParseSnapshot(filename, 1, &fabric, FF_NONE, FALSE))
+		exit(1);
+
+	if (output) {
+		file = fopen(output, "w");
+		if (! file) {
+			fprintf(stderr, "opasnapconvert: Unable to open %s: %s\n", output, strerror(errno));
+			DestroyFabricData(&fabric);
+			exit(1);
+		}
+	}
+	memset(&info, 0, sizeof(info));
+	info.fabricp = &fabric;
+	info.argc = argc;
+	info.argv = argv;
+	info.binary = (output_format == 'b');
+	if (info.binary) {
+		if (FSUCCESS != BinPrintSnapshot(file, &info))
+			exit_code = 1;
+	} else {
+		Xml2PrintSnapshot(file, &info);
+	}
+	if (fflush(file) != 0 || ferror(file)) {
+		fprintf(stderr, "opasnapconvert: Unable to write snapshot: %s\n", strerror(errno));
+		exit_code = 1;
+	}
+	if (output)
+		fclose(file);
+	DestroyFabricData(&fabric);
+	exit(exit_code);
+}
@@ -0,0 +1,4 @@
+include Makefile
+include build.ALL_EMB.release/Md5.c.dep
+include build.ALL_EMB.release/Md5_Deutsch.c.dep
+include build.ALL_EMB.release/Md5_Rivest.c.dep
@@ -0,0 +1,1223 @@
+/* BEGIN_ICS_COPYRIGHT7 ****************************************
+
+Copyright (c) 2015, Intel Corporation
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Intel Corporation nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+** END_ICS_COPYRIGHT7   ****************************************/
+
+/* [ICS VERSION STRING: unknown] */
+
+#include "topology.h"
+#include "topology_internal.h"
+#include <stl_helper.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+
+/* this file supports binary fabric snapshot generation and loading
+ *
+ * A binary snapshot holds the same data as the XML snapshot from
+ * Xml2PrintSnapshot.  The file is a header, a section table and one section
+ * per record type.  Records are fixed size and refer to each other by index
+ * within their section, so a snapshot is loaded by mapping the file and
+ * walking each section once, with the forwarding tables copied out in
+ * blocks.  Only the non-empty 64 entry blocks of LinearFDB and PortGroupFDB
+ * are stored and MulticastFDB rows after the last one in use are dropped.
+ *
+ * Records are in host byte order and record sizes are checked on load, so
+ * a snapshot must be read on a host of the same byte order and
+ * BINSNAP_VERSION must be bumped whenever a record changes.
+ */
+
+#define BINSNAP_MAGIC		0x4e534253	// "SBSN"
+#define BINSNAP_VERSION		1
+#define BINSNAP_BYTE_ORDER	0x01020304
+#define BINSNAP_NONE		0xffffffff	// no record for an optional index
+
+// FabricFlags_t saved in a snapshot, same as the XML Snapshot attributes
+#define BINSNAP_FLAGS	(FF_STATS|FF_ROUTES|FF_QOSDATA|FF_BUFCTRLTABLE|FF_DOWNPORTINFO)
+
+#if NUM_PGFT_ELEMENTS_BLOCK != MAX_LFT_ELEMENTS_BLOCK
+#error "BinSnapBlock_t assumes LFT and PGFT blocks are the same size"
+#endif
+
+typedef enum {
+	BINSNAP_SECT_STRINGS = 0,	// char, NUL terminated strings
+	BINSNAP_SECT_NODES,			// BinSnapNode_t
+	BINSNAP_SECT_PORTS,			// BinSnapPort_t, grouped by node
+	BINSNAP_SECT_SWITCHES,		// BinSnapSwitch_t
+	BINSNAP_SECT_BLOCKS,		// BinSnapBlock_t, LinearFDB and PortGroupFDB
+	BINSNAP_SECT_PORTMASKS,		// STL_PORTMASK, MulticastFDB and PortGroupElements
+	BINSNAP_SECT_QOS,			// BinSnapQos_t
+	BINSNAP_SECT_SCSC,			// STL_SCSCMAP, NumPorts+1 per switch port
+	BINSNAP_SECT_PKEYS,			// STL_PKEY_ELEMENT
+	BINSNAP_SECT_PORTSTATUS,	// STL_PortStatusData_t
+	BINSNAP_SECT_BUFCTRL,		// STL_BUFFER_CONTROL_TABLE
+	BINSNAP_SECT_CABLEINFO,		// STL_CABLE_INFO_PAGESZ bytes per port
+	BINSNAP_SECT_IOUS,			// BinSnapIou_t
+	BINSNAP_SECT_IOCS,			// BinSnapIoc_t
+	BINSNAP_SECT_SERVICES,		// IOC_SERVICE
+	BINSNAP_SECT_SMS,			// STL_SMINFO_RECORD
+	BINSNAP_SECT_MAX
+} BinSnapSectionType_t;
+
+typedef struct BinSnapHeader_s {
+	uint32	magic;			// BINSNAP_MAGIC
+	uint32	byteOrder;		// BINSNAP_BYTE_ORDER as written
+	uint16	version;		// BINSNAP_VERSION
+	uint16	numSections;	// entries in section table which follows
+	uint32	flags;			// FabricFlags_t, see BINSNAP_FLAGS
+	uint64	time;			// FabricData_t.time
+	uint32	options;		// string offset of program arguments
+	uint32	reserved;
+} BinSnapHeader_t;
+
+typedef struct BinSnapSection_s {
+	uint64	offset;			// from start of file, 8 byte aligned
+	uint32	recordSize;
+	uint32	count;
+} BinSnapSection_t;
+
+typedef struct BinSnapNode_s {
+	STL_NODE_INFO	NodeInfo;
+	uint32	nodeDesc;		// string offset
+	uint32	firstPort;		// ports of node are firstPort..firstPort+numPorts-1
+	uint32	numPorts;
+	uint32	switchIndex;	// BinSnapSwitch_t or BINSNAP_NONE
+	uint32	iouIndex;		// BinSnapIou_t or BINSNAP_NONE
+	uint32	reserved;
+} BinSnapNode_t;
+
+typedef struct BinSnapPort_s {
+	STL_PORT_INFO	PortInfo;
+	EUI64	PortGUID;
+	STL_LID_32	EndPortLID;
+	uint32	neighbor;		// port index or BINSNAP_NONE
+	uint32	qosIndex;		// BinSnapQos_t or BINSNAP_NONE
+	uint32	firstPKey;		// STL_PKEY_ELEMENT or BINSNAP_NONE
+	uint32	numPKeys;
+	uint32	portStatusIndex;
+	uint32	bufCtrlIndex;
+	uint32	cableInfoIndex;
+	uint8	PortNum;
+	uint8	from;
+	uint8	reserved[6];
+} BinSnapPort_t;
+
+typedef struct BinSnapQos_s {
+	STL_VLARB_TABLE	VLArbTable[4];
+	STL_SCVLMAP	SC2VLMaps[3];
+	STL_SLSCMAP	SL2SCMap;
+	STL_SCSLMAP	SC2SLMap;
+	uint32	firstSCSC;		// STL_SCSCMAP or BINSNAP_NONE
+	uint32	numSCSC;
+	uint8	hasSL2SC;
+	uint8	hasSC2SL;
+	uint8	reserved[6];
+} BinSnapQos_t;
+
+// SwitchData tables present in a BinSnapSwitch_t
+#define BINSNAP_SW_SWITCHINFO	0x01
+#define BINSNAP_SW_SWITCHDATA	0x02
+#define BINSNAP_SW_LFT			0x04
+#define BINSNAP_SW_PGFT			0x08
+#define BINSNAP_SW_MFT			0x10
+#define BINSNAP_SW_PGT			0x20
+
+typedef struct BinSnapSwitch_s {
+	STL_SWITCHINFO_RECORD	SwitchInfo;
+	uint32	LinearFDBSize;
+	uint32	MulticastFDBSize;
+	uint16	PortGroupSize;
+	uint8	MulticastFDBEntrySize;
+	uint8	tables;			// BINSNAP_SW_*
+	uint32	firstLftBlock;	// BinSnapBlock_t
+	uint32	numLftBlocks;
+	uint32	firstPgftBlock;
+	uint32	numPgftBlocks;
+	uint32	firstMft;		// STL_PORTMASK
+	uint32	numMft;			// rows stored * MulticastFDBEntrySize
+	uint32	firstPgt;		// STL_PORTMASK, PortGroupSize entries
+	uint32	reserved;
+} BinSnapSwitch_t;
+
+typedef struct BinSnapBlock_s {
+	uint32	block;			// block number within the table
+	PORT	entry[MAX_LFT_ELEMENTS_BLOCK];
+} BinSnapBlock_t;
+
+typedef struct BinSnapIou_s {
+	IOUnitInfo	IouInfo;
+	uint32	firstIoc;
+	uint32	numIocs;
+} BinSnapIou_t;
+
+typedef struct BinSnapIoc_s {
+	IOC_PROFILE	IocProfile;
+	uint32	firstService;	// IocProfile.ServiceEntries services
+	uint8	IocSlot;
+	uint8	reserved[3];
+} BinSnapIoc_t;
+
+static const uint32 BinSnapRecordSize[BINSNAP_SECT_MAX] = {
+	[BINSNAP_SECT_STRINGS] = sizeof(char),
+	[BINSNAP_SECT_NODES] = sizeof(BinSnapNode_t),
+	[BINSNAP_SECT_PORTS] = sizeof(BinSnapPort_t),
+	[BINSNAP_SECT_SWITCHES] = sizeof(BinSnapSwitch_t),
+	[BINSNAP_SECT_BLOCKS] = sizeof(BinSnapBlock_t),
+	[BINSNAP_SECT_PORTMASKS] = sizeof(STL_PORTMASK),
+	[BINSNAP_SECT_QOS] = sizeof(BinSnapQos_t),
+	[BINSNAP_SECT_SCSC] = sizeof(STL_SCSCMAP),
+	[BINSNAP_SECT_PKEYS] = sizeof(STL_PKEY_ELEMENT),
+	[BINSNAP_SECT_PORTSTATUS] = sizeof(STL_PortStatusData_t),
+	[BINSNAP_SECT_BUFCTRL] = sizeof(STL_BUFFER_CONTROL_TABLE),
+	[BINSNAP_SECT_CABLEINFO] = STL_CABLE_INFO_PAGESZ,
+	[BINSNAP_SECT_IOUS] = sizeof(BinSnapIou_t),
+	[BINSNAP_SECT_IOCS] = sizeof(BinSnapIoc_t),
+	[BINSNAP_SECT_SERVICES] = sizeof(IOC_SERVICE),
+	[BINSNAP_SECT_SMS] = sizeof(STL_SMINFO_RECORD),
+};
+
+// sizes of the SwitchData tables, as allocated by the XML snapshot parser
+static uint32 BinSnapLftSize(SwitchData *switchp)
+{
+	return switchp->LinearFDBSize;
+}
+
+static uint32 BinSnapPgftSize(SwitchData *switchp)
+{
+	return MIN(switchp->LinearFDBSize, DEFAULT_MAX_PGFT_LID+1);
+}
+
+static uint32 BinSnapMftRows(SwitchData *switchp)
+{
+	if (switchp->MulticastFDBSize <= LID_MCAST_START)
+		return 0;
+	return switchp->MulticastFDBSize - LID_MCAST_START;
+}
+
+/****************************************************************************/
+/* Binary snapshot output */
+
+// a section being built in memory
+typedef struct BinSnapBuf_s {
+	uint8	*data;
+	size_t	size;			// bytes used
+	size_t	alloc;			// bytes allocated
+	uint32	count;			// records
+} BinSnapBuf_t;
+
+// append count records of recordSize from rec, or cleared records if rec is
+// NULL.  Index of first record appended is returned in *index
+static FSTATUS BinSnapAppend(BinSnapBuf_t *buf, const void *rec, uint32 recordSize,
+				uint32 count, uint32 *index)
+{
+	size_t size = (size_t)recordSize * count;
+
+	if (buf->size + size > buf->alloc) {
+		size_t alloc = MAX(buf->alloc * 2, buf->size + size);
+		uint8 *data = (uint8 *)MemoryAllocate2AndClear(alloc, IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+
+		if (! data)
+			return FINSUFFICIENT_MEMORY;
+		if (buf->data) {
+			MemoryCopy(data, buf->data, buf->size);
+			MemoryDeallocate(buf->data);
+		}
+		buf->data = data;
+		buf->alloc = alloc;
+	}
+	if (rec)
+		MemoryCopy(buf->data + buf->size, rec, size);
+	else
+		MemoryClear(buf->data + buf->size, size);
+	if (index)
+		*index = buf->count;
+	buf->size += size;
+	buf->count += count;
+	return FSUCCESS;
+}
+
+static FSTATUS BinSnapAppendString(BinSnapBuf_t *buf, const char *str, size_t len, uint32 *offset)
+{
+	FSTATUS status;
+
+	status = BinSnapAppend(buf, str, sizeof(char), len, offset);
+	if (status == FSUCCESS)
+		status = BinSnapAppend(buf, NULL, sizeof(char), 1, NULL);
+	return status;
+}
+
+// append the non-empty blocks of a forwarding table of size entries
+static FSTATUS BinSnapAppendBlocks(BinSnapBuf_t *buf, const PORT *table, uint32 size,
+				uint32 *first, uint32 *count)
+{
+	BinSnapBlock_t block;
+	uint32 b, i;
+	FSTATUS status;
+
+	*first = buf->count;
+	*count = 0;
+	for (b = 0; b < ROUNDUP(size, MAX_LFT_ELEMENTS_BLOCK)/MAX_LFT_ELEMENTS_BLOCK; b++) {
+		const PORT *entry = &table[b * MAX_LFT_ELEMENTS_BLOCK];
+
+		for (i = 0; i < MAX_LFT_ELEMENTS_BLOCK; i++) {
+			if (entry[i] != 0xFF)
+				break;
+		}
+		if (i == MAX_LFT_ELEMENTS_BLOCK)
+			continue;
+		block.block = b;
+		MemoryCopy(block.entry, entry, sizeof(block.entry));
+		status = BinSnapAppend(buf, &block, sizeof(block), 1, NULL);
+		if (status != FSUCCESS)
+			return status;
+		(*count)++;
+	}
+	return FSUCCESS;
+}
+
+static FSTATUS BinSnapAppendSwitch(BinSnapBuf_t *sect, NodeData *nodep, uint32 *index)
+{
+	SwitchData *switchp = nodep->switchp;
+	BinSnapSwitch_t sw;
+	FSTATUS status;
+
+	MemoryClear(&sw, sizeof(sw));
+	sw.firstLftBlock = sw.firstPgftBlock = sw.firstMft = sw.firstPgt = BINSNAP_NONE;
+	if (nodep->pSwitchInfo) {
+		sw.SwitchInfo = *nodep->pSwitchInfo;
+		sw.tables |= BINSNAP_SW_SWITCHINFO;
+	}
+	if (switchp) {
+		sw.tables |= BINSNAP_SW_SWITCHDATA;
+		sw.LinearFDBSize = switchp->LinearFDBSize;
+		sw.MulticastFDBSize = switchp->MulticastFDBSize;
+		sw.MulticastFDBEntrySize = switchp->MulticastFDBEntrySize;
+		sw.PortGroupSize = switchp->PortGroupSize;
+		if (switchp->LinearFDB) {
+			sw.tables |= BINSNAP_SW_LFT;
+			status = BinSnapAppendBlocks(&sect[BINSNAP_SECT_BLOCKS],
+						(PORT *)switchp->LinearFDB, BinSnapLftSize(switchp),
+						&sw.firstLftBlock, &sw.numLftBlocks);
+			if (status != FSUCCESS)
+				return status;
+		}
+		if (switchp->PortGroupFDB) {
+			sw.tables |= BINSNAP_SW_PGFT;
+			status = BinSnapAppendBlocks(&sect[BINSNAP_SECT_BLOCKS],
+						(PORT *)switchp->PortGroupFDB, BinSnapPgftSize(switchp),
+						&sw.firstPgftBlock, &sw.numPgftBlocks);
+			if (status != FSUCCESS)
+				return status;
+		}
+		if (switchp->MulticastFDB && BinSnapMftRows(switchp)) {
+			uint32 rows = BinSnapMftRows(switchp);
+			uint32 entrySize = switchp->MulticastFDBEntrySize;
+
+			// trailing rows with no ports are left out
+			while (rows) {
+				uint32 j;
+				for (j = 0; j < entrySize; j++) {
+					if (switchp->MulticastFDB[(rows-1)*entrySize + j])
+						break;
+				}
+				if (j < entrySize)
+					break;
+				rows--;
+			}
+			sw.tables |= BINSNAP_SW_MFT;
+			sw.numMft = rows * entrySize;
+			status = BinSnapAppend(&sect[BINSNAP_SECT_PORTMASKS], switchp->MulticastFDB,
+						sizeof(STL_PORTMASK), sw.numMft, &sw.firstMft);
+			if (status != FSUCCESS)
+				return status;
+		}
+		if (switchp->PortGroupElements) {
+			sw.tables |= BINSNAP_SW_PGT;
+			status = BinSnapAppend(&sect[BINSNAP_SECT_PORTMASKS], switchp->PortGroupElements,
+						sizeof(STL_PORTMASK), switchp->PortGroupSize, &sw.firstPgt);
+			if (status != FSUCCESS)
+				return status;
+		}
+	}
+	return BinSnapAppend(&sect[BINSNAP_SECT_SWITCHES], &sw, sizeof(sw), 1, index);
+}
+
+static FSTATUS BinSnapAppendPort(BinSnapBuf_t *sect, cl_hmap_t *portIndex, PortData *portp)
+{
+	BinSnapPort_t port;
+	FSTATUS status;
+
+	MemoryClear(&port, sizeof(port));
+	port.PortInfo = portp->PortInfo;
+	port.PortGUID = portp->PortGUID;
+	port.EndPortLID = portp->EndPortLID;
+	port.PortNum = portp->PortNum;
+	port.from = portp->from;
+	port.neighbor = BINSNAP_NONE;
+	if (portp->neighbor) {
+		void *index = cl_hmap_get(portIndex, (uint64)(uintptr_t)portp->neighbor);
+		if (index)
+			port.neighbor = (uint32)((uintptr_t)index - 1);
+	}
+
+	port.qosIndex = BINSNAP_NONE;
+	if (portp->pQOS) {
+		QOSData *pQOS = portp->pQOS;
+		BinSnapQos_t qos;
+
+		MemoryClear(&qos, sizeof(qos));
+		MemoryCopy(qos.VLArbTable, pQOS->VLArbTable, sizeof(qos.VLArbTable));
+		MemoryCopy(qos.SC2VLMaps, pQOS->SC2VLMaps, sizeof(qos.SC2VLMaps));
+		if (pQOS->SL2SCMap) {
+			qos.SL2SCMap = *pQOS->SL2SCMap;
+			qos.hasSL2SC = 1;
+		}
+		if (pQOS->SC2SLMap) {
+			qos.SC2SLMap = *pQOS->SC2SLMap;
+			qos.hasSC2SL = 1;
+		}
+		qos.firstSCSC = BINSNAP_NONE;
+		if (pQOS->SC2SCMap) {
+			qos.numSCSC = portp->nodep->NodeInfo.NumPorts + 1;
+			status = BinSnapAppend(&sect[BINSNAP_SECT_SCSC], pQOS->SC2SCMap,
+						sizeof(STL_SCSCMAP), qos.numSCSC, &qos.firstSCSC);
+			if (status != FSUCCESS)
+				return status;
+		}
+		status = BinSnapAppend(&sect[BINSNAP_SECT_QOS], &qos, sizeof(qos), 1, &port.qosIndex);
+		if (status != FSUCCESS)
+			return status;
+	}
+
+	port.firstPKey = BINSNAP_NONE;
+	if (portp->pPartitionTable) {
+		port.numPKeys = PortPartitionTableSize(portp);
+		status = BinSnapAppend(&sect[BINSNAP_SECT_PKEYS], portp->pPartitionTable,
+					sizeof(STL_PKEY_ELEMENT), port.numPKeys, &port.firstPKey);
+		if (status != FSUCCESS)
+			return status;
+	}
+
+	port.portStatusIndex = BINSNAP_NONE;
+	if (portp->pPortStatus) {
+		status = BinSnapAppend(&sect[BINSNAP_SECT_PORTSTATUS], portp->pPortStatus,
+					sizeof(STL_PortStatusData_t), 1, &port.portStatusIndex);
+		if (status != FSUCCESS)
+			return status;
+	}
+
+	port.bufCtrlIndex = BINSNAP_NONE;
+	if (portp->pBufCtrlTable) {
+		status = BinSnapAppend(&sect[BINSNAP_SECT_BUFCTRL], portp->pBufCtrlTable,
+					sizeof(STL_BUFFER_CONTROL_TABLE), 1, &port.bufCtrlIndex);
+		if (status != FSUCCESS)
+			return status;
+	}
+
+	port.cableInfoIndex = BINSNAP_NONE;
+	if (portp->pCableInfoData) {
+		status = BinSnapAppend(&sect[BINSNAP_SECT_CABLEINFO], portp->pCableInfoData,
+					STL_CABLE_INFO_PAGESZ, 1, &port.cableInfoIndex);
+		if (status != FSUCCESS)
+			return status;
+	}
+
+	return BinSnapAppend(&sect[BINSNAP_SECT_PORTS], &port, sizeof(port), 1, NULL);
+}
+
+#if !defined(VXWORKS) || defined(BUILD_DMC)
+static FSTATUS BinSnapAppendIou(BinSnapBuf_t *sect, IouData *ioup, uint32 *index)
+{
+	BinSnapIou_t iou;
+	LIST_ITEM *p;
+	FSTATUS status;
+
+	MemoryClear(&iou, sizeof(iou));
+	iou.IouInfo = ioup->IouInfo;
+	iou.firstIoc = sect[BINSNAP_SECT_IOCS].count;
+	for (p=QListHead(&ioup->Iocs); p != NULL; p = QListNext(&ioup->Iocs, p)) {
+		IocData *iocp = (IocData *)QListObj(p);
+		BinSnapIoc_t ioc;
+
+		MemoryClear(&ioc, sizeof(ioc));
+		ioc.IocProfile = iocp->IocProfile;
+		ioc.IocSlot = iocp->IocSlot;
+		ioc.firstService = sect[BINSNAP_SECT_SERVICES].count;
+		if (! iocp->Services)
+			ioc.IocProfile.ServiceEntries = 0;
+		status = BinSnapAppend(&sect[BINSNAP_SECT_SERVICES], iocp->Services,
+					sizeof(IOC_SERVICE), ioc.IocProfile.ServiceEntries, NULL);
+		if (status != FSUCCESS)
+			return status;
+		status = BinSnapAppend(&sect[BINSNAP_SECT_IOCS], &ioc, sizeof(ioc), 1, NULL);
+		if (status != FSUCCESS)
+			return status;
+		iou.numIocs++;
+	}
+	return BinSnapAppend(&sect[BINSNAP_SECT_IOUS], &iou, sizeof(iou), 1, index);
+}
+#endif
+
+static FSTATUS BinSnapBuild(SnapshotOutputInfo_t *info, BinSnapBuf_t *sect, uint32 *options)
+{
+	FabricData_t *fabricp = info->fabricp;
+	cl_hmap_t portIndex;
+	cl_map_item_t *p;
+	uint32 numPorts = 0;
+	FSTATUS status = FSUCCESS;
+	int i;
+
+	// string offset 0 is the empty string
+	status = BinSnapAppendString(&sect[BINSNAP_SECT_STRINGS], "", 0, NULL);
+	if (status != FSUCCESS)
+		return status;
+	*options = sect[BINSNAP_SECT_STRINGS].count;
+	for (i=1; i<info->argc; i++) {
+		if (i > 1)
+			status = BinSnapAppend(&sect[BINSNAP_SECT_STRINGS], " ", sizeof(char), 1, NULL);
+		if (status == FSUCCESS)
+			status = BinSnapAppend(&sect[BINSNAP_SECT_STRINGS], info->argv[i],
+						sizeof(char), strlen(info->argv[i]), NULL);
+		if (status != FSUCCESS)
+			return status;
+	}
+	status = BinSnapAppend(&sect[BINSNAP_SECT_STRINGS], NULL, sizeof(char), 1, NULL);
+	if (status != FSUCCESS)
+		return status;
+
+	// ports are numbered in the order they are output, so links can refer
+	// to a neighbor which follows
+	cl_hmap_init(&portIndex, NULL, NULL, NULL);
+	for (p=cl_qmap_head(&fabricp->AllNodes); p != cl_qmap_end(&fabricp->AllNodes); p = cl_qmap_next(p)) {
+		NodeData *nodep = PARENT_STRUCT(p, NodeData, AllNodesEntry);
+		cl_map_item_t *q;
+
+		for (q=cl_qmap_head(&nodep->Ports); q != cl_qmap_end(&nodep->Ports); q = cl_qmap_next(q)) {
+			PortData *portp = PARENT_STRUCT(q, PortData, NodePortsEntry);
+
+			status = cl_hmap_insert(&portIndex, (uint64)(uintptr_t)portp,
+								(void *)(uintptr_t)(++numPorts));
+			if (status != FSUCCESS)
+				goto done;
+		}
+	}
+
+	for (p=cl_qmap_head(&fabricp->AllNodes); p != cl_qmap_end(&fabricp->AllNodes); p = cl_qmap_next(p)) {
+		NodeData *nodep = PARENT_STRUCT(p, NodeData, AllNodesEntry);
+		cl_map_item_t *q;
+		BinSnapNode_t node;
+
+		MemoryClear(&node, sizeof(node));
+		node.NodeInfo = nodep->NodeInfo;
+		status = BinSnapAppendString(&sect[BINSNAP_SECT_STRINGS],
+					(char *)nodep->NodeDesc.NodeString,
+					strnlen((char *)nodep->NodeDesc.NodeString, STL_NODE_DESCRIPTION_ARRAY_SIZE),
+					&node.nodeDesc);
+		if (status != FSUCCESS)
+			goto done;
+
+		node.switchIndex = BINSNAP_NONE;
+		if (nodep->pSwitchInfo || nodep->switchp) {
+			status = BinSnapAppendSwitch(sect, nodep, &node.switchIndex);
+			if (status != FSUCCESS)
+				goto done;
+		}
+		node.iouIndex = BINSNAP_NONE;
+#if !defined(VXWORKS) || defined(BUILD_DMC)
+		if (nodep->ioup) {
+			status = BinSnapAppendIou(sect, nodep->ioup, &node.iouIndex);
+			if (status != FSUCCESS)
+				goto done;
+		}
+#endif
+
+		node.firstPort = sect[BINSNAP_SECT_PORTS].count;
+		for (q=cl_qmap_head(&nodep->Ports); q != cl_qmap_end(&nodep->Ports); q = cl_qmap_next(q)) {
+			status = BinSnapAppendPort(sect, &portIndex, PARENT_STRUCT(q, PortData, NodePortsEntry));
+			if (status != FSUCCESS)
+				goto done;
+			node.numPorts++;
+		}
+		status = BinSnapAppend(&sect[BINSNAP_SECT_NODES], &node, sizeof(node), 1, NULL);
+		if (status != FSUCCESS)
+			goto done;
+	}
+
+	for (p=cl_qmap_head(&fabricp->AllSMs); p != cl_qmap_end(&fabricp->AllSMs); p = cl_qmap_next(p)) {
+		SMData *smp = PARENT_STRUCT(p, SMData, AllSMsEntry);
+
+		status = BinSnapAppend(&sect[BINSNAP_SECT_SMS], &smp->SMInfoRecord,
+					sizeof(STL_SMINFO_RECORD), 1, NULL);
+		if (status != FSUCCESS)
+			goto done;
+	}
+
+done:
+	cl_hmap_destroy(&portIndex);
+	return status;
+}
+
+static FSTATUS BinSnapWrite(FILE *file, const void *data, size_t size)
+{
+	if (size && fwrite(data, size, 1, file) != 1)
+		return FERROR;
+	return FSUCCESS;
+}
+
+FSTATUS BinPrintSnapshot(FILE *file, SnapshotOutputInfo_t *info)
+{
+	static const uint8 pad[8];
+	BinSnapBuf_t sect[BINSNAP_SECT_MAX];
+	BinSnapSection_t table[BINSNAP_SECT_MAX];
+	BinSnapHeader_t header;
+	uint64 offset;
+	FSTATUS status;
+	int i;
+
+	MemoryClear(sect, sizeof(sect));
+	MemoryClear(&header, sizeof(header));
+	status = BinSnapBuild(info, sect, &header.options);
+	if (status != FSUCCESS) {
+		fprintf(stderr, "%s: Unable to build binary snapshot: %s\n",
+				g_Top_cmdname, iba_fstatus_msg(status));
+		goto done;
+	}
+
+	header.magic = BINSNAP_MAGIC;
+	header.byteOrder = BINSNAP_BYTE_ORDER;
+	header.version = BINSNAP_VERSION;
+	header.numSections = BINSNAP_SECT_MAX;
+	header.flags = info->fabricp->flags & BINSNAP_FLAGS;
+	header.time = (uint64)info->fabricp->time;
+
+	offset = ROUNDUP(sizeof(header) + sizeof(table), 8);
+	for (i = 0; i < BINSNAP_SECT_MAX; i++) {
+		table[i].offset = offset;
+		table[i].recordSize = BinSnapRecordSize[i];
+		table[i].count = sect[i].count;
+		offset += ROUNDUP(sect[i].size, 8);
+	}
+
+	status = BinSnapWrite(file, &header, sizeof(header));
+	if (status == FSUCCESS)
+		status = BinSnapWrite(file, table, sizeof(table));
+	if (status == FSUCCESS)
+		status = BinSnapWrite(file, pad, ROUNDUP(sizeof(header) + sizeof(table), 8)
+						- (sizeof(header) + sizeof(table)));
+	for (i = 0; i < BINSNAP_SECT_MAX && status == FSUCCESS; i++) {
+		status = BinSnapWrite(file, sect[i].data, sect[i].size);
+		if (status == FSUCCESS)
+			status = BinSnapWrite(file, pad, ROUNDUP(sect[i].size, 8) - sect[i].size);
+	}
+	if (status != FSUCCESS)
+		fprintf(stderr, "%s: Unable to write binary snapshot: %s\n",
+				g_Top_cmdname, strerror(errno));
+
+done:
+	for (i = 0; i < BINSNAP_SECT_MAX; i++) {
+		if (sect[i].data)
+			MemoryDeallocate(sect[i].data);
+	}
+	return status;
+}
+
+/****************************************************************************/
+/* Binary snapshot input */
+
+typedef struct BinSnapMap_s {
+	const uint8	*base;
+	size_t	size;
+	const BinSnapHeader_t *header;
+	const BinSnapSection_t *table;
+} BinSnapMap_t;
+
+// records of a section, NULL if the section is empty
+static const void *BinSnapRecords(const BinSnapMap_t *map, BinSnapSectionType_t type, uint32 *count)
+{
+	const BinSnapSection_t *sect = &map->table[type];
+
+	*count = sect->count;
+	return sect->count ? map->base + sect->offset : NULL;
+}
+
+// TRUE if first..first+count-1 are valid records in the section
+static boolean BinSnapValidRange(const BinSnapMap_t *map, BinSnapSectionType_t type,
+				uint32 first, uint32 count)
+{
+	if (! count)
+		return TRUE;
+	return first < map->table[type].count && count <= map->table[type].count - first;
+}
+
+static FSTATUS BinSnapValidate(const char *input_file, BinSnapMap_t *map)
+{
+	int i;
+
+	if (map->size < sizeof(BinSnapHeader_t))
+		goto invalid;
+	map->header = (const BinSnapHeader_t *)map->base;
+	if (map->header->magic != BINSNAP_MAGIC)
+		goto invalid;
+	if (map->header->byteOrder != BINSNAP_BYTE_ORDER) {
+		fprintf(stderr, "%s: %s: Binary snapshot is from a host of different byte order\n",
+				g_Top_cmdname, input_file);
+		return FERROR;
+	}
+	if (map->header->version != BINSNAP_VERSION
+		|| map->header->numSections != BINSNAP_SECT_MAX) {
+		fprintf(stderr, "%s: %s: Unsupported binary snapshot version %u\n",
+				g_Top_cmdname, input_file, map->header->version);
+		return FERROR;
+	}
+	if (map->size < sizeof(BinSnapHeader_t) + sizeof(BinSnapSection_t) * BINSNAP_SECT_MAX)
+		goto invalid;
+	map->table = (const BinSnapSection_t *)(map->header + 1);
+	for (i = 0; i < BINSNAP_SECT_MAX; i++) {
+		const BinSnapSection_t *sect = &map->table[i];
+
+		if (sect->recordSize != BinSnapRecordSize[i]
+			|| (sect->offset & 7)
+			|| sect->offset > map->size
+			|| (uint64)sect->recordSize * sect->count > map->size - sect->offset)
+			goto invalid;
+	}
+	return FSUCCESS;
+
+invalid:
+	fprintf(stderr, "%s: %s: Invalid or truncated binary snapshot\n",
+			g_Top_cmdname, input_file);
+	return FERROR;
+}
+
+// copy stored blocks into a forwarding table of size entries
+static FSTATUS BinSnapLoadBlocks(const BinSnapMap_t *map, PORT **tablep, uint32 size,
+				uint32 first, uint32 count)
+{
+	const BinSnapBlock_t *blocks;
+	uint32 numBlocks, i, alloc;
+	PORT *table;
+
+	if (! BinSnapValidRange(map, BINSNAP_SECT_BLOCKS, first, count))
+		return FERROR;
+	alloc = ROUNDUP(size, MAX_LFT_ELEMENTS_BLOCK);
+	table = (PORT *)MemoryAllocate2AndClear(alloc, IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+	if (! table)
+		return FINSUFFICIENT_MEMORY;
+	memset(table, 0xFF, alloc);
+	blocks = (const BinSnapBlock_t *)BinSnapRecords(map, BINSNAP_SECT_BLOCKS, &numBlocks);
+	for (i = first; i < first + count; i++) {
+		if (blocks[i].block >= alloc/MAX_LFT_ELEMENTS_BLOCK) {
+			MemoryDeallocate(table);
+			return FERROR;
+		}
+		MemoryCopy(&table[blocks[i].block * MAX_LFT_ELEMENTS_BLOCK], blocks[i].entry,
+					MAX_LFT_ELEMENTS_BLOCK);
+	}
+	*tablep = table;
+	return FSUCCESS;
+}
+
+static FSTATUS BinSnapLoadSwitch(const BinSnapMap_t *map, NodeData *nodep, uint32 index)
+{
+	const BinSnapSwitch_t *sw;
+	const STL_PORTMASK *masks;
+	SwitchData *switchp;
+	uint32 count;
+	FSTATUS status;
+
+	sw = (const BinSnapSwitch_t *)BinSnapRecords(map, BINSNAP_SECT_SWITCHES, &count);
+	if (index >= count)
+		return FERROR;
+	sw = &sw[index];
+	masks = (const STL_PORTMASK *)BinSnapRecords(map, BINSNAP_SECT_PORTMASKS, &count);
+
+	if (sw->tables & BINSNAP_SW_SWITCHINFO) {
+		nodep->pSwitchInfo = (STL_SWITCHINFO_RECORD *)MemoryAllocate2AndClear(
+					sizeof(STL_SWITCHINFO_RECORD), IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		if (! nodep->pSwitchInfo)
+			return FINSUFFICIENT_MEMORY;
+		*nodep->pSwitchInfo = sw->SwitchInfo;
+	}
+	if (! (sw->tables & BINSNAP_SW_SWITCHDATA))
+		return FSUCCESS;
+
+	switchp = nodep->switchp = (SwitchData *)MemoryAllocate2AndClear(sizeof(SwitchData),
+					IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+	if (! switchp)
+		return FINSUFFICIENT_MEMORY;
+	switchp->LinearFDBSize = sw->LinearFDBSize;
+	switchp->MulticastFDBSize = sw->MulticastFDBSize;
+	switchp->MulticastFDBEntrySize = sw->MulticastFDBEntrySize;
+	switchp->PortGroupSize = sw->PortGroupSize;
+
+	if (sw->tables & BINSNAP_SW_LFT) {
+		status = BinSnapLoadBlocks(map, (PORT **)&switchp->LinearFDB, BinSnapLftSize(switchp),
+					sw->firstLftBlock, sw->numLftBlocks);
+		if (status != FSUCCESS)
+			return status;
+	}
+	if (sw->tables & BINSNAP_SW_PGFT) {
+		status = BinSnapLoadBlocks(map, (PORT **)&switchp->PortGroupFDB, BinSnapPgftSize(switchp),
+					sw->firstPgftBlock, sw->numPgftBlocks);
+		if (status != FSUCCESS)
+			return status;
+	}
+	if ((sw->tables & BINSNAP_SW_MFT) && BinSnapMftRows(switchp)) {
+		size_t entries = (size_t)BinSnapMftRows(switchp) * switchp->MulticastFDBEntrySize;
+
+		if (sw->numMft > entries || ! BinSnapValidRange(map, BINSNAP_SECT_PORTMASKS, sw->firstMft, sw->numMft))
+			return FERROR;
+		switchp->MulticastFDB = (STL_PORTMASK *)MemoryAllocate2AndClear(
+					entries * sizeof(STL_PORTMASK), IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		if (! switchp->MulticastFDB)
+			return FINSUFFICIENT_MEMORY;
+		if (sw->numMft)
+			MemoryCopy(switchp->MulticastFDB, &masks[sw->firstMft], sw->numMft * sizeof(STL_PORTMASK));
+	}
+	if (sw->tables & BINSNAP_SW_PGT) {
+		if (! BinSnapValidRange(map, BINSNAP_SECT_PORTMASKS, sw->firstPgt, switchp->PortGroupSize))
+			return FERROR;
+		switchp->PortGroupElements = (STL_PORTMASK *)MemoryAllocate2AndClear(
+					switchp->PortGroupSize * sizeof(STL_PORTMASK), IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		if (! switchp->PortGroupElements)
+			return FINSUFFICIENT_MEMORY;
+		if (switchp->PortGroupSize)
+			MemoryCopy(switchp->PortGroupElements, &masks[sw->firstPgt],
+						switchp->PortGroupSize * sizeof(STL_PORTMASK));
+	}
+	return FSUCCESS;
+}
+
+#if !defined(VXWORKS) || defined(BUILD_DMC)
+static FSTATUS BinSnapLoadIou(const BinSnapMap_t *map, FabricData_t *fabricp, NodeData *nodep, uint32 index)
+{
+	const BinSnapIou_t *iou;
+	const BinSnapIoc_t *ioc;
+	const IOC_SERVICE *services;
+	IouData *ioup;
+	uint32 count, i;
+
+	iou = (const BinSnapIou_t *)BinSnapRecords(map, BINSNAP_SECT_IOUS, &count);
+	if (index >= count)
+		return FERROR;
+	iou = &iou[index];
+	if (! BinSnapValidRange(map, BINSNAP_SECT_IOCS, iou->firstIoc, iou->numIocs))
+		return FERROR;
+	ioc = (const BinSnapIoc_t *)BinSnapRecords(map, BINSNAP_SECT_IOCS, &count);
+	services = (const IOC_SERVICE *)BinSnapRecords(map, BINSNAP_SECT_SERVICES, &count);
+
+	ioup = (IouData *)MemoryAllocate2AndClear(sizeof(IouData), IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+	if (! ioup)
+		return FINSUFFICIENT_MEMORY;
+	ListItemInitState(&ioup->AllIOUsEntry);
+	QListSetObj(&ioup->AllIOUsEntry, ioup);
+	ioup->nodep = nodep;
+	QListInitState(&ioup->Iocs);
+	if (! QListInit(&ioup->Iocs)) {
+		MemoryDeallocate(ioup);
+		return FINSUFFICIENT_MEMORY;
+	}
+	ioup->IouInfo = iou->IouInfo;
+	nodep->ioup = ioup;
+
+	for (i = iou->firstIoc; i < iou->firstIoc + iou->numIocs; i++) {
+		IocData *iocp;
+
+		if (! BinSnapValidRange(map, BINSNAP_SECT_SERVICES, ioc[i].firstService,
+								ioc[i].IocProfile.ServiceEntries))
+			return FERROR;
+		iocp = (IocData *)MemoryAllocate2AndClear(sizeof(IocData), IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		if (! iocp)
+			return FINSUFFICIENT_MEMORY;
+		iocp->ioup = ioup;
+		ListItemInitState(&iocp->IouIocsEntry);
+		QListSetObj(&iocp->IouIocsEntry, iocp);
+		iocp->IocProfile = ioc[i].IocProfile;
+		iocp->IocSlot = ioc[i].IocSlot;
+		if (cl_qmap_insert(&fabricp->AllIOCs, iocp->IocProfile.IocGUID, &iocp->AllIOCsEntry) != &iocp->AllIOCsEntry) {
+			fprintf(stderr, "%s: Duplicate IOC Guids found: 0x%016"PRIx64"\n",
+					g_Top_cmdname, iocp->IocProfile.IocGUID);
+			MemoryDeallocate(iocp);
+			return FERROR;
+		}
+		QListInsertTail(&ioup->Iocs, &iocp->IouIocsEntry);
+		if (iocp->IocProfile.ServiceEntries) {
+			iocp->Services = (IOC_SERVICE *)MemoryAllocate2AndClear(
+						sizeof(IOC_SERVICE)*iocp->IocProfile.ServiceEntries, IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+			if (! iocp->Services)
+				return FINSUFFICIENT_MEMORY;
+			MemoryCopy(iocp->Services, &services[ioc[i].firstService],
+						sizeof(IOC_SERVICE)*iocp->IocProfile.ServiceEntries);
+		}
+	}
+	return FSUCCESS;
+}
+#endif
+
+static FSTATUS BinSnapLoadPortTables(const BinSnapMap_t *map, FabricData_t *fabricp,
+				PortData *portp, const BinSnapPort_t *port)
+{
+	uint32 count;
+
+	if (port->qosIndex != BINSNAP_NONE) {
+		const BinSnapQos_t *qos = (const BinSnapQos_t *)BinSnapRecords(map, BINSNAP_SECT_QOS, &count);
+		QOSData *pQOS;
+
+		if (port->qosIndex >= count)
+			return FERROR;
+		qos = &qos[port->qosIndex];
+		pQOS = portp->pQOS = (QOSData *)MemoryAllocate2AndClear(sizeof(QOSData),
+					IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		if (! pQOS)
+			return FINSUFFICIENT_MEMORY;
+		MemoryCopy(pQOS->VLArbTable, qos->VLArbTable, sizeof(pQOS->VLArbTable));
+		MemoryCopy(pQOS->SC2VLMaps, qos->SC2VLMaps, sizeof(pQOS->SC2VLMaps));
+		if (qos->hasSL2SC) {
+			pQOS->SL2SCMap = (STL_SLSCMAP *)MemoryAllocate2AndClear(sizeof(STL_SLSCMAP),
+						IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+			if (! pQOS->SL2SCMap)
+				return FINSUFFICIENT_MEMORY;
+			*pQOS->SL2SCMap = qos->SL2SCMap;
+		}
+		if (qos->hasSC2SL) {
+			pQOS->SC2SLMap = (STL_SCSLMAP *)MemoryAllocate2AndClear(sizeof(STL_SCSLMAP),
+						IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+			if (! pQOS->SC2SLMap)
+				return FINSUFFICIENT_MEMORY;
+			*pQOS->SC2SLMap = qos->SC2SLMap;
+		}
+		if (qos->firstSCSC != BINSNAP_NONE) {
+			const STL_SCSCMAP *scsc = (const STL_SCSCMAP *)BinSnapRecords(map, BINSNAP_SECT_SCSC, &count);
+			uint32 numPorts = portp->nodep->NodeInfo.NumPorts + 1;
+
+			if (qos->numSCSC > numPorts
+				|| ! BinSnapValidRange(map, BINSNAP_SECT_SCSC, qos->firstSCSC, qos->numSCSC))
+				return FERROR;
+			pQOS->SC2SCMap = (STL_SCSCMAP *)MemoryAllocate2AndClear(sizeof(STL_SCSCMAP) * numPorts,
+						IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+			if (! pQOS->SC2SCMap)
+				return FINSUFFICIENT_MEMORY;
+			if (qos->numSCSC)
+				MemoryCopy(pQOS->SC2SCMap, &scsc[qos->firstSCSC], sizeof(STL_SCSCMAP) * qos->numSCSC);
+		}
+	}
+
+	if (port->firstPKey != BINSNAP_NONE) {
+		const STL_PKEY_ELEMENT *pkeys = (const STL_PKEY_ELEMENT *)BinSnapRecords(map, BINSNAP_SECT_PKEYS, &count);
+		uint16 size = PortPartitionTableSize(portp);
+
+		if (port->numPKeys > size
+			|| ! BinSnapValidRange(map, BINSNAP_SECT_PKEYS, port->firstPKey, port->numPKeys))
+			return FERROR;
+		if (FSUCCESS != PortDataAllocatePartitionTable(fabricp, portp))
+			return FINSUFFICIENT_MEMORY;
+		if (port->numPKeys)
+			MemoryCopy(portp->pPartitionTable, &pkeys[port->firstPKey],
+						sizeof(STL_PKEY_ELEMENT) * port->numPKeys);
+	}
+
+	if (port->portStatusIndex != BINSNAP_NONE) {
+		const STL_PortStatusData_t *status = (const STL_PortStatusData_t *)BinSnapRecords(map, BINSNAP_SECT_PORTSTATUS, &count);
+
+		if (port->portStatusIndex >= count)
+			return FERROR;
+		portp->pPortStatus = (STL_PortStatusData_t *)MemoryAllocate2AndClear(
+					sizeof(STL_PortStatusData_t), IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		if (! portp->pPortStatus)
+			return FINSUFFICIENT_MEMORY;
+		*portp->pPortStatus = status[port->portStatusIndex];
+	}
+
+	if (port->bufCtrlIndex != BINSNAP_NONE) {
+		const STL_BUFFER_CONTROL_TABLE *bct = (const STL_BUFFER_CONTROL_TABLE *)BinSnapRecords(map, BINSNAP_SECT_BUFCTRL, &count);
+
+		if (port->bufCtrlIndex >= count)
+			return FERROR;
+		if (FSUCCESS != PortDataAllocateBufCtrlTable(fabricp, portp))
+			return FINSUFFICIENT_MEMORY;
+		*portp->pBufCtrlTable = bct[port->bufCtrlIndex];
+	}
+
+	if (port->cableInfoIndex != BINSNAP_NONE) {
+		const uint8 *cableInfo = (const uint8 *)BinSnapRecords(map, BINSNAP_SECT_CABLEINFO, &count);
+
+		if (port->cableInfoIndex >= count)
+			return FERROR;
+		if (FSUCCESS != PortDataAllocateCableInfoData(fabricp, portp))
+			return FINSUFFICIENT_MEMORY;
+		MemoryCopy(portp->pCableInfoData, &cableInfo[port->cableInfoIndex * STL_CABLE_INFO_PAGESZ],
+					STL_CABLE_INFO_PAGESZ);
+	}
+	return FSUCCESS;
+}
+
+static FSTATUS BinSnapLoadNode(const BinSnapMap_t *map, FabricData_t *fabricp,
+				const BinSnapNode_t *node, PortData **ports)
+{
+	const BinSnapPort_t *port;
+	const char *strings;
+	uint32 numStrings, count, i;
+	NodeData *nodep;
+	FSTATUS status;
+
+	strings = (const char *)BinSnapRecords(map, BINSNAP_SECT_STRINGS, &numStrings);
+	if (node->nodeDesc >= numStrings
+		|| ! BinSnapValidRange(map, BINSNAP_SECT_PORTS, node->firstPort, node->numPorts))
+		return FERROR;
+
+	nodep = (NodeData*)MemoryAllocate2AndClear(sizeof(NodeData), IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+	if (! nodep)
+		return FINSUFFICIENT_MEMORY;
+	cl_qmap_init(&nodep->Ports, NULL);
+	ListItemInitState(&nodep->AllTypesEntry);
+	QListSetObj(&nodep->AllTypesEntry, nodep);
+	nodep->NodeInfo = node->NodeInfo;
+	// string table is NUL terminated, see BinSnapValidate, but strings are
+	// stored unpadded so copy no further than the NUL
+	memcpy(nodep->NodeDesc.NodeString, &strings[node->nodeDesc],
+				strnlen(&strings[node->nodeDesc], STL_NODE_DESCRIPTION_ARRAY_SIZE));
+
+	// once the node is in AllNodes and its system, NodeDataFreeAll will
+	// clean up whatever else is attached to it
+	if (cl_qmap_insert(&fabricp->AllNodes, nodep->NodeInfo.NodeGUID, &nodep->AllNodesEntry) != &nodep->AllNodesEntry) {
+		fprintf(stderr, "%s: Duplicate NodeGuid: 0x%"PRIx64"\n", g_Top_cmdname, nodep->NodeInfo.NodeGUID);
+		MemoryDeallocate(nodep);
+		return FERROR;
+	}
+	if (FSUCCESS != cl_hmap_insert(&fabricp->AllNodeGuids, nodep->NodeInfo.NodeGUID, nodep)) {
+		cl_qmap_remove_item(&fabricp->AllNodes, &nodep->AllNodesEntry);
+		MemoryDeallocate(nodep);
+		return FINSUFFICIENT_MEMORY;
+	}
+	if (FSUCCESS != AddSystemNode(fabricp, nodep)) {
+		(void)cl_hmap_remove(&fabricp->AllNodeGuids, nodep->NodeInfo.NodeGUID);
+		cl_qmap_remove_item(&fabricp->AllNodes, &nodep->AllNodesEntry);
+		MemoryDeallocate(nodep);
+		return FERROR;
+	}
+
+	if (node->switchIndex != BINSNAP_NONE) {
+		status = BinSnapLoadSwitch(map, nodep, node->switchIndex);
+		if (status != FSUCCESS)
+			return status;
+	}
+#if !defined(VXWORKS) || defined(BUILD_DMC)
+	if (node->iouIndex != BINSNAP_NONE) {
+		status = BinSnapLoadIou(map, fabricp, nodep, node->iouIndex);
+		if (status != FSUCCESS)
+			return status;
+	}
+#endif
+
+	port = (const BinSnapPort_t *)BinSnapRecords(map, BINSNAP_SECT_PORTS, &count);
+	for (i = node->firstPort; i < node->firstPort + node->numPorts; i++) {
+		PortData *portp = (PortData*)MemoryAllocate2AndClear(sizeof(PortData), IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+
+		if (! portp)
+			return FINSUFFICIENT_MEMORY;
+		ListItemInitState(&portp->AllPortsEntry);
+		QListSetObj(&portp->AllPortsEntry, portp);
+		portp->nodep = nodep;
+		portp->PortInfo = port[i].PortInfo;
+		portp->PortGUID = port[i].PortGUID;
+		portp->EndPortLID = port[i].EndPortLID;
+		portp->PortNum = port[i].PortNum;
+		portp->rate = StlLinkSpeedWidthToStaticRate(
+				portp->PortInfo.LinkSpeed.Active,
+				portp->PortInfo.LinkWidth.Active);
+
+		if (cl_qmap_insert(&nodep->Ports, portp->PortNum, &portp->NodePortsEntry) != &portp->NodePortsEntry) {
+			fprintf(stderr, "%s: Duplicate PortNum: %u\n", g_Top_cmdname, portp->PortNum);
+			MemoryDeallocate(portp);
+			return FERROR;
+		}
+		if (FSUCCESS != AllLidsAdd(fabricp, portp, FALSE)) {
+			fprintf(stderr, "%s: Duplicate LIDs found in portRecords: LID 0x%x Port %u Node: %.*s\n",
+					g_Top_cmdname, portp->EndPortLID, portp->PortNum,
+					STL_NODE_DESCRIPTION_ARRAY_SIZE, (char*)nodep->NodeDesc.NodeString);
+			cl_qmap_remove_item(&nodep->Ports, &portp->NodePortsEntry);
+			MemoryDeallocate(portp);
+			return FERROR;
+		}
+		ports[i] = portp;
+
+		status = BinSnapLoadPortTables(map, fabricp, portp, &port[i]);
+		if (status != FSUCCESS)
+			return status;
+	}
+	return FSUCCESS;
+}
+
+static FSTATUS BinSnapLoad(const BinSnapMap_t *map, FabricData_t *fabricp)
+{
+	const BinSnapNode_t *node;
+	const BinSnapPort_t *port;
+	const STL_SMINFO_RECORD *sm;
+	PortData **ports = NULL;
+	uint32 numNodes, numPorts, numSMs, i;
+	FSTATUS status = FSUCCESS;
+
+	fabricp->time = (time_t)map->header->time;
+	fabricp->flags |= map->header->flags & BINSNAP_FLAGS;
+
+	node = (const BinSnapNode_t *)BinSnapRecords(map, BINSNAP_SECT_NODES, &numNodes);
+	port = (const BinSnapPort_t *)BinSnapRecords(map, BINSNAP_SECT_PORTS, &numPorts);
+	sm = (const STL_SMINFO_RECORD *)BinSnapRecords(map, BINSNAP_SECT_SMS, &numSMs);
+
+	if (numPorts) {
+		ports = (PortData **)MemoryAllocate2AndClear(sizeof(PortData *) * numPorts,
+					IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		if (! ports) {
+			status = FINSUFFICIENT_MEMORY;
+			goto fail;
+		}
+	}
+	for (i = 0; i < numNodes; i++) {
+		status = BinSnapLoadNode(map, fabricp, &node[i], ports);
+		if (status != FSUCCESS)
+			goto fail;
+	}
+
+	// links refer to ports by index, now that every port exists
+	for (i = 0; i < numPorts; i++) {
+		PortData *p1 = ports[i], *p2;
+
+		if (! p1 || port[i].neighbor == BINSNAP_NONE || p1->neighbor)
+			continue;
+		if (port[i].neighbor >= numPorts || ! ports[port[i].neighbor]
+			|| ports[port[i].neighbor]->neighbor) {
+			status = FERROR;
+			goto fail;
+		}
+		p2 = ports[port[i].neighbor];
+		p1->neighbor = p2;
+		p2->neighbor = p1;
+		p1->from = port[i].from;
+		p2->from = port[port[i].neighbor].from;
+		++(fabricp->LinkCount);
+		if (! isInternalLink(p1))
+			++(fabricp->ExtLinkCount);
+	}
+
+	for (i = 0; i < numSMs; i++) {
+		SMData *smp = (SMData*)MemoryAllocate2AndClear(sizeof(SMData), IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+
+		if (! smp) {
+			status = FINSUFFICIENT_MEMORY;
+			goto fail;
+		}
+		smp->SMInfoRecord = sm[i];
+		smp->portp = FindLidPort(fabricp, smp->SMInfoRecord.RID.LID, 0);
+		if (! smp->portp) {
+			fprintf(stderr, "%s: SM LID not found: 0x%x\n", g_Top_cmdname, smp->SMInfoRecord.RID.LID);
+			MemoryDeallocate(smp);
+			continue;
+		}
+		if (&smp->AllSMsEntry != cl_qmap_insert(&fabricp->AllSMs, smp->SMInfoRecord.SMInfo.PortGUID, &smp->AllSMsEntry)) {
+			fprintf(stderr, "%s: Duplicate SM Port Guids: 0x%016"PRIx64"\n",
+					g_Top_cmdname, smp->SMInfoRecord.SMInfo.PortGUID);
+			MemoryDeallocate(smp);
+		}
+	}
+
+done:
+	if (ports)
+		MemoryDeallocate(ports);
+	return status;
+
+fail:
+	// This free's everything we built while loading, leaving empty lists
+	SMDataFreeAll(fabricp);
+	NodeDataFreeAll(fabricp);
+	fabricp->LinkCount = 0;
+	fabricp->ExtLinkCount = 0;
+	goto done;
+}
+
+// TRUE if input_file starts with a binary snapshot header
+boolean BinIsSnapshot(const char *input_file)
+{
+	FILE *file;
+	uint32 magic = 0;
+
+	file = fopen(input_file, "r");
+	if (! file)
+		return FALSE;
+	if (fread(&magic, sizeof(magic), 1, file) != 1)
+		magic = 0;
+	fclose(file);
+	return magic == BINSNAP_MAGIC;
+}
+
+// load a binary snapshot into fabricp which has been initialized by
+// InitFabricData.  Caller must BuildFabricDataLists
+FSTATUS BinParseSnapshot(const char *input_file, FabricData_t *fabricp)
+{
+	BinSnapMap_t map;
+	struct stat statbuf;
+	const char *strings;
+	uint32 numStrings;
+	void *base;
+	int fd;
+	FSTATUS status;
+
+	fd = open(input_file, O_RDONLY);
+	if (fd < 0 || fstat(fd, &statbuf) != 0) {
+		fprintf(stderr, "%s: Unable to open %s: %s\n", g_Top_cmdname, input_file, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return FERROR;
+	}
+	MemoryClear(&map, sizeof(map));
+	map.size = statbuf.st_size;
+	base = map.size ? mmap(NULL, map.size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+	close(fd);
+	if (base == MAP_FAILED) {
+		fprintf(stderr, "%s: Unable to map %s: %s\n", g_Top_cmdname, input_file, strerror(errno));
+		return FERROR;
+	}
+	map.base = (const uint8 *)base;
+
+	status = BinSnapValidate(input_file, &map);
+	if (status == FSUCCESS) {
+		strings = (const char *)BinSnapRecords(&map, BINSNAP_SECT_STRINGS, &numStrings);
+		if (! numStrings || strings[numStrings-1] != '\0') {
+			fprintf(stderr, "%s: %s: Invalid or truncated binary snapshot\n",
+					g_Top_cmdname, input_file);
+			status = FERROR;
+		}
+	}
+	if (status == FSUCCESS) {
+		status = BinSnapLoad(&map, fabricp);
+		if (status != FSUCCESS)
+			fprintf(stderr, "%s: %s: Unable to load binary snapshot: %s\n",
+					g_Top_cmdname, input_file, iba_fstatus_msg(status));
+	}
+	munmap(base, map.size);
+	return status;
+}
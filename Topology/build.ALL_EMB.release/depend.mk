@@ -0,0 +1,13 @@
+include Makefile
+include build.ALL_EMB.release/getdate.c.dep
+include build.ALL_EMB.release/fabricdata.c.dep
+include build.ALL_EMB.release/focus.c.dep
+include build.ALL_EMB.release/point.c.dep
+include build.ALL_EMB.release/search.c.dep
+include build.ALL_EMB.release/snapshot.c.dep
+include build.ALL_EMB.release/topology.c.dep
+include build.ALL_EMB.release/util.c.dep
+include build.ALL_EMB.release/mad_info.c.dep
+include build.ALL_EMB.release/mad.c.dep
+include build.ALL_EMB.release/route.c.dep
+include build.ALL_EMB.release/sweep.c.dep
@@ -80,6 +80,8 @@ FSTATUS InitFabricData(FabricData_t *fabricp, FabricFlags_t flags)
 {
 	MemoryClear(fabricp, sizeof(*fabricp));
 	cl_qmap_init(&fabricp->AllNodes, NULL);
+	cl_hmap_init(&fabricp->AllNodeGuids, NULL, NULL, NULL);
+	cl_hmap_init(&fabricp->AllPortGuids, NULL, NULL, NULL);
 	if (flags & FF_LIDARRAY) {
 		fabricp->u.LidMap = (PortData **)MemoryAllocate2AndClear(sizeof(PortData)*(LID_UCAST_END+1), IBA_MEM_FLAG_PREMPTABLE, MYTAG);
 		if (!  fabricp->u.LidMap) {
@@ -242,6 +244,12 @@ void BuildFabricDataLists(FabricData_t *fabricp)
 		for (q=cl_qmap_head(&nodep->Ports); q != cl_qmap_end(&nodep->Ports); q = cl_qmap_next(q)) {
 			PortData *portp = PARENT_STRUCT(q, PortData, NodePortsEntry);
 			QListInsertTail(&fabricp->AllPorts, &portp->AllPortsEntry);
+			// switch ports share port 0's guid, keep the 1st in AllPorts order
+			if (portp->PortGUID
+				&& ! cl_hmap_get(&fabricp->AllPortGuids, portp->PortGUID)
+				&& FSUCCESS != cl_hmap_insert(&fabricp->AllPortGuids, portp->PortGUID, portp))
+				fprintf(stderr, "%s: Unable to index Port GUID 0x%016"PRIx64"\n",
+						g_Top_cmdname, portp->PortGUID);
 		}
 	}
 }
@@ -475,8 +483,11 @@ void PortDataFree(FabricData_t *fabricp, PortData *portp)
 	if (portp->context && g_Top_FreeCallbacks.pPortDataFreeCallback)
 		(*g_Top_FreeCallbacks.pPortDataFreeCallback)(fabricp, portp);
 
-	if (portp->PortGUID)
+	if (portp->PortGUID) {
 		AllLidsRemove(fabricp, portp);
+		if (cl_hmap_get(&fabricp->AllPortGuids, portp->PortGUID) == portp)
+			(void)cl_hmap_remove(&fabricp->AllPortGuids, portp->PortGUID);
+	}
 	cl_qmap_remove_item(&nodep->Ports, &portp->NodePortsEntry);
 	if (portp->pPortStatus)
 		MemoryDeallocate(portp->pPortStatus);
@@ -809,7 +820,14 @@ NodeData *FabricDataAddNode(FabricData_t *fabricp, STL_NODE_RECORD *pNodeRecord,
 	}
 
 	if (new_node) {
+		if (FSUCCESS != cl_hmap_insert(&fabricp->AllNodeGuids, nodep->NodeInfo.NodeGUID, nodep)) {
+			fprintf(stderr, "%s: Unable to allocate memory\n", g_Top_cmdname);
+			cl_qmap_remove_item(&fabricp->AllNodes, &nodep->AllNodesEntry);
+			MemoryDeallocate(nodep);
+			goto fail;
+		}
 		if (FSUCCESS != AddSystemNode(fabricp, nodep)) {
+			(void)cl_hmap_remove(&fabricp->AllNodeGuids, nodep->NodeInfo.NodeGUID);
 			cl_qmap_remove_item(&fabricp->AllNodes, &nodep->AllNodesEntry);
 			MemoryDeallocate(nodep);
 			goto fail;
@@ -1207,6 +1225,7 @@ void NodeDataFree(FabricData_t *fabricp, NodeData *nodep)
 		MemoryDeallocate(nodep->systemp);
 	}
 	cl_qmap_remove_item(&fabricp->AllNodes, &nodep->AllNodesEntry);
+	(void)cl_hmap_remove(&fabricp->AllNodeGuids, nodep->NodeInfo.NodeGUID);
 	NodeDataFreePorts(fabricp, nodep);
 #if !defined(VXWORKS) || defined(BUILD_DMC)
 	if (nodep->ioup)
@@ -1380,6 +1399,8 @@ void DestroyFabricData(FabricData_t *fabricp)
 
 	if ((fabricp->flags & FF_LIDARRAY) && fabricp->u.LidMap)
 		MemoryDeallocate(fabricp->u.LidMap);
+	cl_hmap_destroy(&fabricp->AllNodeGuids);
+	cl_hmap_destroy(&fabricp->AllPortGuids);
 
 	// make sure no stale pointers in lists, etc
 	// also clear counters and flags
@@ -2771,9 +2792,15 @@ clGraphData_t* CLGraphDataSplit(clGraphData_t *graphp, int verbose)
    return newGraphp;
 }
 
+// A vertex with no outbound arcs (pure sink) or no inbound arcs (pure source)
+// cannot be part of a cycle, so its arcs are removed.  Removing them may make
+// a neighbor a pure sink or source in turn, so neighbors are queued for
+// another look rather than sweeping the whole graph until nothing changes.
 void CLGraphDataPrune(clGraphData_t *graphp, ValidateCLTimeGetCallback_t timeGetCallback, int verbose) 
 { 
-   uint32 ii, vv, progress = 1, round = 0; 
+   uint32 ii, vv, head = 0, tail = 0, count = 0, deleted = 0; 
+   uint32 *queue = NULL; 
+   uint8 *queued = NULL; 
    uint64_t sTime = 0, eTime = 0; 
    
    if (verbose >= 3) {
@@ -2781,57 +2808,88 @@ void CLGraphDataPrune(clGraphData_t *graphp, ValidateCLTimeGetCallback_t timeGet
       printf("START pruning of graphical layout of all the routes\n");
    }
    
-   //PYTHON: progress = 1;
-   //PYTHON: round = 0;
-   //PYTHON: while progress :
-   while (progress) {          // DEBUG_CODE --- Possible infinite loop, look into later????
-      progress = 0; 
-      //PYTHON: for vertex in self.vertices :
-      for (vv = 0; vv < graphp->NumVertices; vv++) {
-         clVertixData_t *vertexp = graphp->Vertices[vv]; 
-         
-         //PYTHON: if vertex.refcount :
-         if (vertexp->RefCount) {
-            //PYTHON: if len(vertexp->outbound) == 0 :
-            if (vertexp->OutboundInuseCount == 0) {
-               //PYTHON: for arc_id in vertexp->inbound :
-               for (ii = 0; ii < vertexp->InboundCount; ii++) {
-                  if (vertexp->Inbound[ii] >= 0) {
-                     if (verbose >= 4) 
-                        printf("Remove arc id %d since vertex id %d is pure sink\n", 
-                               vertexp->Inbound[ii], vertexp->Id); 
-                     //PYTHON: self.del_arc(arc_id);
-                     CLGraphDataDelArc(graphp, vertexp->Inbound[ii]); 
-                     //PYTHON: progress += 1
-                     progress++;
-                  }
+   if (!graphp->NumVertices) 
+      goto done; 
+   
+   // circular queue, each vertex is queued at most once at a time
+   if (!(queue  = MemoryAllocate2AndClear(graphp->NumVertices * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG)) || 
+       !(queued = MemoryAllocate2AndClear(graphp->NumVertices * sizeof(uint8), IBA_MEM_FLAG_PREMPTABLE, MYTAG))) {
+      fprintf(stderr, "%s: Unable to allocate memory\n", g_Top_cmdname); 
+      goto done;
+   }
+   
+   for (vv = 0; vv < graphp->NumVertices; vv++) {
+      if (graphp->Vertices[vv]->RefCount) {
+         queue[count++] = vv; 
+         queued[vv] = 1;
+      }
+   }
+   tail = count % graphp->NumVertices; 
+   
+   while (count) {
+      clVertixData_t *vertexp = graphp->Vertices[queue[head]]; 
+      
+      queued[queue[head]] = 0; 
+      head = (head + 1) % graphp->NumVertices; 
+      count--; 
+      
+      if (!vertexp->RefCount) 
+         continue; 
+      
+      if (vertexp->OutboundInuseCount == 0) {
+         for (ii = 0; ii < vertexp->InboundCount; ii++) {
+            clArcData_t *arcp; 
+            
+            if (vertexp->Inbound[ii] >= 0 && (arcp = CLGraphFindIdArc(graphp, vertexp->Inbound[ii]))) {
+               uint32 source = arcp->Source; 
+               
+               if (verbose >= 4) 
+                  printf("Remove arc id %d since vertex id %d is pure sink\n", 
+                         vertexp->Inbound[ii], vertexp->Id); 
+               CLGraphDataDelArc(graphp, vertexp->Inbound[ii]); 
+               deleted++; 
+               if (!queued[source]) {
+                  queue[tail] = source; 
+                  tail = (tail + 1) % graphp->NumVertices; 
+                  queued[source] = 1; 
+                  count++;
                }
             }
+         }
+      }
+      
+      if (vertexp->InboundInuseCount == 0) {
+         for (ii = 0; ii < vertexp->OutboundCount; ii++) {
+            clArcData_t *arcp; 
             
-            //PYTHON: if len(vertexp->inbound) == 0 :
-            if (vertexp->InboundInuseCount == 0) {
-               //PYTHON: for arc_id in vertex.outbound :
-               for (ii = 0; ii < vertexp->OutboundCount; ii++) {
-                  if (vertexp->Outbound[ii] >= 0) {
-                     if (verbose >= 4) 
-                        printf("Remove arc id %d since vertex id %d is pure source\n", 
-                               vertexp->Outbound[ii], vertexp->Id); 
-                     //PYTHON: self.del_arc(arc_id);
-                     CLGraphDataDelArc(graphp, vertexp->Outbound[ii]); 
-                     //PYTHON: progress += 1
-                     progress++;
-                  }
+            if (vertexp->Outbound[ii] >= 0 && (arcp = CLGraphFindIdArc(graphp, vertexp->Outbound[ii]))) {
+               uint32 sink = arcp->Sink; 
+               
+               if (verbose >= 4) 
+                  printf("Remove arc id %d since vertex id %d is pure source\n", 
+                         vertexp->Outbound[ii], vertexp->Id); 
+               CLGraphDataDelArc(graphp, vertexp->Outbound[ii]); 
+               deleted++; 
+               if (!queued[sink]) {
+                  queue[tail] = sink; 
+                  tail = (tail + 1) % graphp->NumVertices; 
+                  queued[sink] = 1; 
+                  count++;
                }
             }
          }
       }
-      
-      //PYTHON: round += 1
-      round++; 
-      if (verbose >= 4) 
-         printf("Graph pruning round %d : deleted %d arcs\n", round, progress);
    }
    
+   if (verbose >= 4) 
+      printf("Graph pruning : deleted %d arcs\n", deleted); 
+   
+done:
+   if (queue) 
+      MemoryDeallocate(queue); 
+   if (queued) 
+      MemoryDeallocate(queued); 
+   
    if (verbose >= 3) {
       timeGetCallback(&eTime, &g_cl_lock); 
       printf("END pruning of graphical layout of all the routes; elapsed time(usec)=%d, (sec)=%d\n", 
@@ -3328,4 +3386,530 @@ done:
       MemoryDeallocate(distance_list);
 }
 
+#define CL_GRAPH_NONE               0xffffffff
+
+// compressed sparse row copy of the active vertices and arcs of a graph
+typedef struct clGraphCsr_s {
+   uint32          numVertices; 
+   uint32          *vertexId;       // graph vertex Id of each row
+   uint32          *arcStart;       // numVertices+1 offsets into arcSink
+   uint32          *arcSink;        // row of the sink of each arc
+   uint32          *component;      // component with a cycle or CL_GRAPH_NONE
+   uint32          numComponents; 
+   uint32          *componentStart; // numComponents+1 offsets into componentRows
+   uint32          *componentRows;  // rows of each component, ascending
+} clGraphCsr_t; 
+
+typedef struct clCycleThreadContext_s {
+   clGraphCsr_t *csrp; 
+   clGraphCycles_t *cyclesp; 
+   uint32 *nextComponent;           // shared, protected by g_cl_lock
+   uint8 *done;                     // shared, components touch disjoint rows
+   FSTATUS threadStatus; 
+} clCycleThreadContext_t; 
+
+static void CLGraphCsrFree(clGraphCsr_t *csrp) 
+{ 
+   if (csrp->vertexId) 
+      MemoryDeallocate(csrp->vertexId); 
+   if (csrp->arcStart) 
+      MemoryDeallocate(csrp->arcStart); 
+   if (csrp->arcSink) 
+      MemoryDeallocate(csrp->arcSink); 
+   if (csrp->component) 
+      MemoryDeallocate(csrp->component); 
+   if (csrp->componentStart) 
+      MemoryDeallocate(csrp->componentStart); 
+   if (csrp->componentRows) 
+      MemoryDeallocate(csrp->componentRows); 
+   memset(csrp, 0, sizeof(clGraphCsr_t));
+}
+
+static FSTATUS CLGraphCsrBuild(clGraphData_t *graphp, clGraphCsr_t *csrp) 
+{ 
+   FSTATUS status = FINSUFFICIENT_MEMORY; 
+   uint32 vv, c, row = 0, numArcs = 0; 
+   uint32 *rowOf = NULL; 
+   
+   memset(csrp, 0, sizeof(clGraphCsr_t)); 
+   for (vv = 0; vv < graphp->NumVertices; vv++) {
+      if (graphp->Vertices[vv]->RefCount) {
+         csrp->numVertices++; 
+         numArcs += graphp->Vertices[vv]->OutboundInuseCount;
+      }
+   }
+   if (!csrp->numVertices) 
+      return FSUCCESS; 
+   
+   if (!(rowOf           = MemoryAllocate2AndClear(graphp->NumVertices * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG)) || 
+       !(csrp->vertexId  = MemoryAllocate2AndClear(csrp->numVertices * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG)) || 
+       !(csrp->arcStart  = MemoryAllocate2AndClear((csrp->numVertices + 1) * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG)) || 
+       !(csrp->arcSink   = MemoryAllocate2AndClear(MAX(numArcs, 1) * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG)) || 
+       !(csrp->component = MemoryAllocate2AndClear(csrp->numVertices * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG))) {
+      fprintf(stderr, "%s: Unable to allocate memory\n", g_Top_cmdname); 
+      goto fail;
+   }
+   
+   for (vv = 0; vv < graphp->NumVertices; vv++) {
+      rowOf[vv] = CL_GRAPH_NONE; 
+      if (graphp->Vertices[vv]->RefCount) {
+         csrp->vertexId[row] = vv; 
+         rowOf[vv] = row++;
+      }
+   }
+   
+   numArcs = 0; 
+   for (row = 0; row < csrp->numVertices; row++) {
+      clVertixData_t *vertexp = graphp->Vertices[csrp->vertexId[row]]; 
+      
+      csrp->arcStart[row] = numArcs; 
+      for (c = 0; c < vertexp->OutboundCount; c++) {
+         clArcData_t *arcp; 
+         
+         if (vertexp->Outbound[c] >= 0 && (arcp = CLGraphFindIdArc(graphp, vertexp->Outbound[c])) 
+             && rowOf[arcp->Sink] != CL_GRAPH_NONE) 
+            csrp->arcSink[numArcs++] = rowOf[arcp->Sink];
+      }
+   }
+   csrp->arcStart[row] = numArcs; 
+   status = FSUCCESS; 
+   
+fail:
+   if (rowOf) 
+      MemoryDeallocate(rowOf); 
+   if (status != FSUCCESS) 
+      CLGraphCsrFree(csrp); 
+   return status;
+}
+
+// Find the strongly connected components via an iterative Tarjan's algorithm.
+// Arcs from a vertex to itself are never added to the graph, so only
+// components of more than one vertex contain a cycle; other rows are left
+// with a component of CL_GRAPH_NONE.  Components are numbered in order of
+// their lowest row.
+static FSTATUS CLGraphCsrComponents(clGraphCsr_t *csrp) 
+{ 
+   FSTATUS status = FINSUFFICIENT_MEMORY; 
+   uint32 n = csrp->numVertices; 
+   uint32 r, v, w, u, counter = 0, sp = 0, cp = 0, numSccs = 0; 
+   uint32 *index = NULL, *lowlink = NULL, *stack = NULL, *call = NULL, *nextArc = NULL; 
+   uint32 *sccSize = NULL, *renumber = NULL; 
+   
+   if (!n) 
+      return FSUCCESS; 
+   
+   if (!(index    = MemoryAllocate2AndClear(n * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG)) || 
+       !(lowlink  = MemoryAllocate2AndClear(n * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG)) || 
+       !(stack    = MemoryAllocate2AndClear(n * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG)) || 
+       !(call     = MemoryAllocate2AndClear(n * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG)) || 
+       !(nextArc  = MemoryAllocate2AndClear(n * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG)) || 
+       !(sccSize  = MemoryAllocate2AndClear(n * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG)) || 
+       !(renumber = MemoryAllocate2AndClear(n * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG))) {
+      fprintf(stderr, "%s: Unable to allocate memory\n", g_Top_cmdname); 
+      goto done;
+   }
+   
+   for (v = 0; v < n; v++) {
+      index[v] = CL_GRAPH_NONE; 
+      csrp->component[v] = CL_GRAPH_NONE;
+   }
+   
+   for (r = 0; r < n; r++) {
+      if (index[r] != CL_GRAPH_NONE) 
+         continue; 
+      index[r] = lowlink[r] = counter++; 
+      stack[sp++] = r; 
+      nextArc[r] = csrp->arcStart[r]; 
+      call[cp++] = r; 
+      
+      while (cp) {
+         v = call[cp - 1]; 
+         if (nextArc[v] < csrp->arcStart[v + 1]) {
+            w = csrp->arcSink[nextArc[v]++]; 
+            if (index[w] == CL_GRAPH_NONE) {
+               index[w] = lowlink[w] = counter++; 
+               stack[sp++] = w; 
+               nextArc[w] = csrp->arcStart[w]; 
+               call[cp++] = w;
+            } else if (csrp->component[w] == CL_GRAPH_NONE) {
+               // w is still on the stack
+               lowlink[v] = MIN(lowlink[v], index[w]);
+            }
+         } else {
+            cp--; 
+            if (cp) {
+               u = call[cp - 1]; 
+               lowlink[u] = MIN(lowlink[u], lowlink[v]);
+            }
+            if (lowlink[v] == index[v]) {
+               do {
+                  w = stack[--sp]; 
+                  csrp->component[w] = numSccs; 
+                  sccSize[numSccs]++;
+               } while (w != v); 
+               numSccs++;
+            }
+         }
+      }
+   }
+   
+   // keep components with a cycle, numbered by lowest row
+   for (v = 0; v < numSccs; v++) 
+      renumber[v] = CL_GRAPH_NONE; 
+   csrp->numComponents = 0; 
+   for (v = 0; v < n; v++) {
+      uint32 scc = csrp->component[v]; 
+      
+      if (sccSize[scc] < 2) {
+         csrp->component[v] = CL_GRAPH_NONE; 
+         continue;
+      }
+      if (renumber[scc] == CL_GRAPH_NONE) 
+         renumber[scc] = csrp->numComponents++; 
+      csrp->component[v] = renumber[scc];
+   }
+   
+   // group rows by component; sccSize is reused for the fill position
+   if (!(csrp->componentStart = MemoryAllocate2AndClear((csrp->numComponents + 1) * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG)) || 
+       !(csrp->componentRows  = MemoryAllocate2AndClear(n * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG))) {
+      fprintf(stderr, "%s: Unable to allocate memory\n", g_Top_cmdname); 
+      goto done;
+   }
+   for (v = 0; v < n; v++) {
+      if (csrp->component[v] != CL_GRAPH_NONE) 
+         csrp->componentStart[csrp->component[v] + 1]++;
+   }
+   for (v = 0; v < csrp->numComponents; v++) {
+      csrp->componentStart[v + 1] += csrp->componentStart[v]; 
+      sccSize[v] = csrp->componentStart[v];
+   }
+   for (v = 0; v < n; v++) {
+      if (csrp->component[v] != CL_GRAPH_NONE) 
+         csrp->componentRows[sccSize[csrp->component[v]]++] = v;
+   }
+   status = FSUCCESS; 
+   
+done:
+   if (index) 
+      MemoryDeallocate(index); 
+   if (lowlink) 
+      MemoryDeallocate(lowlink); 
+   if (stack) 
+      MemoryDeallocate(stack); 
+   if (call) 
+      MemoryDeallocate(call); 
+   if (nextArc) 
+      MemoryDeallocate(nextArc); 
+   if (sccSize) 
+      MemoryDeallocate(sccSize); 
+   if (renumber) 
+      MemoryDeallocate(renumber); 
+   return status;
+}
+
+// Find the shortest cycle through each vertex of a component which is not
+// already on a cycle reported for the component.  Arcs are unweighted, so a
+// breadth first search limited to the component gives shortest distances; a
+// cycle through the root can only leave the root's component if it never
+// returns, so the search never looks outside it.
+static FSTATUS CLGraphComponentCycles(clGraphCsr_t *csrp, uint32 comp, uint8 *done, 
+                                      uint32 *dist, uint32 *parent, uint32 *queue, 
+                                      clComponentCycles_t *resultp) 
+{ 
+   uint32 first = csrp->componentStart[comp], last = csrp->componentStart[comp + 1]; 
+   uint32 rr, a, k, offset = 0; 
+   
+   resultp->numVertices = last - first; 
+   for (rr = first; rr < last; rr++) {
+      uint32 row = csrp->componentRows[rr]; 
+      
+      for (a = csrp->arcStart[row]; a < csrp->arcStart[row + 1]; a++) {
+         if (csrp->component[csrp->arcSink[a]] == comp) 
+            resultp->numArcs++;
+      }
+   }
+   
+   // at most one cycle per vertex
+   resultp->cycleStart = MemoryAllocate2AndClear((resultp->numVertices + 1) * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG); 
+   if (!resultp->cycleStart) {
+      fprintf(stderr, "%s: Unable to allocate memory\n", g_Top_cmdname); 
+      return FINSUFFICIENT_MEMORY;
+   }
+   
+   for (rr = first; rr < last; rr++) {
+      uint32 root = csrp->componentRows[rr]; 
+      uint32 head = 0, tail = 0, found = CL_GRAPH_NONE, length = 0, u; 
+      
+      if (done[root]) 
+         continue; 
+      
+      queue[tail++] = root; 
+      dist[root] = 0; 
+      while (head < tail && found == CL_GRAPH_NONE) {
+         u = queue[head++]; 
+         for (a = csrp->arcStart[u]; a < csrp->arcStart[u + 1]; a++) {
+            uint32 w = csrp->arcSink[a]; 
+            
+            if (csrp->component[w] != comp) 
+               continue; 
+            if (w == root) {
+               // vertices are dequeued in order of distance, so this is
+               // the shortest way back
+               found = u; 
+               length = dist[u] + 1; 
+               break;
+            }
+            if (dist[w] == CL_GRAPH_NONE) {
+               dist[w] = dist[u] + 1; 
+               parent[w] = u; 
+               queue[tail++] = w;
+            }
+         }
+      }
+      for (k = 0; k < tail; k++) 
+         dist[queue[k]] = CL_GRAPH_NONE; 
+      if (found == CL_GRAPH_NONE) 
+         continue; 
+      
+      // a single cycle may be longer than any fixed increment, so grow by
+      // doubling until it fits
+      if (offset + length > resultp->cycleVerticesLength) {
+         uint32 newLength = MAX(resultp->cycleVerticesLength * 2, offset + length);
+         uint32 *newVertices = MemoryAllocate2AndClear(newLength * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+
+         if (!newVertices) {
+            fprintf(stderr, "%s: Unable to resize the buffer\n", g_Top_cmdname);
+            return FINSUFFICIENT_MEMORY;
+         }
+         if (resultp->cycleVertices) {
+            memcpy(newVertices, resultp->cycleVertices, offset * sizeof(uint32));
+            MemoryDeallocate(resultp->cycleVertices);
+         }
+         resultp->cycleVertices = newVertices;
+         resultp->cycleVerticesLength = newLength;
+      }
+      // walk back from the last vertex of the cycle to the root
+      for (k = length, u = found; k > 0; k--) {
+         resultp->cycleVertices[offset + k - 1] = csrp->vertexId[u]; 
+         done[u] = 1; 
+         if (u != root) 
+            u = parent[u];
+      }
+      offset += length; 
+      resultp->cycleStart[++resultp->numCycles] = offset;
+   }
+   
+   return FSUCCESS;
+}
+
+static void* CLGraphDataFindCyclesThread(void *context) 
+{ 
+   clCycleThreadContext_t *tcp = (clCycleThreadContext_t *)context; 
+   clGraphCsr_t *csrp = tcp->csrp; 
+   uint32 comp, k, *dist = NULL, *parent = NULL, *queue = NULL; 
+   
+   tcp->threadStatus = FINSUFFICIENT_MEMORY; 
+   if (!(dist   = MemoryAllocate2AndClear(csrp->numVertices * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG)) || 
+       !(parent = MemoryAllocate2AndClear(csrp->numVertices * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG)) || 
+       !(queue  = MemoryAllocate2AndClear(csrp->numVertices * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG))) {
+      fprintf(stderr, "%s: Unable to allocate memory\n", g_Top_cmdname); 
+      goto done;
+   }
+   for (k = 0; k < csrp->numVertices; k++) 
+      dist[k] = CL_GRAPH_NONE; 
+   
+   tcp->threadStatus = FSUCCESS; 
+   while (tcp->threadStatus == FSUCCESS) {
+      pthread_mutex_lock(&g_cl_lock); 
+      comp = (*tcp->nextComponent)++; 
+      pthread_mutex_unlock(&g_cl_lock); 
+      if (comp >= csrp->numComponents) 
+         break; 
+      tcp->threadStatus = CLGraphComponentCycles(csrp, comp, tcp->done, dist, parent, queue, 
+                                                 &tcp->cyclesp->components[comp]);
+   }
+   
+done:
+   if (dist) 
+      MemoryDeallocate(dist); 
+   if (parent) 
+      MemoryDeallocate(parent); 
+   if (queue) 
+      MemoryDeallocate(queue); 
+   return NULL;
+}
+
+void CLGraphDataFreeCycles(clGraphCycles_t *cyclesp) 
+{ 
+   uint32 c; 
+   
+   if (cyclesp->components) {
+      for (c = 0; c < cyclesp->numComponents; c++) {
+         if (cyclesp->components[c].cycleStart) 
+            MemoryDeallocate(cyclesp->components[c].cycleStart); 
+         if (cyclesp->components[c].cycleVertices) 
+            MemoryDeallocate(cyclesp->components[c].cycleVertices);
+      }
+      MemoryDeallocate(cyclesp->components);
+   }
+   memset(cyclesp, 0, sizeof(clGraphCycles_t));
+}
+
+// Find the credit loops in a route dependency graph.  Only vertices in a
+// strongly connected component of more than one vertex are on a cycle, so
+// the graph is copied to CSR form, split into such components and the
+// shortest cycles within each component are found by worker threads.
+FSTATUS CLGraphDataFindCycles(clGraphData_t *graphp, clGraphCycles_t *cyclesp, int verbose) 
+{ 
+   FSTATUS status; 
+   clGraphCsr_t csr; 
+   clCycleThreadContext_t threadContexts[CL_MAX_THREADS]; 
+   pthread_t threadIds[CL_MAX_THREADS]; 
+   uint32 t, numThreads = 0, nextComponent = 0; 
+   uint8 *done = NULL; 
+   
+   memset(cyclesp, 0, sizeof(clGraphCycles_t)); 
+   if ((status = CLGraphCsrBuild(graphp, &csr))) 
+      return status; 
+   if ((status = CLGraphCsrComponents(&csr))) 
+      goto done; 
+   
+   if (verbose >= 3) 
+      printf("Dependency graph of %d vertices has %d strongly connected component(s) with cycles\n", 
+             csr.numVertices, csr.numComponents); 
+   if (!csr.numComponents) 
+      goto done; 
+   
+   if (!(done = MemoryAllocate2AndClear(csr.numVertices * sizeof(uint8), IBA_MEM_FLAG_PREMPTABLE, MYTAG)) || 
+       !(cyclesp->components = MemoryAllocate2AndClear(csr.numComponents * sizeof(clComponentCycles_t), IBA_MEM_FLAG_PREMPTABLE, MYTAG))) {
+      status = FINSUFFICIENT_MEMORY; 
+      fprintf(stderr, "%s: Unable to allocate memory\n", g_Top_cmdname); 
+      goto done;
+   }
+   cyclesp->numComponents = csr.numComponents; 
+   
+   memset(threadContexts, 0, sizeof(threadContexts)); 
+   for (t = 0; t < MIN(CL_MAX_THREADS, csr.numComponents); t++) {
+      threadContexts[t].csrp = &csr; 
+      threadContexts[t].cyclesp = cyclesp; 
+      threadContexts[t].nextComponent = &nextComponent; 
+      threadContexts[t].done = done; 
+      if (pthread_create(&threadIds[t], NULL, CLGraphDataFindCyclesThread, &threadContexts[t])) 
+         break; 
+      numThreads++;
+   }
+   if (!numThreads) {
+      // no threads available, do the work here instead
+      (void)CLGraphDataFindCyclesThread(&threadContexts[0]); 
+      numThreads = 1;
+   } else {
+      for (t = 0; t < numThreads; t++) 
+         pthread_join(threadIds[t], NULL);
+   }
+   for (t = 0; t < numThreads; t++) {
+      if (threadContexts[t].threadStatus != FSUCCESS) 
+         status = threadContexts[t].threadStatus;
+   }
+   
+done:
+   if (done) 
+      MemoryDeallocate(done); 
+   CLGraphCsrFree(&csr); 
+   if (status != FSUCCESS) 
+      CLGraphDataFreeCycles(cyclesp); 
+   return status;
+}
+
+void CLGraphDataCyclesSummary(FabricData_t *fabricp, 
+                              clGraphData_t *graphp, 
+                              clGraphCycles_t *cyclesp, 
+                              ValidateCLDataSummaryCallback_t dataSummaryCallback, 
+                              ValidateCLLinkSummaryCallback_t linkSummaryCallback, 
+                              ValidateCLLinkStepSummaryCallback_t linkStepSummaryCallback, 
+                              ValidateCLPathSummaryCallback_t pathSummaryCallback, 
+                              void *context) 
+{ 
+   uint32 comp, cycle, step; 
+   uint32 *cycle_histogram = NULL, cycle_histogram_entries = 0; 
+   ValidateCreditLoopRoutesContext_t *cp = (ValidateCreditLoopRoutesContext_t *)context; 
+   int xmlFmt = (cp->format == 1) ? 1 : 0; 
+   int verbose = (xmlFmt) ? 0 : cp->detail; 
+   int indent = cp->indent; 
+   
+   for (comp = 0; comp < cyclesp->numComponents; comp++) {
+      clComponentCycles_t *compp = &cyclesp->components[comp]; 
+      
+      if (cp->detail >= 3) {
+         clGraphData_t summary; 
+         char title[100]; 
+         
+         // counts only, the component's vertices stay in graphp
+         memset(&summary, 0, sizeof(summary)); 
+         cl_qmap_init(&summary.Arcs, NULL); 
+         cl_qmap_init(&summary.map_arc_key_to_arc, NULL); 
+         cl_qmap_init(&summary.map_conn_to_vertex_conn, NULL); 
+         summary.NumVertices = summary.NumActiveVertices = compp->numVertices; 
+         summary.NumArcs = compp->numArcs; 
+         if (xmlFmt) 
+            sprintf(title, "SplitGraph%d", comp); 
+         else 
+            sprintf(title, "Split graph %d", comp); 
+         (void)CLGraphDataSummary(&summary, title, dataSummaryCallback, cp);
+      }
+      
+      if (verbose >= 3) {
+         if (cycle_histogram) 
+            MemoryDeallocate(cycle_histogram); 
+         cycle_histogram_entries = 0; 
+         cycle_histogram = MemoryAllocate2AndClear((compp->numVertices + 1) * sizeof(uint32), IBA_MEM_FLAG_PREMPTABLE, MYTAG); 
+      }
+      
+      for (cycle = 0; cycle < compp->numCycles; cycle++) {
+         uint32 *vertices = &compp->cycleVertices[compp->cycleStart[cycle]]; 
+         uint32 dii = compp->cycleStart[cycle + 1] - compp->cycleStart[cycle]; 
+         clVertixData_t *i = graphp->Vertices[vertices[0]]; 
+         
+         (void)linkSummaryCallback(i->Id, ib_connection_source_to_str(fabricp, i->Connection), dii, 1, indent, context); 
+         if (verbose >= 4) 
+            (void)pathSummaryCallback(fabricp, i->Connection, indent + 4, context); 
+         
+         for (step = 0; step < dii; step++) {
+            clVertixData_t *j = graphp->Vertices[vertices[step]]; 
+            
+            (void)linkStepSummaryCallback(j->Id, ib_connection_source_to_str(fabricp, j->Connection), step, 1, indent + 4, context); 
+            if (verbose >= 4) 
+               (void)pathSummaryCallback(fabricp, j->Connection, indent + 8, context); 
+            // insert XML token to indicate the end of link step summary section
+            if (xmlFmt) 
+               (void)linkStepSummaryCallback(0, 0, 0, 0, indent + 4, context);
+         }
+         
+         // insert XML token to indicate the end of link summary section
+         if (xmlFmt) 
+            (void)linkSummaryCallback(0, 0, 0, 0, indent, context); 
+         
+         if (cycle_histogram) {
+            cycle_histogram[dii]++; 
+            cycle_histogram_entries = MAX(cycle_histogram_entries, dii);
+         }
+      }
+      
+      if (cycle_histogram) {
+         uint32 c; 
+         
+         printf("Deadlock - dependency graph routes contain %d cycle(s):\n", compp->numCycles); 
+         for (c = 0; c <= cycle_histogram_entries; c++) {
+            if (cycle_histogram[c]) 
+               printf("  %d cycle(s) of circumference %d\n", cycle_histogram[c], c);
+         }
+      }
+   }
+   
+   if (verbose >= 3 && cyclesp->numComponents > 1) 
+      printf("Dependencies split into %d strongly connected components\n", cyclesp->numComponents); 
+   
+   if (cycle_histogram) 
+      MemoryDeallocate(cycle_histogram);
+}
+
 #endif
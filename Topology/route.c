@@ -500,15 +500,846 @@ FSTATUS TabulateRoutes(FabricData_t *fabricp, PortData *portp1,
 }
 
 
+// Parallel all pairs route analysis
+//
+// TabulateCARoutes, ReportCARoutes and ValidateAllRoutes look at the routes
+// between every pair of LIDs.  IB is destination routed, so the hops taken
+// from a given switch toward a DLID do not depend on where the route started.
+// Each worker thread takes one destination at a time, follows the LFT chain
+// from each switch only once per DLID, memoizing the exit port, next switch
+// and how the chain ends, and then accounts for all the sources which enter
+// the fabric at that switch.  Routes which loop, are too long or do not start
+// at a switch are walked with WalkRoutePort as before.  Per thread results are
+// merged in source/destination order, so totals and callbacks are the same as
+// for a serial walk of every route.
+
+#define ROUTE_MAX_THREADS	8
+#define ROUTE_MAX_HOPS		64		// same limit as WalkRoutePort
+#define ROUTE_NONE			0xffffffff
+
+typedef enum {
+	ROUTE_MODE_TABULATE,	// TabulateCARoutes
+	ROUTE_MODE_REPORT,		// ReportCARoutes
+	ROUTE_MODE_VALIDATE		// ValidateAllRoutes
+} RouteMode_t;
+
+// how the chain of hops from a switch toward the DLID ends
+typedef enum {
+	ROUTE_END_ACTIVE = 0,	// being resolved, seeing it again implies a loop
+	ROUTE_END_OK,			// arrived at DLID
+	ROUTE_END_WRONG,		// arrived at a device without DLID
+	ROUTE_END_DEAD,			// no viable LFT entry
+	ROUTE_END_LOOP,			// looping path, each source must be walked
+	ROUTE_END_UNAVAILABLE	// no routing tables for switch
+} RouteEnd_t;
+
+// chain from a switch crosses the port being reported
+#define ROUTE_HIT_ENTRY		0x1
+#define ROUTE_HIT_EXIT		0x2
+
+typedef struct RoutePort_s {
+	PortData	*portp;		// NULL if no such port in fabric
+	uint32		sw;			// index of switch port is on, ROUTE_NONE if not SW
+	uint32		peer;		// port index of neighbor, ROUTE_NONE if none
+	uint32		peerSw;		// switch index of neighbor, ROUTE_NONE if not SW
+	boolean		viable;		// usable as exit port, see LookupLFT
+	boolean		uplink;		// exit toward a higher tier, for fat tree
+} RoutePort_t;
+
+typedef struct RouteSwitch_s {
+	NodeData	*nodep;
+	uint32		port0;		// port index of port 0, other ports follow
+	uint8		numPorts;
+} RouteSwitch_t;
+
+// a source or destination of the routes analyzed
+typedef struct RouteEndPort_s {
+	PortData	*portp;
+	uint32		port;		// port index
+	uint32		sw;			// switch where route enters fabric or ROUTE_NONE
+	uint32		entry;		// port index of entry port on sw
+} RouteEndPort_t;
+
+// a route to be reported via callback, in the order of the serial walk
+typedef struct RouteHit_s {
+	uint32		src;		// index in ends
+	uint32		dst;		// index in ends
+	uint16		offset;		// DLID is LID of dst | offset
+	uint16		seq;		// order of hits within the route
+	boolean		flag;		// isEntry or isUplink for ReportCallback_t
+} RouteHit_t;
+
+typedef struct RouteEngine_s {
+	RouteMode_t		mode;
+	boolean			fatTree;
+	uint32			reportPort;		// port index for ROUTE_MODE_REPORT
+	cl_hmap_t		nodeIndex;		// NodeData* -> 1 + port index of port 0
+	uint32			numPorts;
+	RoutePort_t		*ports;
+	uint32			numSwitches;
+	RouteSwitch_t	*switches;
+	uint32			numEnds;
+	RouteEndPort_t	*ends;
+	uint32			maxLidCount;	// largest 1<<LMC of ends
+	uint32			nextDst;		// next destination to analyze
+	boolean			abort;
+	pthread_mutex_t	lock;			// protects nextDst and abort
+} RouteEngine_t;
+
+typedef struct RouteThread_s {
+	RouteEngine_t	*enginep;
+	FabricData_t	*fabricp;
+	pthread_t		threadId;
+	FSTATUS			status;
+
+	// memo for current DLID indexed by switch, valid when stamp == serial
+	uint32			serial;
+	uint32			*stamp;
+	uint8			*end;			// RouteEnd_t
+	uint8			*hits;			// ROUTE_HIT_* for ROUTE_MODE_REPORT
+	uint32			*depth;			// switches to the end of the chain
+	uint32			*exit;			// port index or ROUTE_NONE if no exit
+	uint32			*next;			// switch index or ROUTE_NONE
+	uint32			*flow;			// routes through switch, for tabulate
+	uint32			*touched;		// switches resolved for current DLID
+	uint32			numTouched;
+	uint32			*work;			// resolve stack and tabulate order
+
+	// results
+	uint32			(*counts)[4];	// in field order of analysisData
+	uint32			totalPaths;
+	uint32			badPaths;
+	RouteHit_t		*hitList;
+	uint32			numHits;
+	uint32			hitListLength;
+} RouteThread_t;
+
+typedef struct RouteWalkContext_s {
+	RouteThread_t	*threadp;
+	uint32			src;
+	uint32			dst;
+	uint16			offset;
+	uint16			seq;
+} RouteWalkContext_t;
+
+static __inline uint32 RoutePortIndex(RouteEngine_t *enginep, PortData *portp)
+{
+	uint32 port0 = (uint32)(uintptr_t)cl_hmap_get(&enginep->nodeIndex,
+								(uint64)(uintptr_t)portp->nodep);
+	if (! port0 || portp->PortNum > portp->nodep->NodeInfo.NumPorts)
+		return ROUTE_NONE;
+	return port0 - 1 + portp->PortNum;
+}
+
+static __inline boolean RouteLidMatch(PortData *portp, IB_LID dlid)
+{
+	return (dlid >= portp->PortInfo.LID
+			&& dlid <= (portp->PortInfo.LID
+				 		| ((1<<portp->PortInfo.s1.LMC)-1)) );
+}
+
+static FSTATUS RouteAddHit(RouteThread_t *threadp, uint32 src, uint32 dst,
+						uint16 offset, uint16 seq, boolean flag)
+{
+	RouteHit_t *hitp;
+
+	if (threadp->numHits == threadp->hitListLength) {
+		uint32 length = threadp->hitListLength ? threadp->hitListLength * 2 : 1024;
+		RouteHit_t *hitList = (RouteHit_t *)MemoryAllocate2(length * sizeof(RouteHit_t),
+										IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		if (! hitList)
+			return FINSUFFICIENT_MEMORY;
+		if (threadp->hitList) {
+			MemoryCopy(hitList, threadp->hitList, threadp->numHits * sizeof(RouteHit_t));
+			MemoryDeallocate(threadp->hitList);
+		}
+		threadp->hitList = hitList;
+		threadp->hitListLength = length;
+	}
+	hitp = &threadp->hitList[threadp->numHits++];
+	hitp->src = src;
+	hitp->dst = dst;
+	hitp->offset = offset;
+	hitp->seq = seq;
+	hitp->flag = flag;
+	return FSUCCESS;
+}
+
+static int RouteHitCompare(const void *a, const void *b)
+{
+	const RouteHit_t *h1 = (const RouteHit_t *)a;
+	const RouteHit_t *h2 = (const RouteHit_t *)b;
+
+	if (h1->src != h2->src)
+		return h1->src < h2->src ? -1 : 1;
+	if (h1->dst != h2->dst)
+		return h1->dst < h2->dst ? -1 : 1;
+	if (h1->offset != h2->offset)
+		return h1->offset < h2->offset ? -1 : 1;
+	return (int)h1->seq - (int)h2->seq;
+}
+
+// add count routes entering or exiting a port, same as
+// TabulateRouteCallback and TabulateRouteCallbackFatTree
+static __inline void RouteCount(RouteThread_t *threadp, uint32 port,
+						boolean isEntry, uint32 count, boolean isBaseLid)
+{
+	RouteEngine_t *enginep = threadp->enginep;
+	uint32 i;
+
+	if (port == ROUTE_NONE)
+		return;
+	if (enginep->fatTree) {
+		if (isEntry)
+			return;
+		i = enginep->ports[port].uplink ? 1 : 0;	// uplink or downlink
+	} else {
+		i = isEntry ? 0 : 1;	// recv or xmit
+	}
+	threadp->counts[port][i+2] += count;
+	if (isBaseLid)
+		threadp->counts[port][i] += count;
+}
+
+// callback for routes which are walked one hop at a time
+static FSTATUS RouteWalkCallback(PortData *entryPortp, PortData *exitPortp, void *context)
+{
+	RouteWalkContext_t *walkp = (RouteWalkContext_t *)context;
+	RouteThread_t *threadp = walkp->threadp;
+	RouteEngine_t *enginep = threadp->enginep;
+	FSTATUS status = FSUCCESS;
+
+	switch (enginep->mode) {
+	case ROUTE_MODE_TABULATE:
+		if (entryPortp)
+			RouteCount(threadp, RoutePortIndex(enginep, entryPortp), TRUE, 1,
+						walkp->offset == 0);
+		if (exitPortp)
+			RouteCount(threadp, RoutePortIndex(enginep, exitPortp), FALSE, 1,
+						walkp->offset == 0);
+		break;
+	case ROUTE_MODE_REPORT:
+		if (! enginep->fatTree && entryPortp
+			&& RoutePortIndex(enginep, entryPortp) == enginep->reportPort)
+			status = RouteAddHit(threadp, walkp->src, walkp->dst, walkp->offset,
+						walkp->seq++, TRUE);
+		if (status == FSUCCESS && exitPortp
+			&& RoutePortIndex(enginep, exitPortp) == enginep->reportPort)
+			status = RouteAddHit(threadp, walkp->src, walkp->dst, walkp->offset,
+						walkp->seq++,
+						enginep->fatTree?enginep->ports[enginep->reportPort].uplink:FALSE);
+		break;
+	case ROUTE_MODE_VALIDATE:
+		break;
+	}
+	return status;
+}
+
+// walk a single route one hop at a time
+static void RouteWalk(RouteThread_t *threadp, uint32 src, uint32 dst,
+						uint16 offset, IB_LID dlid)
+{
+	RouteEngine_t *enginep = threadp->enginep;
+	PortData *portp = enginep->ends[src].portp;
+	RouteWalkContext_t walkContext = { threadp, src, dst, offset, 0 };
+	FSTATUS status;
+
+	if (portp->nodep->NodeInfo.NodeType != STL_NODE_SW && ! portp->neighbor) {
+		// no link, only the first device is in the route
+		status = RouteWalkCallback(NULL, portp, &walkContext);
+		if (status == FSUCCESS)
+			status = FNOT_DONE;
+	} else {
+		status = WalkRoutePort(threadp->fabricp, portp, dlid,
+						RouteWalkCallback, &walkContext);
+	}
+	if (status != FSUCCESS && status != FNOT_DONE) {
+		threadp->status = status;
+		return;
+	}
+	threadp->totalPaths++;
+	if (status != FSUCCESS) {
+		threadp->badPaths++;
+		if (enginep->mode == ROUTE_MODE_VALIDATE)
+			threadp->status = RouteAddHit(threadp, src, dst, offset, 0, FALSE);
+	}
+}
+
+// resolve the chain of hops from switch sw toward dlid
+static void RouteResolve(RouteThread_t *threadp, uint32 sw, IB_LID dlid)
+{
+	RouteEngine_t *enginep = threadp->enginep;
+	uint32 *stack = threadp->work;
+	uint32 numStack = 0;
+	uint32 s = sw;
+
+	while (threadp->stamp[s] != threadp->serial) {
+		RouteSwitch_t *swp = &enginep->switches[s];
+		SwitchData *switchp = swp->nodep->switchp;
+		RoutePort_t *exitp;
+		uint8 portNum;
+
+		threadp->stamp[s] = threadp->serial;
+		threadp->touched[threadp->numTouched++] = s;
+		stack[numStack++] = s;
+		threadp->end[s] = ROUTE_END_ACTIVE;
+		threadp->exit[s] = ROUTE_NONE;
+		threadp->next[s] = ROUTE_NONE;
+		threadp->flow[s] = 0;
+
+		if (! switchp || ! switchp->LinearFDB) {
+			threadp->end[s] = ROUTE_END_UNAVAILABLE;
+			break;
+		}
+		// same tests as LookupLFT
+		if (! dlid || dlid >= switchp->LinearFDBSize) {
+			threadp->end[s] = ROUTE_END_DEAD;
+			break;
+		}
+		portNum = STL_LFT_PORT_BLOCK(switchp->LinearFDB, dlid);
+		if (portNum == 0xff || portNum > swp->numPorts
+			|| ! enginep->ports[swp->port0 + portNum].viable) {
+			threadp->end[s] = ROUTE_END_DEAD;
+			break;
+		}
+		threadp->exit[s] = swp->port0 + portNum;
+		exitp = &enginep->ports[threadp->exit[s]];
+		if (portNum == 0) {
+			// at port 0 of switch
+			threadp->end[s] = RouteLidMatch(exitp->portp, dlid)
+								? ROUTE_END_OK : ROUTE_END_WRONG;
+			break;
+		}
+		if (exitp->peerSw == ROUTE_NONE) {
+			// at a device which is not a switch
+			threadp->end[s] = RouteLidMatch(exitp->portp->neighbor, dlid)
+								? ROUTE_END_OK : ROUTE_END_WRONG;
+			break;
+		}
+		threadp->next[s] = exitp->peerSw;
+		s = exitp->peerSw;
+	}
+
+	if (threadp->end[s] == ROUTE_END_ACTIVE) {
+		// chain loops back on itself, all of stack leads into the loop
+		while (numStack) {
+			s = stack[--numStack];
+			threadp->end[s] = ROUTE_END_LOOP;
+			threadp->depth[s] = 0;
+			threadp->hits[s] = 0;
+		}
+		return;
+	}
+
+	// unwind from end of chain, which may be a switch resolved earlier
+	while (numStack) {
+		uint32 t;
+		uint32 exit;
+		uint8 hits = 0;
+
+		s = stack[--numStack];
+		t = threadp->next[s];
+		exit = threadp->exit[s];
+		if (t == ROUTE_NONE) {
+			threadp->depth[s] = 1;
+		} else {
+			threadp->end[s] = threadp->end[t];
+			threadp->depth[s] = threadp->depth[t] + 1;
+		}
+		if (enginep->mode == ROUTE_MODE_REPORT && exit != ROUTE_NONE) {
+			uint32 peer = enginep->ports[exit].peer;
+
+			if (exit == enginep->reportPort)
+				hits |= ROUTE_HIT_EXIT;
+			if (t != ROUTE_NONE) {
+				// only counts as entry if next switch has an exit
+				if (peer == enginep->reportPort && threadp->exit[t] != ROUTE_NONE)
+					hits |= ROUTE_HIT_ENTRY;
+				hits |= threadp->hits[t];
+			} else if (peer == enginep->reportPort
+						&& threadp->end[s] == ROUTE_END_OK) {
+				hits |= ROUTE_HIT_ENTRY;	// last device in route
+			}
+		}
+		threadp->hits[s] = hits;
+	}
+}
+
+// account for route from src to dlid
+static void RouteSource(RouteThread_t *threadp, uint32 src, uint32 dst,
+						uint16 offset, IB_LID dlid)
+{
+	RouteEngine_t *enginep = threadp->enginep;
+	RouteEndPort_t *endp = &enginep->ends[src];
+	uint32 s = endp->sw;
+	boolean isFI = (endp->portp->nodep->NodeInfo.NodeType != STL_NODE_SW);
+
+	if (s != ROUTE_NONE && threadp->stamp[s] != threadp->serial)
+		RouteResolve(threadp, s, dlid);
+	if (s == ROUTE_NONE || threadp->end[s] == ROUTE_END_LOOP
+		|| threadp->depth[s] > ROUTE_MAX_HOPS) {
+		RouteWalk(threadp, src, dst, offset, dlid);
+		return;
+	}
+	if (threadp->end[s] == ROUTE_END_UNAVAILABLE) {
+		threadp->status = FUNAVAILABLE;
+		return;
+	}
+
+	threadp->totalPaths++;
+	if (threadp->end[s] != ROUTE_END_OK)
+		threadp->badPaths++;
+
+	switch (enginep->mode) {
+	case ROUTE_MODE_TABULATE:
+		// rest of route is counted by RouteTabulateFlows
+		RouteCount(threadp, endp->port, FALSE, 1, offset == 0);
+		if (threadp->exit[s] != ROUTE_NONE) {
+			RouteCount(threadp, endp->entry, TRUE, 1, offset == 0);
+			threadp->flow[s]++;
+		}
+		break;
+	case ROUTE_MODE_REPORT:
+		if (isFI && endp->port == enginep->reportPort)
+			threadp->status = RouteAddHit(threadp, src, dst, offset, 0,
+						enginep->fatTree?enginep->ports[endp->port].uplink:FALSE);
+		if (threadp->status == FSUCCESS && ! enginep->fatTree
+			&& ((endp->entry == enginep->reportPort
+					&& threadp->exit[s] != ROUTE_NONE)
+				|| (threadp->hits[s] & ROUTE_HIT_ENTRY)))
+			threadp->status = RouteAddHit(threadp, src, dst, offset, 1, TRUE);
+		if (threadp->status == FSUCCESS && (threadp->hits[s] & ROUTE_HIT_EXIT))
+			threadp->status = RouteAddHit(threadp, src, dst, offset, 2,
+						enginep->fatTree?enginep->ports[enginep->reportPort].uplink:FALSE);
+		break;
+	case ROUTE_MODE_VALIDATE:
+		if (threadp->end[s] != ROUTE_END_OK)
+			threadp->status = RouteAddHit(threadp, src, dst, offset, 0, FALSE);
+		break;
+	}
+}
+
+// count the routes to the current DLID along each switch chain.  Switches
+// farthest from the end of their chain go first, so each switch has all its
+// routes before they are passed on to the next switch.
+static void RouteTabulateFlows(RouteThread_t *threadp, boolean isBaseLid)
+{
+	RouteEngine_t *enginep = threadp->enginep;
+	uint32 start[ROUTE_MAX_HOPS+2];
+	uint32 *order = threadp->work;
+	uint32 i, d, num = 0;
+
+	MemoryClear(start, sizeof(start));
+	for (i=0; i < threadp->numTouched; i++) {
+		uint32 s = threadp->touched[i];
+		if (threadp->end[s] != ROUTE_END_LOOP && threadp->depth[s] <= ROUTE_MAX_HOPS)
+			start[threadp->depth[s]]++;
+	}
+	for (d=ROUTE_MAX_HOPS; d > 0; d--) {
+		uint32 count = start[d];
+		start[d] = num;
+		num += count;
+	}
+	for (i=0; i < threadp->numTouched; i++) {
+		uint32 s = threadp->touched[i];
+		if (threadp->end[s] != ROUTE_END_LOOP && threadp->depth[s] <= ROUTE_MAX_HOPS)
+			order[start[threadp->depth[s]]++] = s;
+	}
+
+	for (i=0; i < num; i++) {
+		uint32 s = order[i];
+		uint32 flow = threadp->flow[s];
+		uint32 exit = threadp->exit[s];
+		uint32 t = threadp->next[s];
+
+		if (! flow || exit == ROUTE_NONE)
+			continue;
+		RouteCount(threadp, exit, FALSE, flow, isBaseLid);
+		if (t != ROUTE_NONE) {
+			if (threadp->exit[t] != ROUTE_NONE) {
+				RouteCount(threadp, enginep->ports[exit].peer, TRUE, flow, isBaseLid);
+				threadp->flow[t] += flow;
+			}
+		} else if (threadp->end[s] == ROUTE_END_OK
+					&& enginep->ports[exit].portp->PortNum != 0) {
+			RouteCount(threadp, enginep->ports[exit].peer, TRUE, flow, isBaseLid);
+		}
+	}
+}
+
+// analyze all routes to one destination
+static void RouteDestination(RouteThread_t *threadp, uint32 dst)
+{
+	RouteEngine_t *enginep = threadp->enginep;
+	PortData *portp2 = enginep->ends[dst].portp;
+	IB_LID offset;
+	IB_LID count;
+	uint32 src;
+
+	// TabulateRoutes and ReportRoutes use the LMC of the source,
+	// ValidateRoutes uses the LMC of the destination
+	if (enginep->mode == ROUTE_MODE_VALIDATE)
+		count = (1<<portp2->PortInfo.s1.LMC);
+	else
+		count = enginep->maxLidCount;
+
+	for (offset = 0; offset < count; offset++) {
+		IB_LID dlid = portp2->PortInfo.LID|offset;
+
+		threadp->serial++;
+		threadp->numTouched = 0;
+		for (src=0; src < enginep->numEnds; src++) {
+			// skip loopback paths
+			if (src == dst)
+				continue;
+			if (enginep->mode != ROUTE_MODE_VALIDATE
+				&& offset >= (1<<enginep->ends[src].portp->PortInfo.s1.LMC))
+				continue;
+			RouteSource(threadp, src, dst, offset, dlid);
+			if (threadp->status != FSUCCESS)
+				return;
+		}
+		if (enginep->mode == ROUTE_MODE_TABULATE)
+			RouteTabulateFlows(threadp, offset == 0);
+	}
+}
+
+static void *RouteEngineThread(void *context)
+{
+	RouteThread_t *threadp = (RouteThread_t *)context;
+	RouteEngine_t *enginep = threadp->enginep;
+	uint32 dst;
+
+	while (1) {
+		pthread_mutex_lock(&enginep->lock);
+		if (threadp->status != FSUCCESS)
+			enginep->abort = TRUE;
+		if (enginep->abort || enginep->nextDst >= enginep->numEnds)
+			dst = ROUTE_NONE;
+		else
+			dst = enginep->nextDst++;
+		pthread_mutex_unlock(&enginep->lock);
+		if (dst == ROUTE_NONE)
+			break;
+		RouteDestination(threadp, dst);
+	}
+	return NULL;
+}
+
+static void RouteEngineAddEnd(RouteEngine_t *enginep, PortData *portp)
+{
+	RouteEndPort_t *endp = &enginep->ends[enginep->numEnds++];
+	uint32 lidCount = (1<<portp->PortInfo.s1.LMC);
+
+	endp->portp = portp;
+	endp->port = RoutePortIndex(enginep, portp);
+	endp->sw = ROUTE_NONE;
+	endp->entry = ROUTE_NONE;
+	if (endp->port != ROUTE_NONE) {
+		RoutePort_t *rportp = &enginep->ports[endp->port];
+		if (rportp->sw != ROUTE_NONE) {
+			// route starts at port 0 of switch
+			endp->sw = rportp->sw;
+			endp->entry = endp->port;
+		} else if (rportp->peer != ROUTE_NONE
+					&& enginep->ports[rportp->peer].sw != ROUTE_NONE) {
+			endp->sw = enginep->ports[rportp->peer].sw;
+			endp->entry = rportp->peer;
+		}
+	}
+	if (lidCount > enginep->maxLidCount)
+		enginep->maxLidCount = lidCount;
+}
+
+static void RouteEngineDestroy(RouteEngine_t *enginep)
+{
+	if (enginep->ports)
+		MemoryDeallocate(enginep->ports);
+	if (enginep->switches)
+		MemoryDeallocate(enginep->switches);
+	if (enginep->ends)
+		MemoryDeallocate(enginep->ends);
+	cl_hmap_destroy(&enginep->nodeIndex);
+	pthread_mutex_destroy(&enginep->lock);
+}
+
+// number all the ports and switches in the fabric and list the sources
+// and destinations to be analyzed.  For fat tree, the switch tiers
+// must already be determined.
+static FSTATUS RouteEngineInit(RouteEngine_t *enginep, FabricData_t *fabricp,
+						RouteMode_t mode, PortData *reportPort, boolean fatTree)
+{
+	cl_map_item_t *n;
+	cl_map_item_t *p;
+	LIST_ITEM *l;
+	uint32 i, numEnds = 0;
+	FSTATUS status;
+
+	MemoryClear(enginep, sizeof(*enginep));
+	enginep->mode = mode;
+	enginep->fatTree = fatTree;
+	enginep->reportPort = ROUTE_NONE;
+	cl_hmap_init(&enginep->nodeIndex, NULL, NULL, NULL);
+	pthread_mutex_init(&enginep->lock, NULL);
+
+	// each node has NumPorts+1 consecutive port indexes, starting at port 0
+	for (n=cl_qmap_head(&fabricp->AllNodes); n != cl_qmap_end(&fabricp->AllNodes); n = cl_qmap_next(n)) {
+		NodeData *nodep = PARENT_STRUCT(n, NodeData, AllNodesEntry);
+
+		status = cl_hmap_insert(&enginep->nodeIndex, (uint64)(uintptr_t)nodep,
+							(void *)(uintptr_t)(enginep->numPorts+1));
+		if (status != FSUCCESS)
+			goto fail;
+		enginep->numPorts += nodep->NodeInfo.NumPorts+1;
+		if (nodep->NodeInfo.NodeType == STL_NODE_SW)
+			enginep->numSwitches++;
+		else if (mode == ROUTE_MODE_VALIDATE)
+			numEnds += cl_qmap_count(&nodep->Ports);
+	}
+	if (mode == ROUTE_MODE_VALIDATE) {
+		numEnds += enginep->numSwitches;	// port 0 of each switch
+	} else {
+		for (l=QListHead(&fabricp->AllFIs); l != NULL; l = QListNext(&fabricp->AllFIs, l)) {
+			NodeData *nodep = (NodeData *)QListObj(l);
+			numEnds += cl_qmap_count(&nodep->Ports);
+		}
+	}
+
+	enginep->ports = (RoutePort_t *)MemoryAllocate2AndClear(
+						(enginep->numPorts+1) * sizeof(RoutePort_t),
+						IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+	enginep->switches = (RouteSwitch_t *)MemoryAllocate2AndClear(
+						(enginep->numSwitches+1) * sizeof(RouteSwitch_t),
+						IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+	enginep->ends = (RouteEndPort_t *)MemoryAllocate2AndClear(
+						(numEnds+1) * sizeof(RouteEndPort_t),
+						IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+	if (! enginep->ports || ! enginep->switches || ! enginep->ends) {
+		status = FINSUFFICIENT_MEMORY;
+		goto fail;
+	}
+
+	enginep->numSwitches = 0;
+	for (n=cl_qmap_head(&fabricp->AllNodes); n != cl_qmap_end(&fabricp->AllNodes); n = cl_qmap_next(n)) {
+		NodeData *nodep = PARENT_STRUCT(n, NodeData, AllNodesEntry);
+		uint32 port0 = (uint32)(uintptr_t)cl_hmap_get(&enginep->nodeIndex,
+								(uint64)(uintptr_t)nodep) - 1;
+		uint32 sw = ROUTE_NONE;
+
+		if (nodep->NodeInfo.NodeType == STL_NODE_SW) {
+			sw = enginep->numSwitches++;
+			enginep->switches[sw].nodep = nodep;
+			enginep->switches[sw].port0 = port0;
+			enginep->switches[sw].numPorts = nodep->NodeInfo.NumPorts;
+		}
+		for (i=0; i <= nodep->NodeInfo.NumPorts; i++) {
+			enginep->ports[port0+i].sw = sw;
+			enginep->ports[port0+i].peer = ROUTE_NONE;
+			enginep->ports[port0+i].peerSw = ROUTE_NONE;
+		}
+		for (p=cl_qmap_head(&nodep->Ports); p != cl_qmap_end(&nodep->Ports); p = cl_qmap_next(p)) {
+			PortData *portp = PARENT_STRUCT(p, PortData, NodePortsEntry);
+			RoutePort_t *rportp;
+
+			if (portp->PortNum > nodep->NodeInfo.NumPorts)
+				continue;
+			rportp = &enginep->ports[port0 + portp->PortNum];
+			rportp->portp = portp;
+			rportp->viable = (IsPortInitialized(portp->PortInfo.PortStates)
+							&& (portp->PortNum == 0 || portp->neighbor));
+			rportp->uplink = (portp->neighbor
+						&& nodep->analysis < portp->neighbor->nodep->analysis);
+		}
+	}
+	for (i=0; i < enginep->numPorts; i++) {
+		RoutePort_t *rportp = &enginep->ports[i];
+
+		if (! rportp->portp || ! rportp->portp->neighbor)
+			continue;
+		rportp->peer = RoutePortIndex(enginep, rportp->portp->neighbor);
+		if (rportp->peer != ROUTE_NONE)
+			rportp->peerSw = enginep->ports[rportp->peer].sw;
+	}
+	if (reportPort)
+		enginep->reportPort = RoutePortIndex(enginep, reportPort);
+
+	// sources and destinations, in the order the serial loops used
+	if (mode == ROUTE_MODE_VALIDATE) {
+		for (n=cl_qmap_head(&fabricp->AllNodes); n != cl_qmap_end(&fabricp->AllNodes); n = cl_qmap_next(n)) {
+			NodeData *nodep = PARENT_STRUCT(n, NodeData, AllNodesEntry);
+			for (p=cl_qmap_head(&nodep->Ports); p != cl_qmap_end(&nodep->Ports); p = cl_qmap_next(p)) {
+				PortData *portp = PARENT_STRUCT(p, PortData, NodePortsEntry);
+				// only port 0 of a switch has a LID
+				if (nodep->NodeInfo.NodeType == STL_NODE_SW && portp->PortNum != 0)
+					continue;
+				if (enginep->numEnds < numEnds)
+					RouteEngineAddEnd(enginep, portp);
+			}
+		}
+	} else {
+		for (l=QListHead(&fabricp->AllFIs); l != NULL; l = QListNext(&fabricp->AllFIs, l)) {
+			NodeData *nodep = (NodeData *)QListObj(l);
+			for (p=cl_qmap_head(&nodep->Ports); p != cl_qmap_end(&nodep->Ports); p = cl_qmap_next(p)) {
+				PortData *portp = PARENT_STRUCT(p, PortData, NodePortsEntry);
+				RouteEngineAddEnd(enginep, portp);
+			}
+		}
+	}
+	return FSUCCESS;
+
+fail:
+	fprintf(stderr, "%s: Unable to allocate memory\n", g_Top_cmdname);
+	RouteEngineDestroy(enginep);
+	return status;
+}
+
+static void RouteThreadsFree(RouteThread_t *threads, uint32 numThreads)
+{
+	uint32 t;
+
+	for (t=0; t < numThreads; t++) {
+		RouteThread_t *threadp = &threads[t];
+		void *mem[] = { threadp->stamp, threadp->end, threadp->hits,
+						threadp->depth, threadp->exit, threadp->next,
+						threadp->flow, threadp->touched, threadp->work,
+						threadp->counts, threadp->hitList };
+		unsigned i;
+
+		for (i=0; i < sizeof(mem)/sizeof(mem[0]); i++) {
+			if (mem[i])
+				MemoryDeallocate(mem[i]);
+		}
+	}
+	MemoryDeallocate(threads);
+}
+
+// run the analysis on worker threads.  On success caller must merge the
+// results and free *pThreads with RouteThreadsFree
+static FSTATUS RouteEngineRun(RouteEngine_t *enginep, FabricData_t *fabricp,
+						RouteThread_t **pThreads, uint32 *pNumThreads)
+{
+	RouteThread_t *threads;
+	uint32 numThreads = ROUTE_MAX_THREADS;
+	uint32 numStarted = 0;
+	uint32 t;
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	FSTATUS status = FSUCCESS;
+
+	if (cpus > 0 && cpus < numThreads)
+		numThreads = cpus;
+	if (enginep->numEnds < numThreads)
+		numThreads = enginep->numEnds;
+	if (! numThreads)
+		numThreads = 1;
+
+	threads = (RouteThread_t *)MemoryAllocate2AndClear(numThreads * sizeof(RouteThread_t),
+						IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+	if (! threads)
+		goto nomem;
+	for (t=0; t < numThreads; t++) {
+		RouteThread_t *threadp = &threads[t];
+		uint32 size = (enginep->numSwitches+1) * sizeof(uint32);
+
+		threadp->enginep = enginep;
+		threadp->fabricp = fabricp;
+		threadp->status = FSUCCESS;
+		threadp->stamp = (uint32 *)MemoryAllocate2AndClear(size, IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		threadp->end = (uint8 *)MemoryAllocate2AndClear(enginep->numSwitches+1, IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		threadp->hits = (uint8 *)MemoryAllocate2AndClear(enginep->numSwitches+1, IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		threadp->depth = (uint32 *)MemoryAllocate2AndClear(size, IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		threadp->exit = (uint32 *)MemoryAllocate2AndClear(size, IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		threadp->next = (uint32 *)MemoryAllocate2AndClear(size, IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		threadp->flow = (uint32 *)MemoryAllocate2AndClear(size, IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		threadp->touched = (uint32 *)MemoryAllocate2AndClear(size, IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		threadp->work = (uint32 *)MemoryAllocate2AndClear(size, IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		if (! threadp->stamp || ! threadp->end || ! threadp->hits
+			|| ! threadp->depth || ! threadp->exit || ! threadp->next
+			|| ! threadp->flow || ! threadp->touched || ! threadp->work)
+			goto nomem;
+		if (enginep->mode == ROUTE_MODE_TABULATE) {
+			threadp->counts = (uint32 (*)[4])MemoryAllocate2AndClear(
+						(enginep->numPorts+1) * sizeof(threadp->counts[0]),
+						IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+			if (! threadp->counts)
+				goto nomem;
+		}
+	}
+
+	for (t=0; t < numThreads; t++) {
+		if (pthread_create(&threads[t].threadId, NULL, RouteEngineThread, &threads[t]))
+			break;
+		numStarted++;
+	}
+	if (! numStarted) {
+		// no threads available, do the work here instead
+		(void)RouteEngineThread(&threads[0]);
+	} else {
+		for (t=0; t < numStarted; t++)
+			pthread_join(threads[t].threadId, NULL);
+	}
+	for (t=0; t < numThreads; t++) {
+		if (threads[t].status != FSUCCESS) {
+			status = threads[t].status;
+			if (status == FUNAVAILABLE)
+				break;
+		}
+	}
+	if (status != FSUCCESS) {
+		if (status == FINSUFFICIENT_MEMORY)
+			fprintf(stderr, "%s: Unable to allocate memory\n", g_Top_cmdname);
+		RouteThreadsFree(threads, numThreads);
+		return status;
+	}
+	*pThreads = threads;
+	*pNumThreads = numThreads;
+	return FSUCCESS;
+
+nomem:
+	fprintf(stderr, "%s: Unable to allocate memory\n", g_Top_cmdname);
+	if (threads)
+		RouteThreadsFree(threads, numThreads);
+	return FINSUFFICIENT_MEMORY;
+}
+
+// merge the hits from all threads in the order of a serial walk.
+// caller must free *pHitList
+static FSTATUS RouteMergeHits(RouteThread_t *threads, uint32 numThreads,
+						RouteHit_t **pHitList, uint32 *pNumHits)
+{
+	RouteHit_t *hitList;
+	uint32 t, numHits = 0;
+
+	for (t=0; t < numThreads; t++)
+		numHits += threads[t].numHits;
+	hitList = (RouteHit_t *)MemoryAllocate2((numHits+1) * sizeof(RouteHit_t),
+						IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+	if (! hitList) {
+		fprintf(stderr, "%s: Unable to allocate memory\n", g_Top_cmdname);
+		return FINSUFFICIENT_MEMORY;
+	}
+	numHits = 0;
+	for (t=0; t < numThreads; t++) {
+		if (threads[t].numHits)
+			MemoryCopy(&hitList[numHits], threads[t].hitList,
+						threads[t].numHits * sizeof(RouteHit_t));
+		numHits += threads[t].numHits;
+	}
+	qsort(hitList, numHits, sizeof(RouteHit_t), RouteHitCompare);
+	*pHitList = hitList;
+	*pNumHits = numHits;
+	return FSUCCESS;
+}
+
 
 // tabulate all the routes between FIs, exclude loopback routes
 FSTATUS TabulateCARoutes(FabricData_t *fabricp, uint32 *totalPaths,
 							uint32 *badPaths, boolean fatTree)
 {
-	LIST_ITEM *n1, *n2;
-	cl_map_item_t *p1, *p2;
+	RouteEngine_t engine;
+	RouteThread_t *threads;
+	uint32 numThreads;
+	uint32 i, t;
 	FSTATUS status;
-	uint32 pathCount, badPathCount;
 
 	*totalPaths = 0;
 	*badPaths = 0;
@@ -518,37 +1349,42 @@ FSTATUS TabulateCARoutes(FabricData_t *fabricp, uint32 *totalPaths,
 	if (fatTree)
 		DetermineSwitchTiers(fabricp);
 
-	// TBD - because IB is DLID routed, can save effort by getting routes from
-	// 1 FI per switch to all other FIs (or all FIs on other switches) and
-	// then multiply the result for that FI by the number of FIs on that switch
-	// In a pure fattree such an approach would reduce N*N to (N/18)*(N/18)
-	// so it would have a 18*18 reduction in effort, provided the cost of
-	// finding FIs is not to high, maybe we can loop here based on all switches?
-	for (n1=QListHead(&fabricp->AllFIs); n1 != NULL; n1 = QListNext(&fabricp->AllFIs, n1)) {
-		NodeData *nodep1 = (NodeData *)QListObj(n1);
-		for (p1=cl_qmap_head(&nodep1->Ports); p1 != cl_qmap_end(&nodep1->Ports); p1 = cl_qmap_next(p1)) {
-			PortData *portp1 = PARENT_STRUCT(p1, PortData, NodePortsEntry);
-
-			for (n2=QListHead(&fabricp->AllFIs); n2 != NULL; n2 = QListNext(&fabricp->AllFIs, n2)) {
-				NodeData *nodep2 = (NodeData *)QListObj(n2);
-
-				// enable this if we want to skip node to self paths
-				//if (nodep1 == nodep2) continue;
-
-				for (p2=cl_qmap_head(&nodep2->Ports); p2 != cl_qmap_end(&nodep2->Ports); p2 = cl_qmap_next(p2)) {
-					PortData *portp2 = PARENT_STRUCT(p2, PortData, NodePortsEntry);
-					// skip loopback paths
-					if (portp1 == portp2) continue;
-					status = TabulateRoutes(fabricp, portp1, portp2, &pathCount, &badPathCount, fatTree);
-					if (status == FUNAVAILABLE)
-						return status;
-					*totalPaths += pathCount;
-					*badPaths += badPathCount;
-				}
+	status = RouteEngineInit(&engine, fabricp, ROUTE_MODE_TABULATE, NULL, fatTree);
+	if (status != FSUCCESS)
+		return status;
+	status = RouteEngineRun(&engine, fabricp, &threads, &numThreads);
+	if (status == FSUCCESS) {
+		for (i=0; i < engine.numPorts; i++) {
+			PortData *portp = engine.ports[i].portp;
+			uint32 counts[4] = { 0, 0, 0, 0 };
+			uint32 k;
+
+			if (! portp)
+				continue;
+			for (t=0; t < numThreads; t++) {
+				for (k=0; k < 4; k++)
+					counts[k] += threads[t].counts[i][k];
+			}
+			if (fatTree) {
+				portp->analysisData.fatTreeRoutes.downlinkBasePaths += counts[0];
+				portp->analysisData.fatTreeRoutes.uplinkBasePaths += counts[1];
+				portp->analysisData.fatTreeRoutes.downlinkAllPaths += counts[2];
+				portp->analysisData.fatTreeRoutes.uplinkAllPaths += counts[3];
+			} else {
+				portp->analysisData.routes.recvBasePaths += counts[0];
+				portp->analysisData.routes.xmitBasePaths += counts[1];
+				portp->analysisData.routes.recvAllPaths += counts[2];
+				portp->analysisData.routes.xmitAllPaths += counts[3];
 			}
 		}
+		for (t=0; t < numThreads; t++) {
+			*totalPaths += threads[t].totalPaths;
+			*badPaths += threads[t].badPaths;
+		}
+		RouteThreadsFree(threads, numThreads);
 	}
-	return FSUCCESS;
+	RouteEngineDestroy(&engine);
+	return status;
 }
 
 typedef struct ReportContext_s {
@@ -645,41 +1481,36 @@ FSTATUS ReportCARoutes(FabricData_t *fabricp,
 			   				PortData *reportPort, ReportCallback_t callback,
 							void *context, boolean fatTree)
 {
-	LIST_ITEM *n1, *n2;
-	cl_map_item_t *p1, *p2;
+	RouteEngine_t engine;
+	RouteThread_t *threads;
+	RouteHit_t *hitList;
+	uint32 numThreads, numHits;
+	uint32 i;
 	FSTATUS status;
 
-	// TBD - because IB is DLID routed, can save effort by getting routes from
-	// 1 FI per switch to all other FIs (or all FIs on other switches) and
-	// then multiply the result for that FI by the number of FIs on that switch
-	// In a pure fattree such an approach would reduce N*N to (N/18)*(N/18)
-	// so it would have a 18*18 reduction in effort, provided the cost of
-	// finding FIs is not to high, maybe we can loop here based on all switches?
-	for (n1=QListHead(&fabricp->AllFIs); n1 != NULL; n1 = QListNext(&fabricp->AllFIs, n1)) {
-		NodeData *nodep1 = (NodeData *)QListObj(n1);
-		for (p1=cl_qmap_head(&nodep1->Ports); p1 != cl_qmap_end(&nodep1->Ports); p1 = cl_qmap_next(p1)) {
-			PortData *portp1 = PARENT_STRUCT(p1, PortData, NodePortsEntry);
-
-			for (n2=QListHead(&fabricp->AllFIs); n2 != NULL; n2 = QListNext(&fabricp->AllFIs, n2)) {
-				NodeData *nodep2 = (NodeData *)QListObj(n2);
-
-				// enable this if we want to skip node to self paths
-				//if (nodep1 == nodep2) continue;
-
-				for (p2=cl_qmap_head(&nodep2->Ports); p2 != cl_qmap_end(&nodep2->Ports); p2 = cl_qmap_next(p2)) {
-					PortData *portp2 = PARENT_STRUCT(p2, PortData, NodePortsEntry);
-					// skip loopback paths
-					if (portp1 == portp2) continue;
-					status = ReportRoutes(fabricp, portp1, portp2, reportPort, callback, context, fatTree);
-					if (status == FUNAVAILABLE)
-						return status;
-					// TabulateRoutes reports bad paths and will have been used
-					// prior to this, so no need to report FNOT_DONE routes
-				}
-			}
+	status = RouteEngineInit(&engine, fabricp, ROUTE_MODE_REPORT, reportPort, fatTree);
+	if (status != FSUCCESS)
+		return status;
+	status = RouteEngineRun(&engine, fabricp, &threads, &numThreads);
+	if (status == FSUCCESS) {
+		status = RouteMergeHits(threads, numThreads, &hitList, &numHits);
+		RouteThreadsFree(threads, numThreads);
+	}
+	if (status == FSUCCESS) {
+		// TabulateRoutes reports bad paths and will have been used
+		// prior to this, so no need to report FNOT_DONE routes
+		for (i=0; i < numHits; i++) {
+			RouteHit_t *hitp = &hitList[i];
+			PortData *portp2 = engine.ends[hitp->dst].portp;
+
+			(*callback)(engine.ends[hitp->src].portp, portp2,
+						portp2->PortInfo.LID|hitp->offset, hitp->offset == 0,
+						hitp->flag, context);
 		}
+		MemoryDeallocate(hitList);
 	}
-	return FSUCCESS;
+	RouteEngineDestroy(&engine);
+	return status;
 }
 
 
@@ -777,47 +1608,52 @@ FSTATUS ValidateAllRoutes(FabricData_t *fabricp,
 			   				ValidateCallback_t callback, void *context,
 			   				ValidateCallback2_t callback2, void *context2)
 {
-	cl_map_item_t *n1, *n2;
-	cl_map_item_t *p1, *p2;
+	RouteEngine_t engine;
+	RouteThread_t *threads;
+	RouteHit_t *hitList;
+	uint32 numThreads, numHits;
+	uint32 i, t;
 	FSTATUS status;
-	uint32 pathCount, badPathCount;
+	ValidateContext2_t ValidateContext2 ={callback:callback2, context:context2};
 
 	*totalPaths = 0;
 	*badPaths = 0;
 
-	for (n1=cl_qmap_head(&fabricp->AllNodes); n1 != cl_qmap_end(&fabricp->AllNodes); n1 = cl_qmap_next(n1)) {
-		NodeData *nodep1 = PARENT_STRUCT(n1, NodeData, AllNodesEntry);
-		for (p1=cl_qmap_head(&nodep1->Ports); p1 != cl_qmap_end(&nodep1->Ports); p1 = cl_qmap_next(p1)) {
-			PortData *portp1 = PARENT_STRUCT(p1, PortData, NodePortsEntry);
-			if (nodep1->NodeInfo.NodeType == STL_NODE_SW && portp1->PortNum != 0) {
-				// only port 0 of a switch has a LID
-				continue;
-			}
-
-			for (n2=cl_qmap_head(&fabricp->AllNodes); n2 != cl_qmap_end(&fabricp->AllNodes); n2 = cl_qmap_next(n2)) {
-				NodeData *nodep2 = PARENT_STRUCT(n2, NodeData, AllNodesEntry);
-
-				// enable this if we want to skip node to self paths
-				//if (nodep1 == nodep2) continue;
-
-				for (p2=cl_qmap_head(&nodep2->Ports); p2 != cl_qmap_end(&nodep2->Ports); p2 = cl_qmap_next(p2)) {
-					PortData *portp2 = PARENT_STRUCT(p2, PortData, NodePortsEntry);
-					if (nodep2->NodeInfo.NodeType == STL_NODE_SW && portp2->PortNum != 0) {
-						// only port 0 of a switch has a LID
-						continue;
-					}
-					// skip loopback paths
-					if (portp1 == portp2) continue;
-					status = ValidateRoutes(fabricp, portp1, portp2, &pathCount, &badPathCount, callback, context, callback2, context2);
-					if (status == FUNAVAILABLE)
-						return status;
-					(*totalPaths) += pathCount;
-					(*badPaths) += badPathCount;
-				}
+	status = RouteEngineInit(&engine, fabricp, ROUTE_MODE_VALIDATE, NULL, FALSE);
+	if (status != FSUCCESS)
+		return status;
+	status = RouteEngineRun(&engine, fabricp, &threads, &numThreads);
+	if (status == FSUCCESS) {
+		for (t=0; t < numThreads; t++) {
+			*totalPaths += threads[t].totalPaths;
+			*badPaths += threads[t].badPaths;
+		}
+		status = RouteMergeHits(threads, numThreads, &hitList, &numHits);
+		RouteThreadsFree(threads, numThreads);
+	}
+	if (status == FSUCCESS) {
+		for (i=0; i < numHits; i++) {
+			RouteHit_t *hitp = &hitList[i];
+			PortData *portp1 = engine.ends[hitp->src].portp;
+			PortData *portp2 = engine.ends[hitp->dst].portp;
+
+			(*callback)(portp1, portp2, portp2->PortInfo.LID|hitp->offset,
+					   	hitp->offset == 0, context);
+			if (callback2) {
+				// re-walk route and output details of each hop
+				// same as ValidateRoutes, this uses the base LID
+				if (portp1->nodep->NodeInfo.NodeType == STL_NODE_SW
+					|| portp1->neighbor)
+					(void)WalkRoutePort(fabricp, portp1,
+							portp2->PortInfo.LID,
+							ValidateRouteCallback2, &ValidateContext2);
+				(*callback2)(NULL, context2);	// close out path
 			}
 		}
+		MemoryDeallocate(hitList);
 	}
-	return FSUCCESS;
+	RouteEngineDestroy(&engine);
+	return status;
 }
 
 #ifndef __VXWORKS__
@@ -1105,7 +1941,7 @@ FSTATUS ValidateAllCreditLoopRoutes(FabricData_t *fabricp, EUI64 portGuid,
    /* build graphical layout of all the routes */
    //PYTHON: full_graph = build_routing_graph(fabric)
    if (!CLFabricDataBuildRouteGraph(fabricp, routeSummaryCallback, timeGetCallback, cp)) {
-      clGraphData_t *graphp; 
+      clGraphCycles_t cycleInfo; 
       
       if (detail >= 3) {
          //PYTHON: full_graph.summary('Full graph')
@@ -1121,50 +1957,19 @@ FSTATUS ValidateAllCreditLoopRoutes(FabricData_t *fabricp, EUI64 portGuid,
          (void)CLGraphDataSummary(&fabricp->Graph, (xmlFmt) ? "PrunedGraph" : "Pruned graph", dataSummaryCallback, cp);
       }
       
-      /* split the graph data */
-      //PYTHON: split_graph = pruned_graph.split()
-      if (!(graphp = CLGraphDataSplit(&fabricp->Graph, detail))) {
-         if (!xmlFmt) 
-            printf("Routes are deadlock free (No credit loops detected)\n");
-      } else {
-         int count = 0; 
-         char title[100]; 
-         clDijkstraDistancesAndRoutes_t dijkstraInfo; 
-         
-         if (!xmlFmt) 
-            printf("Deadlock detected in routes (Credit loops detected)\n"); 
-         memset(&dijkstraInfo, 0, sizeof(dijkstraInfo)); 
-         
-         //PYTHON: while split_graph :
-         while (graphp) {
-            if (detail >= 3) {
-               if (xmlFmt) 
-                  sprintf(title, "SplitGraph%d", count); 
-               else 
-                  sprintf(title, "Split graph %d", count); 
-               //PYTHON: split_graph.summary('Split graph %d' % count)
-               (void)CLGraphDataSummary(graphp, title, dataSummaryCallback, cp); 
-            }
-            
-            /* find route distances via Dijkstra algorithm */
-            //PYTHON: (distances, routes) = find_distances_and_routes_dijkstra(split_graph)
-            if (CLDijkstraFindDistancesAndRoutes(graphp, &dijkstraInfo, detail)) 
-               break; 
-            else {
-               //PYTHON: find_cycles(split_graph, distances, routes, ib_connection_source_to_str)
-               (void)CLDijkstraFindCycles(fabricp, graphp, &dijkstraInfo, 
-                                          linkSummaryCallback, linkStepSummaryCallback, 
-                                          pathSummaryCallback, cp); 
-               /* free existing distances and routes relaed data */
-               (void)CLDijkstraFreeDistancesAndRoutes(&dijkstraInfo); 
-               //PYTHON: split_graph = pruned_graph.split()
-               graphp = CLGraphDataSplit(&fabricp->Graph, detail);
-            }
-            count += 1;
+      /* find the cycles in the graph data */
+      if (!CLGraphDataFindCycles(&fabricp->Graph, &cycleInfo, detail)) {
+         if (!cycleInfo.numComponents) {
+            if (!xmlFmt) 
+               printf("Routes are deadlock free (No credit loops detected)\n");
+         } else {
+            if (!xmlFmt) 
+               printf("Deadlock detected in routes (Credit loops detected)\n"); 
+            (void)CLGraphDataCyclesSummary(fabricp, &fabricp->Graph, &cycleInfo, dataSummaryCallback, 
+                                           linkSummaryCallback, linkStepSummaryCallback, 
+                                           pathSummaryCallback, cp);
          }
-         
-         if (detail >= 3 && count > 1) 
-            printf("Dependencies split into %d disconnected graphs\n", count);
+         (void)CLGraphDataFreeCycles(&cycleInfo);
       }
       
       // free all credit loop related data
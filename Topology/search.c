@@ -94,26 +94,13 @@ PortData * FindLid(FabricData_t *fabricp, uint16 lid)
 // search for the PortData corresponding to the given port Guid
 PortData * FindPortGuid(FabricData_t *fabricp, EUI64 guid)
 {
-	LIST_ITEM *p;
-
-	for (p=QListHead(&fabricp->AllPorts); p != NULL; p = QListNext(&fabricp->AllPorts, p)) {
-		PortData *portp = (PortData *)QListObj(p);
-
-		if (portp->PortGUID == guid)
-			return portp;
-	}
-	return NULL;
+	return (PortData *)cl_hmap_get(&fabricp->AllPortGuids, guid);
 }
 
 // search for the NodeData corresponding to the given node Guid
 NodeData * FindNodeGuid(const FabricData_t *fabricp, EUI64 guid)
 {
-	cl_map_item_t *mi;
-
-	mi = cl_qmap_get(&fabricp->AllNodes, guid);
-	if (mi == cl_qmap_end(&fabricp->AllNodes))
-		return NULL;
-	return PARENT_STRUCT(mi, NodeData, AllNodesEntry);
+	return (NodeData *)cl_hmap_get(&fabricp->AllNodeGuids, guid);
 }
 
 // search for the NodeData corresponding to the given node name
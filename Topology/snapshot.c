@@ -3060,6 +3060,10 @@ static void NodeDataXmlParserEnd(IXmlParserState_t *state, const IXML_FIELD *fie
 		IXmlParserPrintError(state, "Duplicate NodeGuid: 0x%"PRIx64"\n", nodep->NodeInfo.NodeGUID);
 		goto failinsert;
 	}
+	if (FSUCCESS != cl_hmap_insert(&fabricp->AllNodeGuids, nodep->NodeInfo.NodeGUID, nodep)) {
+		IXmlParserPrintError(state, "Unable to index NodeGuid: 0x%"PRIx64"\n", nodep->NodeInfo.NodeGUID);
+		goto failindex;
+	}
 
 	//printf("processed NodeRecord GUID: 0x%"PRIx64"\n", nodep->NodeInfo.NodeGUID);
 	if (FSUCCESS != AddSystemNode(fabricp, nodep)) {
@@ -3074,6 +3078,8 @@ static void NodeDataXmlParserEnd(IXmlParserState_t *state, const IXML_FIELD *fie
 	return;
 
 failsystem:
+	(void)cl_hmap_remove(&fabricp->AllNodeGuids, nodep->NodeInfo.NodeGUID);
+failindex:
 	cl_qmap_remove_item(&fabricp->AllNodes, &nodep->AllNodesEntry);
 failinsert:
 failvalidate:
@@ -3542,6 +3548,12 @@ void Xml2PrintSnapshot(FILE *file, SnapshotOutputInfo_t *info)
 {
 	IXmlOutputState_t state;
 
+#ifndef __VXWORKS__
+	if (info->binary) {
+		(void)BinPrintSnapshot(file, info);
+		return;
+	}
+#endif
 	/* using SERIALIZE with no indent makes output less pretty but 1/2 the size */
 	if (FSUCCESS != IXmlOutputInit(&state, file, 0, IXML_OUTPUT_FLAG_SERIALIZE, info))
 	//if (FSUCCESS != IXmlOutputInit(&state, file, 4, IXML_OUTPUT_FLAG_NONE, info))
@@ -3575,6 +3587,12 @@ FSTATUS Xml2ParseSnapshot(const char *input_file, int quiet, FabricData_t *fabri
 		if (FSUCCESS != IXmlParseFile(stdin, "stdin", IXML_PARSER_FLAG_NONE, TopLevelFields, NULL, fabricp, NULL, NULL, &tags_found, &fields_found)) {
 			return FERROR;
 		}
+	} else if (BinIsSnapshot(input_file)) {
+		if (! quiet) ProgressPrint(TRUE, "Loading %s...", Top_truncate_str(input_file));
+		if (FSUCCESS != BinParseSnapshot(input_file, fabricp)) {
+			return FERROR;
+		}
+		tags_found = fields_found = 1;
 	} else {
 		if (! quiet) ProgressPrint(TRUE, "Parsing %s...", Top_truncate_str(input_file));
 		if (FSUCCESS != IXmlParseInputFile(input_file, IXML_PARSER_FLAG_NONE, TopLevelFields, NULL, fabricp, NULL, NULL, &tags_found, &fields_found)) {
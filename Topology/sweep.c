@@ -1872,6 +1872,7 @@ static FSTATUS GetAllNodes(struct oib_port *port,
 			{
 				// TBD - better handling cleanup of all previous Ports for node
 				cl_qmap_remove_item(&fabricp->AllNodes, &nodep->AllNodesEntry);
+				(void)cl_hmap_remove(&fabricp->AllNodeGuids, nodep->NodeInfo.NodeGUID);
 				MemoryDeallocate(nodep);
 				goto fail;
 			}
@@ -402,6 +402,21 @@ typedef struct clDijkstraDistancesAndRoutes_s {
     uint32          nCols;
 } clDijkstraDistancesAndRoutes_t;
 
+// shortest cycles found in one strongly connected component of a graph
+typedef struct clComponentCycles_s {
+    uint32          numVertices;            // vertices in component
+    uint32          numArcs;                // arcs within component
+    uint32          numCycles;
+    uint32          *cycleStart;            // numCycles+1 offsets into cycleVertices
+    uint32          cycleVerticesLength;
+    uint32          *cycleVertices;         // vertex Ids of each cycle in arc order
+} clComponentCycles_t;
+
+typedef struct clGraphCycles_s {
+    uint32              numComponents;      // only components with a cycle
+    clComponentCycles_t *components;        // ordered by lowest vertex Id
+} clGraphCycles_t;
+
 // get start of an entry (indexed by low bits of MLID) in MulticastFDB
 // The entry will consist of MulticastFDBEntrySize PORTMASK values
 static inline
@@ -463,6 +478,9 @@ typedef struct FabricData_s {
 
 	// data from live fabric or snapshot
 	cl_qmap_t AllNodes;		// items are NodeData, key is node guid
+	cl_hmap_t AllNodeGuids;	// unordered index of AllNodes for lookups
+	cl_hmap_t AllPortGuids;	// items are PortData, key is port guid
+							// built with AllPorts, 1st port wins
 	union {
 		cl_qmap_t AllLids;		// items are PortData, key is LID
 		PortData **LidMap;		// allocated for max ucast lids, index is LID
@@ -567,6 +585,7 @@ typedef struct {
 	FabricData_t *fabricp;	// fabric to dump to snapshot file
 	int argc;				// args to program ran
 	char **argv;			// args to program ran
+	boolean binary;			// output binary snapshot instead of XML
 	// Point *focus;
 } SnapshotOutputInfo_t;
 
@@ -830,6 +849,14 @@ extern FSTATUS Xml2ParseSnapshot(const char *input_file, int quiet, FabricData_t
 #else
 extern FSTATUS Xml2ParseSnapshot(const char *input_file, int quiet, FabricData_t *fabricp, FabricFlags_t flags, boolean allocFull, XML_Memory_Handling_Suite* memsuite);
 #endif
+
+// binary snapshot routines (from Topology/binsnapshot.c)
+// Xml2PrintSnapshot outputs a binary snapshot when info->binary is set and
+// Xml2ParseSnapshot reads either format, so most callers need not use these
+#ifndef __VXWORKS__
+extern FSTATUS BinPrintSnapshot(FILE *file, SnapshotOutputInfo_t *info);
+extern boolean BinIsSnapshot(const char *input_file);
+#endif
  
 // expected topology input/output routines (from Topology/topology.c)
 #ifndef __VXWORKS__
@@ -1033,6 +1060,16 @@ extern void CLDijkstraFindCycles(FabricData_t *fabricp,
                                  ValidateCLLinkStepSummaryCallback_t linkStepSummaryCallback,
                                  ValidateCLPathSummaryCallback_t pathSummaryCallback,
                                  void *context);
+extern FSTATUS CLGraphDataFindCycles(clGraphData_t *graphp, clGraphCycles_t *cyclesp, int verbose);
+extern void CLGraphDataCyclesSummary(FabricData_t *fabricp,
+                                     clGraphData_t *graphp,
+                                     clGraphCycles_t *cyclesp,
+                                     ValidateCLDataSummaryCallback_t dataSummaryCallback,
+                                     ValidateCLLinkSummaryCallback_t linkSummaryCallback,
+                                     ValidateCLLinkStepSummaryCallback_t linkStepSummaryCallback,
+                                     ValidateCLPathSummaryCallback_t pathSummaryCallback,
+                                     void *context);
+extern void CLGraphDataFreeCycles(clGraphCycles_t *cyclesp);
 extern FSTATUS CLTimeGet(uint64_t *address); 
 #endif
 
@@ -48,6 +48,9 @@ extern Top_FreeCallbacks g_Top_FreeCallbacks;
 
 extern void PortDataFreePartitionTable(FabricData_t *fabricp, PortData *portp);
 extern uint16 PortPartitionTableSize(PortData *portp);
+#ifndef __VXWORKS__
+extern FSTATUS BinParseSnapshot(const char *input_file, FabricData_t *fabricp);
+#endif
 extern FSTATUS PortDataAllocatePartitionTable(FabricData_t *fabricp, PortData *portp);
 extern void PortDataFree(FabricData_t *fabricp, PortData *portp);
 extern FSTATUS AllLidsAdd(FabricData_t *fabricp, PortData *portp, boolean force);
@@ -0,0 +1,4 @@
+include Makefile
+include build.ALL_EMB.release/ixml.c.dep
+include build.ALL_EMB.release/ixml_err.c.dep
+include build.ALL_EMB.release/ixml_ib.c.dep
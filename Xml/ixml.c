@@ -64,6 +64,9 @@ extern void IXmlPrintFileError(const char *input_file, IXmlParserPrintMessage pr
 /****************************************************************************/
 /* XML Init */
 
+/* size of output buffer used when IXML_OUTPUT_FLAG_BUFFERED */
+#define IXML_OUTPUT_BUFSIZE (64*1024)
+
 /* indent is additional indent per level */
 void
 IXmlInit(IXmlOutputState_t *state, FILE *file, unsigned indent,
@@ -74,6 +77,17 @@ IXmlInit(IXmlOutputState_t *state, FILE *file, unsigned indent,
 	state->flags = flags;
 	state->cur_indent = 0;
 	state->context = context;
+	state->buf = NULL;
+	state->buf_len = 0;
+	state->buf_size = 0;
+	state->buf_error = FALSE;
+	if (flags & IXML_OUTPUT_FLAG_BUFFERED) {
+		/* if we can't get a buffer, just output directly to file */
+		state->buf = (char*)MemoryAllocate2(IXML_OUTPUT_BUFSIZE,
+									IBA_MEM_FLAG_PREMPTABLE, MYTAG);
+		if (state->buf)
+			state->buf_size = IXML_OUTPUT_BUFSIZE;
+	}
 }
 
 /****************************************************************************/
@@ -84,47 +98,231 @@ FSTATUS
 IXmlOutputInit(IXmlOutputState_t *state, FILE *file, unsigned indent,
 				IXmlOutputFlags_t flags, void *context)
 {
-	IXmlInit(state, file, indent, flags, context);
+	IXmlInit(state, file, indent, flags|IXML_OUTPUT_FLAG_BUFFERED, context);
 	IXmlOutputPrint(state, "<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n");
 	state->flags &= ~IXML_OUTPUT_FLAG_HAD_CONTENT;	// should not be content
-	return (IXmlOutputFailed(state)?FERROR:FSUCCESS);
+	if (IXmlOutputFailed(state)) {
+		IXmlOutputDestroy(state);
+		return FERROR;
+	}
+	return FSUCCESS;
 }
 
 void
 IXmlOutputDestroy(IXmlOutputState_t *state)
 {
+	IXmlOutputFlush(state);
+	if (state->buf)
+		MemoryDeallocate(state->buf);
+	state->buf = NULL;
+	state->buf_size = 0;
 	state->file = NULL;	// make sure can't be used by mistake
 	state->context = NULL;	// make sure can't be used by mistake
 }
 
+// write buffered output to output file
+void IXmlOutputFlush(IXmlOutputState_t *state)
+{
+	if (! state->buf_len)
+		return;
+	if (fwrite(state->buf, 1, state->buf_len, state->file) != state->buf_len)
+		state->buf_error = TRUE;
+	state->buf_len = 0;
+}
+
+// append len characters to output
+static void IXmlOutputWrite(IXmlOutputState_t *state, const char *str, unsigned len)
+{
+	if (! len)
+		return;
+	if (state->buf_len + len > state->buf_size) {
+		IXmlOutputFlush(state);
+		if (len > state->buf_size) {
+			// too big to buffer (or unbuffered), output directly
+			if (fwrite(str, 1, len, state->file) != len)
+				state->buf_error = TRUE;
+			return;
+		}
+	}
+	MemoryCopy(&state->buf[state->buf_len], str, len);
+	state->buf_len += len;
+}
+
+static _inline void IXmlOutputPutc(IXmlOutputState_t *state, char c)
+{
+	if (state->buf_len < state->buf_size)
+		state->buf[state->buf_len++] = c;
+	else
+		IXmlOutputWrite(state, &c, 1);
+}
+
+static _inline void IXmlOutputWriteStr(IXmlOutputState_t *state, const char *str)
+{
+	IXmlOutputWrite(state, str, strlen(str));
+}
+
+// format into remaining space in buffer
+// returns FALSE if output did not fit, in which case nothing was output
+static boolean IXmlOutputVBuffer(IXmlOutputState_t *state, const char *format, va_list args)
+{
+	unsigned space = state->buf_size - state->buf_len;
+	int len;
+
+	if (! space)
+		return FALSE;
+	len = vsnprintf(&state->buf[state->buf_len], space, format, args);
+	if (len < 0 || (unsigned)len >= space)
+		return FALSE;
+	state->buf_len += len;
+	return TRUE;
+}
+
+// output format and args
+// a va_list can only be traversed once, so when the output does not fit
+// in the buffer the caller must restart args and call IXmlOutputVFile
+static _inline void IXmlOutputVFile(IXmlOutputState_t *state, const char *format, va_list args)
+{
+	IXmlOutputFlush(state);
+	vfprintf(state->file, format, args);
+}
+
+static const char IXmlSpaces[] = "                                                                ";
+
+// output newline if needed followed by present indent
+static void IXmlOutputIndent(IXmlOutputState_t *state)
+{
+	unsigned indent = state->cur_indent;
+
+	if (state->flags & IXML_OUTPUT_FLAG_START_NEED_NL) {
+		IXmlOutputPutc(state, '\n');
+		state->flags &= ~IXML_OUTPUT_FLAG_START_NEED_NL;
+	}
+	state->flags &= ~IXML_OUTPUT_FLAG_HAD_CONTENT;	// should not be content
+	while (indent) {
+		unsigned len = MIN(indent, sizeof(IXmlSpaces)-1);
+		IXmlOutputWrite(state, IXmlSpaces, len);
+		indent -= len;
+	}
+}
+
 // output to output file
 void IXmlOutputPrint(IXmlOutputState_t *state, const char *format, ...)
 {
 	va_list args;
-
-	va_start(args, format);
+	boolean done;
 
 	state->flags &= ~IXML_OUTPUT_FLAG_START_NEED_NL;
 	state->flags |= IXML_OUTPUT_FLAG_HAD_CONTENT;	// could be content
-	vfprintf(state->file, format, args);
+	va_start(args, format);
+	done = IXmlOutputVBuffer(state, format, args);
 	va_end(args);
+	if (! done) {
+		va_start(args, format);
+		IXmlOutputVFile(state, format, args);
+		va_end(args);
+	}
 }
 
 // output to output file with present indent preceeding output
 void IXmlOutputPrintIndent(IXmlOutputState_t *state, const char *format, ...)
 {
 	va_list args;
+	boolean done;
 
+	IXmlOutputIndent(state);
 	va_start(args, format);
-
-	if (state->flags & IXML_OUTPUT_FLAG_START_NEED_NL) {
-		fprintf(state->file, "\n");
-		state->flags &= ~IXML_OUTPUT_FLAG_START_NEED_NL;
-	}
-	state->flags &= ~IXML_OUTPUT_FLAG_HAD_CONTENT;	// should not be content
-	fprintf(state->file, "%*s", state->cur_indent, "");
-	vfprintf(state->file, format, args);
+	done = IXmlOutputVBuffer(state, format, args);
 	va_end(args);
+	if (! done) {
+		va_start(args, format);
+		IXmlOutputVFile(state, format, args);
+		va_end(args);
+	}
+}
+
+// output <tag{suffix}>value</tag{suffix}> with present indent preceeding it
+// value is len characters
+static void IXmlOutputTagValue(IXmlOutputState_t *state, const char *tag,
+				const char *suffix, const char *value, unsigned len)
+{
+	unsigned tag_len = strlen(tag);
+	unsigned suffix_len = strlen(suffix);
+
+	IXmlOutputIndent(state);
+	IXmlOutputPutc(state, '<');
+	IXmlOutputWrite(state, tag, tag_len);
+	IXmlOutputWrite(state, suffix, suffix_len);
+	IXmlOutputPutc(state, '>');
+	IXmlOutputWrite(state, value, len);
+	IXmlOutputWrite(state, "</", 2);
+	IXmlOutputWrite(state, tag, tag_len);
+	IXmlOutputWrite(state, suffix, suffix_len);
+	IXmlOutputWrite(state, ">\n", 2);
+}
+
+/* integer formatting for numeric fields, avoids the cost of printf.
+ * Digits are built backwards from end, first character is returned
+ */
+static char *IXmlFormatUint64(char *end, uint64 value)
+{
+	do {
+		*--end = '0' + (char)(value % 10);
+		value /= 10;
+	} while (value);
+	return end;
+}
+
+static char *IXmlFormatInt64(char *end, int64 value)
+{
+	char *p;
+
+	if (value >= 0)
+		return IXmlFormatUint64(end, (uint64)value);
+	p = IXmlFormatUint64(end, (uint64)0 - (uint64)value);
+	*--p = '-';
+	return p;
+}
+
+// 0x prefixed lower case hex, zero padded to at least pad digits
+static char *IXmlFormatHex64(char *end, uint64 value, unsigned pad)
+{
+	static const char digits[] = "0123456789abcdef";
+	char *p = end;
+
+	do {
+		*--p = digits[value & 0xf];
+		value >>= 4;
+	} while (value || (unsigned)(end - p) < pad);
+	*--p = 'x';
+	*--p = '0';
+	return p;
+}
+
+static void IXmlOutputHexValue(IXmlOutputState_t *state, const char *tag, uint64 value, unsigned pad)
+{
+	char buf[24];
+	char *end = &buf[sizeof(buf)];
+	char *p = IXmlFormatHex64(end, value, pad);
+
+	IXmlOutputTagValue(state, tag, "", p, (unsigned)(end - p));
+}
+
+static void IXmlOutputInt64Value(IXmlOutputState_t *state, const char *tag, const char *suffix, int64 value)
+{
+	char buf[24];
+	char *end = &buf[sizeof(buf)];
+	char *p = IXmlFormatInt64(end, value);
+
+	IXmlOutputTagValue(state, tag, suffix, p, (unsigned)(end - p));
+}
+
+static void IXmlOutputUint64Value(IXmlOutputState_t *state, const char *tag, const char *suffix, uint64 value)
+{
+	char buf[24];
+	char *end = &buf[sizeof(buf)];
+	char *p = IXmlFormatUint64(end, value);
+
+	IXmlOutputTagValue(state, tag, suffix, p, (unsigned)(end - p));
 }
 
 void IXmlOutputNoop(IXmlOutputState_t *state, const char *tag, void *data)
@@ -133,7 +331,10 @@ void IXmlOutputNoop(IXmlOutputState_t *state, const char *tag, void *data)
 
 void IXmlOutputStartTag(IXmlOutputState_t *state, const char *tag)
 {
-	IXmlOutputPrintIndent(state, "<%s>", tag);
+	IXmlOutputIndent(state);
+	IXmlOutputPutc(state, '<');
+	IXmlOutputWriteStr(state, tag);
+	IXmlOutputPutc(state, '>');
 	state->flags |= IXML_OUTPUT_FLAG_START_NEED_NL;
 	state->flags &= ~IXML_OUTPUT_FLAG_HAD_CONTENT;	// no content yet
 	state->cur_indent += state->indent;
@@ -142,9 +343,11 @@ void IXmlOutputStartTag(IXmlOutputState_t *state, const char *tag)
 void IXmlOutputStartAttrTag(IXmlOutputState_t *state, const char *tag, void *data, IXML_FORMAT_ATTR_FUNC attr_func)
 {
 	if (attr_func) {
-		IXmlOutputPrintIndent(state, "<%s", tag);
+		IXmlOutputIndent(state);
+		IXmlOutputPutc(state, '<');
+		IXmlOutputWriteStr(state, tag);
 		(*attr_func)(state, data);
-		IXmlOutputPrint(state, ">");
+		IXmlOutputPutc(state, '>');
 		// clear flags after attr_func in case attr_func calls OutputPrint
 		state->flags |= IXML_OUTPUT_FLAG_START_NEED_NL;
 		state->flags &= ~IXML_OUTPUT_FLAG_HAD_CONTENT;	// no content yet
@@ -167,9 +370,12 @@ void IXmlOutputEndTag(IXmlOutputState_t *state, const char *tag)
 	// or IXmlOutputPrintStr with an empty string so flags indicate intent for
 	// tag to have content
 	if (state->flags & IXML_OUTPUT_FLAG_HAD_CONTENT)
-		IXmlOutputPrint(state, "</%s>\n", tag);
+		state->flags &= ~IXML_OUTPUT_FLAG_START_NEED_NL;
 	else
-		IXmlOutputPrintIndent(state, "</%s>\n", tag);
+		IXmlOutputIndent(state);
+	IXmlOutputWrite(state, "</", 2);
+	IXmlOutputWriteStr(state, tag);
+	IXmlOutputWrite(state, ">\n", 2);
 	state->flags &= ~IXML_OUTPUT_FLAG_HAD_CONTENT;	// closed tag
 }
 
@@ -194,7 +400,7 @@ void IXmlOutputEndTagWithLineno(IXmlOutputState_t *state, const char *tag, unsig
 
 void IXmlOutputHexPad8(IXmlOutputState_t *state, const char *tag, uint8 value)
 {
-	IXmlOutputPrintIndent(state, "<%s>0x%02x</%s>\n", tag, value, tag);
+	IXmlOutputHexValue(state, tag, value, 2);
 }
 
 // only output if value != 0
@@ -206,7 +412,7 @@ void IXmlOutputOptionalHexPad8(IXmlOutputState_t *state, const char *tag, uint8
 
 void IXmlOutputHexPad16(IXmlOutputState_t *state, const char *tag, uint16 value)
 {
-	IXmlOutputPrintIndent(state, "<%s>0x%04x</%s>\n", tag, value, tag);
+	IXmlOutputHexValue(state, tag, value, 4);
 }
 
 // only output if value != 0
@@ -218,7 +424,7 @@ void IXmlOutputOptionalHexPad16(IXmlOutputState_t *state, const char *tag, uint1
 
 void IXmlOutputHexPad32(IXmlOutputState_t *state, const char *tag, uint32 value)
 {
-	IXmlOutputPrintIndent(state, "<%s>0x%08x</%s>\n", tag, value, tag);
+	IXmlOutputHexValue(state, tag, value, 8);
 }
 
 // only output if value != 0
@@ -230,7 +436,7 @@ void IXmlOutputOptionalHexPad32(IXmlOutputState_t *state, const char *tag, uint3
 
 void IXmlOutputHexPad64(IXmlOutputState_t *state, const char *tag, uint64 value)
 {
-	IXmlOutputPrintIndent(state, "<%s>0x%016"PRIx64"</%s>\n", tag, value, tag);
+	IXmlOutputHexValue(state, tag, value, 16);
 }
 
 // only output if value != 0
@@ -242,7 +448,7 @@ void IXmlOutputOptionalHexPad64(IXmlOutputState_t *state, const char *tag, uint6
 
 void IXmlOutputInt(IXmlOutputState_t *state, const char *tag, int value)
 {
-	IXmlOutputPrintIndent(state, "<%s>%d</%s>\n", tag, value, tag);
+	IXmlOutputInt64Value(state, tag, "", value);
 }
 
 // only output if value != 0
@@ -254,7 +460,7 @@ void IXmlOutputOptionalInt(IXmlOutputState_t *state, const char *tag, int value)
 
 void IXmlOutputInt64(IXmlOutputState_t *state, const char *tag, int64 value)
 {
-	IXmlOutputPrintIndent(state, "<%s>%"PRId64"</%s>\n", tag, value, tag);
+	IXmlOutputInt64Value(state, tag, "", value);
 }
 
 // only output if value != 0
@@ -266,12 +472,12 @@ void IXmlOutputOptionalInt64(IXmlOutputState_t *state, const char *tag, int64 va
 
 static void IXmlOutputIntValue(IXmlOutputState_t *state, const char *tag, int value)
 {
-	IXmlOutputPrintIndent(state, "<%s_Int>%d</%s_Int>\n", tag, value, tag);
+	IXmlOutputInt64Value(state, tag, "_Int", value);
 }
 
 void IXmlOutputUint(IXmlOutputState_t *state, const char *tag, unsigned value)
 {
-	IXmlOutputPrintIndent(state, "<%s>%u</%s>\n", tag, value, tag);
+	IXmlOutputUint64Value(state, tag, "", value);
 }
 
 // only output if value != 0
@@ -283,7 +489,7 @@ void IXmlOutputOptionalUint(IXmlOutputState_t *state, const char *tag, unsigned
 
 void IXmlOutputUint64(IXmlOutputState_t *state, const char *tag, uint64 value)
 {
-	IXmlOutputPrintIndent(state, "<%s>%"PRIu64"</%s>\n", tag, value, tag);
+	IXmlOutputUint64Value(state, tag, "", value);
 }
 
 // only output if value != 0
@@ -295,12 +501,12 @@ void IXmlOutputOptionalUint64(IXmlOutputState_t *state, const char *tag, uint64
 
 static void IXmlOutputUintValue(IXmlOutputState_t *state, const char *tag, int value)
 {
-	IXmlOutputPrintIndent(state, "<%s_Int>%u</%s_Int>\n", tag, value, tag);
+	IXmlOutputUint64Value(state, tag, "_Int", (unsigned)value);
 }
 
 void IXmlOutputHex(IXmlOutputState_t *state, const char *tag, unsigned value)
 {
-	IXmlOutputPrintIndent(state, "<%s>0x%x</%s>\n", tag, value, tag);
+	IXmlOutputHexValue(state, tag, value, 1);
 }
 
 // only output if value != 0
@@ -312,7 +518,7 @@ void IXmlOutputOptionalHex(IXmlOutputState_t *state, const char *tag, unsigned v
 
 void IXmlOutputHex64(IXmlOutputState_t *state, const char *tag, uint64 value)
 {
-	IXmlOutputPrintIndent(state, "<%s>0x%"PRIx64"</%s>\n", tag, value, tag);
+	IXmlOutputHexValue(state, tag, value, 1);
 }
 
 // only output if value != 0
@@ -324,25 +530,37 @@ void IXmlOutputOptionalHex64(IXmlOutputState_t *state, const char *tag, uint64 v
 
 void IXmlOutputPrintStrLen(IXmlOutputState_t *state, const char* value, int len)
 {
+	const char *run = value;	/* start of characters not yet output */
+
 	state->flags &= ~IXML_OUTPUT_FLAG_START_NEED_NL;
 	state->flags |= IXML_OUTPUT_FLAG_HAD_CONTENT;	// should be content
-	/* print string taking care to translate special XML characters */
+	/* print string taking care to translate special XML characters,
+	 * runs of characters which need no translation are output together
+	 */
 	for (;len && *value; --len, ++value) {
+		const char *entity;
+		char hex[8];
+
 		if (*value == '&')
-			IXmlOutputPrint(state, "&amp;");
+			entity = "&amp;";
 		else if (*value == '<')
-			IXmlOutputPrint(state, "&lt;");
+			entity = "&lt;";
 		else if (*value == '>')
-			IXmlOutputPrint(state, "&gt;");
+			entity = "&gt;";
 		else if (*value == '\'')
-			IXmlOutputPrint(state, "&apos;");
+			entity = "&apos;";
 		else if (*value == '"')
-			IXmlOutputPrint(state, "&quot;");
-		else if (*value != '\n' && iscntrl(*value))
-			IXmlOutputPrint(state, "&#x%x;", (unsigned)(unsigned char)*value);
-		else
-			fputc((int)(unsigned)(unsigned char)*value, state->file);
+			entity = "&quot;";
+		else if (*value != '\n' && iscntrl(*value)) {
+			snprintf(hex, sizeof(hex), "&#x%x;", (unsigned)(unsigned char)*value);
+			entity = hex;
+		} else
+			continue;
+		IXmlOutputWrite(state, run, (unsigned)(value - run));
+		IXmlOutputWriteStr(state, entity);
+		run = value + 1;
 	}
+	IXmlOutputWrite(state, run, (unsigned)(value - run));
 }
 
 void IXmlOutputPrintStr(IXmlOutputState_t *state, const char* value)
@@ -352,9 +570,14 @@ void IXmlOutputPrintStr(IXmlOutputState_t *state, const char* value)
 
 void IXmlOutputStrLen(IXmlOutputState_t *state, const char *tag, const char* value, int len)
 {
-	IXmlOutputPrintIndent(state, "<%s>", tag);
+	IXmlOutputIndent(state);
+	IXmlOutputPutc(state, '<');
+	IXmlOutputWriteStr(state, tag);
+	IXmlOutputPutc(state, '>');
 	IXmlOutputPrintStrLen(state, value, len);
-	IXmlOutputPrint(state, "</%s>\n", tag);
+	IXmlOutputWrite(state, "</", 2);
+	IXmlOutputWriteStr(state, tag);
+	IXmlOutputWrite(state, ">\n", 2);
 	state->flags &= ~IXML_OUTPUT_FLAG_HAD_CONTENT;	// should not be content
 }
 
@@ -250,6 +250,7 @@ typedef enum {
 	/* flags which can be passed to IXmlInit and IXmlOutputInit */
 	IXML_OUTPUT_FLAG_NONE = 0,
 	IXML_OUTPUT_FLAG_SERIALIZE = 1,	/* compact serialized format */
+	IXML_OUTPUT_FLAG_BUFFERED = 2,	/* buffer output until IXmlOutputFlush */
 	/* these flags are for internal use only */
 	IXML_OUTPUT_FLAG_START_NEED_NL = 0x10000,	/* start tag output without newline */
 	IXML_OUTPUT_FLAG_HAD_CONTENT = 0x20000,	/* tag had content output */
@@ -257,12 +258,15 @@ typedef enum {
 
 /* these structures should not be directly used by callers */
 typedef struct IXmlOutputState {
-// TBD - later support output to a memory buffer
 	FILE *file;		/* output file */
 	unsigned indent;	/* level of indent */
 	unsigned cur_indent;	/* level of indent */
 	int flags;
 	void *context;	/* caller supplied context */
+	char *buf;		/* output not yet written to file, NULL if unbuffered */
+	unsigned buf_len;	/* bytes used in buf */
+	unsigned buf_size;	/* size of buf */
+	boolean buf_error;	/* write of buf to file failed */
 } IXmlOutputState_t;
 
 /* for use in output calls so can early exit */
@@ -271,7 +275,7 @@ typedef struct IXmlOutputState {
  */
 static _inline boolean IXmlOutputFailed(IXmlOutputState_t *state)
 {
-	return (ferror(state->file) != 0);
+	return (state->buf_error || ferror(state->file) != 0);
 }
 
 /* get access to caller supplied context for output */
@@ -280,12 +284,18 @@ static _inline void* IXmlOutputGetContext(IXmlOutputState_t *state)
 	return state->context;
 }
 
-/* indent is additional indent per level */
+/* indent is additional indent per level
+ * IXmlOutputInit always buffers output, IXmlInit only if
+ * IXML_OUTPUT_FLAG_BUFFERED is given.  Buffered output is written to file by
+ * IXmlOutputFlush and IXmlOutputDestroy.
+ */
 extern void IXmlInit(IXmlOutputState_t *state, FILE *file,
 				unsigned indent, IXmlOutputFlags_t flags, void *context);
 extern FSTATUS IXmlOutputInit(IXmlOutputState_t *state, FILE *file,
 				unsigned indent, IXmlOutputFlags_t flags, void *context);
 extern void IXmlOutputDestroy(IXmlOutputState_t *state);
+/* write buffered output to file, needed before caller writes to file directly */
+extern void IXmlOutputFlush(IXmlOutputState_t *state);
 extern void IXmlOutputPrint(IXmlOutputState_t *state, const char *format, ...);
 extern void IXmlOutputPrintIndent(IXmlOutputState_t *state, const char *format, ...);
 extern void IXmlOutputNoop(IXmlOutputState_t *state, const char *tag, void *data);
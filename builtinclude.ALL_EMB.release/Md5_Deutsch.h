@@ -0,0 +1 @@
+/root/repo/Md5/Md5_Deutsch.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Md5/Md5_Rivest.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/opa_fe_utils/include/fe_connections.h
\ No newline at end of file
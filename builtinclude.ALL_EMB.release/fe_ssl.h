@@ -0,0 +1 @@
+/root/repo/opa_fe_utils/src/fe_ssl.h
\ No newline at end of file
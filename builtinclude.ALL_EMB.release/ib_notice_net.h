@@ -0,0 +1 @@
+/root/repo/oib_utils/src/ib_notice_net.h
\ No newline at end of file
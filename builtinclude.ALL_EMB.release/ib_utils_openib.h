@@ -0,0 +1 @@
+/root/repo/oib_utils/src/ib_utils_openib.h
\ No newline at end of file
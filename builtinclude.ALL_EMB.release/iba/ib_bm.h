@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Inc/ib_bm.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Inc/ib_cm.h
\ No newline at end of file
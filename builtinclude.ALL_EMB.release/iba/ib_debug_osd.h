@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/Inc/ib_debug_osd.h
\ No newline at end of file
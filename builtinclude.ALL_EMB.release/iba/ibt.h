@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../UserCommon/Inc/ibt.h
\ No newline at end of file
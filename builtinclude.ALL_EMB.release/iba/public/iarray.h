@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Public/iarray.h
\ No newline at end of file
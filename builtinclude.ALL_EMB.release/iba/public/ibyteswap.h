@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Public/ibyteswap.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/Public/ibyteswap_osd.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Public/idebug.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/Public/ievent_osd.h
\ No newline at end of file
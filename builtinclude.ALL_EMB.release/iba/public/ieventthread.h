@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Public/ieventthread.h
\ No newline at end of file
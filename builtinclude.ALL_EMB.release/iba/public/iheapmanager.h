@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Public/iheapmanager.h
\ No newline at end of file
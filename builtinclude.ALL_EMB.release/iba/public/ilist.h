@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Public/ilist.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Public/iobjmgr.h
\ No newline at end of file
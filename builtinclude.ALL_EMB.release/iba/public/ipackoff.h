@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/Public/ipackoff.h
\ No newline at end of file
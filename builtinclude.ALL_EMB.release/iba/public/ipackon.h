@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/Public/ipackon.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/Public/ispinlock_osd.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Public/itcpip.h
\ No newline at end of file
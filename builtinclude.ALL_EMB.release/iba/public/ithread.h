@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Public/ithread.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Public/itimer.h
\ No newline at end of file
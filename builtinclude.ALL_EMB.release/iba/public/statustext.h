@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Public/statustext.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Inc/stl_mad.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Inc/stl_pm.h
\ No newline at end of file
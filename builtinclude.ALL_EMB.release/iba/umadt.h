@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Inc/umadt.h
\ No newline at end of file
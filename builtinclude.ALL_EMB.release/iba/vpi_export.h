@@ -0,0 +1 @@
+/root/repo/IbAccess/UserLinux/../Common/Inc/vpi_export.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/IbPrint/ibprint.h
\ No newline at end of file
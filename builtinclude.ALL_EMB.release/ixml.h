@@ -0,0 +1 @@
+/root/repo/Xml/ixml.h
\ No newline at end of file
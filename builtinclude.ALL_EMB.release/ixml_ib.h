@@ -0,0 +1 @@
+/root/repo/Xml/ixml_ib.h
\ No newline at end of file
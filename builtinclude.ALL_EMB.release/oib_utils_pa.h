@@ -0,0 +1 @@
+/root/repo/oib_utils/include/oib_utils_pa.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/oib_utils/src/stl_convertfuncs.h
\ No newline at end of file
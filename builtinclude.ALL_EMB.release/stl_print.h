@@ -0,0 +1 @@
+/root/repo/IbPrint/stl_print.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Topology/topology.h
\ No newline at end of file
@@ -0,0 +1,6 @@
+include Makefile
+include build.ALL_EMB.release/src/fe_connections.c.dep
+include build.ALL_EMB.release/src/fe_net.c.dep
+include build.ALL_EMB.release/src/fe_net_blob.c.dep
+include build.ALL_EMB.release/src/fe_net_queue.c.dep
+include build.ALL_EMB.release/src/fe_ssl.c.dep